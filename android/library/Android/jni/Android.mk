@@ -147,7 +147,7 @@ MAPLY_JNI_FILES := Maply_jni.cpp AttrDictionary_jni.cpp AngleAxis_jni.cpp \
 					SphericalMercatorCoordSystem_jni.cpp StringWrapper_jni.cpp \
 					Scene_jni.cpp ScreenObject_jni.cpp Sticker_jni.cpp StickerInfo_jni.cpp StickerManager_jni.cpp Sun_jni.cpp \
 					ShapeInfo_jni.cpp Shape_jni.cpp ShapeRectangle_jni.cpp ShapeSphere_jni.cpp ShapeManager_jni.cpp Texture_jni.cpp \
-					VectorInfo_jni.cpp VectorIterator_jni.cpp VectorManager_jni.cpp VectorObject_jni.cpp View_jni.cpp VertexAttribute_jni.cpp ViewState_jni.cpp WideVectorManager_jni.cpp WideVectorInfo_jni.cpp GeoJSONSource_jni.cpp
+					VectorInfo_jni.cpp VectorIterator_jni.cpp VectorManager_jni.cpp VectorObject_jni.cpp View_jni.cpp VertexAttribute_jni.cpp ViewState_jni.cpp WideVectorManager_jni.cpp WideVectorInfo_jni.cpp GeoJSONSource_jni.cpp GeoTIFFTileSource_jni.cpp IntersectionManager_jni.cpp GeoPackage_jni.cpp
 
 LOCAL_SRC_FILES += $(MAPLY_JNI_FILES)
 
@@ -175,6 +175,7 @@ DrawableString *FontTextureManagerAndroid::addString(JNIEnv *env,const std::vect
             rect.texCoords[1] = TexCoord(1.0,0.0);
 
             rect.subTex = glyphInfo->subTex;
+            rect.glyph = glyph;
             drawString->glyphPolys.push_back(rect);
             drawString->mbr.addPoint(rect.pts[0]);
             drawString->mbr.addPoint(rect.pts[1]);
@@ -0,0 +1,396 @@
+/*
+ *  GeoPackage_jni.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <jni.h>
+#import "Maply_jni.h"
+#import "Maply_utils_jni.h"
+#import "com_mousebird_maply_GeoPackage.h"
+#import "WhirlyGlobe.h"
+
+using namespace WhirlyKit;
+
+// Methods we call on the Android database classes, looked up once in nativeInit
+static jclass sqliteDatabaseClass = NULL;
+static jmethodID openDatabaseMethod = NULL,rawQueryMethod = NULL,dbCloseMethod = NULL;
+static jmethodID moveToNextMethod = NULL,getColumnCountMethod = NULL,getColumnNameMethod = NULL,getTypeMethod = NULL;
+static jmethodID getLongMethod = NULL,getDoubleMethod = NULL,getStringMethod = NULL,getBlobMethod = NULL,cursorCloseMethod = NULL;
+
+// SQLiteDatabase.OPEN_READONLY
+static const int AndroidSQLiteOpenReadOnly = 1;
+
+// Environment for the current thread.  The core only queries from inside our own JNI calls, so it's attached.
+static JNIEnv *GetThreadEnv(JavaVM *jvm)
+{
+    JNIEnv *env = NULL;
+    if (jvm->GetEnv((void **)&env, JNI_VERSION_1_6) != JNI_OK)
+        return NULL;
+    return env;
+}
+
+// Java threw, most likely an SQLiteException.  Clear it so we can report failure instead.
+static bool CheckException(JNIEnv *env)
+{
+    if (!env->ExceptionCheck())
+        return false;
+    env->ExceptionClear();
+    return true;
+}
+
+/// Wraps an android.database.Cursor.  Strings and blobs are copied out.
+class AndroidGeoPackageCursor : public GeoPackageCursor
+{
+public:
+    AndroidGeoPackageCursor(JavaVM *jvm,JNIEnv *env,jobject inCursor)
+    : jvm(jvm)
+    {
+        cursor = env->NewGlobalRef(inCursor);
+    }
+
+    virtual ~AndroidGeoPackageCursor()
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return;
+        env->CallVoidMethod(cursor,cursorCloseMethod);
+        CheckException(env);
+        env->DeleteGlobalRef(cursor);
+    }
+
+    virtual bool step()
+    {
+        blobs.clear();
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return false;
+        bool ret = env->CallBooleanMethod(cursor,moveToNextMethod);
+        return !CheckException(env) && ret;
+    }
+
+    virtual int getNumColumns()
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return 0;
+        int ret = env->CallIntMethod(cursor,getColumnCountMethod);
+        return CheckException(env) ? 0 : ret;
+    }
+
+    virtual std::string getColumnName(int col)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return std::string();
+        jstring jstr = (jstring)env->CallObjectMethod(cursor,getColumnNameMethod,col);
+        return toString(env,jstr);
+    }
+
+    // Cursor.FIELD_TYPE_* are in the same order as ours
+    virtual GeoPackageColumnType getColumnType(int col)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return GeoPackageNull;
+        int type = env->CallIntMethod(cursor,getTypeMethod,col);
+        if (CheckException(env) || type < GeoPackageNull || type > GeoPackageBlob)
+            return GeoPackageNull;
+        return (GeoPackageColumnType)type;
+    }
+
+    virtual int64_t getInt(int col)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return 0;
+        int64_t ret = env->CallLongMethod(cursor,getLongMethod,col);
+        return CheckException(env) ? 0 : ret;
+    }
+
+    virtual double getDouble(int col)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return 0.0;
+        double ret = env->CallDoubleMethod(cursor,getDoubleMethod,col);
+        return CheckException(env) ? 0.0 : ret;
+    }
+
+    virtual std::string getString(int col)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return std::string();
+        jstring jstr = (jstring)env->CallObjectMethod(cursor,getStringMethod,col);
+        return toString(env,jstr);
+    }
+
+    virtual const unsigned char *getBlob(int col,size_t &len)
+    {
+        len = 0;
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return NULL;
+        jbyteArray jarr = (jbyteArray)env->CallObjectMethod(cursor,getBlobMethod,col);
+        if (CheckException(env) || !jarr)
+            return NULL;
+
+        // Each column gets its own copy so they're all good until the next step
+        std::vector<unsigned char> &blob = blobs[col];
+        blob.resize(env->GetArrayLength(jarr));
+        if (!blob.empty())
+            env->GetByteArrayRegion(jarr,0,blob.size(),(jbyte *)&blob[0]);
+        env->DeleteLocalRef(jarr);
+
+        len = blob.size();
+        return blob.empty() ? NULL : &blob[0];
+    }
+
+protected:
+    // Copy out a string and let go of the local reference, since we're called once per row
+    std::string toString(JNIEnv *env,jstring jstr)
+    {
+        if (CheckException(env) || !jstr)
+            return std::string();
+        std::string ret;
+        {
+            JavaString str(env,jstr);
+            if (str.cStr)
+                ret = str.cStr;
+        }
+        env->DeleteLocalRef(jstr);
+        return ret;
+    }
+
+    JavaVM *jvm;
+    jobject cursor;
+    std::map<int,std::vector<unsigned char> > blobs;
+};
+
+/// A read only android.database.sqlite.SQLiteDatabase of its own, for the pool
+class AndroidGeoPackageConnection : public GeoPackageConnection
+{
+public:
+    AndroidGeoPackageConnection(JavaVM *jvm,JNIEnv *env,jobject inDB)
+    : jvm(jvm)
+    {
+        db = env->NewGlobalRef(inDB);
+    }
+
+    virtual ~AndroidGeoPackageConnection()
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return;
+        env->CallVoidMethod(db,dbCloseMethod);
+        CheckException(env);
+        env->DeleteGlobalRef(db);
+    }
+
+    /// Open the file, or return NULL if it can't be
+    static GeoPackageConnectionRef Open(JavaVM *jvm,const std::string &fileName)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return GeoPackageConnectionRef();
+
+        jstring fileNameStr = env->NewStringUTF(fileName.c_str());
+        jobject db = env->CallStaticObjectMethod(sqliteDatabaseClass,openDatabaseMethod,fileNameStr,NULL,AndroidSQLiteOpenReadOnly);
+        env->DeleteLocalRef(fileNameStr);
+        if (CheckException(env) || !db)
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "GeoPackage: Couldn't open %s", fileName.c_str());
+            return GeoPackageConnectionRef();
+        }
+
+        GeoPackageConnectionRef conn(new AndroidGeoPackageConnection(jvm,env,db));
+        env->DeleteLocalRef(db);
+        return conn;
+    }
+
+    virtual GeoPackageCursorRef query(const std::string &sql)
+    {
+        JNIEnv *env = GetThreadEnv(jvm);
+        if (!env)
+            return GeoPackageCursorRef();
+
+        jstring sqlStr = env->NewStringUTF(sql.c_str());
+        jobject cursor = env->CallObjectMethod(db,rawQueryMethod,sqlStr,NULL);
+        env->DeleteLocalRef(sqlStr);
+        if (CheckException(env) || !cursor)
+            return GeoPackageCursorRef();
+
+        GeoPackageCursorRef ret(new AndroidGeoPackageCursor(jvm,env,cursor));
+        env->DeleteLocalRef(cursor);
+        return ret;
+    }
+
+protected:
+    JavaVM *jvm;
+    jobject db;
+};
+
+// The readers want a shared pointer to the package, so that's what we hang on to
+typedef JavaClassInfo<GeoPackageRef> GeoPackageClassInfo;
+template<> GeoPackageClassInfo *GeoPackageClassInfo::classInfoObj = NULL;
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoPackage_nativeInit
+(JNIEnv *env, jclass cls)
+{
+    GeoPackageClassInfo::getClassInfo(env,cls);
+
+    jclass dbClass = env->FindClass("android/database/sqlite/SQLiteDatabase");
+    sqliteDatabaseClass = (jclass)env->NewGlobalRef(dbClass);
+    openDatabaseMethod = env->GetStaticMethodID(dbClass,"openDatabase","(Ljava/lang/String;Landroid/database/sqlite/SQLiteDatabase$CursorFactory;I)Landroid/database/sqlite/SQLiteDatabase;");
+    rawQueryMethod = env->GetMethodID(dbClass,"rawQuery","(Ljava/lang/String;[Ljava/lang/String;)Landroid/database/Cursor;");
+    dbCloseMethod = env->GetMethodID(dbClass,"close","()V");
+    env->DeleteLocalRef(dbClass);
+
+    jclass cursorClass = env->FindClass("android/database/Cursor");
+    moveToNextMethod = env->GetMethodID(cursorClass,"moveToNext","()Z");
+    getColumnCountMethod = env->GetMethodID(cursorClass,"getColumnCount","()I");
+    getColumnNameMethod = env->GetMethodID(cursorClass,"getColumnName","(I)Ljava/lang/String;");
+    getTypeMethod = env->GetMethodID(cursorClass,"getType","(I)I");
+    getLongMethod = env->GetMethodID(cursorClass,"getLong","(I)J");
+    getDoubleMethod = env->GetMethodID(cursorClass,"getDouble","(I)D");
+    getStringMethod = env->GetMethodID(cursorClass,"getString","(I)Ljava/lang/String;");
+    getBlobMethod = env->GetMethodID(cursorClass,"getBlob","(I)[B");
+    cursorCloseMethod = env->GetMethodID(cursorClass,"close","()V");
+    env->DeleteLocalRef(cursorClass);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_GeoPackage_initialise
+(JNIEnv *env, jobject obj, jstring fileNameStr, jint maxConnections)
+{
+    try
+    {
+        JavaVM *jvm = NULL;
+        env->GetJavaVM(&jvm);
+        std::string fileName;
+        {
+            JavaString fileNameJStr(env,fileNameStr);
+            fileName = fileNameJStr.cStr;
+        }
+
+        // Each connection in the pool is its own read only database
+        GeoPackageRef gpkg(new GeoPackage([jvm,fileName]() { return AndroidGeoPackageConnection::Open(jvm,fileName); },
+                                          maxConnections));
+        if (!gpkg->open())
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "GeoPackage: %s", gpkg->getError().c_str());
+            return false;
+        }
+
+        GeoPackageClassInfo::getClassInfo()->setHandle(env,obj,new GeoPackageRef(gpkg));
+
+        return true;
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoPackage::initialise()");
+    }
+
+    return false;
+}
+
+static std::mutex disposeMutex;
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoPackage_dispose
+(JNIEnv *env, jobject obj)
+{
+    try
+    {
+        GeoPackageClassInfo *classInfo = GeoPackageClassInfo::getClassInfo();
+        {
+            std::lock_guard<std::mutex> lock(disposeMutex);
+            GeoPackageRef *inst = classInfo->getObject(env,obj);
+            if (!inst)
+                return;
+            delete inst;
+
+            classInfo->clearHandle(env,obj);
+        }
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoPackage::dispose()");
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_GeoPackage_getFeatureTables
+(JNIEnv *env, jobject obj)
+{
+    try
+    {
+        GeoPackageRef *inst = GeoPackageClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return NULL;
+
+        std::vector<std::string> tableNames;
+        for (const GeoPackageContents &contents : (*inst)->getContents())
+            if (contents.dataType == "features")
+                tableNames.push_back(contents.tableName);
+
+        jclass stringClass = env->FindClass("java/lang/String");
+        jobjectArray retArr = env->NewObjectArray(tableNames.size(), stringClass, NULL);
+        for (unsigned int ii=0;ii<tableNames.size();ii++)
+        {
+            jstring tableName = env->NewStringUTF(tableNames[ii].c_str());
+            env->SetObjectArrayElement(retArr, ii, tableName);
+            env->DeleteLocalRef(tableName);
+        }
+        env->DeleteLocalRef(stringClass);
+
+        return retArr;
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoPackage::getFeatureTables()");
+    }
+
+    return NULL;
+}
+
+JNIEXPORT jobject JNICALL Java_com_mousebird_maply_GeoPackage_readFeaturesNative
+(JNIEnv *env, jobject obj, jstring tableNameStr, jboolean hasBounds, jdouble llX, jdouble llY, jdouble urX, jdouble urY)
+{
+    try
+    {
+        GeoPackageRef *inst = GeoPackageClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return NULL;
+
+        JavaString tableName(env,tableNameStr);
+        GeoPackageFeatureReader reader(*inst,tableName.cStr);
+        if (!reader.isValid())
+            return NULL;
+        if (hasBounds)
+            reader.setGeoBounds(GeoMbr(GeoCoord(llX,llY),GeoCoord(urX,urY)));
+
+        VectorObject *vecObj = new VectorObject();
+        reader.readAll(vecObj->shapes);
+
+        return MakeVectorObject(env,vecObj);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoPackage::readFeaturesNative()");
+    }
+
+    return NULL;
+}
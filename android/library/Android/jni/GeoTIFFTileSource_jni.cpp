@@ -0,0 +1,192 @@
+/*
+ *  GeoTIFFTileSource_jni.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <jni.h>
+#import "Maply_jni.h"
+#import "com_mousebird_maply_GeoTIFFTileSource.h"
+#import "WhirlyGlobe.h"
+
+using namespace WhirlyKit;
+
+// Deepest quad tree we'll consider before asking the file how far down it's worth going
+static const int GeoTIFFMaxLevels = 24;
+
+typedef JavaClassInfo<GeoTIFFTileSource> GeoTIFFTileSourceClassInfo;
+template<> GeoTIFFTileSourceClassInfo *GeoTIFFTileSourceClassInfo::classInfoObj = NULL;
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_nativeInit
+(JNIEnv *env, jclass cls)
+{
+    GeoTIFFTileSourceClassInfo::getClassInfo(env,cls);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_initialise
+(JNIEnv *env, jobject obj, jstring fileNameStr, jobject coordSysObj, jdouble llX, jdouble llY, jdouble urX, jdouble urY, jint tileSize)
+{
+    try
+    {
+        CoordSystem *coordSys = CoordSystemClassInfo::getClassInfo()->getObject(env,coordSysObj);
+        if (!coordSys)
+            return false;
+
+        JavaString fileName(env,fileNameStr);
+        GeoTIFFFileRef file(new GeoTIFFFile());
+        if (!file->open(fileName.cStr))
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "GeoTIFFTileSource: %s", file->getError().c_str());
+            return false;
+        }
+
+        // Usual quad tree over the destination, the same one the layer builds
+        TileMatrixSetRef tileMatrixSet = TileMatrixSet::MakeQuadTree(Point2d(llX,llY),Point2d(urX,urY),GeoTIFFMaxLevels);
+        GeoTIFFTileSource *inst = new GeoTIFFTileSource(file,coordSys,tileMatrixSet,tileSize);
+        GeoTIFFTileSourceClassInfo::getClassInfo()->setHandle(env,obj,inst);
+
+        return true;
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::initialise()");
+    }
+
+    return false;
+}
+
+static std::mutex disposeMutex;
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_dispose
+(JNIEnv *env, jobject obj)
+{
+    try
+    {
+        GeoTIFFTileSourceClassInfo *classInfo = GeoTIFFTileSourceClassInfo::getClassInfo();
+        {
+            std::lock_guard<std::mutex> lock(disposeMutex);
+            GeoTIFFTileSource *inst = classInfo->getObject(env,obj);
+            if (!inst)
+                return;
+            delete inst;
+
+            classInfo->clearHandle(env,obj);
+        }
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::dispose()");
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_getMaxLevel
+(JNIEnv *env, jobject obj)
+{
+    try
+    {
+        GeoTIFFTileSource *inst = GeoTIFFTileSourceClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return 0;
+
+        return inst->calcMaxLevel();
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::getMaxLevel()");
+    }
+
+    return 0;
+}
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_setBilinear
+(JNIEnv *env, jobject obj, jboolean bilinear)
+{
+    try
+    {
+        GeoTIFFTileSource *inst = GeoTIFFTileSourceClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return;
+
+        inst->setBilinear(bilinear);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::setBilinear()");
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_setSampleGrid
+(JNIEnv *env, jobject obj, jint sampleGrid)
+{
+    try
+    {
+        GeoTIFFTileSource *inst = GeoTIFFTileSourceClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return;
+
+        inst->setSampleGrid(sampleGrid);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::setSampleGrid()");
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_tileOverlaps
+(JNIEnv *env, jobject obj, jint x, jint y, jint level)
+{
+    try
+    {
+        GeoTIFFTileSource *inst = GeoTIFFTileSourceClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return false;
+
+        return inst->tileOverlaps(Quadtree::Identifier(x,y,level));
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::tileOverlaps()");
+    }
+
+    return false;
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_fetchTileNative
+(JNIEnv *env, jobject obj, jint x, jint y, jint level)
+{
+    try
+    {
+        GeoTIFFTileSource *inst = GeoTIFFTileSourceClassInfo::getClassInfo()->getObject(env,obj);
+        if (!inst)
+            return NULL;
+
+        RawDataRef tileData = inst->fetchTile(Quadtree::Identifier(x,y,level));
+        if (!tileData || tileData->getLen() == 0)
+            return NULL;
+
+        jbyteArray retArray = env->NewByteArray(tileData->getLen());
+        env->SetByteArrayRegion(retArray,0,tileData->getLen(),(const jbyte *)tileData->getRawData());
+
+        return retArray;
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in GeoTIFFTileSource::fetchTileNative()");
+    }
+
+    return NULL;
+}
@@ -0,0 +1,103 @@
+/*
+ *  IntersectionManager_jni.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <jni.h>
+#import "Maply_jni.h"
+#import "com_mousebird_maply_IntersectionManager.h"
+#import "WhirlyGlobe.h"
+
+using namespace WhirlyKit;
+
+typedef JavaClassInfo<IntersectionManager> IntersectionManagerClassInfo;
+template<> IntersectionManagerClassInfo *IntersectionManagerClassInfo::classInfoObj = NULL;
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_IntersectionManager_nativeInit
+(JNIEnv *env, jclass cls)
+{
+    IntersectionManagerClassInfo::getClassInfo(env,cls);
+}
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_IntersectionManager_initialise
+(JNIEnv *env, jobject obj, jobject sceneObj)
+{
+    try
+    {
+        Scene *scene = SceneClassInfo::getClassInfo()->getObject(env, sceneObj);
+        if (!scene)
+            return;
+        IntersectionManager *intersectManager = dynamic_cast<IntersectionManager *>(scene->getManager(kWKIntersectionManager));
+        IntersectionManagerClassInfo::getClassInfo()->setHandle(env,obj,intersectManager);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in IntersectionManager::initialise()");
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_IntersectionManager_dispose
+(JNIEnv *env, jobject obj)
+{
+    try
+    {
+        IntersectionManagerClassInfo::getClassInfo()->clearHandle(env,obj);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in IntersectionManager::dispose()");
+    }
+}
+
+JNIEXPORT jdoubleArray JNICALL Java_com_mousebird_maply_IntersectionManager_findIntersection
+(JNIEnv *env, jobject obj, jobject sceneObj, jobject viewObj, jobject rendererObj, jobject frameLocObj, jobject frameSizeObj)
+{
+    try
+    {
+        IntersectionManager *intersectManager = IntersectionManagerClassInfo::getClassInfo()->getObject(env,obj);
+        Scene *scene = SceneClassInfo::getClassInfo()->getObject(env,sceneObj);
+        View *view = ViewClassInfo::getClassInfo()->getObject(env,viewObj);
+        SceneRendererES *renderer = (SceneRendererES *)MaplySceneRendererInfo::getClassInfo()->getObject(env,rendererObj);
+        Point2d *frameLoc = Point2dClassInfo::getClassInfo()->getObject(env,frameLocObj);
+        Point2d *frameSize = Point2dClassInfo::getClassInfo()->getObject(env,frameSizeObj);
+        if (!intersectManager || !scene || !view || !renderer || !frameLoc || !frameSize)
+            return NULL;
+
+        IntersectionManager::IntersectionHit hit;
+        if (!intersectManager->findIntersection(renderer,view,Point2f(frameSize->x(),frameSize->y()),Point2f(frameLoc->x(),frameLoc->y()),hit))
+            return NULL;
+
+        // Back out to geographic and meters, the reverse of how the elevation manager builds its surfaces
+        CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+        Point3d localPt = coordAdapter->displayToLocal(hit.pt);
+        GeoCoord geoPt = coordAdapter->getCoordSystem()->localToGeographic(localPt);
+        double elev = coordAdapter->isFlat() ? localPt.z() * EarthRadius : localPt.z();
+
+        double vals[4] = {geoPt.x(),geoPt.y(),elev,hit.dist};
+        jdoubleArray retArray = env->NewDoubleArray(4);
+        env->SetDoubleArrayRegion(retArray,0,4,vals);
+
+        return retArray;
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in IntersectionManager::findIntersection()");
+    }
+
+    return NULL;
+}
@@ -49,7 +49,7 @@ public:
             // Methods can be saved without consequence
             jclass theClass = env->GetObjectClass(clusterObj);
             startClusterGroupJava = env->GetMethodID(theClass, "startClusterGroup", "()V");
-            makeClusterGroupJNIJava = env->GetMethodID(theClass, "makeClusterGroupJNI", "(I)J");
+            makeClusterGroupJNIJava = env->GetMethodID(theClass, "makeClusterGroupJNI", "(ILjava/lang/String;[Ljava/lang/String;[Ljava/lang/String;[D[Ljava/lang/String;)J");
             endClusterGroupJava = env->GetMethodID(theClass, "endClusterGroup", "()V");
             env->DeleteLocalRef(theClass);
         }
@@ -106,11 +106,92 @@ public:
         clusterGens.insert(clusterInfo);
     }
     
+    // Add an aggregate for the given cluster generator to compute
+    void addClusterStat(int clusterID,const ClusterStatDef &statDef)
+    {
+        clusterStatDefs[clusterID].push_back(statDef);
+    }
+
     void clearClusterGenerators()
     {
         for (auto &ci : clusterGens)
             ci.clear(env);
         clusterGens.clear();
+        clusterStatDefs.clear();
+    }
+
+    // Java string from a C++ one, or null if it's empty
+    jstring makeStringOrNull(const std::string &str)
+    {
+        return str.empty() ? NULL : env->NewStringUTF(str.c_str());
+    }
+
+    // Flatten the aggregates into rows for the Java side.
+    // Category counts have a category, first by priority values have a string and the rest are numeric.
+    void makeStatRows(const ClusterStats &stats,jobjectArray &namesArray,jobjectArray &catsArray,jdoubleArray &valsArray,jobjectArray &strsArray)
+    {
+        std::vector<int> rowStat;
+        std::vector<std::string> rowCats;
+        std::vector<double> rowVals;
+        for (int ii=0;ii<stats.numStats();ii++)
+        {
+            const ClusterStatDef &def = stats.getDef(ii);
+            switch (def.type)
+            {
+                case ClusterStatCountByCategory:
+                    for (auto it : stats.getCategoryCounts(ii))
+                    {
+                        rowStat.push_back(ii);
+                        rowCats.push_back(it.first);
+                        rowVals.push_back(it.second);
+                    }
+                    break;
+                case ClusterStatFirstByPriority:
+                    if (stats.getNumValues(ii) > 0)
+                    {
+                        rowStat.push_back(ii);
+                        rowCats.push_back(std::string());
+                        rowVals.push_back(0.0);
+                    }
+                    break;
+                default:
+                    if (stats.getNumValues(ii) > 0)
+                    {
+                        rowStat.push_back(ii);
+                        rowCats.push_back(std::string());
+                        rowVals.push_back(stats.getValue(ii));
+                    }
+                    break;
+            }
+        }
+
+        jclass stringClass = env->FindClass("java/lang/String");
+        namesArray = env->NewObjectArray(rowStat.size(), stringClass, NULL);
+        catsArray = env->NewObjectArray(rowStat.size(), stringClass, NULL);
+        strsArray = env->NewObjectArray(rowStat.size(), stringClass, NULL);
+        env->DeleteLocalRef(stringClass);
+        valsArray = env->NewDoubleArray(rowVals.size());
+        if (!rowVals.empty())
+            env->SetDoubleArrayRegion(valsArray, 0, rowVals.size(), &rowVals[0]);
+
+        for (unsigned int ii=0;ii<rowStat.size();ii++)
+        {
+            const ClusterStatDef &def = stats.getDef(rowStat[ii]);
+            jstring nameStr = env->NewStringUTF(def.getName().c_str());
+            env->SetObjectArrayElement(namesArray, ii, nameStr);
+            env->DeleteLocalRef(nameStr);
+            if (def.type == ClusterStatCountByCategory)
+            {
+                jstring catStr = env->NewStringUTF(rowCats[ii].c_str());
+                env->SetObjectArrayElement(catsArray, ii, catStr);
+                env->DeleteLocalRef(catStr);
+            } else if (def.type == ClusterStatFirstByPriority)
+            {
+                jstring firstStr = env->NewStringUTF(stats.getFirstValue(rowStat[ii]).c_str());
+                env->SetObjectArrayElement(strsArray, ii, firstStr);
+                env->DeleteLocalRef(firstStr);
+            }
+        }
     }
 
     /** ClusterGenerator virtual methods.
@@ -127,7 +208,7 @@ public:
     }
 
     // Ask the appropriate cluster generator to make a cluster image
-    void makeLayoutObject(int clusterID, const std::vector<LayoutObjectEntry *> &layoutObjects, LayoutObject &retObj)
+    void makeLayoutObject(int clusterID, const std::vector<LayoutObjectEntry *> &layoutObjects, const ClusterStats &stats, LayoutObject &retObj)
     {
         ClusterInfo dummyInfo;
         dummyInfo.clusterID = clusterID;
@@ -149,7 +230,17 @@ public:
         SimpleIdentity progID = sampleObj->getTypicalProgramID();
 
         // The texture gets created on the Java side, so we'll just use the ID
-        long texID = env->CallLongMethod(clusterGenerator.clusterObj, clusterGenerator.makeClusterGroupJNIJava, layoutObjects.size());
+        // The aggregates make the key for reusing cluster images
+        jstring statsKey = env->NewStringUTF(stats.getKey().c_str());
+        jobjectArray statNames,statCats,statStrs;
+        jdoubleArray statVals;
+        makeStatRows(stats,statNames,statCats,statVals,statStrs);
+        long texID = env->CallLongMethod(clusterGenerator.clusterObj, clusterGenerator.makeClusterGroupJNIJava, (jint)layoutObjects.size(), statsKey, statNames, statCats, statVals, statStrs);
+        env->DeleteLocalRef(statsKey);
+        env->DeleteLocalRef(statNames);
+        env->DeleteLocalRef(statCats);
+        env->DeleteLocalRef(statVals);
+        env->DeleteLocalRef(statStrs);
         
         Point2d size = clusterGenerator.layoutSize;
         
@@ -214,6 +305,9 @@ public:
         // Note: Make this selectable
         clusterParams.markerAnimationTime = 0.2;
         clusterParams.clusterSize = it->layoutSize;
+        auto statIt = clusterStatDefs.find(clusterID);
+        if (statIt != clusterStatDefs.end())
+            clusterParams.statDefs = statIt->second;
     }
 
 public:
@@ -223,6 +317,8 @@ public:
     
     SimpleIdentity motionShaderID;
     ClusterInfoSet clusterGens;
+    // Aggregates each cluster generator wants, by cluster ID
+    std::map<int,std::vector<ClusterStatDef> > clusterStatDefs;
     JNIEnv *env;
 };
 
@@ -354,6 +450,40 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_LayoutManager_addClusterGenerato
     }
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_LayoutManager_addClusterStat
+(JNIEnv *env, jobject obj, jint clusterID, jint type, jstring attrNameStr, jstring nameStr, jstring priorityAttrStr, jdouble keyBucket)
+{
+    try
+    {
+        LayoutManagerWrapperClassInfo *classInfo = LayoutManagerWrapperClassInfo::getClassInfo();
+        LayoutManagerWrapper *wrap = classInfo->getObject(env, obj);
+        if (!wrap || !attrNameStr)
+            return;
+        wrap->setEnv(env);
+
+        ClusterStatDef statDef((ClusterStatType)type,"");
+        JavaString attrName(env,attrNameStr);
+        statDef.attrName = attrName.cStr;
+        if (nameStr)
+        {
+            JavaString name(env,nameStr);
+            statDef.name = name.cStr;
+        }
+        if (priorityAttrStr)
+        {
+            JavaString priorityAttr(env,priorityAttrStr);
+            statDef.priorityAttr = priorityAttr.cStr;
+        }
+        statDef.keyBucket = keyBucket;
+
+        wrap->addClusterStat(clusterID,statDef);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in LayoutManager::addClusterStat()");
+    }
+}
+
 JNIEXPORT void JNICALL Java_com_mousebird_maply_LayoutManager_clearClusterGenerators
 (JNIEnv *env, jobject obj)
 {
@@ -492,5 +492,7 @@ void ConvertFloat3dArray(JNIEnv *env,jdoubleArray &floatArray,std::vector<Eigen:
 void ConvertFloat4fArray(JNIEnv *env,jfloatArray &floatArray,std::vector<Eigen::Vector4f> &ptVec);
 // Convert a Java long long array into a set of SimpleIdentity values
 void ConvertLongArrayToSet(JNIEnv *env,jlongArray &longArray,std::set<WhirlyKit::SimpleIdentity> &intSet);
+// Convert the level data from a Java TileMatrixSet into the real thing.  Empty if there are no levels.
+WhirlyKit::TileMatrixSetRef ConvertTileMatrixSet(JNIEnv *env,jdoubleArray &levelArray);
 
 #endif /* Maply_JNI_h_ */
@@ -38,6 +38,7 @@ public:
 	Scene *scene;
 	SceneRendererES *renderer;
 	CoordSystem *coordSys;
+	TileMatrixSetRef tileMatrixSet;
 	int minZoom,maxZoom;
 	int simultaneousFetches;
 	bool useTargetZoomLevel;
@@ -58,6 +59,7 @@ public:
 	float fade;
 	RGBAColor color;
 	int imageFormat;
+	GLenum interpType;
 	float currentImage;
 	bool animationWrap;
 	int maxCurrentImage;
@@ -69,8 +71,9 @@ public:
 	int tileSize;
 	std::vector<int> levelLoads;
 	ViewState *lastViewState;
-        std::string shaderName;
-        SimpleIdentity shaderID;
+    std::string shaderName;
+    SimpleIdentity shaderID;
+    SimpleIdentity renderTargetID;
     JavaVM* jvm;
 
 	// Methods for Java quad image layer
@@ -80,9 +83,10 @@ public:
 		: env(NULL), javaObj(NULL), renderer(NULL), coordSys(coordSys),
 		  simultaneousFetches(1), tileLoader(NULL), minVis(0.0), maxVis(10.0),
 		  handleEdges(true),coverPoles(false), drawPriority(0),imageDepth(1),
-		  borderTexel(0),textureAtlasSize(2048),enable(true),fade(1.0),color(255,255,255,255),imageFormat(0),
+		  borderTexel(0),textureAtlasSize(2048),enable(true),fade(1.0),color(255,255,255,255),imageFormat(0), interpType(GL_LINEAR),
 		  currentImage(0.0), animationWrap(true), maxCurrentImage(-1), allowFrameLoading(true), animationPeriod(10.0),
-		  maxTiles(256), importanceScale(1.0), tileSize(256), lastViewState(NULL), shaderID(EmptyIdentity), scene(NULL), control(NULL),scheduleEvalStepJava(0)
+		  maxTiles(256), importanceScale(1.0), tileSize(256), lastViewState(NULL), shaderID(EmptyIdentity), renderTargetID(EmptyIdentity),
+		  scene(NULL), control(NULL),scheduleEvalStepJava(0)
 	{
 		useTargetZoomLevel = true;
         canShortCircuitImportance = false;
@@ -130,6 +134,7 @@ public:
 	    tileLoader->setTextureAtlasSize(textureAtlasSize);
 	    ChangeSet changes;
 	    tileLoader->setEnable(enable,changes);
+	    tileLoader->setInterType(interpType);
 //	    tileLoader->setFade(fade,changes);
 	    tileLoader->setUseTileCenters(false);
 	    switch (imageFormat)
@@ -207,6 +212,8 @@ public:
 	    // This will force the shader setup
 	    if (!shaderName.empty())
 	      setShaderName(shaderName);
+	    if (renderTargetID != EmptyIdentity)
+	        setRenderTarget(renderTargetID);
 	    setCurrentImage(currentImage,changes);
 
 	    return tileLoader;
@@ -261,15 +268,22 @@ public:
 	    animationPeriod = newAnimationPeriod;
 	}
 
-        void setShaderName(const std::string &newName)
+    void setShaderName(const std::string &newName)
+    {
+        shaderName = newName;
+        if (scene && tileLoader)
         {
-	  shaderName = newName;
-	  if (scene && tileLoader)
-	  {
-	      shaderID = scene->getProgramIDBySceneName(shaderName.c_str());
-	      tileLoader->setProgramId(shaderID);
-	  }
-        }    
+          shaderID = scene->getProgramIDBySceneName(shaderName.c_str());
+          tileLoader->setProgramId(shaderID);
+        }
+    }
+
+    void setRenderTarget(SimpleIdentity targetID)
+    {
+	    renderTargetID = targetID;
+	    if (tileLoader)
+	        tileLoader->setRenderTarget(targetID);
+    }
 
 	// Change which image is displayed (or interpolation thereof)
 	void setCurrentImage(float newCurrentImage,ChangeSet &changes)
@@ -300,7 +314,7 @@ public:
         
         changes.push_back(new SetProgramValueReq(shaderID,"u_interp",t));
 	}
-    
+
     void setColor(const RGBAColor &newColor)
     {
         color = newColor;
@@ -340,6 +354,12 @@ public:
     	return maxZoom;
     }
 
+    /// Tile matrix set from the tile source, if it doesn't use the usual quad tree
+    virtual TileMatrixSetRef getTileMatrixSet()
+    {
+        return tileMatrixSet;
+    }
+
     /// Return an importance value for the given tile
     virtual double importanceForTile(const Quadtree::Identifier &ident,const Mbr &mbr,ViewState *viewState,const Point2f &frameSize,Dictionary *attrs)
     {
@@ -376,17 +396,18 @@ public:
             if (TileIsOnScreen(viewState, frameSize, coordSys, scene->getCoordAdapter(), mbr, ident, attrs))
             {
                 import = 1.0/(ident.level+10);
+                import *= importanceScale;
                 if (ident.level <= maxShortCircuitLevel)
                     import += 1.0;
             }
-            import *= importanceScale;
         } else {
         	// Note: Porting
 //            if (elevDelegate)
 //            {
 //                import = ScreenImportance(viewState, frameSize, thisTileSize, coordSys, scene->getCoordAdapter(), mbr, _minElev, _maxElev, ident, attrs);
 //            } else {
-        	    import = ScreenImportance(viewState, frameSize, viewState->eyeVec, thisTileSize, coordSys, scene->getCoordAdapter(), mbr, ident, attrs);
+            // The tile matrix set knows the tile's extents and how big its level's tiles are
+        	    import = control->getQuadtree()->getTileMatrixSet()->screenImportance(viewState, frameSize, thisTileSize, coordSys, scene->getCoordAdapter(), ident, attrs);
 //            }
             import *= importanceScale;
         }
@@ -457,6 +478,7 @@ public:
                 }
             Dictionary attrs;
             float import = ScreenImportance(viewState, frameSize, viewState->eyeVec, 1, coordSys, scene->getCoordAdapter(), mbr, ident, &attrs);
+            import *= importanceScale;
             if (import <= shortCircuitImportance)
             {
                 zoomLevel--;
@@ -551,6 +573,21 @@ public:
     	}
     }
 
+    /// The tile loaded along with a grid of elevation samples (top row first) covering it
+    void tileLoaded(int level,int col,int row,int frame,RawDataRef imgData,int width,int height,const float *elevData,int elevSizeX,int elevSizeY,ChangeSet &changes)
+    {
+        Quadtree::Identifier ident(col,row,level);
+        Point2d ll,ur;
+        control->getQuadtree()->generateMbrForNode(ident,ll,ur);
+        ElevationGridTileRef elevTile(new ElevationGridTile(ident,ll,ur,elevSizeX,elevSizeY,elevData));
+
+        std::vector<LoadedImage *> images;
+        ImageWrapper tileWrapper(imgData,width,height);
+        if (imgData)
+            images.push_back(&tileWrapper);
+        tileLoader->loadedImages(this, images, elevTile, level, col, row, frame, changes);
+    }
+
     /// The tile loaded correctly (or didn't if it's null)
     void tileLoaded(int level,int col,int row,int frame,std::vector<RawDataRef> &imgData,int width,int height,ChangeSet &changes)
     {
@@ -685,6 +722,29 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setEnable
 	}
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setTileMatrixSetNative
+  (JNIEnv *env, jobject obj, jdoubleArray levelArray)
+{
+	try
+	{
+		QILAdapterClassInfo *classInfo = QILAdapterClassInfo::getClassInfo();
+		QuadImageLayerAdapter *adapter = classInfo->getObject(env,obj);
+		if (!adapter)
+			return;
+		// The quad tree is built from this when the layer starts, so it can't change after
+		if (adapter->control)
+		{
+			__android_log_print(ANDROID_LOG_VERBOSE, "Maply", "QuadImageTileLayer::setTileMatrixSet() called after the layer started.  Ignoring.");
+			return;
+		}
+		adapter->tileMatrixSet = ConvertTileMatrixSet(env,levelArray);
+	}
+	catch (...)
+	{
+		__android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadImageTileLayer::setTileMatrixSetNative()");
+	}
+}
+
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setDrawPriority
   (JNIEnv *env, jobject obj, jint drawPriority)
 {
@@ -1007,6 +1067,23 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setImageForma
 	}
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setInterpType
+        (JNIEnv *env, jobject obj, jint interpType)
+{
+    try
+    {
+        QILAdapterClassInfo *classInfo = QILAdapterClassInfo::getClassInfo();
+        QuadImageLayerAdapter *adapter = classInfo->getObject(env,obj);
+        if (!adapter)
+            return;
+        adapter->interpType = interpType == 0 ? GL_NEAREST : GL_LINEAR;
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadImageTileLayer::setInterpType()");
+    }
+}
+
 JNIEXPORT jint JNICALL Java_com_mousebird_maply_QuadImageTileLayer_getBorderTexel
   (JNIEnv *env, jobject obj)
 {
@@ -1107,6 +1184,24 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setShaderName
     }
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setRenderTargetNative
+        (JNIEnv *env, jobject obj, jlong targetID)
+{
+    try
+    {
+        QILAdapterClassInfo *classInfo = QILAdapterClassInfo::getClassInfo();
+        QuadImageLayerAdapter *adapter = classInfo->getObject(env,obj);
+        if (!adapter)
+            return;
+
+        adapter->setRenderTarget(targetID);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadImageTileLayer::setRenderTargetNative()");
+    }
+}
+
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_reload
   (JNIEnv *env, jobject obj, jobject changeSetObj)
 {
@@ -1428,6 +1523,50 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDid
     }
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDidLoadElev
+(JNIEnv *env, jobject obj, jint x, jint y, jint level, jint frame, jobject bitmapObj, jfloatArray elevArray, jint elevSizeX, jint elevSizeY, jobject changesObj)
+{
+    try
+    {
+        QuadImageLayerAdapter *adapter = QILAdapterClassInfo::getClassInfo()->getObject(env,obj);
+        ChangeSet *changes = ChangeSetClassInfo::getClassInfo()->getObject(env,changesObj);
+        if (!adapter || !changes || !elevArray)
+            return;
+
+        if (elevSizeX < 2 || elevSizeY < 2 || env->GetArrayLength(elevArray) < elevSizeX*elevSizeY)
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Elevation samples don't match their size in QuadImageTileLayer::nativeTileDidLoadElev()");
+            return;
+        }
+
+        AndroidBitmapInfo info;
+        if (AndroidBitmap_getInfo(env, bitmapObj, &info) < 0)
+            return;
+        if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888)
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Only dealing with 8888 bitmaps in QuadImageTileLayer");
+            return;
+        }
+        void* bitmapPixels;
+        if (AndroidBitmap_lockPixels(env, bitmapObj, &bitmapPixels) < 0)
+            return;
+
+        if (info.height > 0 && info.width > 0)
+        {
+            RawDataRef rawDataRef(new MutableRawData(bitmapPixels,info.height*info.width*4));
+            jfloat *elevData = env->GetFloatArrayElements(elevArray, NULL);
+            adapter->tileLoaded(level,x,y,frame,rawDataRef,info.width,info.height,elevData,elevSizeX,elevSizeY,*changes);
+            env->ReleaseFloatArrayElements(elevArray, elevData, JNI_ABORT);
+        }
+
+        AndroidBitmap_unlockPixels(env, bitmapObj);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadImageTileLayer::nativeTileDidLoadElev()");
+    }
+}
+
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDidNotLoad
   (JNIEnv *env, jobject obj, jint x, jint y, jint level, jint frame, jobject changesObj)
 {
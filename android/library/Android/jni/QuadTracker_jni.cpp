@@ -150,6 +150,24 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadTracker_removeTile
     }
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadTracker_setTileMatrixSetNative
+(JNIEnv *env, jobject obj, jdoubleArray levelArray)
+{
+    try
+    {
+        QuadTrackerClassInfo *classInfo = QuadTrackerClassInfo::getClassInfo();
+        QuadTracker *inst = classInfo->getObject(env, obj);
+        if (!inst)
+            return;
+        
+        inst->setTileMatrixSet(ConvertTileMatrixSet(env,levelArray));
+    }
+    catch(...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadTracker::setTileMatrixSet()");
+    }
+}
+
 JNIEXPORT jint JNICALL Java_com_mousebird_maply_QuadTracker_getMinLevel
 (JNIEnv *env, jobject obj)
 {
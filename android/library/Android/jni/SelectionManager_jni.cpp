@@ -94,6 +94,25 @@ JNIEXPORT jlong JNICALL Java_com_mousebird_maply_SelectionManager_pickObject
     return EmptyIdentity;
 }
 
+// Wrap the selected objects up for Java.  Returns NULL if there aren't any.
+static jobjectArray MakeSelectedObjectArray(JNIEnv *env,const std::vector<SelectionManager::SelectedObject> &selObjs)
+{
+    if (selObjs.empty())
+        return NULL;
+
+    jobjectArray retArray = env->NewObjectArray(selObjs.size(), SelectedObjectClassInfo::getClassInfo(env,"com/mousebird/maply/SelectedObject")->getClass(), NULL);
+    int which = 0;
+    for (auto &selObj : selObjs)
+    {
+        jobject newObj = MakeSelectedObject(env,selObj);
+        env->SetObjectArrayElement(retArray,which,newObj);
+        env->DeleteLocalRef( newObj);
+        which++;
+    }
+    
+    return retArray;
+}
+
 JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_pickObjects
 (JNIEnv *env, jobject obj, jobject viewObj, jobject pointObj)
 {
@@ -111,24 +130,77 @@ JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_pickObj
         std::vector<SelectionManager::SelectedObject> selObjs;
         selectionManager->pickObjects(Point2f(point->x(),point->y()),10.0,mapView,selObjs);
 
-        if (selObjs.empty())
+        return MakeSelectedObjectArray(env,selObjs);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in SelectionManager::pickObjects()");
+    }
+    
+    return NULL;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_objectsInScreenRegion
+(JNIEnv *env, jobject obj, jobject viewObj, jdoubleArray regionArray)
+{
+    try
+    {
+        SelectionManagerClassInfo *classInfo = SelectionManagerClassInfo::getClassInfo();
+        SelectionManager *selectionManager = classInfo->getObject(env,obj);
+        ViewClassInfo *viewClassInfo = ViewClassInfo::getClassInfo();
+        View *mapView = viewClassInfo->getObject(env,viewObj);
+        if (!selectionManager || !mapView || !regionArray)
             return NULL;
+        
+        // Region comes in as x,y pairs
+        Point2fVector region;
+        int len = env->GetArrayLength(regionArray);
+        jdouble *vals = env->GetDoubleArrayElements(regionArray,NULL);
+        for (int ii=0;ii+1<len;ii+=2)
+            region.push_back(Point2f(vals[ii],vals[ii+1]));
+        env->ReleaseDoubleArrayElements(regionArray,vals,JNI_ABORT);
+        
+        std::vector<SelectionManager::SelectedObject> selObjs;
+        selectionManager->objectsInScreenRegion(region,mapView,selObjs);
+        
+        return MakeSelectedObjectArray(env,selObjs);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in SelectionManager::objectsInScreenRegion()");
+    }
+    
+    return NULL;
+}
 
-        jobjectArray retArray = env->NewObjectArray(selObjs.size(), SelectedObjectClassInfo::getClassInfo(env,"com/mousebird/maply/SelectedObject")->getClass(), NULL);
-        int which = 0;
-        for (auto &selObj : selObjs)
-        {
-            jobject newObj = MakeSelectedObject(env,selObj);
-            env->SetObjectArrayElement(retArray,which,newObj);
-            env->DeleteLocalRef( newObj);
-            which++;
-        }
+JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_objectsInGeoRegion
+(JNIEnv *env, jobject obj, jobject viewObj, jdoubleArray regionArray)
+{
+    try
+    {
+        SelectionManagerClassInfo *classInfo = SelectionManagerClassInfo::getClassInfo();
+        SelectionManager *selectionManager = classInfo->getObject(env,obj);
+        ViewClassInfo *viewClassInfo = ViewClassInfo::getClassInfo();
+        View *mapView = viewClassInfo->getObject(env,viewObj);
+        if (!selectionManager || !mapView || !regionArray)
+            return NULL;
+        
+        // Region comes in as lon,lat pairs in radians
+        Point2dVector region;
+        int len = env->GetArrayLength(regionArray);
+        jdouble *vals = env->GetDoubleArrayElements(regionArray,NULL);
+        for (int ii=0;ii+1<len;ii+=2)
+            region.push_back(Point2d(vals[ii],vals[ii+1]));
+        env->ReleaseDoubleArrayElements(regionArray,vals,JNI_ABORT);
         
-        return retArray;
+        std::vector<SelectionManager::SelectedObject> selObjs;
+        selectionManager->objectsInGeoRegion(region,mapView,selObjs);
+        
+        return MakeSelectedObjectArray(env,selObjs);
     }
     catch (...)
     {
-        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in SelectionManager::pickObjects()");
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in SelectionManager::objectsInGeoRegion()");
     }
     
     return NULL;
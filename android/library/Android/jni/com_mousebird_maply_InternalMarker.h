@@ -103,6 +103,14 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_InternalMarker_setLayoutImportan
 JNIEXPORT void JNICALL Java_com_mousebird_maply_InternalMarker_setVertexAttributes
   (JNIEnv *, jobject, jobjectArray);
 
+/*
+ * Class:     com_mousebird_maply_InternalMarker
+ * Method:    setAttributes
+ * Signature: (Lcom/mousebird/maply/AttrDictionary;)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_InternalMarker_setAttributes
+  (JNIEnv *, jobject, jobject);
+
 /*
  * Class:     com_mousebird_maply_InternalMarker
  * Method:    setClusterGroup
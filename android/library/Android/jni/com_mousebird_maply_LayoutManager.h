@@ -39,6 +39,14 @@ JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_LayoutManager_hasChanges
 JNIEXPORT void JNICALL Java_com_mousebird_maply_LayoutManager_addClusterGenerator
   (JNIEnv *, jobject, jobject, jint, jboolean, jdouble, jdouble);
 
+/*
+ * Class:     com_mousebird_maply_LayoutManager
+ * Method:    addClusterStat
+ * Signature: (IILjava/lang/String;Ljava/lang/String;Ljava/lang/String;D)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_LayoutManager_addClusterStat
+  (JNIEnv *, jobject, jint, jint, jstring, jstring, jstring, jdouble);
+
 /*
  * Class:     com_mousebird_maply_LayoutManager
  * Method:    clearClusterGenerators
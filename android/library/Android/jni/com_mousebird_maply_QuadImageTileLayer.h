@@ -15,6 +15,14 @@ extern "C" {
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setEnable
   (JNIEnv *, jobject, jboolean, jobject);
 
+/*
+ * Class:     com_mousebird_maply_QuadImageTileLayer
+ * Method:    setTileMatrixSetNative
+ * Signature: ([D)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setTileMatrixSetNative
+  (JNIEnv *, jobject, jdoubleArray);
+
 /*
  * Class:     com_mousebird_maply_QuadImageTileLayer
  * Method:    setDrawPriority
@@ -319,6 +327,14 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDid
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDidLoad__IIII_3Landroid_graphics_Bitmap_2Lcom_mousebird_maply_ChangeSet_2
   (JNIEnv *, jobject, jint, jint, jint, jint, jobjectArray, jobject);
 
+/*
+ * Class:     com_mousebird_maply_QuadImageTileLayer
+ * Method:    nativeTileDidLoadElev
+ * Signature: (IIIILandroid/graphics/Bitmap;[FIILcom/mousebird/maply/ChangeSet;)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDidLoadElev
+  (JNIEnv *, jobject, jint, jint, jint, jint, jobject, jfloatArray, jint, jint, jobject);
+
 /*
  * Class:     com_mousebird_maply_QuadImageTileLayer
  * Method:    nativeTileDidNotLoad
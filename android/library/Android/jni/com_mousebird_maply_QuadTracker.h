@@ -31,6 +31,14 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadTracker_addTile
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadTracker_removeTile
   (JNIEnv *, jobject, jint, jint, jint);
 
+/*
+ * Class:     com_mousebird_maply_QuadTracker
+ * Method:    setTileMatrixSetNative
+ * Signature: ([D)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadTracker_setTileMatrixSetNative
+  (JNIEnv *, jobject, jdoubleArray);
+
 /*
  * Class:     com_mousebird_maply_QuadTracker
  * Method:    getMinLevel
@@ -39,6 +39,14 @@ JNIEXPORT jdouble JNICALL Java_com_mousebird_maply_SelectedObject_getScreenDist
 JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_SelectedObject_isPartOfCluster
   (JNIEnv *, jobject);
 
+/*
+ * Class:     com_mousebird_maply_SelectedObject
+ * Method:    getAttributes
+ * Signature: ()Lcom/mousebird/maply/AttrDictionary;
+ */
+JNIEXPORT jobject JNICALL Java_com_mousebird_maply_SelectedObject_getAttributes
+  (JNIEnv *, jobject);
+
 /*
  * Class:     com_mousebird_maply_SelectedObject
  * Method:    nativeInit
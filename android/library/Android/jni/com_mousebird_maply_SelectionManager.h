@@ -23,6 +23,22 @@ JNIEXPORT jlong JNICALL Java_com_mousebird_maply_SelectionManager_pickObject
 JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_pickObjects
   (JNIEnv *, jobject, jobject, jobject);
 
+/*
+ * Class:     com_mousebird_maply_SelectionManager
+ * Method:    objectsInScreenRegion
+ * Signature: (Lcom/mousebird/maply/View;[D)[Lcom/mousebird/maply/SelectedObject;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_objectsInScreenRegion
+  (JNIEnv *, jobject, jobject, jdoubleArray);
+
+/*
+ * Class:     com_mousebird_maply_SelectionManager
+ * Method:    objectsInGeoRegion
+ * Signature: (Lcom/mousebird/maply/View;[D)[Lcom/mousebird/maply/SelectedObject;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_SelectionManager_objectsInGeoRegion
+  (JNIEnv *, jobject, jobject, jdoubleArray);
+
 /*
  * Class:     com_mousebird_maply_SelectionManager
  * Method:    nativeInit
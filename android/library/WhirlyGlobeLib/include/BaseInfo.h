@@ -65,6 +65,8 @@ public:
     TimeInterval fadeOutTime;
     TimeInterval startEnable,endEnable;
     SimpleIdentity programID;
+    /// Memory accounting label for what gets built
+    std::string memLabel;
     
     SingleVertexAttributeSet uniforms;
 };
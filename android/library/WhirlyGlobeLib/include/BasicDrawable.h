@@ -30,6 +30,16 @@
 namespace WhirlyKit
 {
 
+/// A run of vertices and the color they should be
+class VertexColorRange
+{
+public:
+    VertexColorRange(int start,int count,RGBAColor color) : start(start), count(count), color(color) { }
+    
+    int start,count;
+    RGBAColor color;
+};
+
 /** The Basic Drawable is the one we use the most.  It's
  a general purpose container for static geometry which
  may or may not be textured.
@@ -71,6 +81,9 @@ public:
     /// Size of a single vertex used in creating an interleaved buffer.
     virtual GLuint singleVertexSize();
     
+    /// Bytes of geometry and attributes, whether they're still here or out in a buffer
+    virtual unsigned long getMemSize() const;
+    
     /// Called render-thread side to set up a VAO
     virtual GLuint setupVAO(OpenGLES2Program *prog);
     
@@ -190,6 +203,15 @@ public:
     /// Add a color
     virtual void addColor(RGBAColor color);
     
+    /// Keep a copy of the interleaved vertices after they go to OpenGL,
+    ///  so colors can be changed later without rebuilding
+    void setRetainVertexData(bool retain) { retainVertexData = retain; }
+    
+    /// Change the colors for runs of vertices.  This works on the data arrays
+    ///  before setup and on the vertex buffer after, if the vertices were retained.
+    /// Rendering thread only, once we're in the scene.
+    virtual void setVertexColors(const std::vector<VertexColorRange> &ranges);
+    
     /// Add a normal
     virtual void addNormal(const Point3f &norm);
     virtual void addNormal(const Point3d &norm);
@@ -277,6 +299,14 @@ public:
     
     /// Update fade up/down times in renderer (i.e. keep the renderer rendering)
     virtual void updateRenderer(WhirlyKit::SceneRendererES *renderer);
+
+    /// Features of the default triangle shader this needs (ShaderTriangleFeature).
+    /// Used to pick a program when one hasn't been set.
+    /// Ramps and night/day need textures on the program, so those are set up by name instead.
+    virtual int getShaderFeatures() const;
+
+    /// Set if a tweaker projects the texture in screen space
+    bool hasScreenTexture() const;
     
     /// Copy the vertex data into an NSData object and return it
     virtual RawDataRef asData(bool dupStart,bool dupEnd);
@@ -308,6 +338,8 @@ public:
     virtual void bindAdditionalRenderObjects(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene) { }
     /// Called at the end of the drawOGL2() call
     virtual void postDrawCallback(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene) { }
+    /// Issue the draw call for triangles.  Override this to draw more than one copy.
+    virtual void drawTriangleElements(GLsizei numIndices,const GLvoid *indices);
     
     // Attributes associated with each vertex, some standard some not
     std::vector<VertexAttribute *> vertexAttributes;
@@ -357,6 +389,10 @@ public:
     
     // If set the geometry is already in OpenGL clip coordinates, so no transform
     bool clipCoords;
+    
+    // Copy of the interleaved vertices, if we're keeping them for changes
+    bool retainVertexData;
+    std::vector<unsigned char> retainedVerts;
 };
 
 /** Drawable Tweaker that cycles through textures.
@@ -407,6 +443,21 @@ protected:
     unsigned char color[4];
 };
 
+/// Change the colors of runs of vertices within a drawable, leaving the geometry alone
+class VertexColorChangeRequest : public DrawableChangeRequest
+{
+public:
+    VertexColorChangeRequest(SimpleIdentity drawId);
+    
+    /// Add a run of vertices to recolor
+    void addRange(int start,int count,RGBAColor color);
+    
+    void execute2(Scene *scene,WhirlyKit::SceneRendererES *renderer,DrawableRef draw);
+    
+protected:
+    std::vector<VertexColorRange> ranges;
+};
+
 /// Turn a given drawable on or off.  This doesn't delete it.
 class OnOffChangeRequest : public DrawableChangeRequest
 {
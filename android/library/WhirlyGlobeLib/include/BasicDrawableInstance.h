@@ -85,7 +85,15 @@ public:
     virtual bool getWriteZbuffer() const { return writeZBuffer; }
     
     /// Update anything associated with the renderer.  Probably renderUntil.
+    /// Local instances without a program get the default triangle permutation they need.
     virtual void updateRenderer(WhirlyKit::SceneRendererES *renderer);
+
+    /// Features of the default triangle shader this needs (ShaderTriangleFeature).
+    /// Local instances supply their own matrices, for models or screen textures.
+    int getShaderFeatures() const;
+
+    /// Run our tweakers and the ones on the drawable we're instancing
+    virtual void runTweakers(RendererFrameInfo *frame);
     
     /// Fill this in to draw the basic drawable
     virtual void draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene);
@@ -47,4 +47,104 @@ protected:
     int offsetIndex;
 };
 
+// Shader name for the instanced billboards
+#define kBillboardInstanceShaderName "Billboard Instance Shader"
+
+/// Construct and return the instanced billboard shader program
+OpenGLES2Program *BuildBillboardInstanceProgram();
+
+/// Billboards can face the viewer or turn around their up axis (think trees and pins)
+typedef enum {BillboardOrientEye,BillboardOrientGround} BillboardOrient;
+
+/** A single billboard rendered as an instance of a shared quad.
+    The quad is centered on the billboard and runs from -0.5 to 0.5 before scaling.
+  */
+class BillboardInstance
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    BillboardInstance();
+
+    /// Center in display coordinates
+    Point3d center;
+    /// Up axis for ground billboards.  Leave it zero and the manager will fill in the local up.
+    Point3d axis;
+    /// Width and height in display units (ground) or eye space units (eye)
+    Point2f size;
+    /// Offset of the quad from the center, in the same units as size.  Use this to anchor a pin at its base.
+    Point2f offset;
+    /// Rotation in radians, counter-clockwise within the billboard
+    float rotation;
+    /// Face the viewer or turn around the axis
+    BillboardOrient orient;
+    /// Color, multiplied by the texture
+    RGBAColor color;
+    /// Region of the texture (usually an atlas) to use, lower left and upper right
+    TexCoord texLL,texUR;
+};
+
+/** Draws any number of billboards with a single quad and a buffer of per-instance data.
+    Each instance is packed into InstanceSize bytes so big batches can be built quickly.
+    Instances can be changed in place after the buffer is in OpenGL.
+  */
+class BillboardInstanceDrawable : public BasicDrawable
+{
+public:
+    /// Bytes for a single packed instance
+    static const int InstanceSize = 60;
+
+    BillboardInstanceDrawable();
+    virtual ~BillboardInstanceDrawable();
+
+    /// Add instances to the end.  Do this before the drawable is handed over.
+    void addInstances(const std::vector<BillboardInstance> &insts);
+
+    /// Number of instances we'll draw
+    int getNumInstances() const { return numInstances; }
+
+    /// Replace the instances starting at the given index.  Only changes the part of the buffer that's touched.
+    void updateInstances(int start,const std::vector<BillboardInstance> &insts);
+
+    /// Pack instances for the instance buffer, InstanceSize bytes apiece
+    static void PackInstances(const BillboardInstance *insts,int numInsts,unsigned char *basePtr);
+
+    using BasicDrawable::setupGL;
+    /// Set up the quad and the instance buffer
+    virtual void setupGL(WhirlyKitGLSetupInfo *setupInfo,OpenGLMemManager *memManager,GLuint sharedBuf,GLuint sharedBufOffset);
+
+    /// Clean up the instance buffer along with the rest
+    virtual void teardownGL(OpenGLMemManager *memManage);
+
+protected:
+    virtual void setupAdditionalVAO(OpenGLES2Program *prog,GLuint vertArrayObj);
+    virtual void bindAdditionalRenderObjects(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene);
+    virtual void postDrawCallback(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene);
+    virtual void drawTriangleElements(GLsizei numIndices,const GLvoid *indices);
+
+    // Point the instance attributes at the instance buffer (or turn them off)
+    void bindInstanceAttributes(OpenGLES2Program *prog,bool enable);
+
+    int numInstances;
+    // Packed instances waiting for setupGL
+    std::vector<unsigned char> instData;
+    GLuint instBuffer;
+    OpenGLES2Program *boundProg;
+};
+
+typedef std::shared_ptr<BillboardInstanceDrawable> BillboardInstanceDrawableRef;
+
+/// Change some of the instances in a billboard instance drawable
+class BillboardInstanceChangeRequest : public DrawableChangeRequest
+{
+public:
+    BillboardInstanceChangeRequest(SimpleIdentity drawId,int start,const std::vector<BillboardInstance> &insts);
+
+    void execute2(Scene *scene,WhirlyKit::SceneRendererES *renderer,DrawableRef draw);
+
+protected:
+    int start;
+    std::vector<BillboardInstance> insts;
+};
+
 }
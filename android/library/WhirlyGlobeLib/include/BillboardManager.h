@@ -105,6 +105,8 @@ public:
 
     SimpleIDSet drawIDs;  // Drawables created for this
     SimpleIDSet selectIDs;  // IDs used for selection
+    SimpleIdentity instDrawID;  // Instance drawable, if this is a batch of instances
+    int numInstances;  // Instances in that drawable
     float fade;  // Time to fade away for removal
 };
 
@@ -143,9 +145,18 @@ public:
     BillboardManager();
     virtual ~BillboardManager();
 
-    /// Add billboards for display
+    /// Add billboards for display.  If they all share a texture, use one of the default shaders
+    ///  and are made of plain rectangles, they're drawn as instances of a single quad.
     SimpleIdentity addBillboards(std::vector<Billboard*> billboards,BillboardInfo *billboardInfo,SimpleIdentity billShader,ChangeSet &changes);
 
+    /** Add a batch of billboards drawn as instances of one quad.  They all share a texture (usually an atlas)
+        and pick their piece of it with the texture region.  Pass EmptyIdentity for the default instance shader.
+      */
+    SimpleIdentity addBillboardInstances(const std::vector<BillboardInstance> &insts,SimpleIdentity texId,BillboardInfo *billboardInfo,SimpleIdentity billShader,ChangeSet &changes);
+
+    /// Replace the instances in a batch starting at the given index, without rebuilding anything
+    bool changeBillboardInstances(SimpleIdentity billID,int start,const std::vector<BillboardInstance> &insts,ChangeSet &changes);
+
     /// Enable/disable active billboards
     void enableBillboards(SimpleIDSet &billIDs,bool enable,ChangeSet &changes);
 
@@ -153,6 +164,13 @@ public:
     void removeBillboards(SimpleIDSet &billIDs,ChangeSet &changes);
 
 protected:
+    // Fill in the local up for ground billboards that don't have an axis
+    void fillInAxes(std::vector<BillboardInstance> &insts);
+    // Convert billboards to instances, if they can be drawn that way
+    bool billboardsToInstances(const std::vector<Billboard*> &billboards,SimpleIdentity billShader,std::vector<BillboardInstance> &insts,SimpleIdentity &texId);
+    // Build the instance drawable for a batch and note it in the scene rep
+    void addInstanceDrawable(BillboardSceneRep *sceneRep,const std::vector<BillboardInstance> &insts,SimpleIdentity texId,BillboardInfo *billboardInfo,SimpleIdentity billShader,ChangeSet &changes);
+
     pthread_mutex_t billLock;
     BillboardSceneRepSet sceneReps;
 };
@@ -0,0 +1,120 @@
+/*
+ *  ClusterStats.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <map>
+#import <string>
+#import "Dictionary.h"
+
+namespace WhirlyKit
+{
+
+/// Ways to sum up a member attribute over a cluster
+typedef enum {ClusterStatCountByCategory,ClusterStatSum,ClusterStatMin,ClusterStatMax,ClusterStatMean,ClusterStatFirstByPriority} ClusterStatType;
+
+/// One aggregate to compute for every cluster
+class ClusterStatDef
+{
+public:
+    ClusterStatDef();
+    ClusterStatDef(ClusterStatType type,const std::string &attrName);
+
+    /// Name to report it under.  The attribute name if empty.
+    const std::string &getName() const { return name.empty() ? attrName : name; }
+
+    /// How to aggregate
+    ClusterStatType type;
+    /// Member attribute to look at
+    std::string attrName;
+    /// Name to report it under
+    std::string name;
+    /// For first by priority, the numeric attribute to rank members by.  Layout importance if empty.
+    std::string priorityAttr;
+    /// Round numeric results to a multiple of this in the cache key.  Zero for exact.
+    double keyBucket;
+};
+
+/** Aggregates for one cluster.  Members are added as the cluster forms and clusters
+    that run into each other merge their stats, so nothing gets scanned twice.
+    The definitions are owned elsewhere and have to outlive this.
+  */
+class ClusterStats
+{
+public:
+    ClusterStats();
+    ClusterStats(const std::vector<ClusterStatDef> *defs);
+
+    /// Add a single member with its attributes (which may be missing)
+    void addMember(const Dictionary *attrs,double importance);
+
+    /// Fold in another cluster with the same definitions
+    void merge(const ClusterStats &other);
+
+    /// Number of members
+    int getCount() const { return count; }
+
+    /// Number of aggregates
+    int numStats() const { return defs ? (int)defs->size() : 0; }
+
+    /// Definition for a given aggregate
+    const ClusterStatDef &getDef(int which) const { return (*defs)[which]; }
+
+    /// Index of the aggregate with the given name or -1
+    int findStat(const std::string &name) const;
+
+    /// Sum, min, max or mean.  NaN if no member had a value.
+    double getValue(int which) const;
+
+    /// Members that had a value for this aggregate
+    int getNumValues(int which) const;
+
+    /// Value from the member with the highest priority
+    const std::string &getFirstValue(int which) const;
+
+    /// Members in each category
+    const std::map<std::string,int> &getCategoryCounts(int which) const;
+
+    /// Category with the most members.  Ties go to the first alphabetically.
+    std::string getDominantCategory(int which) const;
+
+    /// Key for caching cluster images.  Clusters with the same aggregates get the same key.
+    std::string getKey() const;
+
+protected:
+    // Running totals for one aggregate
+    class Accum
+    {
+    public:
+        Accum();
+
+        int numValues;
+        double sum,minVal,maxVal;
+        bool hasFirst;
+        double firstPriority;
+        std::string firstVal;
+        std::map<std::string,int> categories;
+    };
+
+    const std::vector<ClusterStatDef> *defs;
+    int count;
+    std::vector<Accum> accums;
+};
+
+}
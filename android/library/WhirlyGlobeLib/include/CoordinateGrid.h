@@ -0,0 +1,227 @@
+/*
+ *  CoordinateGrid.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <string>
+#import <map>
+#import <functional>
+#import "WhirlyVector.h"
+#import "VectorData.h"
+#import "Proj4CoordSystem.h"
+
+namespace WhirlyKit
+{
+
+/// Grid lines are major (every few lines), minor, or zone boundaries
+typedef enum {GridLineMajor,GridLineMinor,GridLineZone} GridLineType;
+
+/// Labels go along the left or bottom of the view, or in the middle of a grid cell
+typedef enum {GridLabelLeft,GridLabelBottom,GridLabelCenter} GridLabelPlacement;
+
+/// A single line in a coordinate grid
+class GridLine
+{
+public:
+    GridLine();
+
+    GridLineType type;
+    /// Set for lines of constant X (meridians, eastings), otherwise constant Y
+    bool isX;
+    /// Value along the axis in the grid's own units (degrees, meters)
+    double value;
+    /// Text for the edge label.  Empty for none.
+    std::string label;
+    /// The line itself, geographic in radians
+    VectorRing pts;
+};
+
+/// A label to go with a grid
+class GridLabel
+{
+public:
+    GridLabel();
+
+    /// Where it goes, geographic in radians
+    GeoCoord loc;
+    std::string text;
+    GridLabelPlacement placement;
+};
+
+/** Base class for the coordinate grids.
+    Call update() as the view changes.  Lines are built for an area somewhat larger
+    than the view and at a spacing that suits the zoom level.  As long as the view
+    stays inside that area at the same level, only the edge labels are recalculated.
+  */
+class CoordinateGrid
+{
+public:
+    CoordinateGrid();
+    virtual ~CoordinateGrid();
+
+    /// Spacing between lines we aim for, in pixels.  Default is 100.
+    void setTargetSpacing(double pixels) { targetSpacing = pixels; }
+
+    /// Update for the visible area (radians) and the size of a pixel on the ground (meters) at the center.
+    /// Returns true if the lines were rebuilt.
+    bool update(const GeoMbr &viewMbr,double pixelSize);
+
+    /// The lines from the last update
+    const std::vector<GridLine> &getLines() const { return lines; }
+
+    /// Edge and cell labels from the last update
+    const std::vector<GridLabel> &getLabels() const { return labels; }
+
+    /// Which spacing we picked, 0 being the coarsest
+    int getLevel() const { return level; }
+
+    /// Turn the lines into linear features for the vector manager.
+    /// Each gets a "gridline" attribute of "major", "minor" or "zone" for styling.
+    void makeShapes(ShapeSet &shapes) const;
+
+    /// Formatting for the graticule labels
+    static std::string FormatDegrees(double deg,bool isLon,double step);
+
+protected:
+    /// Pick a level for the given ground distance between lines, in meters
+    virtual int levelForDistance(double meters) = 0;
+    /// Build the lines for an area (geographic radians) at the given level
+    virtual void buildLines(const Mbr &area,int level,std::vector<GridLine> &lines) = 0;
+    /// Labels for the middle of grid cells.  None by default.
+    virtual void buildCellLabels(const Mbr &area,int level,std::vector<GridLabel> &labels) { }
+
+    /// Label the lines where they cross the left and bottom of the view
+    void buildEdgeLabels(const Mbr &view);
+
+    /** Trace lines of constant X and Y through a projected system and keep the
+        parts inside the clip area (geographic radians).
+        Lines stop right at the clip boundary and are broken where they cross the date line.
+      */
+    static void AddProjectedLines(CoordSystem *coordSys,const Mbr &clip,double step,double majorStep,
+                                  const std::function<std::string(bool isX,double value)> &labelFunc,
+                                  std::vector<GridLine> &lines);
+
+    /// A simple line of constant longitude or latitude (radians), sampled so it follows the globe.
+    /// The value is what gets reported for the line, usually in degrees.
+    static void AddGeoLine(bool isX,double coord,double value,double from,double to,GridLineType type,const std::string &label,std::vector<GridLine> &lines);
+
+    double targetSpacing;
+    int level;
+    bool built;
+    std::vector<Mbr> builtAreas;
+    std::vector<GridLine> lines;
+    std::vector<GridLabel> cellLabels;
+    std::vector<GridLabel> labels;
+};
+
+/** Lines of latitude and longitude.
+    Spacing runs from 30 degrees down to a second.  Meridians meet at the poles.
+  */
+class GraticuleGrid : public CoordinateGrid
+{
+public:
+    GraticuleGrid();
+
+    /// Don't draw past this latitude (radians).  Useful for Mercator maps.
+    void setMaxLatitude(double maxLat) { maxLatitude = maxLat; }
+
+protected:
+    virtual int levelForDistance(double meters);
+    virtual void buildLines(const Mbr &area,int level,std::vector<GridLine> &lines);
+
+    double maxLatitude;
+};
+
+/** A grid in any proj.4 coordinate system.
+    Lines fall on round numbers in the system's units (1, 2, 5 and so on).
+  */
+class ProjectedGrid : public CoordinateGrid
+{
+public:
+    /// Construct with the system (which we don't own) and the area it's good for (radians)
+    ProjectedGrid(Proj4CoordSystem *coordSys,const Mbr &validArea,double metersPerUnit = 1.0);
+
+protected:
+    virtual int levelForDistance(double meters);
+    virtual void buildLines(const Mbr &area,int level,std::vector<GridLine> &lines);
+
+    Proj4CoordSystem *coordSys;
+    Mbr validArea;
+    double metersPerUnit;
+    std::vector<double> steps;
+};
+
+/** UTM zones with easting and northing lines.
+    Zones follow the Norway and Svalbard exceptions, and the polar caps past
+    84N and 80S are handled with UPS.
+    Levels are zones only, then 100km, 10km, 1km and 100m lines.
+  */
+class UTMGrid : public CoordinateGrid
+{
+public:
+    UTMGrid();
+    virtual ~UTMGrid();
+
+    /// One cell of the zone and latitude band layout, in degrees
+    class ZoneCell
+    {
+    public:
+        int zone;
+        char band;
+        double minLon,maxLon,minLat,maxLat;
+    };
+
+    /// Every grid zone, including the exceptions and the four polar ones (zone 0)
+    static const std::vector<ZoneCell> &ZoneCells();
+
+    /// Latitude band letter for a latitude in degrees, or 0 outside of UTM
+    static char BandLetter(double lat);
+
+protected:
+    virtual int levelForDistance(double meters);
+    virtual void buildLines(const Mbr &area,int level,std::vector<GridLine> &lines);
+
+    /// Projection for a UTM zone, or UPS for zone 0.  Kept around once made.
+    Proj4CoordSystem *zoneSystem(int zone,bool south);
+    /// Edge label for a line of constant easting or northing
+    virtual std::string lineLabel(bool isX,double value,double step);
+    /// Draw band boundaries as well as zone boundaries
+    virtual bool drawBands() { return false; }
+
+    std::map<int,Proj4CoordSystem *> zoneSystems;
+};
+
+/** MGRS grid.  The same lines as UTM, plus latitude bands, grid zone designators,
+    100km square identifiers and the short digit labels along the edges.
+  */
+class MGRSGrid : public UTMGrid
+{
+public:
+    MGRSGrid();
+
+    /// The two letter 100km square identifier for a UTM location
+    static std::string SquareID(int zone,double easting,double northing);
+
+protected:
+    virtual void buildCellLabels(const Mbr &area,int level,std::vector<GridLabel> &labels);
+    virtual std::string lineLabel(bool isX,double value,double step);
+    virtual bool drawBands() { return true; }
+};
+
+}
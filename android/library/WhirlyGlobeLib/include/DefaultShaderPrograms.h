@@ -20,6 +20,7 @@
 
 #import "OpenGLES2Program.h"
 #import "Scene.h"
+#import "ShaderPermutation.h"
 
 namespace WhirlyKit
 {
@@ -44,10 +45,16 @@ namespace WhirlyKit
 /// Billboard shader
 #define kToolkitDefaultBillboardGroundProgram "Default Billboard ground"
 #define kToolkitDefaultBillboardEyeProgram "Default Billboard eye"
+/// Instanced billboard shader
+#define kToolkitDefaultBillboardInstanceProgram "Default Billboard instance"
 /// Screen space shader
 #define kToolkitDefaultScreenSpaceProgram "Default Screenspace"
 /// Screen space shader w/ motion
 #define kToolkitDefaultScreenSpaceMotionProgram "Default Screenspace Motion"
+/// Screen space shader for signed distance field icons
+#define kToolkitDefaultScreenSpaceSDFProgram "Default Screenspace SDF"
+/// Screen space shader for signed distance field icons w/ motion
+#define kToolkitDefaultScreenSpaceSDFMotionProgram "Default Screenspace SDF Motion"
 /// Widened vector shader
 #define kToolkitDefaultWideVectorProgram "Default Wide Vector"
 /// Widened vector shader for globe
@@ -55,6 +62,15 @@ namespace WhirlyKit
 /// Particle System shader
 #define kToolkitDefaultParticleSystemProgram "Default Part Sys (Point)"
 
+/// The module the default triangle shaders are built from
+#define kToolkitDefaultTriangleModule "Default Triangle"
+
+/// Features of the default triangle module, for picking its permutations
+typedef enum {ShaderTriLighting=1<<0,ShaderTriModelInstance=1<<1,ShaderTriScreenTex=1<<2,ShaderTriMultiTex=1<<3,ShaderTriColorRamp=1<<4,ShaderTriNightDay=1<<5} ShaderTriangleFeature;
+
+/// Build the default triangle module.  The program names above are its permutation names.
+ShaderModule DefaultTriangleShaderModule();
+
 /// Create the default shaders and register them in the appropriate places in the scene
 void SetupDefaultShaders(Scene *);
 
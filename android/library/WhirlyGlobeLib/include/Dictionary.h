@@ -171,5 +171,7 @@ protected:
     typedef std::map<std::string,Value *> FieldMap;
     FieldMap fields;
 };
+
+typedef std::shared_ptr<Dictionary> DictionaryRef;
     
 }
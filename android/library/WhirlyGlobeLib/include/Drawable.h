@@ -89,9 +89,19 @@ public:
     
     /// Unlocks the mutix.  Seriously, not for you.  Don't call this.
     void unlock();
+    
+    /// In headless mode we hand out made up IDs and never call OpenGL.
+    /// The software renderer turns this on before anything is added to the scene.
+    void setHeadless(bool newVal) { headless = newVal; }
+    
+    /// Set if there's no OpenGL context behind this manager
+    bool isHeadless() const { return headless; }
         
 protected:
     pthread_mutex_t idLock;
+    
+    bool headless;
+    GLuint lastFakeID;
 
     std::set<GLuint> buffIDs;
     std::set<GLuint> texIDs;
@@ -121,6 +131,9 @@ public:
 	/// Make a change to the scene.  For the renderer.  Never call this.
 	virtual void execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view) = 0;
     
+    /// Requests that add objects to the scene account for them under this memory tag
+    virtual void setMemTag(int memTag) { }
+    
     /// If non-zero we'll execute this request after the given absolute time
     TimeInterval when;
 };
@@ -161,7 +174,7 @@ class Drawable : public Identifiable
 protected:
 
     /// Used in special cases
-    Drawable() { }
+    Drawable() : animSlot(-1), animGeneration(0) { }
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
 
@@ -222,9 +235,28 @@ public:
     /// Run the tweakers
     virtual void runTweakers(RendererFrameInfo *frame);
     
+    /// Name of the thing that made this drawable
+    const std::string &getName() const { return name; }
+    
+    /// Label for memory accounting, on top of the name
+    void setMemLabel(const std::string &newLabel) { memLabel = newLabel; }
+    const std::string &getMemLabel() const { return memLabel; }
+    
+    /// Bytes of geometry and attribute data this drawable is holding, on the CPU or in buffers
+    virtual unsigned long getMemSize() const { return 0; }
+
+    /// The animator caches where this drawable's results live, along with the generation of its lookups
+    void setAnimSlot(int slot,unsigned int generation) { animSlot = slot;  animGeneration = generation; }
+
+    /// Cached animator slot, if it was set for the given generation.  -1 means nothing animates us.
+    bool getAnimSlot(unsigned int generation,int &slot) const { slot = animSlot;  return animGeneration == generation; }
+    
 protected:
     std::string name;
+    std::string memLabel;
     DrawableTweakerRefSet tweakers;
+    int animSlot;
+    unsigned int animGeneration;
 };
 
 /// Reference counted Drawable pointer
@@ -0,0 +1,225 @@
+/*
+ *  DrawableAnimator.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <map>
+#import <unordered_map>
+#import "Identifiable.h"
+#import "WhirlyVector.h"
+#import "Drawable.h"
+
+namespace WhirlyKit
+{
+
+/// Properties a track can animate
+typedef enum {AnimColor,AnimAlpha,AnimScale,AnimOffset,AnimRotation} AnimProperty;
+
+/// How values get from the previous keyframe to the next
+typedef enum {AnimEaseLinear,AnimEaseIn,AnimEaseOut,AnimEaseInOut,AnimEaseStep} AnimEasing;
+
+/// A value at a given time in a track
+class AnimKeyframe
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    AnimKeyframe();
+    AnimKeyframe(double time,const Eigen::Vector4f &value,AnimEasing easing=AnimEaseLinear);
+
+    /// Seconds from the start of the track
+    double time;
+    /// Color is RGBA from 0 to 1, alpha is x, scale and offset are x and y, rotation is x in radians
+    Eigen::Vector4f value;
+    /// Easing on the way in to this keyframe
+    AnimEasing easing;
+};
+
+typedef std::vector<AnimKeyframe,Eigen::aligned_allocator<AnimKeyframe> > AnimKeyframeVector;
+
+/** A set of keyframes for one property of a drawable or a feature.
+    Feature IDs name groups of drawables.  The marker, label, vector, wide vector, shape and geometry
+    managers register the drawables behind each ID they hand back, so those IDs can be animated directly.
+  */
+class AnimTrack : public Identifiable
+{
+public:
+    AnimTrack();
+
+    AnimProperty property;
+    /// Keyframes in time order
+    AnimKeyframeVector keys;
+    /// When the first keyframe hits
+    TimeInterval startTime;
+    /// Extra times to play after the first.  Negative repeats forever.
+    int repeat;
+    /// Drawable to animate, if there's no feature ID
+    SimpleIdentity drawID;
+    /// Feature to animate
+    SimpleIdentity featureID;
+};
+
+/** Where the animated properties ended up for a drawable on this frame.
+    Color multiplies, alpha multiplies into the fade, scale, offset and rotation
+    are applied in screen space (in pixels) by drawables that live there.
+  */
+class DrawableAnimState
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    DrawableAnimState();
+
+    /// Back to no change
+    void reset();
+
+    Eigen::Vector4f color;
+    float alpha;
+    Point2f scale;
+    Point2f offset;
+    float rotation;
+};
+
+/** Runs keyframe tracks for drawable properties in one pass a frame.
+    Tracks are kept in packed arrays and each drawable caches where its results live when drawing.
+    This lives in the scene and is only touched on the rendering thread, so use the change requests.
+  */
+class DrawableAnimator
+{
+public:
+    DrawableAnimator();
+
+    /// Add a track.  Its ID is how you remove it.
+    void addTrack(const AnimTrack &track);
+
+    /// Remove a single track
+    void removeTrack(SimpleIdentity trackID);
+
+    /// Remove any tracks for the given drawable or feature
+    void removeTracksFor(SimpleIdentity targetID);
+
+    /// Set the drawables that make up a feature
+    void setFeatureDrawables(SimpleIdentity featureID,const SimpleIDSet &drawIDs);
+
+    /// Forget a feature and its tracks
+    void removeFeature(SimpleIdentity featureID);
+
+    /// A drawable went away.  Drops its tracks and feature memberships.
+    void removeDrawable(SimpleIdentity drawID);
+
+    /// True if there's nothing to animate
+    bool empty() const { return trackIDs.empty(); }
+
+    /// Evaluate every track for the given time
+    void evaluate(TimeInterval now);
+
+    /// Where a drawable ended up on the last evaluation.  NULL if nothing is animating it.
+    const DrawableAnimState *stateForDrawable(SimpleIdentity drawID) const;
+
+    /// Same, but the lookup is cached on the drawable until features or tracks change
+    const DrawableAnimState *stateForDrawable(Drawable *draw) const;
+
+    /// Time a value will next change, which is now if anything is moving.  0 if nothing will change.
+    TimeInterval nextChangeTime(TimeInterval now) const;
+
+    /// True if the values on screen are out of date
+    bool hasChanges(TimeInterval now) const;
+
+    /// Eased fraction between two keyframes
+    static float Ease(AnimEasing easing,float t);
+
+protected:
+    // Slot for the state of a drawable or feature, creating it as needed
+    int slotForTarget(SimpleIdentity targetID);
+    // Put the slot lookups back together after features or tracks change
+    void rebuildDrawSlots();
+    // Remove the track at the given index from the packed arrays
+    void removeTrackAt(int which);
+    // Drop one feature from a drawable's reverse index
+    void removeDrawFeature(SimpleIdentity drawID,SimpleIdentity featureID);
+
+    // Packed tracks
+    std::vector<SimpleIdentity> trackIDs;
+    std::vector<AnimProperty> trackProps;
+    std::vector<int> trackFirstKey,trackNumKeys;
+    std::vector<TimeInterval> trackStarts;
+    std::vector<int> trackRepeats;
+    std::vector<SimpleIdentity> trackTargets;
+    std::vector<int> trackSlots;
+    // Set once a track has been evaluated past its end
+    std::vector<bool> trackDone;
+
+    // Packed keyframes for all the tracks
+    std::vector<double> keyTimes;
+    std::vector<Eigen::Vector4f,Eigen::aligned_allocator<Eigen::Vector4f> > keyValues;
+    std::vector<AnimEasing> keyEasings;
+
+    // Results, one per animated drawable or feature
+    std::vector<DrawableAnimState,Eigen::aligned_allocator<DrawableAnimState> > states;
+    std::map<SimpleIdentity,int> targetSlots;
+
+    // Features are groups of drawables
+    std::map<SimpleIdentity,SimpleIDSet> features;
+    // Features each drawable belongs to, so removing a drawable doesn't walk every feature
+    std::unordered_map<SimpleIdentity,SimpleIDSet> drawFeatures;
+    // Drawable ID to its result slot
+    std::unordered_map<SimpleIdentity,int> drawSlots;
+    // Bumped whenever drawSlots changes, which invalidates the slots cached on drawables
+    unsigned int generation;
+};
+
+/// Add a keyframe track to the scene's animator
+class AddAnimTrackReq : public ChangeRequest
+{
+public:
+    AddAnimTrackReq(const AnimTrack &track) : track(track) { }
+
+    void execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view);
+
+protected:
+    AnimTrack track;
+};
+
+/// Remove a track, or all the tracks for a drawable or feature
+class RemAnimTracksReq : public ChangeRequest
+{
+public:
+    RemAnimTracksReq(SimpleIdentity theID,bool isTarget=false) : theID(theID), isTarget(isTarget) { }
+
+    void execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view);
+
+protected:
+    SimpleIdentity theID;
+    bool isTarget;
+};
+
+/// Say which drawables make up a feature, or forget the feature if there are none
+class SetAnimFeatureReq : public ChangeRequest
+{
+public:
+    SetAnimFeatureReq(SimpleIdentity featureID,const SimpleIDSet &drawIDs) : featureID(featureID), drawIDs(drawIDs) { }
+
+    void execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view);
+
+protected:
+    SimpleIdentity featureID;
+    SimpleIDSet drawIDs;
+};
+
+}
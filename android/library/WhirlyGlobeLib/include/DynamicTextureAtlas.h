@@ -55,6 +55,9 @@ public:
     /// Render side only.  Don't call this.  Destroy the OpenGL ES version
     void destroyInGL(OpenGLMemManager *memManager);
     
+    /// Bytes for the full texture plus any CPU side copy
+    virtual unsigned long getMemSize() const;
+    
     /// Set the interpolation type used for min and mag
     void setInterpType(GLenum inType) { interpType = inType; }
     GLenum getInterpType() { return interpType; }
@@ -92,7 +95,21 @@ public:
     /// Return texture cell utilization
     void getUtilization(int &numCell,int &usedCell);
     
+    /// Number of texels on a side
+    int getTexSize() const { return texSize; }
+    
+    /// Memory format (GL_RGBA or GL_ALPHA for the ones we can shadow)
+    GLenum getFormat() const { return format; }
+    
+    /// If we were created headless, this is the CPU side copy of the pixels.
+    /// NULL otherwise.
+    const unsigned char *getSoftData() const { return softData.empty() ? NULL : &softData[0]; }
+    
 protected:
+    /// Copy a block of pixels into the CPU side version
+    void copyIntoSoftData(int startX,int startY,int width,int height,const unsigned char *data);
+    
+
     /// Used for debugging
     std::string name;
     
@@ -121,6 +138,9 @@ protected:
 
     /// If set, overwrite texture data with empty pixels
     bool clearTextures;
+    
+    /// Pixels kept on the CPU side when there's no OpenGL context
+    std::vector<unsigned char> softData;
 };
 
 typedef std::vector<DynamicTexture *> DynamicTextureVec;
@@ -0,0 +1,173 @@
+/*
+ *  ElevationManager.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <vector>
+#import <map>
+#import <memory>
+#import "WhirlyVector.h"
+#import "CoordSystem.h"
+#import "Quadtree.h"
+#import "VectorData.h"
+#import "Scene.h"
+#import "MeshBVH.h"
+
+namespace WhirlyKit
+{
+
+/** A grid of elevation samples covering a single terrain tile.
+    The samples run from corner to corner, so neighboring tiles share their edges.
+    Once it's been handed to the elevation manager it shouldn't be modified.
+  */
+class ElevationGridTile
+{
+public:
+    /// Construct with the tile's identity, its bounds in the elevation coordinate system,
+    ///  the sample counts and the samples in meters, top row first
+    ElevationGridTile(const Quadtree::Identifier &ident,const Point2d &ll,const Point2d &ur,int sizeX,int sizeY,const float *samples);
+
+    /// Which tile this is
+    Quadtree::Identifier ident;
+    /// Bounds in the elevation coordinate system
+    Point2d ll,ur;
+    /// Bounds in geographic (radians).  Filled in by the manager.
+    GeoMbr geoMbr;
+    /// Number of samples across and down
+    int sizeX,sizeY;
+    /// Elevation in meters, top row first
+    std::vector<float> samples;
+
+    /// Distance between samples in the elevation coordinate system
+    Point2d cellSize() const;
+
+    /// Bilinear interpolation at a point in the elevation coordinate system.
+    /// Returns false if the point is outside the tile.
+    bool interpolate(const Point2d &pt,double &elev) const;
+};
+
+typedef std::shared_ptr<ElevationGridTile> ElevationGridTileRef;
+
+/** A snapshot of the elevation loaded over an area.
+    The vector builders get one of these and then sample and subdivide against it
+    without going back to the manager.  It holds on to the tiles it was built with,
+    so it stays valid if they're removed in the mean time.
+  */
+class ElevationSampler
+{
+public:
+    ElevationSampler(CoordSystem *coordSys,CoordSystemDisplayAdapter *coordAdapter);
+
+    /// Set if there's no elevation in the area at all
+    bool empty() const { return tiles.empty(); }
+
+    /// Most detailed tile level in the snapshot
+    int getMaxLevel() const { return maxLevel; }
+
+    /// Elevation in meters at a geographic point (radians).
+    /// Uses the most detailed tile covering the point.  False if none does.
+    bool elevationAt(const Point2d &geoPt,double &elev) const;
+
+    /// Local coordinates in the scene's system for a geographic point, with the elevation as Z.
+    /// Pass the result through the display adapter as usual.
+    Point3d localPointFor(const Point2d &geoPt) const;
+
+    /// Break up the edges wherever they cross a tile boundary or a row or column of samples.
+    /// The heights then follow the terrain rather than cutting through it.
+    void subdivideEdges(const VectorRing &inPts,VectorRing &outPts,bool closed) const;
+
+    /// Spacing and origin of the finest sample grid, in geographic.  Used to chop up areals.
+    bool gridForAreals(Point2f &org,Point2f &spacing) const;
+
+protected:
+    friend class ElevationManager;
+
+    /// Add the sample rows and columns for a tile that overlap the area
+    void addTile(ElevationGridTileRef tile,const GeoMbr &area);
+    /// Sort the tiles and grid lines once they've all been added
+    void finish();
+    /// Add the grid crossings for a single edge
+    void addCrossings(const std::vector<double> &lines,double a,double b,std::vector<double> &ts) const;
+
+    CoordSystem *coordSys;
+    CoordSystemDisplayAdapter *coordAdapter;
+    std::vector<ElevationGridTileRef> tiles;
+    std::vector<double> xLines,yLines;
+    int maxLevel;
+};
+
+typedef std::shared_ptr<ElevationSampler> ElevationSamplerRef;
+
+#define kWKElevationManager "WKElevationManager"
+
+/** The elevation manager keeps the terrain that's been loaded so other
+    managers can drape their geometry over it.  Tiles come from whatever is
+    paging terrain in, in any coordinate system whose axes follow lines of
+    longitude and latitude (geographic or Mercator, usually).
+    When more detailed tiles show up, clamped vectors over them are rebuilt.
+    Each tile's surface also goes to the intersection manager, so taps hit the terrain.
+    It's thread safe.
+  */
+class ElevationManager : public SceneManager
+{
+public:
+    ElevationManager();
+    virtual ~ElevationManager();
+
+    /// Coordinate system the tiles are in.  We don't own it.  Defaults to the scene's.
+    void setCoordSystem(CoordSystem *coordSys);
+
+    /// Add a single tile.  Anything draped over it is rebuilt into the change set.
+    void addElevationTile(ElevationGridTileRef tile,ChangeSet &changes);
+
+    /// Add a group of tiles, rebuilding draped geometry once for all of them
+    void addElevationTiles(const std::vector<ElevationGridTileRef> &tiles,ChangeSet &changes);
+
+    /// Remove tiles that are no longer loaded, along with their surfaces for intersection.
+    /// Draped geometry is left as is.
+    void removeElevationTiles(const std::vector<Quadtree::Identifier> &idents);
+
+    /// Number of tiles we're holding on to
+    int getNumTiles();
+
+    /// Elevation at a single geographic point (radians).  False if there's no data.
+    bool elevationAt(const Point2d &geoPt,double &elev);
+
+    /// Snapshot of the elevation over an area, for sampling against
+    ElevationSamplerRef makeSampler(const GeoMbr &mbr);
+
+protected:
+    CoordSystem *getCoordSystem();
+    // Triangulate a tile's samples in display space for ray intersection
+    MeshBVHRef makeBVH(const ElevationGridTile &tile,CoordSystem *tileSys);
+    // Drop a tile's surface from intersection.  Caller has the lock.
+    void removeTileIntersect(const Quadtree::Identifier &ident);
+    // Make sure the intersection manager knows about our surfaces.  Caller has the lock.
+    void registerMeshIntersect();
+
+    pthread_mutex_t elevLock;
+    CoordSystem *coordSys;
+    std::map<Quadtree::Identifier,ElevationGridTileRef> tiles;
+    // Tile surfaces for ray intersection, grouped by tile
+    MeshIntersectable *meshIntersect;
+    bool meshIntersectRegistered;
+    std::map<Quadtree::Identifier,SimpleIdentity> tileIntersectIDs;
+};
+
+}
@@ -0,0 +1,244 @@
+/*
+ *  FlatGeobuf.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <string>
+#import <vector>
+#import <memory>
+#import "VectorData.h"
+#import "CoordSystem.h"
+#import "Quadtree.h"
+
+namespace WhirlyKit
+{
+
+/// Attribute types from the FlatGeobuf header
+typedef enum {FGBByte=0,FGBUByte,FGBBool,FGBShort,FGBUShort,FGBInt,FGBUInt,FGBLong,FGBULong,
+    FGBFloat,FGBDouble,FGBString,FGBJson,FGBDateTime,FGBBinary} FlatGeobufColumnType;
+
+/// Geometry types, which match the WKB ones for the simple features
+typedef enum {FGBUnknown=0,FGBPoint,FGBLineString,FGBPolygon,FGBMultiPoint,FGBMultiLineString,
+    FGBMultiPolygon,FGBGeometryCollection} FlatGeobufGeometryType;
+
+/// An attribute column
+class FlatGeobufColumn
+{
+public:
+    std::string name;
+    FlatGeobufColumnType type;
+};
+
+/// One entry in the packed R-tree
+class FlatGeobufNode
+{
+public:
+    double minX,minY,maxX,maxY;
+    /// Features offset for a leaf, first child for everything else
+    uint64_t offset;
+};
+
+class FlatGeobufWindow;
+
+/** A FlatGeobuf file.
+    The header and the upper levels of the packed Hilbert R-tree are read when it's
+    opened.  Leaf nodes and features are read as needed with positioned reads, so
+    any number of threads can query the same file at once.
+    Features are decoded straight out of the read buffer into shapes.
+  */
+class FlatGeobufFile
+{
+public:
+    /// Construct with the file name.  Pass in a coordinate system if the data isn't
+    /// in geographic degrees.  We don't own it.
+    FlatGeobufFile(const std::string &fileName,CoordSystem *coordSys = NULL);
+    virtual ~FlatGeobufFile();
+
+    /// Read the header and the index.  False on failure, see getError().
+    bool open();
+
+    bool isValid() const { return fd >= 0; }
+
+    const std::string &getError() const { return error; }
+
+    /// Dataset name from the header
+    const std::string &getName() const { return name; }
+
+    /// Geometry type for every feature, or unknown if it varies
+    FlatGeobufGeometryType getGeometryType() const { return geomType; }
+
+    /// Attribute columns
+    const std::vector<FlatGeobufColumn> &getColumns() const { return columns; }
+
+    /// Number of features, if the header says
+    uint64_t getNumFeatures() const { return numFeatures; }
+
+    /// EPSG code from the header, or zero
+    int getSRSID() const { return srsID; }
+
+    /// True if there's a spatial index to search
+    bool hasIndex() const { return indexNodeSize > 0 && numFeatures > 0; }
+
+    /// Extents of the data in its own coordinates
+    bool getExtents(Point2d &ll,Point2d &ur) const;
+
+    /// Offsets of the features overlapping the bounds (in the file's coordinates), in file order.
+    /// Without an index this is false and the features have to be read through.
+    bool search(const Point2d &ll,const Point2d &ur,std::vector<uint64_t> &offsets) const;
+
+    /// Read the features overlapping the bounds in the file's coordinates.
+    /// If the filter is set, only those attributes are kept.
+    bool readFeatures(const Point2d &ll,const Point2d &ur,ShapeSet &shapes,const StringSet *filter = NULL) const;
+
+    /// Same thing, but with bounds in geographic radians
+    bool readGeoFeatures(const GeoMbr &mbr,ShapeSet &shapes,const StringSet *filter = NULL) const;
+
+    /// Geographic radian bounds to the file's coordinates
+    void geoBoundsToLocal(const GeoMbr &mbr,Point2d &ll,Point2d &ur) const;
+
+    /// Decode a feature at the given offset from the start of the features.
+    /// Returns the offset of the next feature, or zero at the end or on an error.
+    /// If bounds are passed in, features outside of them are skipped.
+    uint64_t readFeature(FlatGeobufWindow &window,uint64_t offset,ShapeSet &shapes,const StringSet *filter,
+                         const Point2d *ll = NULL,const Point2d *ur = NULL) const;
+
+    /// Where the features start in the file
+    uint64_t getFeaturesStart() const { return featuresStart; }
+
+    /// Positioned read from the file
+    bool readAt(uint64_t offset,void *data,size_t len) const;
+
+protected:
+    friend class FlatGeobufWindow;
+
+    bool readHeader(const unsigned char *data,size_t len);
+    bool readNodes(uint64_t first,uint64_t count,std::vector<FlatGeobufNode> &nodes) const;
+
+    std::string fileName;
+    CoordSystem *coordSys;
+    bool degrees;
+    int fd;
+    uint64_t fileSize;
+    std::string error;
+
+    std::string name;
+    FlatGeobufGeometryType geomType;
+    bool hasZ,hasM;
+    std::vector<FlatGeobufColumn> columns;
+    uint64_t numFeatures;
+    uint16_t indexNodeSize;
+    int srsID;
+    bool hasEnvelope;
+    Point2d envLL,envUR;
+
+    uint64_t indexStart,featuresStart;
+    /// Node ranges for each level, leaves first
+    std::vector<std::pair<uint64_t,uint64_t> > levelBounds;
+    /// Everything above the leaves
+    std::vector<FlatGeobufNode> upperNodes;
+};
+
+typedef std::shared_ptr<FlatGeobufFile> FlatGeobufFileRef;
+
+/// A read buffer over a FlatGeobuf file.  Reads in sorted order mostly come right out of it.
+class FlatGeobufWindow
+{
+public:
+    FlatGeobufWindow(const FlatGeobufFile *file);
+
+    /// Pointer to len bytes at the offset, or null if they're not in the file
+    const unsigned char *read(uint64_t offset,size_t len);
+
+protected:
+    const FlatGeobufFile *file;
+    uint64_t base;
+    size_t size;
+    std::vector<unsigned char> buf;
+};
+
+/** Reads the features from a FlatGeobuf file one by one.
+    With bounds, the index picks out the features to read.  Without,
+    the file is read straight through.
+  */
+class FlatGeobufFeatureReader : public VectorReader
+{
+public:
+    FlatGeobufFeatureReader(FlatGeobufFileRef file);
+    virtual ~FlatGeobufFeatureReader();
+
+    /// Only read features overlapping these bounds, in the file's coordinates.
+    /// Call before reading starts.
+    void setBounds(const Point2d &ll,const Point2d &ur);
+
+    /// Same thing, but with bounds in geographic radians
+    void setGeoBounds(const GeoMbr &mbr);
+
+    /// VectorReader methods
+    virtual bool isValid();
+    virtual VectorShapeRef getNextObject(const StringSet *filter);
+
+    /// Read everything left into a shape set
+    bool readAll(ShapeSet &shapes);
+
+protected:
+    void start();
+
+    FlatGeobufFileRef file;
+    FlatGeobufWindow window;
+    bool hasBounds;
+    Point2d boundsLL,boundsUR;
+    bool started,done;
+    bool useOffsets;
+    std::vector<uint64_t> offsets;
+    size_t which;
+    uint64_t nextOffset;
+    ShapeSet pending;
+};
+
+/** Hands out the features for a paging layer's tiles.
+    The tiles are laid out over the given extents in the paging layer's coordinate system,
+    one at the top, four below that and so on.
+  */
+class FlatGeobufPagingSource
+{
+public:
+    /// The paging layer's coordinate system (which we don't own) and its extents
+    FlatGeobufPagingSource(FlatGeobufFileRef file,CoordSystem *coordSys,const Point2d &ll,const Point2d &ur,int minZoom,int maxZoom);
+
+    int getMinZoom() const { return minZoom; }
+    int getMaxZoom() const { return maxZoom; }
+
+    /// Only keep these attributes
+    void setFilterAttrs(const StringSet &attrs) { filterAttrs = attrs; hasFilter = true; }
+
+    /// Bounds of a tile in geographic radians
+    GeoMbr geoBoundsForTile(const Quadtree::Identifier &ident) const;
+
+    /// Features overlapping a tile.  Safe to call from any thread.
+    bool fetchTile(const Quadtree::Identifier &ident,ShapeSet &shapes) const;
+
+protected:
+    FlatGeobufFileRef file;
+    CoordSystem *coordSys;
+    Point2d ll,ur;
+    int minZoom,maxZoom;
+    bool hasFilter;
+    StringSet filterAttrs;
+};
+
+}
@@ -125,9 +125,12 @@ public:
     class Rect
     {
     public:
+        Rect() : glyph(0) { }
         Point2f pts[2];
         TexCoord texCoords[2];
         SubTexture subTex;
+        /// Code point this came from, if the platform fills it in.  Used for line breaking.
+        WKGlyph glyph;
     };
     std::vector<Rect> glyphPolys;
     
@@ -0,0 +1,100 @@
+/*
+ *  GPXReader.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdio.h>
+#import <string>
+#import <vector>
+#import "VectorData.h"
+#import "XMLStreamReader.h"
+#import "KMLReader.h"
+
+namespace WhirlyKit
+{
+
+/** Reads GPX waypoints, routes and tracks into shapes as it goes.
+    Waypoints become points.  Routes and each track segment become linears,
+    or 3D linears (in meters) if every point has an elevation.
+    The gpxType attribute is waypoint, route or track.
+    Track segments also get their start and end times, the duration and
+    a comma separated list of each point's time in seconds from the start.
+  */
+class GPXReader : public XMLStreamHandler
+{
+public:
+    GPXReader();
+    virtual ~GPXReader();
+
+    /// Called with each feature's shapes.  If not set, the shapes pile up in getShapes().
+    void setFeatureCallback(const VectorFeatureCallback &callback) { featureCallback = callback; }
+
+    /// Read a GPX file
+    bool readFile(const std::string &fileName);
+
+    /// Read GPX that's already in memory
+    bool parse(const std::string &xml);
+
+    /// Shapes read, if there's no callback
+    ShapeSet &getShapes() { return shapes; }
+
+    const std::string &getError() const { return error; }
+
+    /// Parse an ISO 8601 time into seconds since 1970.  False if it doesn't look like one.
+    static bool ParseTime(const std::string &str,double &secs);
+
+    /// XMLStreamHandler methods
+    virtual void startElement(const std::string &name,const XMLAttributes &attrs);
+    virtual void endElement(const std::string &name);
+    virtual void characters(const std::string &text);
+
+protected:
+    /// A point from a wpt, rtept or trkpt
+    class GPXPoint
+    {
+    public:
+        GPXPoint() : lon(0.0), lat(0.0), ele(0.0), hasEle(false), time(0.0), hasTime(false) { }
+
+        double lon,lat;
+        double ele;
+        bool hasEle;
+        double time;
+        bool hasTime;
+    };
+
+    /// Turn the points into a linear and pass it on
+    void finishLine(const std::string &gpxType,int segment);
+    void emit(VectorShapeRef shape,Dictionary &attrs);
+
+    VectorFeatureCallback featureCallback;
+    ShapeSet shapes;
+    std::string error;
+
+    std::vector<std::string> elements;
+    std::string text;
+
+    // Current waypoint, route or track
+    Dictionary featureAttrs;
+    // Attributes for the current point
+    Dictionary pointAttrs;
+    GPXPoint curPoint;
+    std::vector<GPXPoint> linePoints;
+    int segment;
+};
+
+}
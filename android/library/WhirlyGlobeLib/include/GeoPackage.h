@@ -0,0 +1,288 @@
+/*
+ *  GeoPackage.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <vector>
+#import <string>
+#import <map>
+#import <memory>
+#import <functional>
+#import "WhirlyVector.h"
+#import "VectorData.h"
+#import "VectorWKB.h"
+#import "RawData.h"
+#import "TileMatrixSet.h"
+
+namespace WhirlyKit
+{
+
+/// Column types, as SQLite reports them
+typedef enum {GeoPackageNull,GeoPackageInteger,GeoPackageFloat,GeoPackageText,GeoPackageBlob} GeoPackageColumnType;
+
+/** Results of a query, one row at a time.
+    The platform provides this on top of its SQLite (sqlite3 directly or a Cursor on Android).
+  */
+class GeoPackageCursor
+{
+public:
+    virtual ~GeoPackageCursor() { }
+
+    /// Move to the next row.  False when there aren't any more.
+    virtual bool step() = 0;
+
+    virtual int getNumColumns() = 0;
+    virtual std::string getColumnName(int col) = 0;
+    virtual GeoPackageColumnType getColumnType(int col) = 0;
+
+    virtual int64_t getInt(int col) = 0;
+    virtual double getDouble(int col) = 0;
+    virtual std::string getString(int col) = 0;
+    /// Blob for the current row.  Good until the next step().
+    virtual const unsigned char *getBlob(int col,size_t &len) = 0;
+};
+
+typedef std::shared_ptr<GeoPackageCursor> GeoPackageCursorRef;
+
+/// A single read only connection to the database
+class GeoPackageConnection
+{
+public:
+    virtual ~GeoPackageConnection() { }
+
+    /// Run a query.  Null if it failed.
+    virtual GeoPackageCursorRef query(const std::string &sql) = 0;
+};
+
+typedef std::shared_ptr<GeoPackageConnection> GeoPackageConnectionRef;
+
+/// Opens a new connection to the same file
+typedef std::function<GeoPackageConnectionRef()> GeoPackageConnectionFactory;
+
+/// An entry from gpkg_contents
+class GeoPackageContents
+{
+public:
+    GeoPackageContents();
+
+    std::string tableName;
+    /// "features", "tiles" or "attributes", mostly
+    std::string dataType;
+    std::string identifier,description;
+    /// Bounds in the table's own system, if given
+    bool hasBounds;
+    Point2d ll,ur;
+    int srsID;
+
+    /// For features, from gpkg_geometry_columns
+    std::string geomColumn,geomType;
+    /// Set if there's an R-tree spatial index for the geometry column
+    bool hasRTree;
+};
+
+/// An entry from gpkg_spatial_ref_sys
+class GeoPackageSRS
+{
+public:
+    GeoPackageSRS();
+
+    int srsID;
+    std::string name;
+    std::string organization;
+    int orgCoordSysID;
+    /// Usually WKT
+    std::string definition;
+
+    /// True for plain longitude and latitude in degrees
+    bool isGeographic() const;
+};
+
+/** The header in front of the WKB in a GeoPackage geometry blob.
+    Parse it to get the envelope (which can save decoding) and where the WKB starts.
+  */
+class GeoPackageGeometryHeader
+{
+public:
+    GeoPackageGeometryHeader();
+
+    /// Parse the header.  False if it's not a GeoPackage geometry.
+    bool parse(const unsigned char *data,size_t len);
+
+    int srsID;
+    bool empty;
+    /// Set if there's an envelope, which is in the table's own coordinates
+    bool hasEnvelope;
+    Point2d envLL,envUR;
+    /// Offset of the WKB
+    size_t wkbOffset;
+};
+
+/** A GeoPackage file.
+    The platform opens the connections.  We keep a small pool of them, so
+    feature and tile reads on different threads don't wait on one another.
+    Readers only hold a connection for the length of a query, so any number of them can be open.
+  */
+class GeoPackage
+{
+public:
+    /// Construct with something to make connections and how many we can have open at once
+    GeoPackage(const GeoPackageConnectionFactory &factory,int maxConnections = 4);
+    virtual ~GeoPackage();
+
+    /// Read the contents, spatial reference systems and geometry columns.
+    /// False if this isn't a GeoPackage.
+    bool open();
+
+    const std::string &getError() const { return error; }
+
+    /// Everything in gpkg_contents
+    const std::vector<GeoPackageContents> &getContents() const { return contents; }
+
+    /// Contents entry for a table, or null
+    const GeoPackageContents *getTableContents(const std::string &tableName) const;
+
+    /// Spatial reference system, or null
+    const GeoPackageSRS *getSRS(int srsID) const;
+
+    /// Get a connection from the pool, opening one if need be.
+    /// Waits if they're all in use.  Hand it back with releaseConnection().
+    GeoPackageConnectionRef acquireConnection();
+
+    /// Return a connection to the pool
+    void releaseConnection(GeoPackageConnectionRef conn);
+
+    /// Quote an identifier for SQL
+    static std::string QuoteIdentifier(const std::string &name);
+    /// Quote a string for SQL
+    static std::string QuoteString(const std::string &str);
+
+protected:
+    GeoPackageConnectionFactory factory;
+    int maxConnections;
+    int numConnections;
+    std::vector<GeoPackageConnectionRef> idleConnections;
+    pthread_mutex_t poolLock;
+    pthread_cond_t poolCond;
+
+    std::string error;
+    std::vector<GeoPackageContents> contents;
+    std::map<int,GeoPackageSRS> srsMap;
+};
+
+typedef std::shared_ptr<GeoPackage> GeoPackageRef;
+
+/** Reads the features from a GeoPackage table.
+    Geometry comes back in geographic radians.  Tables in degrees are converted
+    for you; for anything else pass in the coordinate system the table is in.
+    The other columns become attributes.
+    With bounds set, only features that overlap them are read, using the R-tree
+    if the table has one and the geometry envelopes if it doesn't.
+    Rows are read a page at a time, each with its own query, so the reader
+    doesn't keep a connection from the pool between calls.
+  */
+class GeoPackageFeatureReader : public VectorReader
+{
+public:
+    /// Construct with the package, table and (optionally) the table's system, which we don't own
+    GeoPackageFeatureReader(GeoPackageRef gpkg,const std::string &tableName,CoordSystem *coordSys = NULL);
+    virtual ~GeoPackageFeatureReader();
+
+    /// Only read features overlapping these bounds, in the table's coordinates.
+    /// Call before reading starts.
+    void setBounds(const Point2d &ll,const Point2d &ur);
+
+    /// Same thing, but with bounds in geographic radians
+    void setGeoBounds(const GeoMbr &mbr);
+
+    /// VectorReader methods
+    virtual bool isValid();
+    virtual VectorShapeRef getNextObject(const StringSet *filter);
+
+    /// Read everything left into a shape set
+    bool readAll(ShapeSet &shapes);
+
+protected:
+    /// Read the next page of rows into pending.  Sets done after the last one.
+    bool readPage(const StringSet *filter);
+    /// Read the current row.  Multi geometries can produce more than one shape.
+    bool readRow(GeoPackageCursorRef cursor,ShapeSet &shapes,const StringSet *filter);
+
+    GeoPackageRef gpkg;
+    const GeoPackageContents *contents;
+    CoordSystem *coordSys;
+    bool degrees;
+    bool hasBounds;
+    Point2d boundsLL,boundsUR;
+    /// Where the next page starts
+    int64_t lastRowID;
+    int geomCol;
+    bool done;
+    WKBParser parser;
+    ShapeSet pending;
+};
+
+/** Serves the tiles from a GeoPackage tile pyramid.
+    The tile matrices can be anything the spec allows: missing zoom levels,
+    factors other than two between levels and matrices that don't fill the
+    tile matrix set bounds are all fine.
+    Tiles come back as the encoded image (PNG, JPEG or WebP) for the platform to decode.
+  */
+class GeoPackageTileSource
+{
+public:
+    GeoPackageTileSource(GeoPackageRef gpkg,const std::string &tableName);
+    virtual ~GeoPackageTileSource();
+
+    /// Read gpkg_tile_matrix_set and gpkg_tile_matrix.  False if the table's not there.
+    bool init();
+
+    /// Tiling in the table's coordinate system.  Level 0 is the least detailed zoom level in the table.
+    TileMatrixSetRef getTileMatrixSet() const { return tileMatrixSet; }
+
+    /// Spatial reference system the tiles are in
+    int getSRSID() const { return srsID; }
+
+    /// GeoPackage zoom_level for one of our levels
+    int zoomLevelFor(int level) const;
+
+    /// Tile size in pixels on the given level
+    void getTileSize(int level,int &width,int &height) const;
+
+    /// Check if the table has a given tile
+    bool hasTile(const Quadtree::Identifier &ident);
+
+    /// Fetch the encoded tile image.  Empty if it's not there.  Thread safe.
+    RawDataRef fetchTile(const Quadtree::Identifier &ident);
+
+protected:
+    class ZoomInfo
+    {
+    public:
+        int zoomLevel;
+        int tileWidth,tileHeight;
+    };
+
+    GeoPackageRef gpkg;
+    std::string tableName;
+    int srsID;
+    TileMatrixSetRef tileMatrixSet;
+    std::vector<ZoomInfo> zooms;
+};
+
+}
@@ -0,0 +1,278 @@
+/*
+ *  GeoTIFF.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdio.h>
+#import <stdint.h>
+#import <pthread.h>
+#import <vector>
+#import <string>
+#import <map>
+#import <list>
+#import <memory>
+#import "WhirlyVector.h"
+#import "RawData.h"
+#import "CoordSystem.h"
+#import "Proj4CoordSystem.h"
+#import "Quadtree.h"
+#import "TileMatrixSet.h"
+
+namespace WhirlyKit
+{
+
+/** A single image within a TIFF.
+    GeoTIFFs usually have the full resolution image first and then
+    a series of reduced resolution overviews.
+  */
+class GeoTIFFImage
+{
+public:
+    GeoTIFFImage();
+
+    /// Size in pixels
+    int width,height;
+    /// Size of a tile, or the width and rows per strip for striped images
+    int blockWidth,blockHeight;
+    /// Set if this is tiled rather than striped
+    bool tiled;
+    /// Number of blocks across and down
+    int blocksAcross,blocksDown;
+
+    int bitsPerSample;
+    int samplesPerPixel;
+    /// 1 is unsigned int, 2 is signed int, 3 is floating point
+    int sampleFormat;
+    int compression;
+    int predictor;
+    int photometric;
+    /// 1 for interleaved samples, 2 for separate planes
+    int planarConfig;
+    /// Which sample is alpha, or -1 for none
+    int alphaSample;
+    /// Reduced resolution version of another image
+    bool isOverview;
+    /// Transparency mask rather than an image
+    bool isMask;
+
+    /// Where the blocks are in the file and how big they are
+    std::vector<uint64_t> blockOffsets,blockByteCounts;
+    /// Shared JPEG tables, if any
+    std::vector<unsigned char> jpegTables;
+    /// Palette, 16 bits per entry with all the reds, then greens, then blues
+    std::vector<unsigned short> colorMap;
+
+    /// Check we can decode this one
+    bool isSupported(std::string &why) const;
+};
+
+/// Georeferencing read out of the GeoTIFF tags and keys
+class GeoTIFFGeoref
+{
+public:
+    GeoTIFFGeoref();
+
+    /// Set if we found a tie point and scale or a transform
+    bool valid;
+    /// Pixel to model affine transform, as in GDAL:
+    ///  x = t[0] + col*t[1] + row*t[2], y = t[3] + col*t[4] + row*t[5]
+    double transform[6];
+    /// 1 for projected, 2 for geographic
+    int modelType;
+    /// Set if the tie point refers to the center of a pixel rather than its corner
+    bool pixelIsPoint;
+    /// EPSG code for the projected or geographic system, if it was given
+    int epsg;
+    /// All the short, double and ascii valued geo keys
+    std::map<int,double> keys;
+    std::map<int,std::string> asciiKeys;
+
+    /// Geographic systems use degrees in the file, but radians everywhere else
+    bool isGeographic() const { return modelType == 2; }
+
+    /// Work out a proj.4 string for this system.  Empty if we don't recognize it.
+    std::string proj4String() const;
+};
+
+/** Reader for GeoTIFFs, including Cloud Optimized GeoTIFFs.
+    This reads classic and BigTIFF files, tiled or striped, uncompressed or with
+    LZW, Deflate, PackBits or JPEG compression.  It only reads the blocks you
+    ask for and keeps a cache of the most recently decoded ones.
+    Everything comes back as 8 bit RGBA.  16 bit and floating point data is
+    scaled using the data range.
+    Safe to use from multiple threads.
+  */
+class GeoTIFFFile
+{
+public:
+    GeoTIFFFile();
+    virtual ~GeoTIFFFile();
+
+    /// Open the given file and read its structure.  False on failure.
+    bool open(const std::string &fileName);
+
+    /// Close the file and flush the caches
+    void close();
+
+    /// What went wrong, if something did
+    std::string getError();
+
+    /// Number of images, full resolution first and then overviews from largest to smallest
+    int getNumImages() const { return (int)images.size(); }
+
+    /// Return one of the images
+    const GeoTIFFImage &getImage(int which) const { return images[which]; }
+
+    /// Georeferencing for the full resolution image
+    const GeoTIFFGeoref &getGeoref() const { return georef; }
+
+    /// Make up a coordinate system for the file.  Caller is responsible for deletion.
+    /// Returns NULL if we couldn't figure it out.
+    Proj4CoordSystem *makeCoordSystem() const;
+
+    /// Bounding box in the coordinate system's units (radians for geographic)
+    void getBounds(Point2d &ll,Point2d &ur) const;
+
+    /// Convert a pixel location in the given image to coordinate system units
+    Point2d pixelToLocal(int image,const Point2d &pix) const;
+
+    /// Convert from coordinate system units to a pixel location in the given image
+    Point2d localToPixel(int image,const Point2d &loc) const;
+
+    /// Size of a pixel in the given image, in coordinate system units
+    Point2d pixelSize(int image) const;
+
+    /// Range for scaling 16 bit and floating point data down to 8 bits
+    void setDataRange(double minVal,double maxVal);
+
+    /// Treat this value as transparent.  Defaults to the GDAL no data value if there is one.
+    void setNoData(double noData);
+    void clearNoData();
+
+    /// Memory used for decoded blocks before we start tossing them
+    void setCacheSize(size_t bytes);
+
+    /// Decode a single block into RGBA, blockWidth x blockHeight
+    bool readBlock(int image,int blockX,int blockY,std::vector<unsigned char> &rgba);
+
+    /// Read a window of an image into RGBA.  Only the blocks it touches are decoded.
+    /// Areas outside the image are left alone.
+    bool readRegion(int image,int x,int y,int width,int height,unsigned char *rgba);
+
+    /// Look up the RGBA value for a pixel, decoding its block if need be
+    bool getPixel(int image,int x,int y,unsigned char *rgba);
+
+protected:
+    typedef std::shared_ptr<std::vector<unsigned char> > BlockRef;
+
+    /// A decoded block we're hanging on to
+    class CachedBlock
+    {
+    public:
+        BlockRef data;
+        std::list<uint64_t>::iterator lruPos;
+    };
+
+    bool readHeader();
+    bool readIFD(uint64_t offset,uint64_t &nextOffset);
+    bool readGeoKeys(const std::vector<double> &keyDir,const std::vector<double> &doubleParams,const std::string &asciiParams);
+
+    bool readBytes(uint64_t offset,size_t len,void *data);
+    /// Bytes in the file from the offset on, 0 if the offset is past the end
+    uint64_t bytesLeft(uint64_t offset) const { return offset < fileSize ? fileSize - offset : 0; }
+    uint16_t swap16(uint16_t val) const;
+    uint32_t swap32(uint32_t val) const;
+    uint64_t swap64(uint64_t val) const;
+
+    /// Fetch a decoded block from the cache or the file
+    BlockRef getBlock(int image,int blockX,int blockY);
+    bool decodeBlock(int image,int blockX,int blockY,std::vector<unsigned char> &rgba);
+    bool decodePlane(const GeoTIFFImage &img,int which,int numSamples,int rows,std::vector<unsigned char> &samples);
+    void convertToRGBA(const GeoTIFFImage &img,const std::vector<unsigned char> &samples,int rows,std::vector<unsigned char> &rgba);
+
+    FILE *fp;
+    uint64_t fileSize;
+    pthread_mutex_t fileLock;
+    pthread_mutex_t cacheLock;
+    bool swapBytes;
+    bool bigTIFF;
+    std::string error;
+
+    std::vector<GeoTIFFImage> images;
+    GeoTIFFGeoref georef;
+
+    double dataMin,dataMax;
+    bool dataRangeSet;
+    bool hasNoData;
+    double noData;
+
+    size_t cacheSize,maxCacheSize;
+    std::map<uint64_t,CachedBlock> blockCache;
+    std::list<uint64_t> blockLRU;
+};
+
+typedef std::shared_ptr<GeoTIFFFile> GeoTIFFFileRef;
+
+/** Serves up quad tree tiles from a GeoTIFF.
+    Tiles are defined by a tile matrix set in the destination coordinate system.
+    If that's different from the file's system we reproject, using a grid of exactly
+    converted points and interpolating between them.
+    We pick the overview closest to the resolution each tile needs.
+  */
+class GeoTIFFTileSource
+{
+public:
+    /// Construct with the file, the coordinate system and tiling we want out, and the tile size in pixels
+    GeoTIFFTileSource(GeoTIFFFileRef file,CoordSystem *destSystem,TileMatrixSetRef tileMatrixSet,int tileSize);
+    virtual ~GeoTIFFTileSource();
+
+    /// Tiling that follows the file's own overviews, in its own coordinate system.
+    /// Use this (with the file's coordinate system) if you don't need to reproject.
+    static TileMatrixSetRef MakeNativeTileMatrixSet(GeoTIFFFileRef file,int tileSize);
+
+    /// Number of cells in the reprojection grid along each side.  More is more accurate.
+    void setSampleGrid(int newGrid) { sampleGrid = std::max(newGrid,1); }
+
+    /// Interpolate between pixels rather than taking the nearest one
+    void setBilinear(bool newBilinear) { bilinear = newBilinear; }
+
+    /// Check if a tile has anything in it
+    bool tileOverlaps(const Quadtree::Identifier &ident);
+
+    /// Build the RGBA image for a tile.  Empty if the tile doesn't overlap the file.
+    RawDataRef fetchTile(const Quadtree::Identifier &ident);
+
+    /// Most detailed level worth loading, where tiles match the full resolution pixels
+    int calcMaxLevel();
+
+protected:
+    /// Convert a point in the destination system to the file's system
+    Point2d destToSource(const Point2d &pt);
+
+    GeoTIFFFileRef file;
+    CoordSystem *destSystem;
+    Proj4CoordSystem *srcSystem;
+    bool sameSystem;
+    TileMatrixSetRef tileMatrixSet;
+    int tileSize;
+    int sampleGrid;
+    bool bilinear;
+    Point2d srcLL,srcUR;
+};
+
+}
@@ -23,6 +23,7 @@
 #import "Scene.h"
 #import "SelectionManager.h"
 #import "BaseInfo.h"
+#import "MeshBVH.h"
 
 namespace WhirlyKit
 {
@@ -67,6 +68,9 @@ public:
     // Bounding box (for use in instances of a base model)
     Point3d ll,ur;
     
+    // Triangles for ray intersection (for use in instances of a base model)
+    MeshBVHRef bvh;
+    
     // If set, the amount of time to fade out before deletion
     float fade;
     
@@ -321,8 +325,16 @@ public:
     void removeGeometry(SimpleIDSet &billIDs,ChangeSet &changes);
     
 protected:
+    // Collect the triangles into a BVH and start building it
+    MeshBVHRef makeBVH(const std::vector<GeometryRaw *> &geom);
+    // Make sure the intersection manager knows about our meshes.  Caller has the lock.
+    void registerMeshIntersect();
+
     pthread_mutex_t geomLock;
     GeomSceneRepSet sceneReps;
+    // Models and instances for precise ray intersection
+    MeshIntersectable *meshIntersect;
+    bool meshIntersectRegistered;
 };
 
 }
@@ -0,0 +1,129 @@
+/*
+ *  GroundControlWarp.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <string>
+#import <memory>
+#import <functional>
+#import "WhirlyVector.h"
+
+namespace WhirlyKit
+{
+
+/// A single tie between a pixel in an image and a location on the ground
+class GroundControlPoint
+{
+public:
+    GroundControlPoint();
+    GroundControlPoint(const Point2d &pixel,const Point2d &loc);
+
+    /// Pixel location in the image, from the upper left
+    Point2d pixel;
+    /// Where that pixel goes, in the coordinate system of the chunk (radians for geographic)
+    Point2d loc;
+};
+
+/// Ways to fit the ground control points
+typedef enum {GCPFitAffine,GCPFitPolynomial2,GCPFitPolynomial3,GCPFitThinPlateSpline} GroundControlFitType;
+
+/** Georeferencing for images that don't sit neatly on a bounding box.
+    Scanned maps and drone shots come with ground control points instead.
+    We fit a transform from pixels to the ground through those points and then
+    bend a mesh to match, leaving the image alone.
+    Affine and polynomial fits are least squares and report how far off each
+    point is.  Thin plate splines go through every point exactly, unless
+    they're smoothed.
+  */
+class GroundControlWarp
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    GroundControlWarp();
+
+    /// Fit the points for an image of the given size.  False if there aren't enough
+    ///  of them or they're degenerate (all in a line, for instance).
+    /// Smoothing only applies to thin plate splines.  Zero passes through every point.
+    bool fit(GroundControlFitType type,const std::vector<GroundControlPoint> &gcps,int imageWidth,int imageHeight,double smoothing = 0.0);
+
+    /// What went wrong with the fit, if anything
+    const std::string &getError() const { return error; }
+
+    /// Set if we have a usable fit
+    bool isValid() const { return valid; }
+
+    /// Minimum number of points for a given type of fit
+    static int MinPoints(GroundControlFitType type);
+
+    /// Distance between each control point and where the fit puts it, in coordinate system units
+    const std::vector<double> &getResiduals() const { return residuals; }
+    /// Root mean square of the residuals
+    double getRMSError() const { return rmsError; }
+    /// Largest residual
+    double getMaxError() const { return maxError; }
+
+    int getImageWidth() const { return imageWidth; }
+    int getImageHeight() const { return imageHeight; }
+
+    /// Ground location for a pixel in the image
+    Point2d pixelToLocal(const Point2d &pixel) const;
+
+    /// Bounds of the warped image, found by walking its edges
+    void getBounds(Point2d &ll,Point2d &ur) const;
+
+    /** Work out where to put the mesh vertices.
+        Pixel rows and columns are added wherever the mesh strays farther than eps
+        from the warped surface, so density follows the curvature of the warp
+        (and the globe, if toDisplay includes it).  Rows and columns run all the way
+        across so there are no cracks.
+        Results are in pixels, including the edges.
+      */
+    void buildSampleGrid(const std::function<Point3d(const Point2d &)> &toDisplay,double eps,
+                         int minSampleX,int minSampleY,int maxSampleX,int maxSampleY,
+                         std::vector<double> &xs,std::vector<double> &ys) const;
+
+protected:
+    /// Pixels are normalized to about [-1,1] before fitting, for stability
+    Point2d normalizePixel(const Point2d &pixel) const;
+    /// Polynomial terms at a normalized location
+    void polyTerms(const Point2d &pt,int order,double *terms) const;
+    /// Thin plate spline kernel
+    static double tpsKernel(double r2);
+    void calcResiduals(const std::vector<GroundControlPoint> &gcps);
+
+    bool valid;
+    std::string error;
+    GroundControlFitType fitType;
+    int imageWidth,imageHeight;
+    Point2d pixCenter;
+    double pixScale;
+    Point2d locCenter;
+    /// Polynomial or affine coefficients for X and Y
+    std::vector<double> coeffX,coeffY;
+    /// Thin plate spline centers (normalized) and weights
+    std::vector<Point2d> tpsCenters;
+    std::vector<double> tpsWeightX,tpsWeightY;
+    std::vector<double> residuals;
+    double rmsError,maxError;
+};
+
+typedef std::shared_ptr<GroundControlWarp> GroundControlWarpRef;
+
+}
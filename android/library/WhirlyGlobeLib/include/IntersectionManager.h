@@ -44,6 +44,24 @@ public:
     IntersectionManager(Scene *scene);
     ~IntersectionManager();
 
+    /// Where a ray hit something
+    class IntersectionHit
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+        IntersectionHit() : pt(0,0,0), norm(0,0,0), dist(0.0), featureID(EmptyIdentity) { }
+
+        /// Hit point in display coordinates
+        Point3d pt;
+        /// Surface normal in display coordinates, if the intersectable knows it
+        Point3d norm;
+        /// Distance from the eye
+        double dist;
+        /// What we hit, if the intersectable knows.  Geometry instances use their ID.
+        SimpleIdentity featureID;
+    };
+
     /** A base class for intersectable sets of objects.
         Fill in the methods and return the closest valid intersection.
       */
@@ -54,6 +72,9 @@ public:
 
         // Ray is in display coordinates
         virtual bool findClosestIntersection(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,Point3d &iPt,double &dist) = 0;
+
+        // Fill in the normal and feature as well, if you know them.  The default just has the point.
+        virtual bool findClosestHit(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,IntersectionHit &hit);
     };
     
     /// Add an intersectable object
@@ -65,6 +86,9 @@ public:
     /// Look for the nearest intersection and return the point (in display coordinates)
     bool findIntersection(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,Point3d &iPt,double &dist);
 
+    /// Look for the nearest intersection and return the point, normal and feature we hit
+    bool findIntersection(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,IntersectionHit &hit);
+
 protected:
     pthread_mutex_t mutex;
     Scene *scene;
@@ -0,0 +1,114 @@
+/*
+ *  JPEGDecoder.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <string>
+
+namespace WhirlyKit
+{
+
+/** Baseline JPEG decoder.
+    This handles the sequential Huffman JPEGs found inside GeoTIFFs (and most
+    other places), including the abbreviated streams TIFF uses where the tables
+    are stored once for the whole file.  Progressive and arithmetic coded
+    images are rejected.
+  */
+class JPEGDecoder
+{
+public:
+    JPEGDecoder();
+
+    /// Read quantization and Huffman tables from a tables only stream.
+    /// These stick around for subsequent decodes.
+    bool readTables(const unsigned char *data,size_t len);
+
+    /// How to treat three component images.  The default (-1) converts YCbCr
+    ///  to RGB unless an Adobe marker says otherwise.
+    void setColorTransform(int newTransform) { colorTransform = newTransform; }
+
+    /// Decode an image into interleaved 8 bit samples, top row first
+    bool decode(const unsigned char *data,size_t len,std::vector<unsigned char> &pixels,int &width,int &height,int &numComponents);
+
+    /// What went wrong on the last call
+    const std::string &getError() const { return error; }
+
+protected:
+    class HuffmanTable
+    {
+    public:
+        HuffmanTable();
+        bool valid;
+        /// Largest code of each length, or -1
+        int maxCode[18];
+        /// Index into the values for the first code of each length
+        int valPtr[17];
+        /// First code of each length
+        int minCode[17];
+        unsigned char values[256];
+    };
+
+    class Component
+    {
+    public:
+        int id;
+        int hSamp,vSamp;
+        int quantTable;
+        int dcTable,acTable;
+        int dcPred;
+        /// Decoded samples for the component at its own resolution, padded out to whole MCUs
+        std::vector<unsigned char> samples;
+        int stride;
+    };
+
+    bool readMarkers(const unsigned char *data,size_t len,bool tablesOnly);
+    bool readDQT(const unsigned char *data,size_t len);
+    bool readDHT(const unsigned char *data,size_t len);
+    bool readSOF(const unsigned char *data,size_t len);
+    bool readScan(const unsigned char *data,size_t len,size_t &pos);
+    void outputPixels(std::vector<unsigned char> &pixels);
+
+    // Bit level reading of the entropy coded data
+    int readBit();
+    int readBits(int num);
+    int decodeHuffman(const HuffmanTable &table);
+    bool decodeBlock(Component &comp,int blockX,int blockY);
+    void resetBits();
+
+    unsigned short quantTables[4][64];
+    HuffmanTable dcTables[4],acTables[4];
+    std::vector<Component> components;
+    int width,height;
+    int maxHSamp,maxVSamp;
+    int mcusX,mcusY;
+    int restartInterval;
+    int colorTransform;
+    int adobeTransform;
+    bool frameValid;
+
+    const unsigned char *bitData;
+    size_t bitLen,bitPos;
+    unsigned int bitBuf;
+    int bitCount;
+    bool hitMarker;
+
+    std::string error;
+};
+
+}
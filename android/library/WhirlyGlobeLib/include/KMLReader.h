@@ -0,0 +1,139 @@
+/*
+ *  KMLReader.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdio.h>
+#import <string>
+#import <vector>
+#import <map>
+#import "VectorData.h"
+#import "XMLStreamReader.h"
+
+namespace WhirlyKit
+{
+
+/// The parts of a KML Style we use
+class KMLStyle
+{
+public:
+    KMLStyle();
+
+    bool hasLine,hasPoly,hasIcon,hasLabel;
+    RGBAColor lineColor;
+    double lineWidth;
+    RGBAColor polyColor;
+    bool polyFill,polyOutline;
+    RGBAColor iconColor;
+    double iconScale;
+    std::string iconHref;
+    RGBAColor labelColor;
+    double labelScale;
+
+    /// Fill in anything set in the other style
+    void merge(const KMLStyle &that);
+
+    /// Add the style to a shape's attributes.
+    /// The color (MaplyColor) is the one that suits the shape.
+    void addAttributes(VectorShape *shape,Dictionary &attrs) const;
+
+    /// Parse KML's aabbggrr colors
+    static bool ParseColor(const std::string &str,RGBAColor &color);
+};
+
+/** Reads KML and KMZ into shapes as it goes, without building a document tree.
+    Placemarks with Points, LineStrings, LinearRings, Polygons and MultiGeometry are read.
+    Each shape gets the placemark's name, description, time, ExtendedData and
+    the folder it was in as attributes, along with its style.
+    Styles and StyleMaps (the normal style) are resolved, as long as they're
+    defined in the document before they're used.  Network links aren't followed.
+  */
+class KMLReader : public XMLStreamHandler
+{
+public:
+    KMLReader();
+    virtual ~KMLReader();
+
+    /// Called with each placemark's shapes.  If not set, the shapes pile up in getShapes().
+    void setFeatureCallback(const VectorFeatureCallback &callback) { featureCallback = callback; }
+
+    /// Read a KML or KMZ file.  We look at the contents to tell which.
+    bool readFile(const std::string &fileName);
+
+    /// Read KML from an open file
+    bool readKML(FILE *fp);
+
+    /// Read the main KML file out of a KMZ archive
+    bool readKMZ(FILE *fp);
+
+    /// Read KML that's already in memory
+    bool parse(const std::string &xml);
+
+    /// Shapes read, if there's no callback
+    ShapeSet &getShapes() { return shapes; }
+
+    /// Styles seen so far, by ID
+    const std::map<std::string,KMLStyle> &getStyles() const { return styles; }
+
+    const std::string &getError() const { return error; }
+
+    /// XMLStreamHandler methods
+    virtual void startElement(const std::string &name,const XMLAttributes &attrs);
+    virtual void endElement(const std::string &name);
+    virtual void characters(const std::string &text);
+
+protected:
+    /// Parse a coordinates string into geographic radians
+    static void ParseCoordinates(const std::string &str,VectorRing &pts);
+
+    /// Look up a style from a styleUrl, following style maps
+    bool resolveStyle(const std::string &url,KMLStyle &style,int depth = 0) const;
+
+    /// Set when inside the given element
+    bool inElement(const char *name) const;
+    const std::string &parentElement(int up = 1) const;
+
+    void finishPlacemark();
+
+    VectorFeatureCallback featureCallback;
+    ShapeSet shapes;
+    std::string error;
+
+    std::vector<std::string> elements;
+    std::string text;
+
+    std::map<std::string,KMLStyle> styles;
+    std::map<std::string,std::string> styleMaps;
+    KMLStyle curStyle;
+    std::string curStyleID;
+    bool inStyle;
+    std::string curMapID,curPairKey,curPairUrl;
+
+    std::vector<std::string> containerNames;
+
+    bool inPlacemark;
+    Dictionary placemarkAttrs;
+    std::string placemarkStyleUrl;
+    KMLStyle inlineStyle;
+    bool hasInlineStyle;
+    std::vector<VectorShapeRef> placemarkShapes;
+    VectorArealRef curAreal;
+    std::string dataName;
+};
+
+}
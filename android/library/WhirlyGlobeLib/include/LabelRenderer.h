@@ -86,6 +86,58 @@ public:
     RGBAColor outlineColor;
     float outlineSize;
     float lineHeight;
+    float lineSpacing;
+    float wrapWidth;
+    bool wrapInEms;
+    bool wrapBalanced;
+};
+
+/// Where one line starts and stops within a run of glyphs
+class TextLineRange
+{
+public:
+    TextLineRange() : start(0), end(0), width(0.0) { }
+    
+    /// Glyphs from start up to end, without spaces on either side
+    int start,end;
+    /// Width of those glyphs
+    float width;
+};
+
+/** Breaks a run of glyphs into lines no wider than a given width.
+    Lines break at spaces, after hyphens and dashes, and next to CJK characters.
+    A word too wide for any line gets a line to itself.  Balanced breaking
+    keeps the same number of lines as greedy breaking but evens out their lengths.
+  */
+class TextLineBreaker
+{
+public:
+    TextLineBreaker();
+    
+    /// Widest a line can be.  Zero or less for no wrapping.
+    void setMaxWidth(float width) { maxWidth = width; }
+    
+    /// Even out the lines rather than filling each one up
+    void setBalanced(bool newBalanced) { balanced = newBalanced; }
+    
+    /// Break glyphs with the given advances into lines
+    void breakLines(const std::vector<WKGlyph> &glyphs,const std::vector<float> &advances,std::vector<TextLineRange> &lines) const;
+    
+    /// Break the glyphs of a drawable string.  This relies on the code points in the glyph rects.
+    void breakLines(const DrawableString *str,std::vector<TextLineRange> &lines) const;
+    
+protected:
+    // A run of glyphs we can't break within, with the spaces after it
+    class Word
+    {
+    public:
+        int start,end,next;
+    };
+    
+    int greedyBreak(const std::vector<Word> &words,const std::vector<float> &pos,float width,std::vector<TextLineRange> *lines) const;
+    
+    float maxWidth;
+    bool balanced;
 };
     
 /** Used to render a group of labels, possibly on
@@ -28,6 +28,7 @@
 #import "ViewState.h"
 #import "ScreenSpaceBuilder.h"
 #import "SelectionManager.h"
+#import "ClusterStats.h"
 
 namespace WhirlyKit
 {
@@ -75,6 +76,9 @@ public:
 	/// If set, this is clustering group to sort into
 	int clusterGroup;
 
+    /// Attributes to aggregate when this object is clustered
+    DictionaryRef attrs;
+
 	/// Options for where to place this object:  WhirlyKitLayoutPlacementLeft, WhirlyKitLayoutPlacementRight,
     ///  WhirlyKitLayoutPlacementAbove, WhirlyKitLayoutPlacementBelow
     int acceptablePlacement;
@@ -120,8 +124,9 @@ public:
 	// Called right before we start generating layout objects
 	virtual void startLayoutObjects() = 0;
 
-	// Generate a layout object (with screen space object and such) for the cluster
-	virtual void makeLayoutObject(int clusterID,const std::vector<LayoutObjectEntry *> &layoutObjects,LayoutObject &newObj) = 0;
+	// Generate a layout object (with screen space object and such) for the cluster.
+	// The stats hold the aggregates asked for in the cluster class params and make a good cache key.
+	virtual void makeLayoutObject(int clusterID,const std::vector<LayoutObjectEntry *> &layoutObjects,const ClusterStats &stats,LayoutObject &newObj) = 0;
 
 	// Called right after all the layout objects are generated
 	virtual void endLayoutObjects() = 0;
@@ -136,6 +141,8 @@ public:
 		bool selectable;
 		double markerAnimationTime;
 		Point2d clusterSize;
+		// Aggregates to compute over the member attributes
+		std::vector<ClusterStatDef> statDefs;
 	};
 
 	// Return the shader used when moving objects into and out of clusters
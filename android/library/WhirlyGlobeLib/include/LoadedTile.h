@@ -27,6 +27,7 @@
 #import "QuadDisplayController.h"
 #import "TextureAtlas.h"
 #import "ElevationChunk.h"
+#import "ElevationManager.h"
 #import "DynamicDrawableAtlas.h"
 #import "DynamicTextureAtlas.h"
 
@@ -317,6 +318,8 @@ public:
     // Note: Porting
     /// If here, the elevation data needed to build geometry
 //    WhirlyKitElevationChunk *elevData;
+    /// Elevation handed in with the images, if any.  It goes to the elevation manager.
+    ElevationGridTileRef elevTile;
     /// Center of the tile in display coordinates
     Point3d dispCenter;
     /// Size in display coordinates
@@ -72,6 +72,9 @@ public:
     SimpleIdentity markerId;
     float layoutImportance;
     int clusterGroup;
+    /// Halo for signed distance field icons
+    RGBAColor haloColor;
+    float haloWidth,haloBlur;
 };
 
 /** WhirlyKit Marker
@@ -106,6 +109,10 @@ public:
     ///  we show that.  If there's more than one, we switch
     ///  between them over the period.
     std::vector<WhirlyKit::SimpleIdentity> texIDs;
+    /// Name of an icon in a sprite sheet.  Used if there are no texture IDs.
+    /// Screen markers with no size set take the icon's size.
+    /// Distance field icons only work on screen markers.  3D markers using them are skipped.
+    std::string iconName;
     /// If set we'll keep the screen marker upright in screen space
     bool lockRotation;
     /// The height in 3-space (remember the globe has radius = 1.0)
@@ -131,6 +138,8 @@ public:
     float layoutImportance;
     /// A list of vertex attributes to apply to the marker
     SingleVertexAttributeSet vertexAttrs;
+    /// Attributes the layout engine aggregates when this marker is clustered
+    DictionaryRef attrs;
 
     /// Add a texture ID to be displayed
     void addTexID(SimpleIdentity texID);
@@ -0,0 +1,134 @@
+/*
+ *  MemTracker.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <vector>
+#import <map>
+#import <unordered_map>
+#import <string>
+#import "Identifiable.h"
+
+namespace WhirlyKit
+{
+
+/// Kinds of objects we keep track of
+typedef enum {MemTrackDrawable,MemTrackTexture,MemTrackSelectable,MemTrackLayoutObject,MemTrackSceneRep,MemTrackNumKinds} MemTrackKind;
+
+/// Live totals and high water marks for one owner tag
+class MemTagStats
+{
+public:
+    MemTagStats();
+
+    /// Layer or manager that made the objects
+    std::string owner;
+    /// Label the caller gave us, if any
+    std::string label;
+
+    /// Live objects and bytes by kind
+    int count[MemTrackNumKinds];
+    unsigned long bytes[MemTrackNumKinds];
+    /// Most we've seen at once by kind
+    int maxCount[MemTrackNumKinds];
+    unsigned long maxBytes[MemTrackNumKinds];
+    /// Live bytes over all kinds and its high water mark
+    unsigned long totalBytes,maxTotalBytes;
+};
+
+/// An object that was still around when we checked
+class MemLeak
+{
+public:
+    MemTrackKind kind;
+    SimpleIdentity objID;
+    std::string owner,label;
+    unsigned long bytes;
+};
+
+/** Attributes drawables, textures, selectables, layout objects and scene reps
+    to an owner tag as they come and go.  Owners are the layer or manager that made
+    the object and an optional label from the caller.
+    Adds and removes are a lookup and a few adds, so this stays on in release.
+  */
+class MemTracker
+{
+public:
+    MemTracker();
+    ~MemTracker();
+
+    /// Turn the accounting on or off.  On by default.
+    /// Turning it off stops new objects from being noted, but removals still go through.
+    void setEnable(bool newVal) { enable = newVal; }
+    bool getEnable() const { return enable; }
+
+    /// Tag for the given owner and label, making it if need be.
+    /// Tags never change, so resolve them once and hang on to them.
+    int getTag(const std::string &owner,const std::string &label);
+
+    /// Note a new object.  Adding one we already have replaces it.
+    void addObject(MemTrackKind kind,SimpleIdentity objID,int tag,unsigned long bytes);
+
+    /// Note a new object by owner and label, for callers that don't have a tag.
+    /// Prefer the tag version in anything that adds a lot of objects.
+    void addObject(MemTrackKind kind,SimpleIdentity objID,const std::string &owner,const std::string &label,unsigned long bytes);
+
+    /// An object went away.  Ones we never saw are ignored.
+    void removeObject(MemTrackKind kind,SimpleIdentity objID);
+
+    /// Forget everything of the given kind, as when the scene drops them all at once
+    void removeAll(MemTrackKind kind);
+
+    /// Live totals per tag
+    void getStats(std::vector<MemTagStats> &stats);
+
+    /// Objects that are still around, sorted by owner
+    void findLeaks(std::vector<MemLeak> &leaks);
+
+    /// Log what's still around, listing up to maxPerTag objects per owner.  Returns the number of objects.
+    int logLeaks(int maxPerTag=10);
+
+    /// Log the totals per tag
+    void dumpStats();
+
+    /// Readable name for a kind
+    static const char *KindName(MemTrackKind kind);
+
+protected:
+    class LiveEntry
+    {
+    public:
+        int tag;
+        unsigned long bytes;
+    };
+
+    // Caller has the lock
+    int getTagLocked(const std::string &owner,const std::string &label);
+    void addLocked(MemTrackKind kind,SimpleIdentity objID,int tag,unsigned long bytes);
+    void removeLocked(MemTrackKind kind,SimpleIdentity objID);
+
+    pthread_mutex_t lock;
+    bool enable;
+
+    std::map<std::pair<std::string,std::string>,int> tagMap;
+    std::vector<MemTagStats> tags;
+    std::unordered_map<SimpleIdentity,LiveEntry> live[MemTrackNumKinds];
+};
+
+}
@@ -0,0 +1,148 @@
+/*
+ *  MeshBVH.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <atomic>
+#import <deque>
+#import <map>
+#import <memory>
+#import <vector>
+#import "Identifiable.h"
+#import "WhirlyVector.h"
+#import "IntersectionManager.h"
+
+namespace WhirlyKit
+{
+
+/** Bounding volume hierarchy over the triangles of one mesh, in the mesh's own coordinates.
+    Add the triangles, then build it (usually on the builder thread).  Once it's built
+    it doesn't change, so any number of threads can query it and instances can share it.
+  */
+class MeshBVH
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    MeshBVH();
+
+    /// Add triangles given as three indices each into the points.  Only before it's built.
+    void addTriangles(const Point3d *pts,int numPts,const std::vector<int> &triVerts);
+
+    /// Sort the triangles into the hierarchy
+    void build();
+
+    /// Set once build() is done.  It won't hit anything until then.
+    bool isBuilt() const { return built; }
+
+    /// Number of triangles
+    int numTriangles() const { return (int)triPts.size()/3; }
+
+    /// Bounds of the whole mesh.  Only valid once built.
+    const BBox &getBounds() const { return bounds; }
+
+    /// Closest hit along the ray that's nearer than maxT.
+    /// t is in units of dir, which needn't be normalized.  The normal is the triangle's and faces the ray.
+    bool intersect(const Point3d &org,const Point3d &dir,double maxT,double &t,Point3d &norm,int &triIndex) const;
+
+protected:
+    // Leaves have a count and point at their first triangle.  Others point at their second child.
+    class Node
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+        Point3d ll,ur;
+        int offset;
+        int count;
+    };
+
+    // Sort the triangles between start and end into nodes
+    int buildNode(std::vector<int> &tris,const Point3dVector &centers,int start,int end);
+
+    std::atomic<bool> built;
+    BBox bounds;
+    // Three points per triangle, reordered to match the leaves once built
+    Point3dVector triPts;
+    // Original index of each triangle
+    std::vector<int> triIndices;
+    std::vector<Node,Eigen::aligned_allocator<Node> > nodes;
+};
+
+typedef std::shared_ptr<MeshBVH> MeshBVHRef;
+
+/** Ray intersection against meshes, each of which can be placed any number of times.
+    Instances share their mesh's BVH and the ray is moved into the mesh's coordinates instead.
+    BVHs are built on a worker thread as they come in.  Until one is done, its instances are skipped.
+    Instances are kept in groups, such as all the ones a manager added in one call.
+  */
+class MeshIntersectable : public IntersectionManager::Intersectable
+{
+public:
+    MeshIntersectable();
+    virtual ~MeshIntersectable();
+
+    /// Queue a mesh to be built on the worker thread
+    void buildBVH(MeshBVHRef bvh);
+
+    /// Place a mesh in display space with the given matrix.  The feature ID comes back with any hits.
+    void addInstance(SimpleIdentity groupID,MeshBVHRef bvh,const Eigen::Matrix4d &mat,SimpleIdentity featureID,float minVis,float maxVis,bool enable);
+
+    /// Turn a group of instances on or off
+    void enableGroup(SimpleIdentity groupID,bool enable);
+
+    /// Remove a group of instances
+    void removeGroup(SimpleIdentity groupID);
+
+    /// Closest hit with the normal and feature ID
+    virtual bool findClosestHit(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,IntersectionManager::IntersectionHit &hit);
+
+    /// Closest hit point
+    virtual bool findClosestIntersection(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,Point3d &iPt,double &dist);
+
+    /// Called by the worker thread
+    void runBuilder();
+
+protected:
+    class MeshInstance
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+        MeshBVHRef bvh;
+        Eigen::Matrix4d mat,invMat;
+        SimpleIdentity featureID;
+        float minVis,maxVis;
+        bool enable;
+    };
+    typedef std::vector<MeshInstance,Eigen::aligned_allocator<MeshInstance> > MeshInstanceVector;
+
+    pthread_mutex_t lock;
+    std::map<SimpleIdentity,MeshInstanceVector> groups;
+
+    // Builder thread and its queue
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueCond;
+    pthread_t builderThread;
+    bool threadStarted;
+    bool shutdown;
+    std::deque<MeshBVHRef> buildQueue;
+};
+
+}
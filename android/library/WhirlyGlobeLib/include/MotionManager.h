@@ -0,0 +1,214 @@
+/*
+ *  MotionManager.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <map>
+#import <vector>
+#import <pthread.h>
+#import "Identifiable.h"
+#import "WhirlyVector.h"
+#import "WhirlyTypes.h"
+#import "Scene.h"
+
+namespace WhirlyKit
+{
+
+class Marker;
+class SingleLabel;
+
+/// A single position report for a moving object
+class MotionObservation
+{
+public:
+    MotionObservation();
+    MotionObservation(const GeoCoord &loc,TimeInterval when);
+
+    /// When the report was made.  This is your clock, not necessarily the system's.
+    TimeInterval when;
+    /// Where the object was, in radians
+    GeoCoord loc;
+    /// Position accuracy in meters (one standard deviation).  0 means use the default.
+    double accuracy;
+    /// Set if the report includes a heading and speed
+    bool hasVelocity;
+    /// Heading clockwise from north in radians
+    double heading;
+    /// Speed in meters per second
+    double speed;
+};
+
+/// Where we think a moving object is at a given time
+class MotionSample
+{
+public:
+    MotionSample();
+
+    /// Location to display, in radians
+    GeoCoord loc;
+    /// Heading clockwise from north in radians
+    double heading;
+    /// Speed in meters per second
+    double speed;
+    /// Set if this is past the last report
+    bool extrapolated;
+
+    /// Rotation for markers and labels that lines them up with the heading
+    double screenRotation() const;
+};
+
+/// Parameters controlling the motion filters
+class MotionParams
+{
+public:
+    MotionParams();
+
+    /// How much we expect objects to accelerate (standard deviation in meters/second^2)
+    double processNoise;
+    /// Position accuracy for reports that don't have one (meters)
+    double defaultAccuracy;
+    /// Accuracy of reported speeds (meters/second)
+    double velocityAccuracy;
+    /// How unsure we are of the velocity of a new object (meters/second)
+    double initialVelocityAccuracy;
+    /// Time to blend from what we were showing to the new estimate after a report (seconds)
+    TimeInterval blendTime;
+    /// If the new estimate is further than this from what we were showing, jump to it (meters)
+    double snapDistance;
+    /// How long past the last report we'll keep moving an object (seconds)
+    TimeInterval maxExtrapolate;
+    /// Below this speed the heading is held rather than recalculated (meters/second)
+    double minHeadingSpeed;
+};
+
+/** Motion filter for a single object.
+    This is a constant velocity Kalman filter working on a plane tangent
+    to the earth at the last estimate.  Rather than jump when a new report
+    comes in, what we display blends from the old path to the new one.
+    Everything is a function of the reports and the time you ask about, so
+    the results are repeatable.
+  */
+class MotionFilter
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    MotionFilter();
+
+    /// Fold in a new report.  Returns false if it was older than the last one and was ignored.
+    bool addObservation(const MotionObservation &obs,const MotionParams &params);
+
+    /// Where to display the object at the given time
+    void sample(TimeInterval when,const MotionParams &params,MotionSample &sample) const;
+
+    /// The filter's estimate at the given time, without any blending
+    void estimate(TimeInterval when,const MotionParams &params,GeoCoord &outLoc,Point2d &outVel) const;
+
+    /// True once we've had at least one report
+    bool isValid() const { return valid; }
+
+    /// Time of the last report
+    TimeInterval getLastTime() const { return lastTime; }
+
+    /// Velocity estimate (east and north, in meters/second)
+    Point2d getVelocity() const { return vel; }
+
+protected:
+    /// Estimate at the given time as longitude and latitude
+    Point2d estimateLoc(TimeInterval when,const MotionParams &params,bool &moving) const;
+    /// Display location at the given time as longitude and latitude
+    Point2d displayLoc(TimeInterval when,const MotionParams &params,bool &moving) const;
+
+    bool valid;
+    TimeInterval lastTime;
+    /// Position estimate as of the last report (longitude and latitude in radians)
+    Point2d loc;
+    /// Velocity estimate, east and north
+    Point2d vel;
+    /// Covariance for east, north and their velocities
+    Eigen::Matrix4d cov;
+    /// Offset from the estimate to what we were displaying when the last report came in (meters, east and north)
+    Point2d blendOffset;
+    /// Last heading we trusted
+    double heading;
+};
+
+/// Motion over an interval, in a form markers and labels can use
+class MotionSegment
+{
+public:
+    MotionSegment();
+
+    GeoCoord startLoc,endLoc;
+    TimeInterval startTime,endTime;
+    /// Rotation to line up with the heading, as markers and labels want it
+    double rotation;
+
+    /// Set up a marker to move along this segment, facing the heading
+    void applyToMarker(Marker &marker) const;
+
+    /// Set up a label to move along this segment, rotated to the heading
+    void applyToLabel(SingleLabel &label) const;
+};
+
+typedef std::map<SimpleIdentity,MotionFilter,std::less<SimpleIdentity>,Eigen::aligned_allocator<std::pair<const SimpleIdentity,MotionFilter> > > MotionFilterMap;
+
+#define kWKMotionManager "WKMotionManager"
+
+/** The Motion Manager tracks live objects that report their positions now and again.
+    It keeps a motion filter for each object and will tell you where to display it
+    at any given time, interpolating and extrapolating between reports.
+    Sampling is cheap and thread safe so you can do it every frame, or you can
+    hand markers and labels a segment to move along and refresh them periodically.
+  */
+class MotionManager : public SceneManager
+{
+public:
+    MotionManager();
+    virtual ~MotionManager();
+
+    /// Set the parameters used by all the filters
+    void setParams(const MotionParams &newParams);
+    MotionParams getParams();
+
+    /// Add a report for the given object, creating it if need be.
+    /// Returns false if the report was out of order.
+    bool addObservation(SimpleIdentity objID,const MotionObservation &obs);
+
+    /// Stop tracking the given objects
+    void removeObjects(const SimpleIDSet &objIDs);
+
+    /// Number of objects being tracked
+    int numObjects();
+
+    /// Where to display the given object at a particular time.  False if we don't know it.
+    bool sample(SimpleIdentity objID,TimeInterval when,MotionSample &sample);
+
+    /// Sample all the objects at once
+    void sampleAll(TimeInterval when,std::vector<SimpleIdentity> &objIDs,std::vector<MotionSample> &samples);
+
+    /// Motion for the given object from startTime over the duration.  False if we don't know it.
+    bool calcSegment(SimpleIdentity objID,TimeInterval startTime,TimeInterval duration,MotionSegment &segment);
+
+protected:
+    pthread_mutex_t motionLock;
+    MotionParams params;
+    MotionFilterMap filters;
+};
+
+}
@@ -19,6 +19,7 @@
  */
 
 #import <vector>
+#import <map>
 #import "glwrapper.h"
 #import "WhirlyTypes.h"
 #import "Identifiable.h"
@@ -119,6 +120,9 @@ public:
 
     /// Initialize with both shader programs
     OpenGLES2Program(const std::string &name,const std::string &vShaderString,const std::string &fShaderString);
+
+    /// Initialize with both shader programs and bind the given attributes to fixed locations before linking
+    OpenGLES2Program(const std::string &name,const std::string &vShaderString,const std::string &fShaderString,const std::map<std::string,int> &attrLocations);
     
     /// Return true if it was built correctly
     bool isValid();
@@ -165,6 +169,9 @@ public:
     void cleanUp();
 
 protected:
+    // Compile, bind any attribute locations and link
+    void init(const std::string &vShaderString,const std::string &fShaderString,const std::map<std::string,int> *attrLocations);
+
     std::string name;
     GLuint program;
     GLuint vertShader;
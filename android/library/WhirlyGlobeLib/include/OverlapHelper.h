@@ -29,6 +29,7 @@
 #import "ScreenSpaceBuilder.h"
 #import "SelectionManager.h"
 #import "WhirlyVector.h"
+#import "ClusterStats.h"
 
 
 namespace WhirlyKit
@@ -71,6 +72,9 @@ public:
 
     ClusterHelper(const Mbr &mbr,int sizeX, int sizeY, float resScale, const Point2d &clusterMarkerSize);
     
+    // Aggregates to build up for each cluster as objects join
+    void setStatDefs(const std::vector<ClusterStatDef> &defs) { statDefs = defs; }
+    
     // Add an object, possibly forming a group
     void addObject(LayoutObjectEntry *objEntry,const Point2dVector pts);
 
@@ -101,6 +105,7 @@ public:
     public:
         ClusterObject();
         std::vector<int> children;
+        ClusterStats stats;
     };
     
     // List of objects for this cluster
@@ -117,7 +122,11 @@ public:
     
     void calcCells(const Mbr &mbr,int &sx,int &sy,int &ex,int &ey);
 
+    // Add a simple object's contribution to a cluster's aggregates
+    void addToStats(ClusterObject &cluster,const SimpleObject &obj);
+
     Point2d clusterMarkerSize;
+    std::vector<ClusterStatDef> statDefs;
     
     Mbr mbr;
     std::vector<SimpleObject> simpleObjects;
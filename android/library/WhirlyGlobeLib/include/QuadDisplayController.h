@@ -23,6 +23,7 @@
 #import "Scene.h"
 #import "GlobeMath.h"
 #import "Quadtree.h"
+#import "TileMatrixSet.h"
 #import "SceneRendererES.h"
 #import "ScreenImportance.h"
 #import "ViewState.h"
@@ -73,6 +74,10 @@ public:
     /// Return the maximum quad tree zoom level.  Must be at least minZoom
     virtual int getMaxZoom() = 0;
     
+    /// Return a tile matrix set if your tiling scheme isn't a power of two quad tree over the total extents.
+    /// The default is empty, which means the usual quad tree.
+    virtual TileMatrixSetRef getTileMatrixSet() { return TileMatrixSetRef(); }
+    
     /// Return an importance value for the given tile
     virtual double importanceForTile(const Quadtree::Identifier &ident,const Mbr &mbr,ViewState *viewState,const Point2f &frameSize,Dictionary *attrs) = 0;
     
@@ -20,6 +20,7 @@
 #import <set>
 #import <Eigen/Eigen>
 #import "Quadtree.h"
+#import "TileMatrixSet.h"
 #import "GlobeView.h"
 #import "SceneRendererES.h"
 
@@ -128,7 +129,15 @@ public:
     /// @brief Return the min zoom level
     int getMinLevel();
     
+    /** @brief Set the tile matrix set, if the tiles aren't a regular quad tree over the extents.
+      */
+    void setTileMatrixSet(TileMatrixSetRef newTileMatrixSet);
+    
 private:
+    /// Look for the most detailed tile we have under the given point
+    void findTile(QuadTrackerPointReturn *trackInfo,int which,const Point2d &coordPt);
+
+    TileMatrixSetRef tileMatrixSet;
     CoordSystem *coordSys;
     pthread_mutex_t tilesLock;
     int minLevel;
@@ -21,12 +21,16 @@
 #import "WhirlyVector.h"
 #import "Dictionary.h"
 #import <set>
+#import <vector>
+#import <memory>
 
 namespace WhirlyKit
 {
 
 class QuadTreeImportanceCalculator;
 class ViewState;
+class TileMatrixSet;
+typedef std::shared_ptr<TileMatrixSet> TileMatrixSetRef;
     
 /** The Quadtree is used to represented the quad tree spatial subdivision
     algorithm.  This version tracks abstract representations of quad tree
@@ -41,6 +45,9 @@ public:
     /// Construct with the spatial information, number of nodes, min importance to consider
     ///  and a delegate to calculate importance.
     Quadtree(Mbr mbr,int minLevel,int maxLevel,int maxNodes,float minImportance,QuadTreeImportanceCalculator *importDelegate);
+    /// Construct with a tile matrix set describing the levels, for tiling schemes
+    ///  that aren't a regular power of two quad tree.
+    Quadtree(TileMatrixSetRef tileMatrixSet,int minLevel,int maxLevel,int maxNodes,float minImportance,QuadTreeImportanceCalculator *importDelegate);
     ~Quadtree();
 
     /// Represents a single quad tree node
@@ -196,6 +203,13 @@ public:
     /// Return the IDs for this node's children.  Doesn't check if they're there
     void childrenForNode(const Identifier &ident,std::vector<Identifier> &childIdents);
     
+    /// Return the ID for this node's parent.  Doesn't check if it's there.
+    /// Returns false for nodes at the minimum level.
+    bool parentForNode(const Identifier &ident,Identifier &parentIdent);
+
+    /// Return the IDs for the nodes at the minimum level
+    void topLevelNodes(std::vector<Identifier> &idents);
+
     /// Check if a parent is in the process of loading
     bool parentIsLoading(const Identifier &ident);
     
@@ -235,6 +249,9 @@ public:
     /// Return the quad tree's bounding box
     Mbr getMbr() const { return mbr; }
     
+    /// Return the tile matrix set describing the levels
+    TileMatrixSetRef getTileMatrixSet() const { return tileMatrixSet; }
+    
     /// Return the number of active phantom nodes
     int getNumPhantom() const { return numPhantomNodes; }
     
@@ -286,27 +303,33 @@ protected:
         bool hasNonPhantomParent();
         void Print();
         /// Recalculate child coverage
-        bool recalcCoverage();
+        bool recalcCoverage(Quadtree *tree);
  
     protected:
         NodesByIdentType::iterator identPos;
         NodesBySizeType::iterator sizePos;
         NodesBySizeType::iterator evalPos;
         Node *parent;
-        Node *children[4];
-        bool childOffscreen[4];
+        std::vector<Node *> children;
+        /// For regular quad trees, which of our four children are offscreen
+        bool quadChildOffscreen[4];
+        /// Otherwise, overlapping tiles at the next level we know are offscreen
+        std::set<Identifier> childOffscreen;
     };
         
     Node *getNode(const Identifier &ident);
     void removeNode(Node *);
     /// Recalculate child coverage for a node and its parents
     void recalcCoverage(Node *node);
+    /// Let the tiles this one covers know it's offscreen
+    void setChildOffscreen(const Identifier &ident);
     /// Add an entry for the given flag index
     void addFrameLoaded(int frame);
     /// Clear the flag counts for the given flag entries
     void clearFlagCounts(int frameFlags);
 
     Mbr mbr;
+    TileMatrixSetRef tileMatrixSet;
     int minLevel,maxLevel;
     int maxNodes;
     float minImportance;
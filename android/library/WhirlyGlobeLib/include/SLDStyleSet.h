@@ -0,0 +1,227 @@
+/*
+ *  SLDStyleSet.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <string>
+#import <map>
+#import <memory>
+#import <functional>
+#import "WhirlyVector.h"
+#import "Dictionary.h"
+
+namespace WhirlyKit
+{
+
+/** A minimal XML element, enough to read an SLD document.  Built with the XMLStreamReader.
+    Namespace prefixes are dropped from element and attribute names.
+  */
+class SLDXMLNode
+{
+public:
+    std::string name;
+    std::map<std::string,std::string> attrs;
+    /// Text directly inside this element, trimmed
+    std::string text;
+    std::vector<std::shared_ptr<SLDXMLNode> > children;
+
+    /// First child with the given name, or null
+    SLDXMLNode *child(const std::string &name) const;
+
+    /// Attribute value, or empty
+    std::string attr(const std::string &name) const;
+
+    /// Parse a whole document and return the root element.  Null on failure, with an error.
+    static std::shared_ptr<SLDXMLNode> Parse(const std::string &xml,std::string &error);
+};
+
+typedef std::shared_ptr<SLDXMLNode> SLDXMLNodeRef;
+
+/// A value from an expression.  Either a number or a string, or nothing at all.
+class SLDValue
+{
+public:
+    SLDValue() : valid(false), isNum(false), num(0.0) { }
+
+    bool valid;
+    bool isNum;
+    double num;
+    std::string str;
+
+    /// Set from a string, noting if it's also a number
+    void setString(const std::string &inStr);
+    /// Set from a number
+    void setNumber(double inNum);
+    /// As a string for display
+    std::string asString() const;
+};
+
+/// An ogc expression: a property, a literal or some arithmetic
+class SLDExpression
+{
+public:
+    virtual ~SLDExpression() { }
+
+    /// Evaluate against a feature's attributes
+    virtual void evaluate(const Dictionary &attrs,SLDValue &ret) const = 0;
+};
+
+typedef std::shared_ptr<SLDExpression> SLDExpressionRef;
+
+/// A compiled ogc:Filter, or part of one
+class SLDFilter
+{
+public:
+    virtual ~SLDFilter() { }
+
+    /// True if the feature passes
+    virtual bool matches(const Dictionary &attrs) const = 0;
+};
+
+typedef std::shared_ptr<SLDFilter> SLDFilterRef;
+
+/// Which manager the build parameters are meant for
+typedef enum {SLDVectorParams,SLDMarkerParams,SLDLabelParams} SLDParamsType;
+
+/** One symbolizer from a rule, boiled down to the build parameters for a manager.
+    Line and polygon symbolizers go to the vector manager (a polygon with a fill
+    and a stroke becomes two of these), points to the marker manager and text to the label manager.
+  */
+class SLDSymbolizer
+{
+public:
+    SLDSymbolizer();
+
+    SLDParamsType type;
+    /// Build parameters, including draw priority and the visibility range from the rule
+    Dictionary desc;
+
+    /// Text symbolizers: what goes in the label
+    SLDExpressionRef label;
+
+    /// Point symbolizers: a well known mark (square, circle, triangle, star, cross, x), or an external graphic.
+    /// Making the image is up to the platform.
+    std::string wellKnownName;
+    std::string graphicHref,graphicFormat;
+    /// Inline graphic content and its encoding, usually base64
+    std::string graphicContent,graphicEncoding;
+    RGBAColor markFill,markStroke;
+    double graphicSize;
+
+    /// Label text for a feature, empty if there isn't any
+    std::string labelText(const Dictionary &attrs) const;
+};
+
+typedef std::shared_ptr<SLDSymbolizer> SLDSymbolizerRef;
+
+/// A rule with its filter, scale range and symbolizers
+class SLDRule
+{
+public:
+    SLDRule();
+
+    std::string name;
+    /// Null for a rule that takes everything
+    SLDFilterRef filter;
+    /// Only applies if nothing else in the feature type style matched
+    bool elseFilter;
+    /// Scale denominator range.  Zero for none.
+    double minScale,maxScale;
+    std::vector<SLDSymbolizerRef> symbolizers;
+
+    /// Check the scale denominator.  Pass zero or less to skip the check.
+    bool inScale(double scale) const;
+};
+
+typedef std::shared_ptr<SLDRule> SLDRuleRef;
+
+/// Rules are grouped into feature type styles, which are checked independently
+class SLDFeatureTypeStyle
+{
+public:
+    std::vector<SLDRuleRef> rules;
+};
+
+typedef std::shared_ptr<SLDFeatureTypeStyle> SLDFeatureTypeStyleRef;
+
+/// A named layer, with the feature type styles from all its user styles
+class SLDNamedLayer
+{
+public:
+    std::string name;
+    std::vector<SLDFeatureTypeStyleRef> featureTypeStyles;
+};
+
+typedef std::shared_ptr<SLDNamedLayer> SLDNamedLayerRef;
+
+/** Styled Layer Descriptor (SLD 1.0 and SE 1.1) style set.
+    The XML is parsed once.  Filters are compiled into evaluators that work right on
+    a feature's attribute dictionary and the symbolizers are turned into build
+    parameters for the vector, marker and label managers.
+  */
+class SLDStyleSet
+{
+public:
+    SLDStyleSet();
+
+    /// Converts a scale denominator into a viewer height for minVis and maxVis.
+    /// Set this before parsing, otherwise the scale ranges are only checked by matchingSymbolizers().
+    void setHeightForScale(const std::function<double(double)> &func) { heightForScale = func; }
+
+    /// Draw priority for the first symbolizer.  Each one after that goes up by one.
+    void setBaseDrawPriority(int priority) { baseDrawPriority = priority; }
+
+    /// Parse the document.  False on failure, see getError().
+    bool parse(const std::string &xml);
+
+    const std::string &getError() const { return error; }
+
+    const std::vector<SLDNamedLayerRef> &getLayers() const { return layers; }
+
+    /// Layer by name, or null
+    SLDNamedLayerRef getLayer(const std::string &name) const;
+
+    /** Symbolizers that apply to a feature, in drawing order.
+        If the layer name is empty, every layer is checked.
+        Pass a scale denominator of zero to ignore the scale ranges.
+      */
+    void matchingSymbolizers(const Dictionary &attrs,const std::string &layerName,double scale,std::vector<SLDSymbolizerRef> &syms) const;
+
+    /// Parse a #RRGGBB color, with an opacity from 0 to 1
+    static bool ParseColor(const std::string &str,double opacity,RGBAColor &color);
+
+protected:
+    void parseNamedLayer(SLDXMLNode *node);
+    void parseFeatureTypeStyle(SLDXMLNode *node,SLDNamedLayer *layer);
+    SLDRuleRef parseRule(SLDXMLNode *node);
+    SLDFilterRef parseFilter(SLDXMLNode *node);
+    SLDExpressionRef parseExpression(SLDXMLNode *node);
+    void parseSymbolizer(SLDXMLNode *node,SLDRule *rule);
+
+    /// Priority and visibility common to all the symbolizers
+    void setupDesc(SLDRule *rule,Dictionary &desc);
+
+    std::function<double(double)> heightForScale;
+    int baseDrawPriority;
+    int drawPriority;
+    std::string error;
+    std::vector<SLDNamedLayerRef> layers;
+};
+
+}
@@ -0,0 +1,233 @@
+/*
+ *  ScalarGrid.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <vector>
+#import <map>
+#import <memory>
+#import "WhirlyVector.h"
+#import "RawData.h"
+#import "Quadtree.h"
+#import "Drawable.h"
+#import "OpenGLES2Program.h"
+
+namespace WhirlyKit
+{
+
+/// Type of the raw values in a scalar grid
+typedef enum {ScalarGridUInt8,ScalarGridInt16,ScalarGridUInt16,ScalarGridFloat32} ScalarGridDataType;
+
+/** A single channel grid of values, such as temperature or radar reflectivity.
+    Raw values are converted with value = raw * scale + offset.
+    A raw value matching the no data value (before scaling) is left out.
+    Rows go from the top down, like an image.
+  */
+class ScalarGrid
+{
+public:
+    /// Construct with the size, type and values in native byte order
+    ScalarGrid(int width,int height,ScalarGridDataType dataType,RawDataRef data);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    ScalarGridDataType getDataType() const { return dataType; }
+
+    /// Conversion from raw to real values
+    void setScaleOffset(double inScale,double inOffset) { scale = inScale;  offset = inOffset; }
+    double getScale() const { return scale; }
+    double getOffset() const { return offset; }
+
+    /// Raw value that means there's nothing there
+    void setNoData(double inNoData) { hasNoData = true;  noData = inNoData; }
+    void clearNoData() { hasNoData = false; }
+
+    /// Check the data is big enough for the size and type
+    bool isValid() const;
+
+    /// Bytes in a single raw value
+    static int BytesPerValue(ScalarGridDataType dataType);
+
+    /// Value at a single cell.  False if it's outside or there's no data.
+    bool valueAt(int x,int y,double &val) const;
+
+    /// Value at a pixel location, (0,0) being the upper left corner of the grid.
+    /// Bilinear, unless one of the neighbors is missing, in which case it's the nearest.
+    bool sample(double px,double py,double &val) const;
+
+    /// Real value range of the whole grid, skipping no data.  False if it's all empty.
+    bool getRange(double &minVal,double &maxVal) const;
+
+protected:
+    /// Raw value at a cell, before the scale and offset
+    double rawValue(int x,int y) const;
+
+    int width,height;
+    ScalarGridDataType dataType;
+    RawDataRef data;
+    double scale,offset;
+    bool hasNoData;
+    double noData;
+};
+
+typedef std::shared_ptr<ScalarGrid> ScalarGridRef;
+
+/** How values are packed into an ordinary RGBA texture.
+    OpenGL ES 2 doesn't reliably do float or 16 bit textures, so we scale
+    the values into the range and keep 16 bits in red and green.  Alpha
+    marks no data.  Values outside the range are clamped to it.
+  */
+class ScalarGridEncoding
+{
+public:
+    ScalarGridEncoding();
+    ScalarGridEncoding(double minVal,double maxVal);
+
+    double minVal,maxVal;
+
+    /// Pack a grid into RGBA, four bytes per cell
+    RawDataRef pack(const ScalarGrid &grid) const;
+
+    /// Pack a single value (or no data) into a pixel
+    void encode(double val,bool valid,unsigned char *pixel) const;
+
+    /// Unpack a pixel.  False if it's no data.
+    bool decode(const unsigned char *pixel,double &val) const;
+};
+
+/** A color map from values to colors.
+    Colors are interpolated between the stops, or held until the next
+    one if it's discrete.  Values past the ends take the end colors.
+    On the GPU this becomes a ramp texture, so it can be swapped without
+    touching the data.
+  */
+class ColorMap
+{
+public:
+    /// Texels in the ramp texture
+    static const int RampSize = 1024;
+
+    ColorMap();
+
+    /// Add a stop.  They're kept sorted by value.
+    void addStop(double value,const RGBAColor &color);
+
+    /// Hold colors between stops rather than blending
+    void setDiscrete(bool inDiscrete) { discrete = inDiscrete; }
+    bool getDiscrete() const { return discrete; }
+
+    bool empty() const { return stops.empty(); }
+    double getMinValue() const;
+    double getMaxValue() const;
+
+    /// Exact color for a value
+    RGBAColor colorFor(double value) const;
+
+    /// The ramp, RampSize texels across and one down
+    RawDataRef makeRamp() const;
+
+    /// Color for a value the way the shader finds it in the ramp
+    RGBAColor rampColorFor(double value) const;
+
+protected:
+    std::vector<std::pair<double,RGBAColor> > stops;
+    bool discrete;
+};
+
+/// Build the scalar grid shader.  Rendering thread only.
+/// Each layer gets its own, since the color map and filter are set on the program.
+OpenGLES2Program *BuildScalarGridProgram(const std::string &name);
+
+/** Colors a layer of packed scalar grid tiles at draw time.
+    The tile layer should use the program (with nearest neighbor filtering, since
+    interpolating packed values won't work) and load tiles packed with the same encoding.
+    Color map and filter changes only touch the program.
+  */
+class ScalarGridColorizer
+{
+public:
+    ScalarGridColorizer(const ScalarGridEncoding &encoding);
+
+    /// Program built with BuildScalarGridProgram() and added to the scene
+    void setProgramID(SimpleIdentity progID,ChangeSet &changes);
+    SimpleIdentity getProgramID() const { return progID; }
+
+    const ScalarGridEncoding &getEncoding() const { return encoding; }
+
+    /// Swap in a new color map.  The old ramp texture is removed.
+    void setColorMap(const ColorMap &colorMap,ChangeSet &changes);
+
+    /// Only show values in the given range
+    void setValueFilter(double minVal,double maxVal,ChangeSet &changes);
+
+    /// Show everything again
+    void clearValueFilter(ChangeSet &changes);
+
+    /// Remove the ramp texture.  The program belongs to whoever added it.
+    void shutdown(ChangeSet &changes);
+
+    /// What the shader does to a packed pixel.  False if it's dropped.
+    bool colorForPixel(const unsigned char *pixel,RGBAColor &color) const;
+
+    /// Colorize a whole grid on the CPU, exactly as the shader would
+    RawDataRef colorize(const ScalarGrid &grid) const;
+
+protected:
+    /// Push the range and filter to the program
+    void updateUniforms(ChangeSet &changes);
+
+    ScalarGridEncoding encoding;
+    ColorMap colorMap;
+    double filterMin,filterMax;
+    SimpleIdentity progID;
+    SimpleIdentity rampTexID;
+};
+
+/** Keeps the grids for loaded tiles so we can look up values under a point.
+    Handy for tool tips.  The most detailed tile covering a point wins.
+    It's thread safe.
+  */
+class ScalarGridSampler
+{
+public:
+    ScalarGridSampler();
+    virtual ~ScalarGridSampler();
+
+    /// Add a tile's grid, with its bounds in the layer's coordinate system
+    void addTile(const Quadtree::Identifier &ident,const Point2d &ll,const Point2d &ur,ScalarGridRef grid);
+
+    /// Forget a tile that's been unloaded
+    void removeTile(const Quadtree::Identifier &ident);
+
+    /// Value at a point in the layer's coordinate system.  False if there's nothing there.
+    bool valueAt(const Point2d &pt,double &val);
+
+protected:
+    class TileGrid
+    {
+    public:
+        Point2d ll,ur;
+        ScalarGridRef grid;
+    };
+
+    pthread_mutex_t gridLock;
+    std::map<Quadtree::Identifier,TileGrid> tiles;
+};
+
+}
@@ -33,6 +33,8 @@
 //#import "ActiveModel.h"
 #import "CoordSystem.h"
 #import "OpenGLES2Program.h"
+#import "DrawableAnimator.h"
+#import "MemTracker.h"
 
 /// How the scene refers to the default triangle shader (and how you replace it)
 #define kSceneDefaultTriShader "Default Triangle Shader"
@@ -60,9 +62,9 @@ class ViewPlacementGenerator;
 class AddTextureReq : public ChangeRequest
 {
 public:
-    /// Construct with a texture.
+    /// Construct with a texture and optionally the memory tag of whoever made it.
     /// You are not responsible for deleting the texture after this.
-	AddTextureReq(TextureBase *tex) : tex(tex) { }
+	AddTextureReq(TextureBase *tex,int memTag=-1) : tex(tex), memTag(memTag) { }
     /// If the texture hasn't been added to the renderer, clean it up.
     ~AddTextureReq();
 
@@ -78,8 +80,12 @@ public:
     /// Only use this if you've thought it out
     TextureBase *getTex() { return tex; }
 
+    /// Account for the texture under this memory tag
+    virtual void setMemTag(int newMemTag) { memTag = newMemTag; }
+
 protected:
 	TextureBase *tex;
+    int memTag;
 };
 
 /// Remove a texture referred to by ID
@@ -102,8 +108,9 @@ protected:
 class AddDrawableReq : public ChangeRequest
 {
 public:
-    /// Construct with a drawable.  You're not responsible for deletion
-	AddDrawableReq(Drawable *drawable) : drawable(drawable) { }
+    /// Construct with a drawable and optionally the memory tag of whoever made it.
+    /// You're not responsible for deletion
+	AddDrawableReq(Drawable *drawable,int memTag=-1) : drawable(drawable), memTag(memTag) { }
     /// If the drawable wasn't used, delete it
     ~AddDrawableReq();
     
@@ -116,8 +123,12 @@ public:
 	/// Add to the renderer.  Never call this
 	void execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view);	
 	
+    /// Account for the drawable under this memory tag
+    virtual void setMemTag(int newMemTag) { memTag = newMemTag; }
+
 protected:
 	Drawable *drawable;
+    int memTag;
 };
 
 /// Ask the renderer to remove the drawable from the scene
@@ -261,7 +272,7 @@ typedef std::map<std::string,OpenGLES2Program *> OpenGLES2ProgramMap;
 class SceneManager
 {
 public:
-    SceneManager() : scene(NULL), renderer(NULL) { }
+    SceneManager() : scene(NULL), renderer(NULL), ownerMemTag(-1) { }
     virtual ~SceneManager() { };
     
     /// Set (or reset) the current renderer
@@ -273,9 +284,24 @@ public:
     /// Return the scene this is part of
     Scene *getScene() { return scene; }
     
+    /// Name we're filed under in the scene, which is also our memory accounting owner
+    void setMemOwner(const std::string &newOwner) { memOwner = newOwner; }
+    
 protected:
+    /// Memory tag for this manager and the given label.  Look it up once per batch of objects.
+    int getMemTag(const std::string &label);
+    /// Account for the drawables and textures added by changes from startChange on under the given tag
+    void tagChanges(ChangeSet &changes,unsigned int startChange,int memTag);
+    /// Account for a new scene rep under the given tag
+    void trackSceneRep(SimpleIdentity repID,unsigned long size,int memTag);
+    /// A scene rep went away
+    void untrackSceneRep(SimpleIdentity repID);
+    
     Scene *scene;
     SceneRendererES *renderer;
+    std::string memOwner;
+    // Tag for the manager with no label, looked up the first time we need it
+    int ownerMemTag;
 };
 
 /** This is the top level scene object for WhirlyKit.
@@ -393,6 +419,12 @@ public:
     /// Dump out stats on what is currently in the scene.
     /// Use this sparingly, as it writes to the log.
     void dumpStats();
+    
+    /// Keyframe animation for drawables.  Rendering thread only, use the change requests.
+    DrawableAnimator *getAnimator() { return &animator; }
+    
+    /// Memory accounting by owner.  Thread safe.
+    MemTracker *getMemTracker() { return &memTracker; }
 	
 public:
     /// Don't be calling this
@@ -413,7 +445,7 @@ public:
 	TextureBase *getTexture(SimpleIdentity texId);
     
     /// Add a texture to the scene
-    void addTexture(TextureBase *tex);
+    void addTexture(TextureBase *tex,int memTag=-1);
     
     /// All the active models
     // Note: Porting
@@ -471,6 +503,12 @@ public:
     /// Managers for various functionality
     std::map<std::string,SceneManager *> managers;
     
+    /// Runs the keyframe tracks
+    DrawableAnimator animator;
+    
+    /// Who's holding on to what
+    MemTracker memTracker;
+    
     /// Returns the font texture manager, which is thread safe
     FontTextureManager *getFontTextureManager() { return fontTextureManager; }
     
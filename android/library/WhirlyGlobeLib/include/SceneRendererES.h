@@ -228,6 +228,8 @@ public:
     std::vector<WhirlyKitDirectionalLight> *lights;
     /// State optimizer.  Used when setting state for drawing
     OpenGLStateOptimizer *stateOpt;
+    /// Animated values for the drawable being drawn, if any
+    const DrawableAnimState *animState;
 };
 
 /** We support three different ways of using z buffer.  (1) Regular mode where it's on.
@@ -0,0 +1,110 @@
+/*
+ *  SceneRendererSoft.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <map>
+#import "SceneRendererES.h"
+#import "Lighting.h"
+#import "SoftRasterizer.h"
+
+namespace WhirlyKit
+{
+
+class BasicDrawable;
+class ScreenSpaceDrawable;
+class WideVectorDrawable;
+
+/** Scene Renderer that runs entirely on the CPU.
+    This is for generating images without an OpenGL context, such as
+    on a server or in a test harness.  It follows the OpenGL ES2 renderer
+    closely, but does the work of the default shaders itself.
+    Set it on the scene before adding anything, since the scene won't
+    set up any OpenGL resources after that.
+    Handles basic, screen space and wide vector drawables.
+ */
+class SceneRendererSoft : public SceneRendererES
+{
+public:
+    /// Construct with the size of the image we'll produce
+    SceneRendererSoft(int width,int height);
+    virtual ~SceneRendererSoft();
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    /// Put the scene into headless mode and attach to it
+    virtual void setScene(Scene *inScene);
+
+    /// Add a light to the existing set
+    void addLight(const WhirlyKitDirectionalLight *light);
+
+    /// Replace all the lights at once. nil turns off lighting
+    void replaceLights(const std::vector<WhirlyKitDirectionalLight> &lights);
+
+    /// Set the default material
+    void setDefaultMaterial(WhirlyKitMaterial *mat);
+
+    /// Number of threads to rasterize with.  0 means use all the cores.
+    void setNumThreads(int newNumThreads) { numThreads = newNumThreads; }
+
+    /// Render as if it were this time rather than now.  Use this for repeatable output.
+    /// Set to 0.0 to go back to the current time.
+    void setFixedTime(TimeInterval when) { fixedTime = when; }
+
+    /// Merge any outstanding changes into the scene
+    void processScene();
+
+    /// Draw a frame into the frame buffer.  Unlike the OpenGL renderer, this always draws.
+    void render();
+
+    bool hasChanges();
+
+    /// The image we're rendering into
+    SoftFrameBuffer *getFrameBuffer() { return frameBuffer; }
+
+    /// Copy of the last frame as RGBA rows, top row first
+    RawDataRef snapshot();
+
+protected:
+    /// Time we're rendering for
+    TimeInterval currentTime();
+
+    /// Look up the CPU side version of a texture.  Returns NULL if we can't sample it.
+    const SoftTexture *findTexture(SimpleIdentity texID);
+
+    /// Convert a regular drawable to rasterizer primitives
+    void addBasicDrawable(SoftRasterizer &raster,BasicDrawable *draw,RendererFrameInfo *frameInfo,const Eigen::Matrix4d &mvpMat,const Eigen::Matrix4d &mvMat,const Eigen::Matrix4d &mvNormalMat,const SoftDrawState &baseState,bool useLights);
+    /// Screen space objects, such as labels and markers
+    void addScreenSpaceDrawable(SoftRasterizer &raster,ScreenSpaceDrawable *draw,RendererFrameInfo *frameInfo,const Eigen::Matrix4d &mvpMat,const Eigen::Matrix4d &mvMat,const Eigen::Matrix4d &mvNormalMat,const SoftDrawState &baseState);
+    /// Wide vectors, widened here as their shader would
+    void addWideVectorDrawable(SoftRasterizer &raster,WideVectorDrawable *draw,RendererFrameInfo *frameInfo,const Eigen::Matrix4d &mvpMat,const Eigen::Matrix4d &mvMat,const Eigen::Matrix4d &mvNormalMat,const SoftDrawState &baseState);
+
+    SoftFrameBuffer *frameBuffer;
+    int numThreads;
+    TimeInterval fixedTime;
+
+    WhirlyKitMaterial *defaultMat;
+    std::vector<WhirlyKitDirectionalLight> lights;
+
+    /// Textures we've resolved for this frame
+    std::map<SimpleIdentity,SoftTexture> texCache;
+    /// Converted texture data we need to hang on to for the frame
+    std::vector<RawDataRef> texDataCache;
+};
+
+}
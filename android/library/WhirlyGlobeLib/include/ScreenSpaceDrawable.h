@@ -28,12 +28,21 @@ namespace WhirlyKit
 #define kScreenSpaceShader2DName "Screen Space Shader 2D"
 #define kScreenSpaceShaderMotionName "Screen Space Shader Motion"
 #define kScreenSpaceShader2DMotionName "Screen Space Shader 2D Motion"
+#define kScreenSpaceShaderSDFName "Screen Space Shader SDF"
+#define kScreenSpaceShaderSDF2DName "Screen Space Shader SDF 2D"
+#define kScreenSpaceShaderSDFMotionName "Screen Space Shader SDF Motion"
+#define kScreenSpaceShaderSDF2DMotionName "Screen Space Shader SDF 2D Motion"
     
 /// Construct and return the Screen Space shader program
 OpenGLES2Program *BuildScreenSpaceProgram();
 OpenGLES2Program *BuildScreenSpaceMotionProgram();
 OpenGLES2Program *BuildScreenSpace2DProgram();
 OpenGLES2Program *BuildScreenSpaceMotion2DProgram();
+/// Variants for signed distance field icons.  These take a_haloColor and a_sdfParams per vertex.
+OpenGLES2Program *BuildScreenSpaceSDFProgram();
+OpenGLES2Program *BuildScreenSpaceSDFMotionProgram();
+OpenGLES2Program *BuildScreenSpaceSDF2DProgram();
+OpenGLES2Program *BuildScreenSpaceSDFMotion2DProgram();
 
 /// Wrapper for building screen space drawables
 class ScreenSpaceDrawable : public BasicDrawable
@@ -62,6 +71,14 @@ public:
     void addRot(const Point3f &dir);
     void addRot(const Point3d &dir);
 
+    /// Vertex attribute indices for the offset, rotation and direction (-1 if missing)
+    int getOffsetIndex() const { return offsetIndex; }
+    int getRotIndex() const { return rotIndex; }
+    int getDirIndex() const { return dirIndex; }
+    
+    /// True if the image is kept upright when rotating
+    bool getKeepUpright() const { return keepUpright; }
+
     /// If we have motion we need to force the render to keep rendering
     virtual void updateRenderer(WhirlyKit::SceneRendererES *renderer);
     
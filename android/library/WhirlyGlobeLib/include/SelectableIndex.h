@@ -0,0 +1,94 @@
+/*
+ *  SelectableIndex.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdint.h>
+#import <vector>
+#import <functional>
+#import <unordered_map>
+#import <unordered_set>
+#import "Identifiable.h"
+#import "WhirlyVector.h"
+
+namespace WhirlyKit
+{
+
+/** Sparse two level grid over display space for finding the selectables near
+    a region without looking at every one of them.
+    Selectables go in each fine cell their bounding box touches.  If that's too many
+    cells (long linears, say) or they move, they're candidates for every query.
+    This isn't thread safe.  The selection manager keeps it under its own lock.
+  */
+class SelectableIndex
+{
+public:
+    /// Fine cells are cellSize on a side and are grouped coarseFactor to a side in coarse cells
+    SelectableIndex(double cellSize=1.0/32.0,int coarseFactor=8,int maxCellsPerEntry=64);
+
+    /// Change the cell size.  Only works while the index is empty.
+    void setCellSize(double newSize);
+    double getCellSize() const { return cellSize; }
+
+    /// Add a selectable covering the given display space box.  Adding one again moves it.
+    void addEntry(SimpleIdentity selectID,const Point3d &ll,const Point3d &ur);
+
+    /// Add a selectable that should be considered for every query
+    void addAlways(SimpleIdentity selectID);
+
+    /// Remove a selectable.  Ones we don't have are ignored.
+    void removeEntry(SimpleIdentity selectID);
+
+    /// Number of selectables we're holding
+    int numEntries() const { return (int)(entryCells.size() + alwaysIDs.size()); }
+
+    /// Test applied to the display space bounds of a cell.  Return false to skip what's in it.
+    typedef std::function<bool(const Point3d &ll,const Point3d &ur)> CellTest;
+
+    /// Add the selectables in cells overlapping the given display space box that pass the test,
+    /// along with the ones that are always candidates.
+    /// Only the coarse cells within the box are looked at.  Those are tested first and then the fine cells within the ones that pass.
+    void findCandidates(const Point3d &ll,const Point3d &ur,const CellTest &cellTest,SimpleIDSet &selectIDs) const;
+
+    /// Every cell overlapping the given display space box passes
+    void findCandidates(const Point3d &ll,const Point3d &ur,SimpleIDSet &selectIDs) const;
+
+protected:
+    typedef uint64_t CellKey;
+
+    int cellCoord(double val,double size) const;
+    CellKey makeKey(int ix,int iy,int iz) const;
+    void keyToCell(CellKey key,int &ix,int &iy,int &iz) const;
+    CellKey coarseKeyFor(CellKey fineKey) const;
+    void cellBounds(CellKey key,double size,Point3d &ll,Point3d &ur) const;
+
+    double cellSize;
+    int coarseFactor;
+    int maxCellsPerEntry;
+
+    // Fine cell to the selectables in it
+    std::unordered_map<CellKey,std::vector<SimpleIdentity> > fineCells;
+    // Coarse cell to the fine cells in it that have something
+    std::unordered_map<CellKey,std::unordered_set<CellKey> > coarseCells;
+    // Selectable to the fine cells it's in
+    std::unordered_map<SimpleIdentity,std::vector<CellKey> > entryCells;
+    // Selectables that are always candidates
+    SimpleIDSet alwaysIDs;
+};
+
+}
@@ -21,6 +21,7 @@
 #import <math.h>
 #import <set>
 #import <map>
+#import <unordered_map>
 #import "Identifiable.h"
 #import "WhirlyGeometry.h"
 #import "WhirlyKitView.h"
@@ -29,6 +30,8 @@
 #import "ViewState.h"
 #import "GlobeViewState.h"
 #import "ScreenSpaceBuilder.h"
+#import "SelectableIndex.h"
+#import "Dictionary.h"
 
 namespace WhirlyKit
 {
@@ -204,13 +207,14 @@ public:
     class SelectedObject
     {
     public:
-        SelectedObject() { }
-        SelectedObject(SimpleIdentity selectID,double distIn3D,double screenDist) : distIn3D(distIn3D), screenDist(screenDist) { selectIDs.push_back(selectID); }
-        SelectedObject(const std::vector<SimpleIdentity> &selectIDs,double distIn3D,double screenDist) : selectIDs(selectIDs), distIn3D(distIn3D), screenDist(screenDist) { }
+        SelectedObject() : distIn3D(0.0), screenDist(0.0), isCluster(false) { }
+        SelectedObject(SimpleIdentity selectID,double distIn3D,double screenDist) : distIn3D(distIn3D), screenDist(screenDist), isCluster(false) { selectIDs.push_back(selectID); }
+        SelectedObject(const std::vector<SimpleIdentity> &selectIDs,double distIn3D,double screenDist) : selectIDs(selectIDs), distIn3D(distIn3D), screenDist(screenDist), isCluster(false) { }
         std::vector<SimpleIdentity> selectIDs;    // What we selected.  If it was a cluster, could be more than one
         double distIn3D;            // 3D distance from eye
         double screenDist;          // 2D distance in screen space
         bool isCluster;             // Set if this is a cluster
+        DictionaryRef attrs;        // Attributes registered for the selectable.  Not filled in for clusters.
     };
 
     /// Add a rectangle (in 3-space) for selection
@@ -249,6 +253,10 @@ public:
     /// Add a billboard for selection.  Pass in the middle of the base and size
     void addSelectableBillboard(SimpleIdentity selectId,const Point3d &center,const Point3d &norm,const Point2d &size,float minVis,float maxVis,bool enable);
     
+    /// Attach attributes to a selectable, such as a marker's.  They come back with the region queries and pickObjects.
+    /// They're dropped when the selectable is removed.
+    void setSelectableAttributes(SimpleIdentity selectID,const DictionaryRef &attrs);
+
     /// Remove the given selectable from consideration
     void removeSelectable(SimpleIdentity selectId);
     
@@ -267,6 +275,21 @@ public:
     /// Find all the objects within a given distance and return them, sorted by distance
     void pickObjects(Point2f touchPt,float maxDist,View *theView,std::vector<SelectedObject> &selObjs);
     
+    /** Find the displayed objects that overlap a polygon on the screen, such as a lasso.
+        The polygon is in the same units as the touch point for pickObjects.
+        Objects have to be enabled and in their visible range.  Layout objects have to have been placed.
+        Results are sorted by distance from the eye and have no screen distance.
+        Each has the attributes set with setSelectableAttributes, if any.
+      */
+    void objectsInScreenRegion(const Point2fVector &region,View *theView,std::vector<SelectedObject> &selObjs);
+
+    /** Find the displayed objects within a geographic polygon (in radians).
+        Objects are tested by their location (or any part, for linears) rather than what's on the screen,
+        so this works for objects that are off screen.  They still have to be enabled, in their visible range
+        and placed, if they're under layout control.  Attributes are filled in as for objectsInScreenRegion.
+      */
+    void objectsInGeoRegion(const Point2dVector &region,View *theView,std::vector<SelectedObject> &selObjs);
+
     // Everything we need to project a world coordinate to one or more screen locations
     class PlacementInfo
     {
@@ -294,6 +317,20 @@ protected:
     void getScreenSpaceObjects(const PlacementInfo &pInfo,std::vector<ScreenSpaceObjectLocation> &screenObjs,TimeInterval now);
     // Internal object picking method
     void pickObjects(Point2f touchPt,float maxDist,View *theView,bool multi,std::vector<SelectedObject> &selObjs);
+    // Account for a new selectable
+    void trackSelectable(SimpleIdentity selectID,unsigned long size);
+    // Check if a selectable is turned on and within its visible range
+    static bool isSelectableVisible(const Selectable &sel,double heightAboveSurface);
+    // True if the display space box could project into the screen region.  Conservative.
+    bool boxMayOverlapScreenRegion(const Point3d &ll,const Point3d &ur,const PlacementInfo &pInfo,const Mbr &regionMbr);
+    // True if a screen space object at the given location overlaps the screen region
+    bool screenObjectInRegion(const Point3d &dispLoc,const Point2dVector &pts,const Point2d &offset,const PlacementInfo &pInfo,const Point2fVector &region,const Mbr &regionMbr);
+    // Geographic location (radians) of a display space point
+    Point2f displayToGeo(const Point3d &dispPt);
+    // Display space box the screen region can see, padded out to the cells.  False if we can't work it out.
+    bool screenRegionDisplayBounds(const Mbr &regionMbr,const PlacementInfo &pInfo,Point3d &ll,Point3d &ur);
+    // Copy the registered attributes into the selected objects.  Call with the mutex held.
+    void fillAttributes(std::vector<SelectedObject> &selObjs);
 
 
     pthread_mutex_t mutex;
@@ -307,6 +344,12 @@ protected:
     WhirlyKit::MovingPolytopeSelectableSet movingPolytopeSelectables;
     WhirlyKit::LinearSelectableSet linearSelectables;
     WhirlyKit::BillboardSelectableSet billboardSelectables;
+    /// Where the selectables are in display space, for region queries
+    WhirlyKit::SelectableIndex regionIndex;
+    /// Largest extent of a screen space rectangle from its center
+    float maxScreenRectSize;
+    /// Attributes attached to selectables
+    std::unordered_map<SimpleIdentity,DictionaryRef> selectAttrs;
 };
  
 }
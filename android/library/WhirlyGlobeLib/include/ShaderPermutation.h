@@ -0,0 +1,183 @@
+/*
+ *  ShaderPermutation.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <string>
+#import <vector>
+#import <set>
+#import <map>
+#import "Identifiable.h"
+#import "Scene.h"
+
+namespace WhirlyKit
+{
+
+/** Resolve the conditionals in a shader source against the given defines.
+    Handles #ifdef, #ifndef, #if and #elif (with defined(), !, &&, || and integers),
+    #else and #endif.  #define and #undef in active code count for what follows.
+    Dropped lines come out empty, so compile errors still point at the right line.
+    Everything else, including other directives, is passed through.
+    This doesn't touch OpenGL.  Returns false and fills in errStr if the source is malformed.
+  */
+bool ShaderPreprocess(const std::string &src,const std::set<std::string> &defines,std::string &outSrc,std::string &errStr);
+
+/// A uniform, attribute or varying declared in a shader source
+class ShaderVariable
+{
+public:
+    ShaderVariable() : arraySize(0) { }
+
+    /// Attribute slots this takes up.  Matrices take one per column.
+    int numSlots() const;
+
+    /// GLSL type, such as vec4 or a struct name
+    std::string type;
+    /// Name within the shader
+    std::string name;
+    /// If declared as an array, its length
+    int arraySize;
+};
+
+/// The uniforms, attributes and varyings a shader source declares
+class ShaderInterface
+{
+public:
+    /// Look for a uniform by name.  NULL if it's not declared.
+    const ShaderVariable *findUniform(const std::string &name) const;
+
+    /// Look for an attribute by name.  NULL if it's not declared.
+    const ShaderVariable *findAttribute(const std::string &name) const;
+
+    /// Declared in the order they appear, without duplicates
+    std::vector<ShaderVariable> uniforms;
+    std::vector<ShaderVariable> attributes;
+    std::vector<ShaderVariable> varyings;
+};
+
+/** Pull the uniform, attribute and varying declarations out of a shader source.
+    Preprocessor lines are skipped, so run this on preprocessed source to get
+    what one permutation declares, or on the raw source to get everything a module might.
+  */
+void ShaderReflect(const std::string &src,ShaderInterface &iface);
+
+/** A shader source pair with features turned on and off by defines.
+    Each combination of features is a permutation, named after the module
+    and the features it has turned on.
+  */
+class ShaderModule
+{
+public:
+    /// One feature.  The bit is what goes in the feature mask.
+    class Feature
+    {
+    public:
+        Feature() : bit(0), needs(0), excludes(0), alwaysNamed(false) { }
+
+        int bit;
+        /// Defined in the source when the feature is on
+        std::string define;
+        /// How the feature shows up in permutation names
+        std::string keyName;
+        /// Features this one needs.  Without them it's dropped.
+        int needs;
+        /// Features this one can't be used with.  If they're on, it's dropped.
+        int excludes;
+        /// Name it as =no when it's off, rather than leaving it out
+        bool alwaysNamed;
+    };
+
+    ShaderModule() { }
+    ShaderModule(const std::string &name,const std::string &vertSrc,const std::string &fragSrc);
+
+    /// Add a feature.  Names are built in the order they're added.
+    void addFeature(int bit,const std::string &define,const std::string &keyName,int needs=0,int excludes=0,bool alwaysNamed=false);
+
+    /// Name of the module, which starts all its permutation names
+    const std::string &getName() const { return name; }
+
+    /// Drop unknown features and the ones whose requirements aren't met
+    int normalizeFeatures(int features) const;
+
+    /// Name of a permutation, such as "Default Triangle;multitex=yes;lighting=yes"
+    std::string permutationName(int features) const;
+
+    /// Defines for the given features
+    void getDefines(int features,std::set<std::string> &defines) const;
+
+    /// Preprocess both sources for the given features
+    bool buildSources(int features,std::string &outVert,std::string &outFrag,std::string &errStr) const;
+
+    /// Attribute locations shared by every permutation, in declaration order.
+    /// Permutations that bind these can swap with each other without moving vertex data around.
+    /// Returns false if they'd need more than maxSlots.
+    bool getAttributeLocations(int maxSlots,std::map<std::string,int> &locations) const;
+
+protected:
+    std::string name;
+    std::string vertSrc,fragSrc;
+    std::vector<Feature> features;
+};
+
+/// Identifies a permutation within the modules
+class ShaderPermutationKey
+{
+public:
+    ShaderPermutationKey() : features(0) { }
+    ShaderPermutationKey(const std::string &module,int features) : module(module), features(features) { }
+
+    bool operator < (const ShaderPermutationKey &that) const
+    {
+        if (features != that.features)
+            return features < that.features;
+        return module < that.module;
+    }
+
+    std::string module;
+    int features;
+};
+
+#define kWKShaderPermutationManager "WKShaderPermutationManager"
+
+/** Keeps the shader modules and builds their permutations as they're needed.
+    Each program is added to the scene under its permutation name and cached here by key.
+  */
+class ShaderPermutationManager : public SceneManager
+{
+public:
+    ShaderPermutationManager();
+    virtual ~ShaderPermutationManager();
+
+    /// Add a module, replacing any with the same name
+    void addModule(const ShaderModule &module);
+
+    /// Return the program for the given features of a module, building it if need be.
+    /// Building needs an OpenGL context, so do this on the rendering thread.
+    /// Returns EmptyIdentity if the module doesn't exist or the permutation won't compile.
+    SimpleIdentity getProgram(const std::string &moduleName,int features);
+
+protected:
+    pthread_mutex_t lock;
+    std::map<std::string,ShaderModule> modules;
+    std::map<ShaderPermutationKey,SimpleIdentity> programs;
+    // Permutations that didn't compile, so we don't keep trying
+    std::set<ShaderPermutationKey> failed;
+};
+
+}
@@ -27,6 +27,8 @@
 namespace WhirlyKit
 {
 
+class ViewState;
+
 /// Used to pass shape info between the shape layer and the drawable builder
 ///  and within the threads of the shape layer
 class WhirlyKitShapeInfo : public BaseInfo
@@ -61,6 +63,22 @@ public:
     void setCenter(Point3d value) { center = value; }
     Point3d getCenter() { return center; }
 
+    /// Pick the number of samples for curved shapes based on how big they'll be on the screen.
+    /// The eye position is in display coordinates.  Pixels per unit is the size of one display unit
+    ///  in pixels, seen from one display unit away.  Pixels per sample is the length of an edge we're aiming for.
+    void setSampleLOD(const Point3d &eyePos,double pixelsPerUnit,double pixelsPerSample,int minSamples,int maxSamples);
+
+    /// Set up the sample LOD from the current view and the size of the frame in pixels
+    void setSampleLOD(ViewState *viewState,const Point2f &frameSize,double pixelsPerSample,int minSamples,int maxSamples);
+
+    /// Go back to the fixed sample counts on the individual shapes
+    void clearSampleLOD() { sampleLOD = false; }
+    bool getSampleLOD() { return sampleLOD; }
+
+    /// Number of samples to use for a curve of the given length (in display units).
+    /// The curve lies within extent of the given point.  Returns defaultSamples if the sample LOD isn't set.
+    int calcSamples(const Point3d &dispPt,double extent,double length,int defaultSamples);
+
 private:
     RGBAColor color;
     float lineWidth;
@@ -70,6 +88,10 @@ private:
     bool zBufferWrite;
     bool hasCenter;
     WhirlyKit::Point3d center;
+    bool sampleLOD;
+    WhirlyKit::Point3d lodEyePos;
+    double lodPixelsPerUnit,lodPixelsPerSample;
+    int lodMinSamples,lodMaxSamples;
 };
 
 
@@ -138,6 +160,9 @@ public:
     // Add a group of pre-build triangles
     void addTriangles(Point3fVector &pts,Point3fVector &norms,std::vector<RGBAColor> &colors,std::vector<BasicDrawable::Triangle> &tris);
 
+    // Add a mesh in display coordinates, splitting it across drawables if it won't fit in one
+    void addTriangles(const Point3dVector &pts,const Point3fVector &norms,const std::vector<RGBAColor> &colors,const std::vector<BasicDrawable::Triangle> &tris,const Mbr &shapeMbr);
+
     // Add a convex outline, triangulated
     void addConvexOutline(Point3fVector &pts,Point3f norm,RGBAColor color,Mbr shapeMbr);
 
@@ -138,11 +138,336 @@ private:
     SimpleIdentity texID;
 };
 
+/// A flat circle around a location, offset from the globe by height
+class WhirlyKitCircle : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitCircle();
+    virtual ~WhirlyKitCircle();
+
+    void setLoc(WhirlyKit::GeoCoord value) { loc = value; }
+    WhirlyKit::GeoCoord getLoc() { return loc; }
+
+    /// Radius is in display units
+    void setRadius(float value) { radius = value; }
+    float getRadius() { return radius; }
+
+    /// Offset from the globe in display units
+    void setHeight(float value) { height = value; }
+    float getHeight() { return height; }
+
+    /// Number of samples around the edge, if the sample LOD isn't on
+    void setSampleX(int value) { sampleX = value; }
+    int getSampleX() { return sampleX; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    WhirlyKit::GeoCoord loc;
+    float radius;
+    float height;
+    int sampleX;
+};
+
+/// A cylinder standing up from a location
+class WhirlyKitCylinder : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitCylinder();
+    virtual ~WhirlyKitCylinder();
+
+    void setLoc(WhirlyKit::GeoCoord value) { loc = value; }
+    WhirlyKit::GeoCoord getLoc() { return loc; }
+
+    /// Offset of the bottom from the globe in display units
+    void setBaseHeight(float value) { baseHeight = value; }
+    float getBaseHeight() { return baseHeight; }
+
+    /// Radius is in display units
+    void setRadius(float value) { radius = value; }
+    float getRadius() { return radius; }
+
+    /// Height above the base in display units
+    void setHeight(float value) { height = value; }
+    float getHeight() { return height; }
+
+    /// Number of samples around the edge, if the sample LOD isn't on
+    void setSampleX(int value) { sampleX = value; }
+    int getSampleX() { return sampleX; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    WhirlyKit::GeoCoord loc;
+    float baseHeight;
+    float radius;
+    float height;
+    int sampleX;
+};
+
+/// A cone with its base around the location and its point straight up
+class WhirlyKitCone : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitCone();
+    virtual ~WhirlyKitCone();
+
+    void setLoc(WhirlyKit::GeoCoord value) { loc = value; }
+    WhirlyKit::GeoCoord getLoc() { return loc; }
+
+    /// Offset of the base from the globe in display units
+    void setBaseHeight(float value) { baseHeight = value; }
+    float getBaseHeight() { return baseHeight; }
+
+    /// Radius of the base in display units
+    void setRadius(float value) { radius = value; }
+    float getRadius() { return radius; }
+
+    /// Distance from the base to the point in display units
+    void setHeight(float value) { height = value; }
+    float getHeight() { return height; }
+
+    /// Number of samples around the base, if the sample LOD isn't on
+    void setSampleX(int value) { sampleX = value; }
+    int getSampleX() { return sampleX; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    WhirlyKit::GeoCoord loc;
+    float baseHeight;
+    float radius;
+    float height;
+    int sampleX;
+};
+
+/// An ellipsoid centered on a location, with its axes lined up east, north and up (before the heading)
+class WhirlyKitEllipsoid : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitEllipsoid();
+    virtual ~WhirlyKitEllipsoid();
+
+    void setLoc(WhirlyKit::GeoCoord value) { loc = value; }
+    WhirlyKit::GeoCoord getLoc() { return loc; }
+
+    /// Offset of the center from the globe in display units
+    void setHeight(float value) { height = value; }
+    float getHeight() { return height; }
+
+    /// Radii along the east, north and up axes in display units
+    void setRadii(const Point3d &value) { radii = value; }
+    Point3d getRadii() { return radii; }
+
+    /// Rotation around the up axis, clockwise from north in radians
+    void setHeading(double value) { heading = value; }
+    double getHeading() { return heading; }
+
+    /// Samples around and top to bottom, if the sample LOD isn't on
+    void setSampleX(int value) { sampleX = value; }
+    int getSampleX() { return sampleX; }
+    void setSampleY(int value) { sampleY = value; }
+    int getSampleY() { return sampleY; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    WhirlyKit::GeoCoord loc;
+    float height;
+    Point3d radii;
+    double heading;
+    int sampleX, sampleY;
+};
+
+/** A great circle between two points.  This is a line if the radius is zero
+    and a tube if it's not.  It arcs up to the given height in the middle.
+  */
+class WhirlyKitGreatCircle : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitGreatCircle();
+    virtual ~WhirlyKitGreatCircle();
+
+    void setStartPt(WhirlyKit::GeoCoord value) { startPt = value; }
+    WhirlyKit::GeoCoord getStartPt() { return startPt; }
+
+    void setEndPt(WhirlyKit::GeoCoord value) { endPt = value; }
+    WhirlyKit::GeoCoord getEndPt() { return endPt; }
+
+    /// Height of the arc at its midpoint in display units
+    void setHeight(float value) { height = value; }
+    float getHeight() { return height; }
+
+    /// Radius of the tube in display units.  Zero means a line.
+    void setRadius(float value) { radius = value; }
+    float getRadius() { return radius; }
+
+    /// Line width in pixels, for the line version
+    void setLineWidth(float value) { lineWidth = value; }
+    float getLineWidth() { return lineWidth; }
+
+    /// Number of segments along the path.  Zero means pick based on the arc length.
+    void setSampleX(int value) { sampleX = value; }
+    int getSampleX() { return sampleX; }
+
+    /// Number of samples around the tube
+    void setSampleY(int value) { sampleY = value; }
+    int getSampleY() { return sampleY; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+protected:
+    /// Sample the arc in display coordinates
+    void calcPath(CoordSystemDisplayAdapter *coordAdapter,int numSegments,Point3dVector &pts,Point3dVector &norms);
+
+private:
+    WhirlyKit::GeoCoord startPt,endPt;
+    float height;
+    float radius;
+    float lineWidth;
+    int sampleX, sampleY;
+};
+
+/// A linear feature made up of points already in display space
+class WhirlyKitShapeLinear : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitShapeLinear();
+    virtual ~WhirlyKitShapeLinear();
+
+    /// Points in display coordinates
+    void setPts(const Point3fVector &value) { pts = value; }
+    const Point3fVector &getPts() { return pts; }
+
+    /// Bounding box in local coordinates
+    void setMbr(const Mbr &value) { mbr = value; }
+    Mbr getMbr() { return mbr; }
+
+    /// Line width in pixels
+    void setLineWidth(float value) { lineWidth = value; }
+    float getLineWidth() { return lineWidth; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    Point3fVector pts;
+    Mbr mbr;
+    float lineWidth;
+};
+
+/// An outline extruded up and down from a location, then transformed
+class WhirlyKitShapeExtruded : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitShapeExtruded();
+    virtual ~WhirlyKitShapeExtruded();
+
+    /// Location in radians (x and y) plus an offset along the normal in display units (z)
+    void setLoc(const Point3d &value) { loc = value; }
+    Point3d getLoc() { return loc; }
+
+    /// Outline in display units around the location
+    void setPts(const Point2dVector &value) { pts = value; }
+    const Point2dVector &getPts() { return pts; }
+
+    /// Total thickness in display units, centered on the location
+    void setThickness(double value) { thickness = value; }
+    double getThickness() { return thickness; }
+
+    /// Applied to the shape before it's placed on the globe
+    void setTransform(const Eigen::Matrix4d &value) { transform = value; }
+    Eigen::Matrix4d getTransform() { return transform; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    Point3d loc;
+    Point2dVector pts;
+    double thickness;
+    Eigen::Matrix4d transform;
+};
+
+/** A volume bounded by azimuth, elevation and range around a location.
+    This is the usual way to show radar or sensor coverage.  Azimuth is
+    clockwise from north and elevation is up from the local horizontal,
+    both in radians.
+  */
+class WhirlyKitSector : public WhirlyKitShape
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    WhirlyKitSector();
+    virtual ~WhirlyKitSector();
+
+    void setLoc(WhirlyKit::GeoCoord value) { loc = value; }
+    WhirlyKit::GeoCoord getLoc() { return loc; }
+
+    /// Offset of the sensor from the globe in display units
+    void setBaseHeight(float value) { baseHeight = value; }
+    float getBaseHeight() { return baseHeight; }
+
+    /// Range in display units.  A minimum of zero comes to a point at the sensor.
+    void setRange(double minValue,double maxValue) { minRange = minValue;  maxRange = maxValue; }
+    double getMinRange() { return minRange; }
+    double getMaxRange() { return maxRange; }
+
+    /// Azimuth extents, clockwise from north.  The end should be greater than the start.
+    void setAzimuth(double startValue,double endValue) { startAz = startValue;  endAz = endValue; }
+    double getStartAzimuth() { return startAz; }
+    double getEndAzimuth() { return endAz; }
+
+    /// Elevation extents, from -pi/2 to pi/2
+    void setElevation(double minValue,double maxValue) { minElev = minValue;  maxElev = maxValue; }
+    double getMinElevation() { return minElev; }
+    double getMaxElevation() { return maxElev; }
+
+    /// Samples in azimuth and elevation, if the sample LOD isn't on
+    void setSampleAzimuth(int value) { sampleAz = value; }
+    int getSampleAzimuth() { return sampleAz; }
+    void setSampleElevation(int value) { sampleElev = value; }
+    int getSampleElevation() { return sampleElev; }
+
+    virtual void makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *regBuilder, WhirlyKit::ShapeDrawableBuilderTri *triBuilder, WhirlyKit::Scene *scene, SelectionManager *selectManager, ShapeSceneRep *sceneRep);
+    virtual Point3d displayCenter(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo);
+
+private:
+    WhirlyKit::GeoCoord loc;
+    float baseHeight;
+    double minRange,maxRange;
+    double startAz,endAz;
+    double minElev,maxElev;
+    int sampleAz,sampleElev;
+};
+
 #define kWKShapeManager "WKShapeManager"
 
 
 /** The Shape Manager is used to create and destroy geometry for shapes like circles, cylinders,
  and so forth.  It's entirely thread safe (except for destruction).
+ All the shapes in a single call share drawables.  Set the sample LOD on the shape info
+ to pick the tesselation for the curved shapes from how big they'll be on the screen.
  */
 class ShapeManager : public SceneManager
 {
@@ -48,6 +48,8 @@
 #define MaplyZBufferRead WKString("zbufferread")
 /// Have a given object write itself to the z buffer
 #define MaplyZBufferWrite WKString("zbufferwrite")
+/// Label to account for an object's memory under, in addition to the manager that made it
+#define MaplyMemLabel WKString("memlabel")
 
 /// Assign a shader program to a particular feature.  Use the shader program's name
 #define MaplyShaderString WKString("shader")
@@ -92,6 +94,14 @@
 #define MaplyLabelJustify WKString("justify")
 /// Text justification within multi-line strings
 #define MaplyTextJustify WKString("textjustify")
+/// Wrap lines longer than this, in screen points
+#define MaplyTextWrapWidth WKString("wrapwidth")
+/// Wrap lines longer than this, in ems (the height of the text)
+#define MaplyTextWrapWidthEms WKString("wrapwidthems")
+/// If set, wrapped lines are evened out rather than filled greedily.  On by default.
+#define MaplyTextWrapBalanced WKString("wrapbalanced")
+/// Space between lines as a multiple of the font's line height
+#define MaplyTextLineSpacing WKString("linespacing")
 /// If set, we'll draw a shadow behind each label with this as the stroke size
 #define MaplyShadowSize WKString("shadowSize")
 /// If shadow size is being used, we can control the shadow color like so
@@ -105,6 +115,12 @@
 
 /// These are used for screen and regular markers.
 #define MaplyClusterGroup WKString("clusterGroup")
+/// Halo color for signed distance field icons
+#define MaplyIconHaloColor WKString("iconHaloColor")
+/// Halo width, in screen points, for signed distance field icons
+#define MaplyIconHaloWidth WKString("iconHaloWidth")
+/// Softens the outside of the halo, in screen points
+#define MaplyIconHaloBlur WKString("iconHaloBlur")
 
 /// These are used for screen and regular markers.
 
@@ -136,6 +152,12 @@
 #define MaplyVecCenterX WKString("veccenterx")
 #define MaplyVecCenterY WKString("veccentery")
 
+/// If set, vectors follow the elevation that's been loaded and are rebuilt as better data comes in
+#define MaplyVecClampToGround WKString("clamptoground")
+
+/// If set, vectors keep what they need so per shape colors can be changed without rebuilding
+#define MaplyVecRecolorable WKString("recolorable")
+
 /// For wide vectors, we can widen them in screen space or display space
 #define MaplyWideVecCoordType WKString("wideveccoordtype")
 
@@ -179,6 +201,10 @@
 /// It's real world coordinates for kMaplyWideVecCoordTypeReal and pixel size for kMaplyWideVecCoordTypeScreen
 #define MaplyWideVecTexRepeatLen WKString("repeatSize")
 
+/// Moves the line sideways, positive to the right.
+/// It's real world coordinates for kMaplyWideVecCoordTypeReal and pixel size for kMaplyWideVecCoordTypeScreen
+#define MaplyWideVecOffset WKString("offset")
+
 
 /// If set we'll break up a vector feature to the given epsilon on a globe surface
 #define MaplySubdivEpsilon WKString("subdivisionepsilon")
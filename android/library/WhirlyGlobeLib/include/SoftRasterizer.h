@@ -0,0 +1,207 @@
+/*
+ *  SoftRasterizer.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <pthread.h>
+#import "WhirlyVector.h"
+#import "RawData.h"
+
+namespace WhirlyKit
+{
+
+/** Color and depth buffer for the software rasterizer.
+    Color is 8 bit RGBA, depth is a float per pixel.
+    Row 0 is the top of the image, like most image formats.
+  */
+class SoftFrameBuffer
+{
+public:
+    SoftFrameBuffer(int width,int height);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    /// Fill the color buffer with the given color and reset the depth
+    void clear(const RGBAColor &clearColor,float clearDepth = 1.0);
+
+    /// Return the RGBA bytes for a given pixel
+    unsigned char *colorAt(int x,int y) { return &color[4*(y*width+x)]; }
+    /// Return the depth value for a given pixel
+    float *depthAt(int x,int y) { return &depth[y*width+x]; }
+
+    /// Copy the color buffer out as tightly packed RGBA rows
+    RawDataRef asRawData() const;
+
+protected:
+    int width,height;
+    std::vector<unsigned char> color;
+    std::vector<float> depth;
+};
+
+/** A non-owning view of texture pixels the rasterizer can sample from.
+    Follows OpenGL conventions for wrapping and texel centers.
+  */
+class SoftTexture
+{
+public:
+    SoftTexture();
+
+    /// Sample at the given texture coordinates.  Returns 0-1 RGBA.
+    /// Single channel textures behave like GL_ALPHA and return (0,0,0,a)
+    Eigen::Vector4f sample(float u,float v) const;
+
+    /// Pixels in row order, either 4 bytes (RGBA) or 1 byte (alpha)
+    const unsigned char *pixels;
+    int width,height;
+    /// Bytes per pixel, 4 or 1
+    int pixSize;
+    bool wrapU,wrapV;
+    /// Bilinear if set, nearest otherwise
+    bool linear;
+
+protected:
+    Eigen::Vector4f texel(int x,int y) const;
+};
+
+/// A single vertex in clip space along with the values we interpolate across it
+class SoftVertex
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    SoftVertex() : pos(0,0,0,1), color(1,1,1,1), uv(0,0), extra(1.0) { }
+
+    /// Position in clip coordinates (before the divide by w)
+    Eigen::Vector4f pos;
+    /// Color (0-1)
+    Eigen::Vector4f color;
+    /// Texture coordinates
+    Point2f uv;
+    /// Extra value interpolated along.  The wide vectors use this for their globe facing test.
+    float extra;
+};
+
+/// How we turn the interpolated values into a color
+typedef enum {SoftShadeColor,SoftShadeWideVector} SoftShadeMode;
+
+/** State that's shared across a batch of primitives.
+    This stands in for the shader program and the bits of OpenGL state we care about.
+  */
+class SoftDrawState
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    SoftDrawState();
+
+    SoftShadeMode shadeMode;
+    /// Texture to modulate with, if any.  Caller owns this.
+    const SoftTexture *tex;
+    /// Compare against the depth buffer (GL_LESS)
+    bool depthTest;
+    /// Write to the depth buffer.  With depthTest off this acts like GL_ALWAYS.
+    bool depthWrite;
+    /// Discard counter clockwise facing triangles (OpenGL's default front face is counter clockwise)
+    bool cullBack;
+    /// Discard fragments where the interpolated extra value is <= 0
+    bool useExtraTest;
+    /// Line width in pixels and edge size for the wide vector shading
+    float w2,edge;
+    /// Constant color for the wide vector shading
+    Eigen::Vector4f constColor;
+};
+
+/** Tile based software rasterizer.
+    Primitives are clipped, projected and binned into tiles as they're added.
+    The tiles are then rasterized in parallel on flush().  Each tile is
+    processed by a single thread in submission order, so the results are
+    the same regardless of the number of threads.
+  */
+class SoftRasterizer
+{
+public:
+    /// Construct with the frame buffer we'll draw into.  0 threads means use all the cores.
+    SoftRasterizer(SoftFrameBuffer *frameBuffer,int numThreads=0,int tileSize=64);
+    virtual ~SoftRasterizer();
+
+    /// Add a draw state to use for the primitives that follow.  Returns its index.
+    int addState(const SoftDrawState &state);
+
+    /// Add a triangle in clip space using the given draw state
+    void addTriangle(const SoftVertex &v0,const SoftVertex &v1,const SoftVertex &v2,int state);
+
+    /// Add a line in clip space, expanded to the given width in pixels
+    void addLine(const SoftVertex &v0,const SoftVertex &v1,float width,int state);
+
+    /// Add a square point in clip space of the given size in pixels
+    void addPoint(const SoftVertex &v0,float size,int state);
+
+    /// Rasterize everything we've been handed and clear out the primitives.
+    /// The draw states are kept until clear() is called.
+    void flush();
+
+    /// Clear out primitives and states
+    void clear();
+
+    /// Number of threads we'll use for flush()
+    int getNumThreads() const { return numThreads; }
+
+public:
+    /// A vertex after projection.  Attributes are premultiplied by 1/w.
+    class ScreenVert
+    {
+    public:
+        float x,y,z,invW;
+        float attrs[8];
+    };
+
+    /// Triangle ready to rasterize
+    class ScreenTri
+    {
+    public:
+        ScreenVert verts[3];
+        int state;
+    };
+
+    /// Rasterize all the triangles in a single tile
+    void rasterizeTile(int tileIndex);
+
+    /// Called by the worker threads to grab the next tile.  Returns -1 when done.
+    int nextTile();
+
+protected:
+    void project(const SoftVertex &vert,ScreenVert &screenVert);
+    void addScreenTri(const ScreenVert &v0,const ScreenVert &v1,const ScreenVert &v2,int state,bool canCull);
+    void shadeFragment(const SoftDrawState &state,const float *attrs,Eigen::Vector4f &outColor,bool &keep);
+
+    SoftFrameBuffer *frameBuffer;
+    int numThreads;
+    int tileSize;
+    int tilesX,tilesY;
+    std::vector<SoftDrawState,Eigen::aligned_allocator<SoftDrawState> > states;
+    std::vector<ScreenTri> tris;
+    /// Triangle indices for each tile in the order they were added
+    std::vector<std::vector<int> > bins;
+
+    pthread_mutex_t tileLock;
+    int curTile;
+};
+
+}
@@ -26,6 +26,7 @@
 #import "DynamicTextureAtlas.h"
 #import "DynamicDrawableAtlas.h"
 #import "BaseInfo.h"
+#import "GroundControlWarp.h"
 
 namespace WhirlyKit
 {
@@ -88,6 +89,13 @@ public:
     /// The chunks extents are in this coordinate system.  Geographic if not set.
     CoordSystem *coordSys;
     
+    /// If set, the image is bent to fit these ground control points rather than stretched over the MBR.
+    /// Sampling is adaptive, with sampleX,sampleY as maximums and eps as the tolerance.
+    GroundControlWarpRef warp;
+    
+    /// Set up a warp from ground control points.  The MBR is set to the warped bounds.
+    void setWarp(GroundControlWarpRef warp);
+    
 protected:
     void buildSkirt(BasicDrawable *draw,Point3fVector &pts,std::vector<TexCoord> &texCoords,const SphericalChunkInfo &chunkInfo);
     // Create one or more drawables to represent the chunk.
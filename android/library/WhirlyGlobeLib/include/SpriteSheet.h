@@ -0,0 +1,143 @@
+/*
+ *  SpriteSheet.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <pthread.h>
+#import <string>
+#import <vector>
+#import <map>
+#import <memory>
+#import "Identifiable.h"
+#import "RawData.h"
+#import "TextureAtlas.h"
+#import "Scene.h"
+
+namespace WhirlyKit
+{
+
+/// A single icon within a sprite sheet
+class SpriteIcon
+{
+public:
+    SpriteIcon();
+
+    /// Name the icon is referenced by
+    std::string name;
+    /// Location and size within the sheet, in pixels
+    int x,y,width,height;
+    /// Number of pixels per screen point (2 for @2x sheets)
+    float pixelRatio;
+    /// Set if this is a signed distance field rather than a regular image
+    bool sdf;
+    /// Sub texture mapping into the sheet's texture.  Use this in place of a texture ID.
+    SimpleIdentity subTexID;
+    /// The sheet's texture
+    SimpleIdentity texID;
+
+    /// Natural size of the icon in screen points
+    Point2f getSize() const { return Point2f(width/pixelRatio,height/pixelRatio); }
+};
+
+/** A Mapbox style sprite sheet.
+    This is a single image holding many icons along with a JSON index giving
+    the name and location of each.  The whole thing goes into one static texture
+    and every icon gets a sub texture, so there's only one upload.
+    Icons flagged as "sdf" hold a signed distance field in their alpha channel
+    with the edge at 0.75 and 8 units per pixel.  Those can be tinted and haloed at draw time.
+  */
+class SpriteSheet : public Identifiable
+{
+public:
+    /// Construct with a name to refer to the sheet by
+    SpriteSheet(const std::string &name);
+    virtual ~SpriteSheet();
+
+    /// Name of the sheet
+    const std::string &getName() const { return name; }
+
+    /// Parse the JSON index.  Returns false if it's not a sprite index.
+    bool parseIndex(const std::string &json);
+
+    /// The sheet image, 8 bit RGBA, top row first
+    bool setImage(RawDataRef imageData,int width,int height);
+
+    /// Number of icons in the index
+    int getNumIcons() const { return (int)icons.size(); }
+
+    /// Names of all the icons
+    void getIconNames(std::vector<std::string> &names) const;
+
+    /// Look for the icon by name
+    bool findIcon(const std::string &iconName,SpriteIcon &icon) const;
+
+    /// Build the texture and sub textures.  The texture goes in the change set,
+    ///  the sub textures straight into the scene.
+    bool processIntoScene(Scene *scene,ChangeSet &changes);
+
+    /// Remove the texture and sub textures
+    void clearFromScene(Scene *scene,ChangeSet &changes);
+
+    /// Set once we've been added to a scene
+    bool isInScene() const { return texID != EmptyIdentity; }
+
+protected:
+    std::string name;
+    std::map<std::string,SpriteIcon> icons;
+    RawDataRef imageData;
+    int width,height;
+    SimpleIdentity texID;
+};
+
+typedef std::shared_ptr<SpriteSheet> SpriteSheetRef;
+
+#define kWKSpriteSheetManager "WKSpriteSheetManager"
+
+/** The sprite sheet manager keeps track of the sheets that have been loaded
+    so markers and styles can refer to icons by name.
+    Names can be qualified with the sheet ("sheet:icon").  Unqualified names
+    are looked up in the most recently added sheet first.
+    It's thread safe.
+  */
+class SpriteSheetManager : public SceneManager
+{
+public:
+    SpriteSheetManager();
+    virtual ~SpriteSheetManager();
+
+    /// Add a sprite sheet, building its texture.  A sheet with the same name is replaced.
+    bool addSpriteSheet(SpriteSheetRef sheet,ChangeSet &changes);
+
+    /// Remove the given sprite sheet and its texture
+    void removeSpriteSheet(const std::string &sheetName,ChangeSet &changes);
+
+    /// Return the named sprite sheet, if it's there
+    SpriteSheetRef getSpriteSheet(const std::string &sheetName);
+
+    /// Look for an icon by name
+    bool findIcon(const std::string &iconName,SpriteIcon &icon);
+
+    /// Sub texture ID for an icon, usable anywhere a texture ID is.  EmptyIdentity if not found.
+    SimpleIdentity getIconID(const std::string &iconName);
+
+protected:
+    pthread_mutex_t sheetLock;
+    std::vector<SpriteSheetRef> sheets;
+};
+
+}
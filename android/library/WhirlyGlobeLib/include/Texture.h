@@ -42,6 +42,12 @@ public:
     
     /// Return the unique GL ID.
     GLuint getGLId() const { return glId; }
+    
+    /// Name of whatever made the texture
+    const std::string &getName() const { return name; }
+    
+    /// Bytes this texture takes up once it's loaded
+    virtual unsigned long getMemSize() const { return 0; }
 
     /// Render side only.  Don't call this.  Create the openGL version
 	virtual bool createInGL(OpenGLMemManager *memManager) {  return false; }
@@ -118,6 +124,10 @@ public:
     void setUsesMipmaps(bool use) { usesMipmaps = use; }
     /// Set this to let the texture wrap in the appropriate directions
     void setWrap(bool inWrapU,bool inWrapV) { wrapU = inWrapU;  wrapV = inWrapV; }
+    /// Check if we wrap horizontally
+    bool getWrapU() const { return wrapU; }
+    /// Check if we wrap vertically
+    bool getWrapV() const { return wrapV; }
     /// Set the format (before createInGL() is called)
     void setFormat(GLenum inFormat) { format = inFormat; }
     /// Return the format
@@ -127,8 +137,14 @@ public:
     GLenum getInterpType() { return interpType; }
     /// If we're converting to a single byte, set the source
     void setSingleByteSource(WKSingleByteSource source) { byteSource = source; }
+    WKSingleByteSource getSingleByteSource() const { return byteSource; }
+    /// True if the data is compressed (PVRTC or PKM) rather than plain RGBA
+    bool isCompressed() const { return isPVRTC || isPKM; }
     /// If set, this is a texture we're creating for output purposes
     void setIsEmptyTexture(bool inIsEmptyTexture) { isEmptyTexture = inIsEmptyTexture; }
+    
+    /// Bytes this takes up in GL, worked out from the size and format
+    virtual unsigned long getMemSize() const;
 
     /// Render side only.  Don't call this.  Create the openGL version
     virtual bool createInGL(OpenGLMemManager *memManager);
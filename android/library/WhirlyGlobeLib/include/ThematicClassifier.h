@@ -0,0 +1,158 @@
+/*
+ *  ThematicClassifier.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import <string>
+#import "WhirlyVector.h"
+#import "VectorData.h"
+#import "ScalarGrid.h"
+
+namespace WhirlyKit
+{
+
+/// Ways to pick the class breaks
+typedef enum {ClassifyEqualInterval,ClassifyQuantile,ClassifyJenks,ClassifyStdDev,ClassifyManual} ThematicClassMethod;
+
+/** Sorts the values of a numeric attribute into classes and colors them, as for a choropleth.
+    Breaks run from the low end of the first class to the high end of the last.
+    Class i holds values above break i and up to break i+1, with the first class taking its low end too.
+    Missing values are nulls and get their own color.  Values outside the breaks are outliers
+    and go in the end classes, unless there's an outlier color.
+  */
+class ThematicClassifier
+{
+public:
+    /// Class for a value that's missing
+    static const int NullClass = -1;
+
+    ThematicClassifier();
+
+    /// How to compute the breaks.  Jenks by default.
+    void setMethod(ThematicClassMethod newMethod) { method = newMethod; }
+    ThematicClassMethod getMethod() const { return method; }
+
+    /// Number of classes to aim for.  Five by default.
+    void setNumClasses(int num);
+
+    /// Use these breaks as is.  There's one more break than there are classes.
+    void setManualBreaks(const std::vector<double> &breaks);
+
+    /// Class width in standard deviations for the standard deviation method.  One by default.
+    void setStdDevInterval(double interval);
+
+    /// Leave this fraction of the values out at the low and high ends when computing breaks.
+    /// Those values become outliers.
+    void setOutlierTrim(double lowFrac,double highFrac);
+
+    /// Also treat values more than this many standard deviations from the mean as outliers.  Zero for off.
+    void setOutlierStdDevs(double numStdDevs);
+
+    /// Values to classify.  NaN counts as null.
+    void setValues(const std::vector<double> &values);
+
+    /// Read the values from an attribute on the shapes.  Missing or non-numeric values count as null.
+    void setValues(const ShapeSet &shapes,const std::string &attrName);
+
+    /// Work out the breaks with the current settings.  Call again to reclassify.
+    /// False if there's nothing to work with.
+    bool computeBreaks();
+
+    /// The breaks, one more than the number of classes
+    const std::vector<double> &getBreaks() const { return breaks; }
+
+    /// Number of classes after computing the breaks
+    int getNumClasses() const { return breaks.empty() ? 0 : (int)breaks.size()-1; }
+
+    /// Values in each class, outliers included
+    const std::vector<int> &getClassCounts() const { return classCounts; }
+    int getNullCount() const { return nullCount; }
+    int getOutlierCount() const { return outlierCount; }
+
+    /// Goodness of variance fit over the values between the breaks.  One is a perfect fit.
+    double getGoodnessOfFit() const { return goodnessOfFit; }
+
+    /// Class a value goes in, or NullClass
+    int classFor(double val) const;
+
+    /// Set if the value is outside the breaks
+    bool isOutlier(double val) const;
+
+    /// Colors for the classes in order.  Missing ones repeat the last.
+    void setColors(const std::vector<RGBAColor> &colors);
+
+    /// Sample a ramp evenly from its low end to its high end, one color per class
+    void setColorRamp(const ColorMap &ramp);
+
+    /// Color for missing values.  Transparent by default.
+    void setNullColor(const RGBAColor &color) { nullColor = color; }
+
+    /// Color for outliers, rather than their end class color
+    void setOutlierColor(const RGBAColor &color) { outlierColor = color;  useOutlierColor = true; }
+    void clearOutlierColor() { useOutlierColor = false; }
+
+    /// Color for a given class
+    RGBAColor colorForClass(int which) const;
+
+    /// Color for a value, taking nulls and outliers into account
+    RGBAColor colorFor(double val) const;
+
+    /// Attribute to write each shape's class into.  "class" by default.
+    void setClassAttribute(const std::string &attr) { classAttr = attr; }
+
+    /** Write the class and color (MaplyColor) into each shape's attributes, from the attribute
+        the values came from.  Follow with VectorManager::changeVectorColors to update
+        recolorable vectors that have already been added.
+      */
+    void applyToShapes(const ShapeSet &shapes) const;
+
+    /// Numeric value of an attribute or NaN if it's missing
+    static double ValueForAttribute(const Dictionary *attrs,const std::string &attrName);
+
+protected:
+    void breaksEqualInterval(const std::vector<double> &vals);
+    void breaksQuantile(const std::vector<double> &vals);
+    void breaksJenks(const std::vector<double> &vals);
+    void breaksStdDev(const std::vector<double> &vals);
+    void calcStats(const std::vector<double> &vals);
+
+    ThematicClassMethod method;
+    int numClasses;
+    std::vector<double> manualBreaks;
+    double stdDevInterval;
+    double trimLow,trimHigh;
+    double outlierStdDevs;
+    std::string attrName,classAttr;
+
+    // Values that aren't null, sorted
+    std::vector<double> sortedVals;
+    int nullCount;
+
+    std::vector<double> breaks;
+    std::vector<int> classCounts;
+    int outlierCount;
+    double goodnessOfFit;
+
+    std::vector<RGBAColor> colors;
+    ColorMap ramp;
+    RGBAColor nullColor,outlierColor;
+    bool useOutlierColor;
+};
+
+}
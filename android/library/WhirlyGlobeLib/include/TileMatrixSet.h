@@ -0,0 +1,156 @@
+/*
+ *  TileMatrixSet.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <vector>
+#import "WhirlyVector.h"
+#import "Quadtree.h"
+
+namespace WhirlyKit
+{
+
+class ViewState;
+class CoordSystem;
+class CoordSystemDisplayAdapter;
+
+/** A single level in a tile matrix set.
+    Tiles are laid out in a regular grid starting from a corner.
+    Tile (0,0) is in the lower left, as with the rest of the toolkit.
+    Use the row methods to convert if your source counts rows from the top.
+  */
+class TileMatrix
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    TileMatrix();
+    /// Construct with the lower left corner, size of a tile and number of tiles
+    TileMatrix(const Point2d &ll,const Point2d &tileSpan,int matrixWidth,int matrixHeight);
+
+    /// Construct from a WMTS style description.  The top left corner is where tiles start,
+    ///  the scale denominator and meters per unit work out the tile size.
+    static TileMatrix FromWMTS(const Point2d &topLeft,double scaleDenominator,double metersPerUnit,int tileWidth,int tileHeight,int matrixWidth,int matrixHeight);
+
+    /// Lower left corner of tile (0,0) in the coordinate system
+    Point2d ll;
+    /// Size of a single tile in coordinate system units
+    Point2d tileSpan;
+    /// Number of tiles across and up
+    int matrixWidth,matrixHeight;
+    /// Optional limits on the tiles that actually exist.  Defaults to the whole matrix.
+    int minCol,maxCol,minRow,maxRow;
+    /// Size of a tile in pixels, if the level says.  0 means use whatever the source does.
+    int tileWidth,tileHeight;
+
+    /// Upper right corner of the whole matrix
+    Point2d ur() const;
+
+    /// Check the tile is within the matrix and limits
+    bool isValid(int x,int y) const;
+
+    /// Row counting from the top, for sources that do it that way
+    int topRow(int y) const { return matrixHeight-1-y; }
+};
+
+typedef std::vector<TileMatrix,Eigen::aligned_allocator<TileMatrix> > TileMatrixVector;
+
+/** A Tile Matrix Set describes how a tiling scheme breaks up space at each level.
+    The usual quad tree splits each tile into four at the next level, but WMTS
+    and a number of national grids use their own scales and extents per level.
+    Tiles at one level don't need to line up with the level above.
+    Each tile has a single parent, the tile above containing its center, which
+    is what the Quadtree uses to track loading.  Coverage (when a tile can be
+    replaced by the level below) uses all the tiles that overlap it.
+    For the usual quad tree the two are the same.
+  */
+class TileMatrixSet
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    TileMatrixSet();
+    virtual ~TileMatrixSet();
+
+    /// Build the regular power of two quad tree over the given extents
+    static TileMatrixSetRef MakeQuadTree(const Point2d &ll,const Point2d &ur,int numLevels);
+    /// Build the regular power of two quad tree over the given extents
+    static TileMatrixSetRef MakeQuadTree(const Mbr &mbr,int numLevels);
+
+    /// Add a level.  Levels go from the top (least detailed) down.
+    void addLevel(const TileMatrix &level);
+
+    /// Number of levels we know about
+    int getNumLevels() const { return (int)levels.size(); }
+
+    /// Return the given level
+    const TileMatrix &getLevel(int level) const { return levels[level]; }
+
+    /// True if this is a regular power of two quad tree
+    bool isQuadTree() const { return quadTree; }
+
+    /// Bounding box that covers all the levels
+    Mbr getTotalExtents() const;
+
+    /// Bounding box that covers all the levels in 64 bit precision
+    void getTotalExtents(Point2d &ll,Point2d &ur) const;
+
+    /// Check that the tile is on a level we know and within its matrix
+    bool isValidTile(const Quadtree::Identifier &ident) const;
+
+    /// Bounding box of the given tile
+    Mbr calcTileMbr(const Quadtree::Identifier &ident) const;
+
+    /// Bounding box of the given tile in 64 bit precision
+    void calcTileMbr(const Quadtree::Identifier &ident,Point2d &ll,Point2d &ur) const;
+
+    /// Valid tiles on the given level that overlap the bounding box (more than just touching)
+    void tilesForMbr(int level,const Point2d &ll,const Point2d &ur,std::vector<Quadtree::Identifier> &tiles) const;
+
+    /// All the valid tiles on a given level
+    void tilesForLevel(int level,std::vector<Quadtree::Identifier> &tiles) const;
+
+    /// Valid tile on the given level containing the point.  Returns false if there isn't one.
+    bool tileForPoint(int level,const Point2d &pt,Quadtree::Identifier &tile) const;
+
+    /// The parent of a tile is the tile one level up containing its center.
+    /// Returns false at the top or if the center falls outside the level above.
+    bool parentForTile(const Quadtree::Identifier &ident,Quadtree::Identifier &parent) const;
+
+    /// Tiles one level down whose parent is this tile
+    void childrenForTile(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &children) const;
+
+    /// Tiles one level down that overlap this one.  These are what cover it.
+    void overlappingChildren(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &children) const;
+
+    /// Tiles one level up that overlap this one.  These are what it covers.
+    void overlappingParents(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &parents) const;
+
+    /// Screen space importance of a tile, as with ScreenImportance(), but using the tile's own
+    ///  extents and the pixel size of its level.  tileSize is used for levels that don't say.
+    double screenImportance(ViewState *viewState,const Point2f &frameSize,int tileSize,CoordSystem *srcSystem,CoordSystemDisplayAdapter *coordAdapter,const Quadtree::Identifier &ident,Dictionary *attrs) const;
+
+    /// Screen space importance of a tile with a height range, for volumes
+    double screenImportance(ViewState *viewState,const Point2f &frameSize,int tileSize,CoordSystem *srcSystem,CoordSystemDisplayAdapter *coordAdapter,const Quadtree::Identifier &ident,double minZ,double maxZ,Dictionary *attrs) const;
+
+protected:
+    TileMatrixVector levels;
+    bool quadTree;
+};
+
+}
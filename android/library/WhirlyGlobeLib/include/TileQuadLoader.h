@@ -123,6 +123,10 @@ public:
     /// QuadTileLoaderSupport methods
     virtual void loadedImages(QuadTileImageDataSource *dataSource,const std::vector<LoadedImage *> &loadImages,int level,int col,int row,int frame,ChangeSet &changes);
 
+    /// Images for a tile along with its elevation.  The elevation goes to the scene's
+    ///  elevation manager for as long as the tile is loaded.  The tile geometry stays flat.
+    virtual void loadedImages(QuadTileImageDataSource *dataSource,const std::vector<LoadedImage *> &loadImages,ElevationGridTileRef elevTile,int level,int col,int row,int frame,ChangeSet &changes);
+
     /// Set up the change requests to make the given image layer the active one
     /// The call is thread safe
     void setCurrentImage(int newImage,ChangeSet &changeRequests);
@@ -260,9 +264,13 @@ protected:
     void clear();
     void refreshParents();
     InternalLoadedTile *getTile(const Quadtree::Identifier &ident);
+    /// Parent whose geometry should be updated when this tile changes.  Only regular quad trees split that way.
+    bool parentForTile(const Quadtree::Identifier &ident,Quadtree::Identifier &parentIdent);
     void flushUpdates(ChangeSet &changes);
     void runSetCurrentImage(ChangeSet &changes);
     void updateTexAtlasMapping();
+    /// Take tiles out of the elevation manager once they're no longer loaded
+    void removeElevTiles(const std::vector<Quadtree::Identifier> &idents);
 
     pthread_mutex_t tileLock;
 
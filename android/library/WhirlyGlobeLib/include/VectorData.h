@@ -22,6 +22,7 @@
 #import <vector>
 #import <set>
 #import <map>
+#import <functional>
 #import "Identifiable.h"
 #import "WhirlyVector.h"
 #import "WhirlyGeometry.h"
@@ -88,6 +89,9 @@ struct VectorShapeRefCmp
 /// It's a set of reference counted shapes.  You have to dynamic
 ///  cast to get the specfic type.  Don't forget to use the std dynamic cast
 typedef std::set<VectorShapeRef,VectorShapeRefCmp> ShapeSet;
+
+/// Called with the shapes from each feature as they're read
+typedef std::function<void(ShapeSet &shapes)> VectorFeatureCallback;
     
 /// Calculate area of a loop
 float CalcLoopArea(const VectorRing &);
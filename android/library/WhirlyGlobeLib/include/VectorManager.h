@@ -32,6 +32,8 @@
 namespace WhirlyKit
 {
 
+class VectorInfo;
+
 /*  This is the representation of a group of vectors
      in the scene.  You do not want to create individual
      vector features on the globe one by one, that's too expensive.
@@ -49,9 +51,27 @@ public:
     // Clean out the representation
     void clear(ChangeSet &changes);
     
+    // Note where some of a shape's vertices went, merging with the last run if we can
+    void addVertexRange(const VectorShape *shape,SimpleIdentity drawID,int start,int count);
+    
     SimpleIDSet drawIDs;    // The drawables we created
     SimpleIDSet instIDs;    // Instances if we're doing that
     float fade;       // If set, the amount of time to fade out before deletion
+
+    // Only for vectors clamped to the ground, so we can rebuild them
+    ShapeSet shapes;
+    std::shared_ptr<VectorInfo> clampInfo;
+    GeoMbr geoMbr;
+    
+    // A run of vertices in one drawable
+    class VertexRange
+    {
+    public:
+        SimpleIdentity drawID;
+        int start,count;
+    };
+    // Only for recolorable vectors, where each shape's vertices ended up
+    std::map<const VectorShape *,std::vector<VertexRange> > shapeRanges;
 };
 typedef std::set<VectorSceneRep *,IdentifiableSorter> VectorSceneRepSet;
 
@@ -81,6 +101,8 @@ public:
     bool                        centered;
     bool                        vecCenterSet;
     Point2f                     vecCenter;
+    bool                        clampToGround;
+    bool                        recolorable;
 };
 
 #define kWKVectorManager "WKVectorManager"
@@ -100,7 +122,14 @@ public:
     /// Change the vector(s) represented by the given ID
     void changeVectors(SimpleIdentity vecID,const VectorInfo &vecInfo,ChangeSet &changes);
     
+    /** Push the current color attribute (MaplyColor) of each shape out to its vertices,
+        without rebuilding anything.  The vectors must have been added as recolorable
+        and the shapes must be the same objects that were added.  Shapes with no color are left alone.
+      */
+    void changeVectorColors(SimpleIdentity vecID,const ShapeSet &shapes,ChangeSet &changes);
+    
     /// Make an instance of the given vectors with the given attributes and return an ID to identify them.
+    /// Vectors clamped to the ground can't be instanced, since their drawables are replaced.
     SimpleIdentity instanceVectors(SimpleIdentity vecID,const VectorInfo &vecInfo,ChangeSet &changes);
 
     /// Remove a group of vectors associated with the given ID
@@ -109,7 +138,13 @@ public:
     /// Enable/disable vector data
     void enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet &changes);
     
+    /// More detailed elevation showed up in the given areas.  Rebuild anything clamped to the ground there.
+    void elevationChanged(const std::vector<GeoMbr> &mbrs,ChangeSet &changes);
+    
 protected:
+    /// Build the drawables for a group of vectors into the given representation
+    void buildVectors(VectorSceneRep *sceneRep,ShapeSet *shapes,const VectorInfo &vecInfo,ChangeSet &changes);
+
     pthread_mutex_t vectorLock;
     VectorSceneRepSet vectorReps;
 };
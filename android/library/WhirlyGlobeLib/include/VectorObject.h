@@ -51,6 +51,26 @@ public:
     /// @return True on success, false on failure.
     bool fromShapeFile(const std::string &fileName);
 
+    /// @brief Add objects from Well Known Binary (ISO or EWKB), in degrees.
+    /// @details Any number of geometries one after another are fine.
+    /// @return True on success, false on failure.
+    bool fromWKB(const unsigned char *data,size_t len);
+
+    /// @brief Add objects from Tiny WKB, in degrees.  Any number of geometries one after another are fine.
+    bool fromTWKB(const unsigned char *data,size_t len);
+
+    /// @brief Add objects from Well Known Text, in degrees.  Geometries can be separated by whitespace or semicolons.
+    bool fromWKT(const std::string &wkt);
+
+    /// @brief Append the shapes as a single WKB geometry in degrees, EWKB if an SRID is given.
+    bool toWKB(std::string &out,int srid = 0);
+
+    /// @brief Append the shapes as a single TWKB geometry in degrees, with the given decimal places.
+    bool toTWKB(std::string &out,int precision = 6);
+
+    /// @brief Append the shapes as a single WKT geometry in degrees.
+    bool toWKT(std::string &out);
+
     /// @brief Assemblies are just concattenated JSON
     static bool FromGeoJSONAssembly(const std::string &json,std::map<std::string,VectorObject *> &vecData);
     
@@ -0,0 +1,289 @@
+/*
+ *  VectorWKB.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <functional>
+#import <string>
+#import "VectorData.h"
+
+namespace WhirlyKit
+{
+
+/// The geometry types as they appear in WKB, TWKB and WKT
+typedef enum {WKBPoint=1,WKBLineString=2,WKBPolygon=3,WKBMultiPoint=4,WKBMultiLineString=5,WKBMultiPolygon=6,WKBGeometryCollection=7,
+    WKBPolyhedralSurface=15,WKBTIN=16,WKBTriangle=17} WKBGeometryType;
+
+/// Converts coordinates on their way in or out of shapes
+typedef std::function<Point2d(const Point2d &)> GeometryConverter;
+
+/** Simple features geometry, between shapes and the various encodings.
+    Coordinates are in the encoding's system, usually degrees.
+  */
+class WKBGeometry
+{
+public:
+    WKBGeometry() : type(WKBPoint), hasZ(false) { }
+
+    WKBGeometryType type;
+    bool hasZ;
+    /// The point, the line or the rings, depending on the type.  Z is zero if there isn't one.
+    std::vector<Point3dVector> rings;
+    /// Parts of multi types, collections, TINs and polyhedral surfaces
+    std::vector<WKBGeometry> parts;
+    /// IDs for the parts, from TWKB, if there are any
+    std::vector<int64_t> ids;
+
+    /// True if there are no coordinates
+    bool empty() const;
+
+    /** Build from a set of shapes.  One shape keeps its own type, shapes that are all
+        the same type turn into the multi version of it and anything else is a collection.
+        Points, linears, 3D linears, areals and triangle meshes (as TINs) are handled.
+        If the ID attribute is set, each part gets its shape's value as an ID.
+      */
+    static bool FromShapes(const ShapeSet &shapes,const GeometryConverter &converter,const std::string &idAttr,WKBGeometry &geom);
+
+    /// Build from a single shape
+    static bool FromShape(VectorShape *shape,const GeometryConverter &converter,WKBGeometry &geom);
+
+    /** Add the shapes for this geometry.
+        Multi points become one VectorPoints, while the parts of other multi types become
+        separate shapes, as with GeoJSON.  Lines with Z become 3D linears if keepZ is set,
+        otherwise Z is dropped.  Triangles and TINs become triangle meshes.
+        Part IDs are set on the shapes under idAttr, if there is one.
+      */
+    void toShapes(const GeometryConverter &converter,bool keepZ,const std::string &idAttr,ShapeSet &shapes) const;
+};
+
+/// Default conversion from degrees to radians on the way in
+Point2d GeometryDegreesToRadians(const Point2d &pt);
+/// Default conversion from radians to degrees on the way out
+Point2d GeometryRadiansToDegrees(const Point2d &pt);
+
+/** Reads Well Known Binary geometry into shapes.
+    Both ISO (1000s for Z, 2000s for M) and EWKB (high bit flags, with an optional SRID) are understood.
+    M values are skipped.
+  */
+class WKBParser
+{
+public:
+    WKBParser();
+
+    /// Converts coordinates as they're read into geographic radians.
+    /// By default they're taken to be longitude and latitude in degrees.
+    void setConverter(const GeometryConverter &func) { converter = func; }
+
+    /// Make 3D linears out of lines with Z.  Off by default.
+    void setKeepZ(bool newKeepZ) { keepZ = newKeepZ; }
+
+    /// Parse one geometry, adding the shapes to the set.
+    /// Returns the number of bytes used, or 0 if it couldn't be parsed.
+    size_t parse(const unsigned char *data,size_t len,ShapeSet &shapes);
+
+    /// Parse one geometry without making shapes
+    size_t parse(const unsigned char *data,size_t len,WKBGeometry &geom);
+
+    /// Parse geometries one after another until the data runs out.  False if any of them fail.
+    bool parseAll(const unsigned char *data,size_t len,ShapeSet &shapes);
+
+    /// SRID from the last EWKB geometry that had one, otherwise 0
+    int getSRID() const { return srid; }
+
+    /// Set if the last parse failed because it ran out of data
+    bool needsMore() const { return truncated; }
+
+protected:
+    bool parseGeometry(WKBGeometry &geom,int depth);
+    bool readHeader(int &type,bool &hasZ,bool &hasM);
+    bool readUInt32(uint32_t &val);
+    bool readDouble(double &val);
+    bool readPoint(bool hasZ,bool hasM,Point3d &pt);
+    bool readRing(bool hasZ,bool hasM,Point3dVector &ring);
+
+    GeometryConverter converter;
+    bool keepZ;
+    const unsigned char *data;
+    size_t len,pos;
+    bool littleEndian;
+    bool truncated;
+    int srid;
+};
+
+/** Writes shapes out as Well Known Binary, little endian.
+    ISO types are written unless there's an SRID or EWKB is asked for.
+    3D linears are written with Z.  Nothing has M.
+  */
+class WKBWriter
+{
+public:
+    WKBWriter();
+
+    /// Converts coordinates from geographic radians on the way out.  Degrees by default.
+    void setConverter(const GeometryConverter &func) { converter = func; }
+
+    /// Write EWKB with this SRID on the top level geometry.  Zero for none.
+    void setSRID(int newSRID) { srid = newSRID; }
+
+    /// Write EWKB style types even without an SRID
+    void setEWKB(bool newEWKB) { ewkb = newEWKB; }
+
+    /// Append one geometry for all the shapes.  False if there's nothing to write.
+    bool write(const ShapeSet &shapes,std::string &out);
+
+    /// Append one geometry for a single shape
+    bool write(VectorShapeRef shape,std::string &out);
+
+    /// Append a geometry
+    void write(const WKBGeometry &geom,std::string &out);
+
+protected:
+    void writeGeometry(const WKBGeometry &geom,bool hasZ,bool top,std::string &out);
+
+    GeometryConverter converter;
+    int srid;
+    bool ewkb;
+};
+
+/** Reads Tiny WKB.
+    Precision, bounding boxes, sizes, ID lists and extended dimensions are all handled.
+    IDs end up as an attribute on the shapes.  M values are skipped.
+  */
+class TWKBParser
+{
+public:
+    TWKBParser();
+
+    /// Converts coordinates as they're read into geographic radians.  Degrees by default.
+    void setConverter(const GeometryConverter &func) { converter = func; }
+
+    /// Make 3D linears out of lines with Z.  Off by default.
+    void setKeepZ(bool newKeepZ) { keepZ = newKeepZ; }
+
+    /// Attribute name for the IDs from ID lists.  "id" by default.
+    void setIDAttribute(const std::string &attr) { idAttr = attr; }
+
+    /// Parse one geometry, adding the shapes to the set.
+    /// Returns the number of bytes used, or 0 if it couldn't be parsed.
+    size_t parse(const unsigned char *data,size_t len,ShapeSet &shapes);
+
+    /// Parse one geometry without making shapes
+    size_t parse(const unsigned char *data,size_t len,WKBGeometry &geom);
+
+    /// Parse geometries one after another until the data runs out.  False if any of them fail.
+    bool parseAll(const unsigned char *data,size_t len,ShapeSet &shapes);
+
+    /// Set if the last parse failed because it ran out of data
+    bool needsMore() const { return truncated; }
+
+protected:
+    bool parseGeometry(WKBGeometry &geom,int depth);
+    bool readVarInt(uint64_t &val);
+    bool readSignedVarInt(int64_t &val);
+    bool readCoords(uint64_t numPts,Point3dVector &pts);
+
+    GeometryConverter converter;
+    bool keepZ;
+    std::string idAttr;
+    const unsigned char *data;
+    size_t len,pos;
+    bool truncated;
+    // Current geometry's dimensions and scales
+    bool hasZ,hasM;
+    double scaleXY,scaleZ,scaleM;
+    int64_t prev[4];
+};
+
+/** Writes Tiny WKB.
+    Coordinates are rounded to the given number of decimal places, which can be negative.
+  */
+class TWKBWriter
+{
+public:
+    TWKBWriter();
+
+    /// Converts coordinates from geographic radians on the way out.  Degrees by default.
+    void setConverter(const GeometryConverter &func) { converter = func; }
+
+    /// Decimal places for x and y (-8 to 7) and for z (0 to 7)
+    void setPrecision(int xy,int z = 0);
+
+    /// Include a bounding box in the header
+    void setIncludeBBox(bool newBBox) { includeBBox = newBBox; }
+
+    /// Include the size in the header, so readers can skip geometries
+    void setIncludeSize(bool newSize) { includeSize = newSize; }
+
+    /// Write an ID list for multi types, from this integer attribute on each shape
+    void setIDAttribute(const std::string &attr) { idAttr = attr; }
+
+    /// Append one geometry for all the shapes.  False if there's nothing to write.
+    bool write(const ShapeSet &shapes,std::string &out);
+
+    /// Append one geometry for a single shape
+    bool write(VectorShapeRef shape,std::string &out);
+
+    /// Append a geometry
+    void write(const WKBGeometry &geom,std::string &out);
+
+protected:
+    void writeGeometry(const WKBGeometry &geom,std::string &out);
+    void writeCoords(const Point3dVector &pts,bool hasZ,int64_t *prev,std::string &out);
+
+    GeometryConverter converter;
+    int precXY,precZ;
+    bool includeBBox,includeSize;
+    std::string idAttr;
+};
+
+/** Decodes WKB or TWKB geometries that arrive a piece at a time,
+    such as from a socket or a file read in chunks.
+    Each geometry's shapes go to the callback as soon as it's complete.
+  */
+class WKBStreamDecoder
+{
+public:
+    /// Decode TWKB if set, otherwise WKB
+    WKBStreamDecoder(bool twkb);
+
+    /// Called with the shapes from each geometry
+    void setCallback(const VectorFeatureCallback &callback) { featureCallback = callback; }
+
+    /// The parsers, for converters and other settings
+    WKBParser &getWKBParser() { return wkbParser; }
+    TWKBParser &getTWKBParser() { return twkbParser; }
+
+    /// Add data, decoding anything that's complete.  False on bad data.
+    bool feed(const unsigned char *data,size_t len);
+
+    /// Call at the end.  False if there's a partial geometry left over.
+    bool finish();
+
+    const std::string &getError() const { return error; }
+
+protected:
+    bool twkb;
+    WKBParser wkbParser;
+    TWKBParser twkbParser;
+    VectorFeatureCallback featureCallback;
+    std::string buf;
+    size_t pos;
+    std::string error;
+};
+
+}
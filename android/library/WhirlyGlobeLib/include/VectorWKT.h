@@ -0,0 +1,116 @@
+/*
+ *  VectorWKT.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <string>
+#import "VectorWKB.h"
+
+namespace WhirlyKit
+{
+
+/** Reads Well Known Text geometry into shapes.
+    Z, M and ZM variants and EWKT's SRID= prefix are understood.
+    Without a dimension tag, three numbers are taken as Z and four as ZM.
+    M values are skipped.
+  */
+class WKTParser
+{
+public:
+    WKTParser();
+
+    /// Converts coordinates as they're read into geographic radians.
+    /// By default they're taken to be longitude and latitude in degrees.
+    void setConverter(const GeometryConverter &func) { converter = func; }
+
+    /// Make 3D linears out of lines with Z.  Off by default.
+    void setKeepZ(bool newKeepZ) { keepZ = newKeepZ; }
+
+    /// Parse one geometry, adding the shapes to the set.
+    /// Returns the number of characters used, or 0 if it couldn't be parsed.
+    size_t parse(const char *str,size_t len,ShapeSet &shapes);
+
+    /// Parse one geometry without making shapes
+    size_t parse(const char *str,size_t len,WKBGeometry &geom);
+
+    /// Parse a whole string of geometries, separated by whitespace or semicolons.
+    /// False if any of them fail.
+    bool parseAll(const std::string &str,ShapeSet &shapes);
+
+    /// SRID from the last EWKT geometry that had one, otherwise 0
+    int getSRID() const { return srid; }
+
+    const std::string &getError() const { return error; }
+
+protected:
+    void skipSpace();
+    bool readWord(std::string &word);
+    bool expect(char c);
+    bool peek(char c);
+    bool parseGeometry(WKBGeometry &geom,int depth);
+    bool parseCoords(int numDims,Point3dVector &pts,bool parens);
+    bool parsePoint(int numDims,Point3d &pt);
+    bool parseRings(int numDims,std::vector<Point3dVector> &rings);
+    bool fail(const std::string &what);
+
+    GeometryConverter converter;
+    bool keepZ;
+    const char *str;
+    size_t len,pos;
+    bool sawZ;
+    int srid;
+    std::string error;
+};
+
+/** Writes shapes out as Well Known Text.
+    Numbers are written with up to the given decimal places and trailing zeros trimmed.
+  */
+class WKTWriter
+{
+public:
+    WKTWriter();
+
+    /// Converts coordinates from geographic radians on the way out.  Degrees by default.
+    void setConverter(const GeometryConverter &func) { converter = func; }
+
+    /// Decimal places.  Negative for as many as it takes.
+    void setPrecision(int newPrecision) { precision = newPrecision; }
+
+    /// Write EWKT with this SRID in front.  Zero for none.
+    void setSRID(int newSRID) { srid = newSRID; }
+
+    /// Append one geometry for all the shapes.  False if there's nothing to write.
+    bool write(const ShapeSet &shapes,std::string &out);
+
+    /// Append one geometry for a single shape
+    bool write(VectorShapeRef shape,std::string &out);
+
+    /// Append a geometry
+    void write(const WKBGeometry &geom,std::string &out);
+
+protected:
+    void writeGeometry(const WKBGeometry &geom,bool hasZ,bool withType,std::string &out);
+    void writeNumber(double val,std::string &out);
+    void writeCoords(const Point3dVector &pts,bool hasZ,std::string &out);
+
+    GeometryConverter converter;
+    int precision;
+    int srid;
+};
+
+}
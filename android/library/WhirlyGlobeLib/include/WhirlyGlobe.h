@@ -24,6 +24,7 @@
 #import "WhirlyGeometry.h"
 #import "GlobeMath.h"
 #import "Quadtree.h"
+#import "TileMatrixSet.h"
 #import "WhirlyKitView.h"
 #import "GlobeView.h"
 //#import "AnimateRotation.h"
@@ -35,6 +36,7 @@
 #import "SceneRendererES.h"
 #import "SceneRendererES2.h"
 #import "SceneRendererES3.h"
+#import "SceneRendererSoft.h"
 //#import "EAGLView.h"
 //#import "PinchDelegate.h"
 //#import "SwipeDelegate.h"
@@ -51,10 +53,13 @@
 #import "ShapeReader.h"
 #import "VectorManager.h"
 #import "WideVectorManager.h"
+#import "ElevationManager.h"
 //#import "VectorLayer.h"
 //#import "LabelLayer.h"
 //#import "ParticleSystemLayer.h"
 #import "MarkerManager.h"
+#import "SpriteSheet.h"
+#import "MotionManager.h"
 //#import "LoftLayer.h"
 #import "SelectionManager.h"
 #import "IntersectionManager.h"
@@ -64,6 +69,7 @@
 #import "FlatMath.h"
 #import "SphericalMercator.h"
 #import "Proj4CoordSystem.h"
+#import "CoordinateGrid.h"
 #import "MaplyView.h"
 #import "MaplyFlatView.h"
 #import "ViewState.h"
@@ -77,6 +83,8 @@
 //#import "MaplyRotateDelegate.h"
 #import "QuadDisplayController.h"
 #import "TileQuadLoader.h"
+#import "ScalarGrid.h"
+#import "ThematicClassifier.h"
 //#import "MBTileQuadSource.h"
 #import "TileQuadOfflineRenderer.h"
 //#import "NetworkTileQuadSource.h"
@@ -84,6 +92,7 @@
 //#import "SceneGraphManager.h"
 //#import "SphericalEarthChunkLayer.h"
 #import "SphericalEarthChunkManager.h"
+#import "GroundControlWarp.h"
 //#import "SphericalEarthQuadLayer.h"
 //#import "UpdateDisplayLayer.h"
 //#import "GeometryLayer.h"
@@ -100,6 +109,10 @@
 #import "GridClipper.h"
 #import "GLUtils.h"
 #import "VectorObject.h"
+#import "VectorWKB.h"
+#import "VectorWKT.h"
+#import "XMLStreamReader.h"
+#import "SLDStyleSet.h"
 #import "ParticleSystemManager.h"
 #import "ParticleSystemDrawable.h"
 #import "WhirlyKitLog.h"
@@ -115,7 +128,18 @@
 #ifndef MAPLYMINIMAL
 #import "MapboxVectorTileParser.h"
 #import "GeoJSONSource.h"
+#import "FlatGeobuf.h"
+#import "GeoPackage.h"
+#import "KMLReader.h"
+#import "GPXReader.h"
+#import "GeoTIFF.h"
 #endif
 #import "OverlapHelper.h"
+#import "ClusterStats.h"
+#import "DrawableAnimator.h"
+#import "MemTracker.h"
+#import "SelectableIndex.h"
+#import "MeshBVH.h"
+#import "ShaderPermutation.h"
 
 
@@ -19,6 +19,7 @@
  */
 
 #import "BasicDrawable.h"
+#import "BasicDrawableInstance.h"
 
 namespace WhirlyKit
 {
@@ -52,6 +53,8 @@ public:
     void add_n0(const Point3f &vec);
     // Complex constant we multiply by width for t
     void add_c0(float c);
+    // Where a unit offset moves the center line at this point, mitered at the joins
+    void add_offset(const Point3f &vec);
     // Optional normal
     void addNormal(const Point3f &norm);
     void addNormal(const Point3d &norm);
@@ -65,9 +68,30 @@ public:
     /// Fix the width to a real world value, rather than letting it change
     void setRealWorldWidth(double width) { realWidthSet = true;  realWidth = width; }
     
+    /// Move the line sideways by this much, positive to the right.
+    /// Real world units if the width is, pixels otherwise.
+    void setOffset(float inOffset) { offset = inOffset; }
+    float getOffset() const { return offset; }
+    
     /// We override draw so we can set our own values
     virtual void draw(RendererFrameInfo *frameInfo,Scene *scene);
     
+    /// Vertex attribute indices for the values the shader uses to widen the line
+    int get_p1_index() const { return p1_index; }
+    int get_n0_index() const { return n0_index; }
+    int get_c0_index() const { return c0_index; }
+    int get_tex_index() const { return tex_index; }
+    int get_offset_index() const { return offset_index; }
+    
+    /// Set if we're drawing on the globe (and have normals)
+    bool getGlobeMode() const { return globeMode; }
+    
+    /// Returns true and the width if it's fixed to a real world value
+    bool getRealWorldWidth(double &width) const { width = realWidth;  return realWidthSet; }
+    
+    float getTexRepeat() const { return texRepeat; }
+    float getEdgeSize() const { return edgeSize; }
+    
     // We don't want the standard attributes
     virtual void setupStandardAttributes(int numReserve=0);
 
@@ -78,10 +102,12 @@ protected:
     bool snapTex;
     float texRepeat;
     float edgeSize;
+    float offset;
     int p1_index;
     int n0_index;
     int c0_index;
     int tex_index;
+    int offset_index;
     
 #ifdef WIDEVECDEBUG
     Point3fVector locPts;
@@ -91,5 +117,27 @@ protected:
     std::vector<float> c0;
 #endif
 };
+
+/** Draws the geometry of a wide vector drawable again as another stroke.
+    We use these for casings and parallel lines, which share a single pass over the data.
+  */
+class WideVectorInstance : public BasicDrawableInstance
+{
+public:
+    WideVectorInstance(const std::string &name,SimpleIdentity masterID);
+    
+    /// Width, real world or pixels to match the master
+    void setWidth(float inWidth) { width = inWidth; }
+    
+    /// Sideways offset in the same units as the width
+    void setOffset(float inOffset) { offset = inOffset; }
+    
+    /// Swap our width and offset into the master while it draws
+    virtual void draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene);
+    
+protected:
+    float width;
+    float offset;
+};
     
 }
@@ -29,6 +29,7 @@
 #import "VectorData.h"
 #import "Dictionary.h"
 #import "BaseInfo.h"
+#import "ScreenSpaceBuilder.h"
 
 namespace WhirlyKit
 {
@@ -42,6 +43,49 @@ typedef enum {WideVecMiterJoin,WideVecRoundJoin,WideVecBevelJoin} WideVectorLine
 /// How the lines begin and end.  See: http://www.w3.org/TR/SVG/painting.html#StrokeLinecapProperty
 typedef enum {WideVecButtCap,WideVecRoundCap,WideVecSquareCap} WideVectorLineCapType;
     
+/// Where a decoration goes on the line
+typedef enum {WideVecDecorationRepeat,WideVecDecorationStart,WideVecDecorationEnd} WideVectorDecorationPlacement;
+
+/** One stroke of a line drawn with several, like a road with a casing.
+    All the strokes share the geometry built for the line.
+  */
+class WideVectorStroke
+{
+public:
+    WideVectorStroke();
+    WideVectorStroke(float width,const RGBAColor &color,int drawPriority);
+    
+    /// Width in the line's coordinate type
+    float width;
+    /// Sideways offset in the same units, positive to the right
+    float offset;
+    RGBAColor color;
+    /// Casings want to go under the lines they surround, so each stroke gets its own
+    int drawPriority;
+};
+
+/** A symbol placed along a line, such as a direction arrow or an end cap.
+    Symbols are drawn pointing up and turned to point along the line.
+  */
+class WideVectorDecoration
+{
+public:
+    WideVectorDecoration();
+    
+    WideVectorDecorationPlacement placement;
+    /// Texture for the symbol
+    SimpleIdentity texID;
+    /// Size on the screen in pixels
+    Point2d size;
+    RGBAColor color;
+    /// Distance between repeated symbols in display coordinates
+    double spacing;
+    /// Distance to the first repeated symbol.  Half the spacing if negative.
+    double startGap;
+    /// Draw priority, or the line's if negative
+    int drawPriority;
+};
+    
 /** Used to pass parameters for the wide vectors around.
   */
 class WideVectorInfo : public BaseInfo
@@ -59,6 +103,14 @@ public:
     WideVectorLineCapType capType;
     SimpleIdentity texID;
     float miterLimit;
+    /// Follow the loaded elevation rather than sitting at sea level
+    bool clampToGround;
+    /// Sideways offset for the line, positive to the right.  Same units as the width.
+    float offset;
+    /// Draw these strokes, in order, rather than the single width and color above
+    std::vector<WideVectorStroke> strokes;
+    /// Symbols placed along the lines
+    std::vector<WideVectorDecoration> decorations;
 };
     
 /// Used to track the
@@ -74,7 +126,13 @@ public:
     
     SimpleIDSet drawIDs;
     SimpleIDSet instIDs;    // Instances if we're doing that
+    SimpleIDSet decorIDs;   // Symbols along the lines
     float fade;
+
+    // Only for vectors clamped to the ground, so we can rebuild them
+    ShapeSet shapes;
+    std::shared_ptr<WideVectorInfo> clampInfo;
+    GeoMbr geoMbr;
 };
 
 typedef std::set<WideVectorSceneRep *,IdentifiableSorter> WideVectorSceneRepSet;
@@ -97,12 +155,23 @@ public:
     void enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet &changes);
     
     /// Make an instance of the give vectors with the given attributes and return an ID to identify them.
+    /// Vectors clamped to the ground can't be instanced, since their drawables are replaced.
     SimpleIdentity instanceVectors(SimpleIdentity vecID,const WideVectorInfo &desc,ChangeSet &changes);
     
     /// Remove a gruop of vectors named by the given ID
     void removeVectors(SimpleIDSet &vecIDs,ChangeSet &changes);
     
+    /// More detailed elevation showed up in the given areas.  Rebuild anything clamped to the ground there.
+    void elevationChanged(const std::vector<GeoMbr> &mbrs,ChangeSet &changes);
+    
 protected:
+    /// Build the drawables for a group of vectors into the given representation
+    void buildVectors(WideVectorSceneRep *sceneRep,ShapeSet *shapes,const WideVectorInfo &vecInfo,ChangeSet &changes);
+
+    /// Place the decorations along a single line, in display coordinates
+    void buildDecorations(ScreenSpaceBuilder &ssBuild,const Point3dVector &dispPts,const WideVectorInfo &vecInfo);
+
+
     pthread_mutex_t vecLock;
     WideVectorSceneRepSet sceneReps;
 };
@@ -0,0 +1,94 @@
+/*
+ *  XMLStreamReader.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdio.h>
+#import <string>
+#import <vector>
+#import <map>
+
+namespace WhirlyKit
+{
+
+/// Attributes on an element, by name
+typedef std::map<std::string,std::string> XMLAttributes;
+
+/// Gets the elements and text as the reader finds them
+class XMLStreamHandler
+{
+public:
+    virtual ~XMLStreamHandler() { }
+
+    virtual void startElement(const std::string &name,const XMLAttributes &attrs) = 0;
+    virtual void endElement(const std::string &name) = 0;
+    /// Text, with the entities replaced.  It may come in more than one piece.
+    virtual void characters(const std::string &text) = 0;
+};
+
+/** A small streaming XML reader.
+    Feed it data a piece at a time and it calls the handler for each element and run of text,
+    so big files can be read without holding them in memory.
+    It handles comments, CDATA, processing instructions and the usual entities.
+    It doesn't validate and ignores DTDs.
+  */
+class XMLStreamReader
+{
+public:
+    XMLStreamReader(XMLStreamHandler *handler);
+
+    /// Drop namespace prefixes from element and attribute names.  On by default.
+    void setStripNamespaces(bool strip) { stripNamespaces = strip; }
+
+    /// Add the next piece of the document.  False if there's been an error.
+    bool feed(const char *data,size_t len);
+
+    /// That's all of it.  False if the document was incomplete or broken.
+    bool finish();
+
+    /// Read a whole file in pieces
+    bool parseFile(FILE *fp);
+
+    /// Read a document that's already in memory
+    bool parse(const std::string &xml);
+
+    /// Stop reading.  Call from a handler when it has what it needs.
+    void stop() { stopped = true; }
+
+    const std::string &getError() const { return error; }
+
+    /// Replace the entity references in a run of text
+    static void AppendDecoded(const char *str,size_t len,std::string &out);
+
+protected:
+    /// Handle everything complete in the buffer
+    bool process(bool final);
+    bool processTag(size_t end);
+    std::string localName(const std::string &name) const;
+
+    XMLStreamHandler *handler;
+    bool stripNamespaces;
+    bool stopped;
+    std::string buf;
+    size_t pos;
+    std::vector<std::string> openElements;
+    bool sawRoot;
+    std::string error;
+};
+
+}
@@ -60,6 +60,7 @@ BaseInfo::BaseInfo(const Dictionary &dict)
     endEnable = dict.getDouble("enableend",0.0);
     SimpleIdentity shaderID = dict.getInt("shader",EmptyIdentity);
     programID = dict.getInt("program",shaderID);
+    memLabel = dict.getString("memlabel");
 
     // Note: Porting
     // Uniforms to be passed to shader
@@ -143,6 +144,7 @@ void BaseInfo::setupBasicDrawable(BasicDrawable *drawable) const
     drawable->setViewerVisibility(minViewerDist,maxViewerDist,viewerCenter);
     drawable->setProgram(programID);
     drawable->setUniforms(uniforms);
+    drawable->setMemLabel(memLabel);
 }
 
 void BaseInfo::setupBasicDrawableInstance(BasicDrawableInstance *drawInst)
@@ -153,6 +155,7 @@ void BaseInfo::setupBasicDrawableInstance(BasicDrawableInstance *drawInst)
     drawInst->setVisibleRange(minVis,maxVis);
     drawInst->setViewerVisibility(minViewerDist,maxViewerDist,viewerCenter);
     drawInst->setUniforms(uniforms);
+    drawInst->setMemLabel(memLabel);
 }
     
 }
@@ -23,6 +23,7 @@
 #import "BasicDrawable.h"
 #import "SceneRendererES.h"
 #import "WhirlyKitLog.h"
+#import "DefaultShaderPrograms.h"
 
 using namespace Eigen;
 
@@ -66,6 +67,7 @@ void BasicDrawable::basicDrawableInit()
     clipCoords = false;
     
     hasMatrix = false;
+    retainVertexData = false;
 }
 
 BasicDrawable::BasicDrawable(const std::string &name)
@@ -393,6 +395,55 @@ void BasicDrawable::addTexCoord(int which,TexCoord coord)
 void BasicDrawable::addColor(RGBAColor color)
 { vertexAttributes[colorEntry]->addColor(color); }
 
+void BasicDrawable::setVertexColors(const std::vector<VertexColorRange> &ranges)
+{
+    if (colorEntry < 0 || ranges.empty())
+        return;
+    VertexAttribute *attr = vertexAttributes[colorEntry];
+    
+    // Haven't been set up yet, so just change the colors
+    int numColors = attr->numElements();
+    if (numColors > 0)
+    {
+        for (const VertexColorRange &range : ranges)
+        {
+            int end = std::min(range.start+range.count,numColors);
+            for (int ii=std::max(range.start,0);ii<end;ii++)
+                memcpy(attr->addressForElement(ii),&range.color.r,4*sizeof(unsigned char));
+        }
+        return;
+    }
+    
+    if (!sharedBuffer || attr->buffer == 0 || retainedVerts.empty())
+    {
+        WHIRLYKIT_LOGW("BasicDrawable: Can't change vertex colors without retained vertex data.");
+        return;
+    }
+    
+    // Change the copy and send the part that changed
+    int numVerts = (int)(retainedVerts.size() / vertexSize);
+    int minVert = numVerts,maxVert = 0;
+    for (const VertexColorRange &range : ranges)
+    {
+        int start = std::max(range.start,0);
+        int end = std::min(range.start+range.count,numVerts);
+        if (start >= end)
+            continue;
+        unsigned char *basePtr = &retainedVerts[start*vertexSize+attr->buffer];
+        for (int ii=start;ii<end;ii++,basePtr+=vertexSize)
+            memcpy(basePtr,&range.color.r,4*sizeof(unsigned char));
+        minVert = std::min(minVert,start);
+        maxVert = std::max(maxVert,end);
+    }
+    if (minVert >= maxVert)
+        return;
+    
+    glBindBuffer(GL_ARRAY_BUFFER, sharedBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, sharedBufferOffset+minVert*vertexSize, (maxVert-minVert)*vertexSize, &retainedVerts[minVert*vertexSize]);
+    CheckGLError("BasicDrawable::setVertexColors() glBufferSubData");
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void BasicDrawable::addNormal(const Point3f &norm)
 { vertexAttributes[normalEntry]->addVector3f(norm); }
 
@@ -530,13 +581,42 @@ void BasicDrawable::updateRenderer(WhirlyKit::SceneRendererES *renderer)
     // Let's also pull the default shaders out if need be
     if (programId == EmptyIdentity)
     {
+        Scene *scene = renderer->getScene();
         if (type == GL_LINE_LOOP || type == GL_LINES)
-            programId = renderer->getScene()->getProgramIDBySceneName(kSceneDefaultLineShader);
-        else
-            programId = renderer->getScene()->getProgramIDBySceneName(kSceneDefaultTriShader);
+            programId = scene->getProgramIDBySceneName(kSceneDefaultLineShader);
+        else {
+            // Anything past the plain default gets the triangle permutation that handles it
+            int features = getShaderFeatures();
+            if (features != ShaderTriLighting && !scene->getMemManager()->isHeadless())
+            {
+                ShaderPermutationManager *shaderManager = (ShaderPermutationManager *)scene->getManager(kWKShaderPermutationManager);
+                if (shaderManager)
+                    programId = shaderManager->getProgram(kToolkitDefaultTriangleModule, features);
+            }
+            if (programId == EmptyIdentity)
+                programId = scene->getProgramIDBySceneName(kSceneDefaultTriShader);
+        }
     }
 }
 
+int BasicDrawable::getShaderFeatures() const
+{
+    int features = ShaderTriLighting;
+    if (texInfo.size() > 1)
+        features |= ShaderTriMultiTex;
+
+    return features;
+}
+
+bool BasicDrawable::hasScreenTexture() const
+{
+    for (const DrawableTweakerRef &tweak : tweakers)
+        if (dynamic_cast<BasicDrawableScreenTexTweaker *>(tweak.get()))
+            return true;
+
+    return false;
+}
+
 // Move the texture coordinates around and apply a new texture
 void BasicDrawable::applySubTexture(int which,SubTexture subTex,int startingAt)
 {
@@ -608,6 +688,19 @@ void BasicDrawable::setUniforms(const SingleVertexAttributeSet &newUniforms)
     uniforms = newUniforms;
 }
 
+unsigned long BasicDrawable::getMemSize() const
+{
+    unsigned long size = points.size() * sizeof(Eigen::Vector3f) + tris.size() * sizeof(Triangle) + retainedVerts.size();
+    for (VertexAttribute *attr : vertexAttributes)
+        size += attr->numElements() * attr->size();
+    
+    // Once it's been handed to GL the arrays are gone, but the buffer isn't
+    if (usingBuffers && !sharedBufferIsExternal)
+        size += numPoints * vertexSize + numTris * sizeof(Triangle);
+    
+    return size;
+}
+
 // Size of a single vertex in an interleaved buffer
 // Note: We're resetting the buffers for no good reason
 GLuint BasicDrawable::singleVertexSize()
@@ -755,6 +848,9 @@ void BasicDrawable::setupGL(WhirlyKitGLSetupInfo *setupInfo,OpenGLMemManager *me
             memcpy(basePtr, &tris[ii], sizeof(Triangle));
         
         glBufferData(GL_ARRAY_BUFFER, bufferSize, glMem, GL_STATIC_DRAW);
+        // Hang on to the vertices if they're going to be changed later
+        if (retainVertexData)
+            retainedVerts.assign(glMem,glMem+numVerts*vertexSize);
         free(glMem);
     }
     
@@ -1018,6 +1114,7 @@ void BasicDrawable::teardownGL(OpenGLMemManager *memManager)
     triBuffer = 0;
     for (unsigned int ii=0;ii<vertexAttributes.size();ii++)
         vertexAttributes[ii]->buffer = 0;
+    retainedVerts.clear();
 }
 
 void BasicDrawable::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
@@ -1095,6 +1192,11 @@ GLuint BasicDrawable::setupVAO(OpenGLES2Program *prog)
     return theVertArrayObj;
 }
 
+void BasicDrawable::drawTriangleElements(GLsizei numIndices,const GLvoid *indices)
+{
+    glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, indices);
+}
+
 // Draw Vertex Buffer Objects, OpenGL 2.0
 void BasicDrawable::drawOGL2(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
 {
@@ -1145,6 +1247,11 @@ void BasicDrawable::drawOGL2(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scen
         fade = fade * factor;
     }
     
+    // Keyframe animation from the scene's animator
+    const DrawableAnimState *animState = frameInfo->animState;
+    if (animState)
+        fade = fade * animState->alpha;
+    
     // GL Texture IDs
     bool anyTextures = false;
     std::vector<GLuint> glTexIDs;
@@ -1195,6 +1302,8 @@ void BasicDrawable::drawOGL2(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scen
     
     // Fade is always mixed in
     prog->setUniform("u_fade", fade);
+    // So is the tint, which is usually white
+    prog->setUniform("u_tint", animState ? animState->color : Vector4f(1.0,1.0,1.0,1.0));
     
     // Let the shaders know if we even have a texture
     prog->setUniform("u_hasTexture", anyTextures);
@@ -1340,7 +1449,7 @@ void BasicDrawable::drawOGL2(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scen
         switch (type)
         {
             case GL_TRIANGLES:
-                glDrawElements(GL_TRIANGLES, numTris*3, GL_UNSIGNED_SHORT, CALCBUFOFF(sharedBufferOffset,triBuffer));
+                drawTriangleElements(numTris*3, CALCBUFOFF(sharedBufferOffset,triBuffer));
                 CheckGLError("BasicDrawable::drawVBO2() glDrawElements");
                 break;
             case GL_POINTS:
@@ -1368,14 +1477,14 @@ void BasicDrawable::drawOGL2(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scen
                     if (!boundElements)
                         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triBuffer);
                     CheckGLError("BasicDrawable::drawVBO2() glBindBuffer");
-                    glDrawElements(GL_TRIANGLES, numTris*3, GL_UNSIGNED_SHORT, (void *)((uintptr_t)triBuffer));
+                    drawTriangleElements(numTris*3, (void *)((uintptr_t)triBuffer));
                     CheckGLError("BasicDrawable::drawVBO2() glDrawElements");
                     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
                 } else {
                     if (!boundElements)
-                        glDrawElements(GL_TRIANGLES, (GLsizei)tris.size()*3, GL_UNSIGNED_SHORT, &tris[0]);
+                        drawTriangleElements((GLsizei)tris.size()*3, &tris[0]);
                     else
-                        glDrawElements(GL_TRIANGLES, numTris*3, GL_UNSIGNED_SHORT, 0);
+                        drawTriangleElements(numTris*3, 0);
                     CheckGLError("BasicDrawable::drawVBO2() glDrawElements");
                 }
             }
@@ -1518,6 +1627,23 @@ void ColorChangeRequest::execute2(Scene *scene,WhirlyKit::SceneRendererES *rende
     }
 }
 
+VertexColorChangeRequest::VertexColorChangeRequest(SimpleIdentity drawId)
+: DrawableChangeRequest(drawId)
+{
+}
+
+void VertexColorChangeRequest::addRange(int start,int count,RGBAColor color)
+{
+    ranges.push_back(VertexColorRange(start,count,color));
+}
+
+void VertexColorChangeRequest::execute2(Scene *scene,WhirlyKit::SceneRendererES *renderer,DrawableRef draw)
+{
+    BasicDrawableRef basicDrawable = std::dynamic_pointer_cast<BasicDrawable>(draw);
+    if (basicDrawable)
+        basicDrawable->setVertexColors(ranges);
+}
+
 OnOffChangeRequest::OnOffChangeRequest(SimpleIdentity drawId,bool OnOff)
 : DrawableChangeRequest(drawId), newOnOff(OnOff)
 {
@@ -23,6 +23,8 @@
 #import "GlobeScene.h"
 #import "SceneRendererES.h"
 #import "TextureAtlas.h"
+#import "ShaderPermutation.h"
+#import "DefaultShaderPrograms.h"
 
 using namespace Eigen;
 
@@ -106,7 +108,42 @@ void BasicDrawableInstance::updateRenderer(WhirlyKit::SceneRendererES *renderer)
         renderer->addContinuousRenderRequest(getId());
     }
     
-    return basicDraw->updateRenderer(renderer);
+    basicDraw->updateRenderer(renderer);
+
+    // If the base drawable ended up with a default triangle program, that doesn't know about the instance matrices
+    GLenum type = basicDraw->getType();
+    Scene *scene = renderer->getScene();
+    if (programID == EmptyIdentity && instanceStyle == LocalStyle && type != GL_LINE_LOOP && type != GL_LINES &&
+        !scene->getMemManager()->isHeadless())
+    {
+        ShaderPermutationManager *shaderManager = (ShaderPermutationManager *)scene->getManager(kWKShaderPermutationManager);
+        SimpleIdentity baseProgID = basicDraw->getProgram();
+        if (shaderManager && baseProgID != EmptyIdentity &&
+            (baseProgID == scene->getProgramIDBySceneName(kSceneDefaultTriShader) ||
+             baseProgID == shaderManager->getProgram(kToolkitDefaultTriangleModule, basicDraw->getShaderFeatures())))
+            programID = shaderManager->getProgram(kToolkitDefaultTriangleModule, getShaderFeatures());
+    }
+}
+
+int BasicDrawableInstance::getShaderFeatures() const
+{
+    int features = basicDraw ? basicDraw->getShaderFeatures() : ShaderTriLighting;
+    if (instanceStyle == LocalStyle)
+    {
+        if (basicDraw && basicDraw->hasScreenTexture())
+            features |= ShaderTriScreenTex;
+        else
+            features |= ShaderTriModelInstance;
+    }
+
+    return features;
+}
+
+void BasicDrawableInstance::runTweakers(RendererFrameInfo *frame)
+{
+    Drawable::runTweakers(frame);
+    if (basicDraw)
+        basicDraw->runTweakers(frame);
 }
 
 const Eigen::Matrix4d *BasicDrawableInstance::getMatrix() const
@@ -384,6 +421,11 @@ void BasicDrawableInstance::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *
             fade = fade * factor;
         }
         
+        // Keyframe animation from the scene's animator
+        const DrawableAnimState *animState = frameInfo->animState;
+        if (animState)
+            fade = fade * animState->alpha;
+        
         // Time for motion
         if (moving)
             frameInfo->program->setUniform("u_time", (float)(frameInfo->currentTime - startTime));
@@ -412,6 +454,8 @@ void BasicDrawableInstance::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *
         
         // Fade is always mixed in
         prog->setUniform("u_fade", fade);
+        // The tint has to be set every time or it'll carry over from the last drawable
+        prog->setUniform("u_tint", animState ? animState->color : Vector4f(1.0,1.0,1.0,1.0));
         
         // Let the shaders know if we even have a texture
         prog->setUniform("u_hasTexture", anyTextures);
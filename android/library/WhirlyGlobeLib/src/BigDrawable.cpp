@@ -255,6 +255,11 @@ void BigDrawable::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
         theFade = theFade * factor;
     }
     
+    // Keyframe animation from the scene's animator
+    const DrawableAnimState *animState = frameInfo->animState;
+    if (animState)
+        theFade = theFade * animState->alpha;
+    
     // If it's totally faded out, don't waste the rendering
     if (theFade <= 0.0)
         return;
@@ -276,6 +281,8 @@ void BigDrawable::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
     
     // Fade is always mixed in
     prog->setUniform("u_fade", theFade);
+    // The tint has to be set every time or it'll carry over from the last drawable
+    prog->setUniform("u_tint", animState ? animState->color : Eigen::Vector4f(1.0,1.0,1.0,1.0));
     
     // Let the shaders know if we even have a texture
     prog->setUniform("u_hasTexture", anyTextures);
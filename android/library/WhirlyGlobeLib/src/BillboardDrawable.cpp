@@ -20,6 +20,9 @@
 
 #include "BillboardDrawable.h"
 #include "OpenGLES2Program.h"
+#include "GLUtils.h"
+#include "SceneRendererES.h"
+#include "WhirlyKitLog.h"
 
 namespace WhirlyKit
 {
@@ -42,6 +45,7 @@ void BillboardDrawable::addOffset(const Point3d &offset)
 static const char *vertexShaderGroundTri =
 "uniform mat4  u_mvpMatrix;                   \n"
 "uniform float u_fade;                        \n"
+"uniform vec4  u_tint;                        \n"
 "uniform vec3 u_eyeVec;"
 "\n"
 "attribute vec3 a_position;                  \n"
@@ -56,7 +60,7 @@ static const char *vertexShaderGroundTri =
 "void main()                                 \n"
 "{                                           \n"
 "   v_texCoord = a_texCoord0;                 \n"
-"   v_color = a_color;         \n"
+"   v_color = a_color * u_tint;\n"
 "   vec3 axisX = cross(u_eyeVec,a_normal);"
 "   vec3 axisZ = cross(axisX,a_normal);"
 "   vec3 newPos = a_position + axisX * a_offset.x + a_normal * a_offset.y + axisZ * a_offset.z;"
@@ -69,6 +73,7 @@ static const char *vertexShaderEyeTri =
 "uniform mat4  u_mvMatrix;                   \n"
 "uniform mat4  u_pMatrix;                   \n"
 "uniform float u_fade;                        \n"
+"uniform vec4  u_tint;                        \n"
 "uniform vec3 u_eyeVec;"
 "\n"
 "attribute vec3 a_position;                  \n"
@@ -83,7 +88,7 @@ static const char *vertexShaderEyeTri =
 "void main()                                 \n"
 "{                                           \n"
 "   v_texCoord = a_texCoord0;                 \n"
-"   v_color = a_color;"
+"   v_color = a_color * u_tint;"
 "   vec4 pos = u_mvMatrix * vec4(a_position,1.0);"
 "   vec3 pos3 = (pos/pos.w).xyz;"
 "   vec3 newPos = vec3(pos3.x + a_offset.x,pos3.y+a_offset.y,pos3.z+a_offset.z);"
@@ -157,5 +162,281 @@ WhirlyKit::OpenGLES2Program *BuildBillboardEyeProgram()
         
     return shader;
 }
+
+static const char *vertexShaderInstanceTri =
+"uniform mat4  u_mvpMatrix;                   \n"
+"uniform mat4  u_mvMatrix;                    \n"
+"uniform mat4  u_pMatrix;                     \n"
+"uniform float u_fade;                        \n"
+"uniform vec4  u_tint;                        \n"
+"uniform vec3 u_eyeVec;                       \n"
+"\n"
+"attribute vec3 a_position;                   \n"
+"attribute vec2 a_texCoord0;                  \n"
+"attribute vec3 a_instCenter;                 \n"
+"attribute vec3 a_instAxis;                   \n"
+"attribute vec4 a_instSize;                   \n"
+"attribute vec2 a_instRotOrient;              \n"
+"attribute vec4 a_instColor;                  \n"
+"attribute vec4 a_instTexRegion;              \n"
+"\n"
+"varying vec2 v_texCoord;                     \n"
+"varying vec4 v_color;                        \n"
+"\n"
+"void main()                                  \n"
+"{                                            \n"
+"   v_texCoord = mix(a_instTexRegion.xy,a_instTexRegion.zw,a_texCoord0);\n"
+"   v_color = a_instColor * u_fade * u_tint;  \n"
+"   vec2 corner = a_position.xy * a_instSize.xy + a_instSize.zw;\n"
+"   float c = cos(a_instRotOrient.x);         \n"
+"   float s = sin(a_instRotOrient.x);         \n"
+"   corner = vec2(c*corner.x - s*corner.y, s*corner.x + c*corner.y);\n"
+"   if (a_instRotOrient.y > 0.5)              \n"
+"   {                                         \n"
+"      vec3 axisX = cross(u_eyeVec,a_instAxis);\n"
+"      vec3 newPos = a_instCenter + axisX * corner.x + a_instAxis * corner.y;\n"
+"      gl_Position = u_mvpMatrix * vec4(newPos,1.0);\n"
+"   } else {                                  \n"
+"      vec4 pos = u_mvMatrix * vec4(a_instCenter,1.0);\n"
+"      vec3 pos3 = (pos/pos.w).xyz;           \n"
+"      gl_Position = u_pMatrix * vec4(pos3.x + corner.x,pos3.y + corner.y,pos3.z,1.0);\n"
+"   }                                         \n"
+"}                                            \n"
+;
+
+WhirlyKit::OpenGLES2Program *BuildBillboardInstanceProgram()
+{
+    OpenGLES2Program *shader = new OpenGLES2Program(kBillboardInstanceShaderName,vertexShaderInstanceTri,fragmentShaderTri);
+    if (!shader->isValid())
+    {
+        delete shader;
+        shader = NULL;
+    }
+    
+    // Set some reasonable defaults
+    if (shader)
+    {
+        glUseProgram(shader->getProgram());
+        
+        shader->setUniform("u_eyeVec", Point3f(0,0,1));
+    }
+    
+    return shader;
+}
+
+BillboardInstance::BillboardInstance() :
+    center(0,0,0), axis(0,0,0), size(1,1), offset(0,0), rotation(0.0),
+    orient(BillboardOrientEye), color(255,255,255,255), texLL(0,0), texUR(1,1)
+{
+}
+
+BillboardInstanceDrawable::BillboardInstanceDrawable()
+    : BasicDrawable("Billboard Instance"), numInstances(0), instBuffer(0), boundProg(NULL)
+{
+    // The one quad every instance shares
+    setType(GL_TRIANGLES);
+    addPoint(Point3f(-0.5,-0.5,0.0));  addTexCoord(0,TexCoord(0,0));
+    addPoint(Point3f(0.5,-0.5,0.0));  addTexCoord(0,TexCoord(1,0));
+    addPoint(Point3f(0.5,0.5,0.0));  addTexCoord(0,TexCoord(1,1));
+    addPoint(Point3f(-0.5,0.5,0.0));  addTexCoord(0,TexCoord(0,1));
+    addTriangle(Triangle(0,1,2));
+    addTriangle(Triangle(0,2,3));
+}
+
+BillboardInstanceDrawable::~BillboardInstanceDrawable()
+{
+}
+
+// Position of each piece in a packed instance
+static const int InstCenterOffset = 0;
+static const int InstAxisOffset = 12;
+static const int InstSizeOffset = 24;
+static const int InstRotOrientOffset = 40;
+static const int InstColorOffset = 48;
+static const int InstTexRegionOffset = 52;
+
+static inline unsigned short PackTexValue(float val)
+{
+    return (unsigned short)(std::min(std::max(val,0.0f),1.0f) * 65535.0f + 0.5f);
+}
+
+void BillboardInstanceDrawable::PackInstances(const BillboardInstance *insts,int numInsts,unsigned char *basePtr)
+{
+    for (int ii=0;ii<numInsts;ii++,basePtr+=InstanceSize)
+    {
+        const BillboardInstance &inst = insts[ii];
+        float *fPtr = (float *)basePtr;
+        fPtr[0] = inst.center.x();  fPtr[1] = inst.center.y();  fPtr[2] = inst.center.z();
+        fPtr[3] = inst.axis.x();  fPtr[4] = inst.axis.y();  fPtr[5] = inst.axis.z();
+        fPtr[6] = inst.size.x();  fPtr[7] = inst.size.y();
+        fPtr[8] = inst.offset.x();  fPtr[9] = inst.offset.y();
+        fPtr[10] = inst.rotation;  fPtr[11] = (inst.orient == BillboardOrientGround ? 1.0 : 0.0);
+        memcpy(basePtr+InstColorOffset, &inst.color.r, 4);
+        unsigned short *texPtr = (unsigned short *)(basePtr+InstTexRegionOffset);
+        texPtr[0] = PackTexValue(inst.texLL.x());  texPtr[1] = PackTexValue(inst.texLL.y());
+        texPtr[2] = PackTexValue(inst.texUR.x());  texPtr[3] = PackTexValue(inst.texUR.y());
+    }
+}
+
+void BillboardInstanceDrawable::addInstances(const std::vector<BillboardInstance> &insts)
+{
+    if (insts.empty())
+        return;
+    if (instBuffer)
+    {
+        WHIRLYKIT_LOGW("BillboardInstanceDrawable: Can't add instances after setupGL.");
+        return;
+    }
+    
+    size_t start = instData.size();
+    instData.resize(start + insts.size()*InstanceSize);
+    PackInstances(&insts[0], (int)insts.size(), &instData[start]);
+    numInstances += (int)insts.size();
+}
+
+void BillboardInstanceDrawable::updateInstances(int start,const std::vector<BillboardInstance> &insts)
+{
+    if (start < 0 || start >= numInstances || insts.empty())
+        return;
+    int count = std::min((int)insts.size(),numInstances-start);
+    
+    // Not in OpenGL yet, so just repack
+    if (!instBuffer)
+    {
+        PackInstances(&insts[0], count, &instData[start*InstanceSize]);
+        return;
+    }
+    
+    // Send over just the instances that changed
+    std::vector<unsigned char> changed(count*InstanceSize);
+    PackInstances(&insts[0], count, &changed[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, instBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, start*InstanceSize, count*InstanceSize, &changed[0]);
+    CheckGLError("BillboardInstanceDrawable::updateInstances() glBufferSubData");
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BillboardInstanceDrawable::setupGL(WhirlyKitGLSetupInfo *setupInfo,OpenGLMemManager *memManager,GLuint sharedBuf,GLuint sharedBufOffset)
+{
+    BasicDrawable::setupGL(setupInfo,memManager,sharedBuf,sharedBufOffset);
+    
+    if (instBuffer || instData.empty())
+        return;
+    
+    instBuffer = memManager->getBufferID(0,GL_DYNAMIC_DRAW);
+    if (!memManager->isHeadless())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instBuffer);
+        glBufferData(GL_ARRAY_BUFFER, instData.size(), &instData[0], GL_DYNAMIC_DRAW);
+        CheckGLError("BillboardInstanceDrawable::setupGL() glBufferData");
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    
+    // Changes go straight to the buffer from here on
+    instData.clear();
+    instData.shrink_to_fit();
+}
+
+void BillboardInstanceDrawable::teardownGL(OpenGLMemManager *memManage)
+{
+    BasicDrawable::teardownGL(memManage);
+    
+    if (instBuffer)
+    {
+        memManage->removeBufferID(instBuffer);
+        instBuffer = 0;
+    }
+}
+
+void BillboardInstanceDrawable::bindInstanceAttributes(OpenGLES2Program *prog,bool enable)
+{
+    struct InstAttr {
+        const char *name;
+        GLint size;
+        GLenum type;
+        GLboolean norm;
+        int offset;
+    };
+    static const InstAttr instAttrs[] = {
+        {"a_instCenter",3,GL_FLOAT,GL_FALSE,InstCenterOffset},
+        {"a_instAxis",3,GL_FLOAT,GL_FALSE,InstAxisOffset},
+        {"a_instSize",4,GL_FLOAT,GL_FALSE,InstSizeOffset},
+        {"a_instRotOrient",2,GL_FLOAT,GL_FALSE,InstRotOrientOffset},
+        {"a_instColor",4,GL_UNSIGNED_BYTE,GL_TRUE,InstColorOffset},
+        {"a_instTexRegion",4,GL_UNSIGNED_SHORT,GL_TRUE,InstTexRegionOffset}
+    };
+    
+    if (enable)
+        glBindBuffer(GL_ARRAY_BUFFER, instBuffer);
+    for (const InstAttr &instAttr : instAttrs)
+    {
+        const OpenGLESAttribute *progAttr = prog->findAttribute(instAttr.name);
+        if (!progAttr)
+            continue;
+        if (enable)
+        {
+            glVertexAttribPointer(progAttr->index, instAttr.size, instAttr.type, instAttr.norm, InstanceSize, (const GLvoid *)(long)instAttr.offset);
+            CheckGLError("BillboardInstanceDrawable glVertexAttribPointer");
+            glVertexAttribDivisor(progAttr->index, 1);
+            glEnableVertexAttribArray(progAttr->index);
+            CheckGLError("BillboardInstanceDrawable glEnableVertexAttribArray");
+        } else {
+            glVertexAttribDivisor(progAttr->index, 0);
+            glDisableVertexAttribArray(progAttr->index);
+        }
+    }
+    if (enable)
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BillboardInstanceDrawable::setupAdditionalVAO(OpenGLES2Program *prog,GLuint vertArrayObj)
+{
+    if (!instBuffer)
+        return;
     
+    glBindVertexArray(vertArrayObj);
+    bindInstanceAttributes(prog, true);
+    glBindVertexArray(0);
+}
+
+void BillboardInstanceDrawable::bindAdditionalRenderObjects(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
+{
+    // The VAO already has the instance attributes
+    if (vertArrayObj || !instBuffer)
+        return;
+    
+    boundProg = frameInfo->program;
+    bindInstanceAttributes(boundProg, true);
+}
+
+void BillboardInstanceDrawable::postDrawCallback(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
+{
+    // Divisors stick around outside a VAO, so put them back
+    if (boundProg)
+    {
+        bindInstanceAttributes(boundProg, false);
+        boundProg = NULL;
+    }
+}
+
+void BillboardInstanceDrawable::drawTriangleElements(GLsizei numIndices,const GLvoid *indices)
+{
+    if (!instBuffer || numInstances == 0)
+        return;
+    
+    glDrawElementsInstanced(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, indices, numInstances);
+}
+
+BillboardInstanceChangeRequest::BillboardInstanceChangeRequest(SimpleIdentity drawId,int start,const std::vector<BillboardInstance> &insts)
+    : DrawableChangeRequest(drawId), start(start), insts(insts)
+{
+}
+
+void BillboardInstanceChangeRequest::execute2(Scene *scene,WhirlyKit::SceneRendererES *renderer,DrawableRef draw)
+{
+    BillboardInstanceDrawableRef billDraw = std::dynamic_pointer_cast<BillboardInstanceDrawable>(draw);
+    if (billDraw)
+        billDraw->updateInstances(start,insts);
+}
+
 }
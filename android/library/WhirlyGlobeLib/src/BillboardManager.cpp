@@ -20,6 +20,7 @@
 
 #include "BillboardManager.h"
 #include "WhirlyKitLog.h"
+#include "DefaultShaderPrograms.h"
 
 using namespace Eigen;
 
@@ -48,12 +49,16 @@ Billboard::Billboard() :
 {
 }
 
-BillboardSceneRep::BillboardSceneRep()
+BillboardSceneRep::BillboardSceneRep() :
+    instDrawID(EmptyIdentity),
+    numInstances(0)
 {
 }
 
 BillboardSceneRep::BillboardSceneRep(SimpleIdentity inId) :
-    Identifiable(inId)
+    Identifiable(inId),
+    instDrawID(EmptyIdentity),
+    numInstances(0)
 {
 }
 
@@ -188,9 +193,91 @@ BillboardManager::~BillboardManager()
 
 typedef std::map<SimpleIdentity,BillboardDrawableBuilder *> BuilderMap;
 
+// Convert a billboard polygon to an instance, if it's an axis aligned rectangle
+static bool BillboardPolyToInstance(const Point3d &center,const SingleBillboardPoly &poly,BillboardOrient orient,BillboardInstance &inst)
+{
+    if (poly.pts.size() != 4 || poly.texCoords.size() != 4 || !poly.vertexAttrs.empty())
+        return false;
+
+    Point2d ll = poly.pts[0], ur = poly.pts[0];
+    for (const Point2d &pt : poly.pts)
+    {
+        ll = ll.cwiseMin(pt);
+        ur = ur.cwiseMax(pt);
+    }
+
+    // Every corner has to sit on the box, and its texture coordinate on the matching corner of the region
+    int llIdx = -1, urIdx = -1;
+    for (unsigned int ii=0;ii<4;ii++)
+    {
+        const Point2d &pt = poly.pts[ii];
+        bool isLeft = pt.x() == ll.x(), isBottom = pt.y() == ll.y();
+        if ((!isLeft && pt.x() != ur.x()) || (!isBottom && pt.y() != ur.y()))
+            return false;
+        if (isLeft && isBottom)
+            llIdx = ii;
+        else if (!isLeft && !isBottom)
+            urIdx = ii;
+    }
+    if (llIdx < 0 || urIdx < 0)
+        return false;
+    const TexCoord &texLL = poly.texCoords[llIdx], &texUR = poly.texCoords[urIdx];
+    for (unsigned int ii=0;ii<4;ii++)
+    {
+        const Point2d &pt = poly.pts[ii];
+        const TexCoord &tc = poly.texCoords[ii];
+        if (tc.u() != (pt.x() == ll.x() ? texLL.u() : texUR.u()) ||
+            tc.v() != (pt.y() == ll.y() ? texLL.v() : texUR.v()))
+            return false;
+    }
+
+    inst.center = center;
+    inst.size = Point2f(ur.x()-ll.x(),ur.y()-ll.y());
+    inst.offset = Point2f((ll.x()+ur.x())/2.0,(ll.y()+ur.y())/2.0);
+    inst.orient = orient;
+    inst.color = poly.color;
+    inst.texLL = texLL;
+    inst.texUR = texUR;
+
+    return true;
+}
+
+bool BillboardManager::billboardsToInstances(const std::vector<Billboard*> &billboards,SimpleIdentity billShader,std::vector<BillboardInstance> &insts,SimpleIdentity &texId)
+{
+    // Only the default shaders, since a custom one is expecting the polygons
+    BillboardOrient orient;
+    if (billShader == scene->getProgramIDBySceneName(kToolkitDefaultBillboardGroundProgram))
+        orient = BillboardOrientGround;
+    else if (billShader == scene->getProgramIDBySceneName(kToolkitDefaultBillboardEyeProgram))
+        orient = BillboardOrientEye;
+    else
+        return false;
+
+    texId = EmptyIdentity;
+    bool first = true;
+    for (Billboard *billboard : billboards)
+        for (const SingleBillboardPoly &billPoly : billboard->polys)
+        {
+            if (first)
+                texId = billPoly.texId;
+            else if (billPoly.texId != texId)
+                return false;
+            first = false;
+
+            BillboardInstance inst;
+            if (!BillboardPolyToInstance(billboard->center,billPoly,orient,inst))
+                return false;
+            insts.push_back(inst);
+        }
+
+    return !insts.empty();
+}
+
 /// Add billboards for display
 SimpleIdentity BillboardManager::addBillboards(std::vector<Billboard*> billboards,BillboardInfo *billboardInfo,SimpleIdentity billShader,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(billboardInfo->memLabel);
     SelectionManager *selectManager = (SelectionManager *)scene->getManager(kWKSelectionManager);
 
 
@@ -198,6 +285,13 @@ SimpleIdentity BillboardManager::addBillboards(std::vector<Billboard*> billboard
     sceneRep->fade = billboardInfo->fade;
         
     CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+
+    // Billboards sharing a texture with the default shaders are drawn as instances of one quad
+    std::vector<BillboardInstance> insts;
+    SimpleIdentity instTexId = EmptyIdentity;
+    bool useInstances = billboardsToInstances(billboards,billShader,insts,instTexId);
+    if (useInstances)
+        addInstanceDrawable(sceneRep,insts,instTexId,billboardInfo,EmptyIdentity,changes);
         
     // One builder per texture
     BuilderMap drawBuilders;
@@ -205,21 +299,22 @@ SimpleIdentity BillboardManager::addBillboards(std::vector<Billboard*> billboard
     // Work through the billboards, constructing as we go
     for (Billboard *billboard : billboards)
     {
-        // Work through the individual polygons
-        for (const SingleBillboardPoly &billPoly : billboard->polys)
-        {
-            BuilderMap::iterator it = drawBuilders.find(billPoly.texId);
-            BillboardDrawableBuilder *drawBuilder = NULL;
-            // Need a new one
-            if (it == drawBuilders.end())
+        // Work through the individual polygons, unless they're already instances
+        if (!useInstances)
+            for (const SingleBillboardPoly &billPoly : billboard->polys)
             {
-                drawBuilder = new BillboardDrawableBuilder(scene,changes,sceneRep,billboardInfo,billShader,billPoly.texId);
-                drawBuilders[billPoly.texId] = drawBuilder;
-            } else
-                drawBuilder = it->second;
+                BuilderMap::iterator it = drawBuilders.find(billPoly.texId);
+                BillboardDrawableBuilder *drawBuilder = NULL;
+                // Need a new one
+                if (it == drawBuilders.end())
+                {
+                    drawBuilder = new BillboardDrawableBuilder(scene,changes,sceneRep,billboardInfo,billShader,billPoly.texId);
+                    drawBuilders[billPoly.texId] = drawBuilder;
+                } else
+                    drawBuilder = it->second;
             
-            drawBuilder->addBillboard(billboard->center, billPoly.pts, billPoly.texCoords, &billPoly.color, billPoly.vertexAttrs);
-        }
+                drawBuilder->addBillboard(billboard->center, billPoly.pts, billPoly.texCoords, &billPoly.color, billPoly.vertexAttrs);
+            }
             
         // While we're at it, let's add this to the selection layer
         if (selectManager && billboard->isSelectable)
@@ -252,10 +347,114 @@ SimpleIdentity BillboardManager::addBillboards(std::vector<Billboard*> billboard
     pthread_mutex_lock(&billLock);
     sceneReps.insert(sceneRep);
     pthread_mutex_unlock(&billLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
+        
+    return billID;
+}
+
+void BillboardManager::fillInAxes(std::vector<BillboardInstance> &insts)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    
+    for (BillboardInstance &inst : insts)
+    {
+        if (inst.orient != BillboardOrientGround || inst.axis != Point3d(0,0,0))
+            continue;
         
+        // Normal is straight up
+        Point3d localPt = coordAdapter->displayToLocal(inst.center);
+        inst.axis = coordAdapter->normalForLocal(localPt);
+    }
+}
+
+void BillboardManager::addInstanceDrawable(BillboardSceneRep *sceneRep,const std::vector<BillboardInstance> &insts,SimpleIdentity texId,BillboardInfo *billboardInfo,SimpleIdentity billShader,ChangeSet &changes)
+{
+    if (billShader == EmptyIdentity)
+        billShader = scene->getProgramIDBySceneName(kToolkitDefaultBillboardInstanceProgram);
+    
+    BillboardInstanceDrawable *drawable = new BillboardInstanceDrawable();
+    billboardInfo->setupBasicDrawable(drawable);
+    drawable->setProgram(billShader);
+    drawable->setTexId(0,texId);
+    drawable->setRequestZBuffer(billboardInfo->zBufferRead);
+    drawable->setWriteZBuffer(billboardInfo->zBufferWrite);
+    drawable->setDrawPriority(billboardInfo->drawPriority);
+    
+    // Only copy if we have to fill in axes
+    bool needAxes = false;
+    for (const BillboardInstance &inst : insts)
+        if (inst.orient == BillboardOrientGround && inst.axis == Point3d(0,0,0))
+        {
+            needAxes = true;
+            break;
+        }
+    if (needAxes)
+    {
+        std::vector<BillboardInstance> localInsts(insts);
+        fillInAxes(localInsts);
+        drawable->addInstances(localInsts);
+    } else
+        drawable->addInstances(insts);
+    
+    sceneRep->instDrawID = drawable->getId();
+    sceneRep->numInstances = drawable->getNumInstances();
+    sceneRep->drawIDs.insert(drawable->getId());
+    changes.push_back(new AddDrawableReq(drawable));
+}
+
+SimpleIdentity BillboardManager::addBillboardInstances(const std::vector<BillboardInstance> &insts,SimpleIdentity texId,BillboardInfo *billboardInfo,SimpleIdentity billShader,ChangeSet &changes)
+{
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(billboardInfo->memLabel);
+    if (insts.empty())
+        return EmptyIdentity;
+    
+    BillboardSceneRep *sceneRep = new BillboardSceneRep();
+    sceneRep->fade = billboardInfo->fade;
+    addInstanceDrawable(sceneRep,insts,texId,billboardInfo,billShader,changes);
+    
+    SimpleIdentity billID = sceneRep->getId();
+    
+    pthread_mutex_lock(&billLock);
+    sceneReps.insert(sceneRep);
+    pthread_mutex_unlock(&billLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
+    
     return billID;
 }
 
+bool BillboardManager::changeBillboardInstances(SimpleIdentity billID,int start,const std::vector<BillboardInstance> &insts,ChangeSet &changes)
+{
+    if (insts.empty())
+        return false;
+    
+    SimpleIdentity drawID = EmptyIdentity;
+    int numInstances = 0;
+    pthread_mutex_lock(&billLock);
+    BillboardSceneRep dummyRep(billID);
+    BillboardSceneRepSet::iterator it = sceneReps.find(&dummyRep);
+    if (it != sceneReps.end())
+    {
+        drawID = (*it)->instDrawID;
+        numInstances = (*it)->numInstances;
+    }
+    pthread_mutex_unlock(&billLock);
+    
+    if (drawID == EmptyIdentity || start < 0 || start+(int)insts.size() > numInstances)
+    {
+        WHIRLYKIT_LOGW("BillboardManager: Can't change instances outside of an instance batch.");
+        return false;
+    }
+    
+    std::vector<BillboardInstance> localInsts(insts);
+    fillInAxes(localInsts);
+    changes.push_back(new BillboardInstanceChangeRequest(drawID,start,localInsts));
+    
+    return true;
+}
+
 void BillboardManager::enableBillboards(SimpleIDSet &billIDs,bool enable,ChangeSet &changes)
 {
     SelectionManager *selectManager = (SelectionManager *)scene->getManager(kWKSelectionManager);
@@ -306,6 +505,7 @@ void BillboardManager::removeBillboards(SimpleIDSet &billIDs,ChangeSet &changes)
             }
             
             sceneRep->clearContents(selectManager,changes,removeTime);
+            untrackSceneRep(sceneRep->getId());
             sceneReps.erase(it);
             delete sceneRep;
         }
@@ -0,0 +1,271 @@
+/*
+ *  ClusterStats.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import "ClusterStats.h"
+#import "ThematicClassifier.h"
+
+namespace WhirlyKit
+{
+
+ClusterStatDef::ClusterStatDef()
+    : type(ClusterStatCountByCategory), keyBucket(0.0)
+{
+}
+
+ClusterStatDef::ClusterStatDef(ClusterStatType type,const std::string &attrName)
+    : type(type), attrName(attrName), keyBucket(0.0)
+{
+}
+
+ClusterStats::Accum::Accum()
+    : numValues(0), sum(0.0), minVal(0.0), maxVal(0.0), hasFirst(false), firstPriority(0.0)
+{
+}
+
+ClusterStats::ClusterStats()
+    : defs(NULL), count(0)
+{
+}
+
+ClusterStats::ClusterStats(const std::vector<ClusterStatDef> *defs)
+    : defs(defs), count(0)
+{
+    if (defs)
+        accums.resize(defs->size());
+}
+
+void ClusterStats::addMember(const Dictionary *attrs,double importance)
+{
+    count++;
+    if (!attrs)
+        return;
+
+    for (unsigned int ii=0;ii<accums.size();ii++)
+    {
+        const ClusterStatDef &def = (*defs)[ii];
+        Accum &accum = accums[ii];
+        if (!attrs->hasField(def.attrName))
+            continue;
+
+        switch (def.type)
+        {
+            case ClusterStatCountByCategory:
+                accum.numValues++;
+                accum.categories[attrs->getString(def.attrName)]++;
+                break;
+            case ClusterStatSum:
+            case ClusterStatMin:
+            case ClusterStatMax:
+            case ClusterStatMean:
+            {
+                double val = ThematicClassifier::ValueForAttribute(attrs,def.attrName);
+                if (isnan(val))
+                    break;
+                if (accum.numValues == 0)
+                    accum.minVal = accum.maxVal = val;
+                else {
+                    accum.minVal = std::min(accum.minVal,val);
+                    accum.maxVal = std::max(accum.maxVal,val);
+                }
+                accum.sum += val;
+                accum.numValues++;
+            }
+                break;
+            case ClusterStatFirstByPriority:
+            {
+                double priority = importance;
+                if (!def.priorityAttr.empty())
+                {
+                    priority = ThematicClassifier::ValueForAttribute(attrs,def.priorityAttr);
+                    if (isnan(priority))
+                        priority = -MAXFLOAT;
+                }
+                // Ties keep the one we saw first
+                if (!accum.hasFirst || priority > accum.firstPriority)
+                {
+                    accum.hasFirst = true;
+                    accum.firstPriority = priority;
+                    accum.firstVal = attrs->getString(def.attrName);
+                }
+                accum.numValues++;
+            }
+                break;
+        }
+    }
+}
+
+void ClusterStats::merge(const ClusterStats &other)
+{
+    count += other.count;
+    if (other.accums.size() != accums.size())
+        return;
+
+    for (unsigned int ii=0;ii<accums.size();ii++)
+    {
+        Accum &accum = accums[ii];
+        const Accum &otherAccum = other.accums[ii];
+        if (otherAccum.numValues == 0)
+            continue;
+
+        for (auto it : otherAccum.categories)
+            accum.categories[it.first] += it.second;
+        if (accum.numValues == 0)
+        {
+            accum.minVal = otherAccum.minVal;
+            accum.maxVal = otherAccum.maxVal;
+        } else {
+            accum.minVal = std::min(accum.minVal,otherAccum.minVal);
+            accum.maxVal = std::max(accum.maxVal,otherAccum.maxVal);
+        }
+        accum.sum += otherAccum.sum;
+        if (otherAccum.hasFirst && (!accum.hasFirst || otherAccum.firstPriority > accum.firstPriority))
+        {
+            accum.hasFirst = true;
+            accum.firstPriority = otherAccum.firstPriority;
+            accum.firstVal = otherAccum.firstVal;
+        }
+        accum.numValues += otherAccum.numValues;
+    }
+}
+
+int ClusterStats::findStat(const std::string &name) const
+{
+    for (int ii=0;ii<numStats();ii++)
+        if (getDef(ii).getName() == name)
+            return ii;
+
+    return -1;
+}
+
+double ClusterStats::getValue(int which) const
+{
+    if (which < 0 || which >= accums.size())
+        return NAN;
+    const Accum &accum = accums[which];
+    if (accum.numValues == 0)
+        return NAN;
+
+    switch ((*defs)[which].type)
+    {
+        case ClusterStatSum:
+            return accum.sum;
+        case ClusterStatMin:
+            return accum.minVal;
+        case ClusterStatMax:
+            return accum.maxVal;
+        case ClusterStatMean:
+            return accum.sum / accum.numValues;
+        default:
+            return NAN;
+    }
+}
+
+int ClusterStats::getNumValues(int which) const
+{
+    if (which < 0 || which >= accums.size())
+        return 0;
+    return accums[which].numValues;
+}
+
+const std::string &ClusterStats::getFirstValue(int which) const
+{
+    static const std::string empty;
+    if (which < 0 || which >= accums.size())
+        return empty;
+    return accums[which].firstVal;
+}
+
+const std::map<std::string,int> &ClusterStats::getCategoryCounts(int which) const
+{
+    static const std::map<std::string,int> empty;
+    if (which < 0 || which >= accums.size())
+        return empty;
+    return accums[which].categories;
+}
+
+std::string ClusterStats::getDominantCategory(int which) const
+{
+    std::string best;
+    int bestCount = 0;
+    for (auto it : getCategoryCounts(which))
+        if (it.second > bestCount)
+        {
+            best = it.first;
+            bestCount = it.second;
+        }
+
+    return best;
+}
+
+// Escape the characters the key uses as separators, so names can't run together
+static void AppendKeyString(std::string &key,const std::string &str)
+{
+    for (char c : str)
+    {
+        if (c == '\\' || c == ':' || c == ',' || c == '|')
+            key += '\\';
+        key += c;
+    }
+}
+
+std::string ClusterStats::getKey() const
+{
+    std::string key = std::to_string(count);
+
+    for (unsigned int ii=0;ii<accums.size();ii++)
+    {
+        const ClusterStatDef &def = (*defs)[ii];
+        const Accum &accum = accums[ii];
+        key += "|";
+        switch (def.type)
+        {
+            case ClusterStatCountByCategory:
+                for (auto it : accum.categories)
+                {
+                    AppendKeyString(key,it.first);
+                    key += ":" + std::to_string(it.second) + ",";
+                }
+                break;
+            case ClusterStatSum:
+            case ClusterStatMin:
+            case ClusterStatMax:
+            case ClusterStatMean:
+            {
+                double val = getValue(ii);
+                if (isnan(val))
+                    break;
+                if (def.keyBucket > 0.0)
+                    val = floor(val / def.keyBucket + 0.5) * def.keyBucket;
+                char valStr[32];
+                snprintf(valStr,sizeof(valStr),"%.9g",val);
+                key += valStr;
+            }
+                break;
+            case ClusterStatFirstByPriority:
+                AppendKeyString(key,accum.firstVal);
+                break;
+        }
+    }
+
+    return key;
+}
+
+}
@@ -0,0 +1,746 @@
+/*
+ *  CoordinateGrid.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import <cfloat>
+#import "CoordinateGrid.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+// Meters in a degree of latitude, near enough for picking a spacing
+static const double MetersPerDegree = 111319.5;
+
+// Samples along each projected line before clipping
+static const int NumLineSamples = 32;
+
+// Most lines we'll trace along one axis, in case the spacing doesn't suit the area
+static const int MaxLinesPerAxis = 1000;
+
+GridLine::GridLine()
+    : type(GridLineMinor), isX(true), value(0.0)
+{
+}
+
+GridLabel::GridLabel()
+    : loc(0,0), placement(GridLabelCenter)
+{
+}
+
+CoordinateGrid::CoordinateGrid()
+    : targetSpacing(100.0), level(-1), built(false)
+{
+}
+
+CoordinateGrid::~CoordinateGrid()
+{
+}
+
+bool CoordinateGrid::update(const GeoMbr &viewMbr,double pixelSize)
+{
+    std::vector<Mbr> viewAreas;
+    viewMbr.splitIntoMbrs(viewAreas);
+    int newLevel = levelForDistance(pixelSize * targetSpacing);
+
+    // Still inside what we built last time?
+    bool covered = built && newLevel == level;
+    for (unsigned int ii=0;ii<viewAreas.size() && covered;ii++)
+    {
+        bool inside = false;
+        for (const Mbr &area : builtAreas)
+            if (viewAreas[ii].contained(area))
+            {
+                inside = true;
+                break;
+            }
+        covered = inside;
+    }
+
+    if (!covered)
+    {
+        // Build for twice the view so small moves don't cost anything
+        builtAreas.clear();
+        lines.clear();
+        cellLabels.clear();
+        for (const Mbr &view : viewAreas)
+        {
+            Point2f span = view.ur() - view.ll();
+            Point2f ll = view.ll() - span/2.0, ur = view.ur() + span/2.0;
+            ll.x() = std::max(ll.x(),(float)-M_PI);  ll.y() = std::max(ll.y(),(float)-M_PI_2);
+            ur.x() = std::min(ur.x(),(float)M_PI);  ur.y() = std::min(ur.y(),(float)M_PI_2);
+            Mbr area(ll,ur);
+            builtAreas.push_back(area);
+            buildLines(area,newLevel,lines);
+            buildCellLabels(area,newLevel,cellLabels);
+        }
+        level = newLevel;
+        built = true;
+    }
+
+    labels = cellLabels;
+    for (const Mbr &view : viewAreas)
+        buildEdgeLabels(view);
+
+    return !covered;
+}
+
+void CoordinateGrid::buildEdgeLabels(const Mbr &view)
+{
+    // Keep the labels just inside the view
+    Point2f span = view.ur() - view.ll();
+    double edgeX = view.ll().x() + span.x() * 0.02;
+    double edgeY = view.ll().y() + span.y() * 0.02;
+
+    for (const GridLine &line : lines)
+    {
+        if (line.label.empty())
+            continue;
+
+        // Lines of constant X are labeled along the bottom, the rest along the left
+        double edge = line.isX ? edgeY : edgeX;
+        for (unsigned int ii=1;ii<line.pts.size();ii++)
+        {
+            const Point2f &pa = line.pts[ii-1], &pb = line.pts[ii];
+            double a = line.isX ? pa.y() : pa.x();
+            double b = line.isX ? pb.y() : pb.x();
+            if (a == b || (a - edge) * (b - edge) > 0.0)
+                continue;
+            double t = (edge - a) / (b - a);
+            GridLabel label;
+            if (line.isX)
+            {
+                double x = pa.x() + t * (pb.x() - pa.x());
+                if (x < view.ll().x() || x > view.ur().x())
+                    continue;
+                label.loc = GeoCoord(x,edge);
+                label.placement = GridLabelBottom;
+            } else {
+                double y = pa.y() + t * (pb.y() - pa.y());
+                if (y < view.ll().y() || y > view.ur().y())
+                    continue;
+                label.loc = GeoCoord(edge,y);
+                label.placement = GridLabelLeft;
+            }
+            label.text = line.label;
+            labels.push_back(label);
+            break;
+        }
+    }
+}
+
+void CoordinateGrid::makeShapes(ShapeSet &shapes) const
+{
+    for (const GridLine &line : lines)
+    {
+        if (line.pts.size() < 2)
+            continue;
+
+        VectorLinearRef lin = VectorLinear::createLinear();
+        lin->pts = line.pts;
+        lin->initGeoMbr();
+        Dictionary *attrs = lin->getAttrDict();
+        switch (line.type)
+        {
+            case GridLineMajor:
+                attrs->setString("gridline","major");
+                break;
+            case GridLineMinor:
+                attrs->setString("gridline","minor");
+                break;
+            case GridLineZone:
+                attrs->setString("gridline","zone");
+                break;
+        }
+        attrs->setDouble("value",line.value);
+        shapes.insert(lin);
+    }
+}
+
+std::string CoordinateGrid::FormatDegrees(double deg,bool isLon,double step)
+{
+    long totalSec = std::lround(std::abs(deg) * 3600.0);
+    long degs = totalSec / 3600, mins = (totalSec / 60) % 60, secs = totalSec % 60;
+
+    char str[64];
+    if (step >= 1.0)
+        snprintf(str,sizeof(str),"%ld\xC2\xB0",degs);
+    else if (step >= 1.0/60.0)
+        snprintf(str,sizeof(str),"%ld\xC2\xB0%02ld'",degs,mins);
+    else
+        snprintf(str,sizeof(str),"%ld\xC2\xB0%02ld'%02ld\"",degs,mins,secs);
+
+    std::string ret = str;
+    if (totalSec != 0 && !(isLon && totalSec == 180*3600))
+    {
+        if (isLon)
+            ret += deg > 0.0 ? "E" : "W";
+        else
+            ret += deg > 0.0 ? "N" : "S";
+    }
+
+    return ret;
+}
+
+void CoordinateGrid::AddGeoLine(bool isX,double coord,double value,double from,double to,GridLineType type,const std::string &label,std::vector<GridLine> &lines)
+{
+    if (to <= from)
+        return;
+
+    // Long lines are broken up so they follow the globe
+    static const double MaxSegment = M_PI/180.0;
+    int numSegs = std::min(std::max((int)ceil((to - from) / MaxSegment),1),360);
+
+    GridLine line;
+    line.type = type;
+    line.isX = isX;
+    line.value = value;
+    line.label = label;
+    line.pts.reserve(numSegs+1);
+    for (int ii=0;ii<=numSegs;ii++)
+    {
+        double along = from + (to - from) * ii / numSegs;
+        line.pts.push_back(isX ? Point2f(coord,along) : Point2f(along,coord));
+    }
+    lines.push_back(line);
+}
+
+// A sample along a projected line, in geographic
+typedef struct
+{
+    Point2d geo;
+    bool valid;
+    bool inside;
+} LineSample;
+
+static LineSample SampleLine(CoordSystem *coordSys,const Mbr &clip,bool isX,double value,double along)
+{
+    LineSample sample;
+    sample.geo = coordSys->localToGeographicD(isX ? Point3d(value,along,0.0) : Point3d(along,value,0.0));
+    // proj.4 hands back HUGE_VAL for points it can't do
+    sample.valid = std::isfinite(sample.geo.x()) && std::isfinite(sample.geo.y()) &&
+                   std::abs(sample.geo.x()) <= 2*M_PI && std::abs(sample.geo.y()) <= M_PI;
+    sample.inside = sample.valid && clip.insideOrOnEdge(Point2f(sample.geo.x(),sample.geo.y()));
+    return sample;
+}
+
+// Narrow down where a line crosses the clip boundary, between a point inside and one outside
+static Point2d FindCrossing(CoordSystem *coordSys,const Mbr &clip,bool isX,double value,double alongIn,double alongOut)
+{
+    LineSample best = SampleLine(coordSys,clip,isX,value,alongIn);
+    for (int ii=0;ii<24;ii++)
+    {
+        double mid = (alongIn + alongOut) / 2.0;
+        LineSample sample = SampleLine(coordSys,clip,isX,value,mid);
+        if (sample.inside)
+        {
+            alongIn = mid;
+            best = sample;
+        } else
+            alongOut = mid;
+    }
+
+    return best.geo;
+}
+
+// Projected bounds of a geographic area, by sampling over it
+static bool ProjectedBounds(CoordSystem *coordSys,const Mbr &clip,Point2d &ll,Point2d &ur)
+{
+    static const int NumSamples = 8;
+
+    ll = Point2d(DBL_MAX,DBL_MAX);
+    ur = Point2d(-DBL_MAX,-DBL_MAX);
+    bool found = false;
+    for (int ix=0;ix<=NumSamples;ix++)
+        for (int iy=0;iy<=NumSamples;iy++)
+        {
+            Point2d geo(clip.ll().x() + (clip.ur().x()-clip.ll().x()) * ix / NumSamples,
+                        clip.ll().y() + (clip.ur().y()-clip.ll().y()) * iy / NumSamples);
+            Point3d loc = coordSys->geographicToLocal(geo);
+            if (!std::isfinite(loc.x()) || !std::isfinite(loc.y()) || std::abs(loc.x()) > 1e20 || std::abs(loc.y()) > 1e20)
+                continue;
+            ll = ll.cwiseMin(Point2d(loc.x(),loc.y()));
+            ur = ur.cwiseMax(Point2d(loc.x(),loc.y()));
+            found = true;
+        }
+
+    return found;
+}
+
+void CoordinateGrid::AddProjectedLines(CoordSystem *coordSys,const Mbr &clip,double step,double majorStep,
+                                       const std::function<std::string(bool isX,double value)> &labelFunc,
+                                       std::vector<GridLine> &lines)
+{
+    if (!coordSys || step <= 0.0 || !clip.valid())
+        return;
+    Point2d ll,ur;
+    if (!ProjectedBounds(coordSys,clip,ll,ur))
+        return;
+
+    // The edges of the area bow out in projection, so look a step further
+    ll -= Point2d(step,step);
+    ur += Point2d(step,step);
+
+    for (int axis=0;axis<2;axis++)
+    {
+        bool isX = axis == 0;
+        double minVal = isX ? ll.x() : ll.y(), maxVal = isX ? ur.x() : ur.y();
+        double minAlong = isX ? ll.y() : ll.x(), maxAlong = isX ? ur.y() : ur.x();
+        double startIdx = ceil(minVal / step), endIdx = floor(maxVal / step);
+        if (endIdx - startIdx > MaxLinesPerAxis)
+        {
+            WHIRLYKIT_LOGW("CoordinateGrid: Too many lines for spacing %f.  Skipping.",step);
+            continue;
+        }
+
+        for (double idx = startIdx;idx <= endIdx;idx += 1.0)
+        {
+            double value = idx * step;
+            double rem = std::abs(fmod(value,majorStep));
+            bool isMajor = rem < step*1e-3 || majorStep - rem < step*1e-3;
+            std::string label = labelFunc ? labelFunc(isX,value) : std::string();
+
+            GridLine line;
+            line.type = isMajor ? GridLineMajor : GridLineMinor;
+            line.isX = isX;
+            line.value = value;
+            line.label = label;
+
+            // Walk along the line, keeping the runs inside the clip area
+            double prevAlong = minAlong;
+            LineSample prev;
+            prev.valid = prev.inside = false;
+            for (int ii=0;ii<=NumLineSamples;ii++)
+            {
+                double along = minAlong + (maxAlong - minAlong) * ii / NumLineSamples;
+                LineSample sample = SampleLine(coordSys,clip,isX,value,along);
+                if (sample.inside)
+                {
+                    // Break where we wrap around the date line
+                    if (!line.pts.empty() && std::abs(sample.geo.x() - line.pts.back().x()) > M_PI)
+                    {
+                        if (line.pts.size() > 1)
+                            lines.push_back(line);
+                        line.pts.clear();
+                    }
+                    if (line.pts.empty() && ii > 0 && !prev.inside)
+                    {
+                        Point2d edgePt = FindCrossing(coordSys,clip,isX,value,along,prevAlong);
+                        line.pts.push_back(Point2f(edgePt.x(),edgePt.y()));
+                    }
+                    line.pts.push_back(Point2f(sample.geo.x(),sample.geo.y()));
+                } else if (!line.pts.empty())
+                {
+                    Point2d edgePt = FindCrossing(coordSys,clip,isX,value,prevAlong,along);
+                    line.pts.push_back(Point2f(edgePt.x(),edgePt.y()));
+                    if (line.pts.size() > 1)
+                        lines.push_back(line);
+                    line.pts.clear();
+                }
+                prev = sample;
+                prevAlong = along;
+            }
+            if (line.pts.size() > 1)
+                lines.push_back(line);
+        }
+    }
+}
+
+// Graticule spacing in arc seconds, with the spacing of the major lines to go with it
+static const int GraticuleSteps[][2] = {
+    {30*3600,90*3600}, {10*3600,30*3600}, {5*3600,10*3600}, {2*3600,10*3600}, {3600,5*3600},
+    {1800,3600}, {900,3600}, {600,3600}, {300,1800}, {120,600}, {60,300},
+    {30,60}, {15,60}, {10,60}, {5,30}, {2,10}, {1,5}
+};
+static const int NumGraticuleSteps = sizeof(GraticuleSteps)/sizeof(GraticuleSteps[0]);
+
+// Finest graticule step that's at least the given number of degrees
+static int GraticuleLevelFor(double deg)
+{
+    int which = 0;
+    for (int ii=0;ii<NumGraticuleSteps;ii++)
+        if (GraticuleSteps[ii][0] / 3600.0 >= deg)
+            which = ii;
+    return which;
+}
+
+GraticuleGrid::GraticuleGrid()
+    : maxLatitude(M_PI_2)
+{
+}
+
+int GraticuleGrid::levelForDistance(double meters)
+{
+    return GraticuleLevelFor(meters / MetersPerDegree);
+}
+
+void GraticuleGrid::buildLines(const Mbr &area,int level,std::vector<GridLine> &lines)
+{
+    double minLat = std::max((double)area.ll().y(),-maxLatitude), maxLat = std::min((double)area.ur().y(),maxLatitude);
+    if (maxLat <= minLat)
+        return;
+
+    // Meridians bunch up away from the equator, so they may want a coarser spacing
+    double midLat = (minLat + maxLat) / 2.0;
+    double cosLat = std::max(cos(midLat),0.01);
+    int lonLevel = GraticuleLevelFor(GraticuleSteps[level][0] / 3600.0 / cosLat);
+
+    // Work in arc seconds so the lines land on exact values
+    static const double SecToRad = M_PI / (180.0 * 3600.0);
+    for (int axis=0;axis<2;axis++)
+    {
+        bool isX = axis == 0;
+        int whichLevel = isX ? lonLevel : level;
+        long step = GraticuleSteps[whichLevel][0], majorStep = GraticuleSteps[whichLevel][1];
+        double minVal = (isX ? area.ll().x() : minLat) / SecToRad, maxVal = (isX ? area.ur().x() : maxLat) / SecToRad;
+        long startIdx = (long)ceil(minVal / step), endIdx = (long)floor(maxVal / step);
+        for (long idx = startIdx;idx <= endIdx;idx++)
+        {
+            long sec = idx * step;
+            // The poles are points and 180 shows up at both ends
+            if (!isX && std::abs(sec) >= 90*3600)
+                continue;
+            if (isX && sec == 180*3600 && area.ll().x() <= -M_PI)
+                continue;
+            GridLineType type = (sec % majorStep == 0) ? GridLineMajor : GridLineMinor;
+            double deg = sec / 3600.0;
+            std::string label = FormatDegrees(deg,isX,step / 3600.0);
+            if (isX)
+                AddGeoLine(true,sec * SecToRad,deg,minLat,maxLat,type,label,lines);
+            else
+                AddGeoLine(false,sec * SecToRad,deg,area.ll().x(),area.ur().x(),type,label,lines);
+        }
+    }
+}
+
+ProjectedGrid::ProjectedGrid(Proj4CoordSystem *coordSys,const Mbr &validArea,double metersPerUnit)
+    : coordSys(coordSys), validArea(validArea), metersPerUnit(metersPerUnit)
+{
+    // 1, 2, 5 and so on, coarsest first
+    for (int exp=7;exp>=-3;exp--)
+    {
+        double scale = pow(10.0,exp);
+        steps.push_back(5*scale);
+        steps.push_back(2*scale);
+        steps.push_back(scale);
+    }
+}
+
+int ProjectedGrid::levelForDistance(double meters)
+{
+    double units = meters / metersPerUnit;
+    int which = 0;
+    for (unsigned int ii=0;ii<steps.size();ii++)
+        if (steps[ii] >= units)
+            which = ii;
+    return which;
+}
+
+void ProjectedGrid::buildLines(const Mbr &area,int level,std::vector<GridLine> &lines)
+{
+    Mbr clip = area.intersect(validArea);
+    if (!clip.valid() || !coordSys)
+        return;
+
+    double step = steps[level];
+    double majorStep = level >= 2 ? steps[level-2] : step * 10;
+    AddProjectedLines(coordSys,clip,step,majorStep,
+                      [step](bool isX,double value)
+                      {
+                          char str[64];
+                          int decimals = step >= 1.0 ? 0 : (int)ceil(-log10(step) - 1e-6);
+                          snprintf(str,sizeof(str),"%.*f",decimals,value);
+                          return std::string(str);
+                      },
+                      lines);
+}
+
+// UTM line spacing in meters.  The first level is just the zones.
+static const double UTMSteps[] = {0.0, 100000.0, 10000.0, 1000.0, 100.0};
+static const int NumUTMSteps = sizeof(UTMSteps)/sizeof(UTMSteps[0]);
+
+// Latitude bands from 80S to 84N, skipping I and O
+static const char *UTMBandLetters = "CDEFGHJKLMNPQRSTUVWX";
+
+UTMGrid::UTMGrid()
+{
+}
+
+UTMGrid::~UTMGrid()
+{
+    for (auto it : zoneSystems)
+        delete it.second;
+    zoneSystems.clear();
+}
+
+char UTMGrid::BandLetter(double lat)
+{
+    if (lat < -80.0 || lat > 84.0)
+        return 0;
+    int which = std::min((int)floor((lat + 80.0) / 8.0),19);
+
+    return UTMBandLetters[which];
+}
+
+const std::vector<UTMGrid::ZoneCell> &UTMGrid::ZoneCells()
+{
+    static std::vector<ZoneCell> cells;
+    static bool init = false;
+    static pthread_mutex_t cellLock = PTHREAD_MUTEX_INITIALIZER;
+
+    pthread_mutex_lock(&cellLock);
+    if (!init)
+    {
+        for (int band=0;band<20;band++)
+        {
+            char letter = UTMBandLetters[band];
+            double minLat = -80.0 + band*8.0;
+            double maxLat = letter == 'X' ? 84.0 : minLat + 8.0;
+            for (int zone=1;zone<=60;zone++)
+            {
+                double minLon = -180.0 + (zone-1)*6.0, maxLon = minLon + 6.0;
+                // Southwest Norway
+                if (letter == 'V')
+                {
+                    if (zone == 31)
+                        maxLon = 3.0;
+                    else if (zone == 32)
+                        minLon = 3.0;
+                }
+                // Svalbard
+                if (letter == 'X')
+                {
+                    if (zone == 32 || zone == 34 || zone == 36)
+                        continue;
+                    switch (zone)
+                    {
+                        case 31:  maxLon = 9.0;  break;
+                        case 33:  minLon = 9.0;  maxLon = 21.0;  break;
+                        case 35:  minLon = 21.0;  maxLon = 33.0;  break;
+                        case 37:  minLon = 33.0;  break;
+                    }
+                }
+                ZoneCell cell;
+                cell.zone = zone;  cell.band = letter;
+                cell.minLon = minLon;  cell.maxLon = maxLon;
+                cell.minLat = minLat;  cell.maxLat = maxLat;
+                cells.push_back(cell);
+            }
+        }
+
+        // The polar caps are UPS, split at the prime meridian
+        ZoneCell polar[4] = {
+            {0,'A',-180.0,0.0,-90.0,-80.0}, {0,'B',0.0,180.0,-90.0,-80.0},
+            {0,'Y',-180.0,0.0,84.0,90.0}, {0,'Z',0.0,180.0,84.0,90.0}
+        };
+        cells.insert(cells.end(),polar,polar+4);
+        init = true;
+    }
+    pthread_mutex_unlock(&cellLock);
+
+    return cells;
+}
+
+Proj4CoordSystem *UTMGrid::zoneSystem(int zone,bool south)
+{
+    int key = zone*2 + (south ? 1 : 0);
+    auto it = zoneSystems.find(key);
+    if (it != zoneSystems.end())
+        return it->second;
+
+    char str[256];
+    if (zone > 0)
+        snprintf(str,sizeof(str),"+proj=utm +zone=%d +datum=WGS84 +units=m +no_defs%s",zone,south ? " +south" : "");
+    else
+        snprintf(str,sizeof(str),"+proj=ups +datum=WGS84 +units=m +no_defs%s",south ? " +south" : "");
+    Proj4CoordSystem *coordSys = new Proj4CoordSystem(str);
+    if (!coordSys->isValid())
+    {
+        WHIRLYKIT_LOGE("UTMGrid: Failed to set up coordinate system: %s",str);
+        delete coordSys;
+        coordSys = NULL;
+    }
+    zoneSystems[key] = coordSys;
+
+    return coordSys;
+}
+
+int UTMGrid::levelForDistance(double meters)
+{
+    int which = 0;
+    for (int ii=1;ii<NumUTMSteps;ii++)
+        if (UTMSteps[ii] >= meters)
+            which = ii;
+    return which;
+}
+
+std::string UTMGrid::lineLabel(bool isX,double value,double step)
+{
+    char str[64];
+    if (step >= 1000.0)
+        snprintf(str,sizeof(str),"%ldkm%s",std::lround(value / 1000.0),isX ? "E" : "N");
+    else
+        snprintf(str,sizeof(str),"%ldm%s",std::lround(value),isX ? "E" : "N");
+    return str;
+}
+
+// Area of a zone cell, in radians, clipped to the given area
+static Mbr ClipZoneCell(const UTMGrid::ZoneCell &cell,const Mbr &area)
+{
+    static const double DegToRad = M_PI / 180.0;
+    Mbr cellMbr(Point2f(cell.minLon * DegToRad,cell.minLat * DegToRad),Point2f(cell.maxLon * DegToRad,cell.maxLat * DegToRad));
+    return cellMbr.intersect(area);
+}
+
+void UTMGrid::buildLines(const Mbr &area,int level,std::vector<GridLine> &lines)
+{
+    static const double DegToRad = M_PI / 180.0;
+    bool bands = drawBands();
+
+    for (const ZoneCell &cell : ZoneCells())
+    {
+        Mbr clip = ClipZoneCell(cell,area);
+        if (!clip.valid() || clip.ur().x() <= clip.ll().x() || clip.ur().y() <= clip.ll().y())
+            continue;
+
+        // Zone boundaries run up the west side of each cell.  The poles only have the band split.
+        double west = cell.minLon * DegToRad, south = cell.minLat * DegToRad;
+        if ((cell.zone > 0 || bands) && west >= area.ll().x() && west <= area.ur().x() && cell.minLon > -180.0)
+            AddGeoLine(true,west,cell.minLon,clip.ll().y(),clip.ur().y(),GridLineZone,"",lines);
+        // Band boundaries for MGRS, otherwise just the edges of UTM
+        if ((bands || cell.minLat == -80.0 || cell.minLat == 84.0) && south >= area.ll().y() && south <= area.ur().y())
+            AddGeoLine(false,south,cell.minLat,clip.ll().x(),clip.ur().x(),GridLineZone,"",lines);
+
+        if (level <= 0 || level >= NumUTMSteps)
+            continue;
+        Proj4CoordSystem *coordSys = zoneSystem(cell.zone,cell.minLat < 0.0);
+        if (!coordSys)
+            continue;
+        double step = UTMSteps[level];
+        double majorStep = level > 1 ? UTMSteps[level-1] : 500000.0;
+        AddProjectedLines(coordSys,clip,step,majorStep,
+                          [this,step](bool isX,double value) { return lineLabel(isX,value,step); },
+                          lines);
+    }
+}
+
+MGRSGrid::MGRSGrid()
+{
+}
+
+std::string MGRSGrid::SquareID(int zone,double easting,double northing)
+{
+    // Columns cycle through three sets of letters, rows through A-V with an offset for even zones
+    static const char *colSets[3] = {"ABCDEFGH","JKLMNPQR","STUVWXYZ"};
+    static const char *rowLetters = "ABCDEFGHJKLMNPQRSTUV";
+
+    if (zone < 1 || zone > 60)
+        return "";
+    int col = (int)floor(easting / 100000.0);
+    if (col < 1 || col > 8)
+        return "";
+    int row = (int)floor(northing / 100000.0) % 20;
+    if (row < 0)
+        row += 20;
+    if (zone % 2 == 0)
+        row = (row + 5) % 20;
+
+    std::string ret;
+    ret += colSets[(zone-1)%3][col-1];
+    ret += rowLetters[row];
+    return ret;
+}
+
+std::string MGRSGrid::lineLabel(bool isX,double value,double step)
+{
+    // Digits within the 100km square.  The squares themselves get cell labels.
+    if (step >= 100000.0)
+        return "";
+    long inSquare = std::lround(fmod(value,100000.0));
+    if (inSquare < 0)
+        inSquare += 100000;
+
+    char str[32];
+    if (step >= 10000.0)
+        snprintf(str,sizeof(str),"%ld",inSquare / 10000);
+    else if (step >= 1000.0)
+        snprintf(str,sizeof(str),"%02ld",inSquare / 1000);
+    else
+        snprintf(str,sizeof(str),"%03ld",inSquare / 100);
+    return str;
+}
+
+void MGRSGrid::buildCellLabels(const Mbr &area,int level,std::vector<GridLabel> &labels)
+{
+    static const int MaxSquares = 1000;
+
+    for (const ZoneCell &cell : ZoneCells())
+    {
+        Mbr clip = ClipZoneCell(cell,area);
+        if (!clip.valid() || clip.ur().x() <= clip.ll().x() || clip.ur().y() <= clip.ll().y())
+            continue;
+
+        char gzd[16];
+        if (cell.zone > 0)
+            snprintf(gzd,sizeof(gzd),"%d%c",cell.zone,cell.band);
+        else
+            snprintf(gzd,sizeof(gzd),"%c",cell.band);
+
+        // Grid zone designators when zoomed out, or for the polar caps
+        if (level <= 0 || cell.zone == 0)
+        {
+            GridLabel label;
+            Point2f mid = clip.mid();
+            label.loc = GeoCoord(mid.x(),mid.y());
+            label.text = gzd;
+            label.placement = GridLabelCenter;
+            labels.push_back(label);
+            continue;
+        }
+
+        // 100km squares, labeled in the middle of each one
+        Proj4CoordSystem *coordSys = zoneSystem(cell.zone,cell.minLat < 0.0);
+        Point2d ll,ur;
+        if (!coordSys || !ProjectedBounds(coordSys,clip,ll,ur))
+            continue;
+        long startE = (long)floor(ll.x() / 100000.0), endE = (long)floor(ur.x() / 100000.0);
+        long startN = (long)floor(ll.y() / 100000.0), endN = (long)floor(ur.y() / 100000.0);
+        if ((endE - startE + 1) * (endN - startN + 1) > MaxSquares)
+            continue;
+        for (long ie = startE;ie <= endE;ie++)
+            for (long in = startN;in <= endN;in++)
+            {
+                double easting = ie * 100000.0 + 50000.0, northing = in * 100000.0 + 50000.0;
+                Point2d geo = coordSys->localToGeographicD(Point3d(easting,northing,0.0));
+                if (!std::isfinite(geo.x()) || !std::isfinite(geo.y()) || !clip.insideOrOnEdge(Point2f(geo.x(),geo.y())))
+                    continue;
+                std::string squareID = SquareID(cell.zone,easting,northing);
+                if (squareID.empty())
+                    continue;
+                GridLabel label;
+                label.loc = GeoCoord(geo.x(),geo.y());
+                label.text = std::string(gzd) + " " + squareID;
+                label.placement = GridLabelCenter;
+                labels.push_back(label);
+            }
+    }
+}
+
+}
@@ -25,179 +25,13 @@
 #import "WideVectorDrawable.h"
 #import "GlobeScene.h"
 #import "Drawable.h"
+#import "ShaderPermutation.h"
 
 namespace WhirlyKit
 {
 
+// The triangle shaders are all one module, with features turned on by defines
 static const char *vertexShaderTri =
-"struct directional_light {"
-"  vec3 direction;"
-"  vec3 halfplane;"
-"  vec4 ambient;"
-"  vec4 diffuse;"
-"  vec4 specular;"
-"  float viewdepend;"
-"};"
-""
-"struct material_properties {"
-"  vec4 ambient;"
-"  vec4 diffuse;"
-"  vec4 specular;"
-"  float specular_exponent;"
-"};"
-""
-"uniform mat4  u_mvpMatrix;"
-"uniform float u_fade;"
-"uniform int u_numLights;"
-"uniform directional_light light[8];"
-"uniform material_properties material;"
-""
-"attribute vec3 a_position;"
-"attribute vec2 a_texCoord0;"
-"attribute vec4 a_color;"
-"attribute vec3 a_normal;"
-""
-"varying vec2 v_texCoord;"
-"varying vec4 v_color;"
-""
-"void main()"
-"{"
-"   v_texCoord = a_texCoord0;"
-"   v_color = vec4(0.0,0.0,0.0,0.0);"
-"   if (u_numLights > 0)"
-"   {"
-"     vec4 ambient = vec4(0.0,0.0,0.0,0.0);"
-"     vec4 diffuse = vec4(0.0,0.0,0.0,0.0);"
-"     for (int ii=0;ii<8;ii++)"
-"     {"
-"        if (ii>=u_numLights)"
-"           break;"
-"        vec3 adjNorm = light[ii].viewdepend > 0.0 ? normalize((u_mvpMatrix * vec4(a_normal.xyz, 0.0)).xyz) : a_normal.xzy;"
-"        float ndotl;"
-//"        float ndoth;\n"
-"        ndotl = max(0.0, dot(adjNorm, light[ii].direction));"
-//"        ndotl = pow(ndotl,0.5);\n"
-//"        ndoth = max(0.0, dot(adjNorm, light[ii].halfplane));\n"
-"        ambient += light[ii].ambient;"
-"        diffuse += ndotl * light[ii].diffuse;"
-"     }"
-"     v_color = vec4(ambient.xyz * material.ambient.xyz * a_color.xyz + diffuse.xyz * a_color.xyz,a_color.a) * u_fade;"
-"   } else {"
-"     v_color = a_color * u_fade;"
-"   }"
-""
-"   gl_Position = u_mvpMatrix * vec4(a_position,1.0);"
-"}"
-;
-
-static const char *fragmentShaderTri =
-"precision mediump float;                            \n"
-"\n"
-"uniform sampler2D s_baseMap0;                        \n"
-"uniform bool  u_hasTexture;                         \n"
-"\n"
-"varying vec2      v_texCoord;                       \n"
-"varying vec4      v_color;                          \n"
-"\n"
-"void main()                                         \n"
-"{                                                   \n"
-//"  vec4 baseColor = texture2D(s_baseMap0, v_texCoord); \n"
-"  vec4 baseColor = u_hasTexture ? texture2D(s_baseMap0, v_texCoord) : vec4(1.0,1.0,1.0,1.0); \n"
-//"  if (baseColor.a < 0.1)                            \n"
-//"      discard;                                      \n"
-"  gl_FragColor = v_color * baseColor;  \n"
-"}                                                   \n"
-;
-
-/*static const char *fragmentShaderRampTri =
-"precision mediump float;\n"
-"\n"
-"uniform sampler2D s_baseMap0;\n"
-"uniform sampler2D s_colorRamp;\n"
-"uniform bool  u_hasTexture;\n"
-"\n"
-"varying vec2      v_texCoord;\n"
-"varying vec4      v_color;\n"
-"\n"
-"void main()\n"
-"{\n"
-"  float index = texture2D(s_baseMap0, v_texCoord).a;\n"
-"  vec4 baseColor = texture2D(s_colorRamp,vec2(0.5,index));\n"
-"  gl_FragColor = v_color * baseColor;\n"
-"}\n"
-;*/
-
-static const char *vertexShaderModelTri =
-"struct directional_light {"
-"  vec3 direction;"
-"  vec3 halfplane;"
-"  vec4 ambient;"
-"  vec4 diffuse;"
-"  vec4 specular;"
-"  float viewdepend;"
-"};"
-""
-"struct material_properties {"
-"  vec4 ambient;"
-"  vec4 diffuse;"
-"  vec4 specular;"
-"  float specular_exponent;"
-"};"
-""
-"uniform mat4  u_mvpMatrix;"
-"uniform float u_fade;"
-"uniform float u_time;"
-"uniform int u_numLights;"
-"uniform directional_light light[8];"
-"uniform material_properties material;"
-""
-"attribute vec3 a_position;"
-"attribute vec2 a_texCoord0;"
-"attribute vec4 a_color;"
-"attribute vec4 a_instanceColor;"
-"attribute float a_useInstanceColor;"
-"attribute vec3 a_normal;"
-"attribute mat4 a_singleMatrix;"
-"attribute vec3 a_modelCenter;"
-"attribute vec3 a_modelDir;"
-""
-"varying vec2 v_texCoord;"
-"varying vec4 v_color;"
-""
-"void main()"
-"{"
-"   v_texCoord = a_texCoord0;"
-"   v_color = vec4(0.0,0.0,0.0,0.0);"
-"   vec4 inColor = a_useInstanceColor > 0.0 ? a_instanceColor : a_color;"
-"   if (u_numLights > 0)"
-"   {"
-"     vec4 ambient = vec4(0.0,0.0,0.0,0.0);"
-"     vec4 diffuse = vec4(0.0,0.0,0.0,0.0);"
-"     for (int ii=0;ii<8;ii++)"
-"     {"
-"        if (ii>=u_numLights)"
-"           break;"
-"        vec3 adjNorm = light[ii].viewdepend > 0.0 ? normalize((u_mvpMatrix * vec4(a_normal.xyz, 0.0)).xyz) : a_normal.xzy;"
-"        float ndotl;"
-//"        float ndoth;\n"
-"        ndotl = max(0.0, dot(adjNorm, light[ii].direction));"
-//"        ndotl = pow(ndotl,0.5);\n"
-//"        ndoth = max(0.0, dot(adjNorm, light[ii].halfplane));\n"
-"        ambient += light[ii].ambient;"
-"        diffuse += ndotl * light[ii].diffuse;"
-"     }"
-"     v_color = vec4(ambient.xyz * material.ambient.xyz * inColor.xyz + diffuse.xyz * inColor.xyz,inColor.a) * u_fade;"
-"   } else {"
-"     v_color = inColor * u_fade;"
-"   }"
-"   vec3 center = a_modelDir * u_time + a_modelCenter;"
-"   vec3 vertPos = (a_singleMatrix *vec4(a_position,1.0)).xyz + center;"
-""
-"   gl_Position = u_mvpMatrix * vec4(vertPos,1.0);"
-"}"
-;
-
-static const char *vertexShaderTriMultiTex =
 "struct directional_light {\n"
 "  vec3 direction;\n"
 "  vec3 halfplane;\n"
@@ -214,243 +48,194 @@ static const char *vertexShaderTriMultiTex =
 "  float specular_exponent;\n"
 "};\n"
 "\n"
-"uniform mat4  u_mvpMatrix;                   \n"
-"uniform float u_fade;                        \n"
-"uniform int u_numLights;                      \n"
-"uniform directional_light light[8];                     \n"
-"uniform material_properties material;       \n"
-"uniform float u_interp;"
+"uniform mat4  u_mvpMatrix;\n"
+"uniform float u_fade;\n"
+"uniform vec4  u_tint;\n"
+"#ifdef LIGHTING\n"
+"uniform int u_numLights;\n"
+"#ifdef NIGHT_DAY\n"
+"uniform directional_light light[1];\n"
+"#else\n"
+"uniform directional_light light[8];\n"
+"#endif\n"
+"uniform material_properties material;\n"
+"#endif\n"
+"#ifdef MODEL_INSTANCE\n"
+"uniform float u_time;\n"
+"#endif\n"
+"#ifdef SCREEN_TEX\n"
+"uniform vec2  u_scale;\n"
+"uniform vec2  u_texScale;\n"
+"uniform vec2  u_screenOrigin;\n"
+"#endif\n"
 "\n"
-"attribute vec3 a_position;                  \n"
-"attribute vec2 a_texCoord0;                  \n"
-"attribute vec2 a_texCoord1;                  \n"
-"attribute vec4 a_color;                     \n"
-"attribute vec3 a_normal;                    \n"
+"attribute vec3 a_position;\n"
+"attribute vec2 a_texCoord0;\n"
+"#ifdef MULTI_TEX\n"
+"attribute vec2 a_texCoord1;\n"
+"#endif\n"
+"attribute vec4 a_color;\n"
+"attribute vec3 a_normal;\n"
+"#if defined(MODEL_INSTANCE) || defined(SCREEN_TEX)\n"
+"attribute mat4 a_singleMatrix;\n"
+"#endif\n"
+"#ifdef MODEL_INSTANCE\n"
+"attribute vec4 a_instanceColor;\n"
+"attribute float a_useInstanceColor;\n"
+"attribute vec3 a_modelCenter;\n"
+"attribute vec3 a_modelDir;\n"
+"#endif\n"
 "\n"
-"varying vec2 v_texCoord0;                    \n"
-"varying vec2 v_texCoord1;                    \n"
-"varying vec4 v_color;                       \n"
+"#ifdef MULTI_TEX\n"
+"varying vec2 v_texCoord0;\n"
+"varying vec2 v_texCoord1;\n"
+"#else\n"
+"varying vec2 v_texCoord;\n"
+"#endif\n"
+"varying vec4 v_color;\n"
+"#ifdef NIGHT_DAY\n"
+"varying vec3 v_adjNorm;\n"
+"varying vec3 v_lightDir;\n"
+"#endif\n"
 "\n"
-"void main()                                 \n"
-"{                                           \n"
-"   v_texCoord0 = a_texCoord0;                 \n"
-"   v_texCoord1 = a_texCoord1;                 \n"
-"   v_color = vec4(0.0,0.0,0.0,0.0);         \n"
-"   if (u_numLights > 0)                     \n"
+"void main()\n"
+"{\n"
+"#ifdef MULTI_TEX\n"
+"   v_texCoord0 = a_texCoord0;\n"
+"   v_texCoord1 = a_texCoord1;\n"
+"#else\n"
+"   v_texCoord = a_texCoord0;\n"
+"#endif\n"
+"#ifdef MODEL_INSTANCE\n"
+"   vec4 inColor = a_useInstanceColor > 0.0 ? a_instanceColor : a_color;\n"
+"#else\n"
+"   vec4 inColor = a_color;\n"
+"#endif\n"
+"#if defined(NIGHT_DAY)\n"
+// Night/day does its lighting in the fragment shader with the one light
+"   v_adjNorm = light[0].viewdepend > 0.0 ? normalize((u_mvpMatrix * vec4(a_normal.xyz, 0.0)).xyz) : a_normal.xzy;\n"
+"   v_lightDir = (u_numLights > 0) ? light[0].direction : vec3(1,0,0);\n"
+"   v_color = vec4(light[0].ambient.xyz * material.ambient.xyz * inColor.xyz + light[0].diffuse.xyz * inColor.xyz,inColor.a) * u_fade * u_tint;\n"
+"#elif defined(LIGHTING)\n"
+"   v_color = vec4(0.0,0.0,0.0,0.0);\n"
+"   if (u_numLights > 0)\n"
 "   {\n"
-"     vec4 ambient = vec4(0.0,0.0,0.0,0.0);         \n"
-"     vec4 diffuse = vec4(0.0,0.0,0.0,0.0);         \n"
-"     for (int ii=0;ii<8;ii++)                 \n"
+"     vec4 ambient = vec4(0.0,0.0,0.0,0.0);\n"
+"     vec4 diffuse = vec4(0.0,0.0,0.0,0.0);\n"
+"     for (int ii=0;ii<8;ii++)\n"
 "     {\n"
-"        if (ii>=u_numLights)                  \n"
-"           break;                             \n"
+"        if (ii>=u_numLights)\n"
+"           break;\n"
 "        vec3 adjNorm = light[ii].viewdepend > 0.0 ? normalize((u_mvpMatrix * vec4(a_normal.xyz, 0.0)).xyz) : a_normal.xzy;\n"
 "        float ndotl;\n"
-//"        float ndoth;\n"
 "        ndotl = max(0.0, dot(adjNorm, light[ii].direction));\n"
-//"        ndotl = pow(ndotl,0.5);\n"
-//"        ndoth = max(0.0, dot(adjNorm, light[ii].halfplane));\n"
 "        ambient += light[ii].ambient;\n"
 "        diffuse += ndotl * light[ii].diffuse;\n"
 "     }\n"
-"     v_color = vec4(ambient.xyz * material.ambient.xyz * a_color.xyz + diffuse.xyz * a_color.xyz,a_color.a) * u_fade;\n"
+"     v_color = vec4(ambient.xyz * material.ambient.xyz * inColor.xyz + diffuse.xyz * inColor.xyz,inColor.a) * u_fade * u_tint;\n"
 "   } else {\n"
-"     v_color = a_color * u_fade;\n"
+"     v_color = inColor * u_fade * u_tint;\n"
 "   }\n"
+"#else\n"
+"   v_color = inColor * u_fade * u_tint;\n"
+"#endif\n"
 "\n"
-"   gl_Position = u_mvpMatrix * vec4(a_position,1.0);  \n"
-"}                                           \n"
-;
-
-static const char *fragmentShaderTriMultiTex =
-"precision mediump float;"
-""
-"uniform sampler2D s_baseMap0;"
-"uniform sampler2D s_baseMap1;"
-"uniform float u_interp;"
-""
-"varying vec2      v_texCoord0;"
-"varying vec2      v_texCoord1;"
-"varying vec4      v_color;"
-""
-"void main()"
-"{"
-"  vec4 baseColor0 = texture2D(s_baseMap0, v_texCoord0);"
-"  vec4 baseColor1 = texture2D(s_baseMap1, v_texCoord1);"
-"  gl_FragColor = v_color * mix(baseColor0,baseColor1,u_interp);"
-"}"
+"#if defined(MODEL_INSTANCE)\n"
+"   vec3 center = a_modelDir * u_time + a_modelCenter;\n"
+"   vec3 vertPos = (a_singleMatrix * vec4(a_position,1.0)).xyz + center;\n"
+"   gl_Position = u_mvpMatrix * vec4(vertPos,1.0);\n"
+"#elif defined(SCREEN_TEX)\n"
+"   vec4 screenPt = (u_mvpMatrix * vec4(a_position,1.0));\n"
+"   screenPt /= screenPt.w;\n"
+"   vec2 screenTexCoord = vec2((screenPt.x+u_screenOrigin.x)*u_scale.x*u_texScale.x,(screenPt.y+u_screenOrigin.y)*u_scale.y*u_texScale.y);\n"
+"#ifdef MULTI_TEX\n"
+"   v_texCoord0 = screenTexCoord;\n"
+"#else\n"
+"   v_texCoord = screenTexCoord;\n"
+"#endif\n"
+"   gl_Position = u_mvpMatrix * (a_singleMatrix * vec4(a_position,1.0));\n"
+"#else\n"
+"   gl_Position = u_mvpMatrix * vec4(a_position,1.0);\n"
+"#endif\n"
+"}\n"
 ;
 
-static const char *fragmentShaderTriMultiTexRamp =
+static const char *fragmentShaderTri =
 "precision mediump float;\n"
 "\n"
 "uniform sampler2D s_baseMap0;\n"
+"#ifdef MULTI_TEX\n"
 "uniform sampler2D s_baseMap1;\n"
-"uniform sampler2D s_colorRamp;\n"
 "uniform float u_interp;\n"
+"#else\n"
+"uniform bool  u_hasTexture;\n"
+"#endif\n"
+"#ifdef COLOR_RAMP\n"
+"uniform sampler2D s_colorRamp;\n"
+"#endif\n"
 "\n"
+"#ifdef MULTI_TEX\n"
 "varying vec2      v_texCoord0;\n"
 "varying vec2      v_texCoord1;\n"
+"#else\n"
+"varying vec2      v_texCoord;\n"
+"#endif\n"
 "varying vec4      v_color;\n"
+"#ifdef NIGHT_DAY\n"
+"varying vec3      v_adjNorm;\n"
+"varying vec3      v_lightDir;\n"
+"#endif\n"
 "\n"
 "void main()\n"
 "{\n"
+"#if defined(NIGHT_DAY)\n"
+"  float ndotl = max(0.0, dot(v_adjNorm, v_lightDir));\n"
+"  ndotl = pow(ndotl,0.5);\n"
+"  vec4 baseColor0 = texture2D(s_baseMap0, v_texCoord0);\n"
+"  vec4 baseColor1 = texture2D(s_baseMap1, v_texCoord1);\n"
+"  gl_FragColor = mix(baseColor0,baseColor1,1.0-ndotl);\n"
+"#elif defined(COLOR_RAMP)\n"
+// The texture is an index into the ramp
+"#ifdef MULTI_TEX\n"
 "  float baseVal0 = texture2D(s_baseMap0, v_texCoord0).a;\n"
 "  float baseVal1 = texture2D(s_baseMap1, v_texCoord1).a;\n"
 "  float index = mix(baseVal0,baseVal1,u_interp);\n"
+"#else\n"
+"  float index = texture2D(s_baseMap0, v_texCoord).a;\n"
+"#endif\n"
 "  gl_FragColor = v_color * texture2D(s_colorRamp,vec2(0.5,index));\n"
-"}\n"
-;
-
-static const char *vertexShaderScreenTexTri =
-"struct directional_light {"
-"  vec3 direction;"
-"  vec3 halfplane;"
-"  vec4 ambient;"
-"  vec4 diffuse;"
-"  vec4 specular;"
-"  float viewdepend;"
-"};"
-""
-"struct material_properties {"
-"  vec4 ambient;"
-"  vec4 diffuse;"
-"  vec4 specular;"
-"  float specular_exponent;"
-"};"
-""
-"uniform mat4  u_mvpMatrix;"
-"uniform float u_fade;"
-"uniform vec2  u_scale;"
-"uniform vec2  u_texScale;"
-"uniform vec2  u_screenOrigin;"
-"uniform int u_numLights;"
-"uniform directional_light light[8];"
-"uniform material_properties material;"
-""
-"attribute vec3 a_position;"
-"attribute vec2 a_texCoord0;"
-"attribute vec4 a_color;"
-"attribute vec3 a_normal;"
-"attribute mat4 a_singleMatrix;"
-""
-"varying vec2 v_texCoord;"
-"varying vec4 v_color;"
-""
-"void main()"
-"{"
-"   v_texCoord = a_texCoord0;"
-"   v_color = vec4(0.0,0.0,0.0,0.0);"
-"   if (u_numLights > 0)"
-"   {"
-"     vec4 ambient = vec4(0.0,0.0,0.0,0.0);"
-"     vec4 diffuse = vec4(0.0,0.0,0.0,0.0);"
-"     for (int ii=0;ii<8;ii++)"
-"     {"
-"        if (ii>=u_numLights)"
-"           break;"
-"        vec3 adjNorm = light[ii].viewdepend > 0.0 ? normalize((u_mvpMatrix * vec4(a_normal.xyz, 0.0)).xyz) : a_normal.xzy;"
-"        float ndotl;"
-//"        float ndoth;\n"
-"        ndotl = max(0.0, dot(adjNorm, light[ii].direction));"
-//"        ndotl = pow(ndotl,0.5);\n"
-//"        ndoth = max(0.0, dot(adjNorm, light[ii].halfplane));\n"
-"        ambient += light[ii].ambient;"
-"        diffuse += ndotl * light[ii].diffuse;"
-"     }"
-"     v_color = vec4(ambient.xyz * material.ambient.xyz * a_color.xyz + diffuse.xyz * a_color.xyz,a_color.a) * u_fade;"
-"   } else {"
-"     v_color = a_color * u_fade;"
-"   }"
-""
-"   vec4 screenPt = (u_mvpMatrix * vec4(a_position,1.0));"
-"   screenPt /= screenPt.w;"
-"   v_texCoord = vec2((screenPt.x+u_screenOrigin.x)*u_scale.x*u_texScale.x,(screenPt.y+u_screenOrigin.y)*u_scale.y*u_texScale.y);"
-""
-"   gl_Position = u_mvpMatrix * (a_singleMatrix * vec4(a_position,1.0));"
-"}"
-;
-
-
-static const char *vertexShaderTriNightDay =
-"struct directional_light {\n"
-"  vec3 direction;\n"
-"  vec3 halfplane;\n"
-"  vec4 ambient;\n"
-"  vec4 diffuse;\n"
-"  vec4 specular;\n"
-"  float viewdepend;\n"
-"};\n"
-"\n"
-"struct material_properties {\n"
-"  vec4 ambient;\n"
-"  vec4 diffuse;\n"
-"  vec4 specular;\n"
-"  float specular_exponent;\n"
-"};\n"
-"\n"
-"uniform mat4  u_mvpMatrix;                   \n"
-"uniform float u_fade;                        \n"
-"uniform int u_numLights;                      \n"
-"uniform directional_light light[1];                     \n"
-"uniform material_properties material;       \n"
-"uniform float u_interp;"
-"\n"
-"attribute vec3 a_position;                  \n"
-"attribute vec2 a_texCoord0;                  \n"
-"attribute vec2 a_texCoord1;                  \n"
-"attribute vec4 a_color;                     \n"
-"attribute vec3 a_normal;                    \n"
-"\n"
-"varying mediump vec2 v_texCoord0;                    \n"
-"varying mediump vec2 v_texCoord1;                    \n"
-"varying mediump vec4 v_color;\n"
-"varying mediump vec3 v_adjNorm;\n"
-"varying mediump vec3 v_lightDir;\n"
-"\n"
-"void main()                                 \n"
-"{                                           \n"
-"   v_texCoord0 = a_texCoord0;                 \n"
-"   v_texCoord1 = a_texCoord1;                 \n"
-"   v_color = a_color;\n"
-"   v_adjNorm = light[0].viewdepend > 0.0 ? normalize((u_mvpMatrix * vec4(a_normal.xyz, 0.0)).xyz) : a_normal.xzy;\n"
-"   v_lightDir = (u_numLights > 0) ? light[0].direction : vec3(1,0,0);\n"
-"   v_color = vec4(light[0].ambient.xyz * material.ambient.xyz * a_color.xyz + light[0].diffuse.xyz * a_color.xyz,a_color.a) * u_fade;\n"
-"\n"
-"   gl_Position = u_mvpMatrix * vec4(a_position,1.0);  \n"
-"}                                           \n"
-;
-
-static const char *fragmentShaderTriNightDay =
-"precision mediump float;"
-"\n"
-"uniform sampler2D s_baseMap0;\n"
-"uniform sampler2D s_baseMap1;\n"
-"\n"
-"varying vec2      v_texCoord0;\n"
-"varying vec2      v_texCoord1;\n"
-"varying vec4      v_color;\n"
-"varying vec3      v_adjNorm;\n"
-"varying vec3      v_lightDir;\n"
-"\n"
-"void main()\n"
-"{\n"
-"   float ndotl = max(0.0, dot(v_adjNorm, v_lightDir));\n"
-"   ndotl = pow(ndotl,0.5);\n"
-"\n"
-// Note: Put the color back
+"#elif defined(MULTI_TEX)\n"
 "  vec4 baseColor0 = texture2D(s_baseMap0, v_texCoord0);\n"
 "  vec4 baseColor1 = texture2D(s_baseMap1, v_texCoord1);\n"
-"  gl_FragColor = mix(baseColor0,baseColor1,1.0-ndotl);\n"
+"  gl_FragColor = v_color * mix(baseColor0,baseColor1,u_interp);\n"
+"#else\n"
+"  vec4 baseColor = u_hasTexture ? texture2D(s_baseMap0, v_texCoord) : vec4(1.0,1.0,1.0,1.0);\n"
+"  gl_FragColor = v_color * baseColor;\n"
+"#endif\n"
 "}\n"
 ;
 
+ShaderModule DefaultTriangleShaderModule()
+{
+    ShaderModule module(kToolkitDefaultTriangleModule,vertexShaderTri,fragmentShaderTri);
+
+    // Added in the order they show up in the program names
+    module.addFeature(ShaderTriModelInstance,"MODEL_INSTANCE","model",0,ShaderTriScreenTex);
+    module.addFeature(ShaderTriScreenTex,"SCREEN_TEX","screentex");
+    module.addFeature(ShaderTriNightDay,"NIGHT_DAY","nightday",ShaderTriMultiTex | ShaderTriLighting);
+    module.addFeature(ShaderTriMultiTex,"MULTI_TEX","multitex");
+    module.addFeature(ShaderTriLighting,"LIGHTING","lighting",0,0,true);
+    module.addFeature(ShaderTriColorRamp,"COLOR_RAMP","ramp",0,ShaderTriNightDay);
+
+    return module;
+}
 
 static const char *vertexShaderLine =
 "uniform mat4  u_mvpMatrix;"
 "uniform mat4  u_mvMatrix;"
 "uniform mat4  u_mvNormalMatrix;"
 "uniform float u_fade;"
+"uniform vec4  u_tint;"
 ""
 "attribute vec3 a_position;"
 "attribute vec4 a_color;"
@@ -465,7 +250,7 @@ static const char *vertexShaderLine =
 "   pt /= pt.w;"
 "   vec4 testNorm = u_mvNormalMatrix * vec4(a_normal,0.0);"
 "   v_dot = dot(-pt.xyz,testNorm.xyz);"
-"   v_color = a_color * u_fade;"
+"   v_color = a_color * u_fade * u_tint;"
 "   gl_Position = u_mvpMatrix * vec4(a_position,1.0);"
 "}"
 ;
@@ -487,6 +272,7 @@ static const char *vertexShaderLineNoBack =
 "uniform mat4  u_mvMatrix;"
 "uniform mat4  u_mvNormalMatrix;"
 "uniform float u_fade;"
+"uniform vec4  u_tint;"
 ""
 "attribute vec3 a_position;"
 "attribute vec4 a_color;"
@@ -496,7 +282,7 @@ static const char *vertexShaderLineNoBack =
 ""
 "void main()"
 "{"
-"   v_color = a_color * u_fade;"
+"   v_color = a_color * u_fade * u_tint;"
 "   gl_Position = u_mvpMatrix * vec4(a_position,1.0);"
 "}"
 ;
@@ -512,64 +298,31 @@ static const char *fragmentShaderLineNoBack =
 "}"
 ;
 
-static const char *vertexShaderNoLightTri =
-"uniform mat4  u_mvpMatrix;                   \n"
-"uniform float u_fade;                        \n"
-"attribute vec3 a_position;                  \n"
-"attribute vec2 a_texCoord0;                  \n"
-"attribute vec4 a_color;                     \n"
-"attribute vec3 a_normal;                    \n"
-"\n"
-"varying vec2 v_texCoord;                    \n"
-"varying vec4 v_color;                       \n"
-"\n"
-"void main()                                 \n"
-"{                                           \n"
-"   v_texCoord = a_texCoord0;                 \n"
-"   v_color = a_color * u_fade;\n"
-"\n"
-"   gl_Position = u_mvpMatrix * vec4(a_position,1.0);  \n"
-"}                                           \n"
-;
-
-static const char *fragmentShaderNoLightTri =
-"precision mediump float;                            \n"
-"\n"
-"uniform sampler2D s_baseMap0;                        \n"
-"uniform bool  u_hasTexture;                         \n"
-"\n"
-"varying vec2      v_texCoord;                       \n"
-"varying vec4      v_color;                          \n"
-"\n"
-"void main()                                         \n"
-"{                                                   \n"
-//"  vec4 baseColor = texture2D(s_baseMap0, v_texCoord); \n"
-"  vec4 baseColor = u_hasTexture ? texture2D(s_baseMap0, v_texCoord) : vec4(1.0,1.0,1.0,1.0); \n"
-//"  if (baseColor.a < 0.1)                            \n"
-//"      discard;                                      \n"
-    "  gl_FragColor = v_color * baseColor;  \n"
-"}                                                   \n"
-;
-    
 void SetupDefaultShaders(Scene *scene)
 {
+    // Triangle shaders are permutations of the one module.  Their permutation
+    //  names are the toolkit program names, so that's what they're added as.
+    ShaderPermutationManager *shaderManager = (ShaderPermutationManager *)scene->getManager(kWKShaderPermutationManager);
+    SimpleIdentity triShaderID = EmptyIdentity;
+    if (shaderManager)
+    {
+        shaderManager->addModule(DefaultTriangleShaderModule());
+        triShaderID = shaderManager->getProgram(kToolkitDefaultTriangleModule, ShaderTriLighting);
+    }
+
     // Default triangle and line (point) shaders
-    OpenGLES2Program *triShader = new OpenGLES2Program("Default triangle shader with lighting",vertexShaderTri,fragmentShaderTri);
     OpenGLES2Program *lineShader;
     if (dynamic_cast<WhirlyGlobe::GlobeScene *>(scene))
         lineShader = new OpenGLES2Program("Default line shader with backface culling",vertexShaderLine,fragmentShaderLine);
     else
         lineShader = new OpenGLES2Program("Default line shader without culling",vertexShaderLineNoBack,fragmentShaderLineNoBack);
-    if (!triShader->isValid() || !lineShader->isValid())
+    if (triShaderID == EmptyIdentity || !lineShader->isValid())
     {
         fprintf(stderr,"SetupDefaultShaders: Default triangle and line shaders didn't compile.  Nothing will work.\n");
-        delete triShader;
         delete lineShader;
     } else {
-        scene->addProgram(triShader);
         scene->addProgram(lineShader);
-        scene->setSceneProgram(kToolkitDefaultTriangleProgram, triShader->getId());
-        scene->setSceneProgram(kSceneDefaultTriShader, triShader->getId());
+        scene->setSceneProgram(kSceneDefaultTriShader, triShaderID);
         scene->setSceneProgram(kToolkitDefaultLineProgram, lineShader->getId());
         scene->setSceneProgram(kSceneDefaultLineShader, lineShader->getId());
     }
@@ -584,65 +337,22 @@ void SetupDefaultShaders(Scene *scene)
         scene->addProgram(kToolkitDefaultLineNoBackfaceProgram, lineNoBackShader);
     }
     
-    // Triangle shader that doesn't do lighting
-    OpenGLES2Program *triShaderNoLight = new OpenGLES2Program("Default triangle shader without lighting",vertexShaderNoLightTri,fragmentShaderNoLightTri);
-    if (!triShaderNoLight->isValid())
-    {
-        fprintf(stderr,"SetupDefaultShaders: Triangle shader without lighting didn't compile.\n");
-        delete triShaderNoLight;
-    } else {
-        scene->addProgram(kToolkitDefaultTriangleNoLightingProgram, triShaderNoLight);
-    }
-    
-    // Triangle shader the model instancing
-    OpenGLES2Program *triShaderModel = new OpenGLES2Program("Triangle shader for models with lighting",vertexShaderModelTri,fragmentShaderTri);
-    if (!triShaderModel->isValid())
-    {
-        fprintf(stderr,"SetupDefaultShaders: Triangle shader for model instancing and lighting didn't compile.");
-        delete triShaderModel;
-    } else {
-        scene->addProgram(kToolkitDefaultTriangleModel, triShaderModel);
-    }
-    
-    // Triangle shader that does screen space texture application
-    OpenGLES2Program *triShaderScreenTex = new OpenGLES2Program("Triangle shader with screen texture and lighting",vertexShaderScreenTexTri,fragmentShaderTri);
-    if (!triShaderScreenTex->isValid())
-    {
-        fprintf(stderr,"SetupDefaultShaders: Triangle shader with screen texture and lighting didn't compile.");
-        delete triShaderScreenTex;
-    } else {
-        scene->addProgram(kToolkitDefaultTriangleScreenTex, triShaderScreenTex);
-    }
-    
-    // Triangle shader that handles multiple textures
-    OpenGLES2Program *triShaderMultiTex = new OpenGLES2Program("Triangle shader with multitex and lighting",vertexShaderTriMultiTex,fragmentShaderTriMultiTex);
-    if (!triShaderMultiTex->isValid())
-    {
-        fprintf(stderr,"SetupDefaultShaders: Triangle shader with multi texture support didn't compile.\n");
-        delete triShaderMultiTex;
-    } else {
-        scene->addProgram(kToolkitDefaultTriangleMultiTex, triShaderMultiTex);
-    }
-    
-    // Triangle shader with ramp texture
-    OpenGLES2Program *triShaderMultiTexRamp = new OpenGLES2Program("Triangle ramp shader with multitex and lighting",vertexShaderTriMultiTex,fragmentShaderTriMultiTexRamp);
-    if (!triShaderMultiTexRamp->isValid())
-    {
-        fprintf(stderr,"SetupDefaultShaders: Triangle ramp shader with multi texture support didn't compile.\n");
-        delete triShaderMultiTexRamp;
-    } else {
-        scene->addProgram(kToolkitDefaultTriangleMultiTexRamp, triShaderMultiTexRamp);
-    }
-
-    
-    // Triangle shader that does night/day shading with multiple textures
-    OpenGLES2Program *triShaderNightDay = new OpenGLES2Program("Triangle shader with multitex, lighting, and night/day support",vertexShaderTriNightDay,fragmentShaderTriNightDay);
-    if (!triShaderNightDay->isValid())
+    // The rest of the named triangle shaders.  Other combinations are built when a drawable needs them.
+    // Model and screen texture instances pick theirs up without a name, but ramps and night/day are only set up by name.
+    if (shaderManager)
     {
-        fprintf(stderr,"SetupDefaultShaders: Triangle shader with night/day support didn't compile.");
-        delete triShaderNightDay;
-    } else {
-        scene->addProgram(kToolkitDefaultTriangleNightDay, triShaderNightDay);
+        ShaderModule triModule = DefaultTriangleShaderModule();
+        int triFeatures[] = {
+            0,
+            ShaderTriModelInstance | ShaderTriLighting,
+            ShaderTriScreenTex | ShaderTriLighting,
+            ShaderTriMultiTex | ShaderTriLighting,
+            ShaderTriMultiTex | ShaderTriLighting | ShaderTriColorRamp,
+            ShaderTriNightDay | ShaderTriMultiTex | ShaderTriLighting
+        };
+        for (int features : triFeatures)
+            if (shaderManager->getProgram(kToolkitDefaultTriangleModule, features) == EmptyIdentity)
+                fprintf(stderr,"SetupDefaultShaders: Triangle shader %s didn't compile.\n",triModule.permutationName(features).c_str());
     }
     
 #ifndef MAPLYMINIMAL
@@ -663,6 +373,15 @@ void SetupDefaultShaders(Scene *scene)
     } else {
         scene->addProgram(kToolkitDefaultBillboardEyeProgram, billShaderEye);
     }
+    
+    // Billboard shader (instanced)
+    OpenGLES2Program *billShaderInst = BuildBillboardInstanceProgram();
+    if (!billShaderInst)
+    {
+        fprintf(stderr,"SetupDefaultShaders: Billboard instance shader didn't compile.");
+    } else {
+        scene->addProgram(kToolkitDefaultBillboardInstanceProgram, billShaderInst);
+    }
 #endif
     
     // Widened vector shader
@@ -702,6 +421,24 @@ void SetupDefaultShaders(Scene *scene)
         } else {
             scene->addProgram(kToolkitDefaultScreenSpaceMotionProgram, screenSpaceMotionShader);
         }
+
+        // Screen space shader for SDF icons
+        OpenGLES2Program *screenSpaceSDFShader = BuildScreenSpaceSDFProgram();
+        if (!screenSpaceSDFShader)
+        {
+            fprintf(stderr,"SetupDefaultShaders: Screen Space SDF shader didn't compile.");
+        } else {
+            scene->addProgram(kToolkitDefaultScreenSpaceSDFProgram, screenSpaceSDFShader);
+        }
+
+        // Screen space shader for SDF icons w/ Motion
+        OpenGLES2Program *screenSpaceSDFMotionShader = BuildScreenSpaceSDFMotionProgram();
+        if (!screenSpaceSDFMotionShader)
+        {
+            fprintf(stderr,"SetupDefaultShaders: Screen Space SDF Motion shader didn't compile.");
+        } else {
+            scene->addProgram(kToolkitDefaultScreenSpaceSDFMotionProgram, screenSpaceSDFMotionShader);
+        }
     } else {
         // Use the 2D versions, which don't do backface checking
 
@@ -722,6 +459,24 @@ void SetupDefaultShaders(Scene *scene)
         } else {
             scene->addProgram(kToolkitDefaultScreenSpaceMotionProgram, screenSpaceMotionShader);
         }
+
+        // Screen space shader for SDF icons
+        OpenGLES2Program *screenSpaceSDFShader = BuildScreenSpaceSDF2DProgram();
+        if (!screenSpaceSDFShader)
+        {
+            fprintf(stderr,"SetupDefaultShaders: Screen Space SDF shader didn't compile.");
+        } else {
+            scene->addProgram(kToolkitDefaultScreenSpaceSDFProgram, screenSpaceSDFShader);
+        }
+
+        // Screen space shader for SDF icons w/ Motion
+        OpenGLES2Program *screenSpaceSDFMotionShader = BuildScreenSpaceSDFMotion2DProgram();
+        if (!screenSpaceSDFMotionShader)
+        {
+            fprintf(stderr,"SetupDefaultShaders: Screen Space SDF Motion shader didn't compile.");
+        } else {
+            scene->addProgram(kToolkitDefaultScreenSpaceSDFMotionProgram, screenSpaceSDFMotionShader);
+        }
     }
     
 #ifndef MAPLYMINIMAL
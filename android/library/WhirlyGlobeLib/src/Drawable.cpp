@@ -36,6 +36,7 @@ WhirlyKitGLSetupInfo::WhirlyKitGLSetupInfo()
 }
 
 OpenGLMemManager::OpenGLMemManager()
+    : headless(false), lastFakeID(0)
 {
     pthread_mutex_init(&idLock,NULL);
 }
@@ -49,6 +50,14 @@ GLuint OpenGLMemManager::getBufferID(unsigned int size,GLenum drawType)
 {
     pthread_mutex_lock(&idLock);
     
+    // Nothing to allocate, but callers still want a non-zero ID
+    if (headless)
+    {
+        GLuint which = ++lastFakeID;
+        pthread_mutex_unlock(&idLock);
+        return which;
+    }
+    
     if (buffIDs.empty())
     {
         GLuint newAlloc[WhirlyKitOpenGLMemCacheAllocUnit];
@@ -86,6 +95,9 @@ static const bool ReuseBuffers = false;
 
 void OpenGLMemManager::removeBufferID(GLuint bufID)
 {
+    if (headless)
+        return;
+    
     bool doClear = false;
     
     pthread_mutex_lock(&idLock);
@@ -126,6 +138,13 @@ GLuint OpenGLMemManager::getTexID()
 {
     pthread_mutex_lock(&idLock);
     
+    if (headless)
+    {
+        GLuint which = ++lastFakeID;
+        pthread_mutex_unlock(&idLock);
+        return which;
+    }
+    
     if (texIDs.empty())
     {
         GLuint newAlloc[WhirlyKitOpenGLMemCacheAllocUnit];
@@ -148,6 +167,9 @@ GLuint OpenGLMemManager::getTexID()
     
 void OpenGLMemManager::removeTexID(GLuint texID)
 {
+    if (headless)
+        return;
+    
     bool doClear = false;
     
     pthread_mutex_lock(&idLock);
@@ -205,7 +227,7 @@ ChangeRequest::~ChangeRequest()
 }
 		
 Drawable::Drawable(const std::string &name)
-    : name(name)
+    : name(name), animSlot(-1), animGeneration(0)
 {
 }
 	
@@ -0,0 +1,396 @@
+/*
+ *  DrawableAnimator.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import "DrawableAnimator.h"
+#import "Scene.h"
+
+using namespace Eigen;
+
+namespace WhirlyKit
+{
+
+AnimKeyframe::AnimKeyframe()
+    : time(0.0), value(1.0,1.0,1.0,1.0), easing(AnimEaseLinear)
+{
+}
+
+AnimKeyframe::AnimKeyframe(double time,const Eigen::Vector4f &value,AnimEasing easing)
+    : time(time), value(value), easing(easing)
+{
+}
+
+AnimTrack::AnimTrack()
+    : property(AnimAlpha), startTime(0.0), repeat(0), drawID(EmptyIdentity), featureID(EmptyIdentity)
+{
+}
+
+DrawableAnimState::DrawableAnimState()
+{
+    reset();
+}
+
+void DrawableAnimState::reset()
+{
+    color = Vector4f(1.0,1.0,1.0,1.0);
+    alpha = 1.0;
+    scale = Point2f(1.0,1.0);
+    offset = Point2f(0.0,0.0);
+    rotation = 0.0;
+}
+
+DrawableAnimator::DrawableAnimator()
+    : generation(1)
+{
+}
+
+void DrawableAnimator::addTrack(const AnimTrack &track)
+{
+    trackIDs.push_back(track.getId());
+    trackProps.push_back(track.property);
+    trackFirstKey.push_back((int)keyTimes.size());
+    trackNumKeys.push_back((int)track.keys.size());
+    trackStarts.push_back(track.startTime);
+    trackRepeats.push_back(track.repeat);
+    trackTargets.push_back(track.featureID != EmptyIdentity ? track.featureID : track.drawID);
+    trackSlots.push_back(-1);
+    trackDone.push_back(false);
+    for (const AnimKeyframe &key : track.keys)
+    {
+        keyTimes.push_back(key.time);
+        keyValues.push_back(key.value);
+        keyEasings.push_back(key.easing);
+    }
+
+    trackSlots.back() = slotForTarget(trackTargets.back());
+    rebuildDrawSlots();
+}
+
+void DrawableAnimator::removeTrackAt(int which)
+{
+    // Close up the keyframes and shift the later tracks down
+    int first = trackFirstKey[which], num = trackNumKeys[which];
+    keyTimes.erase(keyTimes.begin()+first,keyTimes.begin()+first+num);
+    keyValues.erase(keyValues.begin()+first,keyValues.begin()+first+num);
+    keyEasings.erase(keyEasings.begin()+first,keyEasings.begin()+first+num);
+    for (unsigned int ii=which+1;ii<trackFirstKey.size();ii++)
+        trackFirstKey[ii] -= num;
+
+    trackIDs.erase(trackIDs.begin()+which);
+    trackProps.erase(trackProps.begin()+which);
+    trackFirstKey.erase(trackFirstKey.begin()+which);
+    trackNumKeys.erase(trackNumKeys.begin()+which);
+    trackStarts.erase(trackStarts.begin()+which);
+    trackRepeats.erase(trackRepeats.begin()+which);
+    trackTargets.erase(trackTargets.begin()+which);
+    trackSlots.erase(trackSlots.begin()+which);
+    trackDone.erase(trackDone.begin()+which);
+}
+
+void DrawableAnimator::removeTrack(SimpleIdentity trackID)
+{
+    for (int ii=(int)trackIDs.size()-1;ii>=0;ii--)
+        if (trackIDs[ii] == trackID)
+            removeTrackAt(ii);
+
+    rebuildDrawSlots();
+}
+
+void DrawableAnimator::removeTracksFor(SimpleIdentity targetID)
+{
+    for (int ii=(int)trackIDs.size()-1;ii>=0;ii--)
+        if (trackTargets[ii] == targetID)
+            removeTrackAt(ii);
+
+    rebuildDrawSlots();
+}
+
+void DrawableAnimator::setFeatureDrawables(SimpleIdentity featureID,const SimpleIDSet &drawIDs)
+{
+    if (drawIDs.empty())
+    {
+        removeFeature(featureID);
+        return;
+    }
+
+    SimpleIDSet &featDrawIDs = features[featureID];
+    for (SimpleIdentity drawID : featDrawIDs)
+        if (drawIDs.find(drawID) == drawIDs.end())
+            removeDrawFeature(drawID,featureID);
+    for (SimpleIdentity drawID : drawIDs)
+        drawFeatures[drawID].insert(featureID);
+    featDrawIDs = drawIDs;
+    rebuildDrawSlots();
+}
+
+void DrawableAnimator::removeDrawFeature(SimpleIdentity drawID,SimpleIdentity featureID)
+{
+    auto it = drawFeatures.find(drawID);
+    if (it == drawFeatures.end())
+        return;
+
+    it->second.erase(featureID);
+    if (it->second.empty())
+        drawFeatures.erase(it);
+}
+
+void DrawableAnimator::removeFeature(SimpleIdentity featureID)
+{
+    auto fit = features.find(featureID);
+    if (fit != features.end())
+    {
+        for (SimpleIdentity drawID : fit->second)
+            removeDrawFeature(drawID,featureID);
+        features.erase(fit);
+    }
+    removeTracksFor(featureID);
+}
+
+void DrawableAnimator::removeDrawable(SimpleIdentity drawID)
+{
+    // Take it out of just the features it's part of
+    auto dit = drawFeatures.find(drawID);
+    if (dit != drawFeatures.end())
+    {
+        for (SimpleIdentity featureID : dit->second)
+        {
+            auto fit = features.find(featureID);
+            if (fit != features.end())
+                fit->second.erase(drawID);
+        }
+        drawFeatures.erase(dit);
+    }
+    if (drawSlots.erase(drawID) > 0)
+        generation++;
+
+    // Only tracks aimed right at the drawable need the slots put back together
+    if (targetSlots.find(drawID) != targetSlots.end() && features.find(drawID) == features.end())
+        removeTracksFor(drawID);
+}
+
+int DrawableAnimator::slotForTarget(SimpleIdentity targetID)
+{
+    auto it = targetSlots.find(targetID);
+    if (it != targetSlots.end())
+        return it->second;
+
+    int slot = (int)states.size();
+    states.resize(states.size()+1);
+    targetSlots[targetID] = slot;
+
+    return slot;
+}
+
+void DrawableAnimator::rebuildDrawSlots()
+{
+    // Only keep slots something is still using
+    targetSlots.clear();
+    states.clear();
+    for (unsigned int ii=0;ii<trackIDs.size();ii++)
+        trackSlots[ii] = slotForTarget(trackTargets[ii]);
+
+    // Features first so drawables targeted directly win
+    drawSlots.clear();
+    generation++;
+    for (auto it : targetSlots)
+    {
+        auto fit = features.find(it.first);
+        if (fit != features.end())
+            for (SimpleIdentity drawID : fit->second)
+                drawSlots[drawID] = it.second;
+    }
+    for (auto it : targetSlots)
+        if (features.find(it.first) == features.end())
+            drawSlots[it.first] = it.second;
+}
+
+float DrawableAnimator::Ease(AnimEasing easing,float t)
+{
+    switch (easing)
+    {
+        case AnimEaseLinear:
+            return t;
+        case AnimEaseIn:
+            return t*t;
+        case AnimEaseOut:
+            return 1.0-(1.0-t)*(1.0-t);
+        case AnimEaseInOut:
+            return t*t*(3.0-2.0*t);
+        case AnimEaseStep:
+            return t < 1.0 ? 0.0 : 1.0;
+    }
+
+    return t;
+}
+
+void DrawableAnimator::evaluate(TimeInterval now)
+{
+    for (auto &state : states)
+        state.reset();
+
+    for (unsigned int ti=0;ti<trackIDs.size();ti++)
+    {
+        int first = trackFirstKey[ti], numKeys = trackNumKeys[ti];
+        if (numKeys == 0)
+            continue;
+        double t = now - trackStarts[ti];
+        // Nothing until it starts
+        if (t < 0.0)
+            continue;
+
+        // Work out where we are in the cycle
+        double duration = keyTimes[first+numKeys-1];
+        int repeat = trackRepeats[ti];
+        if (duration > 0.0)
+        {
+            if (repeat < 0)
+                t = fmod(t,duration);
+            else if (t < duration * (repeat+1))
+                t = fmod(t,duration);
+            else {
+                t = duration;
+                trackDone[ti] = true;
+            }
+        } else
+            trackDone[ti] = repeat >= 0;
+
+        // Keyframes are usually few, so just walk them
+        int which = first;
+        int last = first+numKeys-1;
+        while (which < last && keyTimes[which] < t)
+            which++;
+        Vector4f val;
+        if (which == first || keyTimes[which] <= t)
+            val = keyValues[which];
+        else {
+            double t0 = keyTimes[which-1], t1 = keyTimes[which];
+            float frac = Ease(keyEasings[which],(t-t0)/(t1-t0));
+            val = keyValues[which-1] + (keyValues[which] - keyValues[which-1]) * frac;
+        }
+
+        DrawableAnimState &state = states[trackSlots[ti]];
+        switch (trackProps[ti])
+        {
+            case AnimColor:
+                state.color = state.color.cwiseProduct(val);
+                break;
+            case AnimAlpha:
+                state.alpha *= val.x();
+                break;
+            case AnimScale:
+                state.scale = Point2f(state.scale.x()*val.x(),state.scale.y()*val.y());
+                break;
+            case AnimOffset:
+                state.offset += Point2f(val.x(),val.y());
+                break;
+            case AnimRotation:
+                state.rotation += val.x();
+                break;
+        }
+    }
+}
+
+const DrawableAnimState *DrawableAnimator::stateForDrawable(SimpleIdentity drawID) const
+{
+    auto it = drawSlots.find(drawID);
+    if (it == drawSlots.end())
+        return NULL;
+
+    return &states[it->second];
+}
+
+const DrawableAnimState *DrawableAnimator::stateForDrawable(Drawable *draw) const
+{
+    int slot;
+    if (!draw->getAnimSlot(generation,slot))
+    {
+        auto it = drawSlots.find(draw->getId());
+        slot = (it == drawSlots.end()) ? -1 : it->second;
+        draw->setAnimSlot(slot,generation);
+    }
+    if (slot < 0)
+        return NULL;
+
+    return &states[slot];
+}
+
+TimeInterval DrawableAnimator::nextChangeTime(TimeInterval now) const
+{
+    TimeInterval next = 0.0;
+
+    for (unsigned int ti=0;ti<trackIDs.size();ti++)
+    {
+        int first = trackFirstKey[ti], numKeys = trackNumKeys[ti];
+        if (numKeys == 0 || trackDone[ti])
+            continue;
+
+        TimeInterval when = now;
+        double t = now - trackStarts[ti];
+        double duration = keyTimes[first+numKeys-1];
+        int repeat = trackRepeats[ti];
+        if (t < 0.0)
+            when = trackStarts[ti];
+        else if (duration > 0.0 && (repeat < 0 || t < duration * (repeat+1)))
+        {
+            // Values only hold still over a step or between matching keyframes
+            t = fmod(t,duration);
+            int which = first;
+            int last = first+numKeys-1;
+            while (which < last && keyTimes[which] <= t)
+                which++;
+            if (keyTimes[which] > t &&
+                (which == first || keyEasings[which] == AnimEaseStep || keyValues[which] == keyValues[which-1]))
+                when = now + (keyTimes[which] - t);
+        }
+        // Otherwise it's past the end, but hasn't been drawn there yet
+
+        if (next == 0.0 || when < next)
+            next = when;
+    }
+
+    return next;
+}
+
+bool DrawableAnimator::hasChanges(TimeInterval now) const
+{
+    TimeInterval next = nextChangeTime(now);
+
+    return next != 0.0 && next <= now;
+}
+
+void AddAnimTrackReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view)
+{
+    scene->getAnimator()->addTrack(track);
+}
+
+void RemAnimTracksReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view)
+{
+    if (isTarget)
+        scene->getAnimator()->removeTracksFor(theID);
+    else
+        scene->getAnimator()->removeTrack(theID);
+}
+
+void SetAnimFeatureReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view)
+{
+    scene->getAnimator()->setFeatureDrawables(featureID,drawIDs);
+}
+
+}
@@ -121,6 +121,17 @@ DynamicTexture::~DynamicTexture()
     pthread_mutex_destroy(&regionLock);
 }
 
+unsigned long DynamicTexture::getMemSize() const
+{
+    int pixSize = 4;
+    if (format == GL_ALPHA)
+        pixSize = 1;
+    else if (type != GL_UNSIGNED_BYTE)
+        pixSize = 2;
+    
+    return (unsigned long)texSize * texSize * pixSize + softData.size();
+}
+
 // If set we'll try to clear the images when we're not using them.
 static const bool ClearImages = true;
 
@@ -134,6 +145,15 @@ bool DynamicTexture::createInGL(OpenGLMemManager *memManager)
     glId = memManager->getTexID();
     if (!glId)
         return false;
+    
+    // No OpenGL, so we keep the pixels ourselves.  Only 8 bit RGBA and alpha are kept.
+    if (memManager->isHeadless())
+    {
+        if (!compressed && type == GL_UNSIGNED_BYTE)
+            softData.resize(texSize*texSize*(format == GL_ALPHA ? 1 : 4),0);
+        return true;
+    }
+    
     glBindTexture(GL_TEXTURE_2D, glId);
     CheckGLError("DynamicTexture::createInGL() glBindTexture()");
     
@@ -173,6 +193,23 @@ void DynamicTexture::destroyInGL(OpenGLMemManager *memManager)
 	if (glId)
         memManager->removeTexID(glId);    
     glId = 0;
+    softData.clear();
+}
+    
+void DynamicTexture::copyIntoSoftData(int startX,int startY,int width,int height,const unsigned char *data)
+{
+    int pixSize = (format == GL_ALPHA ? 1 : 4);
+    for (int iy=0;iy<height;iy++)
+    {
+        int destY = startY + iy;
+        if (destY < 0 || destY >= texSize)
+            continue;
+        int sx = std::max(startX,0);
+        int ex = std::min(startX+width,texSize);
+        if (ex <= sx)
+            continue;
+        memcpy(&softData[(destY*texSize+sx)*pixSize], data + (iy*width+(sx-startX))*pixSize, (ex-sx)*pixSize);
+    }
 }
     
 void DynamicTexture::addTexture(Texture *tex,const Region &region)
@@ -188,7 +225,10 @@ void DynamicTexture::addTexture(Texture *tex,const Region &region)
     
 void DynamicTexture::addTextureData(int startX,int startY,int width,int height,RawDataRef data)
 {
-    if (data)
+    if (data && !softData.empty())
+    {
+        copyIntoSoftData(startX, startY, width, height, (const unsigned char *)data->getRawData());
+    } else if (data)
     {
 //        if (startX+width > texSize || startY+height > texSize)
 //            NSLog(@"Pixels outside bounds in dynamic texture.");
@@ -216,6 +256,13 @@ void DynamicTexture::clearTextureData(int startX,int startY,int width,int height
 {
     if (!clearTextures)
         return;
+    
+    if (!softData.empty())
+    {
+        if (ClearImages && emptyData)
+            copyIntoSoftData(startX, startY, width, height, emptyData);
+        return;
+    }
 
     glBindTexture(GL_TEXTURE_2D, glId);
     
@@ -0,0 +1,401 @@
+/*
+ *  ElevationManager.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import "ElevationManager.h"
+#import "FlatMath.h"
+#import "VectorManager.h"
+#import "WideVectorManager.h"
+#import "IntersectionManager.h"
+
+namespace WhirlyKit
+{
+
+ElevationGridTile::ElevationGridTile(const Quadtree::Identifier &ident,const Point2d &ll,const Point2d &ur,int sizeX,int sizeY,const float *inSamples)
+    : ident(ident), ll(ll), ur(ur), sizeX(sizeX), sizeY(sizeY)
+{
+    if (sizeX > 0 && sizeY > 0 && inSamples)
+        samples.assign(inSamples,inSamples+sizeX*sizeY);
+}
+
+Point2d ElevationGridTile::cellSize() const
+{
+    return Point2d((ur.x()-ll.x())/std::max(sizeX-1,1),(ur.y()-ll.y())/std::max(sizeY-1,1));
+}
+
+bool ElevationGridTile::interpolate(const Point2d &pt,double &elev) const
+{
+    if (sizeX < 2 || sizeY < 2 || samples.size() < (size_t)sizeX*sizeY)
+        return false;
+
+    // Allow a little slop for points that are right on the edge
+    Point2d span = ur - ll;
+    double epsX = span.x() * 1e-9, epsY = span.y() * 1e-9;
+    if (pt.x() < ll.x()-epsX || pt.x() > ur.x()+epsX || pt.y() < ll.y()-epsY || pt.y() > ur.y()+epsY)
+        return false;
+
+    // Samples are top row first
+    double fx = (pt.x() - ll.x()) / span.x() * (sizeX-1);
+    double fy = (ur.y() - pt.y()) / span.y() * (sizeY-1);
+    fx = std::min(std::max(fx,0.0),(double)(sizeX-1));
+    fy = std::min(std::max(fy,0.0),(double)(sizeY-1));
+    int ix = std::min((int)fx,sizeX-2);
+    int iy = std::min((int)fy,sizeY-2);
+    double tx = fx - ix, ty = fy - iy;
+
+    const float *row0 = &samples[iy*sizeX+ix];
+    const float *row1 = row0 + sizeX;
+    double top = row0[0] * (1.0-tx) + row0[1] * tx;
+    double bot = row1[0] * (1.0-tx) + row1[1] * tx;
+    elev = top * (1.0-ty) + bot * ty;
+
+    return true;
+}
+
+ElevationSampler::ElevationSampler(CoordSystem *coordSys,CoordSystemDisplayAdapter *coordAdapter)
+    : coordSys(coordSys), coordAdapter(coordAdapter), maxLevel(-1)
+{
+}
+
+void ElevationSampler::addTile(ElevationGridTileRef tile,const GeoMbr &area)
+{
+    tiles.push_back(tile);
+    maxLevel = std::max(maxLevel,tile->ident.level);
+
+    // Rows and columns of samples in geographic.  Lines of constant X and Y
+    //  in the tile system are meridians and parallels, so we can do them separately.
+    Point2d cell = tile->cellSize();
+    Point2d mid = (tile->ll + tile->ur)/2.0;
+    for (int ix=0;ix<tile->sizeX;ix++)
+    {
+        double lon = coordSys->localToGeographicD(Point3d(tile->ll.x()+ix*cell.x(),mid.y(),0.0)).x();
+        if (lon >= area.ll().x() && lon <= area.ur().x())
+            xLines.push_back(lon);
+    }
+    for (int iy=0;iy<tile->sizeY;iy++)
+    {
+        double lat = coordSys->localToGeographicD(Point3d(mid.x(),tile->ll.y()+iy*cell.y(),0.0)).y();
+        if (lat >= area.ll().y() && lat <= area.ur().y())
+            yLines.push_back(lat);
+    }
+}
+
+// Neighboring tiles share their edges
+static void SortAndMerge(std::vector<double> &lines)
+{
+    std::sort(lines.begin(),lines.end());
+    std::vector<double> merged;
+    merged.reserve(lines.size());
+    for (double line : lines)
+        if (merged.empty() || line - merged.back() > 1e-12)
+            merged.push_back(line);
+    lines.swap(merged);
+}
+
+void ElevationSampler::finish()
+{
+    // Most detailed first
+    std::stable_sort(tiles.begin(),tiles.end(),
+                     [](const ElevationGridTileRef &a,const ElevationGridTileRef &b) { return a->ident.level > b->ident.level; });
+    SortAndMerge(xLines);
+    SortAndMerge(yLines);
+}
+
+bool ElevationSampler::elevationAt(const Point2d &geoPt,double &elev) const
+{
+    if (tiles.empty())
+        return false;
+
+    // Subdivided points land right on tile edges, so let the tiles do the bounds check
+    Point3d localPt = coordSys->geographicToLocal(geoPt);
+    for (const auto &tile : tiles)
+        if (tile->interpolate(Point2d(localPt.x(),localPt.y()),elev))
+            return true;
+
+    return false;
+}
+
+Point3d ElevationSampler::localPointFor(const Point2d &geoPt) const
+{
+    Point3d localPt = coordAdapter->getCoordSystem()->geographicToLocal(geoPt);
+    double elev;
+    if (elevationAt(geoPt,elev))
+    {
+        // The globe wants meters, flat maps are in units of the earth's radius
+        localPt.z() = coordAdapter->isFlat() ? elev / EarthRadius : elev;
+    }
+
+    return localPt;
+}
+
+void ElevationSampler::addCrossings(const std::vector<double> &lines,double a,double b,std::vector<double> &ts) const
+{
+    if (a == b)
+        return;
+    double minVal = std::min(a,b), maxVal = std::max(a,b);
+    auto it = std::upper_bound(lines.begin(),lines.end(),minVal);
+    for (;it != lines.end() && *it < maxVal;++it)
+        ts.push_back((*it - a) / (b - a));
+}
+
+void ElevationSampler::subdivideEdges(const VectorRing &inPts,VectorRing &outPts,bool closed) const
+{
+    if (inPts.empty())
+        return;
+
+    int numEdges = (int)inPts.size() - (closed ? 0 : 1);
+    std::vector<double> ts;
+    for (int ii=0;ii<numEdges;ii++)
+    {
+        const Point2f &pa = inPts[ii];
+        const Point2f &pb = inPts[(ii+1)%inPts.size()];
+        outPts.push_back(pa);
+
+        ts.clear();
+        addCrossings(xLines,pa.x(),pb.x(),ts);
+        addCrossings(yLines,pa.y(),pb.y(),ts);
+        std::sort(ts.begin(),ts.end());
+        for (double t : ts)
+            if (t > 1e-6 && t < 1.0-1e-6)
+                outPts.push_back(Point2f(pa.x() + t*(pb.x()-pa.x()),pa.y() + t*(pb.y()-pa.y())));
+    }
+    if (!closed)
+        outPts.push_back(inPts.back());
+}
+
+bool ElevationSampler::gridForAreals(Point2f &org,Point2f &spacing) const
+{
+    if (tiles.empty())
+        return false;
+
+    const ElevationGridTileRef &tile = tiles.front();
+    if (tile->sizeX < 2 || tile->sizeY < 2)
+        return false;
+    org = tile->geoMbr.ll();
+    spacing = Point2f((tile->geoMbr.ur().x()-tile->geoMbr.ll().x())/(tile->sizeX-1),
+                      (tile->geoMbr.ur().y()-tile->geoMbr.ll().y())/(tile->sizeY-1));
+
+    return spacing.x() > 0.0 && spacing.y() > 0.0;
+}
+
+ElevationManager::ElevationManager()
+    : coordSys(NULL), meshIntersect(new MeshIntersectable()), meshIntersectRegistered(false)
+{
+    pthread_mutex_init(&elevLock, NULL);
+}
+
+ElevationManager::~ElevationManager()
+{
+    if (meshIntersectRegistered && scene)
+    {
+        IntersectionManager *intersectManager = (IntersectionManager *)scene->getManager(kWKIntersectionManager);
+        if (intersectManager)
+            intersectManager->removeIntersectable(meshIntersect);
+    }
+    delete meshIntersect;
+
+    pthread_mutex_destroy(&elevLock);
+}
+
+void ElevationManager::setCoordSystem(CoordSystem *newCoordSys)
+{
+    pthread_mutex_lock(&elevLock);
+    coordSys = newCoordSys;
+    pthread_mutex_unlock(&elevLock);
+}
+
+CoordSystem *ElevationManager::getCoordSystem()
+{
+    if (coordSys)
+        return coordSys;
+    return scene->getCoordAdapter()->getCoordSystem();
+}
+
+MeshBVHRef ElevationManager::makeBVH(const ElevationGridTile &tile,CoordSystem *tileSys)
+{
+    if (tile.sizeX < 2 || tile.sizeY < 2 || tile.samples.size() < (size_t)tile.sizeX*tile.sizeY)
+        return MeshBVHRef();
+
+    // Samples go through geographic to the scene's system, the same way the draped vectors do
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    CoordSystem *sceneSys = coordAdapter->getCoordSystem();
+    bool isFlat = coordAdapter->isFlat();
+    Point2d cell = tile.cellSize();
+    Point3dVector pts;
+    pts.reserve(tile.sizeX*tile.sizeY);
+    for (int iy=0;iy<tile.sizeY;iy++)
+        for (int ix=0;ix<tile.sizeX;ix++)
+        {
+            GeoCoord geoPt = tileSys->localToGeographic(Point3d(tile.ll.x()+ix*cell.x(),tile.ur.y()-iy*cell.y(),0.0));
+            Point3d localPt = sceneSys->geographicToLocal3d(geoPt);
+            float elev = tile.samples[iy*tile.sizeX+ix];
+            localPt.z() = isFlat ? elev / EarthRadius : elev;
+            pts.push_back(coordAdapter->localToDisplay(localPt));
+        }
+
+    // Two triangles per cell
+    std::vector<int> triVerts;
+    triVerts.reserve(6*(tile.sizeX-1)*(tile.sizeY-1));
+    for (int iy=0;iy<tile.sizeY-1;iy++)
+        for (int ix=0;ix<tile.sizeX-1;ix++)
+        {
+            int v0 = iy*tile.sizeX+ix, v1 = v0+1, v2 = v0+tile.sizeX+1, v3 = v0+tile.sizeX;
+            triVerts.push_back(v0);  triVerts.push_back(v1);  triVerts.push_back(v2);
+            triVerts.push_back(v2);  triVerts.push_back(v3);  triVerts.push_back(v0);
+        }
+
+    MeshBVHRef bvh(new MeshBVH());
+    bvh->addTriangles(&pts[0],(int)pts.size(),triVerts);
+    meshIntersect->buildBVH(bvh);
+
+    return bvh;
+}
+
+void ElevationManager::removeTileIntersect(const Quadtree::Identifier &ident)
+{
+    auto it = tileIntersectIDs.find(ident);
+    if (it == tileIntersectIDs.end())
+        return;
+
+    meshIntersect->removeGroup(it->second);
+    tileIntersectIDs.erase(it);
+}
+
+void ElevationManager::registerMeshIntersect()
+{
+    if (meshIntersectRegistered)
+        return;
+
+    IntersectionManager *intersectManager = (IntersectionManager *)scene->getManager(kWKIntersectionManager);
+    if (intersectManager)
+    {
+        intersectManager->addIntersectable(meshIntersect);
+        meshIntersectRegistered = true;
+    }
+}
+
+void ElevationManager::addElevationTile(ElevationGridTileRef tile,ChangeSet &changes)
+{
+    std::vector<ElevationGridTileRef> newTiles;
+    newTiles.push_back(tile);
+    addElevationTiles(newTiles,changes);
+}
+
+void ElevationManager::addElevationTiles(const std::vector<ElevationGridTileRef> &newTiles,ChangeSet &changes)
+{
+    std::vector<GeoMbr> changedMbrs;
+
+    pthread_mutex_lock(&elevLock);
+
+    CoordSystem *tileSys = getCoordSystem();
+    for (const auto &tile : newTiles)
+    {
+        tile->geoMbr.reset();
+        tile->geoMbr.addGeoCoord(tileSys->localToGeographic(Point3d(tile->ll.x(),tile->ll.y(),0.0)));
+        tile->geoMbr.addGeoCoord(tileSys->localToGeographic(Point3d(tile->ur.x(),tile->ur.y(),0.0)));
+        tiles[tile->ident] = tile;
+
+        // The surface replaces any we had for the tile.  It's skipped for taps until the BVH is built.
+        removeTileIntersect(tile->ident);
+        MeshBVHRef bvh = makeBVH(*tile,tileSys);
+        if (bvh)
+        {
+            SimpleIdentity groupID = Identifiable::genId();
+            meshIntersect->addInstance(groupID,bvh,Eigen::Matrix4d::Identity(),EmptyIdentity,DrawVisibleInvalid,DrawVisibleInvalid,true);
+            tileIntersectIDs[tile->ident] = groupID;
+            registerMeshIntersect();
+        }
+    }
+
+    // Only tiles that are now the most detailed in their area change anything
+    for (const auto &tile : newTiles)
+    {
+        GeoCoord mid = tile->geoMbr.mid();
+        bool covered = false;
+        for (const auto &it : tiles)
+            if (it.second->ident.level > tile->ident.level && it.second->geoMbr.inside(mid))
+            {
+                covered = true;
+                break;
+            }
+        if (!covered)
+            changedMbrs.push_back(tile->geoMbr);
+    }
+
+    pthread_mutex_unlock(&elevLock);
+
+    if (changedMbrs.empty())
+        return;
+
+    // Rebuild anything draped over the new tiles
+    VectorManager *vecManager = (VectorManager *)scene->getManager(kWKVectorManager);
+    if (vecManager)
+        vecManager->elevationChanged(changedMbrs,changes);
+    WideVectorManager *wideVecManager = (WideVectorManager *)scene->getManager(kWKWideVectorManager);
+    if (wideVecManager)
+        wideVecManager->elevationChanged(changedMbrs,changes);
+}
+
+void ElevationManager::removeElevationTiles(const std::vector<Quadtree::Identifier> &idents)
+{
+    pthread_mutex_lock(&elevLock);
+    for (const auto &ident : idents)
+    {
+        tiles.erase(ident);
+        removeTileIntersect(ident);
+    }
+    pthread_mutex_unlock(&elevLock);
+}
+
+int ElevationManager::getNumTiles()
+{
+    pthread_mutex_lock(&elevLock);
+    int numTiles = (int)tiles.size();
+    pthread_mutex_unlock(&elevLock);
+
+    return numTiles;
+}
+
+bool ElevationManager::elevationAt(const Point2d &geoPt,double &elev)
+{
+    GeoMbr mbr;
+    mbr.addGeoCoord(GeoCoord(geoPt.x(),geoPt.y()));
+    ElevationSamplerRef sampler = makeSampler(mbr);
+
+    return sampler->elevationAt(geoPt,elev);
+}
+
+ElevationSamplerRef ElevationManager::makeSampler(const GeoMbr &mbr)
+{
+    pthread_mutex_lock(&elevLock);
+
+    ElevationSamplerRef sampler(new ElevationSampler(getCoordSystem(),scene->getCoordAdapter()));
+    for (const auto &it : tiles)
+        if (it.second->geoMbr.overlaps(mbr))
+            sampler->addTile(it.second,mbr);
+
+    pthread_mutex_unlock(&elevLock);
+
+    sampler->finish();
+
+    return sampler;
+}
+
+}
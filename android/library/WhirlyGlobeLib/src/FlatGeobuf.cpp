@@ -0,0 +1,811 @@
+/*
+ *  FlatGeobuf.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <string.h>
+#import <math.h>
+#import <algorithm>
+#import "FlatGeobuf.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+// Size of the node entries in the index
+static const size_t FGBNodeSize = 40;
+// Smallest read we'll do for features
+static const size_t FGBWindowSize = 256*1024;
+// Feature sizes beyond this are assumed to be corrupt
+static const uint32_t FGBMaxFeatureSize = 512*1024*1024;
+// Nested geometry collections deeper than this are ignored
+static const int FGBMaxDepth = 16;
+
+template<typename T> static T FGBRead(const unsigned char *data)
+{
+    T val;
+    memcpy(&val,data,sizeof(T));
+    return val;
+}
+
+/// A flatbuffers table, read in place with bounds checks
+class FGBTable
+{
+public:
+    FGBTable() : buf(NULL), len(0), table(0), vtable(0), vtableLen(0) { }
+
+    // Set up with a table at the given position
+    bool init(const unsigned char *inBuf,size_t inLen,size_t pos)
+    {
+        buf = inBuf;  len = inLen;  table = pos;
+        if (pos + 4 > len)
+            return false;
+        int64_t vt = (int64_t)pos - FGBRead<int32_t>(buf+pos);
+        if (vt < 0 || vt + 4 > (int64_t)len)
+            return false;
+        vtable = (size_t)vt;
+        vtableLen = FGBRead<uint16_t>(buf+vtable);
+        return vtableLen >= 4 && vtable + vtableLen <= len;
+    }
+
+    // The root table of a buffer
+    bool initRoot(const unsigned char *inBuf,size_t inLen)
+    {
+        if (inLen < 4)
+            return false;
+        return init(inBuf,inLen,FGBRead<uint32_t>(inBuf));
+    }
+
+    // Position of a field, or zero if it's not there
+    size_t field(int which,size_t size) const
+    {
+        size_t entry = 4 + 2*which;
+        if (entry + 2 > vtableLen)
+            return 0;
+        uint16_t off = FGBRead<uint16_t>(buf+vtable+entry);
+        if (off == 0 || table + off + size > len)
+            return 0;
+        return table + off;
+    }
+
+    template<typename T> T get(int which,T defVal) const
+    {
+        size_t pos = field(which,sizeof(T));
+        return pos ? FGBRead<T>(buf+pos) : defVal;
+    }
+
+    // Follow an offset field
+    size_t indirect(int which) const
+    {
+        size_t pos = field(which,4);
+        if (!pos)
+            return 0;
+        size_t target = pos + FGBRead<uint32_t>(buf+pos);
+        return target < len ? target : 0;
+    }
+
+    // Vector of elements of the given size
+    bool vector(int which,size_t elemSize,const unsigned char *&data,uint32_t &count) const
+    {
+        size_t pos = indirect(which);
+        if (!pos || pos + 4 > len)
+            return false;
+        count = FGBRead<uint32_t>(buf+pos);
+        if ((uint64_t)count * elemSize > len - pos - 4)
+            return false;
+        data = buf + pos + 4;
+        return true;
+    }
+
+    bool string(int which,std::string &str) const
+    {
+        const unsigned char *data;
+        uint32_t count;
+        if (!vector(which,1,data,count))
+            return false;
+        str.assign((const char *)data,count);
+        return true;
+    }
+
+    // Table from a vector of tables
+    bool tableAt(int which,uint32_t index,FGBTable &ret) const
+    {
+        const unsigned char *data;
+        uint32_t count;
+        if (!vector(which,4,data,count) || index >= count)
+            return false;
+        size_t pos = (data - buf) + 4*index;
+        return ret.init(buf,len,pos + FGBRead<uint32_t>(buf+pos));
+    }
+
+    bool subTable(int which,FGBTable &ret) const
+    {
+        size_t pos = indirect(which);
+        return pos && ret.init(buf,len,pos);
+    }
+
+    const unsigned char *buf;
+    size_t len;
+    size_t table,vtable;
+    uint16_t vtableLen;
+};
+
+// Header fields
+enum {FGBHeaderName=0,FGBHeaderEnvelope,FGBHeaderGeometryType,FGBHeaderHasZ,FGBHeaderHasM,FGBHeaderHasT,FGBHeaderHasTM,
+    FGBHeaderColumns,FGBHeaderFeaturesCount,FGBHeaderIndexNodeSize,FGBHeaderCrs};
+// Column fields
+enum {FGBColumnName=0,FGBColumnType};
+// Crs fields
+enum {FGBCrsOrg=0,FGBCrsCode};
+// Geometry fields
+enum {FGBGeomEnds=0,FGBGeomXY,FGBGeomZ,FGBGeomM,FGBGeomT,FGBGeomTM,FGBGeomType,FGBGeomParts};
+// Feature fields
+enum {FGBFeatureGeometry=0,FGBFeatureProperties,FGBFeatureColumns};
+
+FlatGeobufFile::FlatGeobufFile(const std::string &fileName,CoordSystem *coordSys)
+    : fileName(fileName), coordSys(coordSys), degrees(true), fd(-1), fileSize(0),
+    geomType(FGBUnknown), hasZ(false), hasM(false), numFeatures(0), indexNodeSize(0), srsID(0),
+    hasEnvelope(false), indexStart(0), featuresStart(0)
+{
+}
+
+FlatGeobufFile::~FlatGeobufFile()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+bool FlatGeobufFile::readAt(uint64_t offset,void *data,size_t len) const
+{
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t ret = pread(fd,(char *)data + done,len - done,(off_t)(offset + done));
+        if (ret <= 0)
+            return false;
+        done += ret;
+    }
+
+    return true;
+}
+
+bool FlatGeobufFile::open()
+{
+    fd = ::open(fileName.c_str(),O_RDONLY);
+    if (fd < 0)
+    {
+        error = "Couldn't open " + fileName;
+        return false;
+    }
+    off_t end = lseek(fd,0,SEEK_END);
+    fileSize = end > 0 ? end : 0;
+
+    // Magic number, then the size prefixed header
+    unsigned char start[12];
+    if (!readAt(0,start,12) || memcmp(start,"fgb",3) || memcmp(start+4,"fgb",3))
+    {
+        error = "Not a FlatGeobuf file";
+        close(fd);  fd = -1;
+        return false;
+    }
+    if (start[3] != 3)
+        WHIRLYKIT_LOGW("FlatGeobufFile: Version %d in %s, reading it as version 3",(int)start[3],fileName.c_str());
+    uint32_t headerSize = FGBRead<uint32_t>(start+8);
+    std::vector<unsigned char> header(headerSize);
+    if (headerSize < 4 || 12 + (uint64_t)headerSize > fileSize || !readAt(12,&header[0],headerSize) || !readHeader(&header[0],headerSize))
+    {
+        if (error.empty())
+            error = "Bad header in " + fileName;
+        close(fd);  fd = -1;
+        return false;
+    }
+    indexStart = 12 + headerSize;
+
+    // Work out the levels of the packed tree, root first
+    uint64_t indexSize = 0;
+    if (hasIndex())
+    {
+        uint16_t nodeSize = std::max(indexNodeSize,(uint16_t)2);
+        std::vector<uint64_t> levelNumNodes;
+        uint64_t n = numFeatures,numNodes = n;
+        levelNumNodes.push_back(n);
+        do
+        {
+            n = (n + nodeSize - 1) / nodeSize;
+            numNodes += n;
+            levelNumNodes.push_back(n);
+        } while (n != 1);
+        uint64_t nodeEnd = numNodes;
+        for (auto levelNodes : levelNumNodes)
+        {
+            levelBounds.push_back(std::make_pair(nodeEnd - levelNodes,nodeEnd));
+            nodeEnd -= levelNodes;
+        }
+        indexSize = numNodes * FGBNodeSize;
+
+        // Keep everything above the leaves around
+        uint64_t leafStart = levelBounds[0].first;
+        if (indexStart + indexSize > fileSize || !readNodes(0,leafStart,upperNodes))
+        {
+            error = "Couldn't read the index in " + fileName;
+            close(fd);  fd = -1;
+            return false;
+        }
+    }
+    featuresStart = indexStart + indexSize;
+
+    if (!coordSys)
+    {
+        degrees = srsID == 0 || srsID == 4326;
+        if (!degrees)
+            WHIRLYKIT_LOGW("FlatGeobufFile: %s is in EPSG:%d and no coordinate system was given",fileName.c_str(),srsID);
+    } else
+        degrees = false;
+
+    return true;
+}
+
+bool FlatGeobufFile::readHeader(const unsigned char *data,size_t len)
+{
+    FGBTable header;
+    if (!header.initRoot(data,len))
+        return false;
+
+    header.string(FGBHeaderName,name);
+    const unsigned char *env;
+    uint32_t envCount;
+    if (header.vector(FGBHeaderEnvelope,8,env,envCount) && envCount >= 4)
+    {
+        hasEnvelope = true;
+        envLL = Point2d(FGBRead<double>(env),FGBRead<double>(env+8));
+        envUR = Point2d(FGBRead<double>(env+16),FGBRead<double>(env+24));
+    }
+    geomType = (FlatGeobufGeometryType)header.get<uint8_t>(FGBHeaderGeometryType,0);
+    hasZ = header.get<uint8_t>(FGBHeaderHasZ,0);
+    hasM = header.get<uint8_t>(FGBHeaderHasM,0);
+    if (header.get<uint8_t>(FGBHeaderHasT,0) || header.get<uint8_t>(FGBHeaderHasTM,0))
+        WHIRLYKIT_LOGW("FlatGeobufFile: Ignoring T values in %s",fileName.c_str());
+    numFeatures = header.get<uint64_t>(FGBHeaderFeaturesCount,0);
+    indexNodeSize = header.get<uint16_t>(FGBHeaderIndexNodeSize,16);
+
+    FGBTable col;
+    for (uint32_t ii=0;header.tableAt(FGBHeaderColumns,ii,col);ii++)
+    {
+        FlatGeobufColumn column;
+        col.string(FGBColumnName,column.name);
+        column.type = (FlatGeobufColumnType)col.get<uint8_t>(FGBColumnType,0);
+        columns.push_back(column);
+    }
+
+    FGBTable crs;
+    if (header.subTable(FGBHeaderCrs,crs))
+        srsID = crs.get<int32_t>(FGBCrsCode,0);
+
+    return true;
+}
+
+bool FlatGeobufFile::getExtents(Point2d &ll,Point2d &ur) const
+{
+    if (hasEnvelope)
+    {
+        ll = envLL;  ur = envUR;
+        return true;
+    }
+    if (!upperNodes.empty())
+    {
+        ll = Point2d(upperNodes[0].minX,upperNodes[0].minY);
+        ur = Point2d(upperNodes[0].maxX,upperNodes[0].maxY);
+        return true;
+    }
+
+    return false;
+}
+
+bool FlatGeobufFile::readNodes(uint64_t first,uint64_t count,std::vector<FlatGeobufNode> &nodes) const
+{
+    nodes.resize(count);
+    if (count == 0)
+        return true;
+    std::vector<unsigned char> data(count * FGBNodeSize);
+    if (!readAt(indexStart + first * FGBNodeSize,&data[0],data.size()))
+        return false;
+    for (uint64_t ii=0;ii<count;ii++)
+    {
+        const unsigned char *ptr = &data[ii*FGBNodeSize];
+        FlatGeobufNode &node = nodes[ii];
+        node.minX = FGBRead<double>(ptr);
+        node.minY = FGBRead<double>(ptr+8);
+        node.maxX = FGBRead<double>(ptr+16);
+        node.maxY = FGBRead<double>(ptr+24);
+        node.offset = FGBRead<uint64_t>(ptr+32);
+    }
+
+    return true;
+}
+
+bool FlatGeobufFile::search(const Point2d &ll,const Point2d &ur,std::vector<uint64_t> &offsets) const
+{
+    if (!isValid() || !hasIndex())
+        return false;
+
+    uint64_t nodeSize = std::max(indexNodeSize,(uint16_t)2);
+    std::vector<FlatGeobufNode> leaves;
+    // Node index and level to look at, starting at the root
+    std::vector<std::pair<uint64_t,int> > toCheck;
+    toCheck.push_back(std::make_pair(0,(int)levelBounds.size()-1));
+    while (!toCheck.empty())
+    {
+        uint64_t nodeIndex = toCheck.back().first;
+        int level = toCheck.back().second;
+        toCheck.pop_back();
+        if (level < 0 || nodeIndex < levelBounds[level].first || nodeIndex >= levelBounds[level].second)
+            return false;
+        uint64_t nodeEnd = std::min(nodeIndex + nodeSize,levelBounds[level].second);
+
+        const FlatGeobufNode *nodes;
+        if (level == 0)
+        {
+            if (!readNodes(nodeIndex,nodeEnd-nodeIndex,leaves))
+                return false;
+            nodes = &leaves[0];
+        } else {
+            if (nodeEnd > upperNodes.size())
+                return false;
+            nodes = &upperNodes[nodeIndex];
+        }
+
+        for (uint64_t ii=0;ii<nodeEnd-nodeIndex;ii++)
+        {
+            const FlatGeobufNode &node = nodes[ii];
+            if (node.maxX < ll.x() || node.minX > ur.x() || node.maxY < ll.y() || node.minY > ur.y())
+                continue;
+            if (level == 0)
+                offsets.push_back(node.offset);
+            else
+                toCheck.push_back(std::make_pair(node.offset,level-1));
+        }
+    }
+
+    // Reading in file order keeps the reads together
+    std::sort(offsets.begin(),offsets.end());
+    return true;
+}
+
+void FlatGeobufFile::geoBoundsToLocal(const GeoMbr &mbr,Point2d &ll,Point2d &ur) const
+{
+    if (!coordSys)
+    {
+        if (degrees)
+        {
+            ll = Point2d(RadToDeg(mbr.ll().x()),RadToDeg(mbr.ll().y()));
+            ur = Point2d(RadToDeg(mbr.ur().x()),RadToDeg(mbr.ur().y()));
+        } else {
+            ll = Point2d(mbr.ll().x(),mbr.ll().y());
+            ur = Point2d(mbr.ur().x(),mbr.ur().y());
+        }
+        return;
+    }
+
+    // Run around the edges, since the bounds can bend in the file's system
+    static const int EdgeSamples = 8;
+    ll = Point2d(MAXFLOAT,MAXFLOAT);
+    ur = Point2d(-MAXFLOAT,-MAXFLOAT);
+    for (int ix=0;ix<=EdgeSamples;ix++)
+        for (int iy=0;iy<=EdgeSamples;iy++)
+        {
+            if (ix != 0 && ix != EdgeSamples && iy != 0 && iy != EdgeSamples)
+                continue;
+            Point2d geo(mbr.ll().x() + (mbr.ur().x()-mbr.ll().x()) * ix / EdgeSamples,
+                        mbr.ll().y() + (mbr.ur().y()-mbr.ll().y()) * iy / EdgeSamples);
+            Point3d loc = coordSys->geographicToLocal(geo);
+            ll = ll.cwiseMin(Point2d(loc.x(),loc.y()));
+            ur = ur.cwiseMax(Point2d(loc.x(),loc.y()));
+        }
+}
+
+bool FlatGeobufFile::readGeoFeatures(const GeoMbr &mbr,ShapeSet &shapes,const StringSet *filter) const
+{
+    Point2d ll,ur;
+    geoBoundsToLocal(mbr,ll,ur);
+    return readFeatures(ll,ur,shapes,filter);
+}
+
+bool FlatGeobufFile::readFeatures(const Point2d &ll,const Point2d &ur,ShapeSet &shapes,const StringSet *filter) const
+{
+    if (!isValid())
+        return false;
+
+    FlatGeobufWindow window(this);
+    std::vector<uint64_t> offsets;
+    if (search(ll,ur,offsets))
+    {
+        for (auto offset : offsets)
+            readFeature(window,offset,shapes,filter,&ll,&ur);
+        return true;
+    }
+
+    // No index, so read through it all
+    uint64_t offset = 0;
+    while ((offset = readFeature(window,offset,shapes,filter,&ll,&ur)) != 0)
+        ;
+
+    return true;
+}
+
+FlatGeobufWindow::FlatGeobufWindow(const FlatGeobufFile *file)
+    : file(file), base(0), size(0)
+{
+}
+
+const unsigned char *FlatGeobufWindow::read(uint64_t offset,size_t len)
+{
+    if (offset >= base && offset + len <= base + size)
+        return &buf[offset - base];
+
+    if (offset + len > file->fileSize)
+        return NULL;
+    size_t toRead = std::max(len,FGBWindowSize);
+    toRead = (size_t)std::min((uint64_t)toRead,file->fileSize - offset);
+    if (buf.size() < toRead)
+        buf.resize(toRead);
+    if (!file->readAt(offset,&buf[0],toRead))
+    {
+        size = 0;
+        return NULL;
+    }
+    base = offset;
+    size = toRead;
+
+    return &buf[0];
+}
+
+/// Decodes a feature's geometry right into shapes
+class FGBGeometryDecoder
+{
+public:
+    FGBGeometryDecoder(CoordSystem *coordSys,bool degrees)
+    : coordSys(coordSys), degrees(degrees), rawLL(MAXFLOAT,MAXFLOAT), rawUR(-MAXFLOAT,-MAXFLOAT)
+    {
+    }
+
+    Point2f convert(const unsigned char *xy)
+    {
+        Point2d pt(FGBRead<double>(xy),FGBRead<double>(xy+8));
+        rawLL = rawLL.cwiseMin(pt);
+        rawUR = rawUR.cwiseMax(pt);
+        if (coordSys)
+            pt = coordSys->localToGeographicD(Point3d(pt.x(),pt.y(),0.0));
+        else if (degrees)
+            pt = Point2d(DegToRad(pt.x()),DegToRad(pt.y()));
+        return Point2f((float)pt.x(),(float)pt.y());
+    }
+
+    void addPoints(const unsigned char *xy,uint32_t start,uint32_t end,VectorRing &pts)
+    {
+        pts.reserve(pts.size() + end - start);
+        for (uint32_t ii=start;ii<end;ii++)
+            pts.push_back(convert(xy + 16*ii));
+    }
+
+    bool decode(const FGBTable &geom,FlatGeobufGeometryType type,ShapeSet &shapes,int depth)
+    {
+        if (depth > FGBMaxDepth)
+            return false;
+        if (type == FGBUnknown)
+            type = (FlatGeobufGeometryType)geom.get<uint8_t>(FGBGeomType,0);
+
+        // Multi polygons and collections are made of parts
+        if (type == FGBMultiPolygon || type == FGBGeometryCollection)
+        {
+            FGBTable part;
+            bool ret = false;
+            for (uint32_t ii=0;geom.tableAt(FGBGeomParts,ii,part);ii++)
+                ret |= decode(part,type == FGBMultiPolygon ? FGBPolygon : FGBUnknown,shapes,depth+1);
+            return ret;
+        }
+
+        const unsigned char *xy = NULL,*ends = NULL;
+        uint32_t numXY = 0,numEnds = 0;
+        if (!geom.vector(FGBGeomXY,8,xy,numXY) || numXY < 2)
+            return false;
+        uint32_t numPts = numXY / 2;
+        geom.vector(FGBGeomEnds,4,ends,numEnds);
+
+        // Ring or line ranges from the ends
+        std::vector<std::pair<uint32_t,uint32_t> > ranges;
+        uint32_t start = 0;
+        for (uint32_t ii=0;ii<numEnds;ii++)
+        {
+            uint32_t end = std::min(FGBRead<uint32_t>(ends + 4*ii),numPts);
+            if (end > start)
+                ranges.push_back(std::make_pair(start,end));
+            start = end;
+        }
+        if (ranges.empty())
+            ranges.push_back(std::make_pair(0,numPts));
+
+        switch (type)
+        {
+            case FGBPoint:
+            case FGBMultiPoint:
+            {
+                VectorPointsRef pts = VectorPoints::createPoints();
+                addPoints(xy,0,numPts,pts->pts);
+                pts->initGeoMbr();
+                shapes.insert(pts);
+            }
+                break;
+            case FGBLineString:
+            case FGBMultiLineString:
+                for (const auto &range : ranges)
+                {
+                    VectorLinearRef lin = VectorLinear::createLinear();
+                    addPoints(xy,range.first,range.second,lin->pts);
+                    lin->initGeoMbr();
+                    shapes.insert(lin);
+                }
+                break;
+            case FGBPolygon:
+            {
+                VectorArealRef ar = VectorAreal::createAreal();
+                ar->loops.resize(ranges.size());
+                for (unsigned int ii=0;ii<ranges.size();ii++)
+                    addPoints(xy,ranges[ii].first,ranges[ii].second,ar->loops[ii]);
+                ar->initGeoMbr();
+                shapes.insert(ar);
+            }
+                break;
+            default:
+                return false;
+        }
+
+        return true;
+    }
+
+    CoordSystem *coordSys;
+    bool degrees;
+    Point2d rawLL,rawUR;
+};
+
+uint64_t FlatGeobufFile::readFeature(FlatGeobufWindow &window,uint64_t offset,ShapeSet &shapes,const StringSet *filter,const Point2d *ll,const Point2d *ur) const
+{
+    uint64_t pos = featuresStart + offset;
+    const unsigned char *sizePtr = window.read(pos,4);
+    if (!sizePtr)
+        return 0;
+    uint32_t size = FGBRead<uint32_t>(sizePtr);
+    const unsigned char *data = size < FGBMaxFeatureSize ? window.read(pos+4,size) : NULL;
+    FGBTable feature,geom;
+    if (!data || !feature.initRoot(data,size))
+    {
+        WHIRLYKIT_LOGW("FlatGeobufFile: Bad feature at offset %llu in %s",(unsigned long long)offset,fileName.c_str());
+        return 0;
+    }
+    uint64_t next = offset + 4 + size;
+
+    ShapeSet newShapes;
+    FGBGeometryDecoder decoder(coordSys,degrees);
+    if (!feature.subTable(FGBFeatureGeometry,geom) || !decoder.decode(geom,geomType,newShapes,0))
+        return next;
+    if (ll && ur && (decoder.rawLL.x() > ur->x() || decoder.rawUR.x() < ll->x() ||
+                     decoder.rawLL.y() > ur->y() || decoder.rawUR.y() < ll->y()))
+        return next;
+
+    // Features can have their own columns, though it's rare
+    std::vector<FlatGeobufColumn> featColumns;
+    FGBTable col;
+    for (uint32_t ii=0;feature.tableAt(FGBFeatureColumns,ii,col);ii++)
+    {
+        FlatGeobufColumn column;
+        col.string(FGBColumnName,column.name);
+        column.type = (FlatGeobufColumnType)col.get<uint8_t>(FGBColumnType,0);
+        featColumns.push_back(column);
+    }
+    const std::vector<FlatGeobufColumn> &cols = featColumns.empty() ? columns : featColumns;
+
+    // Properties are a column index followed by the value
+    Dictionary attrs;
+    const unsigned char *props;
+    uint32_t propsLen;
+    if (feature.vector(FGBFeatureProperties,1,props,propsLen))
+    {
+        uint32_t pp = 0;
+        while (pp + 2 <= propsLen)
+        {
+            uint16_t which = FGBRead<uint16_t>(props+pp);
+            pp += 2;
+            if (which >= cols.size())
+                break;
+            const FlatGeobufColumn &column = cols[which];
+            size_t valSize = 0;
+            switch (column.type)
+            {
+                case FGBByte: case FGBUByte: case FGBBool: valSize = 1; break;
+                case FGBShort: case FGBUShort: valSize = 2; break;
+                case FGBInt: case FGBUInt: case FGBFloat: valSize = 4; break;
+                case FGBLong: case FGBULong: case FGBDouble: valSize = 8; break;
+                default:
+                    if (pp + 4 > propsLen)
+                        break;
+                    valSize = 4 + FGBRead<uint32_t>(props+pp);
+                    break;
+            }
+            if (valSize == 0 || pp + valSize > propsLen)
+                break;
+            const unsigned char *val = props + pp;
+            pp += valSize;
+            if (filter && filter->find(column.name) == filter->end())
+                continue;
+
+            switch (column.type)
+            {
+                case FGBByte: attrs.setInt(column.name,FGBRead<int8_t>(val)); break;
+                case FGBUByte: attrs.setInt(column.name,FGBRead<uint8_t>(val)); break;
+                case FGBBool: attrs.setInt(column.name,FGBRead<uint8_t>(val) != 0); break;
+                case FGBShort: attrs.setInt(column.name,FGBRead<int16_t>(val)); break;
+                case FGBUShort: attrs.setInt(column.name,FGBRead<uint16_t>(val)); break;
+                case FGBInt: attrs.setInt(column.name,FGBRead<int32_t>(val)); break;
+                case FGBUInt:
+                {
+                    uint32_t iVal = FGBRead<uint32_t>(val);
+                    if (iVal <= INT32_MAX)
+                        attrs.setInt(column.name,(int)iVal);
+                    else
+                        attrs.setDouble(column.name,iVal);
+                }
+                    break;
+                case FGBLong:
+                case FGBULong:
+                {
+                    int64_t iVal = FGBRead<int64_t>(val);
+                    if (column.type == FGBLong ? (iVal >= INT32_MIN && iVal <= INT32_MAX) : (uint64_t)iVal <= INT32_MAX)
+                        attrs.setInt(column.name,(int)iVal);
+                    else
+                        attrs.setDouble(column.name,column.type == FGBLong ? (double)iVal : (double)(uint64_t)iVal);
+                }
+                    break;
+                case FGBFloat: attrs.setDouble(column.name,FGBRead<float>(val)); break;
+                case FGBDouble: attrs.setDouble(column.name,FGBRead<double>(val)); break;
+                case FGBString:
+                case FGBJson:
+                case FGBDateTime:
+                    attrs.setString(column.name,std::string((const char *)val+4,valSize-4));
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    for (auto shape : newShapes)
+        shape->setAttrDict(attrs);
+    shapes.insert(newShapes.begin(),newShapes.end());
+
+    return next;
+}
+
+FlatGeobufFeatureReader::FlatGeobufFeatureReader(FlatGeobufFileRef file)
+    : file(file), window(file.get()), hasBounds(false), started(false), done(false), useOffsets(false), which(0), nextOffset(0)
+{
+}
+
+FlatGeobufFeatureReader::~FlatGeobufFeatureReader()
+{
+}
+
+void FlatGeobufFeatureReader::setBounds(const Point2d &ll,const Point2d &ur)
+{
+    hasBounds = true;
+    boundsLL = ll;
+    boundsUR = ur;
+}
+
+void FlatGeobufFeatureReader::setGeoBounds(const GeoMbr &mbr)
+{
+    Point2d ll,ur;
+    file->geoBoundsToLocal(mbr,ll,ur);
+    setBounds(ll,ur);
+}
+
+bool FlatGeobufFeatureReader::isValid()
+{
+    return file && file->isValid();
+}
+
+void FlatGeobufFeatureReader::start()
+{
+    started = true;
+    if (!isValid())
+    {
+        done = true;
+        return;
+    }
+    if (hasBounds)
+        useOffsets = file->search(boundsLL,boundsUR,offsets);
+}
+
+VectorShapeRef FlatGeobufFeatureReader::getNextObject(const StringSet *filter)
+{
+    if (!started)
+        start();
+
+    const Point2d *ll = hasBounds ? &boundsLL : NULL;
+    const Point2d *ur = hasBounds ? &boundsUR : NULL;
+    while (pending.empty() && !done)
+    {
+        if (useOffsets)
+        {
+            if (which >= offsets.size())
+                done = true;
+            else
+                file->readFeature(window,offsets[which++],pending,filter,ll,ur);
+        } else {
+            uint64_t offset = nextOffset;
+            nextOffset = file->readFeature(window,offset,pending,filter,ll,ur);
+            if (nextOffset == 0)
+                done = true;
+        }
+    }
+    if (pending.empty())
+        return VectorShapeRef();
+
+    VectorShapeRef shape = *pending.begin();
+    pending.erase(pending.begin());
+    return shape;
+}
+
+bool FlatGeobufFeatureReader::readAll(ShapeSet &shapes)
+{
+    if (!isValid())
+        return false;
+
+    VectorShapeRef shape;
+    while ((shape = getNextObject(NULL)))
+        shapes.insert(shape);
+
+    return true;
+}
+
+FlatGeobufPagingSource::FlatGeobufPagingSource(FlatGeobufFileRef file,CoordSystem *coordSys,const Point2d &ll,const Point2d &ur,int minZoom,int maxZoom)
+    : file(file), coordSys(coordSys), ll(ll), ur(ur), minZoom(minZoom), maxZoom(maxZoom), hasFilter(false)
+{
+}
+
+GeoMbr FlatGeobufPagingSource::geoBoundsForTile(const Quadtree::Identifier &ident) const
+{
+    double span = 1 << ident.level;
+    Point2d tileSize((ur.x()-ll.x())/span,(ur.y()-ll.y())/span);
+    Point2d tileLL(ll.x() + ident.x * tileSize.x(),ll.y() + ident.y * tileSize.y());
+    Point2d tileUR = tileLL + tileSize;
+
+    Point2d geoLL = coordSys->localToGeographicD(Point3d(tileLL.x(),tileLL.y(),0.0));
+    Point2d geoUR = coordSys->localToGeographicD(Point3d(tileUR.x(),tileUR.y(),0.0));
+    return GeoMbr(GeoCoord(geoLL.x(),geoLL.y()),GeoCoord(geoUR.x(),geoUR.y()));
+}
+
+bool FlatGeobufPagingSource::fetchTile(const Quadtree::Identifier &ident,ShapeSet &shapes) const
+{
+    if (ident.level < minZoom || ident.level > maxZoom || !file->isValid())
+        return false;
+
+    return file->readGeoFeatures(geoBoundsForTile(ident),shapes,hasFilter ? &filterAttrs : NULL);
+}
+
+}
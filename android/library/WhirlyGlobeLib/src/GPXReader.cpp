@@ -0,0 +1,272 @@
+/*
+ *  GPXReader.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdlib.h>
+#import <stdio.h>
+#import <math.h>
+#import "GPXReader.h"
+#import "CoordSystem.h"
+
+namespace WhirlyKit
+{
+
+static std::string Trim(const std::string &str)
+{
+    size_t start = str.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+        return std::string();
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(start,end-start+1);
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static long DaysFromCivil(long y,unsigned m,unsigned d)
+{
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y-399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;
+    unsigned doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+    return era * 146097 + (long)doe - 719468;
+}
+
+bool GPXReader::ParseTime(const std::string &inStr,double &secs)
+{
+    std::string str = Trim(inStr);
+    int year,month,day,hour = 0,minute = 0;
+    double second = 0.0;
+    int numRead = 0;
+    if (sscanf(str.c_str(),"%d-%d-%d%n",&year,&month,&day,&numRead) != 3)
+        return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+    const char *ptr = str.c_str() + numRead;
+    long offset = 0;
+    if (*ptr == 'T' || *ptr == 't' || *ptr == ' ')
+    {
+        ptr++;
+        int timeRead = 0;
+        if (sscanf(ptr,"%d:%d%n",&hour,&minute,&timeRead) != 2)
+            return false;
+        ptr += timeRead;
+        if (*ptr == ':')
+        {
+            char *end;
+            second = strtod(ptr+1,&end);
+            ptr = end;
+        }
+        // Time zone
+        if (*ptr == '+' || *ptr == '-')
+        {
+            int tzHour = 0,tzMin = 0;
+            int sign = *ptr == '-' ? -1 : 1;
+            if (sscanf(ptr+1,"%d:%d",&tzHour,&tzMin) < 1)
+                return false;
+            // Also handle +hhmm
+            if (tzHour > 99)
+            {
+                tzMin = tzHour % 100;
+                tzHour /= 100;
+            }
+            offset = sign * (tzHour * 3600 + tzMin * 60);
+        }
+    }
+
+    secs = DaysFromCivil(year,month,day) * 86400.0 + hour * 3600.0 + minute * 60.0 + second - offset;
+    return true;
+}
+
+GPXReader::GPXReader()
+    : segment(0)
+{
+}
+
+GPXReader::~GPXReader()
+{
+}
+
+bool GPXReader::readFile(const std::string &fileName)
+{
+    FILE *fp = fopen(fileName.c_str(),"rb");
+    if (!fp)
+    {
+        error = "Couldn't open " + fileName;
+        return false;
+    }
+
+    XMLStreamReader reader(this);
+    bool ret = reader.parseFile(fp);
+    fclose(fp);
+    if (!ret)
+        error = reader.getError();
+
+    return ret;
+}
+
+bool GPXReader::parse(const std::string &xml)
+{
+    XMLStreamReader reader(this);
+    if (!reader.parse(xml))
+    {
+        error = reader.getError();
+        return false;
+    }
+
+    return true;
+}
+
+void GPXReader::startElement(const std::string &name,const XMLAttributes &attrs)
+{
+    elements.push_back(name);
+    text.clear();
+
+    if (name == "wpt" || name == "rtept" || name == "trkpt")
+    {
+        curPoint = GPXPoint();
+        auto lonIt = attrs.find("lon");
+        auto latIt = attrs.find("lat");
+        if (lonIt != attrs.end())
+            curPoint.lon = atof(lonIt->second.c_str());
+        if (latIt != attrs.end())
+            curPoint.lat = atof(latIt->second.c_str());
+        if (name == "wpt")
+            featureAttrs.clear();
+    } else if (name == "rte")
+    {
+        featureAttrs.clear();
+        linePoints.clear();
+    } else if (name == "trk")
+    {
+        featureAttrs.clear();
+        segment = 0;
+    } else if (name == "trkseg")
+        linePoints.clear();
+}
+
+void GPXReader::characters(const std::string &newText)
+{
+    text += newText;
+}
+
+void GPXReader::endElement(const std::string &name)
+{
+    std::string parent = elements.size() > 1 ? elements[elements.size()-2] : std::string();
+    bool inPoint = parent == "wpt" || parent == "rtept" || parent == "trkpt";
+
+    if (name == "ele" && inPoint)
+    {
+        curPoint.ele = atof(text.c_str());
+        curPoint.hasEle = true;
+    } else if (name == "time" && inPoint)
+    {
+        curPoint.hasTime = ParseTime(text,curPoint.time);
+        if (parent == "wpt")
+            featureAttrs.setString("time",Trim(text));
+    } else if ((name == "name" || name == "desc" || name == "cmt" || name == "sym" || name == "type" || name == "src") &&
+               (parent == "wpt" || parent == "rte" || parent == "trk"))
+        featureAttrs.setString(name,Trim(text));
+    else if (name == "number" && (parent == "rte" || parent == "trk"))
+        featureAttrs.setInt("number",atoi(text.c_str()));
+    else if (name == "wpt")
+    {
+        VectorPointsRef pts = VectorPoints::createPoints();
+        pts->pts.push_back(GeoCoord::CoordFromDegrees(curPoint.lon,curPoint.lat));
+        pts->initGeoMbr();
+        Dictionary attrs(featureAttrs);
+        attrs.setString("gpxType","waypoint");
+        if (curPoint.hasEle)
+            attrs.setDouble("ele",curPoint.ele);
+        emit(pts,attrs);
+    } else if (name == "rtept" || name == "trkpt")
+        linePoints.push_back(curPoint);
+    else if (name == "rte")
+        finishLine("route",-1);
+    else if (name == "trkseg")
+        finishLine("track",segment++);
+
+    elements.pop_back();
+    text.clear();
+}
+
+void GPXReader::finishLine(const std::string &gpxType,int whichSeg)
+{
+    if (linePoints.empty())
+        return;
+
+    Dictionary attrs(featureAttrs);
+    attrs.setString("gpxType",gpxType);
+    if (whichSeg >= 0)
+        attrs.setInt("segment",whichSeg);
+
+    // Times relative to the first point, if they all have one
+    bool allTimes = true,allEle = true;
+    for (const auto &pt : linePoints)
+    {
+        allTimes &= pt.hasTime;
+        allEle &= pt.hasEle;
+    }
+    if (allTimes)
+    {
+        double startTime = linePoints.front().time;
+        attrs.setDouble("startTime",startTime);
+        attrs.setDouble("endTime",linePoints.back().time);
+        attrs.setDouble("duration",linePoints.back().time - startTime);
+        std::string times;
+        char num[32];
+        for (unsigned int ii=0;ii<linePoints.size();ii++)
+        {
+            snprintf(num,sizeof(num),ii > 0 ? ",%g" : "%g",linePoints[ii].time - startTime);
+            times += num;
+        }
+        attrs.setString("times",times);
+    }
+
+    if (allEle)
+    {
+        VectorLinear3dRef lin = VectorLinear3d::createLinear();
+        lin->pts.reserve(linePoints.size());
+        for (const auto &pt : linePoints)
+            lin->pts.push_back(Point3d(DegToRad(pt.lon),DegToRad(pt.lat),pt.ele));
+        lin->initGeoMbr();
+        emit(lin,attrs);
+    } else {
+        VectorLinearRef lin = VectorLinear::createLinear();
+        lin->pts.reserve(linePoints.size());
+        for (const auto &pt : linePoints)
+            lin->pts.push_back(GeoCoord::CoordFromDegrees(pt.lon,pt.lat));
+        lin->initGeoMbr();
+        emit(lin,attrs);
+    }
+    linePoints.clear();
+}
+
+void GPXReader::emit(VectorShapeRef shape,Dictionary &attrs)
+{
+    shape->setAttrDict(attrs);
+    if (featureCallback)
+    {
+        ShapeSet newShapes;
+        newShapes.insert(shape);
+        featureCallback(newShapes);
+    } else
+        shapes.insert(shape);
+}
+
+}
@@ -0,0 +1,661 @@
+/*
+ *  GeoPackage.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdint.h>
+#import <string.h>
+#import <strings.h>
+#import <algorithm>
+#import "GeoPackage.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+// Rows read by one query.  The connection goes back to the pool between pages.
+static const int GeoPackagePageSize = 256;
+
+// Format a number for SQL without losing precision
+static std::string SQLNumber(double val)
+{
+    char buf[64];
+    snprintf(buf,sizeof(buf),"%.17g",val);
+    return buf;
+}
+
+GeoPackageContents::GeoPackageContents()
+    : hasBounds(false), ll(0,0), ur(0,0), srsID(0), hasRTree(false)
+{
+}
+
+GeoPackageSRS::GeoPackageSRS()
+    : srsID(0), orgCoordSysID(0)
+{
+}
+
+bool GeoPackageSRS::isGeographic() const
+{
+    if (!strcasecmp(organization.c_str(),"EPSG") && orgCoordSysID == 4326)
+        return true;
+    // Undefined geographic, as the spec has it
+    if (srsID == 0)
+        return true;
+
+    return definition.compare(0,6,"GEOGCS") == 0;
+}
+
+GeoPackageGeometryHeader::GeoPackageGeometryHeader()
+    : srsID(0), empty(false), hasEnvelope(false), envLL(0,0), envUR(0,0), wkbOffset(0)
+{
+}
+
+bool GeoPackageGeometryHeader::parse(const unsigned char *data,size_t len)
+{
+    if (len < 8 || data[0] != 'G' || data[1] != 'P')
+        return false;
+
+    unsigned char flags = data[3];
+    bool littleEndian = flags & 0x1;
+    int envType = (flags >> 1) & 0x7;
+    empty = (flags >> 4) & 0x1;
+
+    auto readUInt32 = [&](size_t pos) -> uint32_t
+    {
+        const unsigned char *b = data + pos;
+        return littleEndian ? (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24) :
+                              (uint32_t)b[3] | ((uint32_t)b[2] << 8) | ((uint32_t)b[1] << 16) | ((uint32_t)b[0] << 24);
+    };
+    auto readDouble = [&](size_t pos) -> double
+    {
+        uint64_t bits = 0;
+        for (int ii=0;ii<8;ii++)
+            bits |= (uint64_t)data[pos + (littleEndian ? ii : 7-ii)] << (8*ii);
+        double val;
+        memcpy(&val,&bits,8);
+        return val;
+    };
+    srsID = (int)readUInt32(4);
+
+    // Envelope is min x, max x, min y, max y, then maybe z and m ranges
+    int envDoubles = 0;
+    switch (envType)
+    {
+        case 0:
+            break;
+        case 1:
+            envDoubles = 4;
+            break;
+        case 2:
+        case 3:
+            envDoubles = 6;
+            break;
+        case 4:
+            envDoubles = 8;
+            break;
+        default:
+            return false;
+    }
+    wkbOffset = 8 + 8*envDoubles;
+    if (wkbOffset > len)
+        return false;
+    hasEnvelope = envDoubles > 0;
+    if (hasEnvelope)
+    {
+        envLL = Point2d(readDouble(8),readDouble(24));
+        envUR = Point2d(readDouble(16),readDouble(32));
+    }
+
+    return true;
+}
+
+GeoPackage::GeoPackage(const GeoPackageConnectionFactory &factory,int maxConnections)
+    : factory(factory), maxConnections(std::max(maxConnections,1)), numConnections(0)
+{
+    pthread_mutex_init(&poolLock, NULL);
+    pthread_cond_init(&poolCond, NULL);
+}
+
+GeoPackage::~GeoPackage()
+{
+    idleConnections.clear();
+    pthread_cond_destroy(&poolCond);
+    pthread_mutex_destroy(&poolLock);
+}
+
+GeoPackageConnectionRef GeoPackage::acquireConnection()
+{
+    pthread_mutex_lock(&poolLock);
+    while (idleConnections.empty() && numConnections >= maxConnections)
+        pthread_cond_wait(&poolCond, &poolLock);
+
+    GeoPackageConnectionRef conn;
+    if (!idleConnections.empty())
+    {
+        conn = idleConnections.back();
+        idleConnections.pop_back();
+    } else
+        numConnections++;
+    pthread_mutex_unlock(&poolLock);
+
+    // Open a new one outside the lock, since it can be slow
+    if (!conn)
+    {
+        conn = factory();
+        if (!conn)
+        {
+            pthread_mutex_lock(&poolLock);
+            numConnections--;
+            pthread_cond_signal(&poolCond);
+            pthread_mutex_unlock(&poolLock);
+        }
+    }
+
+    return conn;
+}
+
+void GeoPackage::releaseConnection(GeoPackageConnectionRef conn)
+{
+    if (!conn)
+        return;
+
+    pthread_mutex_lock(&poolLock);
+    idleConnections.push_back(conn);
+    pthread_cond_signal(&poolCond);
+    pthread_mutex_unlock(&poolLock);
+}
+
+std::string GeoPackage::QuoteIdentifier(const std::string &name)
+{
+    std::string ret = "\"";
+    for (char c : name)
+    {
+        if (c == '"')
+            ret += '"';
+        ret += c;
+    }
+    ret += '"';
+
+    return ret;
+}
+
+std::string GeoPackage::QuoteString(const std::string &str)
+{
+    std::string ret = "'";
+    for (char c : str)
+    {
+        if (c == '\'')
+            ret += '\'';
+        ret += c;
+    }
+    ret += '\'';
+
+    return ret;
+}
+
+bool GeoPackage::open()
+{
+    error.clear();
+    contents.clear();
+    srsMap.clear();
+
+    GeoPackageConnectionRef conn = acquireConnection();
+    if (!conn)
+    {
+        error = "Couldn't open a connection";
+        return false;
+    }
+
+    GeoPackageCursorRef cursor = conn->query("SELECT srs_id,srs_name,organization,organization_coordsys_id,definition FROM gpkg_spatial_ref_sys");
+    if (!cursor)
+    {
+        error = "No gpkg_spatial_ref_sys table.  Not a GeoPackage.";
+        releaseConnection(conn);
+        return false;
+    }
+    while (cursor->step())
+    {
+        GeoPackageSRS srs;
+        srs.srsID = (int)cursor->getInt(0);
+        srs.name = cursor->getString(1);
+        srs.organization = cursor->getString(2);
+        srs.orgCoordSysID = (int)cursor->getInt(3);
+        srs.definition = cursor->getString(4);
+        srsMap[srs.srsID] = srs;
+    }
+
+    cursor = conn->query("SELECT table_name,data_type,identifier,description,min_x,min_y,max_x,max_y,srs_id FROM gpkg_contents");
+    if (!cursor)
+    {
+        error = "No gpkg_contents table.  Not a GeoPackage.";
+        releaseConnection(conn);
+        return false;
+    }
+    while (cursor->step())
+    {
+        GeoPackageContents entry;
+        entry.tableName = cursor->getString(0);
+        entry.dataType = cursor->getString(1);
+        entry.identifier = cursor->getString(2);
+        entry.description = cursor->getString(3);
+        entry.hasBounds = true;
+        for (int ii=4;ii<8;ii++)
+            if (cursor->getColumnType(ii) == GeoPackageNull)
+                entry.hasBounds = false;
+        if (entry.hasBounds)
+        {
+            entry.ll = Point2d(cursor->getDouble(4),cursor->getDouble(5));
+            entry.ur = Point2d(cursor->getDouble(6),cursor->getDouble(7));
+        }
+        entry.srsID = (int)cursor->getInt(8);
+        contents.push_back(entry);
+    }
+
+    // Geometry columns only exist if there are features
+    cursor = conn->query("SELECT table_name,column_name,geometry_type_name FROM gpkg_geometry_columns");
+    if (cursor)
+    {
+        while (cursor->step())
+        {
+            std::string tableName = cursor->getString(0);
+            for (auto &entry : contents)
+                if (entry.tableName == tableName)
+                {
+                    entry.geomColumn = cursor->getString(1);
+                    entry.geomType = cursor->getString(2);
+                }
+        }
+    }
+
+    // Look for the R-tree indices
+    for (auto &entry : contents)
+    {
+        if (entry.geomColumn.empty())
+            continue;
+        std::string rtreeName = "rtree_" + entry.tableName + "_" + entry.geomColumn;
+        cursor = conn->query("SELECT name FROM sqlite_master WHERE type='table' AND name=" + QuoteString(rtreeName));
+        entry.hasRTree = cursor && cursor->step();
+    }
+    cursor.reset();
+
+    releaseConnection(conn);
+
+    return true;
+}
+
+const GeoPackageContents *GeoPackage::getTableContents(const std::string &tableName) const
+{
+    for (const auto &entry : contents)
+        if (entry.tableName == tableName)
+            return &entry;
+
+    return NULL;
+}
+
+const GeoPackageSRS *GeoPackage::getSRS(int srsID) const
+{
+    auto it = srsMap.find(srsID);
+    return it == srsMap.end() ? NULL : &it->second;
+}
+
+GeoPackageFeatureReader::GeoPackageFeatureReader(GeoPackageRef gpkg,const std::string &tableName,CoordSystem *coordSys)
+    : gpkg(gpkg), contents(NULL), coordSys(coordSys), degrees(true), hasBounds(false), boundsLL(0,0), boundsUR(0,0),
+    lastRowID(INT64_MIN), geomCol(-1), done(false)
+{
+    contents = gpkg->getTableContents(tableName);
+    if (contents && contents->geomColumn.empty())
+    {
+        WHIRLYKIT_LOGW("GeoPackageFeatureReader: Table %s has no geometry column",tableName.c_str());
+        contents = NULL;
+    }
+    if (!contents)
+        return;
+
+    if (!coordSys)
+    {
+        const GeoPackageSRS *srs = gpkg->getSRS(contents->srsID);
+        degrees = !srs || srs->isGeographic();
+        if (!degrees)
+            WHIRLYKIT_LOGW("GeoPackageFeatureReader: Table %s isn't in degrees and no coordinate system was given",tableName.c_str());
+    } else
+        degrees = false;
+}
+
+GeoPackageFeatureReader::~GeoPackageFeatureReader()
+{
+}
+
+void GeoPackageFeatureReader::setBounds(const Point2d &ll,const Point2d &ur)
+{
+    hasBounds = true;
+    boundsLL = ll;
+    boundsUR = ur;
+}
+
+void GeoPackageFeatureReader::setGeoBounds(const GeoMbr &mbr)
+{
+    if (!coordSys)
+    {
+        setBounds(Point2d(RadToDeg(mbr.ll().x()),RadToDeg(mbr.ll().y())),Point2d(RadToDeg(mbr.ur().x()),RadToDeg(mbr.ur().y())));
+        return;
+    }
+
+    // Run around the edges, since the bounds can bend in the table's system
+    static const int EdgeSamples = 8;
+    Point2d ll(MAXFLOAT,MAXFLOAT),ur(-MAXFLOAT,-MAXFLOAT);
+    for (int ix=0;ix<=EdgeSamples;ix++)
+        for (int iy=0;iy<=EdgeSamples;iy++)
+        {
+            if (ix != 0 && ix != EdgeSamples && iy != 0 && iy != EdgeSamples)
+                continue;
+            Point2d geo(mbr.ll().x() + (mbr.ur().x()-mbr.ll().x()) * ix / EdgeSamples,
+                        mbr.ll().y() + (mbr.ur().y()-mbr.ll().y()) * iy / EdgeSamples);
+            Point3d loc = coordSys->geographicToLocal(geo);
+            ll = ll.cwiseMin(Point2d(loc.x(),loc.y()));
+            ur = ur.cwiseMax(Point2d(loc.x(),loc.y()));
+        }
+    setBounds(ll,ur);
+}
+
+bool GeoPackageFeatureReader::isValid()
+{
+    return contents != NULL;
+}
+
+bool GeoPackageFeatureReader::readPage(const StringSet *filter)
+{
+    GeoPackageConnectionRef conn = gpkg->acquireConnection();
+    if (!conn)
+        return false;
+
+    // Each page picks up after the last rowid we saw, so it doesn't depend on an open cursor
+    std::string table = GeoPackage::QuoteIdentifier(contents->tableName);
+    std::string sql = "SELECT rowid,* FROM " + table + " WHERE rowid > " + std::to_string(lastRowID);
+    if (hasBounds && contents->hasRTree)
+    {
+        std::string rtree = GeoPackage::QuoteIdentifier("rtree_" + contents->tableName + "_" + contents->geomColumn);
+        sql += " AND rowid IN (SELECT id FROM " + rtree +
+            " WHERE minx <= " + SQLNumber(boundsUR.x()) + " AND maxx >= " + SQLNumber(boundsLL.x()) +
+            " AND miny <= " + SQLNumber(boundsUR.y()) + " AND maxy >= " + SQLNumber(boundsLL.y()) + ")";
+    }
+    sql += " ORDER BY rowid LIMIT " + std::to_string(GeoPackagePageSize);
+    GeoPackageCursorRef cursor = conn->query(sql);
+    if (!cursor)
+    {
+        WHIRLYKIT_LOGE("GeoPackageFeatureReader: Query failed on %s",contents->tableName.c_str());
+        gpkg->releaseConnection(conn);
+        return false;
+    }
+
+    // The first column is the rowid we added
+    if (geomCol < 0)
+        for (int ii=1;ii<cursor->getNumColumns();ii++)
+            if (cursor->getColumnName(ii) == contents->geomColumn)
+                geomCol = ii;
+
+    int numRows = 0;
+    while (geomCol >= 0 && cursor->step())
+    {
+        numRows++;
+        lastRowID = cursor->getInt(0);
+        readRow(cursor,pending,filter);
+    }
+    cursor.reset();
+    gpkg->releaseConnection(conn);
+
+    if (numRows < GeoPackagePageSize)
+        done = true;
+
+    return geomCol >= 0;
+}
+
+bool GeoPackageFeatureReader::readRow(GeoPackageCursorRef cursor,ShapeSet &shapes,const StringSet *filter)
+{
+    size_t len = 0;
+    const unsigned char *blob = cursor->getBlob(geomCol,len);
+    GeoPackageGeometryHeader header;
+    if (!blob || !header.parse(blob,len) || header.empty)
+        return false;
+
+    // The envelope saves us decoding the geometry
+    auto outside = [&](const Point2d &ll,const Point2d &ur)
+    {
+        return ll.x() > boundsUR.x() || ur.x() < boundsLL.x() || ll.y() > boundsUR.y() || ur.y() < boundsLL.y();
+    };
+    bool checkBounds = hasBounds && !contents->hasRTree;
+    if (checkBounds && header.hasEnvelope)
+    {
+        if (outside(header.envLL,header.envUR))
+            return false;
+        checkBounds = false;
+    }
+
+    // Convert as we go, keeping track of the extents in case there was no envelope
+    Point2d rawLL(MAXFLOAT,MAXFLOAT),rawUR(-MAXFLOAT,-MAXFLOAT);
+    CoordSystem *theCoordSys = coordSys;
+    bool isDegrees = degrees;
+    parser.setConverter([&](const Point2d &pt) -> Point2d
+        {
+            rawLL = rawLL.cwiseMin(pt);
+            rawUR = rawUR.cwiseMax(pt);
+            if (theCoordSys)
+                return theCoordSys->localToGeographicD(Point3d(pt.x(),pt.y(),0.0));
+            if (isDegrees)
+                return Point2d(DegToRad(pt.x()),DegToRad(pt.y()));
+            return pt;
+        });
+    ShapeSet newShapes;
+    if (parser.parse(blob + header.wkbOffset,len - header.wkbOffset,newShapes) == 0)
+    {
+        WHIRLYKIT_LOGW("GeoPackageFeatureReader: Bad geometry in %s",contents->tableName.c_str());
+        return false;
+    }
+    if (newShapes.empty() || (checkBounds && outside(rawLL,rawUR)))
+        return false;
+
+    // Everything else is attributes
+    Dictionary attrs;
+    for (int ii=1;ii<cursor->getNumColumns();ii++)
+    {
+        if (ii == geomCol)
+            continue;
+        std::string name = cursor->getColumnName(ii);
+        if (filter && filter->find(name) == filter->end())
+            continue;
+        switch (cursor->getColumnType(ii))
+        {
+            case GeoPackageInteger:
+            {
+                int64_t val = cursor->getInt(ii);
+                if (val >= INT32_MIN && val <= INT32_MAX)
+                    attrs.setInt(name,(int)val);
+                else
+                    attrs.setDouble(name,(double)val);
+            }
+                break;
+            case GeoPackageFloat:
+                attrs.setDouble(name,cursor->getDouble(ii));
+                break;
+            case GeoPackageText:
+                attrs.setString(name,cursor->getString(ii));
+                break;
+            default:
+                break;
+        }
+    }
+    for (auto shape : newShapes)
+        shape->setAttrDict(attrs);
+    shapes.insert(newShapes.begin(),newShapes.end());
+
+    return true;
+}
+
+VectorShapeRef GeoPackageFeatureReader::getNextObject(const StringSet *filter)
+{
+    if (!contents)
+        return VectorShapeRef();
+
+    while (pending.empty() && !done)
+        if (!readPage(filter))
+            done = true;
+    if (pending.empty())
+        return VectorShapeRef();
+
+    VectorShapeRef shape = *pending.begin();
+    pending.erase(pending.begin());
+    return shape;
+}
+
+bool GeoPackageFeatureReader::readAll(ShapeSet &shapes)
+{
+    if (!contents)
+        return false;
+
+    VectorShapeRef shape;
+    while ((shape = getNextObject(NULL)))
+        shapes.insert(shape);
+
+    return true;
+}
+
+GeoPackageTileSource::GeoPackageTileSource(GeoPackageRef gpkg,const std::string &tableName)
+    : gpkg(gpkg), tableName(tableName), srsID(0)
+{
+}
+
+GeoPackageTileSource::~GeoPackageTileSource()
+{
+}
+
+bool GeoPackageTileSource::init()
+{
+    GeoPackageConnectionRef conn = gpkg->acquireConnection();
+    if (!conn)
+        return false;
+
+    std::string quotedName = GeoPackage::QuoteString(tableName);
+    GeoPackageCursorRef cursor = conn->query("SELECT srs_id,min_x,min_y,max_x,max_y FROM gpkg_tile_matrix_set WHERE table_name=" + quotedName);
+    if (!cursor || !cursor->step())
+    {
+        WHIRLYKIT_LOGE("GeoPackageTileSource: No tile matrix set for %s",tableName.c_str());
+        gpkg->releaseConnection(conn);
+        return false;
+    }
+    srsID = (int)cursor->getInt(0);
+    Point2d setLL(cursor->getDouble(1),cursor->getDouble(2));
+    Point2d setUR(cursor->getDouble(3),cursor->getDouble(4));
+
+    // Zoom levels can skip around and don't have to double.  Tiles start at the top left of the set.
+    tileMatrixSet = TileMatrixSetRef(new TileMatrixSet());
+    zooms.clear();
+    cursor = conn->query("SELECT zoom_level,matrix_width,matrix_height,tile_width,tile_height,pixel_x_size,pixel_y_size FROM gpkg_tile_matrix WHERE table_name=" +
+                         quotedName + " ORDER BY zoom_level");
+    while (cursor && cursor->step())
+    {
+        ZoomInfo zoom;
+        zoom.zoomLevel = (int)cursor->getInt(0);
+        int matrixWidth = (int)cursor->getInt(1), matrixHeight = (int)cursor->getInt(2);
+        zoom.tileWidth = (int)cursor->getInt(3);
+        zoom.tileHeight = (int)cursor->getInt(4);
+        Point2d tileSpan(zoom.tileWidth * cursor->getDouble(5),zoom.tileHeight * cursor->getDouble(6));
+        if (matrixWidth <= 0 || matrixHeight <= 0 || tileSpan.x() <= 0.0 || tileSpan.y() <= 0.0)
+            continue;
+        Point2d ll(setLL.x(),setUR.y() - matrixHeight * tileSpan.y());
+        tileMatrixSet->addLevel(TileMatrix(ll,tileSpan,matrixWidth,matrixHeight));
+        zooms.push_back(zoom);
+    }
+    cursor.reset();
+    gpkg->releaseConnection(conn);
+
+    if (zooms.empty())
+    {
+        WHIRLYKIT_LOGE("GeoPackageTileSource: No tile matrices for %s",tableName.c_str());
+        tileMatrixSet.reset();
+        return false;
+    }
+
+    return true;
+}
+
+int GeoPackageTileSource::zoomLevelFor(int level) const
+{
+    if (level < 0 || level >= (int)zooms.size())
+        return -1;
+    return zooms[level].zoomLevel;
+}
+
+void GeoPackageTileSource::getTileSize(int level,int &width,int &height) const
+{
+    if (level < 0 || level >= (int)zooms.size())
+    {
+        width = height = 0;
+        return;
+    }
+    width = zooms[level].tileWidth;
+    height = zooms[level].tileHeight;
+}
+
+bool GeoPackageTileSource::hasTile(const Quadtree::Identifier &ident)
+{
+    if (!tileMatrixSet || !tileMatrixSet->isValidTile(ident))
+        return false;
+
+    GeoPackageConnectionRef conn = gpkg->acquireConnection();
+    if (!conn)
+        return false;
+    const TileMatrix &mat = tileMatrixSet->getLevel(ident.level);
+    GeoPackageCursorRef cursor = conn->query("SELECT 1 FROM " + GeoPackage::QuoteIdentifier(tableName) +
+                                             " WHERE zoom_level=" + std::to_string(zooms[ident.level].zoomLevel) +
+                                             " AND tile_column=" + std::to_string(ident.x) +
+                                             " AND tile_row=" + std::to_string(mat.topRow(ident.y)));
+    bool found = cursor && cursor->step();
+    cursor.reset();
+    gpkg->releaseConnection(conn);
+
+    return found;
+}
+
+RawDataRef GeoPackageTileSource::fetchTile(const Quadtree::Identifier &ident)
+{
+    if (!tileMatrixSet || !tileMatrixSet->isValidTile(ident))
+        return RawDataRef();
+
+    GeoPackageConnectionRef conn = gpkg->acquireConnection();
+    if (!conn)
+        return RawDataRef();
+    // Rows count down from the top in GeoPackage
+    const TileMatrix &mat = tileMatrixSet->getLevel(ident.level);
+    GeoPackageCursorRef cursor = conn->query("SELECT tile_data FROM " + GeoPackage::QuoteIdentifier(tableName) +
+                                             " WHERE zoom_level=" + std::to_string(zooms[ident.level].zoomLevel) +
+                                             " AND tile_column=" + std::to_string(ident.x) +
+                                             " AND tile_row=" + std::to_string(mat.topRow(ident.y)));
+    RawDataRef ret;
+    if (cursor && cursor->step())
+    {
+        size_t len = 0;
+        const unsigned char *blob = cursor->getBlob(0,len);
+        if (blob && len > 0)
+            ret = RawDataRef(new MutableRawData((void *)blob,len));
+    }
+    cursor.reset();
+    gpkg->releaseConnection(conn);
+
+    return ret;
+}
+
+}
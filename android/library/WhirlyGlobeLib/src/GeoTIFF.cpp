@@ -0,0 +1,1833 @@
+/*
+ *  GeoTIFF.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import <string.h>
+#import <stdlib.h>
+#import <algorithm>
+#import <sstream>
+#import <set>
+#import <zlib.h>
+#import "GeoTIFF.h"
+#import "JPEGDecoder.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+// TIFF tags we care about
+enum {
+    TagNewSubfileType = 254, TagImageWidth = 256, TagImageLength = 257, TagBitsPerSample = 258,
+    TagCompression = 259, TagPhotometric = 262, TagStripOffsets = 273, TagSamplesPerPixel = 277,
+    TagRowsPerStrip = 278, TagStripByteCounts = 279, TagPlanarConfig = 284, TagPredictor = 317,
+    TagColorMap = 320, TagTileWidth = 322, TagTileLength = 323, TagTileOffsets = 324,
+    TagTileByteCounts = 325, TagExtraSamples = 338, TagSampleFormat = 339, TagJPEGTables = 347,
+    TagModelPixelScale = 33550, TagModelTiepoint = 33922, TagModelTransformation = 34264,
+    TagGeoKeyDirectory = 34735, TagGeoDoubleParams = 34736, TagGeoAsciiParams = 34737,
+    TagGDALNoData = 42113
+};
+
+// Compression schemes
+enum {
+    CompressNone = 1, CompressLZW = 5, CompressJPEG = 7, CompressDeflate = 8,
+    CompressPackBits = 32773, CompressDeflateOld = 32946
+};
+
+// Photometric interpretations
+enum {
+    PhotoWhiteIsZero = 0, PhotoBlackIsZero = 1, PhotoRGB = 2, PhotoPalette = 3, PhotoYCbCr = 6
+};
+
+// GeoTIFF keys
+enum {
+    KeyModelType = 1024, KeyRasterType = 1025,
+    KeyGeographicType = 2048, KeyGeogDatum = 2050, KeyGeogEllipsoid = 2056,
+    KeyGeogSemiMajor = 2057, KeyGeogSemiMinor = 2058, KeyGeogInvFlattening = 2059,
+    KeyProjectedCSType = 3072, KeyProjection = 3074, KeyProjCoordTrans = 3075, KeyProjLinearUnits = 3076,
+    KeyStdParallel1 = 3078, KeyStdParallel2 = 3079, KeyNatOriginLong = 3080, KeyNatOriginLat = 3081,
+    KeyFalseEasting = 3082, KeyFalseNorthing = 3083, KeyFalseOriginLong = 3084, KeyFalseOriginLat = 3085,
+    KeyFalseOriginEasting = 3086, KeyFalseOriginNorthing = 3087, KeyCenterLong = 3088, KeyCenterLat = 3089,
+    KeyScaleAtNatOrigin = 3092, KeyScaleAtCenter = 3093, KeyStraightVertPoleLong = 3095
+};
+
+// Size in bytes of each of the TIFF field types
+static int TIFFTypeSize(int type)
+{
+    switch (type)
+    {
+        case 1: case 2: case 6: case 7:
+            return 1;
+        case 3: case 8:
+            return 2;
+        case 4: case 9: case 11: case 13:
+            return 4;
+        case 5: case 10: case 12: case 16: case 17: case 18:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+GeoTIFFImage::GeoTIFFImage()
+    : width(0), height(0), blockWidth(0), blockHeight(0), tiled(false), blocksAcross(0), blocksDown(0),
+    bitsPerSample(1), samplesPerPixel(1), sampleFormat(1), compression(CompressNone), predictor(1),
+    photometric(PhotoBlackIsZero), planarConfig(1), alphaSample(-1), isOverview(false), isMask(false)
+{
+}
+
+bool GeoTIFFImage::isSupported(std::string &why) const
+{
+    switch (compression)
+    {
+        case CompressNone:
+        case CompressLZW:
+        case CompressJPEG:
+        case CompressDeflate:
+        case CompressDeflateOld:
+        case CompressPackBits:
+            break;
+        default:
+            why = "Unsupported compression " + std::to_string(compression);
+            return false;
+    }
+
+    switch (photometric)
+    {
+        case PhotoWhiteIsZero:
+        case PhotoBlackIsZero:
+        case PhotoRGB:
+        case PhotoPalette:
+            break;
+        case PhotoYCbCr:
+            if (compression != CompressJPEG)
+            {
+                why = "YCbCr is only supported with JPEG compression";
+                return false;
+            }
+            break;
+        default:
+            why = "Unsupported photometric interpretation " + std::to_string(photometric);
+            return false;
+    }
+
+    if (compression == CompressJPEG && bitsPerSample != 8)
+    {
+        why = "JPEG compression needs 8 bit samples";
+        return false;
+    }
+    if (bitsPerSample != 1 && bitsPerSample != 2 && bitsPerSample != 4 && bitsPerSample != 8 &&
+        bitsPerSample != 16 && bitsPerSample != 32 && bitsPerSample != 64)
+    {
+        why = "Unsupported bits per sample " + std::to_string(bitsPerSample);
+        return false;
+    }
+    if (sampleFormat == 3 && bitsPerSample != 32 && bitsPerSample != 64)
+    {
+        why = "Floating point samples must be 32 or 64 bits";
+        return false;
+    }
+    if (photometric == PhotoRGB && samplesPerPixel < 3)
+    {
+        why = "RGB images need three samples per pixel";
+        return false;
+    }
+    if (blockWidth <= 0 || blockHeight <= 0 || blockOffsets.empty() || blockOffsets.size() != blockByteCounts.size())
+    {
+        why = "Missing strip or tile layout";
+        return false;
+    }
+    int numPlanes = (planarConfig == 2) ? samplesPerPixel : 1;
+    if (blockOffsets.size() < (size_t)blocksAcross * blocksDown * numPlanes)
+    {
+        why = "Not enough strips or tiles for the image size";
+        return false;
+    }
+
+    return true;
+}
+
+GeoTIFFGeoref::GeoTIFFGeoref()
+    : valid(false), modelType(0), pixelIsPoint(false), epsg(0)
+{
+    transform[0] = 0.0;  transform[1] = 1.0;  transform[2] = 0.0;
+    transform[3] = 0.0;  transform[4] = 0.0;  transform[5] = -1.0;
+}
+
+// Datum (or ellipsoid) part of a proj.4 string for a geographic system, datum or ellipsoid code
+static std::string DatumForCode(int code)
+{
+    switch (code)
+    {
+        case 4326: case 6326:
+            return "+datum=WGS84";
+        case 4269: case 6269:
+            return "+datum=NAD83";
+        case 4267: case 6267:
+            return "+datum=NAD27";
+        case 4258: case 6258:
+        case 4283: case 6283:
+            return "+ellps=GRS80 +towgs84=0,0,0";
+        case 4230: case 6230:
+            return "+ellps=intl +towgs84=-87,-98,-121,0,0,0,0";
+        case 4277: case 6277:
+            return "+ellps=airy +towgs84=446.448,-125.157,542.06,0.15,0.247,0.842,-20.489";
+        case 7030:
+            return "+ellps=WGS84";
+        case 7019:
+            return "+ellps=GRS80";
+        case 7008:
+            return "+ellps=clrk66";
+        case 7022:
+            return "+ellps=intl";
+        case 7001:
+            return "+ellps=airy";
+        default:
+            return "";
+    }
+}
+
+// A few well known projected systems we can't build out of their parts
+static std::string ProjectedForCode(int code)
+{
+    if (code == 3857 || code == 3785 || code == 900913 || code == 102100 || code == 102113)
+        return "+proj=merc +a=6378137 +b=6378137 +lat_ts=0.0 +lon_0=0.0 +x_0=0.0 +y_0=0 +k=1.0 +units=m +nadgrids=@null +no_defs";
+    if (code == 3395)
+        return "+proj=merc +lon_0=0 +k=1 +x_0=0 +y_0=0 +datum=WGS84 +units=m +no_defs";
+
+    // UTM families
+    std::string datum;
+    int zone = 0;
+    bool south = false;
+    if (code >= 32601 && code <= 32660) { zone = code - 32600;  datum = "+datum=WGS84"; }
+    else if (code >= 32701 && code <= 32760) { zone = code - 32700;  datum = "+datum=WGS84";  south = true; }
+    else if (code >= 26901 && code <= 26923) { zone = code - 26900;  datum = "+datum=NAD83"; }
+    else if (code >= 26701 && code <= 26722) { zone = code - 26700;  datum = "+datum=NAD27"; }
+    else if (code >= 25828 && code <= 25838) { zone = code - 25800;  datum = DatumForCode(4258); }
+    else if (code >= 23028 && code <= 23038) { zone = code - 23000;  datum = DatumForCode(4230); }
+    else if (code >= 28348 && code <= 28358) { zone = code - 28300;  datum = DatumForCode(4283);  south = true; }
+    if (zone > 0)
+        return "+proj=utm +zone=" + std::to_string(zone) + (south ? " +south " : " ") + datum + " +units=m +no_defs";
+
+    switch (code)
+    {
+        case 27700:
+            return "+proj=tmerc +lat_0=49 +lon_0=-2 +k=0.9996012717 +x_0=400000 +y_0=-100000 " + DatumForCode(4277) + " +units=m +no_defs";
+        case 2154:
+            return "+proj=lcc +lat_1=49 +lat_2=44 +lat_0=46.5 +lon_0=3 +x_0=700000 +y_0=6600000 " + DatumForCode(4258) + " +units=m +no_defs";
+        case 3035:
+            return "+proj=laea +lat_0=52 +lon_0=10 +x_0=4321000 +y_0=3210000 " + DatumForCode(4258) + " +units=m +no_defs";
+        case 5070:
+            return "+proj=aea +lat_1=29.5 +lat_2=45.5 +lat_0=23 +lon_0=-96 +x_0=0 +y_0=0 +datum=NAD83 +units=m +no_defs";
+        case 3413:
+            return "+proj=stere +lat_0=90 +lat_ts=70 +lon_0=-45 +k=1 +x_0=0 +y_0=0 +datum=WGS84 +units=m +no_defs";
+        case 3031:
+            return "+proj=stere +lat_0=-90 +lat_ts=-71 +lon_0=0 +k=1 +x_0=0 +y_0=0 +datum=WGS84 +units=m +no_defs";
+        default:
+            return "";
+    }
+}
+
+std::string GeoTIFFGeoref::proj4String() const
+{
+    auto keyVal = [this](int key,double defVal) -> double
+    {
+        std::map<int,double>::const_iterator kit = keys.find(key);
+        return kit == keys.end() ? defVal : kit->second;
+    };
+    auto hasKey = [this](int key) -> bool { return keys.find(key) != keys.end(); };
+
+    // Work out the datum from whatever pieces we've got
+    std::string datum;
+    int geogType = (int)keyVal(KeyGeographicType,0);
+    if (geogType > 0 && geogType != 32767)
+        datum = DatumForCode(geogType);
+    if (datum.empty() && hasKey(KeyGeogDatum))
+        datum = DatumForCode((int)keyVal(KeyGeogDatum,0));
+    if (datum.empty() && hasKey(KeyGeogEllipsoid))
+        datum = DatumForCode((int)keyVal(KeyGeogEllipsoid,0));
+    if (datum.empty() && hasKey(KeyGeogSemiMajor))
+    {
+        std::ostringstream str;
+        str.precision(12);
+        str << "+a=" << keyVal(KeyGeogSemiMajor,6378137.0);
+        if (hasKey(KeyGeogSemiMinor))
+            str << " +b=" << keyVal(KeyGeogSemiMinor,6378137.0);
+        else if (hasKey(KeyGeogInvFlattening))
+            str << " +rf=" << keyVal(KeyGeogInvFlattening,298.257223563);
+        datum = str.str();
+    }
+    if (datum.empty())
+        datum = "+datum=WGS84";
+
+    if (modelType == 2)
+        return "+proj=longlat " + datum + " +no_defs";
+    if (modelType != 1)
+        return "";
+
+    if (epsg > 0 && epsg != 32767)
+    {
+        std::string known = ProjectedForCode(epsg);
+        if (!known.empty())
+            return known;
+    }
+
+    std::ostringstream str;
+    str.precision(12);
+    int projCode = (int)keyVal(KeyProjection,0);
+    int coordTrans = (int)keyVal(KeyProjCoordTrans,0);
+    if (projCode >= 16001 && projCode <= 16060)
+        str << "+proj=utm +zone=" << projCode - 16000;
+    else if (projCode >= 16101 && projCode <= 16160)
+        str << "+proj=utm +zone=" << projCode - 16100 << " +south";
+    else {
+        double falseEasting = keyVal(KeyFalseEasting,keyVal(KeyFalseOriginEasting,0.0));
+        double falseNorthing = keyVal(KeyFalseNorthing,keyVal(KeyFalseOriginNorthing,0.0));
+        double originLat = keyVal(KeyNatOriginLat,keyVal(KeyFalseOriginLat,keyVal(KeyCenterLat,0.0)));
+        double originLon = keyVal(KeyNatOriginLong,keyVal(KeyFalseOriginLong,keyVal(KeyCenterLong,0.0)));
+        switch (coordTrans)
+        {
+            case 1:
+                str << "+proj=tmerc +lat_0=" << originLat << " +lon_0=" << originLon << " +k=" << keyVal(KeyScaleAtNatOrigin,1.0);
+                break;
+            case 7:
+                str << "+proj=merc +lon_0=" << originLon;
+                if (hasKey(KeyStdParallel1))
+                    str << " +lat_ts=" << keyVal(KeyStdParallel1,0.0);
+                else
+                    str << " +k=" << keyVal(KeyScaleAtNatOrigin,1.0);
+                break;
+            case 8:
+                str << "+proj=lcc +lat_1=" << keyVal(KeyStdParallel1,0.0) << " +lat_2=" << keyVal(KeyStdParallel2,0.0)
+                    << " +lat_0=" << originLat << " +lon_0=" << originLon;
+                break;
+            case 9:
+                str << "+proj=lcc +lat_1=" << originLat << " +lat_0=" << originLat << " +lon_0=" << originLon
+                    << " +k_0=" << keyVal(KeyScaleAtNatOrigin,1.0);
+                break;
+            case 10:
+                str << "+proj=laea +lat_0=" << originLat << " +lon_0=" << originLon;
+                break;
+            case 11:
+                str << "+proj=aea +lat_1=" << keyVal(KeyStdParallel1,0.0) << " +lat_2=" << keyVal(KeyStdParallel2,0.0)
+                    << " +lat_0=" << originLat << " +lon_0=" << originLon;
+                break;
+            case 15:
+                str << "+proj=stere +lat_0=" << (originLat < 0.0 ? -90 : 90) << " +lat_ts=" << originLat
+                    << " +lon_0=" << keyVal(KeyStraightVertPoleLong,originLon) << " +k=" << keyVal(KeyScaleAtNatOrigin,1.0);
+                break;
+            case 17:
+                str << "+proj=eqc +lat_ts=" << keyVal(KeyStdParallel1,0.0) << " +lon_0=" << originLon;
+                break;
+            default:
+                return "";
+        }
+        str << " +x_0=" << falseEasting << " +y_0=" << falseNorthing;
+    }
+
+    str << " " << datum;
+    switch ((int)keyVal(KeyProjLinearUnits,9001))
+    {
+        case 9002:
+            str << " +units=ft";
+            break;
+        case 9003:
+            str << " +units=us-ft";
+            break;
+        default:
+            str << " +units=m";
+            break;
+    }
+    str << " +no_defs";
+
+    return str.str();
+}
+
+GeoTIFFFile::GeoTIFFFile()
+    : fp(NULL), fileSize(0), swapBytes(false), bigTIFF(false), dataMin(0.0), dataMax(0.0), dataRangeSet(false),
+    hasNoData(false), noData(0.0), cacheSize(0), maxCacheSize(32*1024*1024)
+{
+    pthread_mutex_init(&fileLock, NULL);
+    pthread_mutex_init(&cacheLock, NULL);
+}
+
+GeoTIFFFile::~GeoTIFFFile()
+{
+    close();
+    pthread_mutex_destroy(&fileLock);
+    pthread_mutex_destroy(&cacheLock);
+}
+
+std::string GeoTIFFFile::getError()
+{
+    pthread_mutex_lock(&fileLock);
+    std::string ret = error;
+    pthread_mutex_unlock(&fileLock);
+
+    return ret;
+}
+
+bool GeoTIFFFile::open(const std::string &fileName)
+{
+    close();
+
+    fp = fopen(fileName.c_str(),"rb");
+    if (!fp)
+    {
+        error = "Couldn't open " + fileName;
+        return false;
+    }
+    // Sizes in the file get checked against this before we allocate for them
+    fseeko(fp,0,SEEK_END);
+    off_t endPos = ftello(fp);
+    fileSize = endPos > 0 ? (uint64_t)endPos : 0;
+
+    if (!readHeader())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void GeoTIFFFile::close()
+{
+    pthread_mutex_lock(&fileLock);
+    if (fp)
+        fclose(fp);
+    fp = NULL;
+    fileSize = 0;
+    pthread_mutex_unlock(&fileLock);
+
+    pthread_mutex_lock(&cacheLock);
+    blockCache.clear();
+    blockLRU.clear();
+    cacheSize = 0;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+bool GeoTIFFFile::readBytes(uint64_t offset,size_t len,void *data)
+{
+    if (!fp)
+        return false;
+    if (fseeko(fp,(off_t)offset,SEEK_SET) != 0)
+        return false;
+
+    return fread(data,1,len,fp) == len;
+}
+
+uint16_t GeoTIFFFile::swap16(uint16_t val) const
+{
+    return swapBytes ? (uint16_t)((val >> 8) | (val << 8)) : val;
+}
+
+uint32_t GeoTIFFFile::swap32(uint32_t val) const
+{
+    if (!swapBytes)
+        return val;
+    return ((val >> 24) & 0xFF) | ((val >> 8) & 0xFF00) | ((val << 8) & 0xFF0000) | (val << 24);
+}
+
+uint64_t GeoTIFFFile::swap64(uint64_t val) const
+{
+    if (!swapBytes)
+        return val;
+    return ((uint64_t)swap32((uint32_t)(val & 0xFFFFFFFF)) << 32) | swap32((uint32_t)(val >> 32));
+}
+
+bool GeoTIFFFile::readHeader()
+{
+    unsigned char header[16];
+    if (!readBytes(0,8,header))
+    {
+        error = "Couldn't read TIFF header";
+        return false;
+    }
+
+    uint16_t hostTest = 1;
+    bool hostLittle = *(unsigned char *)&hostTest == 1;
+    if (header[0] == 'I' && header[1] == 'I')
+        swapBytes = !hostLittle;
+    else if (header[0] == 'M' && header[1] == 'M')
+        swapBytes = hostLittle;
+    else {
+        error = "Not a TIFF file";
+        return false;
+    }
+
+    uint16_t version;
+    memcpy(&version,&header[2],2);
+    version = swap16(version);
+    uint64_t ifdOffset = 0;
+    if (version == 42)
+    {
+        bigTIFF = false;
+        uint32_t offset32;
+        memcpy(&offset32,&header[4],4);
+        ifdOffset = swap32(offset32);
+    } else if (version == 43)
+    {
+        bigTIFF = true;
+        if (!readBytes(0,16,header))
+            return false;
+        uint64_t offset64;
+        memcpy(&offset64,&header[8],8);
+        ifdOffset = swap64(offset64);
+    } else {
+        error = "Unknown TIFF version";
+        return false;
+    }
+
+    // Work through the chain of images
+    std::set<uint64_t> visited;
+    while (ifdOffset != 0 && visited.find(ifdOffset) == visited.end())
+    {
+        visited.insert(ifdOffset);
+        uint64_t nextOffset = 0;
+        if (!readIFD(ifdOffset,nextOffset))
+            return false;
+        ifdOffset = nextOffset;
+    }
+
+    if (images.empty())
+    {
+        error = "No usable images in TIFF";
+        return false;
+    }
+
+    // Full resolution first, then overviews from biggest to smallest
+    std::stable_sort(images.begin()+1,images.end(),
+                     [](const GeoTIFFImage &a,const GeoTIFFImage &b) { return a.width > b.width; });
+
+    std::string why;
+    if (!images[0].isSupported(why))
+    {
+        error = why;
+        return false;
+    }
+
+    return true;
+}
+
+bool GeoTIFFFile::readIFD(uint64_t offset,uint64_t &nextOffset)
+{
+    size_t countSize = bigTIFF ? 8 : 2;
+    size_t entrySize = bigTIFF ? 20 : 12;
+    size_t inlineSize = bigTIFF ? 8 : 4;
+
+    unsigned char countBuf[8];
+    if (!readBytes(offset,countSize,countBuf))
+    {
+        error = "Couldn't read TIFF directory";
+        return false;
+    }
+    uint64_t numEntries;
+    if (bigTIFF)
+    {
+        uint64_t val;
+        memcpy(&val,countBuf,8);
+        numEntries = swap64(val);
+    } else {
+        uint16_t val;
+        memcpy(&val,countBuf,2);
+        numEntries = swap16(val);
+    }
+    if (numEntries > 4096)
+    {
+        error = "Corrupt TIFF directory";
+        return false;
+    }
+
+    std::vector<unsigned char> entries(numEntries*entrySize + inlineSize);
+    if (!readBytes(offset+countSize,entries.size(),&entries[0]))
+    {
+        error = "Couldn't read TIFF directory";
+        return false;
+    }
+    if (bigTIFF)
+    {
+        uint64_t val;
+        memcpy(&val,&entries[numEntries*entrySize],8);
+        nextOffset = swap64(val);
+    } else {
+        uint32_t val;
+        memcpy(&val,&entries[numEntries*entrySize],4);
+        nextOffset = swap32(val);
+    }
+
+    GeoTIFFImage img;
+    int rowsPerStrip = 0;
+    int subfileType = 0;
+    std::vector<double> extraSamples;
+    std::vector<double> pixelScale,tiePoints,modelTransform,keyDir,doubleParams;
+    std::string asciiParams,noDataStr;
+
+    for (uint64_t ie=0;ie<numEntries;ie++)
+    {
+        const unsigned char *entry = &entries[ie*entrySize];
+        uint16_t tag,type;
+        memcpy(&tag,entry,2);
+        memcpy(&type,entry+2,2);
+        tag = swap16(tag);
+        type = swap16(type);
+        uint64_t count;
+        const unsigned char *valPtr;
+        if (bigTIFF)
+        {
+            uint64_t val;
+            memcpy(&val,entry+4,8);
+            count = swap64(val);
+            valPtr = entry+12;
+        } else {
+            uint32_t val;
+            memcpy(&val,entry+4,4);
+            count = swap32(val);
+            valPtr = entry+8;
+        }
+        int typeSize = TIFFTypeSize(type);
+        // A value can't be bigger than the file it's in
+        if (typeSize == 0 || count > (1<<28) || count*typeSize > fileSize)
+            continue;
+
+        // Small values live in the entry, the rest somewhere else in the file
+        std::vector<unsigned char> raw(count*typeSize);
+        if (raw.empty())
+            continue;
+        if (raw.size() <= inlineSize)
+            memcpy(&raw[0],valPtr,raw.size());
+        else {
+            uint64_t valOffset;
+            if (bigTIFF)
+            {
+                memcpy(&valOffset,valPtr,8);
+                valOffset = swap64(valOffset);
+            } else {
+                uint32_t val32;
+                memcpy(&val32,valPtr,4);
+                valOffset = swap32(val32);
+            }
+            if (raw.size() > bytesLeft(valOffset))
+                continue;
+            if (!readBytes(valOffset,raw.size(),&raw[0]))
+                continue;
+        }
+
+        if (type == 2)
+        {
+            std::string str((const char *)&raw[0],raw.size());
+            str = str.substr(0,str.find('\0'));
+            if (tag == TagGeoAsciiParams)
+                asciiParams = str;
+            else if (tag == TagGDALNoData)
+                noDataStr = str;
+            continue;
+        }
+        if (tag == TagJPEGTables)
+        {
+            img.jpegTables = raw;
+            continue;
+        }
+
+        // Everything else is numbers
+        std::vector<double> vals(count);
+        std::vector<uint64_t> intVals(count);
+        for (uint64_t ii=0;ii<count;ii++)
+        {
+            const unsigned char *src = &raw[ii*typeSize];
+            switch (type)
+            {
+                case 1: case 7:
+                    intVals[ii] = src[0];
+                    vals[ii] = src[0];
+                    break;
+                case 6:
+                    intVals[ii] = (uint64_t)(int8_t)src[0];
+                    vals[ii] = (int8_t)src[0];
+                    break;
+                case 3: case 8:
+                {
+                    uint16_t val;
+                    memcpy(&val,src,2);
+                    val = swap16(val);
+                    intVals[ii] = val;
+                    vals[ii] = (type == 8) ? (double)(int16_t)val : (double)val;
+                }
+                    break;
+                case 4: case 9: case 13:
+                {
+                    uint32_t val;
+                    memcpy(&val,src,4);
+                    val = swap32(val);
+                    intVals[ii] = val;
+                    vals[ii] = (type == 9) ? (double)(int32_t)val : (double)val;
+                }
+                    break;
+                case 16: case 17: case 18:
+                {
+                    uint64_t val;
+                    memcpy(&val,src,8);
+                    val = swap64(val);
+                    intVals[ii] = val;
+                    vals[ii] = (type == 17) ? (double)(int64_t)val : (double)val;
+                }
+                    break;
+                case 5: case 10:
+                {
+                    uint32_t num,denom;
+                    memcpy(&num,src,4);
+                    memcpy(&denom,src+4,4);
+                    num = swap32(num);  denom = swap32(denom);
+                    if (type == 10)
+                        vals[ii] = denom ? (double)(int32_t)num / (int32_t)denom : 0.0;
+                    else
+                        vals[ii] = denom ? (double)num / denom : 0.0;
+                    intVals[ii] = (uint64_t)vals[ii];
+                }
+                    break;
+                case 11:
+                {
+                    uint32_t val;
+                    memcpy(&val,src,4);
+                    val = swap32(val);
+                    float fVal;
+                    memcpy(&fVal,&val,4);
+                    vals[ii] = fVal;
+                    intVals[ii] = (uint64_t)fVal;
+                }
+                    break;
+                case 12:
+                {
+                    uint64_t val;
+                    memcpy(&val,src,8);
+                    val = swap64(val);
+                    double dVal;
+                    memcpy(&dVal,&val,8);
+                    vals[ii] = dVal;
+                    intVals[ii] = (uint64_t)dVal;
+                }
+                    break;
+            }
+        }
+
+        switch (tag)
+        {
+            case TagNewSubfileType:
+                subfileType = (int)intVals[0];
+                break;
+            case TagImageWidth:
+                img.width = (int)intVals[0];
+                break;
+            case TagImageLength:
+                img.height = (int)intVals[0];
+                break;
+            case TagBitsPerSample:
+                img.bitsPerSample = (int)intVals[0];
+                break;
+            case TagCompression:
+                img.compression = (int)intVals[0];
+                break;
+            case TagPhotometric:
+                img.photometric = (int)intVals[0];
+                break;
+            case TagStripOffsets:
+            case TagTileOffsets:
+                img.blockOffsets = intVals;
+                img.tiled |= (tag == TagTileOffsets);
+                break;
+            case TagStripByteCounts:
+            case TagTileByteCounts:
+                img.blockByteCounts = intVals;
+                break;
+            case TagSamplesPerPixel:
+                img.samplesPerPixel = (int)intVals[0];
+                break;
+            case TagRowsPerStrip:
+                rowsPerStrip = (int)std::min(intVals[0],(uint64_t)(1<<30));
+                break;
+            case TagPlanarConfig:
+                img.planarConfig = (int)intVals[0];
+                break;
+            case TagPredictor:
+                img.predictor = (int)intVals[0];
+                break;
+            case TagColorMap:
+                img.colorMap.resize(count);
+                for (uint64_t ii=0;ii<count;ii++)
+                    img.colorMap[ii] = (unsigned short)intVals[ii];
+                break;
+            case TagTileWidth:
+                img.blockWidth = (int)intVals[0];
+                break;
+            case TagTileLength:
+                img.blockHeight = (int)intVals[0];
+                break;
+            case TagExtraSamples:
+                extraSamples = vals;
+                break;
+            case TagSampleFormat:
+                img.sampleFormat = (int)intVals[0];
+                break;
+            case TagModelPixelScale:
+                pixelScale = vals;
+                break;
+            case TagModelTiepoint:
+                tiePoints = vals;
+                break;
+            case TagModelTransformation:
+                modelTransform = vals;
+                break;
+            case TagGeoKeyDirectory:
+                keyDir = vals;
+                break;
+            case TagGeoDoubleParams:
+                doubleParams = vals;
+                break;
+            default:
+                break;
+        }
+    }
+
+    img.isOverview = subfileType & 0x1;
+    img.isMask = subfileType & 0x4;
+
+    // Strips are just very wide tiles
+    if (!img.tiled)
+    {
+        img.blockWidth = img.width;
+        img.blockHeight = (rowsPerStrip > 0 && rowsPerStrip < img.height) ? rowsPerStrip : img.height;
+    }
+    if (img.width <= 0 || img.height <= 0 || img.blockWidth <= 0 || img.blockHeight <= 0)
+        return true;
+    img.blocksAcross = (img.width + img.blockWidth - 1) / img.blockWidth;
+    img.blocksDown = (img.height + img.blockHeight - 1) / img.blockHeight;
+
+    // Only alpha counts among the extra samples
+    int numColor = (img.photometric == PhotoRGB || img.photometric == PhotoYCbCr) ? 3 : 1;
+    for (unsigned int ii=0;ii<extraSamples.size();ii++)
+        if (extraSamples[ii] == 1 || extraSamples[ii] == 2)
+        {
+            img.alphaSample = numColor + ii;
+            break;
+        }
+
+    // The first real image is the full resolution one and carries the georeferencing
+    if (images.empty())
+    {
+        if (img.isMask)
+            return true;
+
+        if (modelTransform.size() >= 16)
+        {
+            georef.transform[0] = modelTransform[3];
+            georef.transform[1] = modelTransform[0];
+            georef.transform[2] = modelTransform[1];
+            georef.transform[3] = modelTransform[7];
+            georef.transform[4] = modelTransform[4];
+            georef.transform[5] = modelTransform[5];
+            georef.valid = true;
+        } else if (tiePoints.size() >= 6 && pixelScale.size() >= 2)
+        {
+            georef.transform[0] = tiePoints[3] - tiePoints[0] * pixelScale[0];
+            georef.transform[1] = pixelScale[0];
+            georef.transform[2] = 0.0;
+            georef.transform[3] = tiePoints[4] + tiePoints[1] * pixelScale[1];
+            georef.transform[4] = 0.0;
+            georef.transform[5] = -pixelScale[1];
+            georef.valid = true;
+        }
+        if (!keyDir.empty())
+            readGeoKeys(keyDir,doubleParams,asciiParams);
+
+        // Point rasters have their tie point on the center of the pixel
+        if (georef.valid && georef.pixelIsPoint)
+        {
+            georef.transform[0] -= 0.5 * georef.transform[1] + 0.5 * georef.transform[2];
+            georef.transform[3] -= 0.5 * georef.transform[4] + 0.5 * georef.transform[5];
+        }
+
+        if (!noDataStr.empty())
+        {
+            hasNoData = true;
+            noData = atof(noDataStr.c_str());
+        }
+
+        images.push_back(img);
+    } else if (img.isOverview && !img.isMask && img.width < images[0].width)
+    {
+        // Overviews have to look like the main image to be any use
+        std::string why;
+        if (img.isSupported(why))
+            images.push_back(img);
+    }
+
+    return true;
+}
+
+bool GeoTIFFFile::readGeoKeys(const std::vector<double> &keyDir,const std::vector<double> &doubleParams,const std::string &asciiParams)
+{
+    if (keyDir.size() < 4)
+        return false;
+    int numKeys = (int)keyDir[3];
+    for (int ii=0;ii<numKeys && 4+ii*4+3 < keyDir.size();ii++)
+    {
+        int keyID = (int)keyDir[4+ii*4];
+        int location = (int)keyDir[4+ii*4+1];
+        int count = (int)keyDir[4+ii*4+2];
+        int valOffset = (int)keyDir[4+ii*4+3];
+
+        if (location == 0)
+            georef.keys[keyID] = valOffset;
+        else if (location == TagGeoDoubleParams)
+        {
+            if (valOffset >= 0 && valOffset < doubleParams.size())
+                georef.keys[keyID] = doubleParams[valOffset];
+        } else if (location == TagGeoAsciiParams)
+        {
+            if (valOffset >= 0 && valOffset < asciiParams.size())
+            {
+                std::string str = asciiParams.substr(valOffset,count);
+                // Strings are terminated with a pipe
+                if (!str.empty() && str[str.size()-1] == '|')
+                    str.resize(str.size()-1);
+                georef.asciiKeys[keyID] = str;
+            }
+        }
+    }
+
+    std::map<int,double>::iterator it = georef.keys.find(KeyModelType);
+    if (it != georef.keys.end())
+        georef.modelType = (int)it->second;
+    it = georef.keys.find(KeyRasterType);
+    if (it != georef.keys.end())
+        georef.pixelIsPoint = (it->second == 2);
+    if (georef.modelType == 1)
+    {
+        it = georef.keys.find(KeyProjectedCSType);
+        if (it != georef.keys.end())
+            georef.epsg = (int)it->second;
+    } else if (georef.modelType == 2)
+    {
+        it = georef.keys.find(KeyGeographicType);
+        if (it != georef.keys.end())
+            georef.epsg = (int)it->second;
+    }
+
+    return true;
+}
+
+Proj4CoordSystem *GeoTIFFFile::makeCoordSystem() const
+{
+    std::string projStr = georef.proj4String();
+    if (projStr.empty())
+        return NULL;
+
+    Proj4CoordSystem *coordSys = new Proj4CoordSystem(projStr);
+    if (!coordSys->isValid())
+    {
+        WHIRLYKIT_LOGE("GeoTIFF: Failed to set up coordinate system: %s",projStr.c_str());
+        delete coordSys;
+        return NULL;
+    }
+
+    return coordSys;
+}
+
+Point2d GeoTIFFFile::pixelToLocal(int image,const Point2d &pix) const
+{
+    // Overviews cover the same area with fewer pixels
+    double scaleX = (double)images[0].width / images[image].width;
+    double scaleY = (double)images[0].height / images[image].height;
+    double col = pix.x() * scaleX,row = pix.y() * scaleY;
+
+    const double *t = georef.transform;
+    Point2d loc(t[0] + col*t[1] + row*t[2],t[3] + col*t[4] + row*t[5]);
+    if (georef.isGeographic())
+        loc = Point2d(DegToRad(loc.x()),DegToRad(loc.y()));
+
+    return loc;
+}
+
+Point2d GeoTIFFFile::localToPixel(int image,const Point2d &inLoc) const
+{
+    Point2d loc = inLoc;
+    if (georef.isGeographic())
+        loc = Point2d(RadToDeg(loc.x()),RadToDeg(loc.y()));
+
+    const double *t = georef.transform;
+    double det = t[1]*t[5] - t[2]*t[4];
+    if (det == 0.0)
+        return Point2d(0,0);
+    double dx = loc.x() - t[0],dy = loc.y() - t[3];
+    double col = (t[5]*dx - t[2]*dy) / det;
+    double row = (-t[4]*dx + t[1]*dy) / det;
+
+    double scaleX = (double)images[image].width / images[0].width;
+    double scaleY = (double)images[image].height / images[0].height;
+
+    return Point2d(col * scaleX,row * scaleY);
+}
+
+Point2d GeoTIFFFile::pixelSize(int image) const
+{
+    Point2d org = pixelToLocal(image,Point2d(0,0));
+    Point2d right = pixelToLocal(image,Point2d(1,0));
+    Point2d down = pixelToLocal(image,Point2d(0,1));
+
+    return Point2d((right-org).norm(),(down-org).norm());
+}
+
+void GeoTIFFFile::getBounds(Point2d &ll,Point2d &ur) const
+{
+    const GeoTIFFImage &img = images[0];
+    Point2d corners[4] = {pixelToLocal(0,Point2d(0,0)),pixelToLocal(0,Point2d(img.width,0)),
+        pixelToLocal(0,Point2d(img.width,img.height)),pixelToLocal(0,Point2d(0,img.height))};
+    ll = ur = corners[0];
+    for (unsigned int ii=1;ii<4;ii++)
+    {
+        ll.x() = std::min(ll.x(),corners[ii].x());
+        ll.y() = std::min(ll.y(),corners[ii].y());
+        ur.x() = std::max(ur.x(),corners[ii].x());
+        ur.y() = std::max(ur.y(),corners[ii].y());
+    }
+}
+
+void GeoTIFFFile::setDataRange(double minVal,double maxVal)
+{
+    pthread_mutex_lock(&cacheLock);
+    dataMin = minVal;
+    dataMax = maxVal;
+    dataRangeSet = true;
+    blockCache.clear();
+    blockLRU.clear();
+    cacheSize = 0;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+void GeoTIFFFile::setNoData(double newNoData)
+{
+    pthread_mutex_lock(&cacheLock);
+    hasNoData = true;
+    noData = newNoData;
+    blockCache.clear();
+    blockLRU.clear();
+    cacheSize = 0;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+void GeoTIFFFile::clearNoData()
+{
+    pthread_mutex_lock(&cacheLock);
+    hasNoData = false;
+    blockCache.clear();
+    blockLRU.clear();
+    cacheSize = 0;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+void GeoTIFFFile::setCacheSize(size_t bytes)
+{
+    pthread_mutex_lock(&cacheLock);
+    maxCacheSize = bytes;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+// TIFF flavored LZW.  Codes are MSB first and the width goes up one code early.
+static bool DecodeLZW(const unsigned char *data,size_t len,std::vector<unsigned char> &out,size_t expectedLen)
+{
+    const int ClearCode = 256,EOICode = 257;
+    std::vector<int> prefix(4096),length(4096);
+    std::vector<unsigned char> suffix(4096),first(4096);
+    for (int ii=0;ii<256;ii++)
+    {
+        prefix[ii] = -1;
+        suffix[ii] = first[ii] = (unsigned char)ii;
+        length[ii] = 1;
+    }
+
+    out.clear();
+    out.reserve(expectedLen);
+    int nextCode = 258,codeLen = 9;
+    int oldCode = -1;
+    uint64_t bitPos = 0,totalBits = (uint64_t)len*8;
+    std::vector<unsigned char> str;
+
+    while (bitPos + codeLen <= totalBits)
+    {
+        int code = 0;
+        for (int ii=0;ii<codeLen;ii++,bitPos++)
+            code = (code << 1) | ((data[bitPos >> 3] >> (7 - (bitPos & 7))) & 1);
+
+        if (code == EOICode)
+            break;
+        if (code == ClearCode)
+        {
+            nextCode = 258;
+            codeLen = 9;
+            oldCode = -1;
+            continue;
+        }
+
+        if (oldCode == -1)
+        {
+            if (code > 255)
+                return false;
+            out.push_back((unsigned char)code);
+            oldCode = code;
+            continue;
+        }
+
+        int outCode = code;
+        unsigned char firstChar;
+        if (code < nextCode)
+            firstChar = first[code];
+        else if (code == nextCode)
+        {
+            firstChar = first[oldCode];
+            outCode = oldCode;
+        } else
+            return false;
+
+        // Spit out the string for the code (or the old one for the special case)
+        size_t start = out.size();
+        out.resize(start + length[outCode]);
+        for (int which = outCode, pos = length[outCode]-1; which >= 0; which = prefix[which], pos--)
+            out[start+pos] = suffix[which];
+        if (code == nextCode)
+            out.push_back(firstChar);
+
+        if (nextCode < 4096)
+        {
+            prefix[nextCode] = oldCode;
+            suffix[nextCode] = firstChar;
+            first[nextCode] = first[oldCode];
+            length[nextCode] = length[oldCode] + 1;
+            nextCode++;
+        }
+        if (nextCode >= (1 << codeLen) - 1 && codeLen < 12)
+            codeLen++;
+        oldCode = code;
+
+        if (out.size() >= expectedLen)
+            break;
+    }
+
+    return true;
+}
+
+static bool DecodePackBits(const unsigned char *data,size_t len,std::vector<unsigned char> &out,size_t expectedLen)
+{
+    out.clear();
+    out.reserve(expectedLen);
+    size_t pos = 0;
+    while (pos < len && out.size() < expectedLen)
+    {
+        int n = (signed char)data[pos++];
+        if (n >= 0)
+        {
+            size_t num = std::min((size_t)n+1,len-pos);
+            out.insert(out.end(),data+pos,data+pos+num);
+            pos += num;
+        } else if (n != -128)
+        {
+            if (pos >= len)
+                break;
+            out.insert(out.end(),1-n,data[pos++]);
+        }
+    }
+
+    return true;
+}
+
+static bool DecodeDeflate(const unsigned char *data,size_t len,std::vector<unsigned char> &out,size_t expectedLen)
+{
+    out.resize(expectedLen);
+    z_stream stream;
+    memset(&stream,0,sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        return false;
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = (uInt)len;
+    stream.next_out = &out[0];
+    stream.avail_out = (uInt)expectedLen;
+    int ret = inflate(&stream,Z_FINISH);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+
+    return ret == Z_STREAM_END || ret == Z_OK || ret == Z_BUF_ERROR;
+}
+
+bool GeoTIFFFile::decodePlane(const GeoTIFFImage &img,int which,int numSamples,int rows,std::vector<unsigned char> &samples)
+{
+    samples.clear();
+    if (which >= img.blockOffsets.size())
+        return false;
+    uint64_t offset = img.blockOffsets[which];
+    uint64_t byteCount = img.blockByteCounts[which];
+    // Sparse files leave out empty blocks
+    if (offset == 0 || byteCount == 0)
+        return true;
+
+    size_t rowBytes = ((size_t)img.blockWidth * numSamples * img.bitsPerSample + 7) / 8;
+    size_t expectedLen = rowBytes * rows;
+
+    // Don't trust the byte count to size the buffer.  It has to fit in the file, and
+    //  compressed data can only be so much bigger than what it decodes to.
+    // Uncompressed strips at the bottom often claim a full strip, so just read what we need.
+    if (img.compression == CompressNone)
+        byteCount = std::min(byteCount,(uint64_t)expectedLen);
+    if (byteCount > bytesLeft(offset) || byteCount > 2*(uint64_t)expectedLen + 4096)
+    {
+        WHIRLYKIT_LOGE("GeoTIFF: Block %d claims %llu bytes, which is more than it can be",which,(unsigned long long)byteCount);
+        return false;
+    }
+
+    std::vector<unsigned char> compressed(byteCount);
+    pthread_mutex_lock(&fileLock);
+    bool readOK = readBytes(offset,byteCount,&compressed[0]);
+    pthread_mutex_unlock(&fileLock);
+    if (!readOK)
+    {
+        WHIRLYKIT_LOGE("GeoTIFF: Failed to read block %d",which);
+        return false;
+    }
+
+    bool decodeOK = true;
+    switch (img.compression)
+    {
+        case CompressNone:
+            samples.swap(compressed);
+            break;
+        case CompressLZW:
+            decodeOK = DecodeLZW(&compressed[0],compressed.size(),samples,expectedLen);
+            break;
+        case CompressDeflate:
+        case CompressDeflateOld:
+            decodeOK = DecodeDeflate(&compressed[0],compressed.size(),samples,expectedLen);
+            break;
+        case CompressPackBits:
+            decodeOK = DecodePackBits(&compressed[0],compressed.size(),samples,expectedLen);
+            break;
+        case CompressJPEG:
+        {
+            JPEGDecoder decoder;
+            if (!img.jpegTables.empty())
+                decoder.readTables(&img.jpegTables[0],img.jpegTables.size());
+            // libtiff leaves three component data as it found it unless it's tagged YCbCr
+            if (numSamples == 3)
+                decoder.setColorTransform(img.photometric == PhotoYCbCr ? 1 : 0);
+            std::vector<unsigned char> pixels;
+            int jpegWidth,jpegHeight,jpegComps;
+            decodeOK = decoder.decode(&compressed[0],compressed.size(),pixels,jpegWidth,jpegHeight,jpegComps);
+            if (decodeOK && jpegComps == numSamples)
+            {
+                samples.assign(expectedLen,0);
+                int copyRows = std::min(rows,jpegHeight);
+                size_t copyBytes = std::min((size_t)jpegWidth * jpegComps,rowBytes);
+                for (int iy=0;iy<copyRows;iy++)
+                    memcpy(&samples[iy*rowBytes],&pixels[iy*jpegWidth*jpegComps],copyBytes);
+            } else {
+                if (decodeOK)
+                    WHIRLYKIT_LOGE("GeoTIFF: JPEG has %d components, expected %d",jpegComps,numSamples);
+                else
+                    WHIRLYKIT_LOGE("GeoTIFF: JPEG decode failed: %s",decoder.getError().c_str());
+                decodeOK = false;
+            }
+        }
+            break;
+        default:
+            decodeOK = false;
+            break;
+    }
+    if (!decodeOK)
+    {
+        samples.clear();
+        return false;
+    }
+    samples.resize(expectedLen,0);
+
+    int bytesPerSample = img.bitsPerSample / 8;
+    size_t valsPerRow = (size_t)img.blockWidth * numSamples;
+    if (img.predictor == 3 && bytesPerSample > 1)
+    {
+        // Floating point predictor.  Bytes are split into planes, most significant first, and then differenced.
+        std::vector<unsigned char> rowBuf(rowBytes);
+        uint16_t hostTest = 1;
+        bool hostLittle = *(unsigned char *)&hostTest == 1;
+        for (int iy=0;iy<rows;iy++)
+        {
+            unsigned char *row = &samples[iy*rowBytes];
+            for (size_t ii=numSamples;ii<rowBytes;ii++)
+                row[ii] += row[ii-numSamples];
+            memcpy(&rowBuf[0],row,rowBytes);
+            for (size_t iv=0;iv<valsPerRow;iv++)
+                for (int ib=0;ib<bytesPerSample;ib++)
+                {
+                    int dest = hostLittle ? (bytesPerSample-1-ib) : ib;
+                    row[iv*bytesPerSample+dest] = rowBuf[ib*valsPerRow+iv];
+                }
+        }
+        return true;
+    }
+
+    // Get multi-byte samples into our byte order
+    if (swapBytes && bytesPerSample > 1)
+    {
+        for (size_t ii=0;ii+bytesPerSample<=samples.size();ii+=bytesPerSample)
+            std::reverse(&samples[ii],&samples[ii+bytesPerSample]);
+    }
+
+    // Horizontal differencing
+    if (img.predictor == 2)
+    {
+        for (int iy=0;iy<rows;iy++)
+        {
+            unsigned char *row = &samples[iy*rowBytes];
+            switch (img.bitsPerSample)
+            {
+                case 8:
+                    for (size_t ii=numSamples;ii<valsPerRow;ii++)
+                        row[ii] += row[ii-numSamples];
+                    break;
+                case 16:
+                {
+                    uint16_t *vals = (uint16_t *)row;
+                    for (size_t ii=numSamples;ii<valsPerRow;ii++)
+                        vals[ii] += vals[ii-numSamples];
+                }
+                    break;
+                case 32:
+                {
+                    uint32_t *vals = (uint32_t *)row;
+                    for (size_t ii=numSamples;ii<valsPerRow;ii++)
+                        vals[ii] += vals[ii-numSamples];
+                }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Pull a single sample out of a row as a double
+static inline double GetSample(const unsigned char *row,size_t which,int bitsPerSample,int sampleFormat)
+{
+    switch (bitsPerSample)
+    {
+        case 1: case 2: case 4:
+        {
+            size_t bitPos = which * bitsPerSample;
+            int shift = 8 - bitsPerSample - (int)(bitPos & 7);
+            return (row[bitPos >> 3] >> shift) & ((1 << bitsPerSample) - 1);
+        }
+        case 8:
+            return sampleFormat == 2 ? (double)(int8_t)row[which] : (double)row[which];
+        case 16:
+        {
+            uint16_t val;
+            memcpy(&val,&row[which*2],2);
+            return sampleFormat == 2 ? (double)(int16_t)val : (double)val;
+        }
+        case 32:
+        {
+            uint32_t val;
+            memcpy(&val,&row[which*4],4);
+            if (sampleFormat == 3)
+            {
+                float fVal;
+                memcpy(&fVal,&val,4);
+                return fVal;
+            }
+            return sampleFormat == 2 ? (double)(int32_t)val : (double)val;
+        }
+        case 64:
+        {
+            uint64_t val;
+            memcpy(&val,&row[which*8],8);
+            if (sampleFormat == 3)
+            {
+                double dVal;
+                memcpy(&dVal,&val,8);
+                return dVal;
+            }
+            return sampleFormat == 2 ? (double)(int64_t)val : (double)val;
+        }
+        default:
+            return 0.0;
+    }
+}
+
+void GeoTIFFFile::convertToRGBA(const GeoTIFFImage &img,const std::vector<unsigned char> &samples,int rows,std::vector<unsigned char> &rgba)
+{
+    int spp = img.samplesPerPixel;
+    size_t rowBytes = ((size_t)img.blockWidth * spp * img.bitsPerSample + 7) / 8;
+    bool isColor = (img.photometric == PhotoRGB || img.photometric == PhotoYCbCr);
+    int numColor = isColor ? 3 : 1;
+
+    // Work out how to get samples into 0-255
+    double minVal = 0.0,maxVal = 255.0;
+    if (dataRangeSet)
+    {
+        minVal = dataMin;
+        maxVal = dataMax;
+    } else if (img.bitsPerSample < 8)
+        maxVal = (1 << img.bitsPerSample) - 1;
+    else if (img.sampleFormat == 3)
+        maxVal = 1.0;
+    else if (img.bitsPerSample > 8)
+    {
+        double range = pow(2.0,img.bitsPerSample);
+        minVal = (img.sampleFormat == 2) ? -range/2.0 : 0.0;
+        maxVal = minVal + range - 1.0;
+    } else if (img.sampleFormat == 2)
+    {
+        minVal = -128.0;
+        maxVal = 127.0;
+    }
+    double scale = (maxVal > minVal) ? 255.0 / (maxVal - minVal) : 1.0;
+    auto toByte = [minVal,scale](double val) -> unsigned char
+    {
+        double res = (val - minVal) * scale;
+        if (res != res)
+            return 0;
+        return (unsigned char)std::min(std::max(res + 0.5,0.0),255.0);
+    };
+    int paletteSize = (int)img.colorMap.size() / 3;
+
+    for (int iy=0;iy<rows;iy++)
+    {
+        const unsigned char *row = &samples[iy*rowBytes];
+        unsigned char *out = &rgba[(size_t)iy*img.blockWidth*4];
+        for (int ix=0;ix<img.blockWidth;ix++,out+=4)
+        {
+            size_t base = (size_t)ix * spp;
+            double vals[3];
+            bool isNoData = hasNoData;
+            for (int ic=0;ic<numColor;ic++)
+            {
+                vals[ic] = GetSample(row,base+ic,img.bitsPerSample,img.sampleFormat);
+                if (isNoData && vals[ic] != noData && fabs(vals[ic] - noData) > 1e-6 * std::max(1.0,fabs(noData)))
+                    isNoData = false;
+            }
+
+            if (isNoData)
+            {
+                out[0] = out[1] = out[2] = out[3] = 0;
+                continue;
+            }
+
+            switch (img.photometric)
+            {
+                case PhotoPalette:
+                {
+                    int idx = (int)vals[0];
+                    if (idx >= 0 && idx < paletteSize)
+                    {
+                        out[0] = img.colorMap[idx] >> 8;
+                        out[1] = img.colorMap[paletteSize+idx] >> 8;
+                        out[2] = img.colorMap[2*paletteSize+idx] >> 8;
+                    } else
+                        out[0] = out[1] = out[2] = 0;
+                }
+                    break;
+                case PhotoWhiteIsZero:
+                    out[0] = out[1] = out[2] = 255 - toByte(vals[0]);
+                    break;
+                case PhotoRGB:
+                case PhotoYCbCr:
+                    if (img.bitsPerSample == 8 && img.sampleFormat == 1 && !dataRangeSet)
+                    {
+                        out[0] = (unsigned char)vals[0];  out[1] = (unsigned char)vals[1];  out[2] = (unsigned char)vals[2];
+                    } else {
+                        out[0] = toByte(vals[0]);  out[1] = toByte(vals[1]);  out[2] = toByte(vals[2]);
+                    }
+                    break;
+                default:
+                    out[0] = out[1] = out[2] = toByte(vals[0]);
+                    break;
+            }
+
+            if (img.alphaSample >= 0 && img.alphaSample < spp)
+            {
+                double alpha = GetSample(row,base+img.alphaSample,img.bitsPerSample,img.sampleFormat);
+                if (img.bitsPerSample == 8)
+                    out[3] = (unsigned char)alpha;
+                else if (img.bitsPerSample == 16)
+                    out[3] = (unsigned char)((int)alpha >> 8);
+                else
+                    out[3] = (unsigned char)std::min(std::max(alpha * 255.0,0.0),255.0);
+            } else
+                out[3] = 255;
+        }
+    }
+}
+
+bool GeoTIFFFile::decodeBlock(int image,int blockX,int blockY,std::vector<unsigned char> &rgba)
+{
+    const GeoTIFFImage &img = images[image];
+    int rows = img.tiled ? img.blockHeight : std::min(img.blockHeight,img.height - blockY*img.blockHeight);
+    int blockIdx = blockY * img.blocksAcross + blockX;
+    rgba.assign((size_t)img.blockWidth * img.blockHeight * 4,0);
+
+    std::vector<unsigned char> samples;
+    if (img.planarConfig == 2 && img.samplesPerPixel > 1)
+    {
+        // Separate planes get stitched back together
+        int bytesPerSample = img.bitsPerSample / 8;
+        if (bytesPerSample < 1)
+            return false;
+        int blocksPerPlane = img.blocksAcross * img.blocksDown;
+        size_t numPixels = (size_t)img.blockWidth * rows;
+        samples.resize(numPixels * img.samplesPerPixel * bytesPerSample);
+        for (int ip=0;ip<img.samplesPerPixel;ip++)
+        {
+            std::vector<unsigned char> plane;
+            if (!decodePlane(img,ip*blocksPerPlane+blockIdx,1,rows,plane))
+                return false;
+            if (plane.empty())
+                return true;
+            for (size_t ii=0;ii<numPixels;ii++)
+                memcpy(&samples[(ii*img.samplesPerPixel+ip)*bytesPerSample],&plane[ii*bytesPerSample],bytesPerSample);
+        }
+    } else {
+        if (!decodePlane(img,blockIdx,img.samplesPerPixel,rows,samples))
+            return false;
+        // Sparse block, leave it transparent
+        if (samples.empty())
+            return true;
+    }
+
+    convertToRGBA(img,samples,rows,rgba);
+
+    return true;
+}
+
+GeoTIFFFile::BlockRef GeoTIFFFile::getBlock(int image,int blockX,int blockY)
+{
+    if (image < 0 || image >= images.size())
+        return BlockRef();
+    const GeoTIFFImage &img = images[image];
+    if (blockX < 0 || blockY < 0 || blockX >= img.blocksAcross || blockY >= img.blocksDown)
+        return BlockRef();
+
+    uint64_t key = ((uint64_t)image << 48) | ((uint64_t)blockY << 24) | (uint64_t)blockX;
+    pthread_mutex_lock(&cacheLock);
+    std::map<uint64_t,CachedBlock>::iterator it = blockCache.find(key);
+    if (it != blockCache.end())
+    {
+        blockLRU.splice(blockLRU.begin(),blockLRU,it->second.lruPos);
+        BlockRef ret = it->second.data;
+        pthread_mutex_unlock(&cacheLock);
+        return ret;
+    }
+    pthread_mutex_unlock(&cacheLock);
+
+    // Decode outside the lock so other threads can get at the cache
+    BlockRef block(new std::vector<unsigned char>());
+    if (!decodeBlock(image,blockX,blockY,*block))
+        return BlockRef();
+
+    pthread_mutex_lock(&cacheLock);
+    if (blockCache.find(key) == blockCache.end())
+    {
+        blockLRU.push_front(key);
+        CachedBlock &cached = blockCache[key];
+        cached.data = block;
+        cached.lruPos = blockLRU.begin();
+        cacheSize += block->size();
+
+        // Toss the oldest blocks until we fit
+        while (cacheSize > maxCacheSize && blockLRU.size() > 1)
+        {
+            uint64_t oldKey = blockLRU.back();
+            blockLRU.pop_back();
+            std::map<uint64_t,CachedBlock>::iterator oldIt = blockCache.find(oldKey);
+            if (oldIt != blockCache.end())
+            {
+                cacheSize -= oldIt->second.data->size();
+                blockCache.erase(oldIt);
+            }
+        }
+    }
+    pthread_mutex_unlock(&cacheLock);
+
+    return block;
+}
+
+bool GeoTIFFFile::readBlock(int image,int blockX,int blockY,std::vector<unsigned char> &rgba)
+{
+    BlockRef block = getBlock(image,blockX,blockY);
+    if (!block)
+        return false;
+    rgba = *block;
+
+    return true;
+}
+
+bool GeoTIFFFile::readRegion(int image,int x,int y,int width,int height,unsigned char *rgba)
+{
+    if (image < 0 || image >= images.size())
+        return false;
+    const GeoTIFFImage &img = images[image];
+
+    int startX = std::max(x,0),endX = std::min(x+width,img.width);
+    int startY = std::max(y,0),endY = std::min(y+height,img.height);
+    if (startX >= endX || startY >= endY)
+        return true;
+
+    bool success = true;
+    for (int by=startY/img.blockHeight;by<=(endY-1)/img.blockHeight;by++)
+        for (int bx=startX/img.blockWidth;bx<=(endX-1)/img.blockWidth;bx++)
+        {
+            BlockRef block = getBlock(image,bx,by);
+            if (!block)
+            {
+                success = false;
+                continue;
+            }
+
+            // Copy the part of the block we overlap
+            int blockX0 = bx*img.blockWidth,blockY0 = by*img.blockHeight;
+            int x0 = std::max(startX,blockX0),x1 = std::min(endX,blockX0+img.blockWidth);
+            int y0 = std::max(startY,blockY0),y1 = std::min(endY,blockY0+img.blockHeight);
+            for (int iy=y0;iy<y1;iy++)
+                memcpy(&rgba[((size_t)(iy-y)*width + (x0-x))*4],
+                       &(*block)[((size_t)(iy-blockY0)*img.blockWidth + (x0-blockX0))*4],
+                       (x1-x0)*4);
+        }
+
+    return success;
+}
+
+bool GeoTIFFFile::getPixel(int image,int x,int y,unsigned char *rgba)
+{
+    if (image < 0 || image >= images.size())
+        return false;
+    const GeoTIFFImage &img = images[image];
+    if (x < 0 || y < 0 || x >= img.width || y >= img.height)
+        return false;
+
+    BlockRef block = getBlock(image,x/img.blockWidth,y/img.blockHeight);
+    if (!block)
+        return false;
+    memcpy(rgba,&(*block)[((size_t)(y % img.blockHeight)*img.blockWidth + (x % img.blockWidth))*4],4);
+
+    return true;
+}
+
+GeoTIFFTileSource::GeoTIFFTileSource(GeoTIFFFileRef file,CoordSystem *destSystem,TileMatrixSetRef tileMatrixSet,int tileSize)
+    : file(file), destSystem(destSystem), srcSystem(NULL), sameSystem(false), tileMatrixSet(tileMatrixSet),
+    tileSize(tileSize), sampleGrid(16), bilinear(true)
+{
+    srcSystem = file->makeCoordSystem();
+    if (!srcSystem)
+    {
+        WHIRLYKIT_LOGE("GeoTIFF: Don't know the coordinate system, assuming it's the same as the destination");
+        sameSystem = true;
+    } else
+        sameSystem = destSystem->isSameAs(srcSystem);
+    file->getBounds(srcLL,srcUR);
+}
+
+GeoTIFFTileSource::~GeoTIFFTileSource()
+{
+    if (srcSystem)
+        delete srcSystem;
+}
+
+TileMatrixSetRef GeoTIFFTileSource::MakeNativeTileMatrixSet(GeoTIFFFileRef file,int tileSize)
+{
+    TileMatrixSetRef tms(new TileMatrixSet());
+
+    // Smallest overview at the top, full resolution at the bottom
+    for (int ii=file->getNumImages()-1;ii>=0;ii--)
+    {
+        const GeoTIFFImage &img = file->getImage(ii);
+        Point2d pixSize = file->pixelSize(ii);
+        Point2d topLeft = file->pixelToLocal(ii,Point2d(0,0));
+        Point2d tileSpan(pixSize.x()*tileSize,pixSize.y()*tileSize);
+        int matrixWidth = (img.width + tileSize - 1) / tileSize;
+        int matrixHeight = (img.height + tileSize - 1) / tileSize;
+        tms->addLevel(TileMatrix(Point2d(topLeft.x(),topLeft.y() - matrixHeight*tileSpan.y()),tileSpan,matrixWidth,matrixHeight));
+    }
+
+    return tms;
+}
+
+Point2d GeoTIFFTileSource::destToSource(const Point2d &pt)
+{
+    if (sameSystem)
+        return pt;
+
+    Point3d srcPt = CoordSystemConvert3d(destSystem,srcSystem,Point3d(pt.x(),pt.y(),0.0));
+    return Point2d(srcPt.x(),srcPt.y());
+}
+
+bool GeoTIFFTileSource::tileOverlaps(const Quadtree::Identifier &ident)
+{
+    Point2d ll,ur;
+    tileMatrixSet->calcTileMbr(ident,ll,ur);
+
+    // Check a few points along the edges, since reprojection can bend them
+    const int numEdge = 4;
+    Point2d srcMin(MAXFLOAT,MAXFLOAT),srcMax(-MAXFLOAT,-MAXFLOAT);
+    for (int iy=0;iy<=numEdge;iy++)
+        for (int ix=0;ix<=numEdge;ix++)
+        {
+            Point2d srcPt = destToSource(Point2d(ll.x() + (ur.x()-ll.x())*ix/numEdge,ll.y() + (ur.y()-ll.y())*iy/numEdge));
+            if (!std::isfinite(srcPt.x()) || !std::isfinite(srcPt.y()) || fabs(srcPt.x()) > 1e20)
+                continue;
+            srcMin.x() = std::min(srcMin.x(),srcPt.x());  srcMin.y() = std::min(srcMin.y(),srcPt.y());
+            srcMax.x() = std::max(srcMax.x(),srcPt.x());  srcMax.y() = std::max(srcMax.y(),srcPt.y());
+        }
+
+    return srcMin.x() <= srcUR.x() && srcMax.x() >= srcLL.x() && srcMin.y() <= srcUR.y() && srcMax.y() >= srcLL.y();
+}
+
+int GeoTIFFTileSource::calcMaxLevel()
+{
+    // Size of a full resolution pixel in the destination system, near the middle of the image
+    const GeoTIFFImage &img = file->getImage(0);
+    Point2d center = file->pixelToLocal(0,Point2d(img.width/2.0,img.height/2.0));
+    Point2d next = file->pixelToLocal(0,Point2d(img.width/2.0+1.0,img.height/2.0+1.0));
+    Point3d destCenter = sameSystem ? Point3d(center.x(),center.y(),0.0) : CoordSystemConvert3d(srcSystem,destSystem,Point3d(center.x(),center.y(),0.0));
+    Point3d destNext = sameSystem ? Point3d(next.x(),next.y(),0.0) : CoordSystemConvert3d(srcSystem,destSystem,Point3d(next.x(),next.y(),0.0));
+    double destPixSize = std::min(fabs(destNext.x()-destCenter.x()),fabs(destNext.y()-destCenter.y()));
+
+    for (int level=0;level<tileMatrixSet->getNumLevels();level++)
+    {
+        const TileMatrix &matrix = tileMatrixSet->getLevel(level);
+        if (std::max(matrix.tileSpan.x(),matrix.tileSpan.y()) / tileSize <= destPixSize * 1.01)
+            return level;
+    }
+
+    return tileMatrixSet->getNumLevels()-1;
+}
+
+RawDataRef GeoTIFFTileSource::fetchTile(const Quadtree::Identifier &ident)
+{
+    if (!tileMatrixSet->isValidTile(ident))
+        return RawDataRef();
+    Point2d ll,ur;
+    tileMatrixSet->calcTileMbr(ident,ll,ur);
+
+    // Convert a grid of points exactly, straight to full resolution pixels.  Rows go from the top down.
+    int gridSize = sampleGrid+1;
+    std::vector<Point2d,Eigen::aligned_allocator<Point2d> > grid(gridSize*gridSize);
+    std::vector<bool> gridValid(gridSize*gridSize);
+    Point2d pixMin(MAXFLOAT,MAXFLOAT),pixMax(-MAXFLOAT,-MAXFLOAT);
+    const GeoTIFFImage &fullImg = file->getImage(0);
+    for (int iy=0;iy<gridSize;iy++)
+        for (int ix=0;ix<gridSize;ix++)
+        {
+            Point2d destPt(ll.x() + (ur.x()-ll.x())*ix/sampleGrid,ur.y() - (ur.y()-ll.y())*iy/sampleGrid);
+            Point2d srcPt = destToSource(destPt);
+            bool valid = std::isfinite(srcPt.x()) && std::isfinite(srcPt.y()) && fabs(srcPt.x()) < 1e20;
+            Point2d pix = valid ? file->localToPixel(0,srcPt) : Point2d(0,0);
+            grid[iy*gridSize+ix] = pix;
+            gridValid[iy*gridSize+ix] = valid;
+            if (valid)
+            {
+                pixMin.x() = std::min(pixMin.x(),pix.x());  pixMin.y() = std::min(pixMin.y(),pix.y());
+                pixMax.x() = std::max(pixMax.x(),pix.x());  pixMax.y() = std::max(pixMax.y(),pix.y());
+            }
+        }
+    if (pixMax.x() < 0.0 || pixMax.y() < 0.0 || pixMin.x() > fullImg.width || pixMin.y() > fullImg.height)
+        return RawDataRef();
+
+    // Pick the smallest overview that still has enough resolution
+    double pixPerOut = std::max(pixMax.x()-pixMin.x(),pixMax.y()-pixMin.y()) / tileSize;
+    int image = 0;
+    for (int ii=1;ii<file->getNumImages();ii++)
+    {
+        double factor = (double)fullImg.width / file->getImage(ii).width;
+        if (factor <= pixPerOut * 1.01)
+            image = ii;
+    }
+    const GeoTIFFImage &img = file->getImage(image);
+    double scaleX = (double)img.width / fullImg.width,scaleY = (double)img.height / fullImg.height;
+
+    // Read just the window we need from that image
+    int winX0 = std::max((int)floor(pixMin.x()*scaleX) - 1,0);
+    int winY0 = std::max((int)floor(pixMin.y()*scaleY) - 1,0);
+    int winX1 = std::min((int)ceil(pixMax.x()*scaleX) + 1,img.width);
+    int winY1 = std::min((int)ceil(pixMax.y()*scaleY) + 1,img.height);
+    if (winX0 >= winX1 || winY0 >= winY1)
+        return RawDataRef();
+    int winWidth = winX1-winX0,winHeight = winY1-winY0;
+    std::vector<unsigned char> window((size_t)winWidth*winHeight*4,0);
+    file->readRegion(image,winX0,winY0,winWidth,winHeight,&window[0]);
+
+    auto winPixel = [&](int x,int y) -> const unsigned char *
+    {
+        x = std::min(std::max(x,0),winWidth-1);
+        y = std::min(std::max(y,0),winHeight-1);
+        return &window[((size_t)y*winWidth + x)*4];
+    };
+
+    std::vector<unsigned char> tileData((size_t)tileSize*tileSize*4,0);
+    for (int py=0;py<tileSize;py++)
+    {
+        double gy = (py + 0.5) / tileSize * sampleGrid;
+        int cy = std::min((int)gy,sampleGrid-1);
+        double ty = gy - cy;
+        for (int px=0;px<tileSize;px++)
+        {
+            double gx = (px + 0.5) / tileSize * sampleGrid;
+            int cx = std::min((int)gx,sampleGrid-1);
+            double tx = gx - cx;
+            int c00 = cy*gridSize+cx,c10 = c00+1,c01 = c00+gridSize,c11 = c01+1;
+            if (!gridValid[c00] || !gridValid[c10] || !gridValid[c01] || !gridValid[c11])
+                continue;
+
+            // Interpolate the source location within the grid cell
+            Point2d pix = (grid[c00]*(1.0-tx) + grid[c10]*tx)*(1.0-ty) + (grid[c01]*(1.0-tx) + grid[c11]*tx)*ty;
+            if (pix.x() < 0.0 || pix.y() < 0.0 || pix.x() >= fullImg.width || pix.y() >= fullImg.height)
+                continue;
+            double sx = pix.x()*scaleX - winX0,sy = pix.y()*scaleY - winY0;
+
+            unsigned char *out = &tileData[((size_t)py*tileSize + px)*4];
+            if (bilinear)
+            {
+                double fx = sx - 0.5,fy = sy - 0.5;
+                int x0 = (int)floor(fx),y0 = (int)floor(fy);
+                double wx = fx - x0,wy = fy - y0;
+                const unsigned char *p00 = winPixel(x0,y0),*p10 = winPixel(x0+1,y0);
+                const unsigned char *p01 = winPixel(x0,y0+1),*p11 = winPixel(x0+1,y0+1);
+                // Weight by alpha so transparent pixels don't bleed their color
+                double w00 = (1.0-wx)*(1.0-wy)*p00[3],w10 = wx*(1.0-wy)*p10[3];
+                double w01 = (1.0-wx)*wy*p01[3],w11 = wx*wy*p11[3];
+                double wSum = w00+w10+w01+w11;
+                if (wSum <= 0.0)
+                    continue;
+                for (int ic=0;ic<3;ic++)
+                    out[ic] = (unsigned char)std::min((p00[ic]*w00 + p10[ic]*w10 + p01[ic]*w01 + p11[ic]*w11) / wSum + 0.5,255.0);
+                out[3] = (unsigned char)std::min(wSum + 0.5,255.0);
+            } else
+                memcpy(out,winPixel((int)sx,(int)sy),4);
+        }
+    }
+
+    return RawDataRef(new MutableRawData(&tileData[0],(unsigned int)tileData.size()));
+}
+
+}
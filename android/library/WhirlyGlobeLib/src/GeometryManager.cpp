@@ -23,6 +23,7 @@
 #import "BaseInfo.h"
 #import "BasicDrawableInstance.h"
 #import "SharedAttributes.h"
+#import "IntersectionManager.h"
 
 using namespace Eigen;
 using namespace WhirlyKit;
@@ -615,12 +616,21 @@ void GeometryRawPoints::buildDrawables(std::vector<BasicDrawable *> &draws,const
 
     
 GeometryManager::GeometryManager()
+    : meshIntersect(new MeshIntersectable()), meshIntersectRegistered(false)
 {
     pthread_mutex_init(&geomLock, NULL);
 }
     
 GeometryManager::~GeometryManager()
 {
+    if (meshIntersectRegistered && scene)
+    {
+        IntersectionManager *intersectManager = (IntersectionManager *)scene->getManager(kWKIntersectionManager);
+        if (intersectManager)
+            intersectManager->removeIntersectable(meshIntersect);
+    }
+    delete meshIntersect;
+    
     pthread_mutex_destroy(&geomLock);
     for (GeomSceneRepSet::iterator it = sceneReps.begin();
          it != sceneReps.end(); ++it)
@@ -628,8 +638,46 @@ GeometryManager::~GeometryManager()
     sceneReps.clear();
 }
     
+MeshBVHRef GeometryManager::makeBVH(const std::vector<GeometryRaw *> &geom)
+{
+    MeshBVHRef bvh(new MeshBVH());
+    std::vector<int> triVerts;
+    for (const GeometryRaw *raw : geom)
+    {
+        if (raw->type != WhirlyKitGeometryTriangles || raw->pts.empty())
+            continue;
+        triVerts.clear();
+        triVerts.reserve(3*raw->triangles.size());
+        for (const GeometryRaw::RawTriangle &tri : raw->triangles)
+            for (unsigned int jj=0;jj<3;jj++)
+                triVerts.push_back(tri.verts[jj]);
+        bvh->addTriangles(&raw->pts[0],(int)raw->pts.size(),triVerts);
+    }
+    if (bvh->numTriangles() == 0)
+        return MeshBVHRef();
+    
+    meshIntersect->buildBVH(bvh);
+    
+    return bvh;
+}
+
+void GeometryManager::registerMeshIntersect()
+{
+    if (meshIntersectRegistered)
+        return;
+    
+    IntersectionManager *intersectManager = (IntersectionManager *)scene->getManager(kWKIntersectionManager);
+    if (intersectManager)
+    {
+        intersectManager->addIntersectable(meshIntersect);
+        meshIntersectRegistered = true;
+    }
+}
+    
 SimpleIdentity GeometryManager::addGeometry(std::vector<GeometryRaw *> &geom,const std::vector<GeometryInstance *> &instances,GeometryInfo &geomInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(geomInfo.memLabel);
     SelectionManager *selectManager = (SelectionManager *)scene->getManager(kWKSelectionManager);
     GeomSceneRep *sceneRep = new GeomSceneRep();
     
@@ -713,11 +761,25 @@ SimpleIdentity GeometryManager::addGeometry(std::vector<GeometryRaw *> &geom,con
         }
     }
     
+    // The instances share one BVH for ray intersection
+    MeshBVHRef bvh = makeBVH(geom);
+    if (bvh)
+        for (const GeometryInstance *inst : instances)
+            meshIntersect->addInstance(sceneRep->getId(), bvh, inst->mat, inst->getId(), geomInfo.minVis, geomInfo.maxVis, geomInfo.enable);
+    
+    // Keyframe tracks can animate the geometry as a whole
+    if (!sceneRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),sceneRep->drawIDs));
+    
     SimpleIdentity geomID = sceneRep->getId();
     
     pthread_mutex_lock(&geomLock);
+    if (bvh)
+        registerMeshIntersect();
     sceneReps.insert(sceneRep);
     pthread_mutex_unlock(&geomLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
     
     return geomID;
 }
@@ -725,6 +787,8 @@ SimpleIdentity GeometryManager::addGeometry(std::vector<GeometryRaw *> &geom,con
 /// Add geometry we're planning to reuse (as a model, for example)
 SimpleIdentity GeometryManager::addBaseGeometry(std::vector<GeometryRaw *> &geom,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag("");
     GeomSceneRep *sceneRep = new GeomSceneRep();
     
     // Sort the geometry by type and texture
@@ -754,6 +818,9 @@ SimpleIdentity GeometryManager::addBaseGeometry(std::vector<GeometryRaw *> &geom
         }
     }
 
+    // Instances will share this for ray intersection
+    sceneRep->bvh = makeBVH(geom);
+
     // Instance the geometry once for now
     Matrix4d instMat = Matrix4d::Identity();
     
@@ -786,6 +853,8 @@ SimpleIdentity GeometryManager::addBaseGeometry(std::vector<GeometryRaw *> &geom
     pthread_mutex_lock(&geomLock);
     sceneReps.insert(sceneRep);
     pthread_mutex_unlock(&geomLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
     
     return geomID;
 }
@@ -802,6 +871,8 @@ SimpleIdentity GeometryManager::addBaseGeometry(std::vector<GeometryRaw> &inGeom
 /// Add instances that reuse base geometry
 SimpleIdentity GeometryManager::addGeometryInstances(SimpleIdentity baseGeomID,const std::vector<GeometryInstance *> &instances,GeometryInfo &geomInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(geomInfo.memLabel);
     pthread_mutex_lock(&geomLock);
     TimeInterval startTime = TimeGetCurrent();
 
@@ -883,17 +954,34 @@ SimpleIdentity GeometryManager::addGeometryInstances(SimpleIdentity baseGeomID,c
         sceneRep->drawIDs.insert(drawInst->getId());
         changes.push_back(new AddDrawableReq(drawInst));
     }
+    
+    // Ray intersection reuses the base model's BVH.  Moving instances aren't tracked.
+    // We've held geomLock since looking up the base, which registerMeshIntersect needs.
+    if (baseSceneRep->bvh && !hasMotion)
+    {
+        for (const GeometryInstance *inst : instances)
+            meshIntersect->addInstance(sceneRep->getId(), baseSceneRep->bvh, inst->mat, inst->getId(), geomInfo.minVis, geomInfo.maxVis, geomInfo.enable);
+        registerMeshIntersect();
+    }
 
+    // Keyframe tracks can animate the geometry as a whole
+    if (!sceneRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),sceneRep->drawIDs));
+    
     SimpleIdentity geomID = sceneRep->getId();
     
     sceneReps.insert(sceneRep);
     pthread_mutex_unlock(&geomLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
     
     return geomID;
 }
     
 SimpleIdentity GeometryManager::addGeometryPoints(const GeometryRawPoints &geomPoints,const Eigen::Matrix4d &mat,GeometryInfo &geomInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(geomInfo.memLabel);
     GeomSceneRep *sceneRep = new GeomSceneRep();
         
     // Calculate the bounding box for the whole thing
@@ -931,11 +1019,17 @@ SimpleIdentity GeometryManager::addGeometryPoints(const GeometryRawPoints &geomP
         changes.push_back(new AddDrawableReq(draw));
     }
     
+    // Keyframe tracks can animate the geometry as a whole
+    if (!sceneRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),sceneRep->drawIDs));
+    
     SimpleIdentity geomID = sceneRep->getId();
     
     pthread_mutex_lock(&geomLock);
     sceneReps.insert(sceneRep);
     pthread_mutex_unlock(&geomLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
     
     return geomID;
 }
@@ -954,6 +1048,7 @@ void GeometryManager::enableGeometry(SimpleIDSet &geomIDs,bool enable,ChangeSet
         {
             GeomSceneRep *geomRep = *it;
             geomRep->enableContents(selectManager,enable,changes);
+            meshIntersect->enableGroup(geomRep->getId(),enable);
         }
     }
     
@@ -987,6 +1082,9 @@ void GeometryManager::removeGeometry(SimpleIDSet &geomIDs,ChangeSet &changes)
             }
 
             sceneRep->clearContents(selectManager,changes,removeTime);
+            changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),SimpleIDSet()));
+            meshIntersect->removeGroup(sceneRep->getId());
+            untrackSceneRep(sceneRep->getId());
             sceneReps.erase(it);
             delete sceneRep;
         }
@@ -92,7 +92,7 @@ void GlobeView::setRotQuat(Eigen::Quaterniond newRotQuat,bool updateWatchers)
     x = newRotQuat.coeffs().x();
     y = newRotQuat.coeffs().y();
     z = newRotQuat.coeffs().z();
-    if (isnan(w) || isnan(x) || isnan(y) || isnan(z))
+    if (std::isnan(w) || std::isnan(x) || std::isnan(y) || std::isnan(z))
         return;
     
     lastChangedTime = TimeGetCurrent();
@@ -103,7 +103,7 @@ void GlobeView::setRotQuat(Eigen::Quaterniond newRotQuat,bool updateWatchers)
 
 void GlobeView::setTilt(double newTilt)
 {
-    if (isnan(newTilt))
+    if (std::isnan(newTilt))
         return;
 
     tilt = newTilt;
@@ -152,7 +152,7 @@ void GlobeView::setHeightAboveGlobe(double newH,bool updateWatchers)
 
 void GlobeView::setHeightAboveGlobeNoLimits(double newH,bool updateWatchers)
 {
-    if (isnan(newH))
+    if (std::isnan(newH))
         return;
 
     heightAboveGlobe = newH;
@@ -183,7 +183,7 @@ void GlobeView::setHeightAboveGlobeNoLimits(double newH,bool updateWatchers)
 // Also keep track of when we did it
 void GlobeView::privateSetHeightAboveGlobe(double newH,bool updateWatchers)
 {
-    if (isnan(newH))
+    if (std::isnan(newH))
         return;
 
     double minH = minHeightAboveGlobe();
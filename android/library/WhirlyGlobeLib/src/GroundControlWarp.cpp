@@ -0,0 +1,329 @@
+/*
+ *  GroundControlWarp.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import "GroundControlWarp.h"
+
+using namespace Eigen;
+
+namespace WhirlyKit
+{
+
+GroundControlPoint::GroundControlPoint()
+    : pixel(0,0), loc(0,0)
+{
+}
+
+GroundControlPoint::GroundControlPoint(const Point2d &pixel,const Point2d &loc)
+    : pixel(pixel), loc(loc)
+{
+}
+
+GroundControlWarp::GroundControlWarp()
+    : valid(false), fitType(GCPFitAffine), imageWidth(0), imageHeight(0), pixCenter(0,0), pixScale(1.0),
+    locCenter(0,0), rmsError(0.0), maxError(0.0)
+{
+}
+
+int GroundControlWarp::MinPoints(GroundControlFitType type)
+{
+    switch (type)
+    {
+        case GCPFitAffine:
+        case GCPFitThinPlateSpline:
+            return 3;
+        case GCPFitPolynomial2:
+            return 6;
+        case GCPFitPolynomial3:
+            return 10;
+    }
+
+    return 3;
+}
+
+// Number of terms in a polynomial of the given order in two variables
+static int NumPolyTerms(int order)
+{
+    return (order+1)*(order+2)/2;
+}
+
+static int PolyOrder(GroundControlFitType type)
+{
+    switch (type)
+    {
+        case GCPFitPolynomial2:
+            return 2;
+        case GCPFitPolynomial3:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+Point2d GroundControlWarp::normalizePixel(const Point2d &pixel) const
+{
+    return (pixel - pixCenter) / pixScale;
+}
+
+void GroundControlWarp::polyTerms(const Point2d &pt,int order,double *terms) const
+{
+    int which = 0;
+    for (int deg=0;deg<=order;deg++)
+        for (int yPow=0;yPow<=deg;yPow++)
+            terms[which++] = pow(pt.x(),deg-yPow) * pow(pt.y(),yPow);
+}
+
+double GroundControlWarp::tpsKernel(double r2)
+{
+    // r^2 log r, written in terms of r^2
+    return r2 > 0.0 ? 0.5 * r2 * log(r2) : 0.0;
+}
+
+bool GroundControlWarp::fit(GroundControlFitType type,const std::vector<GroundControlPoint> &gcps,int inWidth,int inHeight,double smoothing)
+{
+    valid = false;
+    error.clear();
+    fitType = type;
+    imageWidth = inWidth;
+    imageHeight = inHeight;
+    coeffX.clear();  coeffY.clear();
+    tpsCenters.clear();  tpsWeightX.clear();  tpsWeightY.clear();
+    residuals.clear();
+    rmsError = maxError = 0.0;
+
+    if (imageWidth <= 0 || imageHeight <= 0)
+    {
+        error = "Image size is not set";
+        return false;
+    }
+    int numPts = (int)gcps.size();
+    if (numPts < MinPoints(type))
+    {
+        error = "Not enough ground control points for this kind of fit";
+        return false;
+    }
+
+    pixCenter = Point2d(imageWidth/2.0,imageHeight/2.0);
+    pixScale = std::max(imageWidth,imageHeight)/2.0;
+    locCenter = Point2d(0,0);
+    for (const auto &gcp : gcps)
+        locCenter += gcp.loc;
+    locCenter /= numPts;
+
+    if (type == GCPFitThinPlateSpline)
+    {
+        // Kernel for the points plus an affine part that has to be orthogonal to it
+        MatrixXd mat = MatrixXd::Zero(numPts+3,numPts+3);
+        VectorXd rhsX = VectorXd::Zero(numPts+3), rhsY = VectorXd::Zero(numPts+3);
+        for (const auto &gcp : gcps)
+            tpsCenters.push_back(normalizePixel(gcp.pixel));
+        for (int ii=0;ii<numPts;ii++)
+        {
+            for (int jj=0;jj<numPts;jj++)
+                mat(ii,jj) = tpsKernel((tpsCenters[ii]-tpsCenters[jj]).squaredNorm());
+            mat(ii,ii) += smoothing;
+            mat(ii,numPts) = mat(numPts,ii) = 1.0;
+            mat(ii,numPts+1) = mat(numPts+1,ii) = tpsCenters[ii].x();
+            mat(ii,numPts+2) = mat(numPts+2,ii) = tpsCenters[ii].y();
+            rhsX(ii) = gcps[ii].loc.x() - locCenter.x();
+            rhsY(ii) = gcps[ii].loc.y() - locCenter.y();
+        }
+        FullPivLU<MatrixXd> lu(mat);
+        if (!lu.isInvertible())
+        {
+            error = "Ground control points are degenerate (duplicated or all in a line)";
+            tpsCenters.clear();
+            return false;
+        }
+        VectorXd solX = lu.solve(rhsX), solY = lu.solve(rhsY);
+        tpsWeightX.assign(solX.data(),solX.data()+numPts);
+        tpsWeightY.assign(solY.data(),solY.data()+numPts);
+        coeffX.assign(solX.data()+numPts,solX.data()+numPts+3);
+        coeffY.assign(solY.data()+numPts,solY.data()+numPts+3);
+    } else {
+        // Least squares on the polynomial terms
+        int order = PolyOrder(type);
+        int numTerms = NumPolyTerms(order);
+        MatrixXd mat(numPts,numTerms);
+        VectorXd rhsX(numPts), rhsY(numPts);
+        std::vector<double> terms(numTerms);
+        for (int ii=0;ii<numPts;ii++)
+        {
+            polyTerms(normalizePixel(gcps[ii].pixel),order,&terms[0]);
+            for (int jj=0;jj<numTerms;jj++)
+                mat(ii,jj) = terms[jj];
+            rhsX(ii) = gcps[ii].loc.x() - locCenter.x();
+            rhsY(ii) = gcps[ii].loc.y() - locCenter.y();
+        }
+        ColPivHouseholderQR<MatrixXd> qr(mat);
+        if (qr.rank() < numTerms)
+        {
+            error = "Ground control points are degenerate (duplicated or all in a line)";
+            return false;
+        }
+        VectorXd solX = qr.solve(rhsX), solY = qr.solve(rhsY);
+        coeffX.assign(solX.data(),solX.data()+numTerms);
+        coeffY.assign(solY.data(),solY.data()+numTerms);
+    }
+
+    valid = true;
+    calcResiduals(gcps);
+
+    return true;
+}
+
+void GroundControlWarp::calcResiduals(const std::vector<GroundControlPoint> &gcps)
+{
+    double sumSq = 0.0;
+    for (const auto &gcp : gcps)
+    {
+        double dist = (pixelToLocal(gcp.pixel) - gcp.loc).norm();
+        residuals.push_back(dist);
+        sumSq += dist*dist;
+        maxError = std::max(maxError,dist);
+    }
+    rmsError = gcps.empty() ? 0.0 : sqrt(sumSq / gcps.size());
+}
+
+Point2d GroundControlWarp::pixelToLocal(const Point2d &pixel) const
+{
+    if (!valid)
+        return Point2d(0,0);
+
+    Point2d pt = normalizePixel(pixel);
+    Point2d ret(0,0);
+    if (fitType == GCPFitThinPlateSpline)
+    {
+        ret.x() = coeffX[0] + coeffX[1]*pt.x() + coeffX[2]*pt.y();
+        ret.y() = coeffY[0] + coeffY[1]*pt.x() + coeffY[2]*pt.y();
+        for (unsigned int ii=0;ii<tpsCenters.size();ii++)
+        {
+            double kern = tpsKernel((pt-tpsCenters[ii]).squaredNorm());
+            ret.x() += tpsWeightX[ii] * kern;
+            ret.y() += tpsWeightY[ii] * kern;
+        }
+    } else {
+        double terms[10];
+        polyTerms(pt,PolyOrder(fitType),terms);
+        for (unsigned int ii=0;ii<coeffX.size();ii++)
+        {
+            ret.x() += coeffX[ii] * terms[ii];
+            ret.y() += coeffY[ii] * terms[ii];
+        }
+    }
+
+    return ret + locCenter;
+}
+
+void GroundControlWarp::getBounds(Point2d &ll,Point2d &ur) const
+{
+    static const int EdgeSamples = 32;
+
+    ll = Point2d(MAXFLOAT,MAXFLOAT);
+    ur = Point2d(-MAXFLOAT,-MAXFLOAT);
+    Point2d corners[5] = {Point2d(0,0),Point2d(imageWidth,0),Point2d(imageWidth,imageHeight),Point2d(0,imageHeight),Point2d(0,0)};
+    for (unsigned int side=0;side<4;side++)
+        for (int ii=0;ii<EdgeSamples;ii++)
+        {
+            double t = ii / (double)EdgeSamples;
+            Point2d loc = pixelToLocal(corners[side] + t * (corners[side+1]-corners[side]));
+            ll = ll.cwiseMin(loc);
+            ur = ur.cwiseMax(loc);
+        }
+}
+
+// Break up a range into evenly spaced samples
+static void UniformSamples(double maxVal,int num,std::vector<double> &vals)
+{
+    num = std::max(num,1);
+    vals.resize(num+1);
+    for (int ii=0;ii<=num;ii++)
+        vals[ii] = maxVal * ii / num;
+}
+
+// Split the intervals along one axis where the mesh is farthest from the surface.
+// Returns true if anything was split.
+static bool RefineSamples(std::vector<double> &vals,const std::vector<double> &across,bool alongX,
+                          const std::function<Point3d(const Point2d &)> &toDisplay,double eps,int maxSamples)
+{
+    int numIntervals = (int)vals.size()-1;
+    if (numIntervals >= maxSamples)
+        return false;
+
+    // Worst chord error for each interval, checked along every row (or column)
+    std::vector<std::pair<double,int> > errs;
+    for (int ii=0;ii<numIntervals;ii++)
+    {
+        double a = vals[ii], b = vals[ii+1], mid = (a+b)/2.0;
+        double worst = 0.0;
+        for (double other : across)
+        {
+            Point3d pa = toDisplay(alongX ? Point2d(a,other) : Point2d(other,a));
+            Point3d pb = toDisplay(alongX ? Point2d(b,other) : Point2d(other,b));
+            Point3d pm = toDisplay(alongX ? Point2d(mid,other) : Point2d(other,mid));
+            worst = std::max(worst,(pm - (pa+pb)/2.0).norm());
+        }
+        if (worst > eps)
+            errs.push_back(std::pair<double,int>(worst,ii));
+    }
+    if (errs.empty())
+        return false;
+
+    // Worst first, until we run out of room
+    std::sort(errs.begin(),errs.end(),[](const std::pair<double,int> &a,const std::pair<double,int> &b) { return a.first > b.first; });
+    int numSplit = std::min((int)errs.size(),maxSamples - numIntervals);
+    std::vector<bool> split(numIntervals,false);
+    for (int ii=0;ii<numSplit;ii++)
+        split[errs[ii].second] = true;
+
+    std::vector<double> newVals;
+    newVals.reserve(vals.size()+numSplit);
+    for (int ii=0;ii<numIntervals;ii++)
+    {
+        newVals.push_back(vals[ii]);
+        if (split[ii])
+            newVals.push_back((vals[ii]+vals[ii+1])/2.0);
+    }
+    newVals.push_back(vals.back());
+    vals.swap(newVals);
+
+    return true;
+}
+
+void GroundControlWarp::buildSampleGrid(const std::function<Point3d(const Point2d &)> &toDisplay,double eps,
+                                        int minSampleX,int minSampleY,int maxSampleX,int maxSampleY,
+                                        std::vector<double> &xs,std::vector<double> &ys) const
+{
+    maxSampleX = std::max(maxSampleX,minSampleX);
+    maxSampleY = std::max(maxSampleY,minSampleY);
+    UniformSamples(imageWidth,minSampleX,xs);
+    UniformSamples(imageHeight,minSampleY,ys);
+    if (eps <= 0.0)
+        return;
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = RefineSamples(xs,ys,true,toDisplay,eps,maxSampleX);
+        changed |= RefineSamples(ys,xs,false,toDisplay,eps,maxSampleY);
+    }
+}
+
+}
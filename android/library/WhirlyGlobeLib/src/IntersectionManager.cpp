@@ -24,21 +24,47 @@ IntersectionManager::~IntersectionManager()
     pthread_mutex_destroy(&mutex);
 }
     
+IntersectionManager::Intersectable::~Intersectable()
+{
+}
+
+bool IntersectionManager::Intersectable::findClosestHit(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,IntersectionHit &hit)
+{
+    hit.norm = Point3d(0,0,0);
+    hit.featureID = EmptyIdentity;
+    return findClosestIntersection(renderer, theView, frameSize, touchPt, org, dir, hit.pt, hit.dist);
+}
+    
 void IntersectionManager::addIntersectable(Intersectable *intersect)
 {
+    pthread_mutex_lock(&mutex);
     intersectables.insert(intersect);
+    pthread_mutex_unlock(&mutex);
 }
 
 /// Remove an intersectable object
 void IntersectionManager::removeIntersectable(Intersectable *intersect)
 {
+    pthread_mutex_lock(&mutex);
     intersectables.erase(intersect);
+    pthread_mutex_unlock(&mutex);
 }
 
 /// Look for the nearest intersection and return the point (in display coordinates)
 bool IntersectionManager::findIntersection(SceneRendererES *renderer,View *view,const Point2f &frameSize,const Point2f &touchPt,Point3d &iPt,double &dist)
 {
-    Point3d minPt;
+    IntersectionHit hit;
+    if (!findIntersection(renderer, view, frameSize, touchPt, hit))
+        return false;
+    
+    iPt = hit.pt;
+    dist = hit.dist;
+    return true;
+}
+
+bool IntersectionManager::findIntersection(SceneRendererES *renderer,View *view,const Point2f &frameSize,const Point2f &touchPt,IntersectionHit &hit)
+{
+    IntersectionHit minHit;
     double minDist = std::numeric_limits<double>::max();
 
     Eigen::Matrix4d fullMat = view->calcFullMatrix();
@@ -62,14 +88,13 @@ bool IntersectionManager::findIntersection(SceneRendererES *renderer,View *view,
     
     for (auto inter : intersectables)
     {
-        Point3d thisPt;
-        double thisDist;
-        if (inter->findClosestIntersection(renderer, view, frameSize, touchPt, org, dir, thisPt, thisDist))
+        IntersectionHit thisHit;
+        if (inter->findClosestHit(renderer, view, frameSize, touchPt, org, dir, thisHit))
         {
-            if (thisDist < minDist)
+            if (thisHit.dist < minDist)
             {
-                minDist = thisDist;
-                minPt = thisPt;
+                minDist = thisHit.dist;
+                minHit = thisHit;
             }
         }
     }
@@ -78,7 +103,7 @@ bool IntersectionManager::findIntersection(SceneRendererES *renderer,View *view,
     
     if (minDist != std::numeric_limits<double>::max())
     {
-        iPt = minPt;
+        hit = minHit;
         return true;
     }
     
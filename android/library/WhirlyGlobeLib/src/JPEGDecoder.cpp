@@ -0,0 +1,634 @@
+/*
+ *  JPEGDecoder.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import <string.h>
+#import <limits.h>
+#import <algorithm>
+#import "JPEGDecoder.h"
+
+namespace WhirlyKit
+{
+
+// Order coefficients show up in relative to their natural position
+static const int ZigZag[64] = {
+    0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// Cosine basis for the inverse DCT, including the scale factors
+static float IDCTTable[8][8];
+static bool IDCTTableValid = false;
+
+static void SetupIDCTTable()
+{
+    if (IDCTTableValid)
+        return;
+    for (unsigned int x=0;x<8;x++)
+        for (unsigned int u=0;u<8;u++)
+        {
+            double scale = (u == 0) ? sqrt(0.5) : 1.0;
+            IDCTTable[x][u] = (float)(scale * cos((2*x+1)*u*M_PI/16.0) / 2.0);
+        }
+    IDCTTableValid = true;
+}
+
+static inline unsigned char ClampSample(float val)
+{
+    int iVal = (int)lrintf(val);
+    return (unsigned char)std::min(std::max(iVal,0),255);
+}
+
+static inline int ReadShort(const unsigned char *data)
+{
+    return (data[0] << 8) | data[1];
+}
+
+JPEGDecoder::HuffmanTable::HuffmanTable()
+    : valid(false)
+{
+    memset(maxCode,0,sizeof(maxCode));
+    memset(valPtr,0,sizeof(valPtr));
+    memset(minCode,0,sizeof(minCode));
+    memset(values,0,sizeof(values));
+}
+
+JPEGDecoder::JPEGDecoder()
+    : width(0), height(0), maxHSamp(1), maxVSamp(1), mcusX(0), mcusY(0), restartInterval(0),
+    colorTransform(-1), adobeTransform(-1), frameValid(false),
+    bitData(NULL), bitLen(0), bitPos(0), bitBuf(0), bitCount(0), hitMarker(false)
+{
+    memset(quantTables,0,sizeof(quantTables));
+    SetupIDCTTable();
+}
+
+bool JPEGDecoder::readTables(const unsigned char *data,size_t len)
+{
+    error.clear();
+    return readMarkers(data,len,true);
+}
+
+bool JPEGDecoder::decode(const unsigned char *data,size_t len,std::vector<unsigned char> &pixels,int &outWidth,int &outHeight,int &numComponents)
+{
+    error.clear();
+    frameValid = false;
+    components.clear();
+    adobeTransform = -1;
+
+    if (!readMarkers(data,len,false))
+        return false;
+    if (!frameValid)
+    {
+        error = "No image in JPEG stream";
+        return false;
+    }
+
+    outputPixels(pixels);
+    outWidth = width;
+    outHeight = height;
+    numComponents = (int)components.size();
+
+    return true;
+}
+
+bool JPEGDecoder::readMarkers(const unsigned char *data,size_t len,bool tablesOnly)
+{
+    size_t pos = 0;
+    while (pos+1 < len)
+    {
+        // Skip over fill bytes until we find a marker
+        if (data[pos] != 0xFF)
+        {
+            pos++;
+            continue;
+        }
+        int marker = data[pos+1];
+        pos += 2;
+        if (marker == 0xFF || marker == 0x00)
+        {
+            pos--;
+            continue;
+        }
+
+        // Markers without a payload
+        if (marker == 0xD8 || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01)
+            continue;
+        if (marker == 0xD9)
+            break;
+
+        if (pos+2 > len)
+            break;
+        int segLen = ReadShort(&data[pos]);
+        if (segLen < 2 || pos+segLen > len)
+        {
+            error = "Truncated JPEG segment";
+            return false;
+        }
+        const unsigned char *seg = &data[pos+2];
+        size_t segDataLen = segLen-2;
+
+        switch (marker)
+        {
+            case 0xDB:
+                if (!readDQT(seg,segDataLen))
+                    return false;
+                break;
+            case 0xC4:
+                if (!readDHT(seg,segDataLen))
+                    return false;
+                break;
+            case 0xDD:
+                if (segDataLen < 2)
+                    return false;
+                restartInterval = ReadShort(seg);
+                break;
+            case 0xC0:
+            case 0xC1:
+                if (tablesOnly)
+                    break;
+                if (!readSOF(seg,segDataLen))
+                    return false;
+                break;
+            case 0xC2:
+            case 0xC3:
+            case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB:
+            case 0xCD: case 0xCE: case 0xCF:
+                error = "Only baseline JPEG is supported";
+                return false;
+            case 0xEE:
+                // Adobe marker tells us whether the color was transformed
+                if (segDataLen >= 12 && !strncmp((const char *)seg,"Adobe",5))
+                    adobeTransform = seg[11];
+                break;
+            case 0xDA:
+            {
+                if (tablesOnly)
+                    break;
+                size_t scanPos = pos;
+                if (!readScan(data,len,scanPos))
+                    return false;
+                pos = scanPos;
+                continue;
+            }
+            default:
+                break;
+        }
+
+        pos += segLen;
+    }
+
+    return true;
+}
+
+bool JPEGDecoder::readDQT(const unsigned char *data,size_t len)
+{
+    size_t pos = 0;
+    while (pos < len)
+    {
+        int precision = data[pos] >> 4;
+        int which = data[pos] & 0xF;
+        pos++;
+        if (which > 3)
+        {
+            error = "Bad quantization table";
+            return false;
+        }
+        for (unsigned int ii=0;ii<64;ii++)
+        {
+            if (precision)
+            {
+                if (pos+2 > len)
+                    return false;
+                quantTables[which][ii] = ReadShort(&data[pos]);
+                pos += 2;
+            } else {
+                if (pos+1 > len)
+                    return false;
+                quantTables[which][ii] = data[pos++];
+            }
+        }
+    }
+
+    return true;
+}
+
+bool JPEGDecoder::readDHT(const unsigned char *data,size_t len)
+{
+    size_t pos = 0;
+    while (pos+17 <= len)
+    {
+        int tableClass = data[pos] >> 4;
+        int which = data[pos] & 0xF;
+        if (which > 3 || tableClass > 1)
+        {
+            error = "Bad Huffman table";
+            return false;
+        }
+        HuffmanTable &table = tableClass ? acTables[which] : dcTables[which];
+
+        int counts[17];
+        int total = 0;
+        for (unsigned int ii=1;ii<=16;ii++)
+        {
+            counts[ii] = data[pos+ii];
+            total += counts[ii];
+        }
+        pos += 17;
+        if (total > 256 || pos+total > len)
+        {
+            error = "Bad Huffman table";
+            return false;
+        }
+        memcpy(table.values,&data[pos],total);
+        pos += total;
+
+        // Canonical codes, as laid out in the spec
+        int code = 0,which2 = 0;
+        for (unsigned int ii=1;ii<=16;ii++)
+        {
+            table.valPtr[ii] = which2;
+            table.minCode[ii] = code;
+            code += counts[ii];
+            which2 += counts[ii];
+            table.maxCode[ii] = counts[ii] ? code-1 : -1;
+            code <<= 1;
+        }
+        table.maxCode[17] = INT_MAX;
+        table.valid = true;
+    }
+
+    return true;
+}
+
+bool JPEGDecoder::readSOF(const unsigned char *data,size_t len)
+{
+    if (len < 6)
+        return false;
+    if (data[0] != 8)
+    {
+        error = "Only 8 bit JPEG is supported";
+        return false;
+    }
+    height = ReadShort(&data[1]);
+    width = ReadShort(&data[3]);
+    int numComps = data[5];
+    if (width <= 0 || height <= 0 || numComps < 1 || numComps > 4 || len < 6+3*numComps)
+    {
+        error = "Bad JPEG frame header";
+        return false;
+    }
+
+    components.resize(numComps);
+    maxHSamp = 1;  maxVSamp = 1;
+    for (int ii=0;ii<numComps;ii++)
+    {
+        Component &comp = components[ii];
+        comp.id = data[6+3*ii];
+        comp.hSamp = data[7+3*ii] >> 4;
+        comp.vSamp = data[7+3*ii] & 0xF;
+        comp.quantTable = data[8+3*ii] & 0x3;
+        comp.dcTable = comp.acTable = 0;
+        comp.dcPred = 0;
+        if (comp.hSamp < 1 || comp.hSamp > 4 || comp.vSamp < 1 || comp.vSamp > 4)
+        {
+            error = "Bad JPEG sampling factors";
+            return false;
+        }
+        maxHSamp = std::max(maxHSamp,comp.hSamp);
+        maxVSamp = std::max(maxVSamp,comp.vSamp);
+    }
+
+    mcusX = (width + 8*maxHSamp - 1) / (8*maxHSamp);
+    mcusY = (height + 8*maxVSamp - 1) / (8*maxVSamp);
+    for (Component &comp : components)
+    {
+        comp.stride = mcusX * comp.hSamp * 8;
+        comp.samples.assign(comp.stride * mcusY * comp.vSamp * 8,0);
+    }
+    frameValid = true;
+
+    return true;
+}
+
+void JPEGDecoder::resetBits()
+{
+    bitBuf = 0;
+    bitCount = 0;
+    hitMarker = false;
+}
+
+int JPEGDecoder::readBit()
+{
+    if (bitCount == 0)
+    {
+        int byte = 0;
+        if (!hitMarker && bitPos < bitLen)
+        {
+            byte = bitData[bitPos];
+            if (byte == 0xFF)
+            {
+                int next = (bitPos+1 < bitLen) ? bitData[bitPos+1] : 0xD9;
+                if (next == 0x00)
+                    bitPos += 2;
+                else {
+                    // Ran into a marker.  Feed zeros until someone deals with it.
+                    hitMarker = true;
+                    byte = 0;
+                }
+            } else
+                bitPos++;
+        }
+        bitBuf = byte;
+        bitCount = 8;
+    }
+    bitCount--;
+
+    return (bitBuf >> bitCount) & 1;
+}
+
+int JPEGDecoder::readBits(int num)
+{
+    int val = 0;
+    for (int ii=0;ii<num;ii++)
+        val = (val << 1) | readBit();
+    return val;
+}
+
+int JPEGDecoder::decodeHuffman(const HuffmanTable &table)
+{
+    int code = readBit();
+    int len = 1;
+    while (code > table.maxCode[len])
+    {
+        code = (code << 1) | readBit();
+        len++;
+        if (len > 16)
+            return -1;
+    }
+
+    return table.values[table.valPtr[len] + code - table.minCode[len]];
+}
+
+// Sign extend a value that was coded in the given number of bits
+static inline int ExtendValue(int val,int bits)
+{
+    return (val < (1 << (bits-1))) ? val - (1 << bits) + 1 : val;
+}
+
+bool JPEGDecoder::decodeBlock(Component &comp,int blockX,int blockY)
+{
+    const HuffmanTable &dcTable = dcTables[comp.dcTable];
+    const HuffmanTable &acTable = acTables[comp.acTable];
+    if (!dcTable.valid || !acTable.valid)
+    {
+        error = "Missing Huffman table";
+        return false;
+    }
+    const unsigned short *quant = quantTables[comp.quantTable];
+
+    float coeffs[64];
+    memset(coeffs,0,sizeof(coeffs));
+
+    // DC is coded as a difference from the last block
+    int size = decodeHuffman(dcTable);
+    if (size < 0)
+    {
+        error = "Bad Huffman code";
+        return false;
+    }
+    int diff = size ? ExtendValue(readBits(size),size) : 0;
+    comp.dcPred += diff;
+    coeffs[0] = (float)(comp.dcPred * quant[0]);
+
+    for (int k=1;k<64;)
+    {
+        int rs = decodeHuffman(acTable);
+        if (rs < 0)
+        {
+            error = "Bad Huffman code";
+            return false;
+        }
+        int run = rs >> 4;
+        int acSize = rs & 0xF;
+        if (acSize == 0)
+        {
+            // End of block, or a run of 16 zeros
+            if (run != 15)
+                break;
+            k += 16;
+            continue;
+        }
+        k += run;
+        if (k > 63)
+            break;
+        coeffs[ZigZag[k]] = (float)(ExtendValue(readBits(acSize),acSize) * quant[k]);
+        k++;
+    }
+
+    // Separable inverse DCT, rows then columns
+    float temp[64];
+    for (unsigned int v=0;v<8;v++)
+        for (unsigned int x=0;x<8;x++)
+        {
+            float sum = 0.0;
+            for (unsigned int u=0;u<8;u++)
+                sum += IDCTTable[x][u] * coeffs[v*8+u];
+            temp[v*8+x] = sum;
+        }
+
+    unsigned char *out = &comp.samples[blockY*8*comp.stride + blockX*8];
+    for (unsigned int y=0;y<8;y++)
+        for (unsigned int x=0;x<8;x++)
+        {
+            float sum = 0.0;
+            for (unsigned int v=0;v<8;v++)
+                sum += IDCTTable[y][v] * temp[v*8+x];
+            out[y*comp.stride+x] = ClampSample(sum + 128.0f);
+        }
+
+    return true;
+}
+
+bool JPEGDecoder::readScan(const unsigned char *data,size_t len,size_t &pos)
+{
+    if (!frameValid)
+    {
+        error = "JPEG scan before frame header";
+        return false;
+    }
+    int segLen = ReadShort(&data[pos]);
+    const unsigned char *seg = &data[pos+2];
+    int numScanComps = seg[0];
+    if (numScanComps < 1 || numScanComps > 4 || segLen < 6+2*numScanComps)
+    {
+        error = "Bad JPEG scan header";
+        return false;
+    }
+
+    std::vector<Component *> scanComps;
+    for (int ii=0;ii<numScanComps;ii++)
+    {
+        int compID = seg[1+2*ii];
+        Component *comp = NULL;
+        for (Component &testComp : components)
+            if (testComp.id == compID)
+                comp = &testComp;
+        if (!comp)
+        {
+            error = "Scan refers to unknown component";
+            return false;
+        }
+        comp->dcTable = (seg[2+2*ii] >> 4) & 0x3;
+        comp->acTable = seg[2+2*ii] & 0x3;
+        comp->dcPred = 0;
+        scanComps.push_back(comp);
+    }
+
+    bitData = data;
+    bitLen = len;
+    bitPos = pos + segLen;
+    resetBits();
+
+    // A single component scan goes block by block, otherwise it's by MCU
+    int unitsX,unitsY;
+    if (numScanComps == 1)
+    {
+        Component *comp = scanComps[0];
+        unitsX = ((width * comp->hSamp + maxHSamp - 1) / maxHSamp + 7) / 8;
+        unitsY = ((height * comp->vSamp + maxVSamp - 1) / maxVSamp + 7) / 8;
+    } else {
+        unitsX = mcusX;
+        unitsY = mcusY;
+    }
+
+    int unitsLeft = restartInterval;
+    for (int uy=0;uy<unitsY;uy++)
+        for (int ux=0;ux<unitsX;ux++)
+        {
+            if (restartInterval && unitsLeft == 0)
+            {
+                // Skip to just past the restart marker and start fresh
+                resetBits();
+                while (bitPos+1 < bitLen && !(bitData[bitPos] == 0xFF && bitData[bitPos+1] >= 0xD0 && bitData[bitPos+1] <= 0xD7))
+                    bitPos++;
+                bitPos += 2;
+                for (Component *comp : scanComps)
+                    comp->dcPred = 0;
+                unitsLeft = restartInterval;
+            }
+
+            if (numScanComps == 1)
+            {
+                if (!decodeBlock(*scanComps[0],ux,uy))
+                    return false;
+            } else {
+                for (Component *comp : scanComps)
+                    for (int by=0;by<comp->vSamp;by++)
+                        for (int bx=0;bx<comp->hSamp;bx++)
+                            if (!decodeBlock(*comp,ux*comp->hSamp+bx,uy*comp->vSamp+by))
+                                return false;
+            }
+            unitsLeft--;
+        }
+
+    // Pick up after the entropy coded data
+    pos = bitPos;
+    while (pos+1 < len && !(data[pos] == 0xFF && data[pos+1] != 0x00 && !(data[pos+1] >= 0xD0 && data[pos+1] <= 0xD7)))
+        pos++;
+
+    return true;
+}
+
+void JPEGDecoder::outputPixels(std::vector<unsigned char> &pixels)
+{
+    int numComps = (int)components.size();
+    pixels.resize(width*height*numComps);
+
+    for (int ic=0;ic<numComps;ic++)
+    {
+        const Component &comp = components[ic];
+        if (comp.hSamp == maxHSamp && comp.vSamp == maxVSamp)
+        {
+            for (int y=0;y<height;y++)
+            {
+                const unsigned char *row = &comp.samples[y*comp.stride];
+                unsigned char *out = &pixels[y*width*numComps+ic];
+                for (int x=0;x<width;x++)
+                    out[x*numComps] = row[x];
+            }
+            continue;
+        }
+
+        // Subsampled components are interpolated between sample centers
+        int compWidth = (width * comp.hSamp + maxHSamp - 1) / maxHSamp;
+        int compHeight = (height * comp.vSamp + maxVSamp - 1) / maxVSamp;
+        float scaleX = (float)comp.hSamp / maxHSamp,scaleY = (float)comp.vSamp / maxVSamp;
+        for (int y=0;y<height;y++)
+        {
+            float sy = std::max((y+0.5f)*scaleY - 0.5f,0.0f);
+            int y0 = std::min((int)sy,compHeight-1),y1 = std::min(y0+1,compHeight-1);
+            float ty = sy - y0;
+            const unsigned char *row0 = &comp.samples[y0*comp.stride];
+            const unsigned char *row1 = &comp.samples[y1*comp.stride];
+            unsigned char *out = &pixels[y*width*numComps+ic];
+            for (int x=0;x<width;x++)
+            {
+                float sx = std::max((x+0.5f)*scaleX - 0.5f,0.0f);
+                int x0 = std::min((int)sx,compWidth-1),x1 = std::min(x0+1,compWidth-1);
+                float tx = sx - x0;
+                float top = row0[x0] * (1.0f-tx) + row0[x1] * tx;
+                float bot = row1[x0] * (1.0f-tx) + row1[x1] * tx;
+                out[x*numComps] = ClampSample(top * (1.0f-ty) + bot * ty);
+            }
+        }
+    }
+
+    // Sort out whether this is YCbCr or really RGB
+    if (numComps != 3)
+        return;
+    bool doTransform;
+    if (colorTransform >= 0)
+        doTransform = colorTransform;
+    else if (adobeTransform >= 0)
+        doTransform = adobeTransform != 0;
+    else
+        doTransform = !(components[0].id == 'R' && components[1].id == 'G' && components[2].id == 'B');
+    if (!doTransform)
+        return;
+
+    for (unsigned int ii=0;ii<(unsigned int)(width*height);ii++)
+    {
+        unsigned char *pix = &pixels[ii*3];
+        float lum = pix[0];
+        float cb = pix[1] - 128.0f,cr = pix[2] - 128.0f;
+        pix[0] = ClampSample(lum + 1.402f*cr);
+        pix[1] = ClampSample(lum - 0.344136f*cb - 0.714136f*cr);
+        pix[2] = ClampSample(lum + 1.772f*cb);
+    }
+}
+
+}
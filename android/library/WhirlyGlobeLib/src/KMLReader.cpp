@@ -0,0 +1,634 @@
+/*
+ *  KMLReader.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdlib.h>
+#import <string.h>
+#import <strings.h>
+#import <zlib.h>
+#import "KMLReader.h"
+#import "SharedAttributes.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+// Pieces we read and inflate from a KMZ
+static const size_t KMZReadChunk = 64*1024;
+
+static std::string Trim(const std::string &str)
+{
+    size_t start = str.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+        return std::string();
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(start,end-start+1);
+}
+
+KMLStyle::KMLStyle()
+    : hasLine(false), hasPoly(false), hasIcon(false), hasLabel(false),
+    lineColor(255,255,255,255), lineWidth(1.0), polyColor(255,255,255,255), polyFill(true), polyOutline(true),
+    iconColor(255,255,255,255), iconScale(1.0), labelColor(255,255,255,255), labelScale(1.0)
+{
+}
+
+void KMLStyle::merge(const KMLStyle &that)
+{
+    if (that.hasLine)
+    {
+        hasLine = true;
+        lineColor = that.lineColor;
+        lineWidth = that.lineWidth;
+    }
+    if (that.hasPoly)
+    {
+        hasPoly = true;
+        polyColor = that.polyColor;
+        polyFill = that.polyFill;
+        polyOutline = that.polyOutline;
+    }
+    if (that.hasIcon)
+    {
+        hasIcon = true;
+        iconColor = that.iconColor;
+        iconScale = that.iconScale;
+        iconHref = that.iconHref;
+    }
+    if (that.hasLabel)
+    {
+        hasLabel = true;
+        labelColor = that.labelColor;
+        labelScale = that.labelScale;
+    }
+}
+
+void KMLStyle::addAttributes(VectorShape *shape,Dictionary &attrs) const
+{
+    if (hasLine)
+    {
+        attrs.setInt("lineColor",lineColor.asInt());
+        attrs.setDouble("lineWidth",lineWidth);
+    }
+    if (hasPoly)
+    {
+        attrs.setInt("fillColor",polyColor.asInt());
+        attrs.setInt("fill",polyFill);
+        attrs.setInt("outline",polyOutline);
+    }
+    if (hasIcon)
+    {
+        attrs.setInt("iconColor",iconColor.asInt());
+        attrs.setDouble("iconScale",iconScale);
+        if (!iconHref.empty())
+            attrs.setString("iconHref",iconHref);
+    }
+    if (hasLabel)
+    {
+        attrs.setInt("labelColor",labelColor.asInt());
+        attrs.setDouble("labelScale",labelScale);
+    }
+
+    // The color the vector manager will pick up
+    if (dynamic_cast<VectorAreal *>(shape))
+    {
+        if (hasPoly && polyFill)
+            attrs.setInt(MaplyColor,polyColor.asInt());
+        else if (hasLine)
+            attrs.setInt(MaplyColor,lineColor.asInt());
+    } else if (dynamic_cast<VectorPoints *>(shape))
+    {
+        if (hasIcon)
+            attrs.setInt(MaplyColor,iconColor.asInt());
+    } else if (hasLine)
+        attrs.setInt(MaplyColor,lineColor.asInt());
+}
+
+bool KMLStyle::ParseColor(const std::string &inStr,RGBAColor &color)
+{
+    std::string str = Trim(inStr);
+    if (!str.empty() && str[0] == '#')
+        str = str.substr(1);
+    if (str.size() != 8)
+        return false;
+    char *end = NULL;
+    unsigned long val = strtoul(str.c_str(),&end,16);
+    if (*end != 0)
+        return false;
+
+    color = RGBAColor(val & 0xFF,(val >> 8) & 0xFF,(val >> 16) & 0xFF,(val >> 24) & 0xFF);
+    return true;
+}
+
+KMLReader::KMLReader()
+    : inStyle(false), inPlacemark(false), hasInlineStyle(false)
+{
+}
+
+KMLReader::~KMLReader()
+{
+}
+
+bool KMLReader::readFile(const std::string &fileName)
+{
+    FILE *fp = fopen(fileName.c_str(),"rb");
+    if (!fp)
+    {
+        error = "Couldn't open " + fileName;
+        return false;
+    }
+
+    // Zip files start with PK
+    unsigned char magic[2] = {0,0};
+    bool isZip = fread(magic,1,2,fp) == 2 && magic[0] == 'P' && magic[1] == 'K';
+    fseek(fp,0,SEEK_SET);
+    bool ret = isZip ? readKMZ(fp) : readKML(fp);
+    fclose(fp);
+
+    return ret;
+}
+
+bool KMLReader::readKML(FILE *fp)
+{
+    XMLStreamReader reader(this);
+    if (!reader.parseFile(fp))
+    {
+        error = reader.getError();
+        return false;
+    }
+
+    return true;
+}
+
+bool KMLReader::parse(const std::string &xml)
+{
+    XMLStreamReader reader(this);
+    if (!reader.parse(xml))
+    {
+        error = reader.getError();
+        return false;
+    }
+
+    return true;
+}
+
+static uint16_t ZipUInt16(const unsigned char *b)
+{
+    return (uint16_t)b[0] | ((uint16_t)b[1] << 8);
+}
+
+static uint32_t ZipUInt32(const unsigned char *b)
+{
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+bool KMLReader::readKMZ(FILE *fp)
+{
+    // The end of central directory record is in the last 64k or so
+    if (fseek(fp,0,SEEK_END) != 0)
+        return false;
+    long fileSize = ftell(fp);
+    long tailSize = std::min(fileSize,(long)(65535+22));
+    std::vector<unsigned char> tail(tailSize);
+    fseek(fp,fileSize-tailSize,SEEK_SET);
+    if (tailSize < 22 || fread(&tail[0],1,tailSize,fp) != (size_t)tailSize)
+    {
+        error = "KMZ file is too short";
+        return false;
+    }
+    long eocd = -1;
+    for (long ii=tailSize-22;ii>=0;ii--)
+        if (ZipUInt32(&tail[ii]) == 0x06054b50)
+        {
+            eocd = ii;
+            break;
+        }
+    if (eocd < 0)
+    {
+        error = "KMZ file has no zip directory";
+        return false;
+    }
+    int numEntries = ZipUInt16(&tail[eocd+10]);
+    uint32_t dirSize = ZipUInt32(&tail[eocd+12]);
+    uint32_t dirOffset = ZipUInt32(&tail[eocd+16]);
+    if (dirOffset == 0xFFFFFFFF || (long)dirOffset + (long)dirSize > fileSize)
+    {
+        error = "Zip64 KMZ files aren't supported";
+        return false;
+    }
+
+    std::vector<unsigned char> dir(dirSize);
+    fseek(fp,dirOffset,SEEK_SET);
+    if (dirSize == 0 || fread(&dir[0],1,dirSize,fp) != dirSize)
+    {
+        error = "Couldn't read the KMZ directory";
+        return false;
+    }
+
+    // Look for doc.kml, otherwise the first .kml at the top, otherwise any .kml
+    int bestRank = 0;
+    uint32_t bestOffset = 0,bestCompSize = 0;
+    int bestMethod = 0;
+    size_t pos = 0;
+    for (int ii=0;ii<numEntries && pos + 46 <= dir.size();ii++)
+    {
+        const unsigned char *entry = &dir[pos];
+        if (ZipUInt32(entry) != 0x02014b50)
+            break;
+        int method = ZipUInt16(entry+10);
+        uint32_t compSize = ZipUInt32(entry+20);
+        int nameLen = ZipUInt16(entry+28), extraLen = ZipUInt16(entry+30), commentLen = ZipUInt16(entry+32);
+        uint32_t localOffset = ZipUInt32(entry+42);
+        if (pos + 46 + nameLen > dir.size())
+            break;
+        std::string name((const char *)entry+46,nameLen);
+        pos += 46 + nameLen + extraLen + commentLen;
+
+        if (name.size() < 4 || strcasecmp(name.c_str()+name.size()-4,".kml"))
+            continue;
+        int rank = !strcasecmp(name.c_str(),"doc.kml") ? 3 : (name.find('/') == std::string::npos ? 2 : 1);
+        if (rank > bestRank)
+        {
+            bestRank = rank;
+            bestOffset = localOffset;
+            bestCompSize = compSize;
+            bestMethod = method;
+        }
+    }
+    if (bestRank == 0)
+    {
+        error = "No KML file in the KMZ";
+        return false;
+    }
+    if (bestMethod != 0 && bestMethod != 8)
+    {
+        error = "Unsupported compression in the KMZ";
+        return false;
+    }
+
+    // Skip the local header, which has its own name and extra lengths
+    unsigned char local[30];
+    fseek(fp,bestOffset,SEEK_SET);
+    if (fread(local,1,30,fp) != 30 || ZipUInt32(local) != 0x04034b50)
+    {
+        error = "Bad local header in the KMZ";
+        return false;
+    }
+    fseek(fp,bestOffset + 30 + ZipUInt16(local+26) + ZipUInt16(local+28),SEEK_SET);
+
+    // Inflate a piece at a time straight into the XML reader
+    XMLStreamReader reader(this);
+    std::vector<unsigned char> inBuf(KMZReadChunk),outBuf(KMZReadChunk);
+    z_stream stream;
+    memset(&stream,0,sizeof(stream));
+    if (bestMethod == 8 && inflateInit2(&stream,-MAX_WBITS) != Z_OK)
+    {
+        error = "Couldn't start decompressing the KMZ";
+        return false;
+    }
+    uint32_t remaining = bestCompSize;
+    bool ok = true,streamDone = false;
+    while (ok && remaining > 0 && !streamDone)
+    {
+        size_t toRead = std::min((size_t)remaining,inBuf.size());
+        size_t numRead = fread(&inBuf[0],1,toRead,fp);
+        if (numRead == 0)
+        {
+            error = "KMZ file is truncated";
+            ok = false;
+            break;
+        }
+        remaining -= numRead;
+        if (bestMethod == 0)
+        {
+            ok = reader.feed((const char *)&inBuf[0],numRead);
+            continue;
+        }
+        stream.next_in = &inBuf[0];
+        stream.avail_in = (uInt)numRead;
+        while (ok && stream.avail_in > 0 && !streamDone)
+        {
+            stream.next_out = &outBuf[0];
+            stream.avail_out = (uInt)outBuf.size();
+            int ret = inflate(&stream,Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END)
+            {
+                error = "Corrupt data in the KMZ";
+                ok = false;
+                break;
+            }
+            streamDone = ret == Z_STREAM_END;
+            ok = reader.feed((const char *)&outBuf[0],outBuf.size() - stream.avail_out);
+        }
+    }
+    if (bestMethod == 8)
+        inflateEnd(&stream);
+    if (ok)
+        ok = reader.finish();
+    if (!ok && error.empty())
+        error = reader.getError();
+
+    return ok;
+}
+
+bool KMLReader::inElement(const char *name) const
+{
+    for (const auto &elem : elements)
+        if (elem == name)
+            return true;
+
+    return false;
+}
+
+const std::string &KMLReader::parentElement(int up) const
+{
+    static const std::string empty;
+    int which = (int)elements.size() - 1 - up;
+    return which >= 0 ? elements[which] : empty;
+}
+
+void KMLReader::ParseCoordinates(const std::string &str,VectorRing &pts)
+{
+    // Tuples of lon,lat[,alt] separated by whitespace
+    const char *ptr = str.c_str();
+    while (*ptr)
+    {
+        char *end;
+        double lon = strtod(ptr,&end);
+        if (end == ptr)
+        {
+            ptr++;
+            continue;
+        }
+        ptr = end;
+        while (*ptr == ' ' || *ptr == '\t')
+            ptr++;
+        if (*ptr != ',')
+            continue;
+        ptr++;
+        double lat = strtod(ptr,&end);
+        if (end == ptr)
+            continue;
+        ptr = end;
+        pts.push_back(GeoCoord::CoordFromDegrees(lon,lat));
+        // Skip the altitude, if any
+        while (*ptr && !isspace((unsigned char)*ptr))
+            ptr++;
+    }
+}
+
+bool KMLReader::resolveStyle(const std::string &url,KMLStyle &style,int depth) const
+{
+    if (depth > 4 || url.empty() || url[0] != '#')
+        return false;
+    std::string styleID = url.substr(1);
+
+    auto mapIt = styleMaps.find(styleID);
+    if (mapIt != styleMaps.end())
+        return resolveStyle(mapIt->second,style,depth+1);
+
+    auto it = styles.find(styleID);
+    if (it == styles.end())
+        return false;
+    style.merge(it->second);
+
+    return true;
+}
+
+void KMLReader::startElement(const std::string &name,const XMLAttributes &attrs)
+{
+    elements.push_back(name);
+    text.clear();
+
+    if (name == "Document" || name == "Folder")
+        containerNames.push_back(std::string());
+    else if (name == "Placemark")
+    {
+        inPlacemark = true;
+        placemarkAttrs.clear();
+        placemarkStyleUrl.clear();
+        inlineStyle = KMLStyle();
+        hasInlineStyle = false;
+        placemarkShapes.clear();
+        auto idIt = attrs.find("id");
+        if (idIt != attrs.end())
+            placemarkAttrs.setString("id",idIt->second);
+    } else if (name == "Style")
+    {
+        inStyle = true;
+        curStyle = KMLStyle();
+        auto idIt = attrs.find("id");
+        curStyleID = idIt == attrs.end() ? std::string() : idIt->second;
+    } else if (name == "StyleMap")
+    {
+        auto idIt = attrs.find("id");
+        curMapID = idIt == attrs.end() ? std::string() : idIt->second;
+    } else if (name == "Pair")
+    {
+        curPairKey.clear();
+        curPairUrl.clear();
+    } else if (name == "LineStyle")
+        curStyle.hasLine = true;
+    else if (name == "PolyStyle")
+        curStyle.hasPoly = true;
+    else if (name == "IconStyle")
+        curStyle.hasIcon = true;
+    else if (name == "LabelStyle")
+        curStyle.hasLabel = true;
+    else if (name == "Polygon" && inPlacemark)
+        curAreal = VectorAreal::createAreal();
+    else if ((name == "Data" || name == "SimpleData") && inPlacemark)
+    {
+        auto nameIt = attrs.find("name");
+        dataName = nameIt == attrs.end() ? std::string() : nameIt->second;
+    }
+}
+
+void KMLReader::characters(const std::string &newText)
+{
+    text += newText;
+}
+
+void KMLReader::endElement(const std::string &name)
+{
+    const std::string &parent = parentElement();
+
+    if (name == "Document" || name == "Folder")
+    {
+        if (!containerNames.empty())
+            containerNames.pop_back();
+    } else if (name == "name")
+    {
+        if (inPlacemark && parent == "Placemark")
+            placemarkAttrs.setString("name",Trim(text));
+        else if ((parent == "Document" || parent == "Folder") && !containerNames.empty())
+            containerNames.back() = Trim(text);
+    } else if (inStyle)
+    {
+        std::string val = Trim(text);
+        if (name == "color")
+        {
+            if (parent == "LineStyle")
+                KMLStyle::ParseColor(val,curStyle.lineColor);
+            else if (parent == "PolyStyle")
+                KMLStyle::ParseColor(val,curStyle.polyColor);
+            else if (parent == "IconStyle")
+                KMLStyle::ParseColor(val,curStyle.iconColor);
+            else if (parent == "LabelStyle")
+                KMLStyle::ParseColor(val,curStyle.labelColor);
+        } else if (name == "width" && parent == "LineStyle")
+            curStyle.lineWidth = atof(val.c_str());
+        else if (name == "fill" && parent == "PolyStyle")
+            curStyle.polyFill = atoi(val.c_str()) != 0;
+        else if (name == "outline" && parent == "PolyStyle")
+            curStyle.polyOutline = atoi(val.c_str()) != 0;
+        else if (name == "scale" && parent == "IconStyle")
+            curStyle.iconScale = atof(val.c_str());
+        else if (name == "scale" && parent == "LabelStyle")
+            curStyle.labelScale = atof(val.c_str());
+        else if (name == "href" && parent == "Icon")
+            curStyle.iconHref = val;
+        else if (name == "Style")
+        {
+            inStyle = false;
+            if (inPlacemark && parent == "Placemark")
+            {
+                inlineStyle.merge(curStyle);
+                hasInlineStyle = true;
+            } else if (!curStyleID.empty())
+                styles[curStyleID] = curStyle;
+        }
+    } else if (name == "key" && parent == "Pair")
+        curPairKey = Trim(text);
+    else if (name == "styleUrl")
+    {
+        if (parent == "Pair")
+            curPairUrl = Trim(text);
+        else if (inPlacemark)
+            placemarkStyleUrl = Trim(text);
+    } else if (name == "Pair")
+    {
+        if (curPairKey == "normal" && !curMapID.empty())
+            styleMaps[curMapID] = curPairUrl;
+    } else if (inPlacemark)
+    {
+        if (name == "coordinates")
+        {
+            if (parent == "Point")
+            {
+                VectorPointsRef pts = VectorPoints::createPoints();
+                ParseCoordinates(text,pts->pts);
+                if (!pts->pts.empty())
+                {
+                    pts->initGeoMbr();
+                    placemarkShapes.push_back(pts);
+                }
+            } else if (parent == "LineString" || (parent == "LinearRing" && !curAreal))
+            {
+                VectorLinearRef lin = VectorLinear::createLinear();
+                ParseCoordinates(text,lin->pts);
+                if (!lin->pts.empty())
+                {
+                    lin->initGeoMbr();
+                    placemarkShapes.push_back(lin);
+                }
+            } else if (parent == "LinearRing" && curAreal)
+            {
+                // Outer boundary goes first
+                VectorRing ring;
+                ParseCoordinates(text,ring);
+                if (!ring.empty())
+                {
+                    if (parentElement(2) == "outerBoundaryIs")
+                        curAreal->loops.insert(curAreal->loops.begin(),ring);
+                    else
+                        curAreal->loops.push_back(ring);
+                }
+            }
+        } else if (name == "Polygon")
+        {
+            if (curAreal && !curAreal->loops.empty())
+            {
+                curAreal->initGeoMbr();
+                placemarkShapes.push_back(curAreal);
+            }
+            curAreal.reset();
+        } else if (name == "description" && parent == "Placemark")
+            placemarkAttrs.setString("description",Trim(text));
+        else if (name == "when" && parent == "TimeStamp")
+            placemarkAttrs.setString("when",Trim(text));
+        else if ((name == "begin" || name == "end") && parent == "TimeSpan")
+            placemarkAttrs.setString(name,Trim(text));
+        else if (name == "value" && parent == "Data" && !dataName.empty())
+            placemarkAttrs.setString(dataName,Trim(text));
+        else if (name == "SimpleData" && !dataName.empty())
+            placemarkAttrs.setString(dataName,Trim(text));
+        else if (name == "Placemark")
+            finishPlacemark();
+    }
+
+    elements.pop_back();
+    text.clear();
+}
+
+void KMLReader::finishPlacemark()
+{
+    inPlacemark = false;
+    if (placemarkShapes.empty())
+        return;
+
+    // Folder path, leaving out unnamed ones
+    std::string folder;
+    for (const auto &containerName : containerNames)
+        if (!containerName.empty())
+            folder += (folder.empty() ? "" : "/") + containerName;
+    if (!folder.empty())
+        placemarkAttrs.setString("folder",folder);
+
+    KMLStyle style;
+    bool hasStyle = false;
+    if (!placemarkStyleUrl.empty())
+    {
+        placemarkAttrs.setString("styleUrl",placemarkStyleUrl);
+        hasStyle = resolveStyle(placemarkStyleUrl,style);
+    }
+    // Inline styles override shared ones
+    if (hasInlineStyle)
+    {
+        style.merge(inlineStyle);
+        hasStyle = true;
+    }
+
+    ShapeSet newShapes;
+    for (auto shape : placemarkShapes)
+    {
+        Dictionary attrs(placemarkAttrs);
+        if (hasStyle)
+            style.addAttributes(shape.get(),attrs);
+        shape->setAttrDict(attrs);
+        newShapes.insert(shape);
+    }
+    placemarkShapes.clear();
+
+    if (featureCallback)
+        featureCallback(newShapes);
+    else
+        shapes.insert(newShapes.begin(),newShapes.end());
+}
+
+}
@@ -210,6 +210,8 @@ LabelManager::~LabelManager()
     
 SimpleIdentity LabelManager::addLabels(std::vector<SingleLabel *> &labels,const LabelInfo &labelInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(labelInfo.memLabel);
     CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
 
     // Set up the representation (but then hand it off)
@@ -280,10 +282,16 @@ SimpleIdentity LabelManager::addLabels(std::vector<SingleLabel *> &labels,const
         }
     }
 
+    // Keyframe tracks can animate the label set as a whole
+    if (!labelRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(labelRep->getId(),labelRep->drawIDs));
+
     SimpleIdentity labelID = labelRep->getId();
     pthread_mutex_lock(&labelLock);
     labelReps.insert(labelRep);
     pthread_mutex_unlock(&labelLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(labelRep->getId(),sizeof(*labelRep),memTag);
     
     return labelID;
 }
@@ -371,6 +379,7 @@ void LabelManager::removeLabels(SimpleIDSet &labelIDs,ChangeSet &changes)
             for (SimpleIDSet::iterator idIt = labelRep->drawIDs.begin();
                  idIt != labelRep->drawIDs.end(); ++idIt)
                 changes.push_back(new RemDrawableReq(*idIt,removeTime));
+            changes.push_back(new SetAnimFeatureReq(labelRep->getId(),SimpleIDSet()));
             for (SimpleIDSet::iterator idIt = labelRep->texIDs.begin();
                  idIt != labelRep->texIDs.end(); ++idIt)
                 changes.push_back(new RemTextureReq(*idIt,removeTime));
@@ -393,6 +402,7 @@ void LabelManager::removeLabels(SimpleIDSet &labelIDs,ChangeSet &changes)
             if (layoutManager && !labelRep->layoutIDs.empty())
                 layoutManager->removeLayoutObjects(labelRep->layoutIDs);
             
+            untrackSceneRep(labelRep->getId());
             labelReps.erase(it);
             delete labelRep;
         }
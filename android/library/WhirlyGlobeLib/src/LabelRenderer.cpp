@@ -44,7 +44,8 @@ typedef std::map<SimpleIdentity,BasicDrawable *> IconDrawables;
 LabelInfo::LabelInfo(const Dictionary &dict)
     : BaseInfo(dict), textColor(255,255,255,255), outlineColor(0,0,0,0), backColor(0,0,0,0), screenObject(true), layoutEngine(true),
     layoutImportance(1.0), width(0), height(0), labelJustify(WhirlyKitLabelRight), textJustify(WhirlyKitTextLeft),
-    shadowColor(0,0,0,0), shadowSize(0), outlineSize(0), layoutPlacement(-1), lineHeight(0.0)
+    shadowColor(0,0,0,0), shadowSize(0), outlineSize(0), layoutPlacement(-1), lineHeight(0.0),
+    lineSpacing(1.0), wrapWidth(0.0), wrapInEms(false), wrapBalanced(true)
 {
     textColor = dict.getColor(MaplyTextColor, RGBAColor(255,255,255,255));
     backColor = dict.getColor(MaplyBackgroundColor, RGBAColor(0,0,0,0));
@@ -80,8 +81,160 @@ LabelInfo::LabelInfo(const Dictionary &dict)
                 textJustify = WhirlyKitTextRight;
         }
     }
+    lineSpacing = dict.getDouble(MaplyTextLineSpacing,1.0);
+    if (dict.hasField(MaplyTextWrapWidthEms))
+    {
+        wrapWidth = dict.getDouble(MaplyTextWrapWidthEms,0.0);
+        wrapInEms = true;
+    } else
+        wrapWidth = dict.getDouble(MaplyTextWrapWidth,0.0);
+    wrapBalanced = dict.getBool(MaplyTextWrapBalanced,true);
+}
+
+static bool GlyphIsSpace(WKGlyph glyph)
+{
+    return glyph == ' ' || glyph == '\t' || glyph == 0x3000 || (glyph >= 0x2000 && glyph <= 0x200B);
+}
+
+// Hyphens and dashes
+static bool GlyphBreaksAfter(WKGlyph glyph)
+{
+    return glyph == '-' || glyph == 0x2010 || glyph == 0x2013 || glyph == 0x2014;
+}
+
+// Ideographs, kana and hangul can break between any two characters
+static bool GlyphIsCJK(WKGlyph glyph)
+{
+    return (glyph >= 0x2E80 && glyph <= 0x9FFF) || (glyph >= 0xAC00 && glyph <= 0xD7AF) ||
+        (glyph >= 0xF900 && glyph <= 0xFAFF) || (glyph >= 0xFF00 && glyph <= 0xFFEF) ||
+        (glyph >= 0x20000 && glyph <= 0x2FFFF);
 }
 
+TextLineBreaker::TextLineBreaker()
+    : maxWidth(0.0), balanced(true)
+{
+}
+
+int TextLineBreaker::greedyBreak(const std::vector<Word> &words,const std::vector<float> &pos,float width,std::vector<TextLineRange> *lines) const
+{
+    if (lines)
+        lines->clear();
+    
+    int count = 0;
+    size_t first = 0;
+    while (first < words.size())
+    {
+        // Take words until the next one won't fit
+        size_t last = first;
+        while (last+1 < words.size() && pos[words[last+1].end] - pos[words[first].start] <= width)
+            last++;
+        if (lines)
+        {
+            TextLineRange line;
+            line.start = words[first].start;
+            line.end = words[last].end;
+            line.width = pos[line.end] - pos[line.start];
+            lines->push_back(line);
+        }
+        count++;
+        first = last+1;
+    }
+    
+    return count;
+}
+
+void TextLineBreaker::breakLines(const std::vector<WKGlyph> &glyphs,const std::vector<float> &advances,std::vector<TextLineRange> &lines) const
+{
+    lines.clear();
+    int num = (int)std::min(glyphs.size(),advances.size());
+    
+    // Left edge of each glyph
+    std::vector<float> pos(num+1,0.0);
+    for (int ii=0;ii<num;ii++)
+        pos[ii+1] = pos[ii] + advances[ii];
+    
+    // Sort the glyphs into words and the spaces after them
+    std::vector<Word> words;
+    int ii = 0;
+    while (ii < num && GlyphIsSpace(glyphs[ii]))
+        ii++;
+    while (ii < num)
+    {
+        Word word;
+        word.start = ii++;
+        while (ii < num && !GlyphIsSpace(glyphs[ii]) && !GlyphBreaksAfter(glyphs[ii-1]) &&
+               !GlyphIsCJK(glyphs[ii-1]) && !GlyphIsCJK(glyphs[ii]))
+            ii++;
+        word.end = ii;
+        while (ii < num && GlyphIsSpace(glyphs[ii]))
+            ii++;
+        word.next = ii;
+        words.push_back(word);
+    }
+    if (words.empty())
+        return;
+    
+    if (maxWidth <= 0.0)
+    {
+        TextLineRange line;
+        line.start = words.front().start;
+        line.end = words.back().end;
+        line.width = pos[line.end] - pos[line.start];
+        lines.push_back(line);
+        return;
+    }
+    
+    int numLines = greedyBreak(words,pos,maxWidth,&lines);
+    if (!balanced || numLines < 2)
+        return;
+    
+    // Look for the narrowest width that needs no more lines than greedy did
+    float lo = 0.0,hi = maxWidth;
+    for (const Word &word : words)
+        lo = std::max(lo,pos[word.end] - pos[word.start]);
+    if (lo >= hi)
+        return;
+    for (int it=0;it<20 && hi-lo > 0.25;it++)
+    {
+        float mid = (lo+hi)/2.0;
+        if (greedyBreak(words,pos,mid,NULL) <= numLines)
+            hi = mid;
+        else
+            lo = mid;
+    }
+    greedyBreak(words,pos,hi,&lines);
+}
+
+void TextLineBreaker::breakLines(const DrawableString *str,std::vector<TextLineRange> &lines) const
+{
+    int num = (int)str->glyphPolys.size();
+    std::vector<WKGlyph> glyphs(num);
+    std::vector<float> advances(num);
+    for (int ii=0;ii<num;ii++)
+    {
+        const DrawableString::Rect &poly = str->glyphPolys[ii];
+        glyphs[ii] = poly.glyph;
+        if (ii+1 < num)
+            advances[ii] = str->glyphPolys[ii+1].pts[0].x() - poly.pts[0].x();
+        else
+            advances[ii] = poly.pts[1].x() - poly.pts[0].x();
+    }
+    
+    breakLines(glyphs,advances,lines);
+}
+
+// One line of a label, after wrapping
+class LabelLine
+{
+public:
+    DrawableString *str;
+    int start,end;
+    // Moves the glyphs to the line's spot
+    Point2d off;
+    // Where the line ends up
+    Mbr mbr;
+};
+
 LabelRenderer::LabelRenderer(Scene *scene,FontTextureManager *fontTexManager,const LabelInfo *labelInfo)
     : useAttributedString(true), scene(scene), fontTexManager(fontTexManager), labelInfo(labelInfo),
     textureAtlasSize(2048), labelRep(NULL)
@@ -129,23 +282,66 @@ void LabelRenderer::render(std::vector<SingleLabel *> &labels,ChangeSet &changes
         bool embeddedColor = true;
         
         std::vector<DrawableString *> drawStrs = label->generateDrawableStrings(labelInfo,fontTexManager,changes);
-        Mbr drawMbr;
-        Mbr layoutMbr;
-        int whichLine = 0;
 
-        // Convert the lines
-        // Note: Pass this in
+        // Break up anything wider than the wrap width.  The label can override it.
+        float wrapWidth = label->desc.getDouble(MaplyTextWrapWidth,labelInfo->wrapInEms ? 0.0 : labelInfo->wrapWidth);
+        float wrapWidthEms = label->desc.getDouble(MaplyTextWrapWidthEms,labelInfo->wrapInEms ? labelInfo->wrapWidth : 0.0);
+        TextLineBreaker lineBreaker;
+        lineBreaker.setBalanced(label->desc.getBool(MaplyTextWrapBalanced,labelInfo->wrapBalanced));
+        std::vector<LabelLine> lines;
+        float fontHeight = 0.0;
         for (DrawableString *drawStr : drawStrs)
         {
-            Mbr thisMbr = drawStr->mbr;
-            thisMbr.ll().y() += labelInfo->lineHeight * whichLine;
-            thisMbr.ur().y() += labelInfo->lineHeight * whichLine;
-            drawMbr.expand(thisMbr);
-            Mbr thisLayoutMbr = drawStr->mbr;
-            thisLayoutMbr.ll().y() += labelInfo->lineHeight * whichLine;
-            thisLayoutMbr.ur().y() += labelInfo->lineHeight * whichLine;
-            layoutMbr.expand(thisLayoutMbr);
-            whichLine++;
+            if (!drawStr)
+                continue;
+            float strHeight = drawStr->mbr.ur().y()-drawStr->mbr.ll().y();
+            fontHeight = std::max(fontHeight,strHeight);
+            lineBreaker.setMaxWidth(wrapWidthEms > 0.0 ? wrapWidthEms * strHeight : wrapWidth);
+            std::vector<TextLineRange> ranges;
+            lineBreaker.breakLines(drawStr,ranges);
+            for (const TextLineRange &range : ranges)
+            {
+                // Slide the line back to where the string starts
+                LabelLine line;
+                line.str = drawStr;
+                line.start = range.start;
+                line.end = range.end;
+                line.off = Point2d(drawStr->mbr.ll().x()-drawStr->glyphPolys[range.start].pts[0].x(),0.0);
+                for (int ii=range.start;ii<range.end;ii++)
+                {
+                    const DrawableString::Rect &poly = drawStr->glyphPolys[ii];
+                    line.mbr.addPoint(Point2f(poly.pts[0].x()+line.off.x(),poly.pts[0].y()));
+                    line.mbr.addPoint(Point2f(poly.pts[1].x()+line.off.x(),poly.pts[1].y()));
+                }
+                lines.push_back(line);
+            }
+        }
+
+        // Stack the lines with the first one on top.  The box around them is what we lay out.
+        float lineHeight = (labelInfo->lineHeight > 0.0 ? labelInfo->lineHeight : fontHeight) *
+                            label->desc.getDouble(MaplyTextLineSpacing,labelInfo->lineSpacing);
+        Mbr drawMbr;
+        for (unsigned int li=0;li<lines.size();li++)
+        {
+            LabelLine &line = lines[li];
+            line.off.y() = lineHeight * (lines.size()-1-li);
+            line.mbr.ll().y() += line.off.y();
+            line.mbr.ur().y() += line.off.y();
+            drawMbr.expand(line.mbr);
+        }
+        Mbr layoutMbr = drawMbr;
+
+        // Text justification can come from the label too
+        TextJustify textJustify = labelInfo->textJustify;
+        if (label->desc.hasField(MaplyTextJustify))
+        {
+            std::string textJustifyStr = label->desc.getString(MaplyTextJustify);
+            if (!textJustifyStr.compare("center"))
+                textJustify = WhirlyKitTextCenter;
+            else if (!textJustifyStr.compare("left"))
+                textJustify = WhirlyKitTextLeft;
+            else if (!textJustifyStr.compare("right"))
+                textJustify = WhirlyKitTextRight;
         }
 
         // Set if we're letting the layout engine control placement
@@ -205,6 +401,8 @@ void LabelRenderer::render(std::vector<SingleLabel *> &labels,ChangeSet &changes
             if (label->isSelectable && label->selectID != EmptyIdentity)
                 screenShape->setId(label->selectID);
             screenShape->setWorldLoc(coordAdapter->localToDisplay(coordAdapter->getCoordSystem()->geographicToLocal3d(label->loc)));
+            if (label->hasMotion)
+                screenShape->setMovingLoc(coordAdapter->localToDisplay(coordAdapter->getCoordSystem()->geographicToLocal3d(label->endLoc)),label->startTime,label->endTime);
             
             // If there's an icon, we need to offset
             float height = drawMbr.ur().y()-drawMbr.ll().y();
@@ -354,28 +552,28 @@ void LabelRenderer::render(std::vector<SingleLabel *> &labels,ChangeSet &changes
         }
 
         // Work through the lines
-        double offsetY = 0.0;
-        std::reverse(drawStrs.begin(),drawStrs.end());
         for (DrawableString *drawStr : drawStrs)
+            if (drawStr)
+                labelRep->drawStrIDs.insert(drawStr->getId());
+        
+        if (labelInfo->screenObject)
         {
-            if (!drawStr)
-                continue;
-            
-            labelRep->drawStrIDs.insert(drawStr->getId());
-            
-            if (labelInfo->screenObject)
+            float blockWidth = drawMbr.ur().x()-drawMbr.ll().x();
+            for (const LabelLine &line : lines)
             {
-                Point2d lineOff(0.0,0.0);
-                switch (labelInfo->textJustify)
+                // Justify each line within the block
+                Point2d lineOff = line.off + Point2d(drawMbr.ll().x()-line.mbr.ll().x(),0.0);
+                float lineWidth = line.mbr.ur().x()-line.mbr.ll().x();
+                switch (textJustify)
                 {
                     case WhirlyKitTextCenter:
-                        lineOff.x() = (drawMbr.ur().x()-drawMbr.ll().x() - (drawStr->mbr.ur().x()-drawStr->mbr.ll().x()))/2.0;
+                        lineOff.x() += (blockWidth - lineWidth)/2.0;
                         break;
                     case WhirlyKitTextLeft:
                         // Leave it alone
                         break;
                     case WhirlyKitTextRight:
-                        lineOff.x() = drawMbr.ur().x()-drawMbr.ll().x() - (drawStr->mbr.ur().x()-drawStr->mbr.ll().x());
+                        lineOff.x() += blockWidth - lineWidth;
                         break;
                 }
                 
@@ -393,22 +591,22 @@ void LabelRenderer::render(std::vector<SingleLabel *> &labels,ChangeSet &changes
                         soff = Point2d(theShadowSize,theShadowSize);
                         color = theShadowColor;
                     }
-                    for (unsigned int ii=0;ii<drawStr->glyphPolys.size();ii++)
+                    for (int ii=line.start;ii<line.end;ii++)
                     {
-                        DrawableString::Rect &poly = drawStr->glyphPolys[ii];
+                        DrawableString::Rect &poly = line.str->glyphPolys[ii];
                         // Note: Ignoring the desired size in favor of the font size
                         ScreenSpaceObject::ConvexGeometry smGeom;
                         smGeom.progID = labelInfo->programID;
-                        smGeom.coords.push_back(Point2d(poly.pts[1].x()+label->screenOffset.x(),poly.pts[0].y()+label->screenOffset.y() + offsetY) + soff + iconOff + justifyOff + lineOff);
+                        smGeom.coords.push_back(Point2d(poly.pts[1].x()+label->screenOffset.x(),poly.pts[0].y()+label->screenOffset.y()) + soff + iconOff + justifyOff + lineOff);
                         smGeom.texCoords.push_back(TexCoord(poly.texCoords[1].u(),poly.texCoords[0].v()));
                         
-                        smGeom.coords.push_back(Point2d(poly.pts[1].x()+label->screenOffset.x(),poly.pts[1].y()+label->screenOffset.y() + offsetY) + soff + iconOff + justifyOff + lineOff);
+                        smGeom.coords.push_back(Point2d(poly.pts[1].x()+label->screenOffset.x(),poly.pts[1].y()+label->screenOffset.y()) + soff + iconOff + justifyOff + lineOff);
                         smGeom.texCoords.push_back(TexCoord(poly.texCoords[1].u(),poly.texCoords[1].v()));
                         
-                        smGeom.coords.push_back(Point2d(poly.pts[0].x()+label->screenOffset.x(),poly.pts[1].y()+label->screenOffset.y() + offsetY) + soff + iconOff + justifyOff + lineOff);
+                        smGeom.coords.push_back(Point2d(poly.pts[0].x()+label->screenOffset.x(),poly.pts[1].y()+label->screenOffset.y()) + soff + iconOff + justifyOff + lineOff);
                         smGeom.texCoords.push_back(TexCoord(poly.texCoords[0].u(),poly.texCoords[1].y()));
                         
-                        smGeom.coords.push_back(Point2d(poly.pts[0].x()+label->screenOffset.x(),poly.pts[0].y()+label->screenOffset.y() + offsetY) + soff + iconOff + justifyOff + lineOff);
+                        smGeom.coords.push_back(Point2d(poly.pts[0].x()+label->screenOffset.x(),poly.pts[0].y()+label->screenOffset.y()) + soff + iconOff + justifyOff + lineOff);
                         smGeom.texCoords.push_back(TexCoord(poly.texCoords[0].u(),poly.texCoords[0].v()));
                         
                         smGeom.texIDs.push_back(poly.subTex.texId);
@@ -418,8 +616,6 @@ void LabelRenderer::render(std::vector<SingleLabel *> &labels,ChangeSet &changes
                     }
                 }
             }
-
-            offsetY += labelInfo->lineHeight;
         }
         
         if (layoutObject)
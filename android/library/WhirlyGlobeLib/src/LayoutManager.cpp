@@ -110,6 +110,7 @@ void LayoutManager::setMaxDisplayObjects(int numObjects)
     
 void LayoutManager::addLayoutObjects(const std::vector<LayoutObject> &newObjects)
 {
+    int memTag = getMemTag("");
 	pthread_mutex_lock(&layoutLock);
 
     for (unsigned int ii=0;ii<newObjects.size();ii++)
@@ -118,6 +119,8 @@ void LayoutManager::addLayoutObjects(const std::vector<LayoutObject> &newObjects
         LayoutObjectEntry *entry = new LayoutObjectEntry(layoutObj.getId());
         entry->obj = newObjects[ii];
         layoutObjects.insert(entry);
+        if (scene)
+            scene->getMemTracker()->addObject(MemTrackLayoutObject,entry->getId(),memTag,sizeof(LayoutObjectEntry));
     }
     hasUpdates = true;
 
@@ -127,6 +130,7 @@ void LayoutManager::addLayoutObjects(const std::vector<LayoutObject> &newObjects
     
 void LayoutManager::addLayoutObjects(const std::vector<LayoutObject *> &newObjects)
 {
+    int memTag = getMemTag("");
 	pthread_mutex_lock(&layoutLock);
 
 	for (unsigned int ii=0;ii<newObjects.size();ii++)
@@ -135,6 +139,8 @@ void LayoutManager::addLayoutObjects(const std::vector<LayoutObject *> &newObjec
         LayoutObjectEntry *entry = new LayoutObjectEntry(layoutObj->getId());
         entry->obj = *(newObjects[ii]);
         layoutObjects.insert(entry);
+        if (scene)
+            scene->getMemTracker()->addObject(MemTrackLayoutObject,entry->getId(),memTag,sizeof(LayoutObjectEntry));
     }
     hasUpdates = true;
 
@@ -173,6 +179,8 @@ void LayoutManager::removeLayoutObjects(const SimpleIDSet &oldObjects)
             delete *eit;
             layoutObjects.erase(eit);
         }
+        if (scene)
+            scene->getMemTracker()->removeObject(MemTrackLayoutObject,*it);
     }
     hasUpdates = true;
 
@@ -457,6 +465,7 @@ bool LayoutManager::runLayoutRules(ViewState *viewState, std::vector<ClusterEntr
 			clusterGen->paramsForClusterClass(cluster->clusterID,params);
 
 			ClusterHelper clusterHelper(screenMbr,OverlapSampleX,OverlapSampleY,resScale,params.clusterSize);
+			clusterHelper.setStatDefs(params.statDefs);
 
 			// Add all the various objects to the cluster and figure out overlaps
 			for (LayoutSortingSet::iterator sit = cluster->layoutObjects.begin(); sit != cluster->layoutObjects.end(); ++sit)
@@ -539,7 +548,7 @@ bool LayoutManager::runLayoutRules(ViewState *viewState, std::vector<ClusterEntr
 						clusterEntry.layoutObj.worldLoc = dispPt;
 						for (auto thisObj : objsForCluster)
 							clusterEntry.objectIDs.push_back(thisObj->obj.getId());
-						clusterGen->makeLayoutObject(cluster->clusterID, objsForCluster, clusterEntry.layoutObj);
+						clusterGen->makeLayoutObject(cluster->clusterID, objsForCluster, clusterObj.stats, clusterEntry.layoutObj);
 						if (!params.selectable)
 							clusterEntry.layoutObj.selectPts.clear();
 					}
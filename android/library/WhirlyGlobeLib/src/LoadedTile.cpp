@@ -473,7 +473,7 @@ void TileBuilder::generateDrawables(ElevationDrawInfo *drawInfo,BasicDrawable **
         if (coverPoles && !drawInfo->coordAdapter->isFlat())
         {
             // If we're at the top, toss in a few more triangles to represent that
-            int maxY = 1 << drawInfo->ident.level;
+            int maxY = drawInfo->yDim;
             if (drawInfo->ident.y == maxY-1)
             {
                 TexCoord singleTexCoord(0.5,0.0);
@@ -594,8 +594,9 @@ bool TileBuilder::buildTile(Quadtree::NodeInfo *nodeInfo,BasicDrawable **draw,Ba
         theMbr.ur().y() = mbr.ur().y();
     
     // Number of pieces at this level
-    int xDim = 1<<nodeInfo->ident.level;
-    int yDim = 1<<nodeInfo->ident.level;
+    const TileMatrix &tileMatrix = tree->getTileMatrixSet()->getLevel(nodeInfo->ident.level);
+    int xDim = tileMatrix.matrixWidth;
+    int yDim = tileMatrix.matrixHeight;
     
     //    NSLog(@"Chunk ll = (%.4f,%.4f)  ur = (%.4f,%.4f)",mbr.ll().x(),mbr.ll().y(),mbr.ur().x(),mbr.ur().y());
     
@@ -23,6 +23,9 @@
 #import "LayoutManager.h"
 #import "ScreenSpaceBuilder.h"
 #import "SharedAttributes.h"
+#import "SpriteSheet.h"
+#import "DefaultShaderPrograms.h"
+#import "WhirlyKitLog.h"
 
 using namespace Eigen;
 using namespace WhirlyKit;
@@ -81,7 +84,7 @@ void Marker::addTexID(SimpleIdentity texID)
 MarkerInfo::MarkerInfo(const Dictionary &dict)
     : BaseInfo(dict), color(255,255,255,255),
     screenObject(false), width(0.001), height(0.001), layoutImportance(MAXFLOAT),
-    markerId(EmptyIdentity), clusterGroup(-1)
+    markerId(EmptyIdentity), clusterGroup(-1), haloColor(0,0,0,0), haloWidth(0.0), haloBlur(0.0)
 {
     color = dict.getColor(MaplyColor, RGBAColor(255,255,255,255));
     screenObject = dict.getBool("screen",false);
@@ -89,6 +92,9 @@ MarkerInfo::MarkerInfo(const Dictionary &dict)
     height = dict.getDouble(MaplyLabelHeight,(screenObject ? 16.0 : 0.001));
     layoutImportance = dict.getDouble(MaplyLayoutImportance,MAXFLOAT);
     clusterGroup = dict.getInt(MaplyClusterGroup,-1);
+    haloColor = dict.getColor(MaplyIconHaloColor, RGBAColor(0,0,0,0));
+    haloWidth = dict.getDouble(MaplyIconHaloWidth,0.0);
+    haloBlur = dict.getDouble(MaplyIconHaloBlur,0.0);
 }
 
 MarkerManager::MarkerManager()
@@ -110,9 +116,12 @@ typedef std::map<SimpleIDSet,BasicDrawable *> DrawableMap;
 
 SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,const MarkerInfo &markerInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(markerInfo.memLabel);
 
     SelectionManager *selectManager = (SelectionManager *)scene->getManager(kWKSelectionManager);
     LayoutManager *layoutManager = (LayoutManager *)scene->getManager(kWKLayoutManager);
+    SpriteSheetManager *spriteManager = (SpriteSheetManager *)scene->getManager(kWKSpriteSheetManager);
     TimeInterval curTime = TimeGetCurrent();
     
     CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
@@ -129,6 +138,9 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
     // Objects to be controlled by the layout layer
     std::vector<LayoutObject *> layoutObjects;
     
+    // Distance field icons we couldn't draw
+    int sdfRejected = 0;
+    
     for (unsigned int ii=0;ii<markers.size();ii++)
     {
         Marker *marker = markers[ii];
@@ -152,6 +164,32 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
             subTexs.push_back(subTex);
         }
         
+        // Icons can also come from a sprite sheet by name
+        SpriteIcon icon;
+        bool hasIcon = false;
+        if (subTexs.empty() && !marker->iconName.empty() && spriteManager)
+        {
+            hasIcon = spriteManager->findIcon(marker->iconName,icon);
+            // The distance field shaders only work in screen space.  Drawn as a regular
+            //  texture the field comes out as a gray smudge, so leave these out.
+            if (hasIcon && icon.sdf && !markerInfo.screenObject)
+            {
+                sdfRejected++;
+                continue;
+            }
+            if (hasIcon)
+            {
+                subTexs.push_back(scene->getSubTexture(icon.subTexID));
+                if (markerInfo.screenObject && marker->width == 0.0 && marker->height == 0.0)
+                {
+                    Point2f iconSize = icon.getSize();
+                    width2 = iconSize.x()/2.0;
+                    height2 = iconSize.y()/2.0;
+                }
+            } else
+                WHIRLYKIT_LOGW("MarkerManager: No icon named %s",marker->iconName.c_str());
+        }
+        
         // Build one set of texture coordinates
         std::vector<TexCoord> texCoord;
         texCoord.resize(4);
@@ -192,6 +230,31 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
             smGeom.vertexAttrs = marker->vertexAttrs;
             if (marker->colorSet)
                 smGeom.color = marker->color;
+            // Distance field icons get tinted by the color and need their own shader
+            if (hasIcon && icon.sdf)
+            {
+                if (smGeom.progID == EmptyIdentity)
+                    smGeom.progID = scene->getProgramIDBySceneName(marker->hasMotion ? kToolkitDefaultScreenSpaceSDFMotionProgram : kToolkitDefaultScreenSpaceSDFProgram);
+                
+                // Screen pixels per texel keeps the edge crisp at any size
+                float pixelScale = renderer ? renderer->getScale() : 1.0;
+                float texelScale = 2.0 * width2 * pixelScale / icon.width;
+                SingleVertexAttribute haloAttr;
+                haloAttr.name = "a_haloColor";
+                haloAttr.type = BDChar4Type;
+                haloAttr.data.color[0] = markerInfo.haloColor.r;
+                haloAttr.data.color[1] = markerInfo.haloColor.g;
+                haloAttr.data.color[2] = markerInfo.haloColor.b;
+                haloAttr.data.color[3] = markerInfo.haloColor.a;
+                smGeom.vertexAttrs.insert(haloAttr);
+                SingleVertexAttribute sdfAttr;
+                sdfAttr.name = "a_sdfParams";
+                sdfAttr.type = BDFloat3Type;
+                sdfAttr.data.vec3[0] = texelScale;
+                sdfAttr.data.vec3[1] = markerInfo.haloWidth * pixelScale / texelScale;
+                sdfAttr.data.vec3[2] = markerInfo.haloBlur * pixelScale / texelScale;
+                smGeom.vertexAttrs.insert(sdfAttr);
+            }
             for (unsigned int ii=0;ii<4;ii++)
             {
                 smGeom.coords.push_back(Point2d(pts[ii].x(),pts[ii].y()));
@@ -200,6 +263,11 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
             if (marker->isSelectable && marker->selectID != EmptyIdentity)
                 shape->setId(marker->selectID);
             shape->setWorldLoc(coordAdapter->localToDisplay(localPt));
+            if (marker->hasMotion)
+            {
+                Point3d localEndPt = coordAdapter->getCoordSystem()->geographicToLocal3d(marker->endLoc);
+                shape->setMovingLoc(coordAdapter->localToDisplay(localEndPt), marker->startTime, marker->endTime);
+            }
             if (marker->lockRotation)
                 shape->setRotation(marker->rotation);
             if (markerInfo.fadeIn > 0.0)
@@ -235,6 +303,7 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
                     layoutObj->layoutPts = layoutObj->selectPts;
                 }
                 layoutObj->clusterGroup = markerInfo.clusterGroup;
+                layoutObj->attrs = marker->attrs;
                 layoutObj->importance = layoutImport;
                 // No moving it around
                 layoutObj->acceptablePlacement = 1;
@@ -270,6 +339,13 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
 
                 screenShapes.push_back(shape);
             }
+            
+            // Hand the attributes to selection so the region queries can return them
+            if (selectManager && marker->selectID != EmptyIdentity && marker->attrs)
+            {
+                selectManager->setSelectableAttributes(marker->selectID,marker->attrs);
+                markerRep->selectIDs.insert(marker->selectID);
+            }
         } else {
             Point3d center = coordAdapter->localToDisplay(localPt);
             Vector3d up(0,0,1);
@@ -343,10 +419,15 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
             {
                 selectManager->addSelectableRect(marker->selectID,pts,markerInfo.minVis,markerInfo.maxVis,markerInfo.enable);
                 markerRep->selectIDs.insert(marker->selectID);
+                if (marker->attrs)
+                    selectManager->setSelectableAttributes(marker->selectID,marker->attrs);
             }
         }
     }
 
+    if (sdfRejected > 0)
+        WHIRLYKIT_LOGW("MarkerManager: Skipped %d 3D markers with distance field icons.  Those only work on screen markers.",sdfRejected);
+
     // Flush out any drawables for the static geometry
     for (DrawableMap::iterator it = drawables.begin();
          it != drawables.end(); ++it)
@@ -372,6 +453,10 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
         ssBuild.flushChanges(changes, markerRep->drawIDs);
     }
     
+    // Keyframe tracks can animate the marker set as a whole
+    if (!markerRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(markerRep->getId(),markerRep->drawIDs));
+    
     // And any layout constraints to the layout engine
     if (layoutManager && !layoutObjects.empty())
         layoutManager->addLayoutObjects(layoutObjects);
@@ -381,6 +466,8 @@ SimpleIdentity MarkerManager::addMarkers(const std::vector<Marker *> &markers,co
     pthread_mutex_lock(&markerLock);
     markerReps.insert(markerRep);
     pthread_mutex_unlock(&markerLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(markerRep->getId(),sizeof(*markerRep),memTag);
     
     return markerInfo.markerId;
 }
@@ -435,9 +522,11 @@ void MarkerManager::removeMarkers(SimpleIDSet &markerIDs,ChangeSet &changes)
                 removeTime = curTime + markerRep->fadeOut;
             }
             
+            changes.push_back(new SetAnimFeatureReq(markerID,SimpleIDSet()));
             
             markerRep->clearContents(selectManager, layoutManager, generatorId, screenGenId, changes, removeTime);
             
+            untrackSceneRep(markerRep->getId());
             markerReps.erase(it);
             delete markerRep;
         }
@@ -0,0 +1,244 @@
+/*
+ *  MemTracker.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import "MemTracker.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+MemTagStats::MemTagStats()
+    : totalBytes(0), maxTotalBytes(0)
+{
+    for (unsigned int ii=0;ii<MemTrackNumKinds;ii++)
+    {
+        count[ii] = maxCount[ii] = 0;
+        bytes[ii] = maxBytes[ii] = 0;
+    }
+}
+
+MemTracker::MemTracker()
+    : enable(true)
+{
+    pthread_mutex_init(&lock,NULL);
+}
+
+MemTracker::~MemTracker()
+{
+    pthread_mutex_destroy(&lock);
+}
+
+int MemTracker::getTagLocked(const std::string &owner,const std::string &label)
+{
+    auto key = std::make_pair(owner,label);
+    auto it = tagMap.find(key);
+    if (it != tagMap.end())
+        return it->second;
+
+    int tag = (int)tags.size();
+    tags.resize(tags.size()+1);
+    tags[tag].owner = owner;
+    tags[tag].label = label;
+    tagMap[key] = tag;
+
+    return tag;
+}
+
+int MemTracker::getTag(const std::string &owner,const std::string &label)
+{
+    pthread_mutex_lock(&lock);
+    int tag = getTagLocked(owner,label);
+    pthread_mutex_unlock(&lock);
+
+    return tag;
+}
+
+void MemTracker::removeLocked(MemTrackKind kind,SimpleIdentity objID)
+{
+    auto it = live[kind].find(objID);
+    if (it == live[kind].end())
+        return;
+
+    MemTagStats &stats = tags[it->second.tag];
+    stats.count[kind]--;
+    stats.bytes[kind] -= it->second.bytes;
+    stats.totalBytes -= it->second.bytes;
+    live[kind].erase(it);
+}
+
+void MemTracker::addObject(MemTrackKind kind,SimpleIdentity objID,int tag,unsigned long bytes)
+{
+    if (!enable || tag < 0)
+        return;
+
+    pthread_mutex_lock(&lock);
+    addLocked(kind,objID,tag,bytes);
+    pthread_mutex_unlock(&lock);
+}
+
+void MemTracker::addLocked(MemTrackKind kind,SimpleIdentity objID,int tag,unsigned long bytes)
+{
+    if (tag < tags.size())
+    {
+        removeLocked(kind,objID);
+
+        LiveEntry &entry = live[kind][objID];
+        entry.tag = tag;
+        entry.bytes = bytes;
+
+        MemTagStats &stats = tags[tag];
+        stats.count[kind]++;
+        stats.bytes[kind] += bytes;
+        stats.totalBytes += bytes;
+        stats.maxCount[kind] = std::max(stats.maxCount[kind],stats.count[kind]);
+        stats.maxBytes[kind] = std::max(stats.maxBytes[kind],stats.bytes[kind]);
+        stats.maxTotalBytes = std::max(stats.maxTotalBytes,stats.totalBytes);
+    }
+}
+
+void MemTracker::addObject(MemTrackKind kind,SimpleIdentity objID,const std::string &owner,const std::string &label,unsigned long bytes)
+{
+    if (!enable)
+        return;
+
+    // Look up the tag and add under the one lock
+    pthread_mutex_lock(&lock);
+    addLocked(kind,objID,getTagLocked(owner,label),bytes);
+    pthread_mutex_unlock(&lock);
+}
+
+void MemTracker::removeObject(MemTrackKind kind,SimpleIdentity objID)
+{
+    // Objects added while we were on can go away while we're off
+    pthread_mutex_lock(&lock);
+    removeLocked(kind,objID);
+    pthread_mutex_unlock(&lock);
+}
+
+void MemTracker::removeAll(MemTrackKind kind)
+{
+    pthread_mutex_lock(&lock);
+
+    for (MemTagStats &stats : tags)
+    {
+        stats.totalBytes -= stats.bytes[kind];
+        stats.count[kind] = 0;
+        stats.bytes[kind] = 0;
+    }
+    live[kind].clear();
+
+    pthread_mutex_unlock(&lock);
+}
+
+void MemTracker::getStats(std::vector<MemTagStats> &stats)
+{
+    pthread_mutex_lock(&lock);
+    stats = tags;
+    pthread_mutex_unlock(&lock);
+}
+
+void MemTracker::findLeaks(std::vector<MemLeak> &leaks)
+{
+    pthread_mutex_lock(&lock);
+
+    for (unsigned int kind=0;kind<MemTrackNumKinds;kind++)
+        for (auto it : live[kind])
+        {
+            const MemTagStats &stats = tags[it.second.tag];
+            MemLeak leak;
+            leak.kind = (MemTrackKind)kind;
+            leak.objID = it.first;
+            leak.owner = stats.owner;
+            leak.label = stats.label;
+            leak.bytes = it.second.bytes;
+            leaks.push_back(leak);
+        }
+
+    pthread_mutex_unlock(&lock);
+
+    std::sort(leaks.begin(),leaks.end(),
+              [](const MemLeak &a,const MemLeak &b)
+              {
+                  if (a.owner != b.owner)
+                      return a.owner < b.owner;
+                  if (a.label != b.label)
+                      return a.label < b.label;
+                  if (a.kind != b.kind)
+                      return a.kind < b.kind;
+                  return a.objID < b.objID;
+              });
+}
+
+int MemTracker::logLeaks(int maxPerTag)
+{
+    std::vector<MemLeak> leaks;
+    findLeaks(leaks);
+    if (leaks.empty())
+        return 0;
+
+    WHIRLYKIT_LOGW("MemTracker: %d objects were never removed",(int)leaks.size());
+    int numThisTag = 0;
+    for (unsigned int ii=0;ii<leaks.size();ii++)
+    {
+        const MemLeak &leak = leaks[ii];
+        if (ii == 0 || leak.owner != leaks[ii-1].owner || leak.label != leaks[ii-1].label)
+            numThisTag = 0;
+        if (numThisTag++ < maxPerTag)
+            WHIRLYKIT_LOGW("MemTracker:   %s %s: %s %llu (%lu bytes)",leak.owner.c_str(),leak.label.c_str(),KindName(leak.kind),(unsigned long long)leak.objID,leak.bytes);
+    }
+
+    return (int)leaks.size();
+}
+
+void MemTracker::dumpStats()
+{
+    std::vector<MemTagStats> stats;
+    getStats(stats);
+
+    for (const MemTagStats &tagStats : stats)
+    {
+        WHIRLYKIT_LOGV("MemTracker: %s %s: %lu bytes (max %lu)",tagStats.owner.c_str(),tagStats.label.c_str(),tagStats.totalBytes,tagStats.maxTotalBytes);
+        for (unsigned int kind=0;kind<MemTrackNumKinds;kind++)
+            if (tagStats.maxCount[kind] > 0)
+                WHIRLYKIT_LOGV("MemTracker:   %d %s, %lu bytes (max %d, %lu bytes)",tagStats.count[kind],KindName((MemTrackKind)kind),tagStats.bytes[kind],tagStats.maxCount[kind],tagStats.maxBytes[kind]);
+    }
+}
+
+const char *MemTracker::KindName(MemTrackKind kind)
+{
+    switch (kind)
+    {
+        case MemTrackDrawable:
+            return "drawables";
+        case MemTrackTexture:
+            return "textures";
+        case MemTrackSelectable:
+            return "selectables";
+        case MemTrackLayoutObject:
+            return "layout objects";
+        case MemTrackSceneRep:
+            return "scene reps";
+        default:
+            return "unknown";
+    }
+}
+
+}
@@ -0,0 +1,389 @@
+/*
+ *  MeshBVH.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import <limits>
+#import "MeshBVH.h"
+#import "WhirlyGeometry.h"
+
+using namespace Eigen;
+
+namespace WhirlyKit
+{
+
+// Most triangles we'll put in a leaf
+static const int MaxLeafTriangles = 4;
+
+MeshBVH::MeshBVH()
+    : built(false)
+{
+}
+
+void MeshBVH::addTriangles(const Point3d *pts,int numPts,const std::vector<int> &triVerts)
+{
+    if (built)
+        return;
+
+    triPts.reserve(triPts.size() + triVerts.size());
+    for (unsigned int ii=0;ii+2<triVerts.size();ii+=3)
+    {
+        int v0 = triVerts[ii], v1 = triVerts[ii+1], v2 = triVerts[ii+2];
+        if (v0 < 0 || v1 < 0 || v2 < 0 || v0 >= numPts || v1 >= numPts || v2 >= numPts)
+            continue;
+        triPts.push_back(pts[v0]);
+        triPts.push_back(pts[v1]);
+        triPts.push_back(pts[v2]);
+    }
+}
+
+int MeshBVH::buildNode(std::vector<int> &tris,const Point3dVector &centers,int start,int end)
+{
+    int nodeIdx = (int)nodes.size();
+    nodes.resize(nodes.size()+1);
+
+    BBox nodeBox,centerBox;
+    for (int ii=start;ii<end;ii++)
+    {
+        int tri = tris[ii];
+        for (unsigned int jj=0;jj<3;jj++)
+            nodeBox.addPoint(triPts[3*tri+jj]);
+        centerBox.addPoint(centers[tri]);
+    }
+    nodes[nodeIdx].ll = nodeBox.ll();
+    nodes[nodeIdx].ur = nodeBox.ur();
+
+    if (end - start <= MaxLeafTriangles)
+    {
+        nodes[nodeIdx].offset = start;
+        nodes[nodeIdx].count = end - start;
+        return nodeIdx;
+    }
+
+    // Split at the median along the longest side of the centers
+    Point3d extent = centerBox.ur() - centerBox.ll();
+    int axis = 0;
+    if (extent.y() > extent.x())
+        axis = 1;
+    if (extent.z() > extent(axis))
+        axis = 2;
+    int mid = (start + end) / 2;
+    std::nth_element(tris.begin()+start,tris.begin()+mid,tris.begin()+end,
+                     [&](int a,int b) { return centers[a](axis) < centers[b](axis); });
+
+    buildNode(tris,centers,start,mid);
+    int right = buildNode(tris,centers,mid,end);
+    // Index again, the children may have grown the vector
+    nodes[nodeIdx].offset = right;
+    nodes[nodeIdx].count = 0;
+
+    return nodeIdx;
+}
+
+void MeshBVH::build()
+{
+    if (built)
+        return;
+
+    int numTris = (int)triPts.size()/3;
+    if (numTris > 0)
+    {
+        Point3dVector centers(numTris);
+        std::vector<int> tris(numTris);
+        for (int ii=0;ii<numTris;ii++)
+        {
+            centers[ii] = (triPts[3*ii] + triPts[3*ii+1] + triPts[3*ii+2]) / 3.0;
+            tris[ii] = ii;
+        }
+
+        nodes.reserve(2*numTris/MaxLeafTriangles+1);
+        buildNode(tris,centers,0,numTris);
+
+        // Put the triangles in leaf order
+        Point3dVector sortedPts(triPts.size());
+        for (int ii=0;ii<numTris;ii++)
+            for (unsigned int jj=0;jj<3;jj++)
+                sortedPts[3*ii+jj] = triPts[3*tris[ii]+jj];
+        triPts.swap(sortedPts);
+        triIndices.swap(tris);
+
+        bounds.addPoint(nodes[0].ll);
+        bounds.addPoint(nodes[0].ur);
+    }
+
+    built = true;
+}
+
+// Slab test against a box.  Returns the entry distance.
+static bool RayBoxIntersect(const Point3d &org,const Point3d &invDir,const Point3d &ll,const Point3d &ur,double maxT,double &entryT)
+{
+    double tMin = 0.0, tMax = maxT;
+    for (unsigned int ii=0;ii<3;ii++)
+    {
+        double t0 = (ll(ii) - org(ii)) * invDir(ii);
+        double t1 = (ur(ii) - org(ii)) * invDir(ii);
+        if (t0 > t1)
+            std::swap(t0,t1);
+        tMin = std::max(tMin,t0);
+        tMax = std::min(tMax,t1);
+        if (tMin > tMax)
+            return false;
+    }
+    entryT = tMin;
+
+    return true;
+}
+
+bool MeshBVH::intersect(const Point3d &org,const Point3d &dir,double maxT,double &t,Point3d &norm,int &triIndex) const
+{
+    if (!built || nodes.empty())
+        return false;
+
+    Point3d invDir(1.0/dir.x(),1.0/dir.y(),1.0/dir.z());
+    double closeT = maxT;
+    int closeTri = -1;
+
+    int stack[64];
+    int stackSize = 0;
+    double entryT;
+    if (!RayBoxIntersect(org,invDir,nodes[0].ll,nodes[0].ur,closeT,entryT))
+        return false;
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        int nodeIdx = stack[--stackSize];
+        const Node &node = nodes[nodeIdx];
+        if (!RayBoxIntersect(org,invDir,node.ll,node.ur,closeT,entryT))
+            continue;
+
+        if (node.count > 0)
+        {
+            for (int ii=node.offset;ii<node.offset+node.count;ii++)
+            {
+                double thisT;
+                if (TriangleRayIntersection(org,dir,&triPts[3*ii],&thisT,NULL) && thisT < closeT)
+                {
+                    closeT = thisT;
+                    closeTri = ii;
+                }
+            }
+        } else {
+            // Visit the nearer child first
+            int left = nodeIdx + 1, right = node.offset;
+            double leftT,rightT;
+            bool hitLeft = RayBoxIntersect(org,invDir,nodes[left].ll,nodes[left].ur,closeT,leftT);
+            bool hitRight = RayBoxIntersect(org,invDir,nodes[right].ll,nodes[right].ur,closeT,rightT);
+            if (stackSize+2 > 64)
+                break;
+            if (hitLeft && hitRight)
+            {
+                if (leftT < rightT)
+                {
+                    stack[stackSize++] = right;
+                    stack[stackSize++] = left;
+                } else {
+                    stack[stackSize++] = left;
+                    stack[stackSize++] = right;
+                }
+            } else if (hitLeft)
+                stack[stackSize++] = left;
+            else if (hitRight)
+                stack[stackSize++] = right;
+        }
+    }
+
+    if (closeTri < 0)
+        return false;
+
+    t = closeT;
+    triIndex = triIndices[closeTri];
+    const Point3d *pts = &triPts[3*closeTri];
+    norm = (pts[1] - pts[0]).cross(pts[2] - pts[0]).normalized();
+    if (norm.dot(dir) > 0.0)
+        norm = -norm;
+
+    return true;
+}
+
+static void *MeshBVHBuilderThread(void *arg)
+{
+    ((MeshIntersectable *)arg)->runBuilder();
+    return NULL;
+}
+
+MeshIntersectable::MeshIntersectable()
+    : threadStarted(false), shutdown(false)
+{
+    pthread_mutex_init(&lock,NULL);
+    pthread_mutex_init(&queueLock,NULL);
+    pthread_cond_init(&queueCond,NULL);
+}
+
+MeshIntersectable::~MeshIntersectable()
+{
+    pthread_mutex_lock(&queueLock);
+    shutdown = true;
+    buildQueue.clear();
+    pthread_cond_signal(&queueCond);
+    pthread_mutex_unlock(&queueLock);
+    if (threadStarted)
+        pthread_join(builderThread,NULL);
+
+    pthread_cond_destroy(&queueCond);
+    pthread_mutex_destroy(&queueLock);
+    pthread_mutex_destroy(&lock);
+}
+
+void MeshIntersectable::buildBVH(MeshBVHRef bvh)
+{
+    if (!bvh || bvh->isBuilt())
+        return;
+
+    pthread_mutex_lock(&queueLock);
+    // Start the worker the first time we need it
+    if (!threadStarted)
+        threadStarted = pthread_create(&builderThread,NULL,&MeshBVHBuilderThread,this) == 0;
+    if (threadStarted)
+    {
+        buildQueue.push_back(bvh);
+        pthread_cond_signal(&queueCond);
+    }
+    pthread_mutex_unlock(&queueLock);
+
+    // Couldn't get a thread, so do it here
+    if (!threadStarted)
+        bvh->build();
+}
+
+void MeshIntersectable::runBuilder()
+{
+    while (true)
+    {
+        pthread_mutex_lock(&queueLock);
+        while (buildQueue.empty() && !shutdown)
+            pthread_cond_wait(&queueCond,&queueLock);
+        if (shutdown)
+        {
+            pthread_mutex_unlock(&queueLock);
+            return;
+        }
+        MeshBVHRef bvh = buildQueue.front();
+        buildQueue.pop_front();
+        pthread_mutex_unlock(&queueLock);
+
+        bvh->build();
+    }
+}
+
+void MeshIntersectable::addInstance(SimpleIdentity groupID,MeshBVHRef bvh,const Eigen::Matrix4d &mat,SimpleIdentity featureID,float minVis,float maxVis,bool enable)
+{
+    if (!bvh)
+        return;
+
+    MeshInstance inst;
+    inst.bvh = bvh;
+    inst.mat = mat;
+    inst.invMat = mat.inverse();
+    inst.featureID = featureID;
+    inst.minVis = minVis;
+    inst.maxVis = maxVis;
+    inst.enable = enable;
+
+    pthread_mutex_lock(&lock);
+    groups[groupID].push_back(inst);
+    pthread_mutex_unlock(&lock);
+}
+
+void MeshIntersectable::enableGroup(SimpleIdentity groupID,bool enable)
+{
+    pthread_mutex_lock(&lock);
+    auto it = groups.find(groupID);
+    if (it != groups.end())
+        for (MeshInstance &inst : it->second)
+            inst.enable = enable;
+    pthread_mutex_unlock(&lock);
+}
+
+void MeshIntersectable::removeGroup(SimpleIdentity groupID)
+{
+    pthread_mutex_lock(&lock);
+    groups.erase(groupID);
+    pthread_mutex_unlock(&lock);
+}
+
+bool MeshIntersectable::findClosestHit(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,IntersectionManager::IntersectionHit &hit)
+{
+    double height = theView->heightAboveSurface();
+    double closeT = std::numeric_limits<double>::max();
+    bool found = false;
+
+    pthread_mutex_lock(&lock);
+
+    for (auto &it : groups)
+        for (const MeshInstance &inst : it.second)
+        {
+            if (!inst.enable || !inst.bvh->isBuilt())
+                continue;
+            if (inst.minVis != DrawVisibleInvalid && (height < inst.minVis || height > inst.maxVis))
+                continue;
+
+            // Move the ray into the mesh's coordinates.  Leaving the direction unnormalized keeps t the same.
+            Vector4d org4 = inst.invMat * Vector4d(org.x(),org.y(),org.z(),1.0);
+            Vector4d dir4 = inst.invMat * Vector4d(dir.x(),dir.y(),dir.z(),0.0);
+            Point3d localOrg(org4.x()/org4.w(),org4.y()/org4.w(),org4.z()/org4.w());
+            Point3d localDir(dir4.x(),dir4.y(),dir4.z());
+
+            double t;
+            Point3d norm;
+            int triIndex;
+            if (inst.bvh->intersect(localOrg,localDir,closeT,t,norm,triIndex))
+            {
+                closeT = t;
+                found = true;
+                // Normals go back through the inverse transpose
+                Vector4d norm4 = inst.invMat.transpose() * Vector4d(norm.x(),norm.y(),norm.z(),0.0);
+                hit.norm = Point3d(norm4.x(),norm4.y(),norm4.z()).normalized();
+                hit.featureID = inst.featureID;
+            }
+        }
+
+    pthread_mutex_unlock(&lock);
+
+    if (!found)
+        return false;
+
+    hit.pt = org + dir * closeT;
+    hit.dist = closeT * dir.norm();
+
+    return true;
+}
+
+bool MeshIntersectable::findClosestIntersection(SceneRendererES *renderer,View *theView,const Point2f &frameSize,const Point2f &touchPt,const Point3d &org,const Point3d &dir,Point3d &iPt,double &dist)
+{
+    IntersectionManager::IntersectionHit hit;
+    if (!findClosestHit(renderer,theView,frameSize,touchPt,org,dir,hit))
+        return false;
+
+    iPt = hit.pt;
+    dist = hit.dist;
+
+    return true;
+}
+
+}
@@ -0,0 +1,373 @@
+/*
+ *  MotionManager.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import "MotionManager.h"
+#import "MarkerManager.h"
+#import "LabelManager.h"
+#import "FlatMath.h"
+
+using namespace Eigen;
+
+namespace WhirlyKit
+{
+
+// Wrap an angle into [0,2pi)
+static double MotionNormalizeAngle(double ang)
+{
+    ang = fmod(ang,2*M_PI);
+    if (ang < 0.0)
+        ang += 2*M_PI;
+    return ang;
+}
+
+// Move a location (longitude, latitude) by an offset in meters east and north
+static Point2d MotionOffsetLoc(const Point2d &loc,const Point2d &offset)
+{
+    double cosLat = std::max(cos(loc.y()),1e-6);
+    double lon = loc.x() + offset.x() / (EarthRadius * cosLat);
+    double lat = loc.y() + offset.y() / EarthRadius;
+    lat = std::min(std::max(lat,-M_PI/2.0),M_PI/2.0);
+    if (lon > M_PI)
+        lon -= 2*M_PI;
+    else if (lon < -M_PI)
+        lon += 2*M_PI;
+
+    return Point2d(lon,lat);
+}
+
+// Offset in meters east and north from one location to another
+static Point2d MotionLocDiff(const Point2d &from,const Point2d &to)
+{
+    double dLon = to.x() - from.x();
+    if (dLon > M_PI)
+        dLon -= 2*M_PI;
+    else if (dLon < -M_PI)
+        dLon += 2*M_PI;
+    double midLat = (from.y() + to.y())/2.0;
+
+    return Point2d(dLon * EarthRadius * cos(midLat),(to.y() - from.y()) * EarthRadius);
+}
+
+MotionObservation::MotionObservation()
+    : when(0.0), loc(0,0), accuracy(0.0), hasVelocity(false), heading(0.0), speed(0.0)
+{
+}
+
+MotionObservation::MotionObservation(const GeoCoord &loc,TimeInterval when)
+    : when(when), loc(loc), accuracy(0.0), hasVelocity(false), heading(0.0), speed(0.0)
+{
+}
+
+MotionSample::MotionSample()
+    : loc(0,0), heading(0.0), speed(0.0), extrapolated(false)
+{
+}
+
+double MotionSample::screenRotation() const
+{
+    // Screen space rotations run counter-clockwise
+    return MotionNormalizeAngle(-heading);
+}
+
+MotionParams::MotionParams()
+    : processNoise(1.0), defaultAccuracy(10.0), velocityAccuracy(1.0), initialVelocityAccuracy(30.0),
+    blendTime(2.0), snapDistance(1000.0), maxExtrapolate(60.0), minHeadingSpeed(0.5)
+{
+}
+
+MotionFilter::MotionFilter()
+    : valid(false), lastTime(0.0), loc(0,0), vel(0,0), cov(Matrix4d::Zero()), blendOffset(0,0), heading(0.0)
+{
+}
+
+bool MotionFilter::addObservation(const MotionObservation &obs,const MotionParams &params)
+{
+    double acc = obs.accuracy > 0.0 ? obs.accuracy : params.defaultAccuracy;
+    Point2d obsLoc(obs.loc.lon(),obs.loc.lat());
+    Point2d obsVel(0,0);
+    if (obs.hasVelocity)
+        obsVel = Point2d(obs.speed * sin(obs.heading),obs.speed * cos(obs.heading));
+
+    // First one just sets things up
+    if (!valid)
+    {
+        valid = true;
+        lastTime = obs.when;
+        loc = obsLoc;
+        vel = obsVel;
+        double velAcc = obs.hasVelocity ? params.velocityAccuracy : params.initialVelocityAccuracy;
+        cov = Matrix4d::Zero();
+        cov(0,0) = cov(1,1) = acc*acc;
+        cov(2,2) = cov(3,3) = velAcc*velAcc;
+        blendOffset = Point2d(0,0);
+        heading = obs.hasVelocity ? MotionNormalizeAngle(obs.heading) : 0.0;
+        return true;
+    }
+
+    if (obs.when < lastTime)
+        return false;
+
+    // What we were showing when the report came in
+    bool moving;
+    Point2d oldDispLoc = displayLoc(obs.when,params,moving);
+
+    // Predict forward to the report.  State is relative to the predicted location.
+    double dt = obs.when - lastTime;
+    Point2d predLoc = MotionOffsetLoc(loc,vel * dt);
+    Matrix4d trans = Matrix4d::Identity();
+    trans(0,2) = trans(1,3) = dt;
+    double q = params.processNoise * params.processNoise;
+    Matrix4d noise = Matrix4d::Zero();
+    noise(0,0) = noise(1,1) = q * dt*dt*dt/3.0;
+    noise(0,2) = noise(2,0) = noise(1,3) = noise(3,1) = q * dt*dt/2.0;
+    noise(2,2) = noise(3,3) = q * dt;
+    cov = trans * cov * trans.transpose() + noise;
+    Vector4d state(0,0,vel.x(),vel.y());
+
+    // Fold in the position
+    {
+        Point2d resid = MotionLocDiff(predLoc,obsLoc) - state.head<2>();
+        Matrix2d innov = cov.topLeftCorner<2,2>() + Matrix2d::Identity() * acc*acc;
+        Matrix<double,4,2> gain = cov.leftCols<2>() * innov.inverse();
+        state += gain * resid;
+        cov -= gain * cov.topRows<2>();
+    }
+
+    // And the velocity, if we have it
+    if (obs.hasVelocity)
+    {
+        Point2d resid = obsVel - state.tail<2>();
+        Matrix2d innov = cov.bottomRightCorner<2,2>() + Matrix2d::Identity() * params.velocityAccuracy*params.velocityAccuracy;
+        Matrix<double,4,2> gain = cov.rightCols<2>() * innov.inverse();
+        state += gain * resid;
+        cov -= gain * cov.bottomRows<2>();
+    }
+    cov = (cov + cov.transpose()) * 0.5;
+
+    lastTime = obs.when;
+    loc = MotionOffsetLoc(predLoc,state.head<2>());
+    vel = state.tail<2>();
+
+    // Blend from the old path, unless we're too far off
+    blendOffset = MotionLocDiff(loc,oldDispLoc);
+    if (params.blendTime <= 0.0 || blendOffset.norm() > params.snapDistance)
+        blendOffset = Point2d(0,0);
+
+    if (obs.hasVelocity && obs.speed >= params.minHeadingSpeed)
+        heading = MotionNormalizeAngle(obs.heading);
+    else if (vel.norm() >= params.minHeadingSpeed)
+        heading = MotionNormalizeAngle(atan2(vel.x(),vel.y()));
+
+    return true;
+}
+
+Point2d MotionFilter::estimateLoc(TimeInterval when,const MotionParams &params,bool &moving) const
+{
+    double dt = when - lastTime;
+    moving = std::abs(dt) < params.maxExtrapolate;
+    dt = std::min(std::max(dt,-params.maxExtrapolate),params.maxExtrapolate);
+
+    return MotionOffsetLoc(loc,vel * dt);
+}
+
+Point2d MotionFilter::displayLoc(TimeInterval when,const MotionParams &params,bool &moving) const
+{
+    Point2d estLoc = estimateLoc(when,params,moving);
+    if (blendOffset.x() == 0.0 && blendOffset.y() == 0.0)
+        return estLoc;
+
+    // Ease out of the old path
+    double t = params.blendTime > 0.0 ? (when - lastTime) / params.blendTime : 1.0;
+    t = std::min(std::max(t,0.0),1.0);
+    double weight = 1.0 - t*t*(3.0-2.0*t);
+    if (weight <= 0.0)
+        return estLoc;
+
+    return MotionOffsetLoc(estLoc,blendOffset * weight);
+}
+
+void MotionFilter::estimate(TimeInterval when,const MotionParams &params,GeoCoord &outLoc,Point2d &outVel) const
+{
+    bool moving;
+    Point2d estLoc = estimateLoc(when,params,moving);
+    outLoc = GeoCoord(estLoc.x(),estLoc.y());
+    outVel = moving ? vel : Point2d(0,0);
+}
+
+void MotionFilter::sample(TimeInterval when,const MotionParams &params,MotionSample &sample) const
+{
+    if (!valid)
+    {
+        sample = MotionSample();
+        return;
+    }
+
+    bool moving;
+    Point2d dispLoc = displayLoc(when,params,moving);
+    sample.loc = GeoCoord(dispLoc.x(),dispLoc.y());
+    sample.extrapolated = when > lastTime;
+    sample.speed = moving ? vel.norm() : 0.0;
+    if (sample.speed >= params.minHeadingSpeed)
+        sample.heading = MotionNormalizeAngle(atan2(vel.x(),vel.y()));
+    else
+        sample.heading = heading;
+}
+
+MotionSegment::MotionSegment()
+    : startLoc(0,0), endLoc(0,0), startTime(0.0), endTime(0.0), rotation(0.0)
+{
+}
+
+void MotionSegment::applyToMarker(Marker &marker) const
+{
+    marker.loc = startLoc;
+    marker.hasMotion = true;
+    marker.endLoc = endLoc;
+    marker.startTime = startTime;
+    marker.endTime = endTime;
+    marker.lockRotation = true;
+    marker.rotation = rotation;
+}
+
+void MotionSegment::applyToLabel(SingleLabel &label) const
+{
+    label.loc = startLoc;
+    label.hasMotion = true;
+    label.endLoc = endLoc;
+    label.startTime = startTime;
+    label.endTime = endTime;
+    label.rotation = rotation;
+}
+
+MotionManager::MotionManager()
+{
+    pthread_mutex_init(&motionLock, NULL);
+}
+
+MotionManager::~MotionManager()
+{
+    pthread_mutex_destroy(&motionLock);
+}
+
+void MotionManager::setParams(const MotionParams &newParams)
+{
+    pthread_mutex_lock(&motionLock);
+    params = newParams;
+    pthread_mutex_unlock(&motionLock);
+}
+
+MotionParams MotionManager::getParams()
+{
+    pthread_mutex_lock(&motionLock);
+    MotionParams theParams = params;
+    pthread_mutex_unlock(&motionLock);
+
+    return theParams;
+}
+
+bool MotionManager::addObservation(SimpleIdentity objID,const MotionObservation &obs)
+{
+    pthread_mutex_lock(&motionLock);
+    bool ret = filters[objID].addObservation(obs,params);
+    pthread_mutex_unlock(&motionLock);
+
+    return ret;
+}
+
+void MotionManager::removeObjects(const SimpleIDSet &objIDs)
+{
+    pthread_mutex_lock(&motionLock);
+    for (SimpleIdentity objID : objIDs)
+        filters.erase(objID);
+    pthread_mutex_unlock(&motionLock);
+}
+
+int MotionManager::numObjects()
+{
+    pthread_mutex_lock(&motionLock);
+    int num = (int)filters.size();
+    pthread_mutex_unlock(&motionLock);
+
+    return num;
+}
+
+bool MotionManager::sample(SimpleIdentity objID,TimeInterval when,MotionSample &sample)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&motionLock);
+    auto it = filters.find(objID);
+    if (it != filters.end() && it->second.isValid())
+    {
+        it->second.sample(when,params,sample);
+        found = true;
+    }
+    pthread_mutex_unlock(&motionLock);
+
+    return found;
+}
+
+void MotionManager::sampleAll(TimeInterval when,std::vector<SimpleIdentity> &objIDs,std::vector<MotionSample> &samples)
+{
+    pthread_mutex_lock(&motionLock);
+    objIDs.clear();
+    samples.clear();
+    objIDs.reserve(filters.size());
+    samples.resize(filters.size());
+    for (auto &it : filters)
+    {
+        if (!it.second.isValid())
+            continue;
+        it.second.sample(when,params,samples[objIDs.size()]);
+        objIDs.push_back(it.first);
+    }
+    samples.resize(objIDs.size());
+    pthread_mutex_unlock(&motionLock);
+}
+
+bool MotionManager::calcSegment(SimpleIdentity objID,TimeInterval startTime,TimeInterval duration,MotionSegment &segment)
+{
+    MotionSample startSample,endSample;
+    bool found = false;
+
+    pthread_mutex_lock(&motionLock);
+    auto it = filters.find(objID);
+    if (it != filters.end() && it->second.isValid())
+    {
+        it->second.sample(startTime,params,startSample);
+        it->second.sample(startTime+duration,params,endSample);
+        found = true;
+    }
+    pthread_mutex_unlock(&motionLock);
+
+    if (!found)
+        return false;
+
+    segment.startLoc = startSample.loc;
+    segment.endLoc = endSample.loc;
+    segment.startTime = startTime;
+    segment.endTime = startTime+duration;
+    segment.rotation = startSample.screenRotation();
+
+    return true;
+}
+
+}
@@ -281,6 +281,17 @@ bool compileShader(const std::string &name,const char *shaderTypeStr,GLuint *sha
 // Construct the program, compile and link
 OpenGLES2Program::OpenGLES2Program(const std::string &inName,const std::string &vShaderString,const std::string &fShaderString)
     : name(inName), lightsLastUpdated(0.0)
+{
+    init(vShaderString,fShaderString,NULL);
+}
+
+OpenGLES2Program::OpenGLES2Program(const std::string &inName,const std::string &vShaderString,const std::string &fShaderString,const std::map<std::string,int> &attrLocations)
+    : name(inName), lightsLastUpdated(0.0)
+{
+    init(vShaderString,fShaderString,&attrLocations);
+}
+
+void OpenGLES2Program::init(const std::string &vShaderString,const std::string &fShaderString,const std::map<std::string,int> *attrLocations)
 {
     program = glCreateProgram();
     
@@ -297,6 +308,11 @@ OpenGLES2Program::OpenGLES2Program(const std::string &inName,const std::string &
 
     glAttachShader(program, vertShader);
     glAttachShader(program, fragShader);
+
+    // Has to happen before the link to take effect
+    if (attrLocations)
+        for (auto it : *attrLocations)
+            glBindAttribLocation(program, it.second, it.first.c_str());
     
     // Now link it
     GLint status;
@@ -358,6 +374,14 @@ OpenGLES2Program::OpenGLES2Program(const std::string &inName,const std::string &
         attrs.insert(attr);
     }
     
+    // Animated values are neutral until something animates the drawable
+    if (findUniform("u_tint") || findUniform("u_animXform"))
+    {
+        glUseProgram(program);
+        setUniform("u_tint", Eigen::Vector4f(1.0,1.0,1.0,1.0));
+        setUniform("u_animXform", Eigen::Vector4f(1.0,0.0,0.0,1.0));
+    }
+    
 //    WHIRLYKIT_LOGE("Successfully created shader %s",name.c_str());
 }
     
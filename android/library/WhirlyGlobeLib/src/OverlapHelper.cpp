@@ -21,6 +21,7 @@
 #import "OverlapHelper.h"
 #import "WhirlyGeometry.h"
 #import "VectorData.h"
+#import "LayoutManager.h"
 
 
 using namespace Eigen;
@@ -196,6 +197,7 @@ void ClusterHelper::addObject(LayoutObjectEntry *objEntry,const Point2dVector pt
 
                 // Hit a cluster, so merge this new object in
                 clusterObj->children.push_back(newID);
+                addToStats(*clusterObj,newObj);
                 clusterObj->center = (clusterObj->center * (clusterObj->children.size() - 1) + newObj.center)/clusterObj->children.size();
                 clusterObj->pts.clear();
                 clusterID = -(which+1);
@@ -210,6 +212,9 @@ void ClusterHelper::addObject(LayoutObjectEntry *objEntry,const Point2dVector pt
                 clusterObj = &clusterObjects[clusterID];
                 clusterObj->children.push_back(which);
                 clusterObj->children.push_back(newID);
+                clusterObj->stats = ClusterStats(&statDefs);
+                addToStats(*clusterObj,*simpleObj);
+                addToStats(*clusterObj,newObj);
                 clusterObj->center = (newObj.center + testObj->center)/2.0;
 
                 simpleObj->parentObject = clusterID;
@@ -257,6 +262,7 @@ void ClusterHelper::resolveClusters()
                     {
                         simpleObj->parentObject = -(which + 1);
                         clusterObj->children.push_back(so);
+                        addToStats(*clusterObj,*simpleObj);
                         break;
                     }
                 }
@@ -283,6 +289,8 @@ void ClusterHelper::resolveClusters()
                     {
                         clusterObj->children.insert(clusterObj->children.begin(),otherClusterObj->children.begin(), otherClusterObj->children.end());
                         otherClusterObj->children.clear();
+                        clusterObj->stats.merge(otherClusterObj->stats);
+                        otherClusterObj->stats = ClusterStats(&statDefs);
                     }
                 }
             }
@@ -290,6 +298,11 @@ void ClusterHelper::resolveClusters()
     }
 }
 
+void ClusterHelper::addToStats(ClusterObject &cluster,const SimpleObject &obj)
+{
+    cluster.stats.addMember(obj.objEntry->obj.attrs.get(),obj.objEntry->obj.importance);
+}
+
 void ClusterHelper::objectsForCluster(ClusterObject &cluster,std::vector<LayoutObjectEntry *> &layoutObjs)
 {
     for (int child : cluster.children)
@@ -70,6 +70,8 @@ ParticleSystemManager::~ParticleSystemManager()
     
 SimpleIdentity ParticleSystemManager::addParticleSystem(const ParticleSystem &newSystem,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag("");
   ParticleSystemSceneRep *sceneRep = new ParticleSystemSceneRep(newSystem.getId());
 
     sceneRep->partSys = newSystem;
@@ -99,6 +101,8 @@ SimpleIdentity ParticleSystemManager::addParticleSystem(const ParticleSystem &ne
     pthread_mutex_lock(&partSysLock);
     sceneReps.insert(sceneRep);
     pthread_mutex_unlock(&partSysLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
     
     return partSysID;
 }
@@ -124,6 +128,7 @@ void ParticleSystemManager::removeParticleSystem(SimpleIdentity sysID,ChangeSet
     if (it != sceneReps.end())
     {
         (*it)->clearContents(changes);
+        untrackSceneRep((*it)->getId());
         sceneReps.erase(it);
     }
     
@@ -91,7 +91,11 @@ void QuadDisplayController::init(Scene *inScene,SceneRendererES *inRenderer)
     scene = inScene;
     renderer = inRenderer;
 
-    quadtree = new Quadtree(dataStructure->getTotalExtents(),minZoom,maxZoom,maxTiles,minImportance,this);
+    TileMatrixSetRef tileMatrixSet = dataStructure->getTileMatrixSet();
+    if (tileMatrixSet)
+        quadtree = new Quadtree(tileMatrixSet,minZoom,maxZoom,maxTiles,minImportance,this);
+    else
+        quadtree = new Quadtree(dataStructure->getTotalExtents(),minZoom,maxZoom,maxTiles,minImportance,this);
     loader->init(this,scene);
 
     canLoadFrames = loader->canLoadFrames();
@@ -256,9 +260,10 @@ void QuadDisplayController::resetEvaluation()
     
     std::vector<Quadtree::Identifier> newlyCoveredTiles;
     // Add everything at the minLevel back in
-    for (int ix=0;ix<1<<minZoom;ix++)
-        for (int iy=0;iy<1<<minZoom;iy++)
-            quadtree->addTile(Quadtree::Identifier(ix,iy,minZoom),true,false,newlyCoveredTiles);
+    std::vector<Quadtree::Identifier> topTiles;
+    quadtree->topLevelNodes(topTiles);
+    for (const Quadtree::Identifier &topTile : topTiles)
+        quadtree->addTile(topTile,true,false,newlyCoveredTiles);
 }
 
 // Dump out info about what we've got loaded in
@@ -756,9 +761,9 @@ void QuadDisplayController::tileDidNotLoad(const Quadtree::Identifier &tileIdent
     quadtree->setFailed(tileIdent, true);
     
     // Let's try to load the parent if we're in target level mode
-    if (!targetLevels.empty() && tileIdent.level > 0)
+    Quadtree::Identifier parentIdent;
+    if (!targetLevels.empty() && tileIdent.level > 0 && quadtree->getTileMatrixSet()->parentForTile(tileIdent,parentIdent))
     {
-        Quadtree::Identifier parentIdent(tileIdent.x/2,tileIdent.y/2,tileIdent.level-1);
         std::vector<Quadtree::Identifier> tilesCovered;
         quadtree->addTile(parentIdent, true, true, tilesCovered);
         
@@ -800,9 +805,10 @@ void QuadDisplayController::refresh(ChangeSet &changes)
     
     // Add everything at the minLevel back in
     std::vector<Quadtree::Identifier> newlyCoveredTiles;
-    for (int ix=0;ix<1<<minZoom;ix++)
-        for (int iy=0;iy<1<<minZoom;iy++)
-            quadtree->addTile(Quadtree::Identifier(ix,iy,minZoom), true, false, newlyCoveredTiles);
+    std::vector<Quadtree::Identifier> topTiles;
+    quadtree->topLevelNodes(topTiles);
+    for (const Quadtree::Identifier &topTile : topTiles)
+        quadtree->addTile(topTile, true, false, newlyCoveredTiles);
     
     loader->startUpdates(changes);
 
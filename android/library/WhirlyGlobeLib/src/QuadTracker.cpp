@@ -169,6 +169,12 @@ void QuadTracker::tiles(WhirlyKit::QuadTrackerPointReturn *trackInfo, int numPts
             
             trackInfo->setCoordLoc(ii, coordPt.x(), coordPt.y());
             
+            if (tileMatrixSet)
+            {
+                findTile(trackInfo, ii, Point2d(coordPt.x(),coordPt.y()));
+                continue;
+            }
+
             //Clip to the overal bounds
             double tileU = (coordPt.x()-ll.x())/mbrSpanX;
             double tileV = (coordPt.y()-ll.y())/mbrSpanY;
@@ -226,6 +232,38 @@ void QuadTracker::tiles(WhirlyKit::QuadTrackerPointReturn *trackInfo, int numPts
     pthread_mutex_unlock(&tilesLock);
 }
 
+void QuadTracker::findTile(QuadTrackerPointReturn *trackInfo,int which,const Point2d &coordPt)
+{
+    // Levels don't nest neatly, so look each one up from scratch
+    bool foundTile = false;
+    Quadtree::Identifier tileID;
+    for (int level=minLevel;level<tileMatrixSet->getNumLevels();level++)
+    {
+        Quadtree::Identifier testTile;
+        if (!tileMatrixSet->tileForPoint(level, coordPt, testTile) ||
+            tileSet.find(TileWrapper(testTile)) == tileSet.end())
+            break;
+        tileID = testTile;
+        foundTile = true;
+    }
+    
+    if (foundTile)
+    {
+        Point2d tileLL,tileUR;
+        tileMatrixSet->calcTileMbr(tileID, tileLL, tileUR);
+        trackInfo->setTileID(which,tileID.x,tileID.y,tileID.level);
+        trackInfo->setTileLoc(which,(coordPt.x()-tileLL.x())/(tileUR.x()-tileLL.x()),(coordPt.y()-tileLL.y())/(tileUR.y()-tileLL.y()));
+    } else
+        trackInfo->setTileID(which,0,0,-1);
+}
+
+void QuadTracker::setTileMatrixSet(TileMatrixSetRef newTileMatrixSet)
+{
+    pthread_mutex_lock(&tilesLock);
+    tileMatrixSet = newTileMatrixSet;
+    pthread_mutex_unlock(&tilesLock);
+}
+
 void QuadTracker::setCoordSys(WhirlyKit::CoordSystem *_coordSys, Point2d _ll, Point2d _ur)
 {
     coordSys = _coordSys;
@@ -18,8 +18,10 @@
  *
  */
 
+#import <algorithm>
 #import "glwrapper.h"
 #import "Quadtree.h"
+#import "TileMatrixSet.h"
 #import "WhirlyKitLog.h"
 
 namespace WhirlyKit
@@ -83,13 +85,10 @@ void Quadtree::NodeInfo::setFrameLoading(int theFrame,bool val)
 Quadtree::Node::Node(Quadtree *tree)
 {
     parent = NULL;
-    for (unsigned int ii=0;ii<4;ii++)
-    {
-        children[ii] = NULL;
-        childOffscreen[ii] = false;
-    }
     identPos = tree->nodesByIdent.end();
     sizePos = tree->nodesBySize.end();
+    for (unsigned int ii=0;ii<4;ii++)
+        quadChildOffscreen[ii] = false;
 }
     
 void Quadtree::Node::addChild(Quadtree *tree,Node *child)
@@ -100,30 +99,22 @@ void Quadtree::Node::addChild(Quadtree *tree,Node *child)
         tree->nodesBySize.erase(it);
     sizePos = tree->nodesBySize.end();
 
-    int ix = child->nodeInfo.ident.x - nodeInfo.ident.x*2;
-    int iy = child->nodeInfo.ident.y - nodeInfo.ident.y*2;
-    children[iy*2+ix] = child;
+    if (std::find(children.begin(),children.end(),child) == children.end())
+        children.push_back(child);
 }
     
 void Quadtree::Node::removeChild(Quadtree *tree, Node *child)
 {
-    bool hasChildren = false;
-    for (unsigned int ii=0;ii<4;ii++)
-    {
-        if (children[ii] == child)
-            children[ii] = NULL;
-        hasChildren |= (children[ii] != NULL);
-    }
-    if (!hasChildren)
+    std::vector<Node *>::iterator it = std::find(children.begin(),children.end(),child);
+    if (it != children.end())
+        children.erase(it);
+    if (children.empty())
         sizePos = tree->nodesBySize.insert(this).first;
 }
     
 bool Quadtree::Node::hasChildren()
 {
-    for (unsigned int ii=0;ii<4;ii++)
-        if (children[ii])
-            return true;
-    return false;
+    return !children.empty();
 }
     
 bool Quadtree::Node::hasNonPhantomParent()
@@ -159,9 +150,8 @@ void Quadtree::Node::Print()
     __android_log_print(ANDROID_LOG_VERBOSE, "Maply","Node (%d,%d,%d)",nodeInfo.ident.x,nodeInfo.ident.y,nodeInfo.ident.level);
     if (parent)
         __android_log_print(ANDROID_LOG_VERBOSE, "Maply"," Parent = (%d,%d,%d)",parent->nodeInfo.ident.x,parent->nodeInfo.ident.y,parent->nodeInfo.ident.level);
-    for (unsigned int ii=0;ii<4;ii++)
-        if (children[ii])
-            __android_log_print(ANDROID_LOG_VERBOSE, "Maply","  Child = (%d,%d,%d)",children[ii]->nodeInfo.ident.x,children[ii]->nodeInfo.ident.y,children[ii]->nodeInfo.ident.level);
+    for (unsigned int ii=0;ii<children.size();ii++)
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply","  Child = (%d,%d,%d)",children[ii]->nodeInfo.ident.x,children[ii]->nodeInfo.ident.y,children[ii]->nodeInfo.ident.level);
 #else
 //    NSLog(@"Node (%d,%d,%d)",nodeInfo.ident.x,nodeInfo.ident.y,nodeInfo.ident.level);
 //    if (parent)
@@ -173,9 +163,19 @@ void Quadtree::Node::Print()
 }
 
 Quadtree::Quadtree(Mbr mbr,int minLevel,int maxLevel,int maxNodes,float minImportance,QuadTreeImportanceCalculator *importDelegate)
-    : mbr(mbr), minLevel(minLevel), maxLevel(maxLevel), maxNodes(maxNodes), minImportance(minImportance), numPhantomNodes(0)
+    : mbr(mbr), minLevel(minLevel), maxLevel(maxLevel), maxNodes(maxNodes), minImportance(minImportance), numPhantomNodes(0), knownNumNodes(0)
+{
+    this->importDelegate = importDelegate;
+    tileMatrixSet = TileMatrixSet::MakeQuadTree(mbr,maxLevel+1);
+}
+
+Quadtree::Quadtree(TileMatrixSetRef tileMatrixSet,int minLevel,int maxLevel,int maxNodes,float minImportance,QuadTreeImportanceCalculator *importDelegate)
+    : tileMatrixSet(tileMatrixSet), minLevel(minLevel), maxLevel(maxLevel), maxNodes(maxNodes), minImportance(minImportance), numPhantomNodes(0), knownNumNodes(0)
 {
     this->importDelegate = importDelegate;
+    mbr = tileMatrixSet->getTotalExtents();
+    // Can't go deeper than the tile matrix set does
+    this->maxLevel = std::min(maxLevel,tileMatrixSet->getNumLevels()-1);
 }
     
 Quadtree::~Quadtree()
@@ -218,7 +218,8 @@ bool Quadtree::shouldLoadTile(const Identifier &ident,int frame)
     // It must have a parent loaded in, if it's not at the top
     if (node->nodeInfo.ident.level > minLevel)
     {
-        if (!getNode(Identifier(node->nodeInfo.ident.x / 2, node->nodeInfo.ident.y / 2, node->nodeInfo.ident.level - 1)))
+        Identifier parentIdent;
+        if (!parentForNode(node->nodeInfo.ident, parentIdent) || !getNode(parentIdent))
             return false;
     }    
     
@@ -250,16 +251,47 @@ bool Quadtree::isPhantom(const Identifier &ident)
 }
     
     
-bool Quadtree::Node::recalcCoverage()
+bool Quadtree::Node::recalcCoverage(Quadtree *tree)
 {
-    bool newChildCoverage = true;
-    for (unsigned int ii=0;ii<4;ii++)
+    // Regular quad trees only need to look at our own four children, which we already have
+    if (tree->tileMatrixSet->isQuadTree())
+    {
+        Node *quadChildren[4] = {NULL,NULL,NULL,NULL};
+        for (Node *child : children)
+        {
+            int ix = child->nodeInfo.ident.x - nodeInfo.ident.x*2;
+            int iy = child->nodeInfo.ident.y - nodeInfo.ident.y*2;
+            if (ix >= 0 && ix < 2 && iy >= 0 && iy < 2)
+                quadChildren[iy*2+ix] = child;
+        }
+        
+        bool newChildCoverage = true;
+        for (unsigned int ii=0;ii<4;ii++)
+        {
+            Node *child = quadChildren[ii];
+            if (child)
+                newChildCoverage &= child->nodeInfo.childCoverage || (!child->nodeInfo.phantom && !child->nodeInfo.isFrameLoading(-1));
+            else
+                if (!quadChildOffscreen[ii])
+                    newChildCoverage = false;
+        }
+        nodeInfo.childCoverage = newChildCoverage;
+        
+        return newChildCoverage;
+    }
+
+    // Everything overlapping us at the next level counts, not just our own children
+    std::vector<Identifier> coverIdents;
+    tree->tileMatrixSet->overlappingChildren(nodeInfo.ident, coverIdents);
+
+    bool newChildCoverage = !coverIdents.empty();
+    for (unsigned int ii=0;ii<coverIdents.size();ii++)
     {
-        Node *child = children[ii];
+        Node *child = tree->getNode(coverIdents[ii]);
         if (child)
             newChildCoverage &= child->nodeInfo.childCoverage || (!child->nodeInfo.phantom && !child->nodeInfo.isFrameLoading(-1));
         else
-            if (!childOffscreen[ii])
+            if (childOffscreen.find(coverIdents[ii]) == childOffscreen.end())
                newChildCoverage = false;
     }
     nodeInfo.childCoverage = newChildCoverage;
@@ -323,42 +355,94 @@ void Quadtree::resetKnownNodes()
     
 void Quadtree::updateParentCoverage(const Identifier &ident,std::vector<Identifier> &coveredTiles,std::vector<Identifier> &unCoveredTiles)
 {
-    Node *p = getNode(Identifier(ident.x/2, ident.y/2, ident.level-1));
-    while (p)
+    // Work upward a level at a time through everything this tile overlaps
+    std::set<Identifier> idents;
+    idents.insert(ident);
+    while (!idents.empty())
     {
-        bool pOldChildCoverage = p->nodeInfo.childCoverage;
-        bool pNewChildCoverage = p->recalcCoverage();
-        if (pOldChildCoverage != pNewChildCoverage)
+        std::vector<Identifier> parentIdents;
+        for (const Identifier &childIdent : idents)
+            tileMatrixSet->overlappingParents(childIdent, parentIdents);
+        idents.clear();
+
+        for (const Identifier &parentIdent : parentIdents)
         {
-            if (pNewChildCoverage)
+            Node *p = getNode(parentIdent);
+            if (!p || idents.find(parentIdent) != idents.end())
+                continue;
+            idents.insert(parentIdent);
+
+            bool pOldChildCoverage = p->nodeInfo.childCoverage;
+            bool pNewChildCoverage = p->recalcCoverage(this);
+            if (pOldChildCoverage != pNewChildCoverage)
             {
-//                NSLog(@"Tile recently covered: %d: (%d,%d)",p->nodeInfo.ident.level,p->nodeInfo.ident.x,p->nodeInfo.ident.y);
-                coveredTiles.push_back(p->nodeInfo.ident);
-            } else
-                unCoveredTiles.push_back(p->nodeInfo.ident);
+                if (pNewChildCoverage)
+                {
+//                    NSLog(@"Tile recently covered: %d: (%d,%d)",p->nodeInfo.ident.level,p->nodeInfo.ident.x,p->nodeInfo.ident.y);
+                    coveredTiles.push_back(p->nodeInfo.ident);
+                } else
+                    unCoveredTiles.push_back(p->nodeInfo.ident);
+            }
         }
-        
-        p = p->parent;
     }
 }
     
 void Quadtree::recalcCoverage(Node *node)
 {
     bool oldChildCoverage = node->nodeInfo.childCoverage;
-    bool newChildCoverage = node->recalcCoverage();
+    bool newChildCoverage = node->recalcCoverage(this);
     
-    // Need to propagate the changes upward
+    // Need to propagate the changes upward, but only as far as they make a difference
     if (oldChildCoverage != newChildCoverage)
     {
-        Node *p = node->parent;
-        while (p)
+        std::set<Identifier> idents;
+        idents.insert(node->nodeInfo.ident);
+        while (!idents.empty())
         {
-            bool pOldChildCoverage = p->nodeInfo.childCoverage;
-            bool pNewChildCoverage = p->recalcCoverage();
-            if (pOldChildCoverage == pNewChildCoverage)
-                break;
-            
-            p = p->parent;
+            std::vector<Identifier> parentIdents;
+            for (const Identifier &childIdent : idents)
+                tileMatrixSet->overlappingParents(childIdent, parentIdents);
+            idents.clear();
+
+            for (const Identifier &parentIdent : parentIdents)
+            {
+                Node *p = getNode(parentIdent);
+                if (!p || idents.find(parentIdent) != idents.end())
+                    continue;
+                bool pOldChildCoverage = p->nodeInfo.childCoverage;
+                bool pNewChildCoverage = p->recalcCoverage(this);
+                if (pOldChildCoverage != pNewChildCoverage)
+                    idents.insert(parentIdent);
+            }
+        }
+    }
+}
+    
+void Quadtree::setChildOffscreen(const Identifier &ident)
+{
+    if (tileMatrixSet->isQuadTree())
+    {
+        if (ident.level <= minLevel)
+            return;
+        Node *parent = getNode(Identifier(ident.x / 2, ident.y / 2, ident.level - 1));
+        if (parent)
+        {
+            int ix = ident.x-parent->nodeInfo.ident.x*2;
+            int iy = ident.y-parent->nodeInfo.ident.y*2;
+            parent->quadChildOffscreen[iy*2+ix] = true;
+        }
+        return;
+    }
+    
+    std::vector<Identifier> parentIdents;
+    tileMatrixSet->overlappingParents(ident, parentIdents);
+    for (const Identifier &parentIdent : parentIdents)
+    {
+        Node *parent = getNode(parentIdent);
+        if (parent)
+        {
+            parent->childOffscreen.insert(ident);
+//            NSLog(@"Child offscreen for: %d: (%d,%d)",parent->nodeInfo.ident.level,parent->nodeInfo.ident.x,parent->nodeInfo.ident.y);
         }
     }
 }
@@ -544,13 +628,14 @@ void Quadtree::setFailed(const Identifier &ident,bool newFail)
 
 bool Quadtree::childFailed(const Identifier &ident)
 {
-    for (unsigned int ix=0;ix<2;ix++)
-        for (unsigned int iy=0;iy<2;iy++)
-        {
-            Node *child = getNode(Identifier(ident.x*2+ix,ident.y*2+iy,ident.level+1));
-            if (child && child->nodeInfo.failed)
-                return true;
-        }
+    std::vector<Identifier> childIdents;
+    tileMatrixSet->childrenForTile(ident, childIdents);
+    for (const Identifier &childIdent : childIdents)
+    {
+        Node *child = getNode(childIdent);
+        if (child && child->nodeInfo.failed)
+            return true;
+    }
     
     return false;
 }
@@ -648,21 +733,12 @@ void Quadtree::reevaluateNodes()
     {
         Node *node = *it;
         for (unsigned int ii=0;ii<4;ii++)
-            node->childOffscreen[ii] = false;
+            node->quadChildOffscreen[ii] = false;
+        node->childOffscreen.clear();
         node->nodeInfo.importance = importDelegate->importanceForTile(node->nodeInfo.ident, node->nodeInfo.mbr, this, &node->nodeInfo.attrs);
-        // Let the parent know this node is offscreen
+        // Let the parents know this node is offscreen
         if (node->nodeInfo.importance == 0)
-        {
-            Node *parent = getNode(Identifier(node->nodeInfo.ident.x / 2, node->nodeInfo.ident.y / 2, node->nodeInfo.ident.level - 1));
-
-            if (parent)
-            {
-                int ix = node->nodeInfo.ident.x-parent->nodeInfo.ident.x*2;
-                int iy = node->nodeInfo.ident.y-parent->nodeInfo.ident.y*2;
-                parent->childOffscreen[iy*2+ix] = true;
-//                NSLog(@"Reevaluating Child offscreen for: %d: (%d,%d)",parent->nodeInfo.ident.level,parent->nodeInfo.ident.x,parent->nodeInfo.ident.y);
-            }
-        }
+            setChildOffscreen(node->nodeInfo.ident);
         if (!node->hasChildren())
             node->sizePos = nodesBySize.insert(node).first;
         node->evalPos = evalNodes.insert(node).first;
@@ -671,7 +747,7 @@ void Quadtree::reevaluateNodes()
     // Recalculate the coverage for children
     NodesByIdentType::iterator it = std::prev(nodesByIdent.end());
     do {
-        (*it)->recalcCoverage();
+        (*it)->recalcCoverage(this);
         if (it != nodesByIdent.begin())
             it = std::prev(it);
     } while (it != nodesByIdent.begin());
@@ -688,9 +764,10 @@ const Quadtree::NodeInfo *Quadtree::addTile(const Identifier &ident,bool newEval
     {
         // Look for the parent
         Node *parent = NULL;
-        if (ident.level > minLevel)
+        Identifier parentIdent;
+        if (ident.level > minLevel && parentForNode(ident, parentIdent))
         {
-            parent = getNode(Identifier(ident.x / 2, ident.y / 2, ident.level - 1));
+            parent = getNode(parentIdent);
             // Note: Should check for a missing parent.  Shouldn't happen.
         }
         
@@ -701,10 +778,7 @@ const Quadtree::NodeInfo *Quadtree::addTile(const Identifier &ident,bool newEval
         {
             if (parent && nodeInfo.importance == 0.0)
             {
-                int ix = nodeInfo.ident.x-parent->nodeInfo.ident.x*2;
-                int iy = nodeInfo.ident.y-parent->nodeInfo.ident.y*2;
-                parent->childOffscreen[iy*2+ix] = true;
-//                NSLog(@"Child offscreen for: %d: (%d,%d)",parent->nodeInfo.ident.level,parent->nodeInfo.ident.x,parent->nodeInfo.ident.y);
+                setChildOffscreen(ident);
                 std::vector<Identifier> unCoveredTiles;
                 updateParentCoverage(ident,newlyCoveredTiles,unCoveredTiles);
             }
@@ -815,25 +889,12 @@ Quadtree::NodeInfo Quadtree::generateNode(const Identifier &ident)
     
 Mbr Quadtree::generateMbrForNode(const Identifier &ident)
 {
-    Point2f chunkSize(mbr.ur()-mbr.ll());
-    chunkSize.x() /= (1<<ident.level);
-    chunkSize.y() /= (1<<ident.level);
-    
-    Mbr outMbr;
-    outMbr.ll() = Point2f(chunkSize.x()*ident.x,chunkSize.y()*ident.y) + mbr.ll();
-    outMbr.ur() = Point2f(chunkSize.x()*(ident.x+1),chunkSize.y()*(ident.y+1)) + mbr.ll();    
-    
-    return outMbr;
+    return tileMatrixSet->calcTileMbr(ident);
 }
     
 void Quadtree::generateMbrForNode(const Identifier &ident,Point2d &ll,Point2d &ur)
 {
-    Point2d chunkSize(mbr.ur().x()-mbr.ll().x(),mbr.ur().y()-mbr.ll().y());
-    chunkSize.x() /= (1<<ident.level);
-    chunkSize.y() /= (1<<ident.level);
-    
-    ll = Point2d(chunkSize.x()*ident.x,chunkSize.y()*ident.y) + Point2d(mbr.ll().x(),mbr.ll().y());
-    ur = Point2d(chunkSize.x()*(ident.x+1),chunkSize.y()*(ident.y+1)) + Point2d(mbr.ll().x(),mbr.ll().y());
+    tileMatrixSet->calcTileMbr(ident,ll,ur);
 }
     
 bool Quadtree::leastImportantNode(NodeInfo &nodeInfo,bool force)
@@ -846,11 +907,7 @@ bool Quadtree::leastImportantNode(NodeInfo &nodeInfo,bool force)
         if (force || node->nodeInfo.importance == 0.0 || ((node->nodeInfo.importance < minImportance && node->nodeInfo.ident.level > minLevel) &&
                                  !node->parentLoading() && node->nodeInfo.childrenLoading == 0 && node->hasNonPhantomParent()))
         {
-            unsigned int ii;
-            for (ii=0;ii<4;ii++)
-                if (node->children[ii])
-                    break;
-            if (ii == 4 && node->nodeInfo.childrenLoading == 0 && node->nodeInfo.childrenEval == 0 && !node->parentLoading())
+            if (node->children.empty() && node->nodeInfo.childrenLoading == 0 && node->nodeInfo.childrenEval == 0 && !node->parentLoading())
             {
                 nodeInfo = node->nodeInfo;
                 return true;
@@ -862,10 +919,21 @@ bool Quadtree::leastImportantNode(NodeInfo &nodeInfo,bool force)
 }
     
 void Quadtree::childrenForNode(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &childIdents)
-        {
-    for (unsigned int ix=0;ix<2;ix++)
-        for (unsigned int iy=0;iy<2;iy++)
-            childIdents.push_back(Identifier(2*ident.x+ix,2*ident.y+iy,ident.level+1));
+{
+    tileMatrixSet->childrenForTile(ident, childIdents);
+}
+    
+bool Quadtree::parentForNode(const Identifier &ident,Identifier &parentIdent)
+{
+    if (ident.level <= minLevel)
+        return false;
+    
+    return tileMatrixSet->parentForTile(ident, parentIdent);
+}
+    
+void Quadtree::topLevelNodes(std::vector<Identifier> &idents)
+{
+    tileMatrixSet->tilesForLevel(minLevel, idents);
 }
     
 bool Quadtree::parentIsLoading(const Identifier &ident)
@@ -886,10 +954,11 @@ bool Quadtree::parentIsLoading(const Identifier &ident)
 
 bool Quadtree::hasParent(const Quadtree::Identifier &ident,Quadtree::Identifier &parentIdent)
 {
-    if (ident.level == minLevel)
+    Identifier testIdent;
+    if (!parentForNode(ident, testIdent))
         return false;
     
-    Node *node = getNode(Identifier(ident.x/2,ident.y/2,ident.level-1));
+    Node *node = getNode(testIdent);
     if (!node)
         return false;
 
@@ -960,9 +1029,8 @@ void Quadtree::removeNode(Node *node)
         evalNodes.erase(eit);
     
     // Note: Shouldn't happen, but just in case
-    for (unsigned int ii=0;ii<4;ii++)
-        if (node->children[ii])
-            node->children[ii]->parent = NULL;
+    for (unsigned int ii=0;ii<node->children.size();ii++)
+        node->children[ii]->parent = NULL;
 
     // Remove from the parent
     if (node->parent)
@@ -0,0 +1,961 @@
+/*
+ *  SLDStyleSet.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdlib.h>
+#import <string.h>
+#import <strings.h>
+#import <algorithm>
+#import "SLDStyleSet.h"
+#import "XMLStreamReader.h"
+#import "SharedAttributes.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+static std::string Trim(const std::string &str)
+{
+    size_t start = str.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+        return std::string();
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(start,end-start+1);
+}
+
+// Parse a number, the whole string or nothing
+static bool ParseNumber(const std::string &str,double &num)
+{
+    if (str.empty())
+        return false;
+    const char *start = str.c_str();
+    char *end = NULL;
+    num = strtod(start,&end);
+    if (end == start)
+        return false;
+    while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n')
+        end++;
+    return *end == 0;
+}
+
+/// Builds up the element tree as the stream reader goes
+class SLDXMLTreeBuilder : public XMLStreamHandler
+{
+public:
+    virtual void startElement(const std::string &name,const XMLAttributes &attrs)
+    {
+        SLDXMLNodeRef node(new SLDXMLNode());
+        node->name = name;
+        node->attrs = attrs;
+        if (stack.empty())
+            root = node;
+        else
+            stack.back()->children.push_back(node);
+        stack.push_back(node);
+    }
+
+    virtual void endElement(const std::string &name)
+    {
+        stack.back()->text = Trim(stack.back()->text);
+        stack.pop_back();
+    }
+
+    virtual void characters(const std::string &text)
+    {
+        if (!stack.empty())
+            stack.back()->text += text;
+    }
+
+    SLDXMLNodeRef root;
+    std::vector<SLDXMLNodeRef> stack;
+};
+
+SLDXMLNode *SLDXMLNode::child(const std::string &childName) const
+{
+    for (const auto &it : children)
+        if (it->name == childName)
+            return it.get();
+
+    return NULL;
+}
+
+std::string SLDXMLNode::attr(const std::string &attrName) const
+{
+    auto it = attrs.find(attrName);
+    return it == attrs.end() ? std::string() : it->second;
+}
+
+SLDXMLNodeRef SLDXMLNode::Parse(const std::string &xml,std::string &error)
+{
+    SLDXMLTreeBuilder builder;
+    XMLStreamReader reader(&builder);
+    if (!reader.parse(xml))
+    {
+        error = reader.getError();
+        return SLDXMLNodeRef();
+    }
+
+    return builder.root;
+}
+
+void SLDValue::setString(const std::string &inStr)
+{
+    valid = true;
+    str = inStr;
+    isNum = ParseNumber(str,num);
+}
+
+void SLDValue::setNumber(double inNum)
+{
+    valid = true;
+    isNum = true;
+    num = inNum;
+    str.clear();
+}
+
+std::string SLDValue::asString() const
+{
+    if (!valid)
+        return std::string();
+    if (!str.empty() || !isNum)
+        return str;
+
+    char buf[64];
+    snprintf(buf,sizeof(buf),"%.15g",num);
+    return buf;
+}
+
+/// A literal, parsed once
+class SLDLiteralExpression : public SLDExpression
+{
+public:
+    SLDLiteralExpression(const std::string &str) { val.setString(str); }
+
+    virtual void evaluate(const Dictionary &attrs,SLDValue &ret) const { ret = val; }
+
+    SLDValue val;
+};
+
+/// Look up an attribute
+class SLDPropertyExpression : public SLDExpression
+{
+public:
+    SLDPropertyExpression(const std::string &name) : name(name) { }
+
+    virtual void evaluate(const Dictionary &attrs,SLDValue &ret) const
+    {
+        switch (attrs.getType(name))
+        {
+            case DictTypeInt:
+            case DictTypeDouble:
+                ret.setNumber(attrs.getDouble(name));
+                break;
+            case DictTypeString:
+                ret.setString(attrs.getString(name));
+                break;
+            default:
+                ret = SLDValue();
+                break;
+        }
+    }
+
+    std::string name;
+};
+
+typedef enum {SLDArithAdd,SLDArithSub,SLDArithMul,SLDArithDiv} SLDArithOp;
+
+/// Add, Sub, Mul and Div on numbers
+class SLDArithmeticExpression : public SLDExpression
+{
+public:
+    SLDArithmeticExpression(SLDArithOp op,SLDExpressionRef left,SLDExpressionRef right) : op(op), left(left), right(right) { }
+
+    virtual void evaluate(const Dictionary &attrs,SLDValue &ret) const
+    {
+        SLDValue a,b;
+        left->evaluate(attrs,a);
+        right->evaluate(attrs,b);
+        if (!a.isNum || !b.isNum)
+        {
+            ret = SLDValue();
+            return;
+        }
+        switch (op)
+        {
+            case SLDArithAdd:
+                ret.setNumber(a.num + b.num);
+                break;
+            case SLDArithSub:
+                ret.setNumber(a.num - b.num);
+                break;
+            case SLDArithMul:
+                ret.setNumber(a.num * b.num);
+                break;
+            case SLDArithDiv:
+                if (b.num == 0.0)
+                    ret = SLDValue();
+                else
+                    ret.setNumber(a.num / b.num);
+                break;
+        }
+    }
+
+    SLDArithOp op;
+    SLDExpressionRef left,right;
+};
+
+/// Mixed content, like a label with text and properties in it.  Concatenated as strings.
+class SLDConcatExpression : public SLDExpression
+{
+public:
+    virtual void evaluate(const Dictionary &attrs,SLDValue &ret) const
+    {
+        std::string str;
+        for (const auto &part : parts)
+        {
+            SLDValue val;
+            part->evaluate(attrs,val);
+            str += val.asString();
+        }
+        ret.setString(str);
+    }
+
+    std::vector<SLDExpressionRef> parts;
+};
+
+// Compare two values.  Numbers if they both are, otherwise strings.
+static int CompareValues(const SLDValue &a,const SLDValue &b,bool matchCase)
+{
+    if (a.isNum && b.isNum)
+        return a.num < b.num ? -1 : (a.num > b.num ? 1 : 0);
+
+    std::string aStr = a.asString(), bStr = b.asString();
+    int res = matchCase ? strcmp(aStr.c_str(),bStr.c_str()) : strcasecmp(aStr.c_str(),bStr.c_str());
+    return res < 0 ? -1 : (res > 0 ? 1 : 0);
+}
+
+typedef enum {SLDCompareEqual,SLDCompareNotEqual,SLDCompareLess,SLDCompareGreater,SLDCompareLessEqual,SLDCompareGreaterEqual} SLDCompareOp;
+
+/// The binary comparisons
+class SLDComparisonFilter : public SLDFilter
+{
+public:
+    SLDComparisonFilter(SLDCompareOp op,SLDExpressionRef left,SLDExpressionRef right,bool matchCase)
+        : op(op), left(left), right(right), matchCase(matchCase) { }
+
+    virtual bool matches(const Dictionary &attrs) const
+    {
+        SLDValue a,b;
+        left->evaluate(attrs,a);
+        right->evaluate(attrs,b);
+        // A missing property doesn't compare to anything
+        if (!a.valid || !b.valid)
+            return op == SLDCompareNotEqual;
+
+        int res = CompareValues(a,b,matchCase);
+        switch (op)
+        {
+            case SLDCompareEqual:
+                return res == 0;
+            case SLDCompareNotEqual:
+                return res != 0;
+            case SLDCompareLess:
+                return res < 0;
+            case SLDCompareGreater:
+                return res > 0;
+            case SLDCompareLessEqual:
+                return res <= 0;
+            case SLDCompareGreaterEqual:
+                return res >= 0;
+        }
+
+        return false;
+    }
+
+    SLDCompareOp op;
+    SLDExpressionRef left,right;
+    bool matchCase;
+};
+
+/// PropertyIsBetween, inclusive at both ends
+class SLDBetweenFilter : public SLDFilter
+{
+public:
+    SLDBetweenFilter(SLDExpressionRef expr,SLDExpressionRef lower,SLDExpressionRef upper)
+        : expr(expr), lower(lower), upper(upper) { }
+
+    virtual bool matches(const Dictionary &attrs) const
+    {
+        SLDValue val,lo,hi;
+        expr->evaluate(attrs,val);
+        lower->evaluate(attrs,lo);
+        upper->evaluate(attrs,hi);
+        if (!val.valid || !lo.valid || !hi.valid)
+            return false;
+
+        return CompareValues(val,lo,true) >= 0 && CompareValues(val,hi,true) <= 0;
+    }
+
+    SLDExpressionRef expr,lower,upper;
+};
+
+/// PropertyIsLike.  The pattern is compiled into literal runs and wildcards, no regular expressions.
+class SLDLikeFilter : public SLDFilter
+{
+public:
+    SLDLikeFilter(SLDExpressionRef expr,const std::string &pattern,const std::string &wildCard,
+                  const std::string &singleChar,const std::string &escapeChar,bool matchCase)
+        : expr(expr), matchCase(matchCase)
+    {
+        char wild = wildCard.empty() ? '*' : wildCard[0];
+        char single = singleChar.empty() ? '?' : singleChar[0];
+        char escape = escapeChar.empty() ? '\\' : escapeChar[0];
+        for (size_t ii=0;ii<pattern.size();ii++)
+        {
+            char c = pattern[ii];
+            if (c == escape && ii+1 < pattern.size())
+                addLiteral(pattern[++ii]);
+            else if (c == wild)
+                tokens.push_back(Token(TokenMany));
+            else if (c == single)
+                tokens.push_back(Token(TokenOne));
+            else
+                addLiteral(c);
+        }
+    }
+
+    virtual bool matches(const Dictionary &attrs) const
+    {
+        SLDValue val;
+        expr->evaluate(attrs,val);
+        if (!val.valid)
+            return false;
+        std::string str = val.asString();
+
+        // Greedy match, backing up to the last wildcard on failure
+        size_t ti = 0, si = 0;
+        size_t starToken = std::string::npos, starStr = 0;
+        while (si < str.size() || ti < tokens.size())
+        {
+            if (ti < tokens.size())
+            {
+                const Token &tok = tokens[ti];
+                if (tok.type == TokenMany)
+                {
+                    starToken = ti++;
+                    starStr = si;
+                    continue;
+                }
+                if (tok.type == TokenOne && si < str.size())
+                {
+                    ti++;  si++;
+                    continue;
+                }
+                if (tok.type == TokenLiteral && literalAt(tok.literal,str,si))
+                {
+                    ti++;  si += tok.literal.size();
+                    continue;
+                }
+            }
+            if (starToken == std::string::npos || starStr >= str.size())
+                return false;
+            ti = starToken+1;
+            si = ++starStr;
+        }
+
+        return true;
+    }
+
+protected:
+    typedef enum {TokenLiteral,TokenOne,TokenMany} TokenType;
+
+    class Token
+    {
+    public:
+        Token(TokenType type) : type(type) { }
+        TokenType type;
+        std::string literal;
+    };
+
+    void addLiteral(char c)
+    {
+        if (tokens.empty() || tokens.back().type != TokenLiteral)
+            tokens.push_back(Token(TokenLiteral));
+        tokens.back().literal += c;
+    }
+
+    bool literalAt(const std::string &lit,const std::string &str,size_t si) const
+    {
+        if (si + lit.size() > str.size())
+            return false;
+        return matchCase ? strncmp(lit.c_str(),str.c_str()+si,lit.size()) == 0 :
+                           strncasecmp(lit.c_str(),str.c_str()+si,lit.size()) == 0;
+    }
+
+    SLDExpressionRef expr;
+    bool matchCase;
+    std::vector<Token> tokens;
+};
+
+/// PropertyIsNull (and PropertyIsNil)
+class SLDNullFilter : public SLDFilter
+{
+public:
+    SLDNullFilter(SLDExpressionRef expr) : expr(expr) { }
+
+    virtual bool matches(const Dictionary &attrs) const
+    {
+        SLDValue val;
+        expr->evaluate(attrs,val);
+        return !val.valid;
+    }
+
+    SLDExpressionRef expr;
+};
+
+/// And and Or, stopping as soon as the answer is known
+class SLDLogicalFilter : public SLDFilter
+{
+public:
+    SLDLogicalFilter(bool isAnd) : isAnd(isAnd) { }
+
+    virtual bool matches(const Dictionary &attrs) const
+    {
+        for (const auto &filter : filters)
+            if (filter->matches(attrs) != isAnd)
+                return !isAnd;
+
+        return isAnd;
+    }
+
+    bool isAnd;
+    std::vector<SLDFilterRef> filters;
+};
+
+class SLDNotFilter : public SLDFilter
+{
+public:
+    SLDNotFilter(SLDFilterRef filter) : filter(filter) { }
+
+    virtual bool matches(const Dictionary &attrs) const { return !filter->matches(attrs); }
+
+    SLDFilterRef filter;
+};
+
+SLDSymbolizer::SLDSymbolizer()
+    : type(SLDVectorParams), markFill(255,255,255,255), markStroke(64,64,64,255), graphicSize(0.0)
+{
+}
+
+std::string SLDSymbolizer::labelText(const Dictionary &attrs) const
+{
+    if (!label)
+        return std::string();
+
+    SLDValue val;
+    label->evaluate(attrs,val);
+    return val.asString();
+}
+
+SLDRule::SLDRule()
+    : elseFilter(false), minScale(0.0), maxScale(0.0)
+{
+}
+
+bool SLDRule::inScale(double scale) const
+{
+    if (scale <= 0.0)
+        return true;
+    // Min is inclusive, max is exclusive
+    if (minScale > 0.0 && scale < minScale)
+        return false;
+    if (maxScale > 0.0 && scale >= maxScale)
+        return false;
+
+    return true;
+}
+
+SLDStyleSet::SLDStyleSet()
+    : baseDrawPriority(MaplyFeatureDrawPriorityBase), drawPriority(0)
+{
+}
+
+bool SLDStyleSet::ParseColor(const std::string &inStr,double opacity,RGBAColor &color)
+{
+    std::string str = Trim(inStr);
+    if (str.size() != 7 || str[0] != '#')
+        return false;
+    char *end = NULL;
+    unsigned long val = strtoul(str.c_str()+1,&end,16);
+    if (*end != 0)
+        return false;
+
+    opacity = std::min(std::max(opacity,0.0),1.0);
+    color = RGBAColor((val >> 16) & 0xFF,(val >> 8) & 0xFF,val & 0xFF,(unsigned char)(opacity * 255.0 + 0.5));
+    return true;
+}
+
+bool SLDStyleSet::parse(const std::string &xml)
+{
+    error.clear();
+    layers.clear();
+    drawPriority = 0;
+
+    SLDXMLNodeRef root = SLDXMLNode::Parse(xml,error);
+    if (!root)
+        return false;
+    if (root->name != "StyledLayerDescriptor")
+    {
+        error = "Root element is " + root->name + ", not StyledLayerDescriptor";
+        return false;
+    }
+
+    for (const auto &child : root->children)
+        if (child->name == "NamedLayer" || child->name == "UserLayer")
+            parseNamedLayer(child.get());
+
+    return true;
+}
+
+void SLDStyleSet::parseNamedLayer(SLDXMLNode *node)
+{
+    SLDNamedLayerRef layer(new SLDNamedLayer());
+    SLDXMLNode *nameNode = node->child("Name");
+    if (nameNode)
+        layer->name = nameNode->text;
+
+    for (const auto &child : node->children)
+        if (child->name == "UserStyle")
+        {
+            for (const auto &styleChild : child->children)
+                if (styleChild->name == "FeatureTypeStyle" || styleChild->name == "CoverageStyle")
+                    parseFeatureTypeStyle(styleChild.get(),layer.get());
+        }
+
+    layers.push_back(layer);
+}
+
+void SLDStyleSet::parseFeatureTypeStyle(SLDXMLNode *node,SLDNamedLayer *layer)
+{
+    SLDFeatureTypeStyleRef style(new SLDFeatureTypeStyle());
+    for (const auto &child : node->children)
+        if (child->name == "Rule")
+        {
+            SLDRuleRef rule = parseRule(child.get());
+            if (rule)
+                style->rules.push_back(rule);
+        }
+
+    layer->featureTypeStyles.push_back(style);
+}
+
+SLDRuleRef SLDStyleSet::parseRule(SLDXMLNode *node)
+{
+    SLDRuleRef rule(new SLDRule());
+
+    // Scales and filter first, since the symbolizers need them
+    for (const auto &child : node->children)
+    {
+        if (child->name == "Name")
+            rule->name = child->text;
+        else if (child->name == "MinScaleDenominator")
+            ParseNumber(child->text,rule->minScale);
+        else if (child->name == "MaxScaleDenominator")
+            ParseNumber(child->text,rule->maxScale);
+        else if (child->name == "ElseFilter")
+            rule->elseFilter = true;
+        else if (child->name == "Filter")
+        {
+            if (!child->children.empty())
+            {
+                rule->filter = parseFilter(child->children[0].get());
+                // Couldn't make sense of the filter, so leave the rule out rather than draw everything
+                if (!rule->filter)
+                    return SLDRuleRef();
+            }
+        }
+    }
+
+    for (const auto &child : node->children)
+        parseSymbolizer(child.get(),rule.get());
+
+    return rule;
+}
+
+SLDFilterRef SLDStyleSet::parseFilter(SLDXMLNode *node)
+{
+    static const std::map<std::string,SLDCompareOp> compareOps =
+    {
+        {"PropertyIsEqualTo",SLDCompareEqual},
+        {"PropertyIsNotEqualTo",SLDCompareNotEqual},
+        {"PropertyIsLessThan",SLDCompareLess},
+        {"PropertyIsGreaterThan",SLDCompareGreater},
+        {"PropertyIsLessThanOrEqualTo",SLDCompareLessEqual},
+        {"PropertyIsGreaterThanOrEqualTo",SLDCompareGreaterEqual}
+    };
+
+    auto compIt = compareOps.find(node->name);
+    if (compIt != compareOps.end())
+    {
+        if (node->children.size() != 2)
+        {
+            WHIRLYKIT_LOGW("SLDStyleSet: %s needs two expressions",node->name.c_str());
+            return SLDFilterRef();
+        }
+        SLDExpressionRef left = parseExpression(node->children[0].get());
+        SLDExpressionRef right = parseExpression(node->children[1].get());
+        if (!left || !right)
+            return SLDFilterRef();
+        bool matchCase = node->attr("matchCase") != "false";
+        return SLDFilterRef(new SLDComparisonFilter(compIt->second,left,right,matchCase));
+    }
+
+    if (node->name == "PropertyIsBetween")
+    {
+        SLDXMLNode *lowerNode = node->child("LowerBoundary");
+        SLDXMLNode *upperNode = node->child("UpperBoundary");
+        if (node->children.empty() || !lowerNode || !upperNode || lowerNode->children.empty() || upperNode->children.empty())
+        {
+            WHIRLYKIT_LOGW("SLDStyleSet: PropertyIsBetween needs an expression and two boundaries");
+            return SLDFilterRef();
+        }
+        SLDExpressionRef expr = parseExpression(node->children[0].get());
+        SLDExpressionRef lower = parseExpression(lowerNode->children[0].get());
+        SLDExpressionRef upper = parseExpression(upperNode->children[0].get());
+        if (!expr || !lower || !upper)
+            return SLDFilterRef();
+        return SLDFilterRef(new SLDBetweenFilter(expr,lower,upper));
+    }
+
+    if (node->name == "PropertyIsLike")
+    {
+        if (node->children.size() != 2)
+        {
+            WHIRLYKIT_LOGW("SLDStyleSet: PropertyIsLike needs a property and a pattern");
+            return SLDFilterRef();
+        }
+        SLDExpressionRef expr = parseExpression(node->children[0].get());
+        if (!expr)
+            return SLDFilterRef();
+        // SE 1.1 calls it escapeChar, 1.0 escape
+        std::string escape = node->attr("escapeChar");
+        if (escape.empty())
+            escape = node->attr("escape");
+        return SLDFilterRef(new SLDLikeFilter(expr,node->children[1]->text,node->attr("wildCard"),node->attr("singleChar"),
+                                              escape,node->attr("matchCase") != "false"));
+    }
+
+    if (node->name == "PropertyIsNull" || node->name == "PropertyIsNil")
+    {
+        if (node->children.empty())
+            return SLDFilterRef();
+        SLDExpressionRef expr = parseExpression(node->children[0].get());
+        if (!expr)
+            return SLDFilterRef();
+        return SLDFilterRef(new SLDNullFilter(expr));
+    }
+
+    if (node->name == "And" || node->name == "Or")
+    {
+        std::shared_ptr<SLDLogicalFilter> filter(new SLDLogicalFilter(node->name == "And"));
+        for (const auto &child : node->children)
+        {
+            SLDFilterRef childFilter = parseFilter(child.get());
+            if (!childFilter)
+                return SLDFilterRef();
+            filter->filters.push_back(childFilter);
+        }
+        return filter;
+    }
+
+    if (node->name == "Not")
+    {
+        if (node->children.empty())
+            return SLDFilterRef();
+        SLDFilterRef childFilter = parseFilter(node->children[0].get());
+        if (!childFilter)
+            return SLDFilterRef();
+        return SLDFilterRef(new SLDNotFilter(childFilter));
+    }
+
+    WHIRLYKIT_LOGW("SLDStyleSet: Unsupported filter %s",node->name.c_str());
+    return SLDFilterRef();
+}
+
+SLDExpressionRef SLDStyleSet::parseExpression(SLDXMLNode *node)
+{
+    if (node->name == "PropertyName" || node->name == "ValueReference")
+        return SLDExpressionRef(new SLDPropertyExpression(node->text));
+    if (node->name == "Literal")
+        return SLDExpressionRef(new SLDLiteralExpression(node->text));
+
+    static const std::map<std::string,SLDArithOp> arithOps =
+    {
+        {"Add",SLDArithAdd},
+        {"Sub",SLDArithSub},
+        {"Mul",SLDArithMul},
+        {"Div",SLDArithDiv}
+    };
+    auto arithIt = arithOps.find(node->name);
+    if (arithIt != arithOps.end() && node->children.size() == 2)
+    {
+        SLDExpressionRef left = parseExpression(node->children[0].get());
+        SLDExpressionRef right = parseExpression(node->children[1].get());
+        if (!left || !right)
+            return SLDExpressionRef();
+        return SLDExpressionRef(new SLDArithmeticExpression(arithIt->second,left,right));
+    }
+
+    WHIRLYKIT_LOGW("SLDStyleSet: Unsupported expression %s",node->name.c_str());
+    return SLDExpressionRef();
+}
+
+// Collect the Svg/CssParameters under a node (Stroke, Fill, Font)
+static void ReadParameters(SLDXMLNode *node,std::map<std::string,std::string> &params)
+{
+    if (!node)
+        return;
+    for (const auto &child : node->children)
+        if (child->name == "SvgParameter" || child->name == "CssParameter")
+        {
+            std::string val = child->text;
+            SLDXMLNode *lit = child->child("Literal");
+            if (val.empty() && lit)
+                val = lit->text;
+            params[child->attr("name")] = val;
+        }
+}
+
+static double ParamDouble(const std::map<std::string,std::string> &params,const std::string &name,double defVal)
+{
+    auto it = params.find(name);
+    double val;
+    if (it == params.end() || !ParseNumber(it->second,val))
+        return defVal;
+    return val;
+}
+
+// Color with its opacity from the parameters
+static bool ParamColor(const std::map<std::string,std::string> &params,const std::string &colorName,const std::string &opacityName,RGBAColor &color)
+{
+    auto it = params.find(colorName);
+    if (it == params.end())
+        return false;
+    double opacity = ParamDouble(params,opacityName,ParamDouble(params,"opacity",1.0));
+    return SLDStyleSet::ParseColor(it->second,opacity,color);
+}
+
+// Text of a node that might be a plain value or an ogc:Literal
+static std::string NodeValue(SLDXMLNode *node)
+{
+    if (!node)
+        return std::string();
+    SLDXMLNode *lit = node->child("Literal");
+    return lit ? lit->text : node->text;
+}
+
+void SLDStyleSet::setupDesc(SLDRule *rule,Dictionary &desc)
+{
+    desc.setInt(MaplyDrawPriority,baseDrawPriority + drawPriority++);
+    desc.setInt(MaplyEnable,0);
+
+    if (heightForScale && (rule->minScale > 0.0 || rule->maxScale > 0.0))
+    {
+        desc.setDouble(MaplyMinVis,rule->minScale > 0.0 ? heightForScale(rule->minScale) : 0.0);
+        desc.setDouble(MaplyMaxVis,rule->maxScale > 0.0 ? heightForScale(rule->maxScale) : MAXFLOAT);
+    }
+}
+
+void SLDStyleSet::parseSymbolizer(SLDXMLNode *node,SLDRule *rule)
+{
+    if (node->name == "LineSymbolizer")
+    {
+        std::map<std::string,std::string> stroke;
+        ReadParameters(node->child("Stroke"),stroke);
+        SLDSymbolizerRef sym(new SLDSymbolizer());
+        sym->type = SLDVectorParams;
+        setupDesc(rule,sym->desc);
+        RGBAColor color;
+        if (ParamColor(stroke,"stroke","stroke-opacity",color))
+            sym->desc.setInt(MaplyColor,color.asInt());
+        sym->desc.setDouble(MaplyVecWidth,ParamDouble(stroke,"stroke-width",1.0));
+        sym->desc.setInt(MaplyFilled,0);
+        rule->symbolizers.push_back(sym);
+    } else if (node->name == "PolygonSymbolizer")
+    {
+        SLDXMLNode *fillNode = node->child("Fill");
+        SLDXMLNode *strokeNode = node->child("Stroke");
+        // No fill means the default gray, unless there's only a stroke
+        if (fillNode || !strokeNode)
+        {
+            std::map<std::string,std::string> fill;
+            ReadParameters(fillNode,fill);
+            SLDSymbolizerRef sym(new SLDSymbolizer());
+            sym->type = SLDVectorParams;
+            setupDesc(rule,sym->desc);
+            RGBAColor color(128,128,128,255);
+            ParamColor(fill,"fill","fill-opacity",color);
+            sym->desc.setInt(MaplyColor,color.asInt());
+            sym->desc.setInt(MaplyFilled,1);
+            rule->symbolizers.push_back(sym);
+        }
+        if (strokeNode)
+        {
+            std::map<std::string,std::string> stroke;
+            ReadParameters(strokeNode,stroke);
+            SLDSymbolizerRef sym(new SLDSymbolizer());
+            sym->type = SLDVectorParams;
+            setupDesc(rule,sym->desc);
+            RGBAColor color;
+            if (ParamColor(stroke,"stroke","stroke-opacity",color))
+                sym->desc.setInt(MaplyColor,color.asInt());
+            sym->desc.setDouble(MaplyVecWidth,ParamDouble(stroke,"stroke-width",1.0));
+            sym->desc.setInt(MaplyFilled,0);
+            rule->symbolizers.push_back(sym);
+        }
+    } else if (node->name == "PointSymbolizer")
+    {
+        SLDXMLNode *graphic = node->child("Graphic");
+        if (!graphic)
+            return;
+        SLDSymbolizerRef sym(new SLDSymbolizer());
+        sym->type = SLDMarkerParams;
+        setupDesc(rule,sym->desc);
+        ParseNumber(NodeValue(graphic->child("Size")),sym->graphicSize);
+        if (SLDXMLNode *mark = graphic->child("Mark"))
+        {
+            sym->wellKnownName = NodeValue(mark->child("WellKnownName"));
+            if (sym->wellKnownName.empty())
+                sym->wellKnownName = "square";
+            std::map<std::string,std::string> fill,stroke;
+            ReadParameters(mark->child("Fill"),fill);
+            ReadParameters(mark->child("Stroke"),stroke);
+            ParamColor(fill,"fill","fill-opacity",sym->markFill);
+            ParamColor(stroke,"stroke","stroke-opacity",sym->markStroke);
+        } else if (SLDXMLNode *external = graphic->child("ExternalGraphic"))
+        {
+            sym->graphicFormat = NodeValue(external->child("Format"));
+            if (SLDXMLNode *resource = external->child("OnlineResource"))
+                sym->graphicHref = resource->attr("href");
+            if (SLDXMLNode *inlineNode = external->child("InlineContent"))
+            {
+                sym->graphicContent = inlineNode->text;
+                sym->graphicEncoding = inlineNode->attr("encoding");
+            }
+        }
+        // Marks are at least 8 pixels, as they are elsewhere
+        double size = sym->graphicSize > 0.0 ? sym->graphicSize : 16.0;
+        if (!sym->wellKnownName.empty())
+            size = std::max(size,8.0);
+        sym->desc.setInt("screen",1);
+        sym->desc.setDouble(MaplyLabelWidth,size);
+        sym->desc.setDouble(MaplyLabelHeight,size);
+        rule->symbolizers.push_back(sym);
+    } else if (node->name == "TextSymbolizer")
+    {
+        SLDXMLNode *labelNode = node->child("Label");
+        if (!labelNode)
+            return;
+        SLDSymbolizerRef sym(new SLDSymbolizer());
+        sym->type = SLDLabelParams;
+
+        // A label can mix plain text and expressions, but it's usually just one property
+        if (labelNode->children.size() == 1 && labelNode->text.empty())
+            sym->label = parseExpression(labelNode->children[0].get());
+        else {
+            std::shared_ptr<SLDConcatExpression> concat(new SLDConcatExpression());
+            if (!labelNode->text.empty())
+                concat->parts.push_back(SLDExpressionRef(new SLDLiteralExpression(labelNode->text)));
+            for (const auto &child : labelNode->children)
+            {
+                SLDExpressionRef part = parseExpression(child.get());
+                if (part)
+                    concat->parts.push_back(part);
+            }
+            sym->label = concat;
+        }
+        if (!sym->label)
+            return;
+
+        setupDesc(rule,sym->desc);
+        std::map<std::string,std::string> font,fill;
+        ReadParameters(node->child("Font"),font);
+        ReadParameters(node->child("Fill"),fill);
+        auto familyIt = font.find("font-family");
+        if (familyIt != font.end())
+            sym->desc.setString(MaplyFont,familyIt->second);
+        sym->desc.setDouble(MaplyLabelHeight,ParamDouble(font,"font-size",10.0));
+        RGBAColor textColor(0,0,0,255);
+        ParamColor(fill,"fill","fill-opacity",textColor);
+        sym->desc.setInt(MaplyTextColor,textColor.asInt());
+        if (SLDXMLNode *halo = node->child("Halo"))
+        {
+            double radius = 1.0;
+            ParseNumber(NodeValue(halo->child("Radius")),radius);
+            std::map<std::string,std::string> haloFill;
+            ReadParameters(halo->child("Fill"),haloFill);
+            RGBAColor haloColor(255,255,255,255);
+            ParamColor(haloFill,"fill","fill-opacity",haloColor);
+            sym->desc.setDouble(MaplyTextOutlineSize,radius);
+            sym->desc.setInt(MaplyTextOutlineColor,haloColor.asInt());
+        }
+        sym->desc.setInt("screen",1);
+        sym->desc.setInt("layout",1);
+        rule->symbolizers.push_back(sym);
+    }
+}
+
+SLDNamedLayerRef SLDStyleSet::getLayer(const std::string &name) const
+{
+    for (const auto &layer : layers)
+        if (layer->name == name)
+            return layer;
+
+    return SLDNamedLayerRef();
+}
+
+void SLDStyleSet::matchingSymbolizers(const Dictionary &attrs,const std::string &layerName,double scale,std::vector<SLDSymbolizerRef> &syms) const
+{
+    for (const auto &layer : layers)
+    {
+        if (!layerName.empty() && layer->name != layerName)
+            continue;
+        for (const auto &style : layer->featureTypeStyles)
+        {
+            // Regular rules first, then the else rules if none of them took it
+            bool anyMatched = false;
+            for (const auto &rule : style->rules)
+            {
+                if (rule->elseFilter || !rule->inScale(scale))
+                    continue;
+                if (!rule->filter || rule->filter->matches(attrs))
+                {
+                    anyMatched = true;
+                    syms.insert(syms.end(),rule->symbolizers.begin(),rule->symbolizers.end());
+                }
+            }
+            if (!anyMatched)
+                for (const auto &rule : style->rules)
+                    if (rule->elseFilter && rule->inScale(scale))
+                        syms.insert(syms.end(),rule->symbolizers.begin(),rule->symbolizers.end());
+        }
+    }
+}
+
+}
@@ -0,0 +1,513 @@
+/*
+ *  ScalarGrid.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import <cfloat>
+#import <string.h>
+#import "ScalarGrid.h"
+#import "Texture.h"
+#import "Scene.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+ScalarGrid::ScalarGrid(int width,int height,ScalarGridDataType dataType,RawDataRef data)
+    : width(width), height(height), dataType(dataType), data(data), scale(1.0), offset(0.0), hasNoData(false), noData(0.0)
+{
+}
+
+int ScalarGrid::BytesPerValue(ScalarGridDataType dataType)
+{
+    switch (dataType)
+    {
+        case ScalarGridUInt8:
+            return 1;
+        case ScalarGridInt16:
+        case ScalarGridUInt16:
+            return 2;
+        case ScalarGridFloat32:
+            return 4;
+    }
+
+    return 1;
+}
+
+bool ScalarGrid::isValid() const
+{
+    return data && width > 0 && height > 0 && data->getLen() >= (unsigned long)width*height*BytesPerValue(dataType);
+}
+
+double ScalarGrid::rawValue(int x,int y) const
+{
+    const unsigned char *ptr = data->getRawData() + (y*width + x) * BytesPerValue(dataType);
+    switch (dataType)
+    {
+        case ScalarGridUInt8:
+            return *ptr;
+        case ScalarGridInt16:
+        {
+            int16_t val;
+            memcpy(&val,ptr,sizeof(val));
+            return val;
+        }
+        case ScalarGridUInt16:
+        {
+            uint16_t val;
+            memcpy(&val,ptr,sizeof(val));
+            return val;
+        }
+        case ScalarGridFloat32:
+        {
+            float val;
+            memcpy(&val,ptr,sizeof(val));
+            return val;
+        }
+    }
+
+    return 0.0;
+}
+
+bool ScalarGrid::valueAt(int x,int y,double &val) const
+{
+    if (x < 0 || y < 0 || x >= width || y >= height || !isValid())
+        return false;
+
+    double raw = rawValue(x,y);
+    if (std::isnan(raw) || (hasNoData && raw == noData))
+        return false;
+    val = raw * scale + offset;
+
+    return true;
+}
+
+bool ScalarGrid::sample(double px,double py,double &val) const
+{
+    if (px < 0.0 || py < 0.0 || px > width || py > height)
+        return false;
+
+    // Cell centers are at the half pixel
+    double fx = std::min(std::max(px - 0.5,0.0),(double)(width-1));
+    double fy = std::min(std::max(py - 0.5,0.0),(double)(height-1));
+    int ix = std::min((int)fx,std::max(width-2,0)), iy = std::min((int)fy,std::max(height-2,0));
+    int ix1 = std::min(ix+1,width-1), iy1 = std::min(iy+1,height-1);
+    double tx = fx - ix, ty = fy - iy;
+
+    double v00,v10,v01,v11;
+    if (valueAt(ix,iy,v00) && valueAt(ix1,iy,v10) && valueAt(ix,iy1,v01) && valueAt(ix1,iy1,v11))
+    {
+        double top = v00 * (1.0-tx) + v10 * tx;
+        double bot = v01 * (1.0-tx) + v11 * tx;
+        val = top * (1.0-ty) + bot * ty;
+        return true;
+    }
+
+    // Don't blend with missing values
+    return valueAt(std::min((int)px,width-1),std::min((int)py,height-1),val);
+}
+
+bool ScalarGrid::getRange(double &minVal,double &maxVal) const
+{
+    bool found = false;
+    minVal = DBL_MAX;  maxVal = -DBL_MAX;
+    for (int y=0;y<height;y++)
+        for (int x=0;x<width;x++)
+        {
+            double val;
+            if (valueAt(x,y,val))
+            {
+                minVal = std::min(minVal,val);
+                maxVal = std::max(maxVal,val);
+                found = true;
+            }
+        }
+
+    return found;
+}
+
+ScalarGridEncoding::ScalarGridEncoding()
+    : minVal(0.0), maxVal(1.0)
+{
+}
+
+ScalarGridEncoding::ScalarGridEncoding(double minVal,double maxVal)
+    : minVal(minVal), maxVal(maxVal)
+{
+}
+
+void ScalarGridEncoding::encode(double val,bool valid,unsigned char *pixel) const
+{
+    if (!valid)
+    {
+        pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
+        return;
+    }
+
+    double range = maxVal - minVal;
+    double norm = range > 0.0 ? (val - minVal) / range : 0.0;
+    norm = std::min(std::max(norm,0.0),1.0);
+    unsigned int packed = (unsigned int)lround(norm * 65535.0);
+    pixel[0] = packed >> 8;
+    pixel[1] = packed & 0xff;
+    pixel[2] = 0;
+    pixel[3] = 255;
+}
+
+bool ScalarGridEncoding::decode(const unsigned char *pixel,double &val) const
+{
+    if (pixel[3] < 128)
+        return false;
+
+    double norm = ((pixel[0] << 8) | pixel[1]) / 65535.0;
+    val = minVal + norm * (maxVal - minVal);
+
+    return true;
+}
+
+RawDataRef ScalarGridEncoding::pack(const ScalarGrid &grid) const
+{
+    if (!grid.isValid())
+        return RawDataRef();
+
+    int width = grid.getWidth(), height = grid.getHeight();
+    std::vector<unsigned char> pixels(width*height*4);
+    for (int y=0;y<height;y++)
+        for (int x=0;x<width;x++)
+        {
+            double val = 0.0;
+            bool valid = grid.valueAt(x,y,val);
+            encode(val,valid,&pixels[(y*width+x)*4]);
+        }
+
+    return RawDataRef(new MutableRawData(&pixels[0],(unsigned int)pixels.size()));
+}
+
+ColorMap::ColorMap()
+    : discrete(false)
+{
+}
+
+void ColorMap::addStop(double value,const RGBAColor &color)
+{
+    auto it = std::upper_bound(stops.begin(),stops.end(),value,
+                               [](double val,const std::pair<double,RGBAColor> &stop) { return val < stop.first; });
+    stops.insert(it,std::pair<double,RGBAColor>(value,color));
+}
+
+double ColorMap::getMinValue() const
+{
+    return stops.empty() ? 0.0 : stops.front().first;
+}
+
+double ColorMap::getMaxValue() const
+{
+    return stops.empty() ? 1.0 : stops.back().first;
+}
+
+RGBAColor ColorMap::colorFor(double value) const
+{
+    if (stops.empty())
+        return RGBAColor(0,0,0,0);
+    if (value <= stops.front().first)
+        return stops.front().second;
+    if (value >= stops.back().first)
+        return stops.back().second;
+
+    // First stop past the value
+    auto it = std::upper_bound(stops.begin(),stops.end(),value,
+                               [](double val,const std::pair<double,RGBAColor> &stop) { return val < stop.first; });
+    const auto &next = *it, &prev = *(it-1);
+    if (discrete)
+        return prev.second;
+
+    double t = (value - prev.first) / (next.first - prev.first);
+    const RGBAColor &a = prev.second, &b = next.second;
+    return RGBAColor(a.r + (b.r - a.r) * t + 0.5,a.g + (b.g - a.g) * t + 0.5,
+                     a.b + (b.b - a.b) * t + 0.5,a.a + (b.a - a.a) * t + 0.5);
+}
+
+// Colors are premultiplied in the ramp, as the renderer expects
+static RGBAColor Premultiply(const RGBAColor &color)
+{
+    return RGBAColor(color.r * color.a / 255,color.g * color.a / 255,color.b * color.a / 255,color.a);
+}
+
+RawDataRef ColorMap::makeRamp() const
+{
+    double minVal = getMinValue(), maxVal = getMaxValue();
+    std::vector<unsigned char> pixels(RampSize*4);
+    for (int ii=0;ii<RampSize;ii++)
+    {
+        RGBAColor color = Premultiply(colorFor(minVal + (maxVal - minVal) * ii / (RampSize-1)));
+        pixels[ii*4+0] = color.r;  pixels[ii*4+1] = color.g;
+        pixels[ii*4+2] = color.b;  pixels[ii*4+3] = color.a;
+    }
+
+    return RawDataRef(new MutableRawData(&pixels[0],(unsigned int)pixels.size()));
+}
+
+RGBAColor ColorMap::rampColorFor(double value) const
+{
+    double minVal = getMinValue(), maxVal = getMaxValue();
+    double range = maxVal > minVal ? maxVal - minVal : 1.0;
+    double t = std::min(std::max((value - minVal) / range,0.0),1.0);
+    int which = (int)floor(t * (RampSize-1) + 0.5);
+
+    return Premultiply(colorFor(minVal + (maxVal - minVal) * which / (RampSize-1)));
+}
+
+static const char *vertexShaderScalarGrid =
+"uniform mat4  u_mvpMatrix;\n"
+"uniform float u_fade;\n"
+"\n"
+"attribute vec3 a_position;\n"
+"attribute vec2 a_texCoord0;\n"
+"attribute vec4 a_color;\n"
+"\n"
+"varying vec2 v_texCoord;\n"
+"varying vec4 v_color;\n"
+"\n"
+"void main()\n"
+"{\n"
+"   v_texCoord = a_texCoord0;\n"
+"   v_color = a_color * u_fade;\n"
+"   gl_Position = u_mvpMatrix * vec4(a_position,1.0);\n"
+"}\n"
+;
+
+// The ramp size here has to match ColorMap::RampSize
+static const char *fragmentShaderScalarGrid =
+"#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+"precision highp float;\n"
+"#else\n"
+"precision mediump float;\n"
+"#endif\n"
+"\n"
+"uniform sampler2D s_baseMap0;\n"
+"uniform sampler2D s_colorRamp;\n"
+"uniform float u_encMin;\n"
+"uniform float u_encRange;\n"
+"uniform float u_rampMin;\n"
+"uniform float u_rampRange;\n"
+"uniform float u_filterMin;\n"
+"uniform float u_filterMax;\n"
+"\n"
+"varying vec2 v_texCoord;\n"
+"varying vec4 v_color;\n"
+"\n"
+"void main()\n"
+"{\n"
+"  vec4 packed = texture2D(s_baseMap0, v_texCoord);\n"
+"  if (packed.a < 0.5)\n"
+"    discard;\n"
+"  float val = u_encMin + (packed.r * 65280.0 + packed.g * 255.0) / 65535.0 * u_encRange;\n"
+"  if (val < u_filterMin || val > u_filterMax)\n"
+"    discard;\n"
+"  float t = clamp((val - u_rampMin) / u_rampRange, 0.0, 1.0);\n"
+"  gl_FragColor = v_color * texture2D(s_colorRamp, vec2((t * 1023.0 + 0.5) / 1024.0, 0.5));\n"
+"}\n"
+;
+
+OpenGLES2Program *BuildScalarGridProgram(const std::string &name)
+{
+    OpenGLES2Program *shader = new OpenGLES2Program(name,vertexShaderScalarGrid,fragmentShaderScalarGrid);
+    if (!shader->isValid())
+    {
+        delete shader;
+        return NULL;
+    }
+
+    // Show everything until we're told otherwise
+    glUseProgram(shader->getProgram());
+    shader->setUniform("u_encMin", 0.f);
+    shader->setUniform("u_encRange", 1.f);
+    shader->setUniform("u_rampMin", 0.f);
+    shader->setUniform("u_rampRange", 1.f);
+    shader->setUniform("u_filterMin", -FLT_MAX);
+    shader->setUniform("u_filterMax", FLT_MAX);
+
+    return shader;
+}
+
+ScalarGridColorizer::ScalarGridColorizer(const ScalarGridEncoding &encoding)
+    : encoding(encoding), filterMin(-FLT_MAX), filterMax(FLT_MAX), progID(EmptyIdentity), rampTexID(EmptyIdentity)
+{
+}
+
+void ScalarGridColorizer::setProgramID(SimpleIdentity newProgID,ChangeSet &changes)
+{
+    progID = newProgID;
+    updateUniforms(changes);
+    if (rampTexID != EmptyIdentity)
+        changes.push_back(new ShaderAddTextureReq(progID,"s_colorRamp",rampTexID));
+}
+
+void ScalarGridColorizer::updateUniforms(ChangeSet &changes)
+{
+    if (progID == EmptyIdentity)
+        return;
+
+    double rampMin = colorMap.getMinValue(), rampMax = colorMap.getMaxValue();
+    changes.push_back(new SetProgramValueReq(progID,"u_encMin",encoding.minVal));
+    changes.push_back(new SetProgramValueReq(progID,"u_encRange",encoding.maxVal - encoding.minVal));
+    changes.push_back(new SetProgramValueReq(progID,"u_rampMin",rampMin));
+    changes.push_back(new SetProgramValueReq(progID,"u_rampRange",rampMax > rampMin ? rampMax - rampMin : 1.0));
+    changes.push_back(new SetProgramValueReq(progID,"u_filterMin",filterMin));
+    changes.push_back(new SetProgramValueReq(progID,"u_filterMax",filterMax));
+}
+
+void ScalarGridColorizer::setColorMap(const ColorMap &newColorMap,ChangeSet &changes)
+{
+    colorMap = newColorMap;
+
+    // Ramp lookups have to be exact, so no filtering
+    Texture *tex = new Texture("Scalar Grid Ramp");
+    tex->texData = colorMap.makeRamp();
+    tex->setWidth(ColorMap::RampSize);
+    tex->setHeight(1);
+    tex->setInterpType(GL_NEAREST);
+    tex->setUsesMipmaps(false);
+    tex->setWrap(false,false);
+    SimpleIdentity oldTexID = rampTexID;
+    rampTexID = tex->getId();
+    changes.push_back(new AddTextureReq(tex));
+
+    if (progID != EmptyIdentity)
+        changes.push_back(new ShaderAddTextureReq(progID,"s_colorRamp",rampTexID));
+    updateUniforms(changes);
+
+    if (oldTexID != EmptyIdentity)
+        changes.push_back(new RemTextureReq(oldTexID));
+}
+
+void ScalarGridColorizer::setValueFilter(double minVal,double maxVal,ChangeSet &changes)
+{
+    filterMin = minVal;
+    filterMax = maxVal;
+    updateUniforms(changes);
+}
+
+void ScalarGridColorizer::clearValueFilter(ChangeSet &changes)
+{
+    setValueFilter(-FLT_MAX,FLT_MAX,changes);
+}
+
+void ScalarGridColorizer::shutdown(ChangeSet &changes)
+{
+    if (rampTexID != EmptyIdentity)
+        changes.push_back(new RemTextureReq(rampTexID));
+    rampTexID = EmptyIdentity;
+}
+
+bool ScalarGridColorizer::colorForPixel(const unsigned char *pixel,RGBAColor &color) const
+{
+    double val;
+    if (!encoding.decode(pixel,val))
+        return false;
+    if (val < filterMin || val > filterMax)
+        return false;
+
+    color = colorMap.rampColorFor(val);
+    return true;
+}
+
+RawDataRef ScalarGridColorizer::colorize(const ScalarGrid &grid) const
+{
+    if (!grid.isValid())
+        return RawDataRef();
+
+    int numPixels = grid.getWidth() * grid.getHeight();
+    std::vector<unsigned char> pixels(numPixels*4,0);
+    for (int ii=0;ii<numPixels;ii++)
+    {
+        // Go through the packing so the results match the GPU
+        double val = 0.0;
+        unsigned char packed[4];
+        bool valid = grid.valueAt(ii % grid.getWidth(),ii / grid.getWidth(),val);
+        encoding.encode(val,valid,packed);
+        RGBAColor color;
+        if (colorForPixel(packed,color))
+        {
+            pixels[ii*4+0] = color.r;  pixels[ii*4+1] = color.g;
+            pixels[ii*4+2] = color.b;  pixels[ii*4+3] = color.a;
+        }
+    }
+
+    return RawDataRef(new MutableRawData(&pixels[0],(unsigned int)pixels.size()));
+}
+
+ScalarGridSampler::ScalarGridSampler()
+{
+    pthread_mutex_init(&gridLock, NULL);
+}
+
+ScalarGridSampler::~ScalarGridSampler()
+{
+    pthread_mutex_destroy(&gridLock);
+}
+
+void ScalarGridSampler::addTile(const Quadtree::Identifier &ident,const Point2d &ll,const Point2d &ur,ScalarGridRef grid)
+{
+    TileGrid tile;
+    tile.ll = ll;  tile.ur = ur;
+    tile.grid = grid;
+
+    pthread_mutex_lock(&gridLock);
+    tiles[ident] = tile;
+    pthread_mutex_unlock(&gridLock);
+}
+
+void ScalarGridSampler::removeTile(const Quadtree::Identifier &ident)
+{
+    pthread_mutex_lock(&gridLock);
+    tiles.erase(ident);
+    pthread_mutex_unlock(&gridLock);
+}
+
+bool ScalarGridSampler::valueAt(const Point2d &pt,double &val)
+{
+    bool found = false;
+    int bestLevel = -1;
+
+    pthread_mutex_lock(&gridLock);
+    for (const auto &it : tiles)
+    {
+        const TileGrid &tile = it.second;
+        if (it.first.level <= bestLevel || !tile.grid ||
+            pt.x() < tile.ll.x() || pt.y() < tile.ll.y() || pt.x() > tile.ur.x() || pt.y() > tile.ur.y())
+            continue;
+
+        // Rows run from the top down
+        double px = (pt.x() - tile.ll.x()) / (tile.ur.x() - tile.ll.x()) * tile.grid->getWidth();
+        double py = (tile.ur.y() - pt.y()) / (tile.ur.y() - tile.ll.y()) * tile.grid->getHeight();
+        double tileVal;
+        if (tile.grid->sample(px,py,tileVal))
+        {
+            val = tileVal;
+            bestLevel = it.first.level;
+            found = true;
+        }
+    }
+    pthread_mutex_unlock(&gridLock);
+
+    return found;
+}
+
+}
@@ -34,12 +34,16 @@
 #import "LabelManager.h"
 #import "VectorManager.h"
 #import "WideVectorManager.h"
+#import "ElevationManager.h"
 #import "SphericalEarthChunkManager.h"
 //#import "LoftManager.h"
 #import "ParticleSystemManager.h"
 #import "BillboardManager.h"
+#import "MotionManager.h"
+#import "SpriteSheet.h"
 #import "WideVectorManager.h"
 #import "GeometryManager.h"
+#import "ShaderPermutation.h"
 
 namespace WhirlyKit
 {
@@ -72,6 +76,8 @@ void Scene::Init(WhirlyKit::CoordSystemDisplayAdapter *adapter,Mbr localMbr,unsi
 //
 //    dispatchQueue = dispatch_queue_create("WhirlyKit Scene", 0);
 
+    // Shader permutations are built as drawables need them
+    addManager(kWKShaderPermutationManager, new ShaderPermutationManager());
     // Selection manager is used for object selection from any thread
     addManager(kWKSelectionManager,new SelectionManager(this,DeviceScreenScale()));
     // Intersection handling
@@ -88,6 +94,8 @@ void Scene::Init(WhirlyKit::CoordSystemDisplayAdapter *adapter,Mbr localMbr,unsi
     addManager(kWKVectorManager, new VectorManager());
     // Vector manager handes vector features
     addManager(kWKWideVectorManager, new WideVectorManager());
+    // Elevation manager keeps loaded terrain for draping
+    addManager(kWKElevationManager, new ElevationManager());
 #ifndef MAPLYMINIMAL
     // Chunk manager handles geographic chunks that cover a large chunk of the globe
     addManager(kWKSphericalChunkManager, new SphericalChunkManager());
@@ -99,6 +107,10 @@ void Scene::Init(WhirlyKit::CoordSystemDisplayAdapter *adapter,Mbr localMbr,unsi
     addManager(kWKParticleSystemManager, new ParticleSystemManager());
     // 3D billboards
     addManager(kWKBillboardManager, new BillboardManager());
+    // Motion filters for live objects
+    addManager(kWKMotionManager, new MotionManager());
+    // Sprite sheets for icons referenced by name
+    addManager(kWKSpriteSheetManager, new SpriteSheetManager());
 #endif
 
 //    // Font Texture manager is used from any thread
@@ -132,6 +144,9 @@ Scene::~Scene()
          it != managers.end(); ++it)
         delete it->second;
     managers.clear();
+
+    // Drawables, textures and managers are gone, so anything still here was never removed
+    memTracker.logLeaks();
     
     // Note: Porting
 //    fontTexManager = nil;
@@ -314,11 +329,44 @@ void Scene::addManager(const char *name,SceneManager *manager)
     if (it != managers.end())
         managers.erase(it);
     managers[(std::string)name] = manager;
+    manager->setMemOwner(name);
     manager->setScene(this);
     
     pthread_mutex_unlock(&managerLock);
 }
 
+int SceneManager::getMemTag(const std::string &label)
+{
+    if (!scene)
+        return -1;
+    if (!label.empty())
+        return scene->getMemTracker()->getTag(memOwner,label);
+
+    // Tags don't change, so racing to fill this in is harmless
+    if (ownerMemTag < 0)
+        ownerMemTag = scene->getMemTracker()->getTag(memOwner,"");
+    return ownerMemTag;
+}
+
+void SceneManager::tagChanges(ChangeSet &changes,unsigned int startChange,int memTag)
+{
+    for (unsigned int ii=startChange;ii<changes.size();ii++)
+        if (changes[ii])
+            changes[ii]->setMemTag(memTag);
+}
+
+void SceneManager::trackSceneRep(SimpleIdentity repID,unsigned long size,int memTag)
+{
+    if (scene)
+        scene->getMemTracker()->addObject(MemTrackSceneRep,repID,memTag,size);
+}
+
+void SceneManager::untrackSceneRep(SimpleIdentity repID)
+{
+    if (scene)
+        scene->getMemTracker()->removeObject(MemTrackSceneRep,repID);
+}
+
 // Note: Porting
 //void Scene::addActiveModel(NSObject<WhirlyKitActiveModel> *activeModel)
 //{
@@ -377,11 +425,16 @@ TextureBase *Scene::getTexture(SimpleIdentity texId)
     return retTex;
 }
     
-void Scene::addTexture(TextureBase *tex)
+void Scene::addTexture(TextureBase *tex,int memTag)
 {
     pthread_mutex_lock(&textureLock);
     textures.insert(tex);
     pthread_mutex_unlock(&textureLock);
+
+    if (memTag >= 0)
+        memTracker.addObject(MemTrackTexture,tex->getId(),memTag,tex->getMemSize());
+    else
+        memTracker.addObject(MemTrackTexture,tex->getId(),tex->getName(),"",tex->getMemSize());
 }
 
 const DrawableRefSet &Scene::getDrawables()
@@ -518,6 +571,7 @@ void Scene::dumpStats()
     WHIRLYKIT_LOGV("Scene: %ld sub textures",(long int)subTextureMap.size());
     cullTree->dumpStats();
     memManager.dumpStats();
+    memTracker.dumpStats();
     for (GeneratorSet::iterator it = generators.begin();
          it != generators.end(); ++it)
         (*it)->dumpStats();
@@ -660,15 +714,16 @@ AddTextureReq::~AddTextureReq()
     
 void AddTextureReq::setupGL(WhirlyKitGLSetupInfo *setupInfo,OpenGLMemManager *memManager)
 {
-    if (tex)
+    if (tex && !memManager->isHeadless())
         tex->createInGL(memManager);
 }
     
 void AddTextureReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,WhirlyKit::View *view)
 {
-    if (!tex->getGLId())
+    // Headless textures keep their pixels on the CPU side for the software renderer
+    if (!tex->getGLId() && !scene->getMemManager()->isHeadless())
         tex->createInGL(scene->getMemManager());
-    scene->addTexture(tex);
+    scene->addTexture(tex,memTag);
     tex = NULL;
 }
 
@@ -685,6 +740,8 @@ void RemTextureReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,Wh
         delete tex;
     }
     pthread_mutex_unlock(&scene->textureLock);
+
+    scene->getMemTracker()->removeObject(MemTrackTexture,texture);
 }
     
 AddDrawableReq::~AddDrawableReq()
@@ -714,11 +771,20 @@ void AddDrawableReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,W
 
     DrawableRef drawRef(drawable);
     scene->addDrawable(drawRef);
+    // Size it before GL setup tosses the arrays
+    if (memTag >= 0)
+        scene->getMemTracker()->addObject(MemTrackDrawable,drawable->getId(),memTag,drawable->getMemSize());
+    else
+        scene->getMemTracker()->addObject(MemTrackDrawable,drawable->getId(),drawable->getName(),drawable->getMemLabel(),drawable->getMemSize());
     
     // Initialize any OpenGL foo
-    WhirlyKitGLSetupInfo setupInfo;
-    setupInfo.minZres = view->calcZbufferRes();
-    drawable->setupGL(&setupInfo,scene->getMemManager());
+    // Headless drawables keep their data arrays around for the software renderer
+    if (!scene->getMemManager()->isHeadless())
+    {
+        WhirlyKitGLSetupInfo setupInfo;
+        setupInfo.minZres = view->calcZbufferRes();
+        drawable->setupGL(&setupInfo,scene->getMemManager());
+    }
     
     drawable->updateRenderer(renderer);
         
@@ -733,6 +799,8 @@ void RemDrawableReq::execute(Scene *scene,WhirlyKit::SceneRendererES *renderer,W
     if (it != scene->drawables.end())
     {
         renderer->removeContinuousRenderRequest((*it)->getId());
+        scene->animator.removeDrawable((*it)->getId());
+        scene->getMemTracker()->removeObject(MemTrackDrawable,(*it)->getId());
         // Teardown OpenGL foo
         (*it)->teardownGL(scene->getMemManager());
 
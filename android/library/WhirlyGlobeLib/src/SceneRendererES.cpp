@@ -174,7 +174,7 @@ void RemRenderTargetReq::execute(Scene *scene,WhirlyKit::SceneRendererES *render
     
 RendererFrameInfo::RendererFrameInfo()
     : oglVersion(0), sceneRenderer(NULL), theView(NULL), scene(NULL), frameLen(0), currentTime(0),
-    heightAboveSurface(0), screenSizeInDisplayCoords(0,0), program(NULL), stateOpt(NULL)
+    heightAboveSurface(0), screenSizeInDisplayCoords(0,0), program(NULL), stateOpt(NULL), animState(NULL)
     // Note: Porting
 //,lights(NULL)
 {
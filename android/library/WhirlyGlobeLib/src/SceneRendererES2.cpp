@@ -187,7 +187,8 @@ void SceneRendererES2::processScene()
 
 bool SceneRendererES2::hasChanges()
 {
-  return scene->hasChanges(TimeGetCurrent()) || viewDidChange() || !contRenderRequests.empty();
+  TimeInterval now = TimeGetCurrent();
+  return scene->hasChanges(now) || viewDidChange() || !contRenderRequests.empty() || scene->getAnimator()->hasChanges(now);
 }
 
 // Make the screen a bit bigger for testing
@@ -363,6 +364,11 @@ void SceneRendererES2::render()
 		// Or skip it if we don't acquire the lock
 		scene->processChanges(theView,this,lastDraw);
         
+        // Work out the animated values once for everything
+        DrawableAnimator *animator = scene->getAnimator();
+        if (!animator->empty())
+            animator->evaluate(baseFrameInfo.currentTime);
+        
         if (perfInterval > 0)
             perfTimer.stopTiming("Scene processing");
         
@@ -605,6 +611,7 @@ void SceneRendererES2::render()
                 
             // Run any tweakers right here
             drawContain.drawable->runTweakers(&baseFrameInfo);
+            baseFrameInfo.animState = animator->empty() ? NULL : animator->stateForDrawable(drawContain.drawable);
                         
             // Draw using the given program
             drawContain.drawable->draw(&baseFrameInfo,scene);
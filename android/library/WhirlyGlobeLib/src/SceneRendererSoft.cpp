@@ -0,0 +1,867 @@
+/*
+ *  SceneRendererSoft.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import "Platform.h"
+#import "SceneRendererSoft.h"
+#import "BasicDrawable.h"
+#import "BillboardDrawable.h"
+#import "ScreenSpaceDrawable.h"
+#import "WideVectorDrawable.h"
+#import "DynamicTextureAtlas.h"
+#import "Texture.h"
+#import "GlobeView.h"
+#import "MaplyView.h"
+#import "WhirlyKitLog.h"
+
+using namespace Eigen;
+using namespace WhirlyKit;
+
+namespace WhirlyKit
+{
+
+class SoftDrawableContainer
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    SoftDrawableContainer(Drawable *draw) : drawable(draw) { mvpMat = Matrix4d::Identity(); mvMat = Matrix4d::Identity();  mvNormalMat = Matrix4d::Identity(); }
+    SoftDrawableContainer(Drawable *draw,Matrix4d mvpMat,Matrix4d mvMat,Matrix4d mvNormalMat) : drawable(draw), mvpMat(mvpMat), mvMat(mvMat), mvNormalMat(mvNormalMat) { }
+
+    Drawable *drawable;
+    Matrix4d mvpMat,mvMat,mvNormalMat;
+};
+
+typedef std::vector<SoftDrawableContainer,Eigen::aligned_allocator<SoftDrawableContainer> > SoftDrawList;
+
+// Same ordering as the OpenGL ES2 renderer
+class SoftDrawListSortStruct
+{
+public:
+    SoftDrawListSortStruct(bool useAlpha,bool useZBuffer,WhirlyKit::RendererFrameInfo *frameInfo) : useAlpha(useAlpha), useZBuffer(useZBuffer), frameInfo(frameInfo)
+    {
+    }
+    bool operator()(const SoftDrawableContainer &conA, const SoftDrawableContainer &conB)
+    {
+        Drawable *a = conA.drawable;
+        Drawable *b = conB.drawable;
+        if (useAlpha)
+            if (a->hasAlpha(frameInfo) != b->hasAlpha(frameInfo))
+                return !a->hasAlpha(frameInfo);
+
+        if (a->getDrawPriority() == b->getDrawPriority())
+        {
+            if (useZBuffer)
+            {
+                bool bufferA = a->getRequestZBuffer();
+                bool bufferB = b->getRequestZBuffer();
+                if (bufferA != bufferB)
+                    return !bufferA;
+            }
+        }
+
+        return a->getDrawPriority() < b->getDrawPriority();
+    }
+
+    bool useAlpha,useZBuffer;
+    WhirlyKit::RendererFrameInfo *frameInfo;
+};
+
+// Pull a vertex attribute out as a 4 component float, falling back on the default
+static Vector4f SoftAttrValue(VertexAttribute *attr,int which)
+{
+    if (!attr)
+        return Vector4f(0,0,0,0);
+
+    bool hasData = which < attr->numElements();
+    void *addr = hasData ? attr->addressForElement(which) : NULL;
+    switch (attr->dataType)
+    {
+        case BDFloat4Type:
+        {
+            const float *vals = hasData ? (const float *)addr : attr->defaultData.vec4;
+            return Vector4f(vals[0],vals[1],vals[2],vals[3]);
+        }
+        case BDFloat3Type:
+        {
+            const float *vals = hasData ? (const float *)addr : attr->defaultData.vec3;
+            return Vector4f(vals[0],vals[1],vals[2],0.0);
+        }
+        case BDFloat2Type:
+        {
+            const float *vals = hasData ? (const float *)addr : attr->defaultData.vec2;
+            return Vector4f(vals[0],vals[1],0.0,0.0);
+        }
+        case BDFloatType:
+            return Vector4f(hasData ? *(const float *)addr : attr->defaultData.floatVal,0.0,0.0,0.0);
+        case BDChar4Type:
+        {
+            const unsigned char *vals = hasData ? (const unsigned char *)addr : attr->defaultData.color;
+            return Vector4f(vals[0]/255.0,vals[1]/255.0,vals[2]/255.0,vals[3]/255.0);
+        }
+        case BDIntType:
+            return Vector4f(hasData ? *(const int *)addr : attr->defaultData.intVal,0.0,0.0,0.0);
+        default:
+            break;
+    }
+
+    return Vector4f(0,0,0,0);
+}
+
+// Time and height based fade, as BasicDrawable::drawOGL2 does it
+static float SoftCalcFade(BasicDrawable *draw,RendererFrameInfo *frameInfo)
+{
+    float fade = 1.0;
+    if (draw->fadeDown < draw->fadeUp)
+    {
+        // Heading to 1
+        if (frameInfo->currentTime < draw->fadeDown)
+            fade = 0.0;
+        else
+            if (frameInfo->currentTime > draw->fadeUp)
+                fade = 1.0;
+            else
+                fade = (frameInfo->currentTime - draw->fadeDown)/(draw->fadeUp - draw->fadeDown);
+    } else {
+        if (draw->fadeUp < draw->fadeDown)
+        {
+            // Heading to 0
+            if (frameInfo->currentTime < draw->fadeUp)
+                fade = 1.0;
+            else
+                if (frameInfo->currentTime > draw->fadeDown)
+                    fade = 0.0;
+                else
+                    fade = 1.0-(frameInfo->currentTime - draw->fadeUp)/(draw->fadeDown - draw->fadeUp);
+        }
+    }
+    // Deal with the range based fade
+    if (frameInfo->heightAboveSurface > 0.0)
+    {
+        float factor = 1.0;
+        if (draw->minVisibleFadeBand != 0.0)
+        {
+            float a = (frameInfo->heightAboveSurface - draw->minVisible)/draw->minVisibleFadeBand;
+            if (a >= 0.0 && a < 1.0)
+                factor = a;
+        }
+        if (draw->maxVisibleFadeBand != 0.0)
+        {
+            float b = (draw->maxVisible - frameInfo->heightAboveSurface)/draw->maxVisibleFadeBand;
+            if (b >= 0.0 && b < 1.0)
+                factor = b;
+        }
+
+        fade = fade * factor;
+    }
+
+    return fade;
+}
+
+}
+
+SceneRendererSoft::SceneRendererSoft(int width,int height)
+: SceneRendererES(0), numThreads(0), fixedTime(0.0), defaultMat(NULL)
+{
+    framebufferWidth = width;
+    framebufferHeight = height;
+    frameBuffer = new SoftFrameBuffer(width,height);
+
+    // Same default light as the OpenGL renderer
+    WhirlyKitDirectionalLight light;
+    light.setPos(Vector3f(0.75,0.5, -1.0));
+    light.setViewDependent(true);
+    light.setAmbient(Vector4f(0.6,0.6,0.6,1.0));
+    light.setDiffuse(Vector4f(0.5,0.5,0.5,1.0));
+    light.setSpecular(Vector4f(0,0,0,0));
+    addLight(&light);
+
+    setDefaultMaterial(new WhirlyKitMaterial());
+}
+
+SceneRendererSoft::~SceneRendererSoft()
+{
+    if (frameBuffer)
+        delete frameBuffer;
+    frameBuffer = NULL;
+    if (defaultMat)
+        delete defaultMat;
+    defaultMat = NULL;
+}
+
+void SceneRendererSoft::setScene(WhirlyKit::Scene *inScene)
+{
+    // No OpenGL, so the scene has to keep everything on the CPU side
+    if (inScene)
+        inScene->getMemManager()->setHeadless(true);
+
+    SceneRendererES::setScene(inScene);
+    scene = inScene;
+}
+
+void SceneRendererSoft::addLight(const WhirlyKitDirectionalLight *light)
+{
+    lights.push_back(*light);
+    triggerDraw = true;
+}
+
+void SceneRendererSoft::replaceLights(const std::vector<WhirlyKitDirectionalLight> &newLights)
+{
+    lights = newLights;
+    triggerDraw = true;
+}
+
+void SceneRendererSoft::setDefaultMaterial(WhirlyKitMaterial *mat)
+{
+    if (defaultMat && defaultMat != mat)
+        delete defaultMat;
+    defaultMat = mat;
+    triggerDraw = true;
+}
+
+TimeInterval SceneRendererSoft::currentTime()
+{
+    return fixedTime != 0.0 ? fixedTime : TimeGetCurrent();
+}
+
+void SceneRendererSoft::processScene()
+{
+    if (!scene)
+        return;
+
+    scene->processChanges(theView,this,currentTime());
+}
+
+bool SceneRendererSoft::hasChanges()
+{
+    return scene->hasChanges(currentTime()) || viewDidChange() || !contRenderRequests.empty();
+}
+
+RawDataRef SceneRendererSoft::snapshot()
+{
+    return frameBuffer->asRawData();
+}
+
+const SoftTexture *SceneRendererSoft::findTexture(SimpleIdentity texID)
+{
+    if (texID == EmptyIdentity)
+        return NULL;
+
+    auto it = texCache.find(texID);
+    if (it != texCache.end())
+        return it->second.pixels ? &it->second : NULL;
+
+    SoftTexture softTex;
+    TextureBase *texBase = scene->getTexture(texID);
+    if (Texture *tex = dynamic_cast<Texture *>(texBase))
+    {
+        int width = tex->getWidth(), height = tex->getHeight();
+        if (tex->texData && !tex->isCompressed() && width > 0 && height > 0)
+        {
+            RawDataRef pixData = tex->texData;
+            softTex.pixSize = 4;
+            // Single byte textures get converted the same way they would for OpenGL
+            if (tex->getFormat() == GL_ALPHA)
+            {
+                pixData = tex->processData();
+                softTex.pixSize = 1;
+                texDataCache.push_back(pixData);
+            }
+            if (pixData && pixData->getLen() >= width*height*softTex.pixSize)
+            {
+                softTex.pixels = pixData->getRawData();
+                softTex.width = width;
+                softTex.height = height;
+                softTex.wrapU = tex->getWrapU();
+                softTex.wrapV = tex->getWrapV();
+                softTex.linear = tex->getInterpType() != GL_NEAREST;
+            }
+        }
+    } else if (DynamicTexture *dynTex = dynamic_cast<DynamicTexture *>(texBase))
+    {
+        if (dynTex->getSoftData())
+        {
+            softTex.pixels = dynTex->getSoftData();
+            softTex.width = softTex.height = dynTex->getTexSize();
+            softTex.pixSize = dynTex->getFormat() == GL_ALPHA ? 1 : 4;
+            softTex.linear = dynTex->getInterpType() != GL_NEAREST;
+        }
+    }
+
+    texCache[texID] = softTex;
+    it = texCache.find(texID);
+
+    return it->second.pixels ? &it->second : NULL;
+}
+
+void SceneRendererSoft::addBasicDrawable(SoftRasterizer &raster,BasicDrawable *draw,RendererFrameInfo *frameInfo,const Matrix4d &mvpMat4d,const Matrix4d &mvMat4d,const Matrix4d &mvNormalMat4d,const SoftDrawState &baseState,bool useLights)
+{
+    if (draw->points.empty())
+        return;
+
+    Matrix4f mvpMat = Matrix4dToMatrix4f(mvpMat4d), mvMat = Matrix4dToMatrix4f(mvMat4d), mvNormalMat = Matrix4dToMatrix4f(mvNormalMat4d);
+    if (draw->clipCoords)
+        mvpMat = mvMat = mvNormalMat = Matrix4f::Identity();
+
+    float fade = SoftCalcFade(draw,frameInfo);
+    bool isTris = draw->type == GL_TRIANGLES;
+    WhirlyGlobe::GlobeView *globeView = dynamic_cast<WhirlyGlobe::GlobeView *>(theView);
+
+    SoftDrawState state = baseState;
+    state.shadeMode = SoftShadeColor;
+    int texCoordEntry = -1;
+    if (!draw->texInfo.empty() && draw->texInfo[0].texId != EmptyIdentity)
+    {
+        state.tex = findTexture(draw->texInfo[0].texId);
+        texCoordEntry = draw->texInfo[0].texCoordEntry;
+    }
+    // The line shader discards anything facing away on the globe
+    state.useExtraTest = !isTris && globeView && !draw->clipCoords;
+    int stateIdx = raster.addState(state);
+
+    VertexAttribute *colorAttr = draw->colorEntry >= 0 ? draw->vertexAttributes[draw->colorEntry] : NULL;
+    VertexAttribute *normAttr = draw->normalEntry >= 0 ? draw->vertexAttributes[draw->normalEntry] : NULL;
+    VertexAttribute *texAttr = (texCoordEntry >= 0 && texCoordEntry < draw->vertexAttributes.size()) ? draw->vertexAttributes[texCoordEntry] : NULL;
+
+    // Same lighting as the default triangle shader
+    bool lightsOn = useLights && isTris && !lights.empty();
+    Vector4f matAmbient = defaultMat ? defaultMat->getAmbient() : Vector4f(1,1,1,1);
+
+    std::vector<SoftVertex,Eigen::aligned_allocator<SoftVertex> > verts(draw->points.size());
+    for (unsigned int ii=0;ii<draw->points.size();ii++)
+    {
+        SoftVertex &vert = verts[ii];
+        const Vector3f &pt = draw->points[ii];
+        vert.pos = mvpMat * Vector4f(pt.x(),pt.y(),pt.z(),1.0);
+
+        Vector4f color = colorAttr ? SoftAttrValue(colorAttr,ii) : Vector4f(1,1,1,1);
+        Vector4f norm = SoftAttrValue(normAttr,ii);
+        if (lightsOn)
+        {
+            Vector3f ambient(0,0,0), diffuse(0,0,0);
+            for (auto &light : lights)
+            {
+                Vector3f adjNorm;
+                if (!light.getViewDependent())
+                    adjNorm = (mvpMat * Vector4f(norm.x(),norm.y(),norm.z(),0.0)).head<3>().normalized();
+                else
+                    adjNorm = Vector3f(norm.x(),norm.z(),norm.y());
+                Vector3f dir = light.getPos().normalized();
+                float ndotl = std::max(0.f,adjNorm.dot(dir));
+                ambient += light.getAmbient().head<3>();
+                diffuse += ndotl * light.getDiffuse().head<3>();
+            }
+            Vector3f rgb = ambient.cwiseProduct(matAmbient.head<3>()).cwiseProduct(color.head<3>()) + diffuse.cwiseProduct(color.head<3>());
+            vert.color = Vector4f(rgb.x(),rgb.y(),rgb.z(),color.w()) * fade;
+        } else
+            vert.color = color * fade;
+
+        if (texAttr)
+        {
+            Vector4f uv = SoftAttrValue(texAttr,ii);
+            vert.uv = Point2f(uv.x(),uv.y());
+        }
+
+        if (state.useExtraTest)
+        {
+            Vector4f mvPt = mvMat * Vector4f(pt.x(),pt.y(),pt.z(),1.0);
+            mvPt /= mvPt.w();
+            Vector4f testNorm = mvNormalMat * Vector4f(norm.x(),norm.y(),norm.z(),0.0);
+            vert.extra = -mvPt.head<3>().dot(testNorm.head<3>());
+        }
+    }
+
+    float lineWidth = draw->lineWidth;
+    switch (draw->type)
+    {
+        case GL_TRIANGLES:
+            for (auto &tri : draw->tris)
+            {
+                if (tri.verts[0] >= verts.size() || tri.verts[1] >= verts.size() || tri.verts[2] >= verts.size())
+                    continue;
+                raster.addTriangle(verts[tri.verts[0]],verts[tri.verts[1]],verts[tri.verts[2]],stateIdx);
+            }
+            break;
+        case GL_LINES:
+            for (unsigned int ii=0;ii+1<verts.size();ii+=2)
+                raster.addLine(verts[ii],verts[ii+1],lineWidth,stateIdx);
+            break;
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP:
+            for (unsigned int ii=0;ii+1<verts.size();ii++)
+                raster.addLine(verts[ii],verts[ii+1],lineWidth,stateIdx);
+            if (draw->type == GL_LINE_LOOP && verts.size() > 2)
+                raster.addLine(verts.back(),verts.front(),lineWidth,stateIdx);
+            break;
+        case GL_POINTS:
+            for (auto &vert : verts)
+                raster.addPoint(vert,lineWidth,stateIdx);
+            break;
+        default:
+            break;
+    }
+}
+
+void SceneRendererSoft::addScreenSpaceDrawable(SoftRasterizer &raster,ScreenSpaceDrawable *draw,RendererFrameInfo *frameInfo,const Matrix4d &mvpMat4d,const Matrix4d &mvMat4d,const Matrix4d &mvNormalMat4d,const SoftDrawState &baseState)
+{
+    if (draw->points.empty() || draw->getOffsetIndex() < 0)
+        return;
+
+    Matrix4f mvpMat = Matrix4dToMatrix4f(mvpMat4d), mvMat = Matrix4dToMatrix4f(mvMat4d), mvNormalMat = Matrix4dToMatrix4f(mvNormalMat4d);
+    bool globeMode = dynamic_cast<WhirlyGlobe::GlobeView *>(theView) != NULL;
+    float fade = SoftCalcFade(draw,frameInfo);
+    Point2f scale(2.f/framebufferWidth,2.f/framebufferHeight);
+    float motionTime = frameInfo->currentTime - draw->getStartTime();
+
+    SoftDrawState state = baseState;
+    state.shadeMode = SoftShadeColor;
+    int texCoordEntry = -1;
+    if (!draw->texInfo.empty() && draw->texInfo[0].texId != EmptyIdentity)
+    {
+        state.tex = findTexture(draw->texInfo[0].texId);
+        texCoordEntry = draw->texInfo[0].texCoordEntry;
+    }
+    int stateIdx = raster.addState(state);
+
+    VertexAttribute *colorAttr = draw->colorEntry >= 0 ? draw->vertexAttributes[draw->colorEntry] : NULL;
+    VertexAttribute *normAttr = draw->normalEntry >= 0 ? draw->vertexAttributes[draw->normalEntry] : NULL;
+    VertexAttribute *texAttr = (texCoordEntry >= 0 && texCoordEntry < draw->vertexAttributes.size()) ? draw->vertexAttributes[texCoordEntry] : NULL;
+    VertexAttribute *offsetAttr = draw->vertexAttributes[draw->getOffsetIndex()];
+    VertexAttribute *rotAttr = draw->getRotIndex() >= 0 ? draw->vertexAttributes[draw->getRotIndex()] : NULL;
+    VertexAttribute *dirAttr = draw->getDirIndex() >= 0 ? draw->vertexAttributes[draw->getDirIndex()] : NULL;
+
+    std::vector<SoftVertex,Eigen::aligned_allocator<SoftVertex> > verts(draw->points.size());
+    std::vector<bool> visible(draw->points.size(),true);
+    for (unsigned int ii=0;ii<draw->points.size();ii++)
+    {
+        SoftVertex &vert = verts[ii];
+        Vector3f pos = draw->points[ii];
+        if (dirAttr)
+            pos += motionTime * SoftAttrValue(dirAttr,ii).head<3>();
+        Vector4f pos4(pos.x(),pos.y(),pos.z(),1.0);
+
+        // Make sure the object is facing the user
+        if (globeMode)
+        {
+            Vector4f pt = mvMat * pos4;
+            pt /= pt.w();
+            Vector4f norm = SoftAttrValue(normAttr,ii);
+            Vector4f testNorm = mvNormalMat * Vector4f(norm.x(),norm.y(),norm.z(),0.0);
+            float dotRes = -pt.head<3>().dot(testNorm.head<3>());
+            visible[ii] = dotRes > 0.0 && pt.z() <= 0.0;
+        }
+
+        Vector4f screenPt = mvpMat * pos4;
+        screenPt /= screenPt.w();
+
+        Vector4f offset = SoftAttrValue(offsetAttr,ii);
+        Vector2f screenOffset(offset.x(),offset.y());
+        if (rotAttr)
+        {
+            Vector4f rot = SoftAttrValue(rotAttr,ii);
+            Vector4f projRot = mvNormalMat * Vector4f(rot.x(),rot.y(),rot.z(),0.0);
+            Vector2f rotY = Vector2f(projRot.x(),projRot.y()).normalized();
+            Vector2f rotX(rotY.y(),-rotY.x());
+            screenOffset = offset.x()*rotX + offset.y()*rotY;
+        }
+        vert.pos = Vector4f(screenPt.x() + screenOffset.x()*scale.x(),screenPt.y() + screenOffset.y()*scale.y(),0.0,1.0);
+
+        vert.color = (colorAttr ? SoftAttrValue(colorAttr,ii) : Vector4f(1,1,1,1)) * fade;
+        if (texAttr)
+        {
+            Vector4f uv = SoftAttrValue(texAttr,ii);
+            vert.uv = Point2f(uv.x(),uv.y());
+        }
+    }
+
+    for (auto &tri : draw->tris)
+    {
+        if (tri.verts[0] >= verts.size() || tri.verts[1] >= verts.size() || tri.verts[2] >= verts.size())
+            continue;
+        // The shader collapses these to a point
+        if (!visible[tri.verts[0]] || !visible[tri.verts[1]] || !visible[tri.verts[2]])
+            continue;
+        raster.addTriangle(verts[tri.verts[0]],verts[tri.verts[1]],verts[tri.verts[2]],stateIdx);
+    }
+}
+
+void SceneRendererSoft::addWideVectorDrawable(SoftRasterizer &raster,WideVectorDrawable *draw,RendererFrameInfo *frameInfo,const Matrix4d &mvpMat4d,const Matrix4d &mvMat4d,const Matrix4d &mvNormalMat4d,const SoftDrawState &baseState)
+{
+    if (draw->points.empty())
+        return;
+
+    Matrix4f mvpMat = Matrix4dToMatrix4f(mvpMat4d), mvMat = Matrix4dToMatrix4f(mvMat4d), mvNormalMat = Matrix4dToMatrix4f(mvNormalMat4d);
+
+    // Uniforms, as WideVectorDrawable::draw sets them up
+    float scale = std::max(framebufferWidth,framebufferHeight);
+    float screenSize = frameInfo->screenSizeInDisplayCoords.x();
+    float pixDispSize = std::min(frameInfo->screenSizeInDisplayCoords.x(),frameInfo->screenSizeInDisplayCoords.y()) / scale;
+    float w2,realW2,realOffset;
+    double realWidth;
+    if (draw->getRealWorldWidth(realWidth))
+    {
+        w2 = realWidth / pixDispSize;
+        realW2 = realWidth;
+        realOffset = draw->getOffset();
+    } else {
+        w2 = draw->getLineWidth();
+        realW2 = pixDispSize * draw->getLineWidth();
+        realOffset = pixDispSize * draw->getOffset();
+    }
+    float texScale = scale/(screenSize*draw->getTexRepeat());
+    RGBAColor color = draw->getColor();
+
+    SoftDrawState state = baseState;
+    state.shadeMode = SoftShadeWideVector;
+    state.w2 = w2;
+    state.edge = draw->getEdgeSize();
+    state.constColor = Vector4f(color.r/255.0,color.g/255.0,color.b/255.0,color.a/255.0);
+    state.useExtraTest = draw->getGlobeMode();
+    if (!draw->texInfo.empty() && draw->texInfo[0].texId != EmptyIdentity)
+        state.tex = findTexture(draw->texInfo[0].texId);
+    int stateIdx = raster.addState(state);
+
+    VertexAttribute *p1Attr = draw->vertexAttributes[draw->get_p1_index()];
+    VertexAttribute *n0Attr = draw->vertexAttributes[draw->get_n0_index()];
+    VertexAttribute *c0Attr = draw->vertexAttributes[draw->get_c0_index()];
+    VertexAttribute *texAttr = draw->vertexAttributes[draw->get_tex_index()];
+    VertexAttribute *offAttr = draw->vertexAttributes[draw->get_offset_index()];
+    VertexAttribute *normAttr = draw->normalEntry >= 0 ? draw->vertexAttributes[draw->normalEntry] : NULL;
+
+    std::vector<SoftVertex,Eigen::aligned_allocator<SoftVertex> > verts(draw->points.size());
+    for (unsigned int ii=0;ii<draw->points.size();ii++)
+    {
+        SoftVertex &vert = verts[ii];
+        const Vector3f &pos = draw->points[ii];
+        Vector3f p1 = SoftAttrValue(p1Attr,ii).head<3>();
+        Vector3f n0 = SoftAttrValue(n0Attr,ii).head<3>();
+        float c0 = SoftAttrValue(c0Attr,ii).x();
+        Vector4f texInfo = SoftAttrValue(texAttr,ii);
+        Vector3f off = SoftAttrValue(offAttr,ii).head<3>();
+
+        // Position along the line
+        float t0 = std::min(std::max(c0 * realW2,0.f),1.f);
+        Vector3f realPos = (p1 - pos) * t0 + n0 * realW2 + off * realOffset + pos;
+        float texPos = ((texInfo.z() - texInfo.y()) * t0 + texInfo.y() + texInfo.w() * realW2) * texScale;
+        vert.uv = Point2f(texInfo.x(),texPos);
+
+        Vector4f screenPos = mvpMat * Vector4f(realPos.x(),realPos.y(),realPos.z(),1.0);
+        screenPos /= screenPos.w();
+        vert.pos = Vector4f(screenPos.x(),screenPos.y(),0.0,1.0);
+
+        if (state.useExtraTest)
+        {
+            Vector4f pt = mvMat * Vector4f(pos.x(),pos.y(),pos.z(),1.0);
+            pt /= pt.w();
+            Vector4f norm = SoftAttrValue(normAttr,ii);
+            Vector4f testNorm = mvNormalMat * Vector4f(norm.x(),norm.y(),norm.z(),0.0);
+            vert.extra = -pt.head<3>().dot(testNorm.head<3>());
+        }
+    }
+
+    for (auto &tri : draw->tris)
+    {
+        if (tri.verts[0] >= verts.size() || tri.verts[1] >= verts.size() || tri.verts[2] >= verts.size())
+            continue;
+        raster.addTriangle(verts[tri.verts[0]],verts[tri.verts[1]],verts[tri.verts[2]],stateIdx);
+    }
+}
+
+void SceneRendererSoft::render()
+{
+    if (!scene || !theView || !frameBuffer)
+        return;
+
+    frameCount++;
+
+    if (framebufferWidth <= 0 || framebufferHeight <= 0)
+        return;
+
+    theView->animate();
+
+    TimeInterval now = currentTime();
+    lastDraw = now;
+
+    if (perfInterval > 0)
+        perfTimer.startTiming("Render Frame");
+
+    // See if we're dealing with a globe or map view
+    WhirlyGlobe::GlobeView *globeView = dynamic_cast<WhirlyGlobe::GlobeView *>(theView);
+    Maply::MapView *mapView = dynamic_cast<Maply::MapView *>(theView);
+
+    // Get the model and view matrices
+    Eigen::Matrix4d modelTrans4d = theView->calcModelMatrix();
+    Eigen::Matrix4f modelTrans = Matrix4dToMatrix4f(modelTrans4d);
+    Eigen::Matrix4d viewTrans4d = theView->calcViewMatrix();
+    Eigen::Matrix4f viewTrans = Matrix4dToMatrix4f(viewTrans4d);
+
+    // Set up a projection matrix
+    Point2f frameSize(framebufferWidth,framebufferHeight);
+    Eigen::Matrix4d projMat4d = theView->calcProjectionMatrix(frameSize,0.0);
+
+    Eigen::Matrix4f projMat = Matrix4dToMatrix4f(projMat4d);
+    Eigen::Matrix4f modelAndViewMat = viewTrans * modelTrans;
+    Eigen::Matrix4d modelAndViewMat4d = viewTrans4d * modelTrans4d;
+    Eigen::Matrix4f mvpMat = projMat * (modelAndViewMat);
+    Eigen::Matrix4f mvpNormalMat4f = mvpMat.inverse().transpose();
+    Eigen::Matrix4d modelAndViewNormalMat4d = modelAndViewMat4d.inverse().transpose();
+    Eigen::Matrix4f modelAndViewNormalMat = Matrix4dToMatrix4f(modelAndViewNormalMat4d);
+
+    WhirlyKit::RendererFrameInfo baseFrameInfo;
+    // Generators build their drawables as they would for ES2
+    baseFrameInfo.oglVersion = 2;
+    baseFrameInfo.sceneRenderer = this;
+    baseFrameInfo.theView = theView;
+    baseFrameInfo.viewTrans = viewTrans;
+    baseFrameInfo.viewTrans4d = viewTrans4d;
+    baseFrameInfo.modelTrans = modelTrans;
+    baseFrameInfo.modelTrans4d = modelTrans4d;
+    baseFrameInfo.scene = scene;
+    baseFrameInfo.currentTime = now;
+    baseFrameInfo.projMat = projMat;
+    baseFrameInfo.projMat4d = projMat4d;
+    baseFrameInfo.mvpMat = mvpMat;
+    baseFrameInfo.mvpNormalMat = mvpNormalMat4f;
+    baseFrameInfo.viewModelNormalMat = modelAndViewNormalMat;
+    baseFrameInfo.viewAndModelMat = modelAndViewMat;
+    baseFrameInfo.viewAndModelMat4d = modelAndViewMat4d;
+    theView->getOffsetMatrices(baseFrameInfo.offsetMatrices, frameSize);
+    baseFrameInfo.screenSizeInDisplayCoords = theView->screenSizeInDisplayCoords(frameSize);
+    baseFrameInfo.lights = &lights;
+    baseFrameInfo.stateOpt = NULL;
+    baseFrameInfo.program = NULL;
+
+    // We need a reverse of the eye vector in model space
+    Eigen::Matrix4f modelTransInv = modelTrans.inverse();
+    Vector4f eyeVec4 = modelTransInv * Vector4f(0,0,1,0);
+    baseFrameInfo.eyeVec = Vector3f(eyeVec4.x(),eyeVec4.y(),eyeVec4.z());
+    Eigen::Matrix4f fullTransInv = modelAndViewMat.inverse();
+    Vector4f fullEyeVec4 = fullTransInv * Vector4f(0,0,1,0);
+    baseFrameInfo.fullEyeVec = -Vector3f(fullEyeVec4.x(),fullEyeVec4.y(),fullEyeVec4.z());
+    Vector4d eyeVec4d = modelTrans4d.inverse() * Vector4d(0,0,1,0.0);
+    baseFrameInfo.heightAboveSurface = 0.0;
+    if (globeView)
+        baseFrameInfo.heightAboveSurface = globeView->heightAboveSurface();
+    baseFrameInfo.eyePos = Vector3d(eyeVec4d.x(),eyeVec4d.y(),eyeVec4d.z()) * (1.0+baseFrameInfo.heightAboveSurface);
+
+    // Merge any outstanding changes into the scenegraph
+    scene->processChanges(theView,this,now);
+
+    // Calculate a good center point for the generated drawables
+    Point2f screenPt(frameSize.x()/2.0, frameSize.y()/2.0);
+    Point3d hit;
+    baseFrameInfo.dispCenter = Point3d(0,0,0);
+    if (globeView)
+    {
+        if (globeView->pointOnSphereFromScreen(screenPt, &modelAndViewMat4d, frameSize, &hit, true))
+            baseFrameInfo.dispCenter = hit;
+    } else if (mapView)
+    {
+        if (mapView->pointOnPlaneFromScreen(screenPt,&modelAndViewMat4d,frameSize,&hit,false))
+            baseFrameInfo.dispCenter = hit;
+    }
+
+    // Work through the available offset matrices (only 1 if we're not wrapping)
+    std::vector<Matrix4d> &offsetMats = baseFrameInfo.offsetMatrices;
+    SoftDrawList drawList;
+    std::vector<DrawableRef> screenDrawables;
+    std::vector<DrawableRef> generatedDrawables;
+    for (unsigned int off=0;off<offsetMats.size();off++)
+    {
+        WhirlyKit::RendererFrameInfo offFrameInfo(baseFrameInfo);
+        Matrix4d offModelAndViewMat4d = viewTrans4d * offsetMats[off] * modelTrans4d;
+        Matrix4d thisMvpMat = projMat4d * offModelAndViewMat4d;
+        Matrix4d offNormalMat4d = offModelAndViewMat4d.inverse().transpose();
+        offFrameInfo.mvpMat = Matrix4dToMatrix4f(thisMvpMat);
+        offFrameInfo.mvpNormalMat = Matrix4dToMatrix4f(thisMvpMat.inverse().transpose());
+        offFrameInfo.viewModelNormalMat = Matrix4dToMatrix4f(offNormalMat4d);
+        offFrameInfo.viewAndModelMat4d = offModelAndViewMat4d;
+        offFrameInfo.viewAndModelMat = Matrix4dToMatrix4f(offModelAndViewMat4d);
+        offFrameInfo.pvMat4d = projMat4d * viewTrans4d * offsetMats[off];
+        offFrameInfo.pvMat = Matrix4dToMatrix4f(offFrameInfo.pvMat4d);
+
+        // No culling here, we just check everything
+        const DrawableRefSet &rawDrawables = scene->getDrawables();
+        for (DrawableRefSet::const_iterator it = rawDrawables.begin(); it != rawDrawables.end(); ++it)
+        {
+            Drawable *theDrawable = it->get();
+            if (theDrawable->isOn(&offFrameInfo))
+            {
+                const Matrix4d *localMat = theDrawable->getMatrix();
+                if (localMat)
+                {
+                    Eigen::Matrix4d newMvMat = viewTrans4d * offsetMats[off] * modelTrans4d * (*localMat);
+                    Eigen::Matrix4d newMvpMat = projMat4d * newMvMat;
+                    Eigen::Matrix4d newMvNormalMat = newMvMat.inverse().transpose();
+                    drawList.push_back(SoftDrawableContainer(theDrawable,newMvpMat,newMvMat,newMvNormalMat));
+                } else
+                    drawList.push_back(SoftDrawableContainer(theDrawable,thisMvpMat,offModelAndViewMat4d,offNormalMat4d));
+            }
+        }
+
+        // Run the generators only once, they have to be aware of multiple offset matrices
+        if (off == offsetMats.size()-1)
+        {
+            const GeneratorSet *generators = scene->getGenerators();
+            for (GeneratorSet::iterator it = generators->begin();
+                 it != generators->end(); ++it)
+                (*it)->generateDrawables(&baseFrameInfo, generatedDrawables, screenDrawables);
+
+            for (unsigned int ii=0;ii<generatedDrawables.size();ii++)
+            {
+                Drawable *theDrawable = generatedDrawables[ii].get();
+                if (theDrawable)
+                    drawList.push_back(SoftDrawableContainer(theDrawable,thisMvpMat,offModelAndViewMat4d,offNormalMat4d));
+            }
+            bool sortLinesToEnd = (zBufferMode == zBufferOffDefault);
+            std::sort(drawList.begin(),drawList.end(),SoftDrawListSortStruct(sortAlphaToEnd,sortLinesToEnd,&baseFrameInfo));
+        }
+    }
+
+    if (perfInterval > 0)
+        perfTimer.startTiming("Draw Execution");
+
+    texCache.clear();
+    texDataCache.clear();
+    frameBuffer->clear(clearColor);
+    SoftRasterizer raster(frameBuffer,numThreads);
+
+    // Work out the depth state the same way the OpenGL renderer does
+    SoftDrawState depthState;
+    switch (zBufferMode)
+    {
+        case zBufferOn:
+            depthState.depthTest = true;
+            depthState.depthWrite = true;
+            break;
+        case zBufferOff:
+            depthState.depthTest = false;
+            depthState.depthWrite = false;
+            break;
+        case zBufferOffDefault:
+            depthState.depthTest = false;
+            depthState.depthWrite = true;
+            break;
+    }
+
+    int numDrawn = 0;
+    bool depthTestOn = depthState.depthTest;
+    for (unsigned int ii=0;ii<drawList.size();ii++)
+    {
+        SoftDrawableContainer &drawContain = drawList[ii];
+        Drawable *drawable = drawContain.drawable;
+
+        // Only the screen is a target for us
+        if (drawable->getRenderTarget() != EmptyIdentity)
+            continue;
+
+        SoftDrawState state = depthState;
+        // The first time we hit an explicitly alpha drawable turn off the depth buffer
+        if (depthBufferOffForAlpha && zBufferMode != zBufferOffDefault && depthTestOn && drawable->hasAlpha(&baseFrameInfo))
+            depthTestOn = false;
+        state.depthTest = depthTestOn;
+        // For this mode we turn the z buffer off until we get a request to turn it on
+        if (zBufferMode == zBufferOffDefault)
+            state.depthTest = drawable->getRequestZBuffer();
+        // If we're drawing lines or points we don't want to update the z buffer
+        if (zBufferMode != zBufferOff)
+            state.depthWrite = drawable->getWriteZbuffer();
+
+        baseFrameInfo.mvpMat = Matrix4dToMatrix4f(drawContain.mvpMat);
+        baseFrameInfo.viewAndModelMat = Matrix4dToMatrix4f(drawContain.mvMat);
+        baseFrameInfo.viewModelNormalMat = Matrix4dToMatrix4f(drawContain.mvNormalMat);
+
+        // Note: Tweakers can't run without a program, so they're skipped
+        if (ScreenSpaceDrawable *ssDraw = dynamic_cast<ScreenSpaceDrawable *>(drawable))
+            addScreenSpaceDrawable(raster,ssDraw,&baseFrameInfo,drawContain.mvpMat,drawContain.mvMat,drawContain.mvNormalMat,state);
+        else if (WideVectorDrawable *wideDraw = dynamic_cast<WideVectorDrawable *>(drawable))
+            addWideVectorDrawable(raster,wideDraw,&baseFrameInfo,drawContain.mvpMat,drawContain.mvMat,drawContain.mvNormalMat,state);
+        else if (dynamic_cast<BillboardDrawable *>(drawable) || dynamic_cast<BillboardInstanceDrawable *>(drawable))
+            continue;
+        else if (BasicDrawable *basicDraw = dynamic_cast<BasicDrawable *>(drawable))
+            addBasicDrawable(raster,basicDraw,&baseFrameInfo,drawContain.mvpMat,drawContain.mvMat,drawContain.mvNormalMat,state,true);
+        else
+            continue;
+
+        numDrawn++;
+    }
+    raster.flush();
+
+    // Now for the 2D display
+    if (!screenDrawables.empty())
+    {
+        raster.clear();
+        drawList.clear();
+        for (unsigned int ii=0;ii<screenDrawables.size();ii++)
+        {
+            Drawable *theDrawable = screenDrawables[ii].get();
+            if (theDrawable)
+                drawList.push_back(SoftDrawableContainer(theDrawable));
+        }
+        std::sort(drawList.begin(),drawList.end(),SoftDrawListSortStruct(false,false,&baseFrameInfo));
+
+        // Build an orthographic projection
+        // We flip the vertical axis and spread the window out (0,0)->(width,height)
+        Eigen::Matrix4d orthoMat = Matrix4d::Identity();
+        Vector3d delta(framebufferWidth,-framebufferHeight,2.0);
+        orthoMat(0,0) = 2.0 / delta.x();
+        orthoMat(0,3) = -(framebufferWidth) / delta.x();
+        orthoMat(1,1) = 2.0 / delta.y();
+        orthoMat(1,3) = -framebufferHeight / delta.y();
+        orthoMat(2,2) = -2.0 / delta.z();
+        orthoMat(2,3) = 0.0;
+        baseFrameInfo.mvpMat = Matrix4dToMatrix4f(orthoMat);
+
+        SoftDrawState state;
+        for (unsigned int ii=0;ii<drawList.size();ii++)
+        {
+            BasicDrawable *basicDraw = dynamic_cast<BasicDrawable *>(drawList[ii].drawable);
+            if (basicDraw && basicDraw->isOn(&baseFrameInfo))
+            {
+                addBasicDrawable(raster,basicDraw,&baseFrameInfo,orthoMat,Matrix4d::Identity(),Matrix4d::Identity(),state,false);
+                numDrawn++;
+            }
+        }
+        raster.flush();
+    }
+
+    numDrawables = numDrawn;
+
+    if (perfInterval > 0)
+    {
+        perfTimer.addCount("Drawables drawn", numDrawn);
+        perfTimer.stopTiming("Draw Execution");
+        perfTimer.stopTiming("Render Frame");
+    }
+
+    // Update the frames per sec
+    if (perfInterval > 0 && frameCount > perfInterval)
+    {
+        TimeInterval now = TimeGetCurrent();
+        TimeInterval howLong =  now - frameCountStart;
+        framesPerSec = frameCount / howLong;
+        lastFrameRate = framesPerSec;
+        frameCountStart = now;
+        frameCount = 0;
+
+        perfTimer.report("---Software Rendering Performance---");
+        perfTimer.log();
+        perfTimer.clear();
+    }
+}
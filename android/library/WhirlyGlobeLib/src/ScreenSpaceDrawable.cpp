@@ -92,6 +92,19 @@ void ScreenSpaceDrawable::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *sc
         if (motion)
             frameInfo->program->setUniform("u_time", (float)(frameInfo->currentTime - startTime));
         frameInfo->program->setUniform("u_activerot", (rotIndex >= 0 ? 1 : 0));
+        
+        // Animated scale, rotation and offset all happen around the anchor point
+        Eigen::Vector4f animXform(1.0,0.0,0.0,1.0);
+        Point2f animOffset(0.0,0.0);
+        if (frameInfo->animState)
+        {
+            const DrawableAnimState *animState = frameInfo->animState;
+            float cosRot = cos(animState->rotation), sinRot = sin(animState->rotation);
+            animXform = Eigen::Vector4f(cosRot*animState->scale.x(),sinRot*animState->scale.x(),-sinRot*animState->scale.y(),cosRot*animState->scale.y());
+            animOffset = animState->offset * frameInfo->sceneRenderer->getScale();
+        }
+        frameInfo->program->setUniform("u_animXform", animXform);
+        frameInfo->program->setUniform("u_animOffset", animOffset);
     }
 
     BasicDrawable::draw(frameInfo,scene);
@@ -102,8 +115,11 @@ static const char *vertexShaderTri =
 "uniform mat4  u_mvMatrix;"
 "uniform mat4  u_mvNormalMatrix;"
 "uniform float u_fade;"
+"uniform vec4  u_tint;"
 "uniform vec2  u_scale;"
 "uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
 ""
 "attribute vec3 a_position;"
 "attribute vec3 a_normal;"
@@ -118,7 +134,7 @@ static const char *vertexShaderTri =
 "void main()"
 "{"
 "   v_texCoord = a_texCoord0;"
-"   v_color = a_color * u_fade;"
+"   v_color = a_color * u_fade * u_tint;"
 ""
 // Convert from model space into display space
 "   vec4 pt = u_mvMatrix * vec4(a_position,1.0);"
@@ -134,6 +150,7 @@ static const char *vertexShaderTri =
 "   vec2 rotY = normalize(projRot.xy);"
 "   vec2 rotX = vec2(rotY.y,-rotY.x);"
 "   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
     "   gl_Position = (dot_res > 0.0 && pt.z <= 0.0) ? vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0) : vec4(0.0,0.0,0.0,0.0);"
 //    "   gl_Position = vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0);"
 "}"
@@ -144,8 +161,11 @@ static const char *vertexShaderTri2d =
 "uniform mat4  u_mvMatrix;"
 "uniform mat4  u_mvNormalMatrix;"
 "uniform float u_fade;"
+"uniform vec4  u_tint;"
 "uniform vec2  u_scale;"
 "uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
 ""
 "attribute vec3 a_position;"
 "attribute vec3 a_normal;"
@@ -160,7 +180,7 @@ static const char *vertexShaderTri2d =
 "void main()"
 "{"
 "   v_texCoord = a_texCoord0;"
-"   v_color = a_color * u_fade;"
+"   v_color = a_color * u_fade * u_tint;"
 ""
 // Convert from model space into display space
 "   vec4 pt = u_mvMatrix * vec4(a_position,1.0);"
@@ -173,6 +193,7 @@ static const char *vertexShaderTri2d =
 "   vec2 rotY = normalize(projRot.xy);"
 "   vec2 rotX = vec2(rotY.y,-rotY.x);"
 "   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
 "   gl_Position = vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0);"
 "}"
 ;
@@ -182,9 +203,12 @@ static const char *vertexShaderMotionTri =
 "uniform mat4  u_mvMatrix;"
 "uniform mat4  u_mvNormalMatrix;"
 "uniform float u_fade;"
+"uniform vec4  u_tint;"
 "uniform vec2  u_scale;"
 "uniform float u_time;"
 "uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
 ""
 "attribute vec3 a_position;"
 "attribute vec3 a_dir;"
@@ -200,7 +224,7 @@ static const char *vertexShaderMotionTri =
 "void main()"
 "{"
 "   v_texCoord = a_texCoord0;"
-"   v_color = a_color * u_fade;"
+"   v_color = a_color * u_fade * u_tint;"
 ""
 // Position can be modified over time
 "   vec3 thePos = a_position + u_time * a_dir;"
@@ -218,6 +242,7 @@ static const char *vertexShaderMotionTri =
 "   vec2 rotY = normalize(projRot.xy);"
 "   vec2 rotX = vec2(rotY.y,-rotY.x);"
 "   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
 "   gl_Position = (dot_res > 0.0 && pt.z <= 0.0) ? vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0) : vec4(0.0,0.0,0.0,0.0);"
 "}"
 ;
@@ -227,9 +252,12 @@ static const char *vertexShader2dMotionTri =
 "uniform mat4  u_mvMatrix;"
 "uniform mat4  u_mvNormalMatrix;"
 "uniform float u_fade;"
+"uniform vec4  u_tint;"
 "uniform vec2  u_scale;"
 "uniform float u_time;"
 "uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
 ""
 "attribute vec3 a_position;"
 "attribute vec3 a_dir;"
@@ -245,7 +273,7 @@ static const char *vertexShader2dMotionTri =
 "void main()"
 "{"
 "   v_texCoord = a_texCoord0;"
-"   v_color = a_color * u_fade;"
+"   v_color = a_color * u_fade * u_tint;"
 ""
 // Position can be modified over time
 "   vec3 thePos = a_position + u_time * a_dir;"
@@ -260,6 +288,7 @@ static const char *vertexShader2dMotionTri =
 "   vec2 rotY = normalize(projRot.xy);"
 "   vec2 rotX = vec2(rotY.y,-rotY.x);"
 "   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
 "   gl_Position = vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0);"
 "}"
 ;
@@ -280,6 +309,218 @@ static const char *fragmentShaderTri =
 "}"
 ;
 
+// SDF icons pass the halo and scale through to the fragment shader
+static const char *vertexShaderSDFTri =
+"uniform mat4  u_mvpMatrix;"
+"uniform mat4  u_mvMatrix;"
+"uniform mat4  u_mvNormalMatrix;"
+"uniform float u_fade;"
+"uniform vec4  u_tint;"
+"uniform vec2  u_scale;"
+"uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
+""
+"attribute vec3 a_position;"
+"attribute vec3 a_normal;"
+"attribute vec2 a_texCoord0;"
+"attribute vec4 a_color;"
+"attribute vec2 a_offset;"
+"attribute vec3 a_rot;"
+"attribute vec4 a_haloColor;"
+"attribute vec3 a_sdfParams;"
+""
+"varying vec2 v_texCoord;"
+"varying vec4 v_color;"
+"varying vec4 v_haloColor;"
+"varying vec3 v_sdfParams;"
+""
+"void main()"
+"{"
+"   v_texCoord = a_texCoord0;"
+"   v_color = a_color * u_fade * u_tint;"
+"   v_haloColor = a_haloColor * u_fade;"
+"   v_sdfParams = a_sdfParams;"
+""
+"   vec4 pt = u_mvMatrix * vec4(a_position,1.0);"
+"   pt /= pt.w;"
+"   vec4 testNorm = u_mvNormalMatrix * vec4(a_normal,0.0);"
+"   float dot_res = dot(-pt.xyz,testNorm.xyz);"
+"   vec4 screenPt = (u_mvpMatrix * vec4(a_position,1.0));"
+"   screenPt /= screenPt.w;"
+"   vec4 projRot = u_mvNormalMatrix * vec4(a_rot,0.0);"
+"   vec2 rotY = normalize(projRot.xy);"
+"   vec2 rotX = vec2(rotY.y,-rotY.x);"
+"   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
+"   gl_Position = (dot_res > 0.0 && pt.z <= 0.0) ? vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0) : vec4(0.0,0.0,0.0,0.0);"
+"}"
+;
+
+static const char *vertexShaderSDFTri2d =
+"uniform mat4  u_mvpMatrix;"
+"uniform mat4  u_mvMatrix;"
+"uniform mat4  u_mvNormalMatrix;"
+"uniform float u_fade;"
+"uniform vec4  u_tint;"
+"uniform vec2  u_scale;"
+"uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
+""
+"attribute vec3 a_position;"
+"attribute vec3 a_normal;"
+"attribute vec2 a_texCoord0;"
+"attribute vec4 a_color;"
+"attribute vec2 a_offset;"
+"attribute vec3 a_rot;"
+"attribute vec4 a_haloColor;"
+"attribute vec3 a_sdfParams;"
+""
+"varying vec2 v_texCoord;"
+"varying vec4 v_color;"
+"varying vec4 v_haloColor;"
+"varying vec3 v_sdfParams;"
+""
+"void main()"
+"{"
+"   v_texCoord = a_texCoord0;"
+"   v_color = a_color * u_fade * u_tint;"
+"   v_haloColor = a_haloColor * u_fade;"
+"   v_sdfParams = a_sdfParams;"
+""
+"   vec4 screenPt = (u_mvpMatrix * vec4(a_position,1.0));"
+"   screenPt /= screenPt.w;"
+"   vec4 projRot = u_mvNormalMatrix * vec4(a_rot,0.0);"
+"   vec2 rotY = normalize(projRot.xy);"
+"   vec2 rotX = vec2(rotY.y,-rotY.x);"
+"   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
+"   gl_Position = vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0);"
+"}"
+;
+
+static const char *vertexShaderSDFMotionTri =
+"uniform mat4  u_mvpMatrix;"
+"uniform mat4  u_mvMatrix;"
+"uniform mat4  u_mvNormalMatrix;"
+"uniform float u_fade;"
+"uniform vec4  u_tint;"
+"uniform vec2  u_scale;"
+"uniform float u_time;"
+"uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
+""
+"attribute vec3 a_position;"
+"attribute vec3 a_dir;"
+"attribute vec3 a_normal;"
+"attribute vec2 a_texCoord0;"
+"attribute vec4 a_color;"
+"attribute vec2 a_offset;"
+"attribute vec3 a_rot;"
+"attribute vec4 a_haloColor;"
+"attribute vec3 a_sdfParams;"
+""
+"varying vec2 v_texCoord;"
+"varying vec4 v_color;"
+"varying vec4 v_haloColor;"
+"varying vec3 v_sdfParams;"
+""
+"void main()"
+"{"
+"   v_texCoord = a_texCoord0;"
+"   v_color = a_color * u_fade * u_tint;"
+"   v_haloColor = a_haloColor * u_fade;"
+"   v_sdfParams = a_sdfParams;"
+""
+"   vec3 thePos = a_position + u_time * a_dir;"
+"   vec4 pt = u_mvMatrix * vec4(thePos,1.0);"
+"   pt /= pt.w;"
+"   vec4 testNorm = u_mvNormalMatrix * vec4(a_normal,0.0);"
+"   float dot_res = dot(-pt.xyz,testNorm.xyz);"
+"   vec4 screenPt = (u_mvpMatrix * vec4(thePos,1.0));"
+"   screenPt /= screenPt.w;"
+"   vec4 projRot = u_mvNormalMatrix * vec4(a_rot,0.0);"
+"   vec2 rotY = normalize(projRot.xy);"
+"   vec2 rotX = vec2(rotY.y,-rotY.x);"
+"   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
+"   gl_Position = (dot_res > 0.0 && pt.z <= 0.0) ? vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0) : vec4(0.0,0.0,0.0,0.0);"
+"}"
+;
+
+static const char *vertexShaderSDF2dMotionTri =
+"uniform mat4  u_mvpMatrix;"
+"uniform mat4  u_mvMatrix;"
+"uniform mat4  u_mvNormalMatrix;"
+"uniform float u_fade;"
+"uniform vec4  u_tint;"
+"uniform vec2  u_scale;"
+"uniform float u_time;"
+"uniform bool  u_activerot;"
+"uniform vec4  u_animXform;"
+"uniform vec2  u_animOffset;"
+""
+"attribute vec3 a_position;"
+"attribute vec3 a_dir;"
+"attribute vec3 a_normal;"
+"attribute vec2 a_texCoord0;"
+"attribute vec4 a_color;"
+"attribute vec2 a_offset;"
+"attribute vec3 a_rot;"
+"attribute vec4 a_haloColor;"
+"attribute vec3 a_sdfParams;"
+""
+"varying vec2 v_texCoord;"
+"varying vec4 v_color;"
+"varying vec4 v_haloColor;"
+"varying vec3 v_sdfParams;"
+""
+"void main()"
+"{"
+"   v_texCoord = a_texCoord0;"
+"   v_color = a_color * u_fade * u_tint;"
+"   v_haloColor = a_haloColor * u_fade;"
+"   v_sdfParams = a_sdfParams;"
+""
+"   vec3 thePos = a_position + u_time * a_dir;"
+"   vec4 screenPt = (u_mvpMatrix * vec4(thePos,1.0));"
+"   screenPt /= screenPt.w;"
+"   vec4 projRot = u_mvNormalMatrix * vec4(a_rot,0.0);"
+"   vec2 rotY = normalize(projRot.xy);"
+"   vec2 rotX = vec2(rotY.y,-rotY.x);"
+"   vec2 screenOffset = (u_activerot ? a_offset.x*rotX + a_offset.y*rotY : a_offset);"
+"   screenOffset = vec2(u_animXform.x*screenOffset.x + u_animXform.z*screenOffset.y,u_animXform.y*screenOffset.x + u_animXform.w*screenOffset.y) + u_animOffset;"
+"   gl_Position = vec4(screenPt.xy + vec2(screenOffset.x*u_scale.x,screenOffset.y*u_scale.y),0.0,1.0);"
+"}"
+;
+
+// Distance is in alpha with the edge at 0.75 and 8 units to a pixel.
+// v_sdfParams is (screen pixels per texel, halo width in texels, halo blur in texels)
+static const char *fragmentShaderSDFTri =
+"precision mediump float;\n"
+"\n"
+"uniform sampler2D s_baseMap0;\n"
+"\n"
+"varying vec2      v_texCoord;\n"
+"varying vec4      v_color;\n"
+"varying vec4      v_haloColor;\n"
+"varying vec3      v_sdfParams;\n"
+"\n"
+"void main()\n"
+"{\n"
+"  float dist = texture2D(s_baseMap0, v_texCoord).a;\n"
+"  float scale = max(v_sdfParams.x,0.01);\n"
+"  float gamma = 0.105 * 1.19 / scale;\n"
+"  float fill = smoothstep(0.75 - gamma, 0.75 + gamma, dist);\n"
+"  float haloEdge = 0.75 - v_sdfParams.y / 8.0;\n"
+"  float haloGamma = gamma + v_sdfParams.z * 1.19 / 8.0;\n"
+"  float halo = v_sdfParams.y > 0.0 ? smoothstep(haloEdge - haloGamma, haloEdge + haloGamma, dist) : 0.0;\n"
+"  gl_FragColor = v_color * fill + v_haloColor * halo * (1.0 - fill);\n"
+"}"
+;
+
 WhirlyKit::OpenGLES2Program *BuildScreenSpaceProgram()
 {
     OpenGLES2Program *shader = new OpenGLES2Program(kScreenSpaceShaderName,vertexShaderTri,fragmentShaderTri);
@@ -340,4 +581,64 @@ WhirlyKit::OpenGLES2Program *BuildScreenSpaceMotion2DProgram()
     return shader;
 }
 
+WhirlyKit::OpenGLES2Program *BuildScreenSpaceSDFProgram()
+{
+    OpenGLES2Program *shader = new OpenGLES2Program(kScreenSpaceShaderSDFName,vertexShaderSDFTri,fragmentShaderSDFTri);
+    if (!shader->isValid())
+    {
+        delete shader;
+        shader = NULL;
+    }
+    
+    if (shader)
+        glUseProgram(shader->getProgram());
+    
+    return shader;
+}
+
+WhirlyKit::OpenGLES2Program *BuildScreenSpaceSDF2DProgram()
+{
+    OpenGLES2Program *shader = new OpenGLES2Program(kScreenSpaceShaderSDF2DName,vertexShaderSDFTri2d,fragmentShaderSDFTri);
+    if (!shader->isValid())
+    {
+        delete shader;
+        shader = NULL;
+    }
+    
+    if (shader)
+        glUseProgram(shader->getProgram());
+    
+    return shader;
+}
+
+WhirlyKit::OpenGLES2Program *BuildScreenSpaceSDFMotionProgram()
+{
+    OpenGLES2Program *shader = new OpenGLES2Program(kScreenSpaceShaderSDFMotionName,vertexShaderSDFMotionTri,fragmentShaderSDFTri);
+    if (!shader->isValid())
+    {
+        delete shader;
+        shader = NULL;
+    }
+    
+    if (shader)
+        glUseProgram(shader->getProgram());
+    
+    return shader;
+}
+
+WhirlyKit::OpenGLES2Program *BuildScreenSpaceSDFMotion2DProgram()
+{
+    OpenGLES2Program *shader = new OpenGLES2Program(kScreenSpaceShaderSDF2DMotionName,vertexShaderSDF2dMotionTri,fragmentShaderSDFTri);
+    if (!shader->isValid())
+    {
+        delete shader;
+        shader = NULL;
+    }
+    
+    if (shader)
+        glUseProgram(shader->getProgram());
+    
+    return shader;
+}
+
 }
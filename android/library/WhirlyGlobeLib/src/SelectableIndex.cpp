@@ -0,0 +1,225 @@
+/*
+ *  SelectableIndex.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import <algorithm>
+#import "SelectableIndex.h"
+
+namespace WhirlyKit
+{
+
+// Cell coordinates get 21 bits each in a key
+static const int CellBits = 21;
+static const int CellOffset = 1<<(CellBits-1);
+static const uint64_t CellMask = (1<<CellBits)-1;
+
+SelectableIndex::SelectableIndex(double cellSize,int coarseFactor,int maxCellsPerEntry)
+    : cellSize(cellSize), coarseFactor(std::max(coarseFactor,1)), maxCellsPerEntry(maxCellsPerEntry)
+{
+}
+
+void SelectableIndex::setCellSize(double newSize)
+{
+    if (newSize > 0.0 && numEntries() == 0)
+        cellSize = newSize;
+}
+
+int SelectableIndex::cellCoord(double val,double size) const
+{
+    double cell = floor(val / size);
+    cell = std::min(std::max(cell,(double)-CellOffset),(double)(CellOffset-1));
+
+    return (int)cell;
+}
+
+SelectableIndex::CellKey SelectableIndex::makeKey(int ix,int iy,int iz) const
+{
+    return ((uint64_t)(ix+CellOffset) & CellMask) |
+           (((uint64_t)(iy+CellOffset) & CellMask) << CellBits) |
+           (((uint64_t)(iz+CellOffset) & CellMask) << (2*CellBits));
+}
+
+void SelectableIndex::keyToCell(CellKey key,int &ix,int &iy,int &iz) const
+{
+    ix = (int)(key & CellMask) - CellOffset;
+    iy = (int)((key >> CellBits) & CellMask) - CellOffset;
+    iz = (int)((key >> (2*CellBits)) & CellMask) - CellOffset;
+}
+
+// Integer division that rounds toward negative infinity
+static int FloorDiv(int val,int div)
+{
+    int res = val / div;
+    if ((val % div != 0) && (val < 0))
+        res--;
+    return res;
+}
+
+SelectableIndex::CellKey SelectableIndex::coarseKeyFor(CellKey fineKey) const
+{
+    int ix,iy,iz;
+    keyToCell(fineKey,ix,iy,iz);
+
+    return makeKey(FloorDiv(ix,coarseFactor),FloorDiv(iy,coarseFactor),FloorDiv(iz,coarseFactor));
+}
+
+void SelectableIndex::cellBounds(CellKey key,double size,Point3d &ll,Point3d &ur) const
+{
+    int ix,iy,iz;
+    keyToCell(key,ix,iy,iz);
+    ll = Point3d(ix*size,iy*size,iz*size);
+    ur = Point3d((ix+1)*size,(iy+1)*size,(iz+1)*size);
+}
+
+void SelectableIndex::addEntry(SimpleIdentity selectID,const Point3d &ll,const Point3d &ur)
+{
+    removeEntry(selectID);
+
+    int sx = cellCoord(ll.x(),cellSize), sy = cellCoord(ll.y(),cellSize), sz = cellCoord(ll.z(),cellSize);
+    int ex = cellCoord(ur.x(),cellSize), ey = cellCoord(ur.y(),cellSize), ez = cellCoord(ur.z(),cellSize);
+    double numCells = (double)(ex-sx+1) * (double)(ey-sy+1) * (double)(ez-sz+1);
+    if (numCells > maxCellsPerEntry)
+    {
+        alwaysIDs.insert(selectID);
+        return;
+    }
+
+    std::vector<CellKey> &keys = entryCells[selectID];
+    keys.reserve((int)numCells);
+    for (int iz=sz;iz<=ez;iz++)
+        for (int iy=sy;iy<=ey;iy++)
+            for (int ix=sx;ix<=ex;ix++)
+            {
+                CellKey key = makeKey(ix,iy,iz);
+                keys.push_back(key);
+                fineCells[key].push_back(selectID);
+                coarseCells[coarseKeyFor(key)].insert(key);
+            }
+}
+
+void SelectableIndex::addAlways(SimpleIdentity selectID)
+{
+    removeEntry(selectID);
+    alwaysIDs.insert(selectID);
+}
+
+void SelectableIndex::removeEntry(SimpleIdentity selectID)
+{
+    alwaysIDs.erase(selectID);
+
+    auto it = entryCells.find(selectID);
+    if (it == entryCells.end())
+        return;
+
+    for (CellKey key : it->second)
+    {
+        auto cit = fineCells.find(key);
+        if (cit == fineCells.end())
+            continue;
+        std::vector<SimpleIdentity> &ids = cit->second;
+        auto idIt = std::find(ids.begin(),ids.end(),selectID);
+        if (idIt != ids.end())
+        {
+            *idIt = ids.back();
+            ids.pop_back();
+        }
+        // Clean up empty cells so the queries don't visit them
+        if (ids.empty())
+        {
+            fineCells.erase(cit);
+            auto coarseIt = coarseCells.find(coarseKeyFor(key));
+            if (coarseIt != coarseCells.end())
+            {
+                coarseIt->second.erase(key);
+                if (coarseIt->second.empty())
+                    coarseCells.erase(coarseIt);
+            }
+        }
+    }
+    entryCells.erase(it);
+}
+
+void SelectableIndex::findCandidates(const Point3d &ll,const Point3d &ur,const CellTest &cellTest,SimpleIDSet &selectIDs) const
+{
+    // Range of fine and coarse cells the box covers
+    int sx = cellCoord(ll.x(),cellSize), sy = cellCoord(ll.y(),cellSize), sz = cellCoord(ll.z(),cellSize);
+    int ex = cellCoord(ur.x(),cellSize), ey = cellCoord(ur.y(),cellSize), ez = cellCoord(ur.z(),cellSize);
+    int csx = FloorDiv(sx,coarseFactor), csy = FloorDiv(sy,coarseFactor), csz = FloorDiv(sz,coarseFactor);
+    int cex = FloorDiv(ex,coarseFactor), cey = FloorDiv(ey,coarseFactor), cez = FloorDiv(ez,coarseFactor);
+    
+    double coarseSize = cellSize * coarseFactor;
+    auto addFromCoarse = [&](CellKey coarseKey,const std::unordered_set<CellKey> &fineKeys)
+    {
+        Point3d cellLL,cellUR;
+        cellBounds(coarseKey,coarseSize,cellLL,cellUR);
+        if (!cellTest(cellLL,cellUR))
+            return;
+        
+        for (CellKey fineKey : fineKeys)
+        {
+            int ix,iy,iz;
+            keyToCell(fineKey,ix,iy,iz);
+            if (ix < sx || ix > ex || iy < sy || iy > ey || iz < sz || iz > ez)
+                continue;
+            cellBounds(fineKey,cellSize,cellLL,cellUR);
+            if (!cellTest(cellLL,cellUR))
+                continue;
+            
+            auto cit = fineCells.find(fineKey);
+            if (cit != fineCells.end())
+                selectIDs.insert(cit->second.begin(),cit->second.end());
+        }
+    };
+    
+    // Look up the coarse cells in range if there are fewer of those than we have.
+    // Otherwise run through the ones we have, skipping what's out of range.
+    double numCoarse = (double)(cex-csx+1) * (double)(cey-csy+1) * (double)(cez-csz+1);
+    if (numCoarse < (double)coarseCells.size())
+    {
+        for (int iz=csz;iz<=cez;iz++)
+            for (int iy=csy;iy<=cey;iy++)
+                for (int ix=csx;ix<=cex;ix++)
+                {
+                    CellKey coarseKey = makeKey(ix,iy,iz);
+                    auto coarseIt = coarseCells.find(coarseKey);
+                    if (coarseIt != coarseCells.end())
+                        addFromCoarse(coarseKey,coarseIt->second);
+                }
+    } else {
+        for (auto &coarseIt : coarseCells)
+        {
+            int ix,iy,iz;
+            keyToCell(coarseIt.first,ix,iy,iz);
+            if (ix < csx || ix > cex || iy < csy || iy > cey || iz < csz || iz > cez)
+                continue;
+            addFromCoarse(coarseIt.first,coarseIt.second);
+        }
+    }
+
+    selectIDs.insert(alwaysIDs.begin(),alwaysIDs.end());
+}
+
+void SelectableIndex::findCandidates(const Point3d &ll,const Point3d &ur,SimpleIDSet &selectIDs) const
+{
+    // The cell range is exactly the box, so there's nothing else to test
+    findCandidates(ll,ur,[](const Point3d &,const Point3d &) { return true; },selectIDs);
+}
+
+}
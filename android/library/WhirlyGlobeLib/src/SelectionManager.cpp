@@ -67,9 +67,20 @@ bool BillboardSelectable::operator < (const BillboardSelectable &that) const
 }
 
 SelectionManager::SelectionManager(Scene *scene,float viewScale)
-    : scene(scene), scale(viewScale)
+    : scene(scene), scale(viewScale), maxScreenRectSize(0.0)
 {
     pthread_mutex_init(&mutex,NULL);
+    
+    // Flat maps can be in any units, so size the index cells to the display bounds.
+    // The globe is unit sized and the default works there.
+    CoordSystemDisplayAdapter *coordAdapter = scene ? scene->getCoordAdapter() : NULL;
+    Point3d dispLL,dispUR;
+    if (coordAdapter && coordAdapter->getDisplayBounds(dispLL,dispUR))
+    {
+        double size = std::max(dispUR.x()-dispLL.x(),dispUR.y()-dispLL.y());
+        if (size > 0.0)
+            regionIndex.setCellSize(size / 256.0);
+    }
 }
 
 SelectionManager::~SelectionManager()
@@ -77,6 +88,22 @@ SelectionManager::~SelectionManager()
     pthread_mutex_destroy(&mutex);
 }
 
+// Rough size of a selectable's polygons
+static unsigned long PolysSize(const std::vector<Point3fVector> &polys)
+{
+    unsigned long size = 0;
+    for (const Point3fVector &poly : polys)
+        size += sizeof(poly) + poly.size()*sizeof(Point3f);
+    
+    return size;
+}
+
+void SelectionManager::trackSelectable(SimpleIdentity selectID,unsigned long size)
+{
+    if (scene)
+        scene->getMemTracker()->addObject(MemTrackSelectable,selectID,getMemTag(""),size);
+}
+
 // Add a rectangle (in 3-space) available for selection
 void SelectionManager::addSelectableRect(SimpleIdentity selectId,Point3f *pts,bool enable)
 {
@@ -91,9 +118,16 @@ void SelectionManager::addSelectableRect(SimpleIdentity selectId,Point3f *pts,bo
     for (unsigned int ii=0;ii<4;ii++)
         newSelect.pts[ii] = pts[ii];
 
+    BBox bbox;
+    for (unsigned int ii=0;ii<4;ii++)
+        bbox.addPoint(Vector3fToVector3d(pts[ii]));
+
     pthread_mutex_lock(&mutex);
     rect3Dselectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,bbox.ll(),bbox.ur());
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect));
 }
 
 // Add a rectangle (in 3-space) for selection, but only between the given visibilities
@@ -110,9 +144,16 @@ void SelectionManager::addSelectableRect(SimpleIdentity selectId,Point3f *pts,fl
     for (unsigned int ii=0;ii<4;ii++)
         newSelect.pts[ii] = pts[ii];
     
+    BBox bbox;
+    for (unsigned int ii=0;ii<4;ii++)
+        bbox.addPoint(Vector3fToVector3d(pts[ii]));
+
     pthread_mutex_lock(&mutex);
     rect3Dselectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,bbox.ll(),bbox.ur());
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect));
 }
 
 /// Add a screen space rectangle (2D) for selection, between the given visibilities
@@ -130,9 +171,17 @@ void SelectionManager::addSelectableScreenRect(SimpleIdentity selectId,const Poi
     for (unsigned int ii=0;ii<4;ii++)
         newSelect.pts[ii] = pts[ii];
     
+    float rectSize = 0.0;
+    for (unsigned int ii=0;ii<4;ii++)
+        rectSize = std::max(rectSize,pts[ii].norm());
+
     pthread_mutex_lock(&mutex);
     rect2Dselectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,center,center);
+    maxScreenRectSize = std::max(maxScreenRectSize,rectSize);
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect));
 }
 
 /// Add a screen space rectangle (2D) for selection, between the given visibilities
@@ -155,7 +204,10 @@ void SelectionManager::addSelectableMovingScreenRect(SimpleIdentity selectId,con
     
     pthread_mutex_lock(&mutex);
     movingRect2Dselectables.insert(newSelect);
+    regionIndex.addAlways(newSelect.selectID);
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect));
 }
 
 static const int corners[6][4] = {{0,1,2,3},{7,6,5,4},{1,0,4,5},{1,5,6,2},{2,6,7,3},{3,7,4,0}};
@@ -189,9 +241,17 @@ void SelectionManager::addSelectableRectSolid(SimpleIdentity selectId,Point3f *p
         newSelect.polys.push_back(poly);
     }
     
+    BBox bbox;
+    for (const Point3fVector &poly : newSelect.polys)
+        for (const Point3f &pt : poly)
+            bbox.addPoint(Vector3fToVector3d(pt) + newSelect.centerPt);
+
     pthread_mutex_lock(&mutex);
     polytopeSelectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,bbox.ll(),bbox.ur());
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect) + PolysSize(newSelect.polys));
 }
 
 void SelectionManager::addSelectableRectSolid(SimpleIdentity selectId,const BBox &bbox,float minVis,float maxVis,bool enable)
@@ -234,9 +294,17 @@ void SelectionManager::addPolytope(SimpleIdentity selectId,const std::vector<Poi
         newSelect.polys.push_back(surface3f);
     }
     
+    BBox bbox;
+    for (const Point3fVector &poly : newSelect.polys)
+        for (const Point3f &pt : poly)
+            bbox.addPoint(Vector3fToVector3d(pt) + newSelect.centerPt);
+
     pthread_mutex_lock(&mutex);
     polytopeSelectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,bbox.ll(),bbox.ur());
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect) + PolysSize(newSelect.polys));
 }
 
 void SelectionManager::addPolytopeFromBox(SimpleIdentity selectId,const Point3d &ll,const Point3d &ur,const Eigen::Matrix4d &mat,float minVis,float maxVis,bool enable)
@@ -307,7 +375,10 @@ void SelectionManager::addMovingPolytope(SimpleIdentity selectId,const std::vect
     
     pthread_mutex_lock(&mutex);
     movingPolytopeSelectables.insert(newSelect);
+    regionIndex.addAlways(newSelect.selectID);
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect) + PolysSize(newSelect.polys));
 }
 
 void SelectionManager::addMovingPolytopeFromBox(SimpleIdentity selectID, const Point3d &ll, const Point3d &ur, const Point3d &startCenter, const Point3d &endCenter,TimeInterval startTime,TimeInterval duration, const Eigen::Matrix4d &mat, float minVis, float maxVis, bool enable)
@@ -366,9 +437,15 @@ void SelectionManager::addSelectableLinear(SimpleIdentity selectId,const Point3f
         newSelect.pts[ii] = Point3d(pt.x(),pt.y(),pt.z());
     }
 
+    BBox bbox;
+    bbox.addPoints(newSelect.pts);
+
     pthread_mutex_lock(&mutex);
     linearSelectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,bbox.ll(),bbox.ur());
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect) + newSelect.pts.size()*sizeof(Point3d));
 }
 
 void SelectionManager::addSelectableBillboard(SimpleIdentity selectId,const Point3d &center,const Point3d &norm,const Point2d &size,float minVis,float maxVis,bool enable)
@@ -386,9 +463,16 @@ void SelectionManager::addSelectableBillboard(SimpleIdentity selectId,const Poin
     newSelect.minVis = minVis;
     newSelect.maxVis = maxVis;
     
+    // Billboards turn, so take the box they could sweep out
+    double radius = std::max(size.x()/2.0,size.y());
+    Point3d rad3d(radius,radius,radius);
+
     pthread_mutex_lock(&mutex);
     billboardSelectables.insert(newSelect);
+    regionIndex.addEntry(newSelect.selectID,center-rad3d,center+rad3d);
     pthread_mutex_unlock(&mutex);
+    
+    trackSelectable(newSelect.selectID,sizeof(newSelect));
 }
 
 void SelectionManager::enableSelectable(SimpleIdentity selectID,bool enable)
@@ -537,6 +621,18 @@ void SelectionManager::enableSelectables(const SimpleIDSet &selectIDs,bool enabl
     pthread_mutex_unlock(&mutex);
 }
 
+void SelectionManager::setSelectableAttributes(SimpleIdentity selectID,const DictionaryRef &attrs)
+{
+    pthread_mutex_lock(&mutex);
+    
+    if (attrs)
+        selectAttrs[selectID] = attrs;
+    else
+        selectAttrs.erase(selectID);
+    
+    pthread_mutex_unlock(&mutex);
+}
+
 // Remove the given selectable from consideration
 void SelectionManager::removeSelectable(SimpleIdentity selectID)
 {
@@ -571,7 +667,12 @@ void SelectionManager::removeSelectable(SimpleIdentity selectID)
     if (it4 != billboardSelectables.end())
         billboardSelectables.erase(it4);
 
-    pthread_mutex_unlock(&mutex);
+    regionIndex.removeEntry(selectID);
+    selectAttrs.erase(selectID);
+
+    pthread_mutex_unlock(&mutex);    
+    if (scene)
+        scene->getMemTracker()->removeObject(MemTrackSelectable,selectID);
 }
 
 void SelectionManager::removeSelectables(const SimpleIDSet &selectIDs)
@@ -631,12 +732,18 @@ void SelectionManager::removeSelectables(const SimpleIDSet &selectIDs)
             found = true;
             billboardSelectables.erase(it4);
         }
+
+        regionIndex.removeEntry(selectID);
+        selectAttrs.erase(selectID);
     }
     
 //    if (!found)
 //        NSLog(@"Tried to delete selectable that doesn't exist.");
     
-    pthread_mutex_unlock(&mutex);
+    pthread_mutex_unlock(&mutex);    
+    if (scene)
+        for (SimpleIdentity selectID : selectIDs)
+            scene->getMemTracker()->removeObject(MemTrackSelectable,selectID);
 }
 
 void SelectionManager::getScreenSpaceObjects(const PlacementInfo &pInfo,std::vector<ScreenSpaceObjectLocation> &screenPts,TimeInterval now)
@@ -769,6 +876,10 @@ void SelectionManager::pickObjects(Point2f touchPt,float maxDist,View *theView,s
 {
     pickObjects(touchPt, maxDist, theView, true, selObjs);
 
+    pthread_mutex_lock(&mutex);
+    fillAttributes(selObjs);
+    pthread_mutex_unlock(&mutex);
+
     std::sort(selObjs.begin(),selObjs.end(),SelectedSorter);
 }
 
@@ -1188,3 +1299,535 @@ void SelectionManager::pickObjects(Point2f touchPt,float maxDist,View *theView,b
     
     pthread_mutex_unlock(&mutex);
 }
+
+bool SelectionManager::isSelectableVisible(const Selectable &sel,double heightAboveSurface)
+{
+    if (sel.selectID == EmptyIdentity || !sel.enable)
+        return false;
+    
+    return sel.minVis == DrawVisibleInvalid ||
+        (sel.minVis < heightAboveSurface && heightAboveSurface < sel.maxVis);
+}
+
+// Check if two line segments cross, including touching
+static bool SegmentsIntersect(const Point2f &a0,const Point2f &a1,const Point2f &b0,const Point2f &b1)
+{
+    auto orient = [](const Point2f &p,const Point2f &q,const Point2f &r)
+    {
+        float val = (q.x()-p.x())*(r.y()-p.y()) - (q.y()-p.y())*(r.x()-p.x());
+        return (val > 0.0) - (val < 0.0);
+    };
+    auto onSegment = [](const Point2f &p,const Point2f &q,const Point2f &r)
+    {
+        return std::min(p.x(),q.x()) <= r.x() && r.x() <= std::max(p.x(),q.x()) &&
+               std::min(p.y(),q.y()) <= r.y() && r.y() <= std::max(p.y(),q.y());
+    };
+    
+    int o0 = orient(a0,a1,b0), o1 = orient(a0,a1,b1);
+    int o2 = orient(b0,b1,a0), o3 = orient(b0,b1,a1);
+    if (o0 != o1 && o2 != o3)
+        return true;
+    
+    return (o0 == 0 && onSegment(a0,a1,b0)) || (o1 == 0 && onSegment(a0,a1,b1)) ||
+           (o2 == 0 && onSegment(b0,b1,a0)) || (o3 == 0 && onSegment(b0,b1,a1));
+}
+
+// See if a polygon (or a polyline, if it's not closed) overlaps the region
+static bool ShapeOverlapsRegion(const Point2fVector &pts,bool closed,const Point2fVector &region,const Mbr &regionMbr)
+{
+    if (pts.empty())
+        return false;
+    Mbr ptsMbr(pts);
+    if (!ptsMbr.overlaps(regionMbr))
+        return false;
+    
+    for (const Point2f &pt : pts)
+        if (PointInPolygon(pt,region))
+            return true;
+    
+    // The region might be inside the polygon
+    if (closed && pts.size() > 2 && PointInPolygon(region[0],pts))
+        return true;
+    
+    // Otherwise the edges have to cross
+    int numEdges = closed ? (int)pts.size() : (int)pts.size()-1;
+    for (int ii=0;ii<numEdges;ii++)
+    {
+        const Point2f &p0 = pts[ii], &p1 = pts[(ii+1)%pts.size()];
+        for (unsigned int jj=0;jj<region.size();jj++)
+            if (SegmentsIntersect(p0,p1,region[jj],region[(jj+1)%region.size()]))
+                return true;
+    }
+    
+    return false;
+}
+
+bool SelectionManager::boxMayOverlapScreenRegion(const Point3d &ll,const Point3d &ur,const PlacementInfo &pInfo,const Mbr &regionMbr)
+{
+    std::vector<Eigen::Matrix4d> identMats;
+    const std::vector<Eigen::Matrix4d> *offsetMats = &pInfo.offsetMatrices;
+    if (offsetMats->empty())
+    {
+        identMats.push_back(Eigen::Matrix4d::Identity());
+        offsetMats = &identMats;
+    }
+    
+    for (const Eigen::Matrix4d &offMatrix : *offsetMats)
+    {
+        Eigen::Matrix4d fullMat = pInfo.projMat * pInfo.viewMat * offMatrix * pInfo.modelMat;
+        Mbr screenMbr;
+        for (unsigned int ii=0;ii<8;ii++)
+        {
+            Vector4d corner((ii & 1) ? ur.x() : ll.x(),(ii & 2) ? ur.y() : ll.y(),(ii & 4) ? ur.z() : ll.z(),1.0);
+            Vector4d projPt = fullMat * corner;
+            // Straddles the eye, so we can't say
+            if (projPt.w() <= 0.0)
+                return true;
+            Point2f screenPt((projPt.x()/projPt.w() + 1.0)/2.0 * pInfo.frameSizeScale.x(),
+                             (1.0 - (projPt.y()/projPt.w() + 1.0)/2.0) * pInfo.frameSizeScale.y());
+            screenMbr.addPoint(screenPt);
+        }
+        if (screenMbr.overlaps(regionMbr))
+            return true;
+    }
+    
+    return false;
+}
+
+bool SelectionManager::screenObjectInRegion(const Point3d &dispLoc,const Point2dVector &pts,const Point2d &offset,const PlacementInfo &pInfo,const Point2fVector &region,const Mbr &regionMbr)
+{
+    Point2dVector projPts;
+    projectWorldPointToScreen(dispLoc,pInfo,projPts,scale);
+    
+    for (const Point2d &projPt : projPts)
+    {
+        Point2fVector screenPts;
+        screenPts.reserve(pts.size());
+        for (const Point2d &pt : pts)
+        {
+            Point2d theScreenPt = Point2d(pt.x(),-pt.y()) + projPt + offset;
+            screenPts.push_back(Point2f(theScreenPt.x(),theScreenPt.y()));
+        }
+        if (ShapeOverlapsRegion(screenPts,true,region,regionMbr))
+            return true;
+    }
+    
+    return false;
+}
+
+Point2f SelectionManager::displayToGeo(const Point3d &dispPt)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    Point2d geoPt = coordAdapter->getCoordSystem()->localToGeographicD(coordAdapter->displayToLocal(dispPt));
+    
+    return Point2f(geoPt.x(),geoPt.y());
+}
+
+bool SelectionManager::screenRegionDisplayBounds(const Mbr &regionMbr,const PlacementInfo &pInfo,Point3d &ll,Point3d &ur)
+{
+    std::vector<Eigen::Matrix4d> identMats;
+    const std::vector<Eigen::Matrix4d> *offsetMats = &pInfo.offsetMatrices;
+    if (offsetMats->empty())
+    {
+        identMats.push_back(Eigen::Matrix4d::Identity());
+        offsetMats = &identMats;
+    }
+    
+    // Anything that projects into the region is in the frustum it cuts out between the near and far planes
+    BBox dispBox;
+    for (const Eigen::Matrix4d &offMatrix : *offsetMats)
+    {
+        Eigen::Matrix4d invMat = (pInfo.projMat * pInfo.viewMat * offMatrix * pInfo.modelMat).inverse();
+        for (unsigned int ii=0;ii<8;ii++)
+        {
+            Point2f screenPt((ii & 1) ? regionMbr.ur().x() : regionMbr.ll().x(),(ii & 2) ? regionMbr.ur().y() : regionMbr.ll().y());
+            Vector4d projPt(2.0 * screenPt.x() / pInfo.frameSizeScale.x() - 1.0,
+                            1.0 - 2.0 * screenPt.y() / pInfo.frameSizeScale.y(),
+                            (ii & 4) ? 1.0 : -1.0,1.0);
+            Vector4d dispPt = invMat * projPt;
+            if (fabs(dispPt.w()) < 1e-12 || !std::isfinite(dispPt.w()))
+                return false;
+            dispBox.addPoint(Point3d(dispPt.x()/dispPt.w(),dispPt.y()/dispPt.w(),dispPt.z()/dispPt.w()));
+        }
+    }
+    
+    double pad = regionIndex.getCellSize();
+    Point3d pad3d(pad,pad,pad);
+    ll = dispBox.ll() - pad3d;
+    ur = dispBox.ur() + pad3d;
+    
+    return true;
+}
+
+void SelectionManager::fillAttributes(std::vector<SelectedObject> &selObjs)
+{
+    if (selectAttrs.empty())
+        return;
+    
+    for (SelectedObject &selObj : selObjs)
+    {
+        if (selObj.isCluster || selObj.selectIDs.size() != 1)
+            continue;
+        auto it = selectAttrs.find(selObj.selectIDs[0]);
+        if (it != selectAttrs.end())
+            selObj.attrs = it->second;
+    }
+}
+
+void SelectionManager::objectsInScreenRegion(const Point2fVector &region,View *theView,std::vector<SelectedObject> &selObjs)
+{
+    if (!renderer || region.size() < 3)
+        return;
+    
+    PlacementInfo pInfo(theView,renderer);
+    if (!pInfo.globeView && !pInfo.mapView)
+        return;
+    
+    TimeInterval now = TimeGetCurrent();
+    double height = pInfo.heightAboveSurface;
+    Mbr regionMbr(region);
+    
+    // Eye position and direction for distances and billboards
+    Vector4d eyePos4 = pInfo.viewAndModelInvMat * Vector4d(0,0,0,1);
+    Point3d eyePos(eyePos4.x()/eyePos4.w(),eyePos4.y()/eyePos4.w(),eyePos4.z()/eyePos4.w());
+    Vector4d eyeVec4 = pInfo.viewAndModelInvMat * Vector4d(0,0,1,0);
+    Vector3d eyeVec(eyeVec4.x(),eyeVec4.y(),eyeVec4.z());
+    
+    LayoutManager *layoutManager = (LayoutManager *)scene->getManager(kWKLayoutManager);
+    
+    // Layout objects are only in here if they were placed
+    if (layoutManager)
+    {
+        std::vector<ScreenSpaceObjectLocation> ssObjs;
+        layoutManager->getScreenSpaceObjects(pInfo,ssObjs);
+        for (const ScreenSpaceObjectLocation &ssObj : ssObjs)
+            if (!ssObj.shapeIDs.empty() && screenObjectInRegion(ssObj.dispLoc,ssObj.pts,ssObj.offset,pInfo,region,regionMbr))
+            {
+                SelectedObject selObj(ssObj.shapeIDs,(ssObj.dispLoc - eyePos).norm(),0.0);
+                selObj.isCluster = ssObj.isCluster;
+                selObjs.push_back(selObj);
+            }
+    }
+    
+    pthread_mutex_lock(&mutex);
+    
+    // Screen space rectangles stick out past their cells, so widen the region for the cell test
+    Mbr cellMbr = regionMbr;
+    cellMbr.ll() -= Point2f(maxScreenRectSize,maxScreenRectSize);
+    cellMbr.ur() += Point2f(maxScreenRectSize,maxScreenRectSize);
+    // Only look at the cells the region's frustum covers, if we can work that out
+    Point3d dispLL(-MAXFLOAT,-MAXFLOAT,-MAXFLOAT),dispUR(MAXFLOAT,MAXFLOAT,MAXFLOAT);
+    screenRegionDisplayBounds(cellMbr,pInfo,dispLL,dispUR);
+    SimpleIDSet candidates;
+    regionIndex.findCandidates(dispLL,dispUR,
+                               [&](const Point3d &ll,const Point3d &ur)
+                               {
+                                   return boxMayOverlapScreenRegion(ll,ur,pInfo,cellMbr);
+                               },
+                               candidates);
+    
+    for (SimpleIdentity selectID : candidates)
+    {
+        auto it2 = rect2Dselectables.find(RectSelectable2D(selectID));
+        if (it2 != rect2Dselectables.end())
+        {
+            const RectSelectable2D &sel = *it2;
+            if (isSelectableVisible(sel,height))
+            {
+                Point2dVector pts;
+                for (unsigned int ii=0;ii<4;ii++)
+                    pts.push_back(Point2d(sel.pts[ii].x(),sel.pts[ii].y()));
+                if (screenObjectInRegion(sel.center,pts,Point2d(0,0),pInfo,region,regionMbr))
+                    selObjs.push_back(SelectedObject(sel.selectID,(sel.center - eyePos).norm(),0.0));
+            }
+            continue;
+        }
+        
+        auto itM = movingRect2Dselectables.find(MovingRectSelectable2D(selectID));
+        if (itM != movingRect2Dselectables.end())
+        {
+            const MovingRectSelectable2D &sel = *itM;
+            if (isSelectableVisible(sel,height))
+            {
+                Point3d center = sel.centerForTime(now);
+                Point2dVector pts;
+                for (unsigned int ii=0;ii<4;ii++)
+                    pts.push_back(Point2d(sel.pts[ii].x(),sel.pts[ii].y()));
+                if (screenObjectInRegion(center,pts,Point2d(0,0),pInfo,region,regionMbr))
+                    selObjs.push_back(SelectedObject(sel.selectID,(center - eyePos).norm(),0.0));
+            }
+            continue;
+        }
+        
+        auto it3 = polytopeSelectables.find(PolytopeSelectable(selectID));
+        if (it3 != polytopeSelectables.end())
+        {
+            const PolytopeSelectable &sel = *it3;
+            if (isSelectableVisible(sel,height))
+            {
+                for (const Point3fVector &poly3f : sel.polys)
+                {
+                    Point3dVector poly;
+                    poly.reserve(poly3f.size());
+                    for (const Point3f &pt : poly3f)
+                        poly.push_back(Vector3fToVector3d(pt) + sel.centerPt);
+                    Point2fVector screenPts;
+                    ClipAndProjectPolygon(pInfo.viewAndModelMat,pInfo.projMat,pInfo.frameSizeScale,poly,screenPts);
+                    if (screenPts.size() > 2 && ShapeOverlapsRegion(screenPts,true,region,regionMbr))
+                    {
+                        selObjs.push_back(SelectedObject(sel.selectID,(sel.centerPt - eyePos).norm(),0.0));
+                        break;
+                    }
+                }
+            }
+            continue;
+        }
+        
+        auto it3a = movingPolytopeSelectables.find(MovingPolytopeSelectable(selectID));
+        if (it3a != movingPolytopeSelectables.end())
+        {
+            const MovingPolytopeSelectable &sel = *it3a;
+            if (isSelectableVisible(sel,height))
+            {
+                double t = (now-sel.startTime)/sel.duration;
+                Point3d centerPt = (sel.endCenterPt - sel.centerPt)*t + sel.centerPt;
+                for (const Point3fVector &poly3f : sel.polys)
+                {
+                    Point3dVector poly;
+                    poly.reserve(poly3f.size());
+                    for (const Point3f &pt : poly3f)
+                        poly.push_back(Vector3fToVector3d(pt) + centerPt);
+                    Point2fVector screenPts;
+                    ClipAndProjectPolygon(pInfo.viewAndModelMat,pInfo.projMat,pInfo.frameSizeScale,poly,screenPts);
+                    if (screenPts.size() > 2 && ShapeOverlapsRegion(screenPts,true,region,regionMbr))
+                    {
+                        selObjs.push_back(SelectedObject(sel.selectID,(centerPt - eyePos).norm(),0.0));
+                        break;
+                    }
+                }
+            }
+            continue;
+        }
+        
+        auto it5 = linearSelectables.find(LinearSelectable(selectID));
+        if (it5 != linearSelectables.end())
+        {
+            const LinearSelectable &sel = *it5;
+            if (isSelectableVisible(sel,height) && !sel.pts.empty())
+            {
+                // Follow each wrapped copy of the line, as long as all its points made it
+                std::vector<Point2fVector> screenLines;
+                bool valid = true;
+                for (unsigned int ip=0;ip<sel.pts.size() && valid;ip++)
+                {
+                    Point2dVector projPts;
+                    projectWorldPointToScreen(sel.pts[ip],pInfo,projPts,scale);
+                    if (ip == 0)
+                        screenLines.resize(projPts.size());
+                    else if (projPts.size() != screenLines.size())
+                        valid = false;
+                    for (unsigned int iw=0;iw<projPts.size() && valid;iw++)
+                        screenLines[iw].push_back(Point2f(projPts[iw].x(),projPts[iw].y()));
+                }
+                if (valid)
+                    for (const Point2fVector &screenLine : screenLines)
+                        if (ShapeOverlapsRegion(screenLine,false,region,regionMbr))
+                        {
+                            selObjs.push_back(SelectedObject(sel.selectID,(sel.pts[0] - eyePos).norm(),0.0));
+                            break;
+                        }
+            }
+            continue;
+        }
+        
+        auto it = rect3Dselectables.find(RectSelectable3D(selectID));
+        if (it != rect3Dselectables.end())
+        {
+            const RectSelectable3D &sel = *it;
+            if (isSelectableVisible(sel,height))
+            {
+                Point2fVector screenPts;
+                Point3d midPt(0,0,0);
+                for (unsigned int ii=0;ii<4;ii++)
+                {
+                    Point3d pt3d = Vector3fToVector3d(sel.pts[ii]);
+                    midPt += pt3d;
+                    if (pInfo.globeView)
+                        screenPts.push_back(pInfo.globeView->pointOnScreenFromSphere(pt3d,&pInfo.viewAndModelMat,pInfo.frameSizeScale));
+                    else
+                        screenPts.push_back(pInfo.mapView->pointOnScreenFromPlane(pt3d,&pInfo.viewAndModelMat,pInfo.frameSizeScale));
+                }
+                midPt /= 4.0;
+                if (ShapeOverlapsRegion(screenPts,true,region,regionMbr))
+                    selObjs.push_back(SelectedObject(sel.selectID,(midPt - eyePos).norm(),0.0));
+            }
+            continue;
+        }
+        
+        auto it4 = billboardSelectables.find(BillboardSelectable(selectID));
+        if (it4 != billboardSelectables.end())
+        {
+            const BillboardSelectable &sel = *it4;
+            if (isSelectableVisible(sel,height))
+            {
+                Point3dVector poly(4);
+                Point3d axisX = eyeVec.cross(sel.normal);
+                poly[0] = -sel.size.x()/2.0 * axisX + sel.center;
+                poly[3] = sel.size.x()/2.0 * axisX + sel.center;
+                poly[2] = -sel.size.x()/2.0 * axisX + sel.size.y() * sel.normal + sel.center;
+                poly[1] = sel.size.x()/2.0 * axisX + sel.size.y() * sel.normal + sel.center;
+                Point2fVector screenPts;
+                ClipAndProjectPolygon(pInfo.viewAndModelMat,pInfo.projMat,pInfo.frameSizeScale,poly,screenPts);
+                if (screenPts.size() > 2 && ShapeOverlapsRegion(screenPts,true,region,regionMbr))
+                    selObjs.push_back(SelectedObject(sel.selectID,(sel.center - eyePos).norm(),0.0));
+            }
+            continue;
+        }
+    }
+    
+    fillAttributes(selObjs);
+    
+    pthread_mutex_unlock(&mutex);
+    
+    std::sort(selObjs.begin(),selObjs.end(),SelectedSorter);
+}
+
+void SelectionManager::objectsInGeoRegion(const Point2dVector &region,View *theView,std::vector<SelectedObject> &selObjs)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    if (!renderer || !coordAdapter || region.size() < 3)
+        return;
+    CoordSystem *coordSys = coordAdapter->getCoordSystem();
+    
+    PlacementInfo pInfo(theView,renderer);
+    TimeInterval now = TimeGetCurrent();
+    double height = pInfo.heightAboveSurface;
+    
+    Point2fVector geoRegion;
+    geoRegion.reserve(region.size());
+    for (const Point2d &pt : region)
+        geoRegion.push_back(Point2f(pt.x(),pt.y()));
+    Mbr geoMbr(geoRegion);
+    
+    Vector4d eyePos4 = pInfo.viewAndModelInvMat * Vector4d(0,0,0,1);
+    Point3d eyePos(eyePos4.x()/eyePos4.w(),eyePos4.y()/eyePos4.w(),eyePos4.z()/eyePos4.w());
+    
+    // Display space bounds of the region.  Sample the interior too, since the globe bulges out.
+    static const int NumSamples = 16;
+    BBox dispBox;
+    for (unsigned int ii=0;ii<region.size();ii++)
+    {
+        const Point2d &p0 = region[ii], &p1 = region[(ii+1)%region.size()];
+        for (int is=0;is<NumSamples;is++)
+        {
+            Point2d geoPt = (p1-p0) * is / (double)NumSamples + p0;
+            dispBox.addPoint(coordAdapter->localToDisplay(coordSys->geographicToLocal(geoPt)));
+        }
+    }
+    for (int iy=0;iy<=NumSamples;iy++)
+        for (int ix=0;ix<=NumSamples;ix++)
+        {
+            Point2d geoPt(geoMbr.ll().x() + (geoMbr.ur().x()-geoMbr.ll().x()) * ix / (double)NumSamples,
+                          geoMbr.ll().y() + (geoMbr.ur().y()-geoMbr.ll().y()) * iy / (double)NumSamples);
+            dispBox.addPoint(coordAdapter->localToDisplay(coordSys->geographicToLocal(geoPt)));
+        }
+    // Pad it out to catch what's between the samples and anything off the surface
+    double pad = regionIndex.getCellSize();
+    Point3d pad3d(pad,pad,pad);
+    Point3d dispLL = dispBox.ll() - pad3d, dispUR = dispBox.ur() + pad3d;
+    
+    // Anything with a location in the region
+    auto inRegion = [&](const Point3d &dispPt)
+    {
+        Point2f geoPt = displayToGeo(dispPt);
+        return geoMbr.insideOrOnEdge(geoPt) && PointInPolygon(geoPt,geoRegion);
+    };
+    
+    LayoutManager *layoutManager = (LayoutManager *)scene->getManager(kWKLayoutManager);
+    if (layoutManager && (pInfo.globeView || pInfo.mapView))
+    {
+        std::vector<ScreenSpaceObjectLocation> ssObjs;
+        layoutManager->getScreenSpaceObjects(pInfo,ssObjs);
+        for (const ScreenSpaceObjectLocation &ssObj : ssObjs)
+            if (!ssObj.shapeIDs.empty() && inRegion(ssObj.dispLoc))
+            {
+                SelectedObject selObj(ssObj.shapeIDs,(ssObj.dispLoc - eyePos).norm(),0.0);
+                selObj.isCluster = ssObj.isCluster;
+                selObjs.push_back(selObj);
+            }
+    }
+    
+    pthread_mutex_lock(&mutex);
+    
+    SimpleIDSet candidates;
+    regionIndex.findCandidates(dispLL,dispUR,candidates);
+    
+    for (SimpleIdentity selectID : candidates)
+    {
+        const Selectable *sel = NULL;
+        Point3d loc(0,0,0);
+        bool hit = false;
+        
+        auto it2 = rect2Dselectables.find(RectSelectable2D(selectID));
+        auto itM = movingRect2Dselectables.find(MovingRectSelectable2D(selectID));
+        auto it3 = polytopeSelectables.find(PolytopeSelectable(selectID));
+        auto it3a = movingPolytopeSelectables.find(MovingPolytopeSelectable(selectID));
+        auto it5 = linearSelectables.find(LinearSelectable(selectID));
+        auto it = rect3Dselectables.find(RectSelectable3D(selectID));
+        auto it4 = billboardSelectables.find(BillboardSelectable(selectID));
+        if (it2 != rect2Dselectables.end())
+        {
+            sel = &(*it2);
+            loc = it2->center;
+        } else if (itM != movingRect2Dselectables.end())
+        {
+            sel = &(*itM);
+            loc = itM->centerForTime(now);
+        } else if (it3 != polytopeSelectables.end())
+        {
+            sel = &(*it3);
+            loc = it3->centerPt;
+        } else if (it3a != movingPolytopeSelectables.end())
+        {
+            sel = &(*it3a);
+            double t = (now-it3a->startTime)/it3a->duration;
+            loc = (it3a->endCenterPt - it3a->centerPt)*t + it3a->centerPt;
+        } else if (it5 != linearSelectables.end())
+        {
+            // Linears count if any part of them is in there
+            sel = &(*it5);
+            if (isSelectableVisible(*sel,height) && !it5->pts.empty())
+            {
+                Point2fVector geoLine;
+                geoLine.reserve(it5->pts.size());
+                for (const Point3d &pt : it5->pts)
+                    geoLine.push_back(displayToGeo(pt));
+                hit = ShapeOverlapsRegion(geoLine,false,geoRegion,geoMbr);
+                loc = it5->pts[0];
+            }
+        } else if (it != rect3Dselectables.end())
+        {
+            sel = &(*it);
+            for (unsigned int ii=0;ii<4;ii++)
+                loc += Vector3fToVector3d(it->pts[ii]);
+            loc /= 4.0;
+        } else if (it4 != billboardSelectables.end())
+        {
+            sel = &(*it4);
+            loc = it4->center;
+        }
+        
+        if (!sel || !isSelectableVisible(*sel,height))
+            continue;
+        if (it5 == linearSelectables.end())
+            hit = inRegion(loc);
+        if (hit)
+            selObjs.push_back(SelectedObject(selectID,(loc - eyePos).norm(),0.0));
+    }
+    
+    fillAttributes(selObjs);
+    
+    pthread_mutex_unlock(&mutex);
+    
+    std::sort(selObjs.begin(),selObjs.end(),SelectedSorter);
+}
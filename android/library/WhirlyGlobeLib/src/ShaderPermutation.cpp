@@ -0,0 +1,634 @@
+/*
+ *  ShaderPermutation.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <ctype.h>
+#import <stdlib.h>
+#import <string.h>
+#import <algorithm>
+#import <sstream>
+#import "ShaderPermutation.h"
+#import "OpenGLES2Program.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+// Evaluates the expression on an #if or #elif line
+class ShaderExprParser
+{
+public:
+    ShaderExprParser(const std::string &expr,const std::map<std::string,std::string> &defines)
+    : expr(expr), pos(0), defines(defines), error(false)
+    {
+    }
+
+    // Returns false if the expression doesn't parse
+    bool evaluate(long &result)
+    {
+        result = parseOr();
+        skipSpace();
+        return !error && pos == expr.size();
+    }
+
+protected:
+    void skipSpace()
+    {
+        while (pos < expr.size() && isspace((unsigned char)expr[pos]))
+            pos++;
+    }
+
+    bool match(const char *tok)
+    {
+        skipSpace();
+        size_t len = strlen(tok);
+        if (expr.compare(pos,len,tok) == 0)
+        {
+            pos += len;
+            return true;
+        }
+        return false;
+    }
+
+    std::string parseIdent()
+    {
+        skipSpace();
+        size_t start = pos;
+        while (pos < expr.size() && (isalnum((unsigned char)expr[pos]) || expr[pos] == '_'))
+            pos++;
+        return expr.substr(start,pos-start);
+    }
+
+    long parseOr()
+    {
+        long val = parseAnd();
+        while (!error && match("||"))
+        {
+            long right = parseAnd();
+            val = val || right;
+        }
+        return val;
+    }
+
+    long parseAnd()
+    {
+        long val = parseUnary();
+        while (!error && match("&&"))
+        {
+            long right = parseUnary();
+            val = val && right;
+        }
+        return val;
+    }
+
+    long parseUnary()
+    {
+        if (match("!"))
+            return !parseUnary();
+        if (match("("))
+        {
+            long val = parseOr();
+            if (!match(")"))
+                error = true;
+            return val;
+        }
+
+        skipSpace();
+        if (pos < expr.size() && isdigit((unsigned char)expr[pos]))
+        {
+            char *end = NULL;
+            long val = strtol(expr.c_str()+pos,&end,0);
+            pos = end - expr.c_str();
+            return val;
+        }
+
+        std::string ident = parseIdent();
+        if (ident.empty())
+        {
+            error = true;
+            return 0;
+        }
+        if (ident == "defined")
+        {
+            bool paren = match("(");
+            std::string name = parseIdent();
+            if (name.empty() || (paren && !match(")")))
+            {
+                error = true;
+                return 0;
+            }
+            return defines.find(name) != defines.end();
+        }
+
+        // Defined names are their value, if it's a number, and everything else is zero
+        auto it = defines.find(ident);
+        if (it == defines.end())
+            return 0;
+        char *end = NULL;
+        long val = strtol(it->second.c_str(),&end,0);
+        return (end && *end == 0 && !it->second.empty()) ? val : 1;
+    }
+
+    const std::string &expr;
+    size_t pos;
+    const std::map<std::string,std::string> &defines;
+    bool error;
+};
+
+// State for one level of #if nesting
+typedef struct
+{
+    // Lines in here are live
+    bool active;
+    // Some branch at this level has been taken
+    bool taken;
+    bool seenElse;
+} ShaderCondLevel;
+
+bool ShaderPreprocess(const std::string &src,const std::set<std::string> &inDefines,std::string &outSrc,std::string &errStr)
+{
+    std::map<std::string,std::string> defines;
+    for (auto &def : inDefines)
+        defines[def] = "1";
+
+    std::vector<ShaderCondLevel> levels;
+    std::stringstream out;
+    std::istringstream in(src);
+    std::string line;
+    int lineNo = 0;
+    bool first = true;
+    while (std::getline(in,line))
+    {
+        lineNo++;
+        if (!first)
+            out << "\n";
+        first = false;
+
+        bool active = levels.empty() || levels.back().active;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] != '#')
+        {
+            if (active)
+                out << line;
+            continue;
+        }
+
+        // Split the directive from the rest
+        size_t dirStart = line.find_first_not_of(" \t",start+1);
+        size_t dirEnd = dirStart == std::string::npos ? std::string::npos : line.find_first_of(" \t(",dirStart);
+        std::string directive = dirStart == std::string::npos ? "" : line.substr(dirStart,dirEnd == std::string::npos ? std::string::npos : dirEnd-dirStart);
+        std::string rest = dirEnd == std::string::npos ? "" : line.substr(dirEnd);
+        size_t comment = rest.find("//");
+        if (comment != std::string::npos)
+            rest = rest.substr(0,comment);
+        std::istringstream restStream(rest);
+        std::string firstArg;
+        restStream >> firstArg;
+
+        bool parentActive = levels.empty() || levels.back().active;
+        if (directive == "ifdef" || directive == "ifndef" || directive == "if")
+        {
+            bool cond = false;
+            if (directive == "if")
+            {
+                long val = 0;
+                ShaderExprParser parser(rest,defines);
+                if (!parser.evaluate(val))
+                {
+                    errStr = "Line " + std::to_string(lineNo) + ": Can't evaluate #if expression";
+                    return false;
+                }
+                cond = val != 0;
+            } else {
+                if (firstArg.empty())
+                {
+                    errStr = "Line " + std::to_string(lineNo) + ": Missing name for #" + directive;
+                    return false;
+                }
+                cond = (defines.find(firstArg) != defines.end()) == (directive == "ifdef");
+            }
+            ShaderCondLevel level;
+            level.active = parentActive && cond;
+            level.taken = cond;
+            level.seenElse = false;
+            levels.push_back(level);
+        } else if (directive == "elif" || directive == "else" || directive == "endif") {
+            if (levels.empty())
+            {
+                errStr = "Line " + std::to_string(lineNo) + ": #" + directive + " without #if";
+                return false;
+            }
+            if (directive == "endif")
+            {
+                levels.pop_back();
+                continue;
+            }
+
+            ShaderCondLevel &level = levels.back();
+            if (level.seenElse)
+            {
+                errStr = "Line " + std::to_string(lineNo) + ": #" + directive + " after #else";
+                return false;
+            }
+            bool outerActive = levels.size() < 2 || levels[levels.size()-2].active;
+            bool cond = true;
+            if (directive == "elif")
+            {
+                long val = 0;
+                ShaderExprParser parser(rest,defines);
+                if (!parser.evaluate(val))
+                {
+                    errStr = "Line " + std::to_string(lineNo) + ": Can't evaluate #elif expression";
+                    return false;
+                }
+                cond = val != 0;
+            } else
+                level.seenElse = true;
+            level.active = outerActive && !level.taken && cond;
+            level.taken = level.taken || cond;
+        } else if (active) {
+            // Defines in live code count for later conditionals and get passed on as well
+            if (directive == "define" && !firstArg.empty())
+            {
+                std::string value;
+                std::getline(restStream,value);
+                size_t valStart = value.find_first_not_of(" \t");
+                defines[firstArg] = valStart == std::string::npos ? "" : value.substr(valStart);
+            } else if (directive == "undef" && !firstArg.empty())
+                defines.erase(firstArg);
+            out << line;
+        }
+    }
+
+    if (!levels.empty())
+    {
+        errStr = "Unterminated #if at end of source";
+        return false;
+    }
+
+    outSrc = out.str();
+    return true;
+}
+
+int ShaderVariable::numSlots() const
+{
+    int slots = 1;
+    if (type == "mat2")
+        slots = 2;
+    else if (type == "mat3")
+        slots = 3;
+    else if (type == "mat4")
+        slots = 4;
+
+    return slots * std::max(arraySize,1);
+}
+
+static const ShaderVariable *FindShaderVariable(const std::vector<ShaderVariable> &vars,const std::string &name)
+{
+    for (auto &var : vars)
+        if (var.name == name)
+            return &var;
+    return NULL;
+}
+
+const ShaderVariable *ShaderInterface::findUniform(const std::string &name) const
+{
+    return FindShaderVariable(uniforms,name);
+}
+
+const ShaderVariable *ShaderInterface::findAttribute(const std::string &name) const
+{
+    return FindShaderVariable(attributes,name);
+}
+
+// Blank out comments and preprocessor lines so all that's left is declarations and code
+static std::string StripShaderComments(const std::string &src)
+{
+    std::string ret;
+    ret.reserve(src.size());
+    bool lineStart = true;
+    for (size_t ii=0;ii<src.size();ii++)
+    {
+        char c = src[ii];
+        if (c == '/' && ii+1 < src.size() && src[ii+1] == '/')
+        {
+            while (ii < src.size() && src[ii] != '\n')
+                ii++;
+            ret += '\n';
+            lineStart = true;
+        } else if (c == '/' && ii+1 < src.size() && src[ii+1] == '*') {
+            size_t end = src.find("*/",ii+2);
+            ii = (end == std::string::npos) ? src.size() : end+1;
+            ret += ' ';
+        } else if (c == '#' && lineStart) {
+            while (ii < src.size() && src[ii] != '\n')
+                ii++;
+            ret += '\n';
+        } else {
+            ret += c;
+            if (c == '\n')
+                lineStart = true;
+            else if (!isspace((unsigned char)c))
+                lineStart = false;
+        }
+    }
+
+    return ret;
+}
+
+static bool IsPrecisionQualifier(const std::string &tok)
+{
+    return tok == "lowp" || tok == "mediump" || tok == "highp";
+}
+
+void ShaderReflect(const std::string &src,ShaderInterface &iface)
+{
+    std::string code = StripShaderComments(src);
+
+    // Declarations are statements that start with a storage qualifier
+    size_t start = 0;
+    while (start < code.size())
+    {
+        size_t end = code.find_first_of(";{}",start);
+        if (end == std::string::npos)
+            end = code.size();
+        std::string stmt = code.substr(start,end-start);
+        start = end+1;
+
+        // Split commas and brackets off into their own tokens
+        std::string spaced;
+        for (char c : stmt)
+        {
+            if (c == ',' || c == '[' || c == ']')
+            {
+                spaced += ' ';
+                spaced += c;
+                spaced += ' ';
+            } else
+                spaced += c;
+        }
+        std::istringstream toks(spaced);
+        std::vector<std::string> tokens;
+        std::string tok;
+        while (toks >> tok)
+            tokens.push_back(tok);
+
+        unsigned int which = 0;
+        if (which < tokens.size() && tokens[which] == "invariant")
+            which++;
+        if (which >= tokens.size())
+            continue;
+        std::vector<ShaderVariable> *vars = NULL;
+        if (tokens[which] == "uniform")
+            vars = &iface.uniforms;
+        else if (tokens[which] == "attribute")
+            vars = &iface.attributes;
+        else if (tokens[which] == "varying")
+            vars = &iface.varyings;
+        else
+            continue;
+        which++;
+        if (which < tokens.size() && IsPrecisionQualifier(tokens[which]))
+            which++;
+        if (which >= tokens.size())
+            continue;
+        std::string type = tokens[which++];
+
+        // One or more names, possibly arrays
+        while (which < tokens.size())
+        {
+            ShaderVariable var;
+            var.type = type;
+            var.name = tokens[which++];
+            if (which < tokens.size() && tokens[which] == "[")
+            {
+                if (which+2 < tokens.size() && tokens[which+2] == "]")
+                    var.arraySize = atoi(tokens[which+1].c_str());
+                which += 3;
+            }
+            if (!FindShaderVariable(*vars,var.name))
+                vars->push_back(var);
+            if (which < tokens.size() && tokens[which] == ",")
+                which++;
+            else
+                break;
+        }
+    }
+}
+
+ShaderModule::ShaderModule(const std::string &name,const std::string &vertSrc,const std::string &fragSrc)
+    : name(name), vertSrc(vertSrc), fragSrc(fragSrc)
+{
+}
+
+void ShaderModule::addFeature(int bit,const std::string &define,const std::string &keyName,int needs,int excludes,bool alwaysNamed)
+{
+    Feature feature;
+    feature.bit = bit;
+    feature.define = define;
+    feature.keyName = keyName;
+    feature.needs = needs;
+    feature.excludes = excludes;
+    feature.alwaysNamed = alwaysNamed;
+    features.push_back(feature);
+}
+
+int ShaderModule::normalizeFeatures(int inFeatures) const
+{
+    int known = 0;
+    for (auto &feature : features)
+        known |= feature.bit;
+    int ret = inFeatures & known;
+
+    // Dropping one feature can strand another, so go until it settles
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto &feature : features)
+            if ((ret & feature.bit) &&
+                ((ret & feature.needs) != feature.needs || (ret & feature.excludes)))
+            {
+                ret &= ~feature.bit;
+                changed = true;
+            }
+    }
+
+    return ret;
+}
+
+std::string ShaderModule::permutationName(int inFeatures) const
+{
+    int which = normalizeFeatures(inFeatures);
+
+    std::string ret = name;
+    for (auto &feature : features)
+    {
+        if (which & feature.bit)
+            ret += ";" + feature.keyName + "=yes";
+        else if (feature.alwaysNamed)
+            ret += ";" + feature.keyName + "=no";
+    }
+
+    return ret;
+}
+
+void ShaderModule::getDefines(int inFeatures,std::set<std::string> &defines) const
+{
+    int which = normalizeFeatures(inFeatures);
+    for (auto &feature : features)
+        if (which & feature.bit)
+            defines.insert(feature.define);
+}
+
+bool ShaderModule::buildSources(int inFeatures,std::string &outVert,std::string &outFrag,std::string &errStr) const
+{
+    std::set<std::string> defines;
+    getDefines(inFeatures,defines);
+
+    if (!ShaderPreprocess(vertSrc,defines,outVert,errStr))
+    {
+        errStr = "Vertex shader: " + errStr;
+        return false;
+    }
+    if (!ShaderPreprocess(fragSrc,defines,outFrag,errStr))
+    {
+        errStr = "Fragment shader: " + errStr;
+        return false;
+    }
+
+    return true;
+}
+
+bool ShaderModule::getAttributeLocations(int maxSlots,std::map<std::string,int> &locations) const
+{
+    // Every attribute any permutation might declare
+    ShaderInterface iface;
+    ShaderReflect(vertSrc,iface);
+
+    std::map<std::string,int> ret;
+    int slot = 0;
+    for (auto &attr : iface.attributes)
+    {
+        ret[attr.name] = slot;
+        slot += attr.numSlots();
+    }
+    if (slot > maxSlots)
+        return false;
+
+    locations = ret;
+    return true;
+}
+
+ShaderPermutationManager::ShaderPermutationManager()
+{
+    pthread_mutex_init(&lock, NULL);
+}
+
+ShaderPermutationManager::~ShaderPermutationManager()
+{
+    pthread_mutex_destroy(&lock);
+}
+
+void ShaderPermutationManager::addModule(const ShaderModule &module)
+{
+    pthread_mutex_lock(&lock);
+
+    modules[module.getName()] = module;
+
+    // Anything built from the old one is stale
+    for (auto it = programs.begin(); it != programs.end();)
+    {
+        if (it->first.module == module.getName())
+            programs.erase(it++);
+        else
+            ++it;
+    }
+    for (auto it = failed.begin(); it != failed.end();)
+    {
+        if (it->module == module.getName())
+            failed.erase(it++);
+        else
+            ++it;
+    }
+
+    pthread_mutex_unlock(&lock);
+}
+
+SimpleIdentity ShaderPermutationManager::getProgram(const std::string &moduleName,int features)
+{
+    SimpleIdentity progID = EmptyIdentity;
+
+    pthread_mutex_lock(&lock);
+
+    auto modIt = modules.find(moduleName);
+    if (modIt == modules.end())
+    {
+        pthread_mutex_unlock(&lock);
+        return EmptyIdentity;
+    }
+    const ShaderModule &module = modIt->second;
+    ShaderPermutationKey key(moduleName,module.normalizeFeatures(features));
+
+    // Cached, as long as the scene still has it
+    auto progIt = programs.find(key);
+    if (progIt != programs.end())
+    {
+        if (scene->getProgram(progIt->second))
+            progID = progIt->second;
+        else
+            programs.erase(progIt);
+    }
+
+    if (progID == EmptyIdentity && failed.find(key) == failed.end())
+    {
+        std::string permName = module.permutationName(key.features);
+        std::string vertSrc,fragSrc,errStr;
+        if (!module.buildSources(key.features,vertSrc,fragSrc,errStr))
+        {
+            WHIRLYKIT_LOGW("ShaderPermutationManager: Can't preprocess %s: %s",permName.c_str(),errStr.c_str());
+            failed.insert(key);
+        } else {
+            GLint maxAttrs = 0;
+            glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttrs);
+            std::map<std::string,int> attrLocs;
+            OpenGLES2Program *prog = NULL;
+            if (module.getAttributeLocations(maxAttrs,attrLocs))
+                prog = new OpenGLES2Program(permName,vertSrc,fragSrc,attrLocs);
+            else
+                prog = new OpenGLES2Program(permName,vertSrc,fragSrc);
+            if (!prog->isValid())
+            {
+                WHIRLYKIT_LOGW("ShaderPermutationManager: %s didn't compile",permName.c_str());
+                delete prog;
+                failed.insert(key);
+            } else {
+                scene->addProgram(permName, prog);
+                progID = prog->getId();
+                programs[key] = progID;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    return progID;
+}
+
+}
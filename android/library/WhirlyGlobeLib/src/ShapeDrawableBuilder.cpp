@@ -23,6 +23,7 @@
 #import "ShapeDrawableBuilder.h"
 #import "Tesselator.h"
 #import "Scene.h"
+#import "ViewState.h"
 
 using namespace Eigen;
 using namespace WhirlyKit;
@@ -35,7 +36,8 @@ namespace WhirlyKit
 
 WhirlyKitShapeInfo::WhirlyKitShapeInfo()
     : color(255,255,255,255), lineWidth(1.0), shapeId(EmptyIdentity), insideOut(false),
-    zBufferRead(true), zBufferWrite(true), hasCenter(false), center(0.0,0.0,0.0)
+    zBufferRead(true), zBufferWrite(true), hasCenter(false), center(0.0,0.0,0.0),
+    sampleLOD(false), lodEyePos(0.0,0.0,0.0), lodPixelsPerUnit(0.0), lodPixelsPerSample(0.0), lodMinSamples(0), lodMaxSamples(0)
 {
     shapeId = Identifiable::genId();
 }
@@ -44,6 +46,49 @@ WhirlyKitShapeInfo::~WhirlyKitShapeInfo()
 {
 }
 
+void WhirlyKitShapeInfo::setSampleLOD(const Point3d &eyePos,double pixelsPerUnit,double pixelsPerSample,int minSamples,int maxSamples)
+{
+    sampleLOD = pixelsPerUnit > 0.0 && pixelsPerSample > 0.0;
+    lodEyePos = eyePos;
+    lodPixelsPerUnit = pixelsPerUnit;
+    lodPixelsPerSample = pixelsPerSample;
+    lodMinSamples = std::max(minSamples,1);
+    lodMaxSamples = std::max(maxSamples,lodMinSamples);
+}
+
+void WhirlyKitShapeInfo::setSampleLOD(ViewState *viewState,const Point2f &frameSize,double pixelsPerSample,int minSamples,int maxSamples)
+{
+    if (!viewState || viewState->imagePlaneSize <= 0.0)
+    {
+        sampleLOD = false;
+        return;
+    }
+
+    // An object one unit across at the near plane covers this much of the screen
+    double pixelsPerUnit = frameSize.x() * viewState->nearPlane / (2.0 * viewState->imagePlaneSize);
+    setSampleLOD(viewState->eyePos,pixelsPerUnit,pixelsPerSample,minSamples,maxSamples);
+}
+
+int WhirlyKitShapeInfo::calcSamples(const Point3d &dispPt,double extent,double length,int defaultSamples)
+{
+    if (!sampleLOD)
+        return defaultSamples;
+
+    // Distance to the closest part of the shape, more or less
+    double dist = (dispPt - lodEyePos).norm() - std::abs(extent);
+    if (dist <= 0.0)
+        return lodMaxSamples;
+
+    double pixels = std::abs(length) * lodPixelsPerUnit / dist;
+    double samples = std::ceil(pixels / lodPixelsPerSample);
+    if (samples < lodMinSamples)
+        return lodMinSamples;
+    if (samples > lodMaxSamples)
+        return lodMaxSamples;
+
+    return (int)samples;
+}
+
 
 ShapeDrawableBuilder::ShapeDrawableBuilder(CoordSystemDisplayAdapter *coordAdapter, WhirlyKitShapeInfo *shapeInfo, bool linesOrPoints, const Point3d &center)
     : coordAdapter(coordAdapter), shapeInfo(shapeInfo), drawable(NULL), center(center)
@@ -351,6 +396,52 @@ void ShapeDrawableBuilderTri::addTriangles(Point3fVector &pts,Point3fVector &nor
     }
 }
 
+// Add a mesh, starting new drawables as we fill them up
+void ShapeDrawableBuilderTri::addTriangles(const Point3dVector &pts,const Point3fVector &norms,const std::vector<RGBAColor> &colors,const std::vector<BasicDrawable::Triangle> &tris,const Mbr &shapeMbr)
+{
+    // Where each of the source vertices ended up in the current drawable
+    std::vector<int> vertMap(pts.size(),-1);
+    bool mbrSet = false;
+
+    for (const BasicDrawable::Triangle &tri : tris)
+    {
+        if (!drawable ||
+            (drawable->getNumPoints()+3 > MaxDrawablePoints) ||
+            (drawable->getNumTris()+1 > MaxDrawableTriangles))
+        {
+            if (drawable)
+                flush();
+
+            setupNewDrawable();
+            std::fill(vertMap.begin(),vertMap.end(),-1);
+            mbrSet = false;
+        }
+        if (!mbrSet)
+        {
+            Mbr mbr = drawable->getLocalMbr();
+            mbr.expand(shapeMbr);
+            drawable->setLocalMbr(mbr);
+            drawMbr.expand(shapeMbr);
+            mbrSet = true;
+        }
+
+        BasicDrawable::Triangle newTri;
+        for (unsigned int jj=0;jj<3;jj++)
+        {
+            int which = tri.verts[jj];
+            if (vertMap[which] < 0)
+            {
+                vertMap[which] = drawable->getNumPoints();
+                drawable->addPoint((Point3d)(pts[which]-center));
+                drawable->addNormal(norms[which]);
+                drawable->addColor(colors[which]);
+            }
+            newTri.verts[jj] = vertMap[which];
+        }
+        drawable->addTriangle(newTri);
+    }
+}
+
 // Add a convex outline, triangulated
 void ShapeDrawableBuilderTri::addConvexOutline(Point3fVector &pts,Point3f norm,RGBAColor color,Mbr shapeMbr)
 {
@@ -24,6 +24,9 @@
 #include <set>
 #include <vector>
 #include "Identifiable.h"
+#include "VectorData.h"
+#include "Tesselator.h"
+#include <algorithm>
 
 using namespace Eigen;
 using namespace WhirlyKit;
@@ -105,16 +108,26 @@ void WhirlyKitSphere::makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *r
     // Run it up a bit by the height
     dispPt = dispPt + norm * height;
 
+    // Samples may depend on how big it is on the screen
+    int numX = sampleX, numY = sampleY;
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+    if (shapeInfo->getSampleLOD())
+    {
+        Point3d dispPt3d(dispPt.x(),dispPt.y(),dispPt.z());
+        numX = std::max(3,shapeInfo->calcSamples(dispPt3d,radius,2*M_PI*radius,sampleX));
+        numY = std::max(2,numX/2);
+    }
+
     // It's lame, but we'll use lat/lon coordinates to tesselate the sphere
     // Note: Replace this with something less lame
     Point3fVector locs,norms;
-    locs.reserve((getSampleX()+1)*(getSampleY())+1);
-    norms.reserve((getSampleX()+1)*(getSampleY()+1));
+    locs.reserve((numX+1)*(numY)+1);
+    norms.reserve((numX+1)*(numY+1));
     std::vector<RGBAColor> colors;
-    colors.reserve((getSampleX()+1)*(getSampleY()+1));
-    Point2f geoIncr(2*M_PI/getSampleX(),M_PI/getSampleY());
-	for (unsigned int iy=0;iy<getSampleY()+1;iy++) {
-        for (unsigned int ix=0;ix<getSampleX()+1;ix++) {
+    colors.reserve((numX+1)*(numY+1));
+    Point2f geoIncr(2*M_PI/numX,M_PI/numY);
+	for (unsigned int iy=0;iy<numY+1;iy++) {
+        for (unsigned int ix=0;ix<numX+1;ix++) {
             GeoCoord geoLoc(-M_PI+ix*geoIncr.x(),-M_PI/2.0 + iy*geoIncr.y());
             if (geoLoc.x() < -M_PI)  geoLoc.x() = -M_PI;
             if (geoLoc.x() > M_PI) geoLoc.x() = M_PI;
@@ -132,26 +145,26 @@ void WhirlyKitSphere::makeGeometryWithBuilder(WhirlyKit::ShapeDrawableBuilder *r
 
     // Two triangles per cell
     std::vector<BasicDrawable::Triangle> tris;
-    tris.reserve(2*getSampleX()*getSampleY());
-	for (unsigned int iy=0;iy<getSampleY();iy++) {
-        for (unsigned int ix=0;ix<getSampleX();ix++) {
+    tris.reserve(2*numX*numY);
+	for (unsigned int iy=0;iy<numY;iy++) {
+        for (unsigned int ix=0;ix<numX;ix++) {
             BasicDrawable::Triangle triA,triB;
             if (regBuilder->shapeInfo->getInsideOut()) {
                 // Flip the triangles
-                triA.verts[0] = iy*(getSampleX()+1)+ix;
-                triA.verts[2] = iy*(getSampleX()+1)+(ix+1);
-                triA.verts[1] = (iy+1)*(getSampleX()+1)+(ix+1);
+                triA.verts[0] = iy*(numX+1)+ix;
+                triA.verts[2] = iy*(numX+1)+(ix+1);
+                triA.verts[1] = (iy+1)*(numX+1)+(ix+1);
                 triB.verts[0] = triA.verts[0];
                 triB.verts[2] = triA.verts[1];
-                triB.verts[1] = (iy+1)*(getSampleX()+1)+ix;
+                triB.verts[1] = (iy+1)*(numX+1)+ix;
             }
 			else {
-                triA.verts[0] = iy*(getSampleX()+1)+ix;
-                triA.verts[1] = iy*(getSampleX()+1)+(ix+1);
-                triA.verts[2] = (iy+1)*(getSampleX()+1)+(ix+1);
+                triA.verts[0] = iy*(numX+1)+ix;
+                triA.verts[1] = iy*(numX+1)+(ix+1);
+                triA.verts[2] = (iy+1)*(numX+1)+(ix+1);
                 triB.verts[0] = triA.verts[0];
                 triB.verts[1] = triA.verts[2];
-                triB.verts[2] = (iy+1)*(getSampleX()+1)+ix;
+                triB.verts[2] = (iy+1)*(numX+1)+ix;
             }
             tris.push_back(triA);
             tris.push_back(triB);
@@ -240,6 +253,817 @@ void WhirlyKitRectangle::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilde
     // Note: Should do selection too
 }
 
+// Number of samples for a circle when the sample LOD isn't on
+static const int DefaultCircleSamples = 10;
+
+// Set up east and north axes perpendicular to the given up vector.
+// Flat maps just use the map axes.
+static void ShapeLocalAxes(CoordSystemDisplayAdapter *coordAdapter,const Point3d &up,Point3d &xAxis,Point3d &yAxis)
+{
+    if (coordAdapter->isFlat())
+    {
+        xAxis = Point3d(1,0,0);
+        yAxis = Point3d(0,1,0);
+    } else {
+        Point3d north(0,0,1);
+        xAxis = north.cross(up);
+        // North isn't much help at the poles
+        if (xAxis.squaredNorm() < 1e-12)
+            xAxis = Point3d(0,1,0).cross(up);
+        xAxis.normalize();
+        yAxis = up.cross(xAxis);  yAxis.normalize();
+    }
+}
+
+// Selection box between ll and ur along the given axes, in the same corner order the sphere uses
+static void ShapeSelectBox(const Point3d &org,const Point3d &xAxis,const Point3d &yAxis,const Point3d &zAxis,const Point3d &ll,const Point3d &ur,Point3f *pts)
+{
+    for (unsigned int ii=0;ii<8;ii++)
+    {
+        unsigned int corner = ii % 4;
+        double x = (corner == 1 || corner == 2) ? ur.x() : ll.x();
+        double y = (corner >= 2) ? ur.y() : ll.y();
+        double z = (ii >= 4) ? ur.z() : ll.z();
+        Point3d pt = org + x * xAxis + y * yAxis + z * zAxis;
+        pts[ii] = Point3f(pt.x(),pt.y(),pt.z());
+    }
+}
+
+/** Indexed geometry for a single shape.
+    We collect it here so the vertices can be shared, then hand it
+    to the triangle builder, which batches it with everything else.
+  */
+class ShapeMesh
+{
+public:
+    ShapeMesh(CoordSystemDisplayAdapter *coordAdapter,const RGBAColor &color,bool insideOut)
+    : coordAdapter(coordAdapter), color(color), insideOut(insideOut)
+    {
+    }
+
+    // Add a vertex in display coordinates, returning its index
+    int addPoint(const Point3d &pt,const Point3d &norm)
+    {
+        Point3d thisNorm = insideOut ? -norm : norm;
+        pts.push_back(pt);
+        norms.push_back(Point3f(thisNorm.x(),thisNorm.y(),thisNorm.z()));
+        colors.push_back(color);
+        Point3d localPt = coordAdapter->displayToLocal(pt);
+        mbr.addPoint(Point2f(localPt.x(),localPt.y()));
+
+        return (int)pts.size()-1;
+    }
+
+    // Add a triangle, wound counter clockwise as seen from the side the normals face
+    void addTri(int a,int b,int c)
+    {
+        Point3d faceNorm = (pts[b]-pts[a]).cross(pts[c]-pts[a]);
+        if (faceNorm.squaredNorm() == 0.0)
+            return;
+        Point3f vertNorm = norms[a] + norms[b] + norms[c];
+        if (faceNorm.x()*vertNorm.x() + faceNorm.y()*vertNorm.y() + faceNorm.z()*vertNorm.z() < 0.0)
+            std::swap(b,c);
+        tris.push_back(BasicDrawable::Triangle(a,b,c));
+    }
+
+    // Triangles for a grid of vertices, sizeX across, starting at the given index
+    void addGrid(int startIdx,int sizeX,int sizeY)
+    {
+        for (int iy=0;iy<sizeY-1;iy++)
+            for (int ix=0;ix<sizeX-1;ix++)
+            {
+                int v0 = startIdx + iy*sizeX + ix;
+                int v1 = v0 + 1;
+                int v2 = v1 + sizeX;
+                int v3 = v0 + sizeX;
+                addTri(v0,v1,v2);
+                addTri(v0,v2,v3);
+            }
+    }
+
+    // A fan around the center with the given normal.  The ring is closed for us.
+    void addFan(const Point3d &center,const Point3dVector &ring,const Point3d &norm)
+    {
+        int centerIdx = addPoint(center,norm);
+        for (const Point3d &pt : ring)
+            addPoint(pt,norm);
+        for (unsigned int ii=0;ii<ring.size();ii++)
+            addTri(centerIdx,centerIdx+1+ii,centerIdx+1+(ii+1)%ring.size());
+    }
+
+    void flush(ShapeDrawableBuilderTri *triBuilder)
+    {
+        if (!tris.empty())
+            triBuilder->addTriangles(pts,norms,colors,tris,mbr);
+        pts.clear();  norms.clear();  colors.clear();  tris.clear();
+        mbr.reset();
+    }
+
+    CoordSystemDisplayAdapter *coordAdapter;
+    RGBAColor color;
+    bool insideOut;
+    Point3dVector pts;
+    Point3fVector norms;
+    std::vector<RGBAColor> colors;
+    std::vector<BasicDrawable::Triangle> tris;
+    Mbr mbr;
+};
+
+// Location in display space, pushed up along the normal
+static Point3d ShapeDisplayLoc(CoordSystemDisplayAdapter *coordAdapter,const GeoCoord &loc,double height,Point3d &norm)
+{
+    Point3d localPt = coordAdapter->getCoordSystem()->geographicToLocal3d(loc);
+    norm = coordAdapter->normalForLocal(localPt);
+
+    return coordAdapter->localToDisplay(localPt) + norm * height;
+}
+
+WhirlyKitCircle::WhirlyKitCircle()
+    : loc(0,0), radius(0.0), height(0.0), sampleX(DefaultCircleSamples)
+{
+}
+
+WhirlyKitCircle::~WhirlyKitCircle()
+{
+}
+
+Point3d WhirlyKitCircle::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    return ShapeDisplayLoc(coordAdapter,loc,0.0,norm);
+}
+
+// Build the geometry for a circle in display space
+void WhirlyKitCircle::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    Point3d norm;
+    Point3d dispPt = ShapeDisplayLoc(coordAdapter,loc,height,norm);
+    Point3d xAxis,yAxis;
+    ShapeLocalAxes(coordAdapter,norm,xAxis,yAxis);
+
+    int numSamples = std::max(3,shapeInfo->calcSamples(dispPt,radius,2*M_PI*radius,sampleX));
+    Point3dVector samples(numSamples);
+    for (int ii=0;ii<numSamples;ii++)
+    {
+        double ang = 2*M_PI*ii/numSamples;
+        samples[ii] = dispPt + radius * (cos(ang) * xAxis + sin(ang) * yAxis);
+    }
+
+    // It's flat, so inside out doesn't mean anything
+    ShapeMesh mesh(coordAdapter,theColor,false);
+    mesh.addFan(dispPt,samples,norm);
+    mesh.flush(triBuilder);
+
+    // Add a selection region
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        Point3f pts[8];
+        ShapeSelectBox(dispPt,xAxis,yAxis,norm,Point3d(-radius,-radius,0.0),Point3d(radius,radius,0.0),pts);
+        selectManager->addSelectableRectSolid(getSelectID(),pts,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
+WhirlyKitCylinder::WhirlyKitCylinder()
+    : loc(0,0), baseHeight(0.0), radius(0.0), height(0.0), sampleX(DefaultCircleSamples)
+{
+}
+
+WhirlyKitCylinder::~WhirlyKitCylinder()
+{
+}
+
+Point3d WhirlyKitCylinder::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    return ShapeDisplayLoc(coordAdapter,loc,0.0,norm);
+}
+
+void WhirlyKitCylinder::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    Point3d norm;
+    Point3d dispPt = ShapeDisplayLoc(coordAdapter,loc,baseHeight,norm);
+    Point3d xAxis,yAxis;
+    ShapeLocalAxes(coordAdapter,norm,xAxis,yAxis);
+
+    int numSamples = std::max(3,shapeInfo->calcSamples(dispPt + norm * height/2.0,std::max(radius,height/2.0f),2*M_PI*radius,sampleX));
+
+    ShapeMesh mesh(coordAdapter,theColor,shapeInfo->getInsideOut());
+
+    // Sides run bottom to top, with normals pointing straight out
+    Point3dVector bot(numSamples),top(numSamples);
+    int sideStart = (int)mesh.pts.size();
+    for (int iy=0;iy<2;iy++)
+        for (int ii=0;ii<=numSamples;ii++)
+        {
+            double ang = 2*M_PI*ii/numSamples;
+            Point3d dir = cos(ang) * xAxis + sin(ang) * yAxis;
+            Point3d pt = dispPt + radius * dir + (iy == 0 ? 0.0 : height) * norm;
+            mesh.addPoint(pt,dir);
+            if (ii < numSamples)
+                (iy == 0 ? bot : top)[ii] = pt;
+        }
+    mesh.addGrid(sideStart,numSamples+1,2);
+
+    // And the caps
+    mesh.addFan(dispPt + height * norm,top,norm);
+    mesh.addFan(dispPt,bot,-norm);
+    mesh.flush(triBuilder);
+
+    // Add a selection region
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        Point3f pts[8];
+        ShapeSelectBox(dispPt,xAxis,yAxis,norm,Point3d(-radius,-radius,0.0),Point3d(radius,radius,height),pts);
+        selectManager->addSelectableRectSolid(getSelectID(),pts,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
+WhirlyKitCone::WhirlyKitCone()
+    : loc(0,0), baseHeight(0.0), radius(0.0), height(0.0), sampleX(DefaultCircleSamples)
+{
+}
+
+WhirlyKitCone::~WhirlyKitCone()
+{
+}
+
+Point3d WhirlyKitCone::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    return ShapeDisplayLoc(coordAdapter,loc,0.0,norm);
+}
+
+void WhirlyKitCone::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    Point3d norm;
+    Point3d dispPt = ShapeDisplayLoc(coordAdapter,loc,baseHeight,norm);
+    Point3d xAxis,yAxis;
+    ShapeLocalAxes(coordAdapter,norm,xAxis,yAxis);
+    Point3d apex = dispPt + height * norm;
+
+    int numSamples = std::max(3,shapeInfo->calcSamples(dispPt + norm * height/2.0,std::max(radius,height/2.0f),2*M_PI*radius,sampleX));
+
+    ShapeMesh mesh(coordAdapter,theColor,shapeInfo->getInsideOut());
+
+    // Sides get a normal perpendicular to the slant.  The point gets its own vertex per side.
+    Point3dVector base(numSamples);
+    int sideStart = (int)mesh.pts.size();
+    for (int ii=0;ii<=numSamples;ii++)
+    {
+        double ang = 2*M_PI*ii/numSamples;
+        Point3d dir = cos(ang) * xAxis + sin(ang) * yAxis;
+        Point3d pt = dispPt + radius * dir;
+        mesh.addPoint(pt,(height * dir + radius * norm).normalized());
+        if (ii < numSamples)
+            base[ii] = pt;
+    }
+    for (int ii=0;ii<numSamples;ii++)
+    {
+        double ang = 2*M_PI*(ii+0.5)/numSamples;
+        Point3d dir = cos(ang) * xAxis + sin(ang) * yAxis;
+        int apexIdx = mesh.addPoint(apex,(height * dir + radius * norm).normalized());
+        mesh.addTri(sideStart+ii,sideStart+ii+1,apexIdx);
+    }
+
+    mesh.addFan(dispPt,base,-norm);
+    mesh.flush(triBuilder);
+
+    // Add a selection region
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        Point3f pts[8];
+        ShapeSelectBox(dispPt,xAxis,yAxis,norm,Point3d(-radius,-radius,0.0),Point3d(radius,radius,height),pts);
+        selectManager->addSelectableRectSolid(getSelectID(),pts,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
+WhirlyKitEllipsoid::WhirlyKitEllipsoid()
+    : loc(0,0), height(0.0), radii(0,0,0), heading(0.0), sampleX(DefaultCircleSamples), sampleY(DefaultCircleSamples)
+{
+}
+
+WhirlyKitEllipsoid::~WhirlyKitEllipsoid()
+{
+}
+
+Point3d WhirlyKitEllipsoid::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    return ShapeDisplayLoc(coordAdapter,loc,0.0,norm);
+}
+
+void WhirlyKitEllipsoid::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    Point3d norm;
+    Point3d dispPt = ShapeDisplayLoc(coordAdapter,loc,height,norm);
+    Point3d eastAxis,northAxis;
+    ShapeLocalAxes(coordAdapter,norm,eastAxis,northAxis);
+
+    // Turn the axes by the heading
+    Point3d xAxis = cos(heading) * eastAxis - sin(heading) * northAxis;
+    Point3d yAxis = sin(heading) * eastAxis + cos(heading) * northAxis;
+
+    double maxRadius = std::max(radii.x(),std::max(radii.y(),radii.z()));
+    int numX = sampleX, numY = sampleY;
+    if (shapeInfo->getSampleLOD())
+    {
+        numX = shapeInfo->calcSamples(dispPt,maxRadius,2*M_PI*maxRadius,sampleX);
+        numY = numX/2;
+    }
+    numX = std::max(numX,3);
+    numY = std::max(numY,2);
+
+    ShapeMesh mesh(coordAdapter,theColor,shapeInfo->getInsideOut());
+
+    // Latitude and longitude style grid over the ellipsoid
+    for (int iy=0;iy<=numY;iy++)
+    {
+        double lat = -M_PI/2.0 + M_PI*iy/numY;
+        for (int ix=0;ix<=numX;ix++)
+        {
+            double lon = 2*M_PI*ix/numX;
+            Point3d dir(cos(lat)*cos(lon),cos(lat)*sin(lon),sin(lat));
+            Point3d pt = dispPt + radii.x() * dir.x() * xAxis + radii.y() * dir.y() * yAxis + radii.z() * dir.z() * norm;
+            Point3d thisNorm = (radii.x() > 0.0 ? dir.x() / radii.x() : 0.0) * xAxis +
+                               (radii.y() > 0.0 ? dir.y() / radii.y() : 0.0) * yAxis +
+                               (radii.z() > 0.0 ? dir.z() / radii.z() : 0.0) * norm;
+            mesh.addPoint(pt,thisNorm.normalized());
+        }
+    }
+    mesh.addGrid(0,numX+1,numY+1);
+    mesh.flush(triBuilder);
+
+    // Add a selection region
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        Point3f pts[8];
+        ShapeSelectBox(dispPt,xAxis,yAxis,norm,-radii,radii,pts);
+        selectManager->addSelectableRectSolid(getSelectID(),pts,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
+// Point on the unit sphere for a geographic coordinate
+static Point3d GeoToUnitSphere(const GeoCoord &geo)
+{
+    return Point3d(cos(geo.lat())*cos(geo.lon()),cos(geo.lat())*sin(geo.lon()),sin(geo.lat()));
+}
+
+WhirlyKitGreatCircle::WhirlyKitGreatCircle()
+    : startPt(0,0), endPt(0,0), height(0.0), radius(0.0), lineWidth(1.0), sampleX(0), sampleY(8)
+{
+}
+
+WhirlyKitGreatCircle::~WhirlyKitGreatCircle()
+{
+}
+
+Point3d WhirlyKitGreatCircle::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    Point3d startDisp = ShapeDisplayLoc(coordAdapter,startPt,0.0,norm);
+    Point3d endDisp = ShapeDisplayLoc(coordAdapter,endPt,0.0,norm);
+
+    return (startDisp + endDisp)/2.0;
+}
+
+// Interpolate along the great circle on a unit sphere, then project.
+// That works for flat maps as well as the globe.
+void WhirlyKitGreatCircle::calcPath(CoordSystemDisplayAdapter *coordAdapter,int numSegments,Point3dVector &pts,Point3dVector &norms)
+{
+    Point3d a = GeoToUnitSphere(startPt);
+    Point3d b = GeoToUnitSphere(endPt);
+    double omega = acos(std::min(1.0,std::max(-1.0,a.dot(b))));
+    double sinOmega = sin(omega);
+
+    pts.resize(numSegments+1);
+    norms.resize(numSegments+1);
+    for (int ii=0;ii<=numSegments;ii++)
+    {
+        double t = ii/(double)numSegments;
+        Point3d pt;
+        if (sinOmega < 1e-12)
+            pt = (1.0-t) * a + t * b;
+        else
+            pt = (sin((1.0-t)*omega) * a + sin(t*omega) * b) / sinOmega;
+        GeoCoord geo(atan2(pt.y(),pt.x()),asin(std::min(1.0,std::max(-1.0,pt.z()/pt.norm()))));
+
+        Point3d localPt = coordAdapter->getCoordSystem()->geographicToLocal3d(geo);
+        localPt.z() = height * sin(M_PI*t);
+        pts[ii] = coordAdapter->localToDisplay(localPt);
+        norms[ii] = coordAdapter->normalForLocal(localPt);
+    }
+}
+
+void WhirlyKitGreatCircle::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    // Figure out how finely to cut up the arc
+    double angle = acos(std::min(1.0,std::max(-1.0,GeoToUnitSphere(startPt).dot(GeoToUnitSphere(endPt)))));
+    int numSegments = sampleX;
+    if (numSegments <= 0)
+        numSegments = std::max(2,(int)(angle / (M_PI/180.0)));
+    Point3d norm;
+    Point3d startDisp = ShapeDisplayLoc(coordAdapter,startPt,0.0,norm);
+    Point3d endDisp = ShapeDisplayLoc(coordAdapter,endPt,0.0,norm);
+    // Note: This is the chord, which is short for long arcs on the globe
+    double length = (endDisp - startDisp).norm() + height;
+    numSegments = std::max(1,shapeInfo->calcSamples((startDisp + endDisp)/2.0,length/2.0,length,numSegments));
+
+    Point3dVector path,pathNorms;
+    calcPath(coordAdapter,numSegments,path,pathNorms);
+
+    Point3fVector pts3f(path.size());
+    Mbr shapeMbr;
+    for (unsigned int ii=0;ii<path.size();ii++)
+    {
+        const Point3d &pt = path[ii];
+        pts3f[ii] = Point3f(pt.x(),pt.y(),pt.z());
+        Point3d localPt = coordAdapter->displayToLocal(pt);
+        shapeMbr.addPoint(Point2f(localPt.x(),localPt.y()));
+    }
+
+    if (radius <= 0.0)
+    {
+        regBuilder->addPoints(pts3f, theColor, shapeMbr, lineWidth, false);
+    } else {
+        int numRing = std::max(3,shapeInfo->calcSamples(path[path.size()/2],radius,2*M_PI*radius,sampleY));
+        ShapeMesh mesh(coordAdapter,theColor,false);
+
+        // Run a ring around each point on the path, perpendicular to it
+        Point3dVector startRing,endRing;
+        Point3d startDir,endDir;
+        for (unsigned int ii=0;ii<path.size();ii++)
+        {
+            Point3d dir = path[std::min(ii+1,(unsigned int)path.size()-1)] - path[ii > 0 ? ii-1 : 0];
+            dir.normalize();
+            Point3d side = dir.cross(pathNorms[ii]);
+            if (side.squaredNorm() < 1e-12)
+                side = dir.unitOrthogonal();
+            side.normalize();
+            Point3d up = side.cross(dir);
+            for (int ir=0;ir<=numRing;ir++)
+            {
+                double ang = 2*M_PI*ir/numRing;
+                Point3d ringDir = cos(ang) * side + sin(ang) * up;
+                Point3d pt = path[ii] + radius * ringDir;
+                mesh.addPoint(pt,ringDir);
+                if (ir < numRing)
+                {
+                    if (ii == 0)
+                        startRing.push_back(pt);
+                    else if (ii == path.size()-1)
+                        endRing.push_back(pt);
+                }
+            }
+            if (ii == 0)
+                startDir = dir;
+            endDir = dir;
+        }
+        mesh.addGrid(0,numRing+1,(int)path.size());
+        mesh.addFan(path.front(),startRing,-startDir);
+        mesh.addFan(path.back(),endRing,endDir);
+        mesh.flush(triBuilder);
+    }
+
+    // Add a selection region
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        selectManager->addSelectableLinear(getSelectID(),pts3f,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
+WhirlyKitShapeLinear::WhirlyKitShapeLinear()
+    : lineWidth(1.0)
+{
+}
+
+WhirlyKitShapeLinear::~WhirlyKitShapeLinear()
+{
+}
+
+Point3d WhirlyKitShapeLinear::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    if (!pts.empty())
+    {
+        const Point3f &pt = pts[pts.size()/2];
+        return Point3d(pt.x(),pt.y(),pt.z());
+    } else
+        return Point3d(0,0,0);
+}
+
+void WhirlyKitShapeLinear::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    auto theColor = getUseColor() ? getColor() : regBuilder->getShapeInfo()->getColor();
+
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        selectManager->addSelectableLinear(getSelectID(),pts,regBuilder->getShapeInfo()->minVis,regBuilder->getShapeInfo()->maxVis,regBuilder->getShapeInfo()->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+
+    regBuilder->addPoints(pts, theColor, mbr, lineWidth, false);
+}
+
+WhirlyKitShapeExtruded::WhirlyKitShapeExtruded()
+    : loc(0,0,0), thickness(0.0), transform(Eigen::Matrix4d::Identity())
+{
+}
+
+WhirlyKitShapeExtruded::~WhirlyKitShapeExtruded()
+{
+}
+
+Point3d WhirlyKitShapeExtruded::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    return ShapeDisplayLoc(coordAdapter,GeoCoord(loc.x(),loc.y()),0.0,norm);
+}
+
+void WhirlyKitShapeExtruded::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    if (pts.size() < 3)
+        return;
+
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    Point3d norm;
+    Point3d dispPt = ShapeDisplayLoc(coordAdapter,GeoCoord(loc.x(),loc.y()),0.0,norm);
+    Point3d xAxis,yAxis;
+    ShapeLocalAxes(coordAdapter,norm,xAxis,yAxis);
+
+    // Set up a shift matrix that moves coordinates to the right orientation on the globe (or not)
+    Matrix4d shiftMat = Matrix4d::Identity();
+    shiftMat.block<3,1>(0,0) = xAxis;
+    shiftMat.block<3,1>(0,1) = yAxis;
+    shiftMat.block<3,1>(0,2) = norm;
+
+    // Now add in the transform for orientation
+    shiftMat = shiftMat * transform;
+
+    // Run around the outline, building top and bottom
+    // Note: Should deal with doubles rather than floats
+    VectorRing ring(pts.size());
+    for (unsigned int ii=0;ii<pts.size();ii++)
+        ring[ii] = Point2f(pts[ii].x(),pts[ii].y());
+    VectorTrianglesRef trisRef = VectorTriangles::createTriangles();
+    TesselateRing(ring,trisRef);
+    // Sides point out, which depends on which way the outline runs
+    bool clockwise = CalcLoopArea(ring) < 0.0;
+
+    double botZ = loc.z() - thickness/2.0, topZ = loc.z() + thickness/2.0;
+    Vector4d topNorm4d = shiftMat * Vector4d(0,0,1,0);
+    Point3d topNorm = Point3d(topNorm4d.x(),topNorm4d.y(),topNorm4d.z()).normalized();
+
+    ShapeMesh mesh(coordAdapter,theColor,shapeInfo->getInsideOut());
+    std::vector<Point3dVector> polytope;
+
+    auto shiftPt = [&](double x,double y,double z) -> Point3d
+    {
+        Vector4d pt4d = shiftMat * Vector4d(x,y,z,1.0);
+        return Point3d(pt4d.x(),pt4d.y(),pt4d.z())/pt4d.w() + dispPt;
+    };
+
+    for (const VectorTriangles::Triangle &tri : trisRef->tris)
+    {
+        Point3dVector bot(3),top(3);
+        int botIdx[3],topIdx[3];
+        for (unsigned int jj=0;jj<3;jj++)
+        {
+            const Point3f &pt = trisRef->pts[tri.pts[jj]];
+            bot[jj] = shiftPt(pt.x(),pt.y(),botZ);
+            top[jj] = shiftPt(pt.x(),pt.y(),topZ);
+            botIdx[jj] = mesh.addPoint(bot[jj],-topNorm);
+            topIdx[jj] = mesh.addPoint(top[jj],topNorm);
+        }
+        mesh.addTri(topIdx[0],topIdx[1],topIdx[2]);
+        mesh.addTri(botIdx[0],botIdx[1],botIdx[2]);
+
+        polytope.push_back(top);
+        polytope.push_back(bot);
+    }
+
+    // Work around the outside doing sides
+    for (unsigned int ii=0;ii<pts.size();ii++)
+    {
+        const Point2d &p0 = pts[ii];
+        const Point2d &p1 = pts[(ii+1)%pts.size()];
+        Point2d edgeNorm(p1.y()-p0.y(),p0.x()-p1.x());
+        if (clockwise)
+            edgeNorm = -edgeNorm;
+        Vector4d sideNorm4d = shiftMat * Vector4d(edgeNorm.x(),edgeNorm.y(),0.0,0.0);
+        Point3d sideNorm = Point3d(sideNorm4d.x(),sideNorm4d.y(),sideNorm4d.z()).normalized();
+
+        Point3dVector side(4);
+        side[0] = shiftPt(p0.x(),p0.y(),botZ);
+        side[1] = shiftPt(p1.x(),p1.y(),botZ);
+        side[2] = shiftPt(p1.x(),p1.y(),topZ);
+        side[3] = shiftPt(p0.x(),p0.y(),topZ);
+        int startIdx = (int)mesh.pts.size();
+        for (const Point3d &pt : side)
+            mesh.addPoint(pt,sideNorm);
+        mesh.addTri(startIdx,startIdx+1,startIdx+2);
+        mesh.addTri(startIdx,startIdx+2,startIdx+3);
+
+        polytope.push_back(side);
+    }
+    mesh.flush(triBuilder);
+
+    // Add a selection region
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        selectManager->addPolytope(getSelectID(),polytope,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
+WhirlyKitSector::WhirlyKitSector()
+    : loc(0,0), baseHeight(0.0), minRange(0.0), maxRange(0.0), startAz(0.0), endAz(2*M_PI), minElev(0.0), maxElev(M_PI/2.0),
+    sampleAz(2*DefaultCircleSamples), sampleElev(DefaultCircleSamples)
+{
+}
+
+WhirlyKitSector::~WhirlyKitSector()
+{
+}
+
+Point3d WhirlyKitSector::displayCenter(CoordSystemDisplayAdapter *coordAdapter,WhirlyKitShapeInfo *shapeInfo)
+{
+    if (shapeInfo->getHasCenter())
+        return shapeInfo->getCenter();
+
+    Point3d norm;
+    return ShapeDisplayLoc(coordAdapter,loc,0.0,norm);
+}
+
+void WhirlyKitSector::makeGeometryWithBuilder(ShapeDrawableBuilder *regBuilder,ShapeDrawableBuilderTri *triBuilder,Scene *scene,SelectionManager *selectManager,ShapeSceneRep *sceneRep)
+{
+    if (maxRange <= 0.0 || maxRange <= minRange || endAz <= startAz || maxElev <= minElev)
+        return;
+
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    WhirlyKitShapeInfo *shapeInfo = triBuilder->getShapeInfo();
+
+    auto theColor = getUseColor() ? getColor() : shapeInfo->getColor();
+
+    Point3d up;
+    Point3d org = ShapeDisplayLoc(coordAdapter,loc,baseHeight,up);
+    Point3d east,north;
+    ShapeLocalAxes(coordAdapter,up,east,north);
+
+    double azSpan = std::min(endAz - startAz,2*M_PI);
+    bool fullCircle = azSpan >= 2*M_PI - 1e-6;
+    double elevMin = std::max(minElev,-M_PI/2.0), elevMax = std::min(maxElev,M_PI/2.0);
+    int numAz = std::max(1,shapeInfo->calcSamples(org,maxRange,maxRange*azSpan,sampleAz));
+    int numElev = std::max(1,shapeInfo->calcSamples(org,maxRange,maxRange*(elevMax-elevMin),sampleElev));
+
+    // Horizontal direction for an azimuth and the direction it turns in
+    auto horizDir = [&](double az) -> Point3d { return cos(az) * north + sin(az) * east; };
+    auto horizTurn = [&](double az) -> Point3d { return -sin(az) * north + cos(az) * east; };
+    auto azAt = [&](int ia) { return startAz + azSpan*ia/numAz; };
+    auto elevAt = [&](int ie) { return elevMin + (elevMax-elevMin)*ie/numElev; };
+
+    ShapeMesh mesh(coordAdapter,theColor,shapeInfo->getInsideOut());
+
+    // Outer shell and, if there is one, inner shell
+    for (int shell=0;shell<2;shell++)
+    {
+        double range = shell == 0 ? maxRange : minRange;
+        if (range <= 0.0)
+            continue;
+        int startIdx = (int)mesh.pts.size();
+        for (int ie=0;ie<=numElev;ie++)
+        {
+            double elev = elevAt(ie);
+            for (int ia=0;ia<=numAz;ia++)
+            {
+                Point3d dir = cos(elev) * horizDir(azAt(ia)) + sin(elev) * up;
+                mesh.addPoint(org + range * dir,shell == 0 ? dir : -dir);
+            }
+        }
+        mesh.addGrid(startIdx,numAz+1,numElev+1);
+    }
+
+    // Cones at the top and bottom of the elevation range, unless they've collapsed to a line
+    for (int face=0;face<2;face++)
+    {
+        double elev = face == 0 ? elevMin : elevMax;
+        if (std::abs(elev) >= M_PI/2.0 - 1e-6)
+            continue;
+        int startIdx = (int)mesh.pts.size();
+        for (int ir=0;ir<2;ir++)
+        {
+            double range = ir == 0 ? minRange : maxRange;
+            for (int ia=0;ia<=numAz;ia++)
+            {
+                Point3d horiz = horizDir(azAt(ia));
+                Point3d dir = cos(elev) * horiz + sin(elev) * up;
+                Point3d faceNorm = -sin(elev) * horiz + cos(elev) * up;
+                mesh.addPoint(org + range * dir,face == 0 ? -faceNorm : faceNorm);
+            }
+        }
+        mesh.addGrid(startIdx,numAz+1,2);
+    }
+
+    // Flat sides at the ends of the azimuth range
+    if (!fullCircle)
+    {
+        for (int face=0;face<2;face++)
+        {
+            double az = face == 0 ? startAz : startAz + azSpan;
+            Point3d faceNorm = face == 0 ? -horizTurn(az) : horizTurn(az);
+            int startIdx = (int)mesh.pts.size();
+            for (int ir=0;ir<2;ir++)
+            {
+                double range = ir == 0 ? minRange : maxRange;
+                for (int ie=0;ie<=numElev;ie++)
+                {
+                    double elev = elevAt(ie);
+                    Point3d dir = cos(elev) * horizDir(az) + sin(elev) * up;
+                    mesh.addPoint(org + range * dir,faceNorm);
+                }
+            }
+            mesh.addGrid(startIdx,numElev+1,2);
+        }
+    }
+
+    // Selection box around everything in the local frame
+    Point3d ll(0,0,0),ur(0,0,0);
+    for (unsigned int ii=0;ii<mesh.pts.size();ii++)
+    {
+        Point3d rel = mesh.pts[ii] - org;
+        Point3d boxPt(rel.dot(east),rel.dot(north),rel.dot(up));
+        if (ii == 0)
+            ll = ur = boxPt;
+        else {
+            ll = ll.cwiseMin(boxPt);
+            ur = ur.cwiseMax(boxPt);
+        }
+    }
+
+    mesh.flush(triBuilder);
+
+    if (getSelectable() && selectManager && sceneRep)
+    {
+        Point3f pts[8];
+        ShapeSelectBox(org,east,north,up,ll,ur,pts);
+        selectManager->addSelectableRectSolid(getSelectID(),pts,shapeInfo->minVis,shapeInfo->maxVis,shapeInfo->enable);
+        sceneRep->selectIDs.insert(getSelectID());
+    }
+}
+
 ShapeManager::ShapeManager()
 {
     pthread_mutex_init(&shapeLock, NULL);
@@ -258,6 +1082,8 @@ ShapeManager::~ShapeManager()
 /// Add an array of shapes.  The returned ID can be used to remove or modify the group of shapes.
 SimpleIdentity ShapeManager::addShapes(std::vector<WhirlyKitShape*> shapes, WhirlyKitShapeInfo *shapeInfo, ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(shapeInfo->memLabel);
     SelectionManager *selectManager = (SelectionManager *)getScene()->getManager(kWKSelectionManager);
 
     ShapeSceneRep *sceneRep = new ShapeSceneRep(shapeInfo->getShapeId());
@@ -291,9 +1117,15 @@ SimpleIdentity ShapeManager::addShapes(std::vector<WhirlyKitShape*> shapes, Whir
     drawBuildTri.flush();
     drawBuildTri.getChanges(changes, sceneRep->drawIDs);
 
+    // Keyframe tracks can animate the shapes as a whole
+    if (!sceneRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),sceneRep->drawIDs));
+
     pthread_mutex_lock(&shapeLock);
     shapeReps.insert(sceneRep);
     pthread_mutex_unlock(&shapeLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
 
     return shapeInfo->getShapeId();
 }
@@ -337,6 +1169,8 @@ void ShapeManager::removeShapes(SimpleIDSet &shapeIDs,ChangeSet &changes)
             }
             
 			shapeRep->clearContents(selectManager, changes, removeTime);
+			changes.push_back(new SetAnimFeatureReq(shapeRep->getId(),SimpleIDSet()));
+			untrackSceneRep(shapeRep->getId());
 			shapeReps.erase(sit);
 			delete shapeRep;
         }
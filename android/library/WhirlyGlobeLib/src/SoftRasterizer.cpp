@@ -0,0 +1,510 @@
+/*
+ *  SoftRasterizer.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <unistd.h>
+#import <math.h>
+#import <algorithm>
+#import "SoftRasterizer.h"
+
+using namespace Eigen;
+
+namespace WhirlyKit
+{
+
+// Where the various interpolated values live in ScreenVert::attrs
+static const int AttrColor = 0;
+static const int AttrUV = 4;
+static const int AttrExtra = 6;
+static const int NumAttrs = 7;
+
+// Anything closer than this in w is behind the eye as far as we're concerned
+static const float SoftClipEpsilon = 1e-5;
+
+SoftFrameBuffer::SoftFrameBuffer(int width,int height)
+    : width(width), height(height)
+{
+    color.resize(4*width*height,0);
+    depth.resize(width*height,1.0);
+}
+
+void SoftFrameBuffer::clear(const RGBAColor &clearColor,float clearDepth)
+{
+    for (unsigned int ii=0;ii<width*height;ii++)
+    {
+        unsigned char *pix = &color[4*ii];
+        pix[0] = clearColor.r;  pix[1] = clearColor.g;  pix[2] = clearColor.b;  pix[3] = clearColor.a;
+    }
+    std::fill(depth.begin(),depth.end(),clearDepth);
+}
+
+RawDataRef SoftFrameBuffer::asRawData() const
+{
+    if (color.empty())
+        return RawDataRef();
+
+    return RawDataRef(new MutableRawData((void *)&color[0],(unsigned int)color.size()));
+}
+
+SoftTexture::SoftTexture()
+    : pixels(NULL), width(0), height(0), pixSize(4), wrapU(false), wrapV(false), linear(true)
+{
+}
+
+Vector4f SoftTexture::texel(int x,int y) const
+{
+    if (wrapU)
+    {
+        x = x % width;
+        if (x < 0)  x += width;
+    } else
+        x = std::min(std::max(x,0),width-1);
+    if (wrapV)
+    {
+        y = y % height;
+        if (y < 0)  y += height;
+    } else
+        y = std::min(std::max(y,0),height-1);
+
+    const unsigned char *pix = &pixels[pixSize*(y*width+x)];
+    if (pixSize == 1)
+        return Vector4f(0.0,0.0,0.0,pix[0]/255.0);
+
+    return Vector4f(pix[0]/255.0,pix[1]/255.0,pix[2]/255.0,pix[3]/255.0);
+}
+
+Vector4f SoftTexture::sample(float u,float v) const
+{
+    if (!pixels || width <= 0 || height <= 0)
+        return Vector4f(1,1,1,1);
+
+    if (!linear)
+        return texel((int)floorf(u*width),(int)floorf(v*height));
+
+    // Texel centers are at the half pixel
+    float fx = u*width - 0.5, fy = v*height - 0.5;
+    float x0 = floorf(fx), y0 = floorf(fy);
+    float ax = fx - x0, ay = fy - y0;
+    int ix = (int)x0, iy = (int)y0;
+
+    Vector4f top = texel(ix,iy) * (1.0-ax) + texel(ix+1,iy) * ax;
+    Vector4f bot = texel(ix,iy+1) * (1.0-ax) + texel(ix+1,iy+1) * ax;
+
+    return top * (1.0-ay) + bot * ay;
+}
+
+SoftDrawState::SoftDrawState()
+    : shadeMode(SoftShadeColor), tex(NULL), depthTest(false), depthWrite(false), cullBack(true),
+      useExtraTest(false), w2(1.0), edge(0.0), constColor(1,1,1,1)
+{
+}
+
+SoftRasterizer::SoftRasterizer(SoftFrameBuffer *frameBuffer,int inNumThreads,int tileSize)
+    : frameBuffer(frameBuffer), numThreads(inNumThreads), tileSize(std::max(tileSize,8)), curTile(0)
+{
+    if (numThreads <= 0)
+    {
+        long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = numCores > 0 ? (int)numCores : 1;
+    }
+
+    tilesX = (frameBuffer->getWidth() + this->tileSize - 1) / this->tileSize;
+    tilesY = (frameBuffer->getHeight() + this->tileSize - 1) / this->tileSize;
+    bins.resize(tilesX*tilesY);
+
+    pthread_mutex_init(&tileLock, NULL);
+}
+
+SoftRasterizer::~SoftRasterizer()
+{
+    pthread_mutex_destroy(&tileLock);
+}
+
+int SoftRasterizer::addState(const SoftDrawState &state)
+{
+    states.push_back(state);
+
+    return (int)states.size()-1;
+}
+
+// Linear interpolation of everything in a vertex, used by the clipper
+static SoftVertex LerpVertex(const SoftVertex &a,const SoftVertex &b,float t)
+{
+    SoftVertex ret;
+    ret.pos = a.pos + (b.pos - a.pos) * t;
+    ret.color = a.color + (b.color - a.color) * t;
+    ret.uv = a.uv + (b.uv - a.uv) * t;
+    ret.extra = a.extra + (b.extra - a.extra) * t;
+
+    return ret;
+}
+
+// Distance to one of the clip planes we care about.  Positive is inside.
+static float ClipDist(const SoftVertex &vert,int plane)
+{
+    switch (plane)
+    {
+        case 0:
+            return vert.pos.w() - SoftClipEpsilon;
+        case 1:
+            return vert.pos.z() + vert.pos.w();
+        default:
+            return vert.pos.w() - vert.pos.z();
+    }
+}
+
+// Sutherland-Hodgman against the w, near and far planes.
+// The sides are handled by the bounding box in screen space.
+static void ClipPolygon(std::vector<SoftVertex,Eigen::aligned_allocator<SoftVertex> > &poly)
+{
+    std::vector<SoftVertex,Eigen::aligned_allocator<SoftVertex> > out;
+    for (int plane=0;plane<3 && !poly.empty();plane++)
+    {
+        out.clear();
+        for (unsigned int ii=0;ii<poly.size();ii++)
+        {
+            const SoftVertex &a = poly[ii];
+            const SoftVertex &b = poly[(ii+1)%poly.size()];
+            float da = ClipDist(a,plane), db = ClipDist(b,plane);
+            if (da >= 0.0)
+                out.push_back(a);
+            if ((da >= 0.0) != (db >= 0.0))
+                out.push_back(LerpVertex(a,b,da/(da-db)));
+        }
+        poly = out;
+    }
+}
+
+void SoftRasterizer::project(const SoftVertex &vert,ScreenVert &screenVert)
+{
+    float invW = 1.0/vert.pos.w();
+    float ndcX = vert.pos.x() * invW, ndcY = vert.pos.y() * invW, ndcZ = vert.pos.z() * invW;
+
+    // Flip Y so row 0 is the top
+    screenVert.x = (ndcX * 0.5 + 0.5) * frameBuffer->getWidth();
+    screenVert.y = (0.5 - ndcY * 0.5) * frameBuffer->getHeight();
+    screenVert.z = ndcZ * 0.5 + 0.5;
+    screenVert.invW = invW;
+
+    for (unsigned int ii=0;ii<4;ii++)
+        screenVert.attrs[AttrColor+ii] = vert.color[ii] * invW;
+    screenVert.attrs[AttrUV] = vert.uv.x() * invW;
+    screenVert.attrs[AttrUV+1] = vert.uv.y() * invW;
+    screenVert.attrs[AttrExtra] = vert.extra * invW;
+}
+
+void SoftRasterizer::addTriangle(const SoftVertex &v0,const SoftVertex &v1,const SoftVertex &v2,int state)
+{
+    std::vector<SoftVertex,Eigen::aligned_allocator<SoftVertex> > poly;
+    poly.reserve(6);
+    poly.push_back(v0);  poly.push_back(v1);  poly.push_back(v2);
+
+    // Only clip if we need to
+    bool needsClip = false;
+    for (unsigned int ii=0;ii<3;ii++)
+        for (int plane=0;plane<3;plane++)
+            if (ClipDist(poly[ii],plane) < 0.0)
+                needsClip = true;
+    if (needsClip)
+        ClipPolygon(poly);
+    if (poly.size() < 3)
+        return;
+
+    std::vector<ScreenVert> screenVerts(poly.size());
+    for (unsigned int ii=0;ii<poly.size();ii++)
+        project(poly[ii],screenVerts[ii]);
+
+    // Clipped polygon is convex, so a fan will do
+    for (unsigned int ii=1;ii<screenVerts.size()-1;ii++)
+        addScreenTri(screenVerts[0],screenVerts[ii],screenVerts[ii+1],state,true);
+}
+
+void SoftRasterizer::addLine(const SoftVertex &v0,const SoftVertex &v1,float width,int state)
+{
+    SoftVertex a = v0, b = v1;
+    for (int plane=0;plane<3;plane++)
+    {
+        float da = ClipDist(a,plane), db = ClipDist(b,plane);
+        if (da < 0.0 && db < 0.0)
+            return;
+        if (da < 0.0)
+            a = LerpVertex(a,b,da/(da-db));
+        else if (db < 0.0)
+            b = LerpVertex(a,b,da/(da-db));
+    }
+
+    ScreenVert sa,sb;
+    project(a,sa);
+    project(b,sb);
+
+    // Expand out to a quad in screen space
+    float dx = sb.x - sa.x, dy = sb.y - sa.y;
+    float len = sqrtf(dx*dx+dy*dy);
+    if (len == 0.0)
+        return;
+    float hw = std::max(width,1.f) / 2.0;
+    float nx = -dy/len * hw, ny = dx/len * hw;
+
+    ScreenVert corners[4] = {sa,sa,sb,sb};
+    corners[0].x += nx;  corners[0].y += ny;
+    corners[1].x -= nx;  corners[1].y -= ny;
+    corners[2].x -= nx;  corners[2].y -= ny;
+    corners[3].x += nx;  corners[3].y += ny;
+    addScreenTri(corners[0],corners[1],corners[2],state,false);
+    addScreenTri(corners[0],corners[2],corners[3],state,false);
+}
+
+void SoftRasterizer::addPoint(const SoftVertex &v0,float size,int state)
+{
+    for (int plane=0;plane<3;plane++)
+        if (ClipDist(v0,plane) < 0.0)
+            return;
+
+    ScreenVert sv;
+    project(v0,sv);
+
+    float hs = std::max(size,1.f) / 2.0;
+    ScreenVert corners[4] = {sv,sv,sv,sv};
+    corners[0].x -= hs;  corners[0].y -= hs;
+    corners[1].x += hs;  corners[1].y -= hs;
+    corners[2].x += hs;  corners[2].y += hs;
+    corners[3].x -= hs;  corners[3].y += hs;
+    addScreenTri(corners[0],corners[1],corners[2],state,false);
+    addScreenTri(corners[0],corners[2],corners[3],state,false);
+}
+
+void SoftRasterizer::addScreenTri(const ScreenVert &v0,const ScreenVert &v1,const ScreenVert &v2,int state,bool canCull)
+{
+    if (state < 0 || state >= states.size())
+        return;
+
+    float area = (v1.x-v0.x)*(v2.y-v0.y) - (v2.x-v0.x)*(v1.y-v0.y);
+    if (area == 0.0)
+        return;
+
+    // Y is flipped, so counter clockwise in clip space comes out negative here
+    if (canCull && states[state].cullBack && area > 0.0)
+        return;
+
+    ScreenTri tri;
+    tri.state = state;
+    tri.verts[0] = v0;
+    // Keep everything in one winding for the rasterizer
+    if (area > 0.0)
+    {
+        tri.verts[1] = v1;  tri.verts[2] = v2;
+    } else {
+        tri.verts[1] = v2;  tri.verts[2] = v1;
+    }
+
+    float minX = std::min(v0.x,std::min(v1.x,v2.x)), maxX = std::max(v0.x,std::max(v1.x,v2.x));
+    float minY = std::min(v0.y,std::min(v1.y,v2.y)), maxY = std::max(v0.y,std::max(v1.y,v2.y));
+    if (maxX < 0.0 || maxY < 0.0 || minX >= frameBuffer->getWidth() || minY >= frameBuffer->getHeight())
+        return;
+
+    int sx = std::max((int)floorf(minX),0) / tileSize, ex = std::min((int)floorf(maxX),frameBuffer->getWidth()-1) / tileSize;
+    int sy = std::max((int)floorf(minY),0) / tileSize, ey = std::min((int)floorf(maxY),frameBuffer->getHeight()-1) / tileSize;
+
+    int triIdx = (int)tris.size();
+    tris.push_back(tri);
+    for (int iy=sy;iy<=ey;iy++)
+        for (int ix=sx;ix<=ex;ix++)
+            bins[iy*tilesX+ix].push_back(triIdx);
+}
+
+void SoftRasterizer::shadeFragment(const SoftDrawState &state,const float *attrs,Vector4f &outColor,bool &keep)
+{
+    keep = true;
+    if (state.useExtraTest && attrs[AttrExtra] <= 0.0)
+    {
+        keep = false;
+        return;
+    }
+
+    switch (state.shadeMode)
+    {
+        case SoftShadeColor:
+        {
+            outColor = Vector4f(attrs[AttrColor],attrs[AttrColor+1],attrs[AttrColor+2],attrs[AttrColor+3]);
+            if (state.tex)
+                outColor = outColor.cwiseProduct(state.tex->sample(attrs[AttrUV],attrs[AttrUV+1]));
+        }
+            break;
+        case SoftShadeWideVector:
+        {
+            float patternVal = state.tex ? state.tex->sample(0.5,attrs[AttrUV+1]).w() : 1.0;
+            float alpha = 1.0;
+            float across = attrs[AttrUV] * state.w2;
+            if (across < state.edge)
+                alpha = across/state.edge;
+            if (across > state.w2-state.edge)
+                alpha = (state.w2-across)/state.edge;
+            outColor = state.constColor * alpha * patternVal;
+        }
+            break;
+    }
+}
+
+// Does an edge own the pixels that fall exactly on it
+static inline bool IsTopLeft(const SoftRasterizer::ScreenVert &a,const SoftRasterizer::ScreenVert &b)
+{
+    float dx = b.x - a.x, dy = b.y - a.y;
+    return (dy < 0.0) || (dy == 0.0 && dx > 0.0);
+}
+
+void SoftRasterizer::rasterizeTile(int tileIndex)
+{
+    const std::vector<int> &bin = bins[tileIndex];
+    if (bin.empty())
+        return;
+
+    int tileX0 = (tileIndex % tilesX) * tileSize, tileY0 = (tileIndex / tilesX) * tileSize;
+    int tileX1 = std::min(tileX0 + tileSize, frameBuffer->getWidth()) - 1;
+    int tileY1 = std::min(tileY0 + tileSize, frameBuffer->getHeight()) - 1;
+
+    float attrs[NumAttrs];
+    Vector4f src;
+    for (int triIdx : bin)
+    {
+        const ScreenTri &tri = tris[triIdx];
+        const SoftDrawState &state = states[tri.state];
+        const ScreenVert &v0 = tri.verts[0], &v1 = tri.verts[1], &v2 = tri.verts[2];
+
+        int minX = std::max((int)floorf(std::min(v0.x,std::min(v1.x,v2.x))),tileX0);
+        int maxX = std::min((int)ceilf(std::max(v0.x,std::max(v1.x,v2.x))),tileX1);
+        int minY = std::max((int)floorf(std::min(v0.y,std::min(v1.y,v2.y))),tileY0);
+        int maxY = std::min((int)ceilf(std::max(v0.y,std::max(v1.y,v2.y))),tileY1);
+        if (minX > maxX || minY > maxY)
+            continue;
+
+        float area = (v1.x-v0.x)*(v2.y-v0.y) - (v2.x-v0.x)*(v1.y-v0.y);
+        float invArea = 1.0/area;
+        bool tl0 = IsTopLeft(v1,v2), tl1 = IsTopLeft(v2,v0), tl2 = IsTopLeft(v0,v1);
+
+        for (int py=minY;py<=maxY;py++)
+        {
+            float cy = py + 0.5;
+            unsigned char *colorRow = frameBuffer->colorAt(0,py);
+            float *depthRow = frameBuffer->depthAt(0,py);
+            for (int px=minX;px<=maxX;px++)
+            {
+                float cx = px + 0.5;
+                float e0 = (v2.x-v1.x)*(cy-v1.y) - (v2.y-v1.y)*(cx-v1.x);
+                float e1 = (v0.x-v2.x)*(cy-v2.y) - (v0.y-v2.y)*(cx-v2.x);
+                float e2 = (v1.x-v0.x)*(cy-v0.y) - (v1.y-v0.y)*(cx-v0.x);
+                if (e0 < 0.0 || e1 < 0.0 || e2 < 0.0)
+                    continue;
+                if ((e0 == 0.0 && !tl0) || (e1 == 0.0 && !tl1) || (e2 == 0.0 && !tl2))
+                    continue;
+
+                float l0 = e0*invArea, l1 = e1*invArea, l2 = e2*invArea;
+
+                float z = l0*v0.z + l1*v1.z + l2*v2.z;
+                float &dstDepth = depthRow[px];
+                if (state.depthTest && !(z < dstDepth))
+                    continue;
+
+                // Perspective correct interpolation
+                float invW = l0*v0.invW + l1*v1.invW + l2*v2.invW;
+                float w = invW != 0.0 ? 1.0/invW : 0.0;
+                for (unsigned int ii=0;ii<NumAttrs;ii++)
+                    attrs[ii] = (l0*v0.attrs[ii] + l1*v1.attrs[ii] + l2*v2.attrs[ii]) * w;
+
+                bool keep;
+                shadeFragment(state,attrs,src,keep);
+                if (!keep)
+                    continue;
+
+                // Premultiplied blend, same as GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+                unsigned char *dst = &colorRow[4*px];
+                float srcA = std::min(std::max(src.w(),0.f),1.f);
+                for (unsigned int ii=0;ii<4;ii++)
+                {
+                    float val = std::min(std::max(src[ii],0.f),1.f) + dst[ii]/255.0 * (1.0-srcA);
+                    dst[ii] = (unsigned char)(std::min(std::max(val,0.f),1.f) * 255.0 + 0.5);
+                }
+
+                if (state.depthWrite)
+                    dstDepth = z;
+            }
+        }
+    }
+}
+
+int SoftRasterizer::nextTile()
+{
+    int which = -1;
+    pthread_mutex_lock(&tileLock);
+    if (curTile < bins.size())
+        which = curTile++;
+    pthread_mutex_unlock(&tileLock);
+
+    return which;
+}
+
+// Worker threads pull tiles until there are none left
+static void *SoftRasterizerWorker(void *data)
+{
+    SoftRasterizer *raster = (SoftRasterizer *)data;
+    int which;
+    while ((which = raster->nextTile()) >= 0)
+        raster->rasterizeTile(which);
+
+    return NULL;
+}
+
+void SoftRasterizer::flush()
+{
+    if (tris.empty())
+        return;
+
+    curTile = 0;
+    int threadsToUse = std::min(numThreads,(int)bins.size());
+    if (threadsToUse <= 1)
+    {
+        for (unsigned int ii=0;ii<bins.size();ii++)
+            rasterizeTile(ii);
+    } else {
+        // The current thread does its share too
+        std::vector<pthread_t> threads;
+        for (int ii=0;ii<threadsToUse-1;ii++)
+        {
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, &SoftRasterizerWorker, this) == 0)
+                threads.push_back(thread);
+        }
+        SoftRasterizerWorker(this);
+        for (pthread_t thread : threads)
+            pthread_join(thread, NULL);
+    }
+
+    tris.clear();
+    for (auto &bin : bins)
+        bin.clear();
+}
+
+void SoftRasterizer::clear()
+{
+    tris.clear();
+    for (auto &bin : bins)
+        bin.clear();
+    states.clear();
+}
+
+}
@@ -37,6 +37,17 @@ SphericalChunk::SphericalChunk()
 {
 }
 
+void SphericalChunk::setWarp(GroundControlWarpRef inWarp)
+{
+    warp = inWarp;
+    if (warp && warp->isValid())
+    {
+        Point2d ll,ur;
+        warp->getBounds(ll,ur);
+        mbr = Mbr(Point2f(ll.x(),ll.y()),Point2f(ur.x(),ur.y()));
+    }
+}
+
 static const float SkirtFactor = 0.95;
 
 // Helper routine for constructing the skirt around a tile
@@ -148,9 +159,42 @@ void SphericalChunk::buildDrawable(BasicDrawable **draw,BasicDrawable **skirtDra
     std::vector<TexCoord> texCoords;
     
     Point2f texIncr;
-    // Without rotation, we'll just follow the boundaries
-    if (rotation == 0.0)
+    if (warp && warp->isValid())
+    {
+        // Work out where the mesh needs to bend, then run the pixels through the warp
+        auto toDisplay = [&](const Point2d &pixel) -> Point3d
+        {
+            Point2d loc = warp->pixelToLocal(pixel);
+            return coordAdapter->localToDisplay(CoordSystemConvert3d(srcSystem, localSys, Point3d(loc.x(),loc.y(),0.0)));
+        };
+        std::vector<double> xs,ys;
+        warp->buildSampleGrid(toDisplay, eps, minSampleX, minSampleY, sampleX, sampleY, xs, ys);
+        thisSampleX = (int)xs.size()-1;
+        thisSampleY = (int)ys.size()-1;
+        locs.resize((thisSampleX+1)*(thisSampleY+1));
+        texCoords.resize((thisSampleX+1)*(thisSampleY+1));
+        
+        // Rows go from the bottom of the image up to match the other cases
+        for (unsigned int iy=0;iy<thisSampleY+1;iy++)
+            for (unsigned int ix=0;ix<thisSampleX+1;ix++)
+            {
+                Point2d pixel(xs[ix],ys[thisSampleY-iy]);
+                Point2d loc = warp->pixelToLocal(pixel);
+                localMbr.addPoint(Point2f(loc.x(),loc.y()));
+                Point3d dispLoc = toDisplay(pixel);
+                Point3f dispLoc3f = Point3f(dispLoc.x(),dispLoc.y(),dispLoc.z());
+                
+                locs[iy*(thisSampleX+1)+ix] = dispLoc3f;
+                TexCoord texCoord(pixel.x() / warp->getImageWidth(), pixel.y() / warp->getImageHeight());
+                texCoords[iy*(thisSampleX+1)+ix] = texCoord;
+                
+                drawable->addPoint(dispLoc3f);
+                drawable->addTexCoord(0,texCoord);
+                drawable->addNormal(coordAdapter->isFlat() ? Point3f(0,0,1) : dispLoc3f);
+            }
+    } else if (rotation == 0.0)
     {
+        // Without rotation, we'll just follow the boundaries
         Point3f srcLL,srcUR;
         srcLL = Point3f(pts[0].x(),pts[0].y(),0.0);
         srcUR = Point3f(pts[2].x(),pts[2].y(),0.0);
@@ -469,6 +513,8 @@ void SphericalChunkManager::processChunkRequest(ChunkRequest &request,ChangeSet
     {
         case ChunkAdd:
         {
+            unsigned int startChange = changes.size();
+            int memTag = getMemTag(request.chunkInfo.memLabel);
             CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
             ChunkSceneRepRef chunkRep(new ChunkSceneRep(request.chunkId));
             SphericalChunk *chunk = request.chunk;
@@ -553,6 +599,8 @@ void SphericalChunkManager::processChunkRequest(ChunkRequest &request,ChangeSet
             pthread_mutex_lock(&repLock);
             chunkReps.insert(chunkRep);
             pthread_mutex_unlock(&repLock);
+            tagChanges(changes,startChange,memTag);
+            trackSceneRep(chunkRep->getId(),sizeof(*chunkRep),memTag);
         }
             break;
         case ChunkEnable:
@@ -583,6 +631,7 @@ void SphericalChunkManager::processChunkRequest(ChunkRequest &request,ChangeSet
             if (it != chunkReps.end())
 	      {
                 (*it)->clear(scene,texAtlas,drawAtlas,changes);
+                untrackSceneRep((*it)->getId());
 		chunkReps.erase(it);
 	      }
             pthread_mutex_unlock(&repLock);
@@ -0,0 +1,276 @@
+/*
+ *  SpriteSheet.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdexcept>
+#import "SpriteSheet.h"
+#import "Texture.h"
+#import "WhirlyKitLog.h"
+#import "libjson.h"
+
+using namespace libjson;
+
+namespace WhirlyKit
+{
+
+SpriteIcon::SpriteIcon()
+    : x(0), y(0), width(0), height(0), pixelRatio(1.0), sdf(false), subTexID(EmptyIdentity), texID(EmptyIdentity)
+{
+}
+
+SpriteSheet::SpriteSheet(const std::string &name)
+    : name(name), width(0), height(0), texID(EmptyIdentity)
+{
+}
+
+SpriteSheet::~SpriteSheet()
+{
+}
+
+bool SpriteSheet::parseIndex(const std::string &json)
+{
+    JSONNode topNode;
+    try {
+        topNode = libjson::parse(json);
+    }
+    catch (std::exception &exc)
+    {
+        WHIRLYKIT_LOGE("SpriteSheet: Failed to parse index for %s",name.c_str());
+        return false;
+    }
+    if (topNode.type() != JSON_NODE)
+        return false;
+
+    // Each entry is an icon name with its location in the sheet
+    for (JSONNode::const_iterator it = topNode.begin(); it != topNode.end(); ++it)
+    {
+        if (it->type() != JSON_NODE)
+            continue;
+
+        SpriteIcon icon;
+        icon.name = it->name();
+        for (JSONNode::const_iterator fit = it->begin(); fit != it->end(); ++fit)
+        {
+            json_string fieldName = fit->name();
+            if (fieldName == "x")
+                icon.x = fit->as_int();
+            else if (fieldName == "y")
+                icon.y = fit->as_int();
+            else if (fieldName == "width")
+                icon.width = fit->as_int();
+            else if (fieldName == "height")
+                icon.height = fit->as_int();
+            else if (fieldName == "pixelRatio")
+                icon.pixelRatio = fit->as_float();
+            else if (fieldName == "sdf")
+                icon.sdf = fit->as_bool();
+        }
+        if (icon.width <= 0 || icon.height <= 0 || icon.pixelRatio <= 0.0)
+            continue;
+
+        icons[icon.name] = icon;
+    }
+
+    return !icons.empty();
+}
+
+bool SpriteSheet::setImage(RawDataRef inImageData,int inWidth,int inHeight)
+{
+    if (!inImageData || inImageData->getLen() < (size_t)inWidth*inHeight*4)
+    {
+        WHIRLYKIT_LOGE("SpriteSheet: Image for %s is too small",name.c_str());
+        return false;
+    }
+
+    imageData = inImageData;
+    width = inWidth;
+    height = inHeight;
+
+    return true;
+}
+
+void SpriteSheet::getIconNames(std::vector<std::string> &names) const
+{
+    for (auto it : icons)
+        names.push_back(it.first);
+}
+
+bool SpriteSheet::findIcon(const std::string &iconName,SpriteIcon &icon) const
+{
+    std::map<std::string,SpriteIcon>::const_iterator it = icons.find(iconName);
+    if (it == icons.end())
+        return false;
+
+    icon = it->second;
+    return true;
+}
+
+bool SpriteSheet::processIntoScene(Scene *scene,ChangeSet &changes)
+{
+    if (!imageData || width <= 0 || height <= 0 || isInScene())
+        return false;
+
+    // One texture for the whole sheet.  No mipmaps, since they'd bleed between icons.
+    Texture *tex = new Texture("Sprite Sheet " + name,imageData,false);
+    tex->setWidth(width);
+    tex->setHeight(height);
+    tex->setUsesMipmaps(false);
+    tex->setInterpType(GL_LINEAR);
+    texID = tex->getId();
+    changes.push_back(new AddTextureReq(tex));
+
+    std::vector<SubTexture> subTexs;
+    for (auto &it : icons)
+    {
+        SpriteIcon &icon = it.second;
+        // Drop icons that hang off the edge
+        if (icon.x < 0 || icon.y < 0 || icon.x + icon.width > width || icon.y + icon.height > height)
+        {
+            WHIRLYKIT_LOGW("SpriteSheet: Icon %s is outside sheet %s",icon.name.c_str(),name.c_str());
+            continue;
+        }
+
+        SubTexture subTex;
+        subTex.texId = texID;
+        subTex.setFromTex(TexCoord((float)icon.x / width,(float)icon.y / height),
+                          TexCoord((float)(icon.x+icon.width) / width,(float)(icon.y+icon.height) / height));
+        icon.subTexID = subTex.getId();
+        icon.texID = texID;
+        subTexs.push_back(subTex);
+    }
+    scene->addSubTextures(subTexs);
+
+    // The texture has its own copy now
+    imageData.reset();
+
+    return true;
+}
+
+void SpriteSheet::clearFromScene(Scene *scene,ChangeSet &changes)
+{
+    if (!isInScene())
+        return;
+
+    std::vector<SimpleIdentity> subTexIDs;
+    for (auto &it : icons)
+    {
+        SpriteIcon &icon = it.second;
+        if (icon.subTexID != EmptyIdentity)
+            subTexIDs.push_back(icon.subTexID);
+        icon.subTexID = EmptyIdentity;
+        icon.texID = EmptyIdentity;
+    }
+    scene->removeSubTextures(subTexIDs);
+    changes.push_back(new RemTextureReq(texID));
+    texID = EmptyIdentity;
+}
+
+SpriteSheetManager::SpriteSheetManager()
+{
+    pthread_mutex_init(&sheetLock, NULL);
+}
+
+SpriteSheetManager::~SpriteSheetManager()
+{
+    pthread_mutex_destroy(&sheetLock);
+}
+
+bool SpriteSheetManager::addSpriteSheet(SpriteSheetRef sheet,ChangeSet &changes)
+{
+    if (!sheet->processIntoScene(scene,changes))
+        return false;
+
+    pthread_mutex_lock(&sheetLock);
+    for (std::vector<SpriteSheetRef>::iterator it = sheets.begin(); it != sheets.end(); ++it)
+        if ((*it)->getName() == sheet->getName())
+        {
+            (*it)->clearFromScene(scene,changes);
+            sheets.erase(it);
+            break;
+        }
+    sheets.push_back(sheet);
+    pthread_mutex_unlock(&sheetLock);
+
+    return true;
+}
+
+void SpriteSheetManager::removeSpriteSheet(const std::string &sheetName,ChangeSet &changes)
+{
+    pthread_mutex_lock(&sheetLock);
+    for (std::vector<SpriteSheetRef>::iterator it = sheets.begin(); it != sheets.end(); ++it)
+        if ((*it)->getName() == sheetName)
+        {
+            (*it)->clearFromScene(scene,changes);
+            sheets.erase(it);
+            break;
+        }
+    pthread_mutex_unlock(&sheetLock);
+}
+
+SpriteSheetRef SpriteSheetManager::getSpriteSheet(const std::string &sheetName)
+{
+    SpriteSheetRef ret;
+
+    pthread_mutex_lock(&sheetLock);
+    for (auto sheet : sheets)
+        if (sheet->getName() == sheetName)
+        {
+            ret = sheet;
+            break;
+        }
+    pthread_mutex_unlock(&sheetLock);
+
+    return ret;
+}
+
+bool SpriteSheetManager::findIcon(const std::string &iconName,SpriteIcon &icon)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&sheetLock);
+    // Qualified with the sheet name
+    size_t sep = iconName.find(':');
+    if (sep != std::string::npos)
+    {
+        std::string sheetName = iconName.substr(0,sep);
+        for (auto sheet : sheets)
+            if (sheet->getName() == sheetName)
+            {
+                found = sheet->findIcon(iconName.substr(sep+1),icon);
+                break;
+            }
+    }
+    // Most recent sheet wins
+    for (int ii=(int)sheets.size()-1;ii>=0 && !found;ii--)
+        found = sheets[ii]->findIcon(iconName,icon);
+    pthread_mutex_unlock(&sheetLock);
+
+    return found && icon.subTexID != EmptyIdentity;
+}
+
+SimpleIdentity SpriteSheetManager::getIconID(const std::string &iconName)
+{
+    SpriteIcon icon;
+    if (!findIcon(iconName,icon))
+        return EmptyIdentity;
+
+    return icon.subTexID;
+}
+
+}
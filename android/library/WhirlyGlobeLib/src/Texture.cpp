@@ -152,6 +152,34 @@ void Texture::setRawData(RawData *inRawData,int inWidth,int inHeight)
     height = inHeight;
 }
 
+unsigned long Texture::getMemSize() const
+{
+    // Compressed data goes over as is
+    if (isCompressed())
+        return texData ? texData->getLen() : (unsigned long)width * height / 2;
+    
+    int pixSize = 4;
+    switch (format)
+    {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            pixSize = 2;
+            break;
+        case GL_ALPHA:
+            pixSize = 1;
+            break;
+        default:
+            break;
+    }
+    unsigned long size = (unsigned long)width * height * pixSize;
+    // Mipmaps add another third
+    if (usesMipmaps)
+        size += size / 3;
+    
+    return size;
+}
+
 RawDataRef Texture::processData()
 {
     if (!texData)
@@ -0,0 +1,461 @@
+/*
+ *  ThematicClassifier.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import <stdlib.h>
+#import <algorithm>
+#import <limits>
+#import "ThematicClassifier.h"
+#import "SharedAttributes.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+ThematicClassifier::ThematicClassifier()
+    : method(ClassifyJenks), numClasses(5), stdDevInterval(1.0), trimLow(0.0), trimHigh(0.0), outlierStdDevs(0.0),
+    classAttr("class"), nullCount(0), outlierCount(0), goodnessOfFit(0.0),
+    nullColor(0,0,0,0), outlierColor(0,0,0,0), useOutlierColor(false)
+{
+    // Light yellow to dark red, which reads well for most choropleths
+    ramp.addStop(0.0,RGBAColor(255,255,178));
+    ramp.addStop(0.5,RGBAColor(253,141,60));
+    ramp.addStop(1.0,RGBAColor(189,0,38));
+}
+
+void ThematicClassifier::setNumClasses(int num)
+{
+    numClasses = std::max(num,1);
+}
+
+void ThematicClassifier::setManualBreaks(const std::vector<double> &newBreaks)
+{
+    manualBreaks = newBreaks;
+    std::sort(manualBreaks.begin(),manualBreaks.end());
+    method = ClassifyManual;
+}
+
+void ThematicClassifier::setStdDevInterval(double interval)
+{
+    if (interval > 0.0)
+        stdDevInterval = interval;
+}
+
+void ThematicClassifier::setOutlierTrim(double lowFrac,double highFrac)
+{
+    trimLow = std::min(std::max(lowFrac,0.0),1.0);
+    trimHigh = std::min(std::max(highFrac,0.0),1.0);
+}
+
+void ThematicClassifier::setOutlierStdDevs(double numStdDevs)
+{
+    outlierStdDevs = std::max(numStdDevs,0.0);
+}
+
+double ThematicClassifier::ValueForAttribute(const Dictionary *attrs,const std::string &attrName)
+{
+    switch (attrs->getType(attrName))
+    {
+        case DictTypeInt:
+        case DictTypeDouble:
+            return attrs->getDouble(attrName);
+        case DictTypeString:
+        {
+            // Plenty of formats only have strings
+            std::string str = attrs->getString(attrName);
+            const char *start = str.c_str();
+            char *end = NULL;
+            double val = strtod(start,&end);
+            if (end == start)
+                break;
+            while (*end == ' ')
+                end++;
+            if (*end == 0)
+                return val;
+        }
+            break;
+        default:
+            break;
+    }
+
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+void ThematicClassifier::setValues(const std::vector<double> &values)
+{
+    sortedVals.clear();
+    sortedVals.reserve(values.size());
+    nullCount = 0;
+    for (double val : values)
+    {
+        if (std::isnan(val))
+            nullCount++;
+        else
+            sortedVals.push_back(val);
+    }
+    std::sort(sortedVals.begin(),sortedVals.end());
+}
+
+void ThematicClassifier::setValues(const ShapeSet &shapes,const std::string &inAttrName)
+{
+    attrName = inAttrName;
+    std::vector<double> values;
+    values.reserve(shapes.size());
+    for (auto shape : shapes)
+        values.push_back(ValueForAttribute(shape->getAttrDict(),attrName));
+    setValues(values);
+}
+
+bool ThematicClassifier::computeBreaks()
+{
+    breaks.clear();
+    classCounts.clear();
+    outlierCount = 0;
+    goodnessOfFit = 0.0;
+
+    if (method == ClassifyManual)
+    {
+        if (manualBreaks.size() < 2)
+        {
+            WHIRLYKIT_LOGW("ThematicClassifier: Need at least two manual breaks.");
+            return false;
+        }
+        breaks = manualBreaks;
+        calcStats(sortedVals);
+        return true;
+    }
+
+    if (sortedVals.empty())
+        return false;
+
+    // Trim the ends off, if asked
+    size_t num = sortedVals.size();
+    size_t lo = (size_t)floor(trimLow * num);
+    size_t hi = num - (size_t)floor(trimHigh * num);
+    if (hi <= lo)
+    {
+        lo = 0;
+        hi = num;
+    }
+    if (outlierStdDevs > 0.0)
+    {
+        double sum = 0.0,sum2 = 0.0;
+        for (size_t ii=lo;ii<hi;ii++)
+            sum += sortedVals[ii];
+        double mean = sum / (hi-lo);
+        for (size_t ii=lo;ii<hi;ii++)
+            sum2 += (sortedVals[ii]-mean)*(sortedVals[ii]-mean);
+        double dist = outlierStdDevs * sqrt(sum2 / (hi-lo));
+        size_t newLo = lo,newHi = hi;
+        while (newLo < newHi && sortedVals[newLo] < mean-dist)
+            newLo++;
+        while (newHi > newLo && sortedVals[newHi-1] > mean+dist)
+            newHi--;
+        if (newLo < newHi)
+        {
+            lo = newLo;
+            hi = newHi;
+        }
+    }
+    std::vector<double> vals(sortedVals.begin()+lo,sortedVals.begin()+hi);
+
+    switch (method)
+    {
+        case ClassifyEqualInterval:
+            breaksEqualInterval(vals);
+            break;
+        case ClassifyQuantile:
+            breaksQuantile(vals);
+            break;
+        case ClassifyJenks:
+            breaksJenks(vals);
+            break;
+        case ClassifyStdDev:
+            breaksStdDev(vals);
+            break;
+        default:
+            break;
+    }
+
+    calcStats(vals);
+
+    return true;
+}
+
+void ThematicClassifier::breaksEqualInterval(const std::vector<double> &vals)
+{
+    double minVal = vals.front(),maxVal = vals.back();
+    breaks.resize(numClasses+1);
+    for (int ii=0;ii<=numClasses;ii++)
+        breaks[ii] = minVal + ii * (maxVal-minVal) / numClasses;
+    breaks[numClasses] = maxVal;
+}
+
+void ThematicClassifier::breaksQuantile(const std::vector<double> &vals)
+{
+    // Each break is the top of its class
+    size_t num = vals.size();
+    breaks.resize(numClasses+1);
+    breaks[0] = vals.front();
+    for (int ii=1;ii<numClasses;ii++)
+    {
+        size_t which = (size_t)ceil(ii * (double)num / numClasses);
+        breaks[ii] = vals[which > 0 ? which-1 : 0];
+    }
+    breaks[numClasses] = vals.back();
+}
+
+void ThematicClassifier::breaksStdDev(const std::vector<double> &vals)
+{
+    double sum = 0.0,sum2 = 0.0;
+    for (double val : vals)
+        sum += val;
+    double mean = sum / vals.size();
+    for (double val : vals)
+        sum2 += (val-mean)*(val-mean);
+    double stdDev = sqrt(sum2 / vals.size());
+
+    // Centered on the mean.  An odd number of classes puts the mean in the middle of one.
+    breaks.resize(numClasses+1);
+    for (int ii=1;ii<numClasses;ii++)
+        breaks[ii] = mean + (ii - numClasses/2.0) * stdDevInterval * stdDev;
+    breaks[0] = numClasses > 1 ? std::min(vals.front(),breaks[1]) : vals.front();
+    breaks[numClasses] = numClasses > 1 ? std::max(vals.back(),breaks[numClasses-1]) : vals.back();
+}
+
+// Weighted sums over runs of distinct values, for the Jenks cost
+class JenksSums
+{
+public:
+    JenksSums(const std::vector<double> &uniqueVals,const std::vector<double> &weights,double shift)
+    {
+        size_t num = uniqueVals.size();
+        sw.resize(num+1,0.0);  sx.resize(num+1,0.0);  sxx.resize(num+1,0.0);
+        for (size_t ii=0;ii<num;ii++)
+        {
+            double x = uniqueVals[ii] - shift;
+            sw[ii+1] = sw[ii] + weights[ii];
+            sx[ii+1] = sx[ii] + weights[ii] * x;
+            sxx[ii+1] = sxx[ii] + weights[ii] * x * x;
+        }
+    }
+
+    // Sum of squared deviations from the mean for values start through end
+    double cost(int start,int end) const
+    {
+        double w = sw[end+1] - sw[start];
+        double s = sx[end+1] - sx[start];
+        double ss = sxx[end+1] - sxx[start];
+        return std::max(ss - s*s/w,0.0);
+    }
+
+    std::vector<double> sw,sx,sxx;
+};
+
+// Fill in one row of the Jenks table.  The best start of the last class moves
+//  right as the end does, so we can divide and conquer rather than check every start.
+static void JenksSolveRow(const JenksSums &sums,int numClass,const std::vector<double> &prev,std::vector<double> &cur,std::vector<int> &back,
+                          int lo,int hi,int optLo,int optHi)
+{
+    while (lo <= hi)
+    {
+        int mid = (lo+hi)/2;
+        double best = std::numeric_limits<double>::max();
+        int bestStart = std::max(optLo,numClass);
+        int last = std::min(mid,optHi);
+        for (int start=std::max(optLo,numClass);start<=last;start++)
+        {
+            double val = prev[start-1] + sums.cost(start,mid);
+            if (val < best)
+            {
+                best = val;
+                bestStart = start;
+            }
+        }
+        cur[mid] = best;
+        back[mid] = bestStart;
+
+        // Recurse on the smaller side and loop on the other
+        if (mid-lo < hi-mid)
+        {
+            JenksSolveRow(sums,numClass,prev,cur,back,lo,mid-1,optLo,bestStart);
+            lo = mid+1;
+            optLo = bestStart;
+        } else {
+            JenksSolveRow(sums,numClass,prev,cur,back,mid+1,hi,bestStart,optHi);
+            hi = mid-1;
+            optHi = bestStart;
+        }
+    }
+}
+
+void ThematicClassifier::breaksJenks(const std::vector<double> &vals)
+{
+    // Jenks is optimal 1D k-means, so we only need the distinct values and their counts
+    std::vector<double> uniqueVals,weights;
+    for (double val : vals)
+    {
+        if (uniqueVals.empty() || uniqueVals.back() != val)
+        {
+            uniqueVals.push_back(val);
+            weights.push_back(1.0);
+        } else
+            weights.back() += 1.0;
+    }
+    int num = (int)uniqueVals.size();
+    int numClass = std::min(numClasses,num);
+
+    // Shift toward the middle to keep the sums well behaved
+    JenksSums sums(uniqueVals,weights,uniqueVals[num/2]);
+
+    std::vector<double> prev(num),cur(num,std::numeric_limits<double>::max());
+    std::vector<std::vector<int> > back(numClass);
+    for (int ii=0;ii<num;ii++)
+        prev[ii] = sums.cost(0,ii);
+    for (int cl=1;cl<numClass;cl++)
+    {
+        back[cl].resize(num,0);
+        std::fill(cur.begin(),cur.end(),std::numeric_limits<double>::max());
+        JenksSolveRow(sums,cl,prev,cur,back[cl],cl,num-1,cl,num-1);
+        prev.swap(cur);
+    }
+
+    // Work back from the end to find where each class starts
+    breaks.resize(numClass+1);
+    breaks[0] = uniqueVals.front();
+    breaks[numClass] = uniqueVals.back();
+    int end = num-1;
+    for (int cl=numClass-1;cl>0;cl--)
+    {
+        int start = back[cl][end];
+        breaks[cl] = uniqueVals[start-1];
+        end = start-1;
+    }
+}
+
+void ThematicClassifier::calcStats(const std::vector<double> &fitVals)
+{
+    int numClass = getNumClasses();
+    classCounts.assign(numClass,0);
+    outlierCount = 0;
+    for (double val : sortedVals)
+    {
+        classCounts[classFor(val)]++;
+        if (isOutlier(val))
+            outlierCount++;
+    }
+
+    // Goodness of variance fit over the values that went into the breaks
+    goodnessOfFit = 0.0;
+    if (fitVals.empty())
+        return;
+    double sum = 0.0;
+    for (double val : fitVals)
+        sum += val;
+    double mean = sum / fitVals.size();
+    double sdam = 0.0;
+    std::vector<double> classSum(numClass,0.0),classSum2(numClass,0.0),classNum(numClass,0.0);
+    for (double val : fitVals)
+    {
+        sdam += (val-mean)*(val-mean);
+        int which = classFor(val);
+        double x = val-mean;
+        classSum[which] += x;
+        classSum2[which] += x*x;
+        classNum[which] += 1.0;
+    }
+    double sdcm = 0.0;
+    for (int ii=0;ii<numClass;ii++)
+        if (classNum[ii] > 0.0)
+            sdcm += classSum2[ii] - classSum[ii]*classSum[ii]/classNum[ii];
+    goodnessOfFit = sdam > 0.0 ? 1.0 - sdcm/sdam : 1.0;
+}
+
+int ThematicClassifier::classFor(double val) const
+{
+    if (std::isnan(val) || breaks.size() < 2)
+        return NullClass;
+
+    // Count the inside breaks below the value
+    std::vector<double>::const_iterator first = breaks.begin()+1;
+    std::vector<double>::const_iterator last = breaks.end()-1;
+    return (int)(std::lower_bound(first,last,val) - first);
+}
+
+bool ThematicClassifier::isOutlier(double val) const
+{
+    if (std::isnan(val) || breaks.size() < 2)
+        return false;
+
+    return val < breaks.front() || val > breaks.back();
+}
+
+void ThematicClassifier::setColors(const std::vector<RGBAColor> &newColors)
+{
+    colors = newColors;
+}
+
+void ThematicClassifier::setColorRamp(const ColorMap &newRamp)
+{
+    if (newRamp.empty())
+        return;
+    ramp = newRamp;
+    colors.clear();
+}
+
+RGBAColor ThematicClassifier::colorForClass(int which) const
+{
+    if (which < 0)
+        return nullColor;
+
+    if (!colors.empty())
+        return colors[std::min(which,(int)colors.size()-1)];
+
+    int numClass = getNumClasses();
+    double t = numClass > 1 ? which / (double)(numClass-1) : 0.5;
+    return ramp.colorFor(ramp.getMinValue() + t * (ramp.getMaxValue()-ramp.getMinValue()));
+}
+
+RGBAColor ThematicClassifier::colorFor(double val) const
+{
+    if (useOutlierColor && isOutlier(val))
+        return outlierColor;
+
+    return colorForClass(classFor(val));
+}
+
+void ThematicClassifier::applyToShapes(const ShapeSet &shapes) const
+{
+    if (attrName.empty())
+    {
+        WHIRLYKIT_LOGW("ThematicClassifier: Values didn't come from shapes, so there's no attribute to classify on.");
+        return;
+    }
+
+    for (auto shape : shapes)
+    {
+        Dictionary *attrs = shape->getAttrDict();
+        double val = ValueForAttribute(attrs,attrName);
+        attrs->setInt(classAttr,classFor(val));
+        attrs->setInt(MaplyColor,colorFor(val).asInt());
+    }
+}
+
+}
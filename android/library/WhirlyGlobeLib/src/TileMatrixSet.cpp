@@ -0,0 +1,318 @@
+/*
+ *  TileMatrixSet.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <math.h>
+#import "TileMatrixSet.h"
+#import "ScreenImportance.h"
+#import "ViewState.h"
+
+namespace WhirlyKit
+{
+
+// Size of a pixel in meters, as WMTS defines it
+static const double WMTSPixelSize = 0.00028;
+
+// Tiles have to overlap by more than this (in tiles) to count
+static const double TileOverlapEps = 1e-6;
+
+TileMatrix::TileMatrix()
+    : ll(0,0), tileSpan(1,1), matrixWidth(1), matrixHeight(1), minCol(0), maxCol(0), minRow(0), maxRow(0),
+    tileWidth(0), tileHeight(0)
+{
+}
+
+TileMatrix::TileMatrix(const Point2d &ll,const Point2d &tileSpan,int matrixWidth,int matrixHeight)
+    : ll(ll), tileSpan(tileSpan), matrixWidth(matrixWidth), matrixHeight(matrixHeight),
+    minCol(0), maxCol(matrixWidth-1), minRow(0), maxRow(matrixHeight-1), tileWidth(0), tileHeight(0)
+{
+}
+
+TileMatrix TileMatrix::FromWMTS(const Point2d &topLeft,double scaleDenominator,double metersPerUnit,int tileWidth,int tileHeight,int matrixWidth,int matrixHeight)
+{
+    double pixelSpan = scaleDenominator * WMTSPixelSize / metersPerUnit;
+    Point2d tileSpan(tileWidth * pixelSpan,tileHeight * pixelSpan);
+    Point2d ll(topLeft.x(),topLeft.y() - matrixHeight * tileSpan.y());
+
+    TileMatrix matrix(ll,tileSpan,matrixWidth,matrixHeight);
+    matrix.tileWidth = tileWidth;
+    matrix.tileHeight = tileHeight;
+
+    return matrix;
+}
+
+Point2d TileMatrix::ur() const
+{
+    return Point2d(ll.x() + matrixWidth * tileSpan.x(),ll.y() + matrixHeight * tileSpan.y());
+}
+
+bool TileMatrix::isValid(int x,int y) const
+{
+    return x >= minCol && x <= maxCol && y >= minRow && y <= maxRow &&
+        x >= 0 && x < matrixWidth && y >= 0 && y < matrixHeight;
+}
+
+TileMatrixSet::TileMatrixSet()
+    : quadTree(false)
+{
+}
+
+TileMatrixSet::~TileMatrixSet()
+{
+}
+
+TileMatrixSetRef TileMatrixSet::MakeQuadTree(const Point2d &ll,const Point2d &ur,int numLevels)
+{
+    TileMatrixSetRef tms(new TileMatrixSet());
+    for (int level=0;level<numLevels;level++)
+    {
+        int numTiles = 1<<level;
+        Point2d tileSpan((ur.x()-ll.x())/numTiles,(ur.y()-ll.y())/numTiles);
+        tms->addLevel(TileMatrix(ll,tileSpan,numTiles,numTiles));
+    }
+    tms->quadTree = true;
+
+    return tms;
+}
+
+TileMatrixSetRef TileMatrixSet::MakeQuadTree(const Mbr &mbr,int numLevels)
+{
+    return MakeQuadTree(Point2d(mbr.ll().x(),mbr.ll().y()),Point2d(mbr.ur().x(),mbr.ur().y()),numLevels);
+}
+
+void TileMatrixSet::addLevel(const TileMatrix &level)
+{
+    levels.push_back(level);
+    quadTree = false;
+}
+
+void TileMatrixSet::getTotalExtents(Point2d &ll,Point2d &ur) const
+{
+    if (levels.empty())
+    {
+        ll = Point2d(0,0);
+        ur = Point2d(0,0);
+        return;
+    }
+
+    ll = levels[0].ll;
+    ur = levels[0].ur();
+    for (unsigned int ii=1;ii<levels.size();ii++)
+    {
+        const TileMatrix &level = levels[ii];
+        Point2d levelUR = level.ur();
+        ll.x() = std::min(ll.x(),level.ll.x());
+        ll.y() = std::min(ll.y(),level.ll.y());
+        ur.x() = std::max(ur.x(),levelUR.x());
+        ur.y() = std::max(ur.y(),levelUR.y());
+    }
+}
+
+Mbr TileMatrixSet::getTotalExtents() const
+{
+    Point2d ll,ur;
+    getTotalExtents(ll,ur);
+
+    return Mbr(Point2f(ll.x(),ll.y()),Point2f(ur.x(),ur.y()));
+}
+
+bool TileMatrixSet::isValidTile(const Quadtree::Identifier &ident) const
+{
+    if (ident.level < 0 || ident.level >= levels.size())
+        return false;
+
+    return levels[ident.level].isValid(ident.x,ident.y);
+}
+
+void TileMatrixSet::calcTileMbr(const Quadtree::Identifier &ident,Point2d &ll,Point2d &ur) const
+{
+    if (ident.level < 0 || ident.level >= levels.size())
+    {
+        ll = Point2d(0,0);
+        ur = Point2d(0,0);
+        return;
+    }
+
+    const TileMatrix &level = levels[ident.level];
+    ll = Point2d(level.ll.x() + ident.x * level.tileSpan.x(),level.ll.y() + ident.y * level.tileSpan.y());
+    ur = Point2d(level.ll.x() + (ident.x+1) * level.tileSpan.x(),level.ll.y() + (ident.y+1) * level.tileSpan.y());
+}
+
+Mbr TileMatrixSet::calcTileMbr(const Quadtree::Identifier &ident) const
+{
+    Point2d ll,ur;
+    calcTileMbr(ident,ll,ur);
+
+    return Mbr(Point2f(ll.x(),ll.y()),Point2f(ur.x(),ur.y()));
+}
+
+void TileMatrixSet::tilesForMbr(int levelNum,const Point2d &ll,const Point2d &ur,std::vector<Quadtree::Identifier> &tiles) const
+{
+    if (levelNum < 0 || levelNum >= levels.size())
+        return;
+    const TileMatrix &level = levels[levelNum];
+
+    // Work in tile units so the slop scales with the level
+    int startX = std::max((int)floor((ll.x() - level.ll.x()) / level.tileSpan.x() + TileOverlapEps),std::max(level.minCol,0));
+    int endX = std::min((int)ceil((ur.x() - level.ll.x()) / level.tileSpan.x() - TileOverlapEps) - 1,std::min(level.maxCol,level.matrixWidth-1));
+    int startY = std::max((int)floor((ll.y() - level.ll.y()) / level.tileSpan.y() + TileOverlapEps),std::max(level.minRow,0));
+    int endY = std::min((int)ceil((ur.y() - level.ll.y()) / level.tileSpan.y() - TileOverlapEps) - 1,std::min(level.maxRow,level.matrixHeight-1));
+
+    for (int iy=startY;iy<=endY;iy++)
+        for (int ix=startX;ix<=endX;ix++)
+            tiles.push_back(Quadtree::Identifier(ix,iy,levelNum));
+}
+
+void TileMatrixSet::tilesForLevel(int levelNum,std::vector<Quadtree::Identifier> &tiles) const
+{
+    if (levelNum < 0 || levelNum >= levels.size())
+        return;
+    const TileMatrix &level = levels[levelNum];
+
+    for (int iy=std::max(level.minRow,0);iy<=std::min(level.maxRow,level.matrixHeight-1);iy++)
+        for (int ix=std::max(level.minCol,0);ix<=std::min(level.maxCol,level.matrixWidth-1);ix++)
+            tiles.push_back(Quadtree::Identifier(ix,iy,levelNum));
+}
+
+bool TileMatrixSet::tileForPoint(int levelNum,const Point2d &pt,Quadtree::Identifier &tile) const
+{
+    if (levelNum < 0 || levelNum >= levels.size())
+        return false;
+    const TileMatrix &level = levels[levelNum];
+
+    int x = (int)floor((pt.x() - level.ll.x()) / level.tileSpan.x());
+    int y = (int)floor((pt.y() - level.ll.y()) / level.tileSpan.y());
+    if (!level.isValid(x,y))
+        return false;
+
+    tile = Quadtree::Identifier(x,y,levelNum);
+    return true;
+}
+
+bool TileMatrixSet::parentForTile(const Quadtree::Identifier &ident,Quadtree::Identifier &parent) const
+{
+    if (ident.level <= 0 || ident.level >= levels.size())
+        return false;
+
+    // Skip the floating point for the usual case
+    if (quadTree)
+    {
+        parent = Quadtree::Identifier(ident.x/2,ident.y/2,ident.level-1);
+        return true;
+    }
+
+    Point2d ll,ur;
+    calcTileMbr(ident,ll,ur);
+
+    return tileForPoint(ident.level-1,(ll+ur)/2.0,parent);
+}
+
+void TileMatrixSet::childrenForTile(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &children) const
+{
+    if (ident.level < 0 || ident.level+1 >= levels.size())
+        return;
+
+    if (quadTree)
+    {
+        for (unsigned int ix=0;ix<2;ix++)
+            for (unsigned int iy=0;iy<2;iy++)
+                children.push_back(Quadtree::Identifier(2*ident.x+ix,2*ident.y+iy,ident.level+1));
+        return;
+    }
+
+    // Of the tiles that overlap, only keep the ones that think we're their parent
+    std::vector<Quadtree::Identifier> overlaps;
+    overlappingChildren(ident,overlaps);
+    for (const Quadtree::Identifier &child : overlaps)
+    {
+        Quadtree::Identifier parent;
+        if (parentForTile(child,parent) && parent == ident)
+            children.push_back(child);
+    }
+}
+
+void TileMatrixSet::overlappingChildren(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &children) const
+{
+    if (ident.level < 0 || ident.level+1 >= levels.size())
+        return;
+
+    if (quadTree)
+    {
+        childrenForTile(ident,children);
+        return;
+    }
+
+    Point2d ll,ur;
+    calcTileMbr(ident,ll,ur);
+    tilesForMbr(ident.level+1,ll,ur,children);
+}
+
+void TileMatrixSet::overlappingParents(const Quadtree::Identifier &ident,std::vector<Quadtree::Identifier> &parents) const
+{
+    if (ident.level <= 0 || ident.level >= levels.size())
+        return;
+
+    if (quadTree)
+    {
+        parents.push_back(Quadtree::Identifier(ident.x/2,ident.y/2,ident.level-1));
+        return;
+    }
+
+    Point2d ll,ur;
+    calcTileMbr(ident,ll,ur);
+    tilesForMbr(ident.level-1,ll,ur,parents);
+}
+
+// Pixels in a tile at the given level, falling back to a square of the given size
+static double TilePixelArea(const TileMatrixVector &levels,int level,int tileSize)
+{
+    if (level >= 0 && level < levels.size())
+    {
+        const TileMatrix &matrix = levels[level];
+        if (matrix.tileWidth > 0 && matrix.tileHeight > 0)
+            return (double)matrix.tileWidth * matrix.tileHeight;
+    }
+
+    return (double)tileSize * tileSize;
+}
+
+double TileMatrixSet::screenImportance(ViewState *viewState,const Point2f &frameSize,int tileSize,CoordSystem *srcSystem,CoordSystemDisplayAdapter *coordAdapter,const Quadtree::Identifier &ident,Dictionary *attrs) const
+{
+    if (!isValidTile(ident))
+        return 0.0;
+
+    // Screen area in pixels, then scaled by what the level thinks a tile is
+    Mbr mbr = calcTileMbr(ident);
+    double import = ScreenImportance(viewState,frameSize,viewState->eyeVec,1,srcSystem,coordAdapter,mbr,ident,attrs);
+
+    return import / TilePixelArea(levels,ident.level,tileSize);
+}
+
+double TileMatrixSet::screenImportance(ViewState *viewState,const Point2f &frameSize,int tileSize,CoordSystem *srcSystem,CoordSystemDisplayAdapter *coordAdapter,const Quadtree::Identifier &ident,double minZ,double maxZ,Dictionary *attrs) const
+{
+    if (!isValidTile(ident))
+        return 0.0;
+
+    Mbr mbr = calcTileMbr(ident);
+    double import = ScreenImportance(viewState,frameSize,1,srcSystem,coordAdapter,mbr,minZ,maxZ,ident,attrs);
+
+    return import / TilePixelArea(levels,ident.level,tileSize);
+}
+
+}
@@ -90,6 +90,16 @@ void QuadTileLoader::setTesselationSize(int x,int y)
     defaultTessY = y;
 }
 
+// Parent tiles draw the parts their children don't cover, which only works for a regular quad tree
+bool QuadTileLoader::parentForTile(const Quadtree::Identifier &ident,Quadtree::Identifier &parentIdent)
+{
+    TileMatrixSetRef tileMatrixSet = control->getQuadtree()->getTileMatrixSet();
+    if (!tileMatrixSet->isQuadTree())
+        return false;
+    
+    return tileMatrixSet->parentForTile(ident, parentIdent);
+}
+
 // Look for a specific tile
 InternalLoadedTile *QuadTileLoader::getTile(const Quadtree::Identifier &ident)
 {
@@ -381,14 +391,18 @@ void QuadTileLoader::reset(ChangeSet &changes)
         changeRequests.clear();
     }
     
+    std::vector<Quadtree::Identifier> elevIdents;
     pthread_mutex_lock(&tileLock);
     for (LoadedTileSet::iterator it = tileSet.begin();
          it != tileSet.end(); ++it)
     {
         InternalLoadedTile *tile = *it;
         tile->clearContents(tileBuilder,changes);
+        if (tile->elevTile)
+            elevIdents.push_back(tile->nodeInfo.ident);
     }
     pthread_mutex_unlock(&tileLock);
+    removeElevTiles(elevIdents);
 
     networkFetches.clear();
     localFetches.clear();
@@ -532,6 +546,7 @@ void QuadTileLoader::unloadTile(const Quadtree::NodeInfo &tileInfo)
         localFetches.erase(nit);
     
     // Get rid of an old tile
+    std::vector<Quadtree::Identifier> elevIdents;
     pthread_mutex_lock(&tileLock);
     InternalLoadedTile dummyTile;
     dummyTile.nodeInfo.ident = tileInfo.ident;
@@ -547,16 +562,20 @@ void QuadTileLoader::unloadTile(const Quadtree::NodeInfo &tileInfo)
 //            NSLog(@" *** Deleting node with children *** ");
         
         theTile->clearContents(tileBuilder,changeRequests);
+        if (theTile->elevTile)
+            elevIdents.push_back(theTile->nodeInfo.ident);
         tileSet.erase(it);
         delete theTile;
     }
     pthread_mutex_unlock(&tileLock);
+    removeElevTiles(elevIdents);
     
 //    NSLog(@"Unloaded tile (%d,%d,%d)",tileInfo.ident.x,tileInfo.ident.y,tileInfo.ident.level);
     
     // We'll put this on the list of parents to update, but it'll actually happen in EndUpdates
-    if (tileInfo.ident.level > 0 && control->getTargetLevels().empty())
-        parents.insert(Quadtree::Identifier(tileInfo.ident.x/2,tileInfo.ident.y/2,tileInfo.ident.level-1));
+    Quadtree::Identifier parentIdent;
+    if (tileInfo.ident.level > 0 && control->getTargetLevels().empty() && parentForTile(tileInfo.ident,parentIdent))
+        parents.insert(parentIdent);
     
     updateTexAtlasMapping();
     
@@ -708,6 +727,21 @@ void QuadTileLoader::loadedImage(QuadTileImageDataSource *dataSource,LoadedImage
 }
     
 void QuadTileLoader::loadedImages(QuadTileImageDataSource *dataSource,const std::vector<LoadedImage *> &loadImages,int level,int col,int row,int frame,ChangeSet &changes)
+{
+    loadedImages(dataSource,loadImages,ElevationGridTileRef(),level,col,row,frame,changes);
+}
+
+void QuadTileLoader::removeElevTiles(const std::vector<Quadtree::Identifier> &idents)
+{
+    if (idents.empty())
+        return;
+
+    ElevationManager *elevManager = (ElevationManager *)scene->getManager(kWKElevationManager);
+    if (elevManager)
+        elevManager->removeElevationTiles(idents);
+}
+
+void QuadTileLoader::loadedImages(QuadTileImageDataSource *dataSource,const std::vector<LoadedImage *> &loadImages,ElevationGridTileRef elevTile,int level,int col,int row,int frame,ChangeSet &changes)
 {
     // Note: Porting
 //    bool isPlaceholder = tileIsPlaceholder(loadImage);
@@ -869,24 +903,49 @@ void QuadTileLoader::loadedImages(QuadTileImageDataSource *dataSource,const std:
         }
     }
     
+    // New elevation for the tile goes to the elevation manager once we're out of the lock
+    ElevationGridTileRef addElevTile;
+    std::vector<Quadtree::Identifier> dropElevIdents;
     if (loadingSuccess)
+    {
         control->tileDidLoad(tile->nodeInfo.ident,frame);
-    else {
+        if (elevTile && tile->elevTile != elevTile)
+        {
+            tile->elevTile = elevTile;
+            addElevTile = elevTile;
+        }
+    } else {
         // Clear out the visuals for this tile
         if (tile->isInitialized)
             tile->clearContents(tileBuilder, changeRequests);
         // Shouldn't have a visual representation, so just lose it
         control->tileDidNotLoad(tile->nodeInfo.ident,frame);
+        if (tile->elevTile)
+            dropElevIdents.push_back(tile->nodeInfo.ident);
         tileSet.erase(it);
         delete tile;
     }
     pthread_mutex_unlock(&tileLock);
+    removeElevTiles(dropElevIdents);
+
+    if (addElevTile)
+    {
+        ElevationManager *elevManager = (ElevationManager *)scene->getManager(kWKElevationManager);
+        if (elevManager)
+        {
+            // Samples are in the layer's system, which is whatever the first tile came in
+            if (elevManager->getNumTiles() == 0)
+                elevManager->setCoordSystem(control->getCoordSys());
+            elevManager->addElevationTile(addElevTile,changes);
+        }
+    }
     
     //    NSLog(@"Loaded image for tile (%d,%d,%d)",col,row,level);
     
     // Various child state changed so let's update the parents
-    if (parentUpdate && level > 0 && control->getTargetLevels().empty())
-        parents.insert(Quadtree::Identifier(col/2,row/2,level-1));
+    Quadtree::Identifier parentIdent;
+    if (parentUpdate && level > 0 && control->getTargetLevels().empty() && parentForTile(Quadtree::Identifier(col,row,level),parentIdent))
+        parents.insert(parentIdent);
         
     if (!doingUpdate)
     {
@@ -25,6 +25,7 @@
 #import "GridClipper.h"
 #import "SharedAttributes.h"
 #import "Platform.h"
+#import "ElevationManager.h"
 
 using namespace Eigen;
 using namespace WhirlyKit;
@@ -35,14 +36,14 @@ namespace WhirlyKit
     
 VectorInfo::VectorInfo()
 : BaseInfo(),     filled(false), sample(0.0), texId(EmptyIdentity), texScale(1.0,1.0), subdivEps(1.0), gridSubdiv(false),
-texProj(TextureProjectionNone), color(255,255,255,255), lineWidth(1.0)
+texProj(TextureProjectionNone), color(255,255,255,255), lineWidth(1.0), clampToGround(false), recolorable(false)
 {    
 }
     
 VectorInfo::VectorInfo(const Dictionary &dict) :
     BaseInfo(dict),
     filled(false), sample(0.0), texId(EmptyIdentity), texScale(1.0,1.0), subdivEps(1.0), gridSubdiv(false),
-    texProj(TextureProjectionNone), color(255,255,255,255), lineWidth(1.0), centered(false), vecCenterSet(false), vecCenter(0.0,0.0)
+    texProj(TextureProjectionNone), color(255,255,255,255), lineWidth(1.0), centered(false), vecCenterSet(false), vecCenter(0.0,0.0), clampToGround(false), recolorable(false)
 {
     color = dict.getColor(MaplyColor,RGBAColor(255,255,255,255));
     lineWidth = dict.getDouble(MaplyVecWidth,1.0);
@@ -67,6 +68,8 @@ VectorInfo::VectorInfo(const Dictionary &dict) :
         vecCenter.x() = dict.getDouble("veccenterx");
         vecCenter.x() = dict.getDouble("veccentery");
     }
+    clampToGround = dict.getBool(MaplyVecClampToGround,false);
+    recolorable = dict.getBool(MaplyVecRecolorable,false);
 }
     
 // Really Android?  Really?
@@ -94,7 +97,9 @@ std::string VectorInfo::toString()
     " lineWidth = " + to_string(lineWidth) + ";" +
     " centered = " + (centered ? "yes" : "no") + ";" +
     " vecCenterSet = " + (vecCenterSet ? "yes" : "no") + ";" +
-    " vecCenter = (" + to_string(vecCenter.x()) + "," + to_string(vecCenter.y()) + ");";
+    " vecCenter = (" + to_string(vecCenter.x()) + "," + to_string(vecCenter.y()) + ");" +
+    " clampToGround = " + (clampToGround ? "yes" : "no") + ";" +
+    " recolorable = " + (recolorable ? "yes" : "no") + ";";
     
     return outStr;
 }
@@ -105,6 +110,28 @@ void VectorSceneRep::clear(ChangeSet &changes)
         changes.push_back(new RemDrawableReq(*it));
 }
 
+void VectorSceneRep::addVertexRange(const VectorShape *shape,SimpleIdentity drawID,int start,int count)
+{
+    if (count <= 0)
+        return;
+    
+    std::vector<VertexRange> &ranges = shapeRanges[shape];
+    if (!ranges.empty())
+    {
+        VertexRange &last = ranges.back();
+        if (last.drawID == drawID && last.start+last.count == start)
+        {
+            last.count += count;
+            return;
+        }
+    }
+    VertexRange range;
+    range.drawID = drawID;
+    range.start = start;
+    range.count = count;
+    ranges.push_back(range);
+}
+
 /* Drawable Builder
  Used to construct drawables with multiple shapes in them.
  Eventually, we'll move this out to be a more generic object.
@@ -114,7 +141,7 @@ class VectorDrawableBuilder
 public:
     VectorDrawableBuilder(Scene *scene,ChangeSet &changeRequests,VectorSceneRep *sceneRep,
                           const VectorInfo *vecInfo,bool linesOrPoints,bool doColor)
-    : changeRequests(changeRequests), scene(scene), sceneRep(sceneRep), vecInfo(vecInfo), drawable(NULL), centerValid(false), center(0,0,0), geoCenter(0,0), doColor(doColor)
+    : changeRequests(changeRequests), scene(scene), sceneRep(sceneRep), vecInfo(vecInfo), drawable(NULL), centerValid(false), center(0,0,0), geoCenter(0,0), doColor(doColor), shape(NULL)
     {
         primType = (linesOrPoints ? GL_LINES : GL_POINTS);
     }
@@ -131,6 +158,18 @@ public:
         geoCenter = inGeoCenter;
     }
     
+    // Elevation to drape the lines over
+    void setElevation(ElevationSamplerRef sampler)
+    {
+        elevSampler = sampler;
+    }
+    
+    // Shape we're working on, for recolorable vectors
+    void setShape(const VectorShape *newShape)
+    {
+        shape = newShape;
+    }
+    
     void addPoints(VectorRing3d &inPts,bool closed,Dictionary *attrs)
     {
         VectorRing pts;
@@ -141,8 +180,23 @@ public:
         addPoints(pts,closed,attrs);
     }
 
-    void addPoints(VectorRing &pts,bool closed,Dictionary *attrs)
+    void addPoints(VectorRing &inPts,bool closed,Dictionary *attrs)
     {
+        // Break the edges up where they cross the terrain grid
+        VectorRing clampPts;
+        if (elevSampler)
+        {
+            VectorRing absPts,subPts;
+            absPts.reserve(inPts.size());
+            for (const auto &pt : inPts)
+                absPts.push_back(Point2f(pt.x()+geoCenter.x(),pt.y()+geoCenter.y()));
+            elevSampler->subdivideEdges(absPts,subPts,closed);
+            clampPts.reserve(subPts.size());
+            for (const auto &pt : subPts)
+                clampPts.push_back(Point2f(pt.x()-geoCenter.x(),pt.y()-geoCenter.y()));
+        }
+        VectorRing &pts = elevSampler ? clampPts : inPts;
+        
         CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
         RGBAColor ringColor = attrs->getColor(MaplyColor, vecInfo->color);
         
@@ -162,8 +216,11 @@ public:
             // Adjust according to the vector info
             drawable->setColor(ringColor);
             drawable->setLineWidth(vecInfo->lineWidth);
+            if (vecInfo->recolorable)
+                drawable->setRetainVertexData(true);
         }
         drawMbr.addPoints(pts);
+        int startVert = drawable->getNumPoints();
         
         Point3f prevPt,prevNorm,firstPt,firstNorm;
         for (unsigned int jj=0;jj<pts.size();jj++)
@@ -174,6 +231,8 @@ public:
             Point3d localPt = coordAdapter->getCoordSystem()->geographicToLocal(geoCoordD);
             Point3d norm3d = coordAdapter->normalForLocal(localPt);
             Point3f norm(norm3d.x(),norm3d.y(),norm3d.z());
+            if (elevSampler)
+                localPt = elevSampler->localPointFor(geoCoordD);
             Point3d pt3d = coordAdapter->localToDisplay(localPt) - center;
             Point3f pt(pt3d.x(),pt3d.y(),pt3d.z());
             
@@ -219,6 +278,9 @@ public:
             drawable->addNormal(prevNorm);
             drawable->addNormal(firstNorm);
         }
+        
+        if (vecInfo->recolorable && shape)
+            sceneRep->addVertexRange(shape,drawable->getId(),startVert,drawable->getNumPoints()-startVert);
     }
     
     void flush()
@@ -260,6 +322,8 @@ protected:
     Point2d geoCenter;
     bool centerValid;
     GLenum primType;
+    ElevationSamplerRef elevSampler;
+    const VectorShape *shape;
 };
 
 /* Drawable Builder (Triangle version)
@@ -271,7 +335,7 @@ class VectorDrawableBuilderTri
 public:
     VectorDrawableBuilderTri(Scene *scene,ChangeSet &changeRequests,VectorSceneRep *sceneRep,
                              const VectorInfo *vecInfo,bool doColor)
-    : changeRequests(changeRequests), scene(scene), sceneRep(sceneRep), vecInfo(vecInfo), drawable(NULL), centerValid(false), center(0,0,0), doColor(doColor), geoCenter(0,0)
+    : changeRequests(changeRequests), scene(scene), sceneRep(sceneRep), vecInfo(vecInfo), drawable(NULL), centerValid(false), center(0,0,0), doColor(doColor), geoCenter(0,0), shape(NULL)
     {
     }
     
@@ -287,15 +351,38 @@ public:
         geoCenter = newGeoCenter;
     }
     
+    // Elevation to drape the areals over
+    void setElevation(ElevationSamplerRef sampler)
+    {
+        elevSampler = sampler;
+    }
+    
+    // Shape we're working on, for recolorable vectors
+    void setShape(const VectorShape *newShape)
+    {
+        shape = newShape;
+    }
+    
+    // Grid subdivision is done here
+    void clipToGrid(const VectorRing &ring,std::vector<VectorRing> &outRings)
+    {
+        Point2f org,spacing;
+        if (vecInfo->subdivEps > 0.0 && vecInfo->gridSubdiv)
+            ClipLoopToGrid(ring, Point2f(0.0,0.0), Point2f(vecInfo->subdivEps,vecInfo->subdivEps), outRings);
+        else if (elevSampler && elevSampler->gridForAreals(org,spacing))
+        {
+            // Chop along the elevation samples so the surface can follow them
+            org -= Point2f(geoCenter.x(),geoCenter.y());
+            ClipLoopToGrid(ring, org, spacing, outRings);
+        } else
+            outRings.push_back(ring);
+    }
+    
     // This version converts a ring into a mesh (chopping, tesselating, etc...)
     void addPoints(VectorRing &ring,Dictionary *attrs)
     {
-        // Grid subdivision is done here
         std::vector<VectorRing> inRings;
-        if (vecInfo->subdivEps > 0.0 && vecInfo->gridSubdiv)
-            ClipLoopToGrid(ring, Point2f(0.0,0.0), Point2f(vecInfo->subdivEps,vecInfo->subdivEps), inRings);
-        else
-            inRings.push_back(ring);
+        clipToGrid(ring, inRings);
         VectorTrianglesRef mesh(VectorTriangles::createTriangles());
         for (unsigned int ii=0;ii<inRings.size();ii++)
             TesselateRing(inRings[ii],mesh);
@@ -311,12 +398,8 @@ public:
         for (const auto &pt : inRing)
             ring.push_back(Point2f(pt.x(),pt.y()));
         
-        // Grid subdivision is done here
         std::vector<VectorRing> inRings;
-        if (vecInfo->subdivEps > 0.0 && vecInfo->gridSubdiv)
-            ClipLoopToGrid(ring, Point2f(0.0,0.0), Point2f(vecInfo->subdivEps,vecInfo->subdivEps), inRings);
-        else
-            inRings.push_back(ring);
+        clipToGrid(ring, inRings);
         VectorTrianglesRef mesh(VectorTriangles::createTriangles());
         for (unsigned int ii=0;ii<inRings.size();ii++)
             TesselateRing(inRings[ii],mesh);
@@ -327,13 +410,9 @@ public:
     // This version converts a ring into a mesh (chopping, tesselating, etc...)
     void addPoints(std::vector<VectorRing> &rings,Dictionary *attrs)
     {
-        // Grid subdivision is done here
         std::vector<VectorRing> inRings;
-        if (vecInfo->subdivEps > 0.0 && vecInfo->gridSubdiv)
-            for (unsigned int ii=0;ii<rings.size();ii++)
-                ClipLoopToGrid(rings[ii], Point2f(0.0,0.0), Point2f(vecInfo->subdivEps,vecInfo->subdivEps), inRings);
-        else
-            inRings = rings;
+        for (unsigned int ii=0;ii<rings.size();ii++)
+            clipToGrid(rings[ii], inRings);
         VectorTrianglesRef mesh(VectorTriangles::createTriangles());
         TesselateLoops(inRings, mesh);
         
@@ -378,6 +457,8 @@ public:
                     drawable->setTexId(0, vecInfo->texId);
                 if (vecInfo->programID != EmptyIdentity)
                     drawable->setProgram(vecInfo->programID);
+                if (vecInfo->recolorable)
+                    drawable->setRetainVertexData(true);
             }
             int baseVert = drawable->getNumPoints();
             drawMbr.addPoints(pts);
@@ -455,6 +536,8 @@ public:
                 Point3d localPt = coordAdapter->getCoordSystem()->geographicToLocal(geoCoordD);
                 Point3d norm3d = coordAdapter->normalForLocal(localPt);
                 Point3f norm(norm3d.x(),norm3d.y(),norm3d.z());
+                if (elevSampler)
+                    localPt = elevSampler->localPointFor(geoCoordD);
                 Point3d pt3d = coordAdapter->localToDisplay(localPt) - center;
                 Point3f pt(pt3d.x(),pt3d.y(),pt3d.z());
                 
@@ -472,6 +555,9 @@ public:
             // Note: Should be reusing vertex indices
             if (pts.size() == 3)
                 drawable->addTriangle(BasicDrawable::Triangle(0+baseVert,2+baseVert,1+baseVert));
+            
+            if (vecInfo->recolorable && shape)
+                sceneRep->addVertexRange(shape,drawable->getId(),baseVert,drawable->getNumPoints()-baseVert);
         }
     }
     
@@ -524,6 +610,8 @@ protected:
     bool centerValid;
     BasicDrawable *drawable;
     const VectorInfo *vecInfo;
+    ElevationSamplerRef elevSampler;
+    const VectorShape *shape;
 };
 
 VectorManager::VectorManager()
@@ -543,18 +631,42 @@ VectorManager::~VectorManager()
 
 SimpleIdentity VectorManager::addVectors(ShapeSet *shapes, const VectorInfo &vecInfo, ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(vecInfo.memLabel);
     if (shapes->empty())
         return EmptyIdentity;
     
     VectorSceneRep *sceneRep = new VectorSceneRep();
     sceneRep->fade = vecInfo.fade;
-
+    
+    buildVectors(sceneRep,shapes,vecInfo,changes);
+    
+    // Hang on to what we need to drape these again when better elevation shows up
+    if (vecInfo.clampToGround)
+    {
+        sceneRep->shapes = *shapes;
+        sceneRep->clampInfo = std::shared_ptr<VectorInfo>(new VectorInfo(vecInfo));
+        sceneRep->clampInfo->fade = 0.0;
+    }
+    
+    SimpleIdentity vecID = sceneRep->getId();
+    pthread_mutex_lock(&vectorLock);
+    vectorReps.insert(sceneRep);
+    pthread_mutex_unlock(&vectorLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
+    
+    return vecID;
+}
+    
+void VectorManager::buildVectors(VectorSceneRep *sceneRep,ShapeSet *shapes,const VectorInfo &vecInfo,ChangeSet &changes)
+{
     // No longer do anything with points in here
 //    VectorPointsRef thePoints = std::dynamic_pointer_cast<VectorPoints>(*first);
 //    bool linesOrPoints = (thePoints.get() ? false : true);
     
-    // Look for per vector colors
-    bool doColors = false;
+    // Look for per vector colors.  Recolorable vectors always have them.
+    bool doColors = vecInfo.recolorable;
     for (ShapeSet::iterator it = shapes->begin();it != shapes->end(); ++it)
     {
         if ((*it)->getAttrDict()->hasField("color"))
@@ -570,6 +682,11 @@ SimpleIdentity VectorManager::addVectors(ShapeSet *shapes, const VectorInfo &vec
     Point3d center(0,0,0);
     bool centerValid = false;
     Point2d geoCenter(0,0);
+    // Bounds are needed for centering and for draping
+    GeoMbr geoMbr;
+    if (vecInfo.clampToGround || (vecInfo.centered && coordAdapter->isFlat() && !vecInfo.vecCenterSet))
+        for (ShapeSet::iterator it = shapes->begin();it != shapes->end(); ++it)
+            geoMbr.expand((*it)->calcGeoMbr());
     // Note: Should work for the globe, but doesn't
     if (vecInfo.centered && coordAdapter->isFlat())
     {
@@ -583,9 +700,6 @@ SimpleIdentity VectorManager::addVectors(ShapeSet *shapes, const VectorInfo &vec
             centerValid = true;
         } else {
           // Calculate the center
-          GeoMbr geoMbr;
-          for (ShapeSet::iterator it = shapes->begin();it != shapes->end(); ++it)
-              geoMbr.expand((*it)->calcGeoMbr());
           if (geoMbr.valid())
           {
               Point3d p0 = coordAdapter->localToDisplay(coordSys->geographicToLocal3d(geoMbr.ll()));
@@ -604,10 +718,29 @@ SimpleIdentity VectorManager::addVectors(ShapeSet *shapes, const VectorInfo &vec
     VectorDrawableBuilderTri drawBuildTri(scene,changes,sceneRep,&vecInfo,doColors);
     if (centerValid)
         drawBuildTri.setCenter(center,geoCenter);
+    
+    // Sample whatever elevation is loaded for the area
+    if (vecInfo.clampToGround && geoMbr.valid())
+    {
+        sceneRep->geoMbr = geoMbr;
+        ElevationManager *elevManager = (ElevationManager *)scene->getManager(kWKElevationManager);
+        if (elevManager)
+        {
+            ElevationSamplerRef elevSampler = elevManager->makeSampler(geoMbr);
+            if (!elevSampler->empty())
+            {
+                drawBuild.setElevation(elevSampler);
+                drawBuildTri.setElevation(elevSampler);
+            }
+        }
+    }
         
     for (ShapeSet::iterator it = shapes->begin();
          it != shapes->end(); ++it)
     {
+        drawBuild.setShape(it->get());
+        drawBuildTri.setShape(it->get());
+        
         VectorArealRef theAreal = std::dynamic_pointer_cast<VectorAreal>(*it);
         if (theAreal.get())
         {
@@ -699,16 +832,15 @@ SimpleIdentity VectorManager::addVectors(ShapeSet *shapes, const VectorInfo &vec
     drawBuild.flush();
     drawBuildTri.flush();
     
-    SimpleIdentity vecID = sceneRep->getId();
-    pthread_mutex_lock(&vectorLock);
-    vectorReps.insert(sceneRep);
-    pthread_mutex_unlock(&vectorLock);
-    
-    return vecID;
+    // Keyframe tracks can animate the vectors as a whole
+    if (!sceneRep->drawIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),sceneRep->drawIDs));
 }
 
 SimpleIdentity VectorManager::instanceVectors(SimpleIdentity vecID,const VectorInfo &vecInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(vecInfo.memLabel);
     SimpleIdentity newId = EmptyIdentity;
     
     pthread_mutex_lock(&vectorLock);
@@ -716,7 +848,9 @@ SimpleIdentity VectorManager::instanceVectors(SimpleIdentity vecID,const VectorI
     // Look for the representation
     VectorSceneRep dummyRep(vecID);
     VectorSceneRepSet::iterator it = vectorReps.find(&dummyRep);
-    if (it != vectorReps.end())
+    if (it != vectorReps.end() && (*it)->clampInfo)
+        WHIRLYKIT_LOGW("VectorManager: Can't instance vectors clamped to the ground");
+    else if (it != vectorReps.end())
     {
         VectorSceneRep *sceneRep = *it;
         VectorSceneRep *newSceneRep = new VectorSceneRep();
@@ -742,8 +876,13 @@ SimpleIdentity VectorManager::instanceVectors(SimpleIdentity vecID,const VectorI
             changes.push_back(new AddDrawableReq(drawInst));
         }
         
+        if (!newSceneRep->instIDs.empty())
+            changes.push_back(new SetAnimFeatureReq(newSceneRep->getId(),newSceneRep->instIDs));
+        
         vectorReps.insert(newSceneRep);
         newId = newSceneRep->getId();
+        tagChanges(changes,startChange,memTag);
+        trackSceneRep(newId,sizeof(*newSceneRep),memTag);
     }
 
     pthread_mutex_unlock(&vectorLock);
@@ -761,6 +900,15 @@ void VectorManager::changeVectors(SimpleIdentity vecID,const VectorInfo &vecInfo
     if (it != vectorReps.end())
     {
         VectorSceneRep *sceneRep = *it;
+        // Rebuilds need to pick up the changes
+        if (sceneRep->clampInfo)
+        {
+            sceneRep->clampInfo->color = vecInfo.color;
+            sceneRep->clampInfo->minVis = vecInfo.minVis;
+            sceneRep->clampInfo->maxVis = vecInfo.maxVis;
+            sceneRep->clampInfo->lineWidth = vecInfo.lineWidth;
+            sceneRep->clampInfo->drawPriority = vecInfo.drawPriority;
+        }
         // Make sure we change both drawables and instances
         SimpleIDSet allIDs = sceneRep->drawIDs;
         allIDs.insert(sceneRep->instIDs.begin(),sceneRep->instIDs.end());
@@ -784,6 +932,44 @@ void VectorManager::changeVectors(SimpleIdentity vecID,const VectorInfo &vecInfo
     pthread_mutex_unlock(&vectorLock);
 }
 
+void VectorManager::changeVectorColors(SimpleIdentity vecID,const ShapeSet &shapes,ChangeSet &changes)
+{
+    pthread_mutex_lock(&vectorLock);
+    
+    VectorSceneRep dummyRep(vecID);
+    VectorSceneRepSet::iterator it = vectorReps.find(&dummyRep);
+    if (it != vectorReps.end())
+    {
+        VectorSceneRep *sceneRep = *it;
+        if (sceneRep->shapeRanges.empty())
+            WHIRLYKIT_LOGW("VectorManager: Vectors weren't added as recolorable");
+        
+        // One request per drawable with all its changes
+        std::map<SimpleIdentity,VertexColorChangeRequest *> requests;
+        for (ShapeSet::const_iterator sit = shapes.begin(); sit != shapes.end(); ++sit)
+        {
+            Dictionary *attrs = (*sit)->getAttrDict();
+            if (!attrs->hasField(MaplyColor))
+                continue;
+            auto rit = sceneRep->shapeRanges.find(sit->get());
+            if (rit == sceneRep->shapeRanges.end())
+                continue;
+            RGBAColor color = attrs->getColor(MaplyColor,RGBAColor(255,255,255,255));
+            for (const VectorSceneRep::VertexRange &range : rit->second)
+            {
+                VertexColorChangeRequest *&req = requests[range.drawID];
+                if (!req)
+                    req = new VertexColorChangeRequest(range.drawID);
+                req->addRange(range.start,range.count,color);
+            }
+        }
+        for (auto &req : requests)
+            changes.push_back(req.second);
+    }
+    
+    pthread_mutex_unlock(&vectorLock);
+}
+
 void VectorManager::removeVectors(SimpleIDSet &vecIDs,ChangeSet &changes)
 {
     pthread_mutex_lock(&vectorLock);
@@ -814,7 +1000,9 @@ void VectorManager::removeVectors(SimpleIDSet &vecIDs,ChangeSet &changes)
             for (SimpleIDSet::iterator idIt = allIDs.begin();
                  idIt != allIDs.end(); ++idIt)
                 changes.push_back(new RemDrawableReq(*idIt));
+            changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),SimpleIDSet()));
             vectorReps.erase(it);
+            untrackSceneRep(sceneRep->getId());
             
             delete sceneRep;
         }
@@ -834,6 +1022,8 @@ void VectorManager::enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet &cha
         if (it != vectorReps.end())
         {
             VectorSceneRep *sceneRep = *it;
+            if (sceneRep->clampInfo)
+                sceneRep->clampInfo->enable = enable;
             
             SimpleIDSet allIDs = sceneRep->drawIDs;
             allIDs.insert(sceneRep->instIDs.begin(),sceneRep->instIDs.end());
@@ -845,4 +1035,36 @@ void VectorManager::enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet &cha
     pthread_mutex_unlock(&vectorLock);    
 }
 
+void VectorManager::elevationChanged(const std::vector<GeoMbr> &mbrs,ChangeSet &changes)
+{
+    pthread_mutex_lock(&vectorLock);
+    
+    for (VectorSceneRepSet::iterator it = vectorReps.begin(); it != vectorReps.end(); ++it)
+    {
+        VectorSceneRep *sceneRep = *it;
+        if (!sceneRep->clampInfo)
+            continue;
+        
+        bool overlaps = false;
+        for (const auto &mbr : mbrs)
+            if (mbr.overlaps(sceneRep->geoMbr))
+            {
+                overlaps = true;
+                break;
+            }
+        if (!overlaps)
+            continue;
+        
+        // Swap in new drawables.  The vector ID stays the same.
+        sceneRep->clear(changes);
+        sceneRep->drawIDs.clear();
+        sceneRep->shapeRanges.clear();
+        unsigned int startChange = changes.size();
+        buildVectors(sceneRep,&sceneRep->shapes,*sceneRep->clampInfo,changes);
+        tagChanges(changes,startChange,getMemTag(sceneRep->clampInfo->memLabel));
+    }
+    
+    pthread_mutex_unlock(&vectorLock);
+}
+
 }
@@ -22,6 +22,8 @@
 #import "GlobeMath.h"
 #import "VectorData.h"
 #import "ShapeReader.h"
+#import "VectorWKB.h"
+#import "VectorWKT.h"
 #import "WhirlyKitLog.h"
 
 namespace WhirlyKit
@@ -70,6 +72,50 @@ bool VectorObject::fromShapeFile(const std::string &fileName)
     
     return true;
 }
+
+bool VectorObject::fromWKB(const unsigned char *data,size_t len)
+{
+    WKBParser parser;
+    return parser.parseAll(data,len,shapes);
+}
+
+bool VectorObject::fromTWKB(const unsigned char *data,size_t len)
+{
+    TWKBParser parser;
+    return parser.parseAll(data,len,shapes);
+}
+
+bool VectorObject::fromWKT(const std::string &wkt)
+{
+    WKTParser parser;
+    if (!parser.parseAll(wkt,shapes))
+    {
+        WHIRLYKIT_LOGW("VectorObject: Couldn't parse WKT: %s",parser.getError().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool VectorObject::toWKB(std::string &out,int srid)
+{
+    WKBWriter writer;
+    writer.setSRID(srid);
+    return writer.write(shapes,out);
+}
+
+bool VectorObject::toTWKB(std::string &out,int precision)
+{
+    TWKBWriter writer;
+    writer.setPrecision(precision);
+    return writer.write(shapes,out);
+}
+
+bool VectorObject::toWKT(std::string &out)
+{
+    WKTWriter writer;
+    return writer.write(shapes,out);
+}
     
 Dictionary *VectorObject::getAttributes()
 {
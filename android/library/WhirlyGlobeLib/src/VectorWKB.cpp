@@ -0,0 +1,1189 @@
+/*
+ *  VectorWKB.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <string.h>
+#import <math.h>
+#import "VectorWKB.h"
+
+namespace WhirlyKit
+{
+
+// Collections can nest, but not forever
+static const int MaxWKBDepth = 32;
+
+// EWKB flags in the high bits of the type
+static const uint32_t EWKBZFlag = 0x80000000;
+static const uint32_t EWKBMFlag = 0x40000000;
+static const uint32_t EWKBSRIDFlag = 0x20000000;
+
+// TWKB metadata bits
+static const unsigned char TWKBBBoxFlag = 0x01;
+static const unsigned char TWKBSizeFlag = 0x02;
+static const unsigned char TWKBIDListFlag = 0x04;
+static const unsigned char TWKBExtendedFlag = 0x08;
+static const unsigned char TWKBEmptyFlag = 0x10;
+
+// Streams give up on a geometry bigger than this
+static const size_t MaxStreamGeometry = 64*1024*1024;
+
+Point2d GeometryDegreesToRadians(const Point2d &pt)
+{
+    return Point2d(DegToRad(pt.x()),DegToRad(pt.y()));
+}
+
+Point2d GeometryRadiansToDegrees(const Point2d &pt)
+{
+    return Point2d(RadToDeg(pt.x()),RadToDeg(pt.y()));
+}
+
+static bool IsMultiType(int type)
+{
+    return type == WKBMultiPoint || type == WKBMultiLineString || type == WKBMultiPolygon || type == WKBGeometryCollection ||
+        type == WKBPolyhedralSurface || type == WKBTIN;
+}
+
+bool WKBGeometry::empty() const
+{
+    for (const auto &ring : rings)
+        if (!ring.empty())
+            return false;
+    for (const auto &part : parts)
+        if (!part.empty())
+            return false;
+
+    return true;
+}
+
+bool WKBGeometry::FromShape(VectorShape *shape,const GeometryConverter &converter,WKBGeometry &geom)
+{
+    auto convert = [&](double x,double y,double z)
+    {
+        Point2d pt = converter ? converter(Point2d(x,y)) : Point2d(x,y);
+        return Point3d(pt.x(),pt.y(),z);
+    };
+
+    geom = WKBGeometry();
+    if (VectorPoints *pts = dynamic_cast<VectorPoints *>(shape))
+    {
+        if (pts->pts.empty())
+            return false;
+        geom.type = pts->pts.size() == 1 ? WKBPoint : WKBMultiPoint;
+        for (const auto &pt : pts->pts)
+        {
+            Point3dVector ring(1,convert(pt.x(),pt.y(),0.0));
+            if (geom.type == WKBPoint)
+                geom.rings.push_back(ring);
+            else {
+                WKBGeometry part;
+                part.rings.push_back(ring);
+                geom.parts.push_back(part);
+            }
+        }
+    } else if (VectorLinear *lin = dynamic_cast<VectorLinear *>(shape))
+    {
+        geom.type = WKBLineString;
+        geom.rings.resize(1);
+        geom.rings[0].reserve(lin->pts.size());
+        for (const auto &pt : lin->pts)
+            geom.rings[0].push_back(convert(pt.x(),pt.y(),0.0));
+    } else if (VectorLinear3d *lin3d = dynamic_cast<VectorLinear3d *>(shape))
+    {
+        geom.type = WKBLineString;
+        geom.hasZ = true;
+        geom.rings.resize(1);
+        geom.rings[0].reserve(lin3d->pts.size());
+        for (const auto &pt : lin3d->pts)
+            geom.rings[0].push_back(convert(pt.x(),pt.y(),pt.z()));
+    } else if (VectorAreal *ar = dynamic_cast<VectorAreal *>(shape))
+    {
+        geom.type = WKBPolygon;
+        geom.rings.resize(ar->loops.size());
+        for (unsigned int ii=0;ii<ar->loops.size();ii++)
+        {
+            const VectorRing &loop = ar->loops[ii];
+            Point3dVector &ring = geom.rings[ii];
+            ring.reserve(loop.size()+1);
+            for (const auto &pt : loop)
+                ring.push_back(convert(pt.x(),pt.y(),0.0));
+            // Simple features rings are closed
+            if (!loop.empty() && loop.front() != loop.back())
+                ring.push_back(ring.front());
+        }
+    } else if (VectorTriangles *mesh = dynamic_cast<VectorTriangles *>(shape))
+    {
+        geom.type = WKBTIN;
+        geom.hasZ = true;
+        for (const auto &tri : mesh->tris)
+        {
+            WKBGeometry part;
+            part.type = WKBTriangle;
+            part.hasZ = true;
+            part.rings.resize(1);
+            for (unsigned int ii=0;ii<4;ii++)
+            {
+                int which = tri.pts[ii % 3];
+                if (which < 0 || which >= mesh->pts.size())
+                    return false;
+                const Point3f &pt = mesh->pts[which];
+                part.rings[0].push_back(convert(pt.x(),pt.y(),pt.z()));
+            }
+            geom.parts.push_back(part);
+        }
+    } else
+        return false;
+
+    return true;
+}
+
+bool WKBGeometry::FromShapes(const ShapeSet &shapes,const GeometryConverter &converter,const std::string &idAttr,WKBGeometry &geom)
+{
+    std::vector<WKBGeometry> geoms;
+    std::vector<int64_t> ids;
+    for (auto shape : shapes)
+    {
+        WKBGeometry thisGeom;
+        if (!FromShape(shape.get(),converter,thisGeom))
+            continue;
+        int64_t thisID = 0;
+        if (!idAttr.empty())
+        {
+            Dictionary *attrs = shape->getAttrDict();
+            if (attrs)
+                thisID = (int64_t)attrs->getDouble(idAttr);
+        }
+
+        // Multi points are flattened out, in case there's more than one
+        if (thisGeom.type == WKBMultiPoint && shapes.size() > 1)
+            for (const auto &part : thisGeom.parts)
+            {
+                geoms.push_back(part);
+                ids.push_back(thisID);
+            }
+        else {
+            geoms.push_back(thisGeom);
+            ids.push_back(thisID);
+        }
+    }
+    if (geoms.empty())
+        return false;
+    if (geoms.size() == 1)
+    {
+        geom = geoms[0];
+        return true;
+    }
+
+    int type = geoms[0].type;
+    bool hasZ = false;
+    for (const auto &part : geoms)
+    {
+        if (part.type != type)
+            type = -1;
+        hasZ |= part.hasZ;
+    }
+    geom = WKBGeometry();
+    switch (type)
+    {
+        case WKBPoint:
+            geom.type = WKBMultiPoint;
+            break;
+        case WKBLineString:
+            geom.type = WKBMultiLineString;
+            break;
+        case WKBPolygon:
+            geom.type = WKBMultiPolygon;
+            break;
+        default:
+            geom.type = WKBGeometryCollection;
+            break;
+    }
+    geom.hasZ = hasZ;
+    geom.parts.swap(geoms);
+    if (!idAttr.empty())
+        geom.ids.swap(ids);
+
+    return true;
+}
+
+void WKBGeometry::toShapes(const GeometryConverter &converter,bool keepZ,const std::string &idAttr,ShapeSet &shapes) const
+{
+    auto convert = [&](const Point3d &pt)
+    {
+        Point2d geo = converter ? converter(Point2d(pt.x(),pt.y())) : Point2d(pt.x(),pt.y());
+        return geo;
+    };
+    auto toRing = [&](const Point3dVector &pts,VectorRing &ring)
+    {
+        ring.reserve(pts.size());
+        for (const auto &pt : pts)
+        {
+            Point2d geo = convert(pt);
+            ring.push_back(Point2f(geo.x(),geo.y()));
+        }
+    };
+
+    switch (type)
+    {
+        case WKBPoint:
+        {
+            if (rings.empty() || rings[0].empty() || std::isnan(rings[0][0].x()) || std::isnan(rings[0][0].y()))
+                break;
+            VectorPointsRef pts = VectorPoints::createPoints();
+            toRing(rings[0],pts->pts);
+            pts->initGeoMbr();
+            shapes.insert(pts);
+        }
+            break;
+        case WKBLineString:
+        {
+            if (rings.empty() || rings[0].empty())
+                break;
+            if (hasZ && keepZ)
+            {
+                VectorLinear3dRef lin = VectorLinear3d::createLinear();
+                lin->pts.reserve(rings[0].size());
+                for (const auto &pt : rings[0])
+                {
+                    Point2d geo = convert(pt);
+                    lin->pts.push_back(Point3d(geo.x(),geo.y(),pt.z()));
+                }
+                lin->initGeoMbr();
+                shapes.insert(lin);
+            } else {
+                VectorLinearRef lin = VectorLinear::createLinear();
+                toRing(rings[0],lin->pts);
+                lin->initGeoMbr();
+                shapes.insert(lin);
+            }
+        }
+            break;
+        case WKBPolygon:
+        {
+            if (rings.empty())
+                break;
+            VectorArealRef ar = VectorAreal::createAreal();
+            ar->loops.resize(rings.size());
+            for (unsigned int ii=0;ii<rings.size();ii++)
+                toRing(rings[ii],ar->loops[ii]);
+            ar->initGeoMbr();
+            shapes.insert(ar);
+        }
+            break;
+        case WKBTriangle:
+        case WKBTIN:
+        {
+            // Each triangle gets its own points
+            VectorTrianglesRef mesh = VectorTriangles::createTriangles();
+            const std::vector<WKBGeometry> single(1,*this);
+            const std::vector<WKBGeometry> &tris = type == WKBTriangle ? single : parts;
+            for (const auto &tri : tris)
+            {
+                if (tri.rings.empty() || tri.rings[0].size() < 3)
+                    continue;
+                VectorTriangles::Triangle newTri;
+                for (unsigned int ii=0;ii<3;ii++)
+                {
+                    const Point3d &pt = tri.rings[0][ii];
+                    Point2d geo = convert(pt);
+                    newTri.pts[ii] = (int)mesh->pts.size();
+                    mesh->pts.push_back(Point3f(geo.x(),geo.y(),pt.z()));
+                }
+                mesh->tris.push_back(newTri);
+            }
+            if (!mesh->tris.empty())
+            {
+                mesh->initGeoMbr();
+                shapes.insert(mesh);
+            }
+        }
+            break;
+        default:
+        {
+            // Multi points are gathered back into one shape, unless they've got IDs
+            bool gatherPoints = type == WKBMultiPoint && ids.empty();
+            VectorPointsRef allPts = gatherPoints ? VectorPoints::createPoints() : VectorPointsRef();
+            for (unsigned int ii=0;ii<parts.size();ii++)
+            {
+                ShapeSet partShapes;
+                parts[ii].toShapes(converter,keepZ,idAttr,partShapes);
+                for (auto shape : partShapes)
+                {
+                    VectorPointsRef partPts = gatherPoints ? std::dynamic_pointer_cast<VectorPoints>(shape) : VectorPointsRef();
+                    if (partPts)
+                    {
+                        allPts->pts.insert(allPts->pts.end(),partPts->pts.begin(),partPts->pts.end());
+                        continue;
+                    }
+                    if (ii < ids.size() && !idAttr.empty())
+                    {
+                        int64_t theID = ids[ii];
+                        if (theID >= INT32_MIN && theID <= INT32_MAX)
+                            shape->getAttrDict()->setInt(idAttr,(int)theID);
+                        else
+                            shape->getAttrDict()->setDouble(idAttr,(double)theID);
+                    }
+                    shapes.insert(shape);
+                }
+            }
+            if (allPts && !allPts->pts.empty())
+            {
+                allPts->initGeoMbr();
+                shapes.insert(allPts);
+            }
+        }
+            break;
+    }
+}
+
+WKBParser::WKBParser()
+    : converter(GeometryDegreesToRadians), keepZ(false), data(NULL), len(0), pos(0), littleEndian(true), truncated(false), srid(0)
+{
+}
+
+size_t WKBParser::parse(const unsigned char *inData,size_t inLen,WKBGeometry &geom)
+{
+    data = inData;
+    len = inLen;
+    pos = 0;
+    truncated = false;
+
+    if (!parseGeometry(geom,0))
+        return 0;
+
+    return pos;
+}
+
+size_t WKBParser::parse(const unsigned char *inData,size_t inLen,ShapeSet &shapes)
+{
+    // Only hand back shapes if the whole geometry parsed
+    WKBGeometry geom;
+    size_t used = parse(inData,inLen,geom);
+    if (used == 0)
+        return 0;
+    geom.toShapes(converter,keepZ,std::string(),shapes);
+
+    return used;
+}
+
+bool WKBParser::parseAll(const unsigned char *inData,size_t inLen,ShapeSet &shapes)
+{
+    size_t where = 0;
+    while (where < inLen)
+    {
+        size_t used = parse(inData + where,inLen - where,shapes);
+        if (used == 0)
+            return false;
+        where += used;
+    }
+
+    return true;
+}
+
+bool WKBParser::readUInt32(uint32_t &val)
+{
+    if (pos + 4 > len)
+    {
+        truncated = true;
+        return false;
+    }
+    const unsigned char *b = data + pos;
+    if (littleEndian)
+        val = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    else
+        val = (uint32_t)b[3] | ((uint32_t)b[2] << 8) | ((uint32_t)b[1] << 16) | ((uint32_t)b[0] << 24);
+    pos += 4;
+
+    return true;
+}
+
+bool WKBParser::readDouble(double &val)
+{
+    if (pos + 8 > len)
+    {
+        truncated = true;
+        return false;
+    }
+    uint64_t bits = 0;
+    const unsigned char *b = data + pos;
+    for (int ii=0;ii<8;ii++)
+        bits |= (uint64_t)b[littleEndian ? ii : 7-ii] << (8*ii);
+    memcpy(&val,&bits,8);
+    pos += 8;
+
+    return true;
+}
+
+bool WKBParser::readHeader(int &type,bool &hasZ,bool &hasM)
+{
+    if (pos >= len)
+    {
+        truncated = true;
+        return false;
+    }
+    littleEndian = data[pos++] == 1;
+
+    uint32_t rawType;
+    if (!readUInt32(rawType))
+        return false;
+    hasZ = (rawType & EWKBZFlag) != 0;
+    hasM = (rawType & EWKBMFlag) != 0;
+    if (rawType & EWKBSRIDFlag)
+    {
+        uint32_t newSRID;
+        if (!readUInt32(newSRID))
+            return false;
+        srid = (int)newSRID;
+    }
+    rawType &= 0x0fffffff;
+
+    // ISO style dimensions
+    switch (rawType / 1000)
+    {
+        case 1:
+            hasZ = true;
+            break;
+        case 2:
+            hasM = true;
+            break;
+        case 3:
+            hasZ = hasM = true;
+            break;
+    }
+    type = rawType % 1000;
+
+    return true;
+}
+
+bool WKBParser::readPoint(bool hasZ,bool hasM,Point3d &pt)
+{
+    double x,y,z = 0.0,m;
+    if (!readDouble(x) || !readDouble(y))
+        return false;
+    if (hasZ && !readDouble(z))
+        return false;
+    if (hasM && !readDouble(m))
+        return false;
+    pt = Point3d(x,y,z);
+
+    return true;
+}
+
+bool WKBParser::readRing(bool hasZ,bool hasM,Point3dVector &ring)
+{
+    uint32_t numPts;
+    if (!readUInt32(numPts))
+        return false;
+    // Don't trust the count any further than the data
+    size_t ptSize = 8 * (2 + (hasZ ? 1 : 0) + (hasM ? 1 : 0));
+    if (numPts > (len - pos) / ptSize)
+    {
+        truncated = true;
+        return false;
+    }
+    ring.resize(numPts);
+    for (unsigned int ii=0;ii<numPts;ii++)
+        if (!readPoint(hasZ,hasM,ring[ii]))
+            return false;
+
+    return true;
+}
+
+bool WKBParser::parseGeometry(WKBGeometry &geom,int depth)
+{
+    if (depth > MaxWKBDepth)
+        return false;
+
+    int type;
+    bool hasZ,hasM;
+    if (!readHeader(type,hasZ,hasM))
+        return false;
+    geom.type = (WKBGeometryType)type;
+    geom.hasZ = hasZ;
+
+    switch (type)
+    {
+        case WKBPoint:
+            geom.rings.resize(1);
+            geom.rings[0].resize(1);
+            if (!readPoint(hasZ,hasM,geom.rings[0][0]))
+                return false;
+            break;
+        case WKBLineString:
+            geom.rings.resize(1);
+            if (!readRing(hasZ,hasM,geom.rings[0]))
+                return false;
+            break;
+        case WKBPolygon:
+        case WKBTriangle:
+        {
+            uint32_t numRings;
+            if (!readUInt32(numRings))
+                return false;
+            if (numRings > (len - pos) / 4)
+            {
+                truncated = true;
+                return false;
+            }
+            geom.rings.resize(numRings);
+            for (unsigned int ii=0;ii<numRings;ii++)
+                if (!readRing(hasZ,hasM,geom.rings[ii]))
+                    return false;
+        }
+            break;
+        default:
+        {
+            if (!IsMultiType(type))
+                return false;
+            uint32_t numParts;
+            if (!readUInt32(numParts))
+                return false;
+            if (numParts > (len - pos) / 5)
+            {
+                truncated = true;
+                return false;
+            }
+            geom.parts.resize(numParts);
+            for (unsigned int ii=0;ii<numParts;ii++)
+                if (!parseGeometry(geom.parts[ii],depth+1))
+                    return false;
+        }
+            break;
+    }
+
+    return true;
+}
+
+static void AppendUInt32(uint32_t val,std::string &out)
+{
+    char b[4] = {(char)(val & 0xff),(char)((val >> 8) & 0xff),(char)((val >> 16) & 0xff),(char)((val >> 24) & 0xff)};
+    out.append(b,4);
+}
+
+static void AppendDouble(double val,std::string &out)
+{
+    uint64_t bits;
+    memcpy(&bits,&val,8);
+    char b[8];
+    for (int ii=0;ii<8;ii++)
+        b[ii] = (char)((bits >> (8*ii)) & 0xff);
+    out.append(b,8);
+}
+
+WKBWriter::WKBWriter()
+    : converter(GeometryRadiansToDegrees), srid(0), ewkb(false)
+{
+}
+
+bool WKBWriter::write(const ShapeSet &shapes,std::string &out)
+{
+    WKBGeometry geom;
+    if (!WKBGeometry::FromShapes(shapes,converter,std::string(),geom))
+        return false;
+    write(geom,out);
+
+    return true;
+}
+
+bool WKBWriter::write(VectorShapeRef shape,std::string &out)
+{
+    WKBGeometry geom;
+    if (!shape || !WKBGeometry::FromShape(shape.get(),converter,geom))
+        return false;
+    write(geom,out);
+
+    return true;
+}
+
+void WKBWriter::write(const WKBGeometry &geom,std::string &out)
+{
+    writeGeometry(geom,geom.hasZ,true,out);
+}
+
+void WKBWriter::writeGeometry(const WKBGeometry &geom,bool hasZ,bool top,std::string &out)
+{
+    out += (char)1;
+    bool useEWKB = ewkb || srid != 0;
+    uint32_t type = geom.type;
+    if (useEWKB)
+    {
+        if (hasZ)
+            type |= EWKBZFlag;
+        if (top && srid != 0)
+            type |= EWKBSRIDFlag;
+    } else if (hasZ)
+        type += 1000;
+    AppendUInt32(type,out);
+    if (useEWKB && top && srid != 0)
+        AppendUInt32((uint32_t)srid,out);
+
+    auto writeRing = [&](const Point3dVector &ring)
+    {
+        for (const auto &pt : ring)
+        {
+            AppendDouble(pt.x(),out);
+            AppendDouble(pt.y(),out);
+            if (hasZ)
+                AppendDouble(pt.z(),out);
+        }
+    };
+
+    switch (geom.type)
+    {
+        case WKBPoint:
+            if (geom.rings.empty() || geom.rings[0].empty())
+            {
+                // Empty points are NaNs
+                for (unsigned int ii=0;ii<(hasZ ? 3 : 2);ii++)
+                    AppendDouble(NAN,out);
+            } else {
+                Point3dVector ring(1,geom.rings[0][0]);
+                writeRing(ring);
+            }
+            break;
+        case WKBLineString:
+            if (geom.rings.empty())
+                AppendUInt32(0,out);
+            else {
+                AppendUInt32((uint32_t)geom.rings[0].size(),out);
+                writeRing(geom.rings[0]);
+            }
+            break;
+        case WKBPolygon:
+        case WKBTriangle:
+            AppendUInt32((uint32_t)geom.rings.size(),out);
+            for (const auto &ring : geom.rings)
+            {
+                AppendUInt32((uint32_t)ring.size(),out);
+                writeRing(ring);
+            }
+            break;
+        default:
+            AppendUInt32((uint32_t)geom.parts.size(),out);
+            for (const auto &part : geom.parts)
+                writeGeometry(part,hasZ,false,out);
+            break;
+    }
+}
+
+TWKBParser::TWKBParser()
+    : converter(GeometryDegreesToRadians), keepZ(false), idAttr("id"), data(NULL), len(0), pos(0), truncated(false),
+    hasZ(false), hasM(false), scaleXY(1.0), scaleZ(1.0), scaleM(1.0)
+{
+    memset(prev,0,sizeof(prev));
+}
+
+bool TWKBParser::readVarInt(uint64_t &val)
+{
+    val = 0;
+    for (int shift=0;shift<64;shift+=7)
+    {
+        if (pos >= len)
+        {
+            truncated = true;
+            return false;
+        }
+        unsigned char b = data[pos++];
+        val |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+bool TWKBParser::readSignedVarInt(int64_t &val)
+{
+    uint64_t raw;
+    if (!readVarInt(raw))
+        return false;
+    val = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+
+    return true;
+}
+
+bool TWKBParser::readCoords(uint64_t numPts,Point3dVector &pts)
+{
+    int numDims = 2 + (hasZ ? 1 : 0) + (hasM ? 1 : 0);
+    // Every value takes at least a byte
+    if (numPts > (len - pos) / numDims)
+    {
+        truncated = true;
+        return false;
+    }
+    pts.resize(numPts);
+    for (uint64_t ii=0;ii<numPts;ii++)
+    {
+        for (int dim=0;dim<numDims;dim++)
+        {
+            int64_t delta;
+            if (!readSignedVarInt(delta))
+                return false;
+            prev[dim] += delta;
+        }
+        pts[ii] = Point3d(prev[0] / scaleXY,prev[1] / scaleXY,hasZ ? prev[2] / scaleZ : 0.0);
+    }
+
+    return true;
+}
+
+size_t TWKBParser::parse(const unsigned char *inData,size_t inLen,WKBGeometry &geom)
+{
+    data = inData;
+    len = inLen;
+    pos = 0;
+    truncated = false;
+
+    if (!parseGeometry(geom,0))
+        return 0;
+
+    return pos;
+}
+
+size_t TWKBParser::parse(const unsigned char *inData,size_t inLen,ShapeSet &shapes)
+{
+    WKBGeometry geom;
+    size_t used = parse(inData,inLen,geom);
+    if (used == 0)
+        return 0;
+    geom.toShapes(converter,keepZ,idAttr,shapes);
+
+    return used;
+}
+
+bool TWKBParser::parseAll(const unsigned char *inData,size_t inLen,ShapeSet &shapes)
+{
+    size_t where = 0;
+    while (where < inLen)
+    {
+        size_t used = parse(inData + where,inLen - where,shapes);
+        if (used == 0)
+            return false;
+        where += used;
+    }
+
+    return true;
+}
+
+bool TWKBParser::parseGeometry(WKBGeometry &geom,int depth)
+{
+    if (depth > MaxWKBDepth)
+        return false;
+    if (pos + 2 > len)
+    {
+        truncated = true;
+        return false;
+    }
+
+    // Type and precision, then the metadata
+    unsigned char typeByte = data[pos++];
+    unsigned char meta = data[pos++];
+    int type = typeByte & 0x0f;
+    int precXY = (int)((typeByte >> 4) >> 1) ^ -(int)((typeByte >> 4) & 1);
+    hasZ = hasM = false;
+    int precZ = 0,precM = 0;
+    if (meta & TWKBExtendedFlag)
+    {
+        if (pos >= len)
+        {
+            truncated = true;
+            return false;
+        }
+        unsigned char ext = data[pos++];
+        hasZ = ext & 0x01;
+        hasM = ext & 0x02;
+        precZ = (ext >> 2) & 0x07;
+        precM = (ext >> 5) & 0x07;
+    }
+    scaleXY = pow(10.0,precXY);
+    scaleZ = pow(10.0,precZ);
+    scaleM = pow(10.0,precM);
+    memset(prev,0,sizeof(prev));
+    geom.type = (WKBGeometryType)type;
+    geom.hasZ = hasZ;
+    int numDims = 2 + (hasZ ? 1 : 0) + (hasM ? 1 : 0);
+
+    uint64_t size = 0;
+    if ((meta & TWKBSizeFlag) && !readVarInt(size))
+        return false;
+    size_t bodyStart = pos;
+    if ((meta & TWKBSizeFlag) && size > len - pos)
+    {
+        truncated = true;
+        return false;
+    }
+    if (meta & TWKBBBoxFlag)
+        for (int ii=0;ii<2*numDims;ii++)
+        {
+            int64_t val;
+            if (!readSignedVarInt(val))
+                return false;
+        }
+    if (meta & TWKBEmptyFlag)
+    {
+        if (meta & TWKBSizeFlag)
+            pos = bodyStart + size;
+        return true;
+    }
+
+    switch (type)
+    {
+        case WKBPoint:
+            geom.rings.resize(1);
+            if (!readCoords(1,geom.rings[0]))
+                return false;
+            break;
+        case WKBLineString:
+        {
+            uint64_t numPts;
+            geom.rings.resize(1);
+            if (!readVarInt(numPts) || !readCoords(numPts,geom.rings[0]))
+                return false;
+        }
+            break;
+        case WKBPolygon:
+        {
+            uint64_t numRings;
+            if (!readVarInt(numRings))
+                return false;
+            if (numRings > len - pos)
+            {
+                truncated = true;
+                return false;
+            }
+            geom.rings.resize(numRings);
+            for (uint64_t ii=0;ii<numRings;ii++)
+            {
+                uint64_t numPts;
+                if (!readVarInt(numPts) || !readCoords(numPts,geom.rings[ii]))
+                    return false;
+            }
+        }
+            break;
+        case WKBMultiPoint:
+        case WKBMultiLineString:
+        case WKBMultiPolygon:
+        case WKBGeometryCollection:
+        {
+            uint64_t numParts;
+            if (!readVarInt(numParts))
+                return false;
+            if (numParts > len - pos)
+            {
+                truncated = true;
+                return false;
+            }
+            if (meta & TWKBIDListFlag)
+            {
+                geom.ids.resize(numParts);
+                for (uint64_t ii=0;ii<numParts;ii++)
+                    if (!readSignedVarInt(geom.ids[ii]))
+                        return false;
+            }
+            geom.parts.resize(numParts);
+            for (uint64_t ii=0;ii<numParts;ii++)
+            {
+                WKBGeometry &part = geom.parts[ii];
+                if (type == WKBGeometryCollection)
+                {
+                    // Each member is a whole TWKB geometry, with its own header
+                    if (!parseGeometry(part,depth+1))
+                        return false;
+                    continue;
+                }
+                // The deltas carry on from part to part
+                part.hasZ = hasZ;
+                if (type == WKBMultiPoint)
+                {
+                    part.type = WKBPoint;
+                    part.rings.resize(1);
+                    if (!readCoords(1,part.rings[0]))
+                        return false;
+                } else if (type == WKBMultiLineString)
+                {
+                    part.type = WKBLineString;
+                    uint64_t numPts;
+                    part.rings.resize(1);
+                    if (!readVarInt(numPts) || !readCoords(numPts,part.rings[0]))
+                        return false;
+                } else {
+                    part.type = WKBPolygon;
+                    uint64_t numRings;
+                    if (!readVarInt(numRings))
+                        return false;
+                    if (numRings > len - pos)
+                    {
+                        truncated = true;
+                        return false;
+                    }
+                    part.rings.resize(numRings);
+                    for (uint64_t ri=0;ri<numRings;ri++)
+                    {
+                        uint64_t numPts;
+                        if (!readVarInt(numPts) || !readCoords(numPts,part.rings[ri]))
+                            return false;
+                    }
+                }
+            }
+        }
+            break;
+        default:
+            return false;
+    }
+
+    // Trust the size over what we read, so unknown extensions get skipped
+    if (meta & TWKBSizeFlag)
+        pos = bodyStart + size;
+
+    return true;
+}
+
+static void AppendVarInt(uint64_t val,std::string &out)
+{
+    while (val >= 0x80)
+    {
+        out += (char)((val & 0x7f) | 0x80);
+        val >>= 7;
+    }
+    out += (char)val;
+}
+
+static void AppendSignedVarInt(int64_t val,std::string &out)
+{
+    AppendVarInt(((uint64_t)val << 1) ^ (uint64_t)(val >> 63),out);
+}
+
+TWKBWriter::TWKBWriter()
+    : converter(GeometryRadiansToDegrees), precXY(6), precZ(0), includeBBox(false), includeSize(false)
+{
+}
+
+void TWKBWriter::setPrecision(int xy,int z)
+{
+    precXY = std::max(-8,std::min(7,xy));
+    precZ = std::max(0,std::min(7,z));
+}
+
+bool TWKBWriter::write(const ShapeSet &shapes,std::string &out)
+{
+    WKBGeometry geom;
+    if (!WKBGeometry::FromShapes(shapes,converter,idAttr,geom))
+        return false;
+    write(geom,out);
+
+    return true;
+}
+
+bool TWKBWriter::write(VectorShapeRef shape,std::string &out)
+{
+    WKBGeometry geom;
+    if (!shape || !WKBGeometry::FromShape(shape.get(),converter,geom))
+        return false;
+    write(geom,out);
+
+    return true;
+}
+
+void TWKBWriter::write(const WKBGeometry &geom,std::string &out)
+{
+    writeGeometry(geom,out);
+}
+
+void TWKBWriter::writeCoords(const Point3dVector &pts,bool hasZ,int64_t *prev,std::string &out)
+{
+    double scaleXY = pow(10.0,precXY),scaleZ = pow(10.0,precZ);
+    for (const auto &pt : pts)
+    {
+        int64_t vals[3] = {llround(pt.x() * scaleXY),llround(pt.y() * scaleXY),llround(pt.z() * scaleZ)};
+        for (int dim=0;dim<(hasZ ? 3 : 2);dim++)
+        {
+            AppendSignedVarInt(vals[dim] - prev[dim],out);
+            prev[dim] = vals[dim];
+        }
+    }
+}
+
+void TWKBWriter::writeGeometry(const WKBGeometry &geom,std::string &out)
+{
+    // TWKB doesn't do TINs or polyhedral surfaces, so those go out as collections of polygons
+    int type = geom.type;
+    if (type == WKBTriangle)
+        type = WKBPolygon;
+    else if (type == WKBTIN || type == WKBPolyhedralSurface)
+        type = WKBMultiPolygon;
+    bool hasZ = geom.hasZ;
+    bool empty = geom.empty();
+    bool hasIDs = !geom.ids.empty() && geom.ids.size() == geom.parts.size() && IsMultiType(type);
+
+    unsigned char meta = (empty ? TWKBEmptyFlag : 0) | (hasZ ? TWKBExtendedFlag : 0) | (hasIDs ? TWKBIDListFlag : 0);
+    if (includeBBox && !empty)
+        meta |= TWKBBBoxFlag;
+    if (includeSize)
+        meta |= TWKBSizeFlag;
+    int zigPrec = (precXY << 1) ^ (precXY >> 31);
+    out += (char)((type & 0x0f) | (zigPrec << 4));
+    out += (char)meta;
+    if (hasZ)
+        out += (char)(0x01 | (precZ << 2));
+
+    // Body goes out separately if we need its size
+    std::string body;
+    if (includeBBox && !empty)
+    {
+        double scaleXY = pow(10.0,precXY),scaleZ = pow(10.0,precZ);
+        int64_t minVals[3] = {INT64_MAX,INT64_MAX,INT64_MAX},maxVals[3] = {INT64_MIN,INT64_MIN,INT64_MIN};
+        std::function<void(const WKBGeometry &)> addBounds = [&](const WKBGeometry &g)
+        {
+            for (const auto &ring : g.rings)
+                for (const auto &pt : ring)
+                {
+                    int64_t vals[3] = {llround(pt.x() * scaleXY),llround(pt.y() * scaleXY),llround(pt.z() * scaleZ)};
+                    for (int dim=0;dim<3;dim++)
+                    {
+                        minVals[dim] = std::min(minVals[dim],vals[dim]);
+                        maxVals[dim] = std::max(maxVals[dim],vals[dim]);
+                    }
+                }
+            for (const auto &part : g.parts)
+                addBounds(part);
+        };
+        addBounds(geom);
+        for (int dim=0;dim<(hasZ ? 3 : 2);dim++)
+        {
+            AppendSignedVarInt(minVals[dim],body);
+            AppendSignedVarInt(maxVals[dim] - minVals[dim],body);
+        }
+    }
+
+    if (!empty)
+    {
+        int64_t prev[3] = {0,0,0};
+        auto writeRings = [&](const WKBGeometry &g,bool withCount)
+        {
+            if (withCount)
+                AppendVarInt(g.rings.size(),body);
+            for (const auto &ring : g.rings)
+            {
+                AppendVarInt(ring.size(),body);
+                writeCoords(ring,hasZ,prev,body);
+            }
+        };
+        switch (type)
+        {
+            case WKBPoint:
+                writeCoords(geom.rings[0],hasZ,prev,body);
+                break;
+            case WKBLineString:
+                writeRings(geom,false);
+                break;
+            case WKBPolygon:
+                writeRings(geom,true);
+                break;
+            default:
+                AppendVarInt(geom.parts.size(),body);
+                if (hasIDs)
+                    for (auto theID : geom.ids)
+                        AppendSignedVarInt(theID,body);
+                for (const auto &part : geom.parts)
+                {
+                    if (type == WKBGeometryCollection)
+                    {
+                        writeGeometry(part,body);
+                        continue;
+                    }
+                    WKBGeometry thisPart = part;
+                    thisPart.hasZ = hasZ;
+                    if (type == WKBMultiPoint)
+                    {
+                        if (part.rings.empty() || part.rings[0].empty())
+                            thisPart.rings.assign(1,Point3dVector(1,Point3d(0,0,0)));
+                        writeCoords(thisPart.rings[0],hasZ,prev,body);
+                    } else if (type == WKBMultiLineString)
+                    {
+                        if (thisPart.rings.empty())
+                            thisPart.rings.resize(1);
+                        writeRings(thisPart,false);
+                    } else
+                        writeRings(thisPart,true);
+                }
+                break;
+        }
+    }
+
+    if (includeSize)
+        AppendVarInt(body.size(),out);
+    out += body;
+}
+
+WKBStreamDecoder::WKBStreamDecoder(bool twkb)
+    : twkb(twkb), pos(0)
+{
+}
+
+bool WKBStreamDecoder::feed(const unsigned char *data,size_t len)
+{
+    if (!error.empty())
+        return false;
+    buf.append((const char *)data,len);
+
+    while (pos < buf.size())
+    {
+        ShapeSet shapes;
+        const unsigned char *start = (const unsigned char *)buf.data() + pos;
+        size_t left = buf.size() - pos;
+        size_t used = twkb ? twkbParser.parse(start,left,shapes) : wkbParser.parse(start,left,shapes);
+        if (used == 0)
+        {
+            bool needsMore = twkb ? twkbParser.needsMore() : wkbParser.needsMore();
+            if (!needsMore)
+                error = "Bad geometry in the stream";
+            else if (left > MaxStreamGeometry)
+                error = "Geometry in the stream is too big";
+            else
+                break;
+            return false;
+        }
+        pos += used;
+        if (featureCallback && !shapes.empty())
+            featureCallback(shapes);
+    }
+
+    // Toss what we've used
+    if (pos > 0)
+    {
+        buf.erase(0,pos);
+        pos = 0;
+    }
+
+    return true;
+}
+
+bool WKBStreamDecoder::finish()
+{
+    if (!error.empty())
+        return false;
+    if (pos < buf.size())
+    {
+        error = "Partial geometry at the end of the stream";
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,521 @@
+/*
+ *  VectorWKT.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <ctype.h>
+#import <math.h>
+#import "VectorWKT.h"
+
+namespace WhirlyKit
+{
+
+// Collections can nest, but not forever
+static const int MaxWKTDepth = 32;
+
+// Dimension tags
+typedef enum {WKTDimsUnknown,WKTDimsZ,WKTDimsM,WKTDimsZM} WKTDims;
+
+static const struct
+{
+    const char *name;
+    WKBGeometryType type;
+} WKTTypeNames[] = {
+    {"POINT",WKBPoint},{"LINESTRING",WKBLineString},{"POLYGON",WKBPolygon},
+    {"MULTIPOINT",WKBMultiPoint},{"MULTILINESTRING",WKBMultiLineString},{"MULTIPOLYGON",WKBMultiPolygon},
+    {"GEOMETRYCOLLECTION",WKBGeometryCollection},{"POLYHEDRALSURFACE",WKBPolyhedralSurface},
+    {"TIN",WKBTIN},{"TRIANGLE",WKBTriangle}
+};
+static const int NumWKTTypes = sizeof(WKTTypeNames)/sizeof(WKTTypeNames[0]);
+
+static bool WKTTypeForName(const std::string &name,WKBGeometryType &type)
+{
+    for (int ii=0;ii<NumWKTTypes;ii++)
+        if (name == WKTTypeNames[ii].name)
+        {
+            type = WKTTypeNames[ii].type;
+            return true;
+        }
+
+    return false;
+}
+
+static const char *WKTNameForType(WKBGeometryType type)
+{
+    for (int ii=0;ii<NumWKTTypes;ii++)
+        if (WKTTypeNames[ii].type == type)
+            return WKTTypeNames[ii].name;
+
+    return "GEOMETRYCOLLECTION";
+}
+
+WKTParser::WKTParser()
+    : converter(GeometryDegreesToRadians), keepZ(false), str(NULL), len(0), pos(0), sawZ(false), srid(0)
+{
+}
+
+bool WKTParser::fail(const std::string &what)
+{
+    if (error.empty())
+        error = what + " at character " + std::to_string(pos);
+    return false;
+}
+
+void WKTParser::skipSpace()
+{
+    while (pos < len && isspace((unsigned char)str[pos]))
+        pos++;
+}
+
+bool WKTParser::readWord(std::string &word)
+{
+    skipSpace();
+    word.clear();
+    while (pos < len && isalpha((unsigned char)str[pos]))
+        word += (char)toupper((unsigned char)str[pos++]);
+
+    return !word.empty();
+}
+
+bool WKTParser::peek(char c)
+{
+    skipSpace();
+    return pos < len && str[pos] == c;
+}
+
+bool WKTParser::expect(char c)
+{
+    if (!peek(c))
+        return fail(std::string("Expected '") + c + "'");
+    pos++;
+
+    return true;
+}
+
+bool WKTParser::parsePoint(int numDims,Point3d &pt)
+{
+    // Pull out up to four numbers
+    double vals[4] = {0,0,0,0};
+    int count = 0;
+    while (count < 4)
+    {
+        skipSpace();
+        size_t start = pos;
+        while (pos < len && (isdigit((unsigned char)str[pos]) || str[pos] == '-' || str[pos] == '+' ||
+                             str[pos] == '.' || str[pos] == 'e' || str[pos] == 'E'))
+            pos++;
+        if (pos == start)
+            break;
+        std::string num(str+start,pos-start);
+        char *end = NULL;
+        vals[count++] = strtod(num.c_str(),&end);
+        if (*end != 0)
+            return fail("Bad number");
+    }
+    if (count < 2)
+        return fail("Expected a coordinate");
+    // With a dimension tag, the count has to match it
+    int wantCount = numDims == WKTDimsZM ? 4 : ((numDims == WKTDimsZ || numDims == WKTDimsM) ? 3 : 0);
+    if (wantCount && count != wantCount)
+        return fail("Wrong number of values in a coordinate");
+
+    bool hasZ = numDims == WKTDimsZ || numDims == WKTDimsZM || (numDims == WKTDimsUnknown && count >= 3);
+    if (numDims == WKTDimsUnknown && count >= 3)
+        sawZ = true;
+    pt = Point3d(vals[0],vals[1],hasZ && count >= 3 ? vals[2] : 0.0);
+
+    return true;
+}
+
+bool WKTParser::parseCoords(int numDims,Point3dVector &pts,bool parens)
+{
+    if (!expect('('))
+        return false;
+    while (true)
+    {
+        // Multi points can have their points in parentheses, or not
+        bool inner = parens && peek('(');
+        if (inner)
+            pos++;
+        Point3d pt;
+        if (!parsePoint(numDims,pt))
+            return false;
+        if (inner && !expect(')'))
+            return false;
+        pts.push_back(pt);
+        if (!peek(','))
+            break;
+        pos++;
+    }
+
+    return expect(')');
+}
+
+bool WKTParser::parseRings(int numDims,std::vector<Point3dVector> &rings)
+{
+    if (!expect('('))
+        return false;
+    while (true)
+    {
+        rings.resize(rings.size()+1);
+        if (!parseCoords(numDims,rings.back(),false))
+            return false;
+        if (!peek(','))
+            break;
+        pos++;
+    }
+
+    return expect(')');
+}
+
+bool WKTParser::parseGeometry(WKBGeometry &geom,int depth)
+{
+    if (depth > MaxWKTDepth)
+        return fail("Too deeply nested");
+
+    // Track three number coordinates for just this geometry
+    bool outerSawZ = sawZ;
+    sawZ = false;
+
+    std::string word;
+    if (!readWord(word))
+        return fail("Expected a geometry type");
+    if (depth == 0 && word == "SRID")
+    {
+        if (!expect('='))
+            return false;
+        char *end = NULL;
+        std::string num;
+        skipSpace();
+        while (pos < len && (isdigit((unsigned char)str[pos]) || str[pos] == '-'))
+            num += str[pos++];
+        srid = (int)strtol(num.c_str(),&end,10);
+        if (num.empty() || !expect(';') || !readWord(word))
+            return fail("Bad SRID");
+    }
+
+    // Dimensions can be stuck on the end of the type name
+    int numDims = WKTDimsUnknown;
+    WKBGeometryType type;
+    if (!WKTTypeForName(word,type))
+    {
+        if (word.size() > 2 && word.compare(word.size()-2,2,"ZM") == 0 && WKTTypeForName(word.substr(0,word.size()-2),type))
+            numDims = WKTDimsZM;
+        else if (word.size() > 1 && word.back() == 'Z' && WKTTypeForName(word.substr(0,word.size()-1),type))
+            numDims = WKTDimsZ;
+        else if (word.size() > 1 && word.back() == 'M' && WKTTypeForName(word.substr(0,word.size()-1),type))
+            numDims = WKTDimsM;
+        else
+            return fail("Unknown geometry type " + word);
+    }
+    geom.type = type;
+
+    // Then there's a dimension tag or EMPTY
+    size_t beforeWord = pos;
+    if (readWord(word))
+    {
+        if (word == "Z")
+            numDims = WKTDimsZ;
+        else if (word == "M")
+            numDims = WKTDimsM;
+        else if (word == "ZM")
+            numDims = WKTDimsZM;
+        else if (word != "EMPTY")
+            return fail("Unexpected " + word);
+        if (word != "EMPTY")
+        {
+            beforeWord = pos;
+            if (!readWord(word))
+                pos = beforeWord;
+            else if (word != "EMPTY")
+                return fail("Unexpected " + word);
+        }
+        geom.hasZ = numDims == WKTDimsZ || numDims == WKTDimsZM;
+        if (word == "EMPTY")
+        {
+            sawZ = outerSawZ;
+            return true;
+        }
+    } else
+        pos = beforeWord;
+    geom.hasZ = numDims == WKTDimsZ || numDims == WKTDimsZM;
+
+    switch (type)
+    {
+        case WKBPoint:
+            geom.rings.resize(1);
+            if (!parseCoords(numDims,geom.rings[0],false))
+                return false;
+            break;
+        case WKBLineString:
+            geom.rings.resize(1);
+            if (!parseCoords(numDims,geom.rings[0],false))
+                return false;
+            break;
+        case WKBPolygon:
+        case WKBTriangle:
+            if (!parseRings(numDims,geom.rings))
+                return false;
+            break;
+        case WKBMultiPoint:
+        {
+            Point3dVector pts;
+            if (!parseCoords(numDims,pts,true))
+                return false;
+            for (const auto &pt : pts)
+            {
+                WKBGeometry part;
+                part.rings.push_back(Point3dVector(1,pt));
+                geom.parts.push_back(part);
+            }
+        }
+            break;
+        case WKBGeometryCollection:
+            if (!expect('('))
+                return false;
+            while (true)
+            {
+                geom.parts.resize(geom.parts.size()+1);
+                if (!parseGeometry(geom.parts.back(),depth+1))
+                    return false;
+                geom.hasZ |= geom.parts.back().hasZ;
+                if (!peek(','))
+                    break;
+                pos++;
+            }
+            if (!expect(')'))
+                return false;
+            break;
+        default:
+        {
+            // Lists of lines, polygons or triangles
+            WKBGeometryType partType = type == WKBMultiLineString ? WKBLineString : (type == WKBTIN ? WKBTriangle : WKBPolygon);
+            if (!expect('('))
+                return false;
+            while (true)
+            {
+                WKBGeometry part;
+                part.type = partType;
+                size_t beforeEmpty = pos;
+                if (readWord(word))
+                {
+                    if (word != "EMPTY")
+                        return fail("Unexpected " + word);
+                } else {
+                    pos = beforeEmpty;
+                    if (partType == WKBLineString)
+                    {
+                        part.rings.resize(1);
+                        if (!parseCoords(numDims,part.rings[0],false))
+                            return false;
+                    } else if (!parseRings(numDims,part.rings))
+                        return false;
+                }
+                geom.parts.push_back(part);
+                if (!peek(','))
+                    break;
+                pos++;
+            }
+            if (!expect(')'))
+                return false;
+        }
+            break;
+    }
+
+    // Work out Z from the coordinates, if it wasn't given
+    if (numDims == WKTDimsUnknown && type != WKBGeometryCollection)
+        geom.hasZ = sawZ;
+    sawZ |= outerSawZ;
+    for (auto &part : geom.parts)
+        if (type != WKBGeometryCollection)
+            part.hasZ = geom.hasZ;
+
+    return true;
+}
+
+size_t WKTParser::parse(const char *inStr,size_t inLen,WKBGeometry &geom)
+{
+    str = inStr;
+    len = inLen;
+    pos = 0;
+    sawZ = false;
+    error.clear();
+
+    if (!parseGeometry(geom,0))
+        return 0;
+
+    return pos;
+}
+
+size_t WKTParser::parse(const char *inStr,size_t inLen,ShapeSet &shapes)
+{
+    WKBGeometry geom;
+    size_t used = parse(inStr,inLen,geom);
+    if (used == 0)
+        return 0;
+    geom.toShapes(converter,keepZ,std::string(),shapes);
+
+    return used;
+}
+
+bool WKTParser::parseAll(const std::string &allStr,ShapeSet &shapes)
+{
+    size_t where = 0;
+    while (where < allStr.size())
+    {
+        // Skip separators
+        while (where < allStr.size() && (isspace((unsigned char)allStr[where]) || allStr[where] == ';'))
+            where++;
+        if (where >= allStr.size())
+            break;
+        size_t used = parse(allStr.c_str() + where,allStr.size() - where,shapes);
+        if (used == 0)
+            return false;
+        where += used;
+    }
+
+    return true;
+}
+
+WKTWriter::WKTWriter()
+    : converter(GeometryRadiansToDegrees), precision(-1), srid(0)
+{
+}
+
+bool WKTWriter::write(const ShapeSet &shapes,std::string &out)
+{
+    WKBGeometry geom;
+    if (!WKBGeometry::FromShapes(shapes,converter,std::string(),geom))
+        return false;
+    write(geom,out);
+
+    return true;
+}
+
+bool WKTWriter::write(VectorShapeRef shape,std::string &out)
+{
+    WKBGeometry geom;
+    if (!shape || !WKBGeometry::FromShape(shape.get(),converter,geom))
+        return false;
+    write(geom,out);
+
+    return true;
+}
+
+void WKTWriter::write(const WKBGeometry &geom,std::string &out)
+{
+    if (srid != 0)
+        out += "SRID=" + std::to_string(srid) + ";";
+    writeGeometry(geom,geom.hasZ,true,out);
+}
+
+void WKTWriter::writeNumber(double val,std::string &out)
+{
+    char num[64];
+    if (precision < 0)
+        snprintf(num,sizeof(num),"%.15g",val);
+    else {
+        snprintf(num,sizeof(num),"%.*f",precision,val);
+        // Trim the trailing zeros
+        if (strchr(num,'.'))
+        {
+            char *end = num + strlen(num) - 1;
+            while (*end == '0')
+                *end-- = 0;
+            if (*end == '.')
+                *end = 0;
+        }
+        if (!strcmp(num,"-0"))
+            strcpy(num,"0");
+    }
+    out += num;
+}
+
+void WKTWriter::writeCoords(const Point3dVector &pts,bool hasZ,std::string &out)
+{
+    out += '(';
+    for (unsigned int ii=0;ii<pts.size();ii++)
+    {
+        if (ii > 0)
+            out += ',';
+        writeNumber(pts[ii].x(),out);
+        out += ' ';
+        writeNumber(pts[ii].y(),out);
+        if (hasZ)
+        {
+            out += ' ';
+            writeNumber(pts[ii].z(),out);
+        }
+    }
+    out += ')';
+}
+
+void WKTWriter::writeGeometry(const WKBGeometry &geom,bool hasZ,bool withType,std::string &out)
+{
+    if (withType)
+    {
+        out += WKTNameForType(geom.type);
+        if (hasZ)
+            out += " Z";
+        if (geom.empty())
+        {
+            out += " EMPTY";
+            return;
+        }
+        out += ' ';
+    } else if (geom.empty())
+    {
+        out += "EMPTY";
+        return;
+    }
+
+    switch (geom.type)
+    {
+        case WKBPoint:
+        case WKBLineString:
+            writeCoords(geom.rings[0],hasZ,out);
+            break;
+        case WKBPolygon:
+        case WKBTriangle:
+            out += '(';
+            for (unsigned int ii=0;ii<geom.rings.size();ii++)
+            {
+                if (ii > 0)
+                    out += ',';
+                writeCoords(geom.rings[ii],hasZ,out);
+            }
+            out += ')';
+            break;
+        default:
+            out += '(';
+            for (unsigned int ii=0;ii<geom.parts.size();ii++)
+            {
+                if (ii > 0)
+                    out += ',';
+                // Only collections name their members
+                writeGeometry(geom.parts[ii],hasZ,geom.type == WKBGeometryCollection,out);
+            }
+            out += ')';
+            break;
+    }
+}
+
+}
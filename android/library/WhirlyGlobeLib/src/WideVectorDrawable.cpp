@@ -29,7 +29,7 @@ namespace WhirlyKit
 {
     
 WideVectorDrawable::WideVectorDrawable(const std::string &inName,unsigned int numVert,unsigned int numTri,bool globeMode)
- : BasicDrawable(), texRepeat(1.0), edgeSize(1.0), realWidthSet(false), globeMode(globeMode)
+ : BasicDrawable(), texRepeat(1.0), edgeSize(1.0), offset(0.0), realWidthSet(false), globeMode(globeMode)
 {
     name = inName;
     basicDrawableInit();
@@ -43,6 +43,7 @@ WideVectorDrawable::WideVectorDrawable(const std::string &inName,unsigned int nu
     tex_index = addAttribute(BDFloat4Type, "a_texinfo",numVert);
     n0_index = addAttribute(BDFloat3Type, "a_n0",numVert);
     c0_index = addAttribute(BDFloatType, "a_c0",numVert);
+    offset_index = addAttribute(BDFloat3Type, "a_offset",numVert);
 }
  
 // Not.  Do not want standard attributes.
@@ -105,6 +106,11 @@ void WideVectorDrawable::add_c0(float val)
 #endif
 }
 
+void WideVectorDrawable::add_offset(const Point3f &vec)
+{
+    addAttributeValue(offset_index, vec);
+}
+
 void WideVectorDrawable::draw(RendererFrameInfo *frameInfo, Scene *scene)
 {
     if (frameInfo->program)
@@ -118,14 +124,20 @@ void WideVectorDrawable::draw(RendererFrameInfo *frameInfo, Scene *scene)
             frameInfo->program->setUniform("u_w2", (float)lineWidth);
             frameInfo->program->setUniform("u_real_w2", (float)realWidth);
             frameInfo->program->setUniform("u_edge", edgeSize);
+            frameInfo->program->setUniform("u_real_offset", offset);
         } else {
             frameInfo->program->setUniform("u_w2", lineWidth);
             frameInfo->program->setUniform("u_real_w2", pixDispSize * lineWidth);
             frameInfo->program->setUniform("u_edge", edgeSize);
+            frameInfo->program->setUniform("u_real_offset", pixDispSize * offset);
         }
         float texScale = scale/(screenSize*texRepeat);
         frameInfo->program->setUniform("u_texScale", texScale);
-        frameInfo->program->setUniform("u_color", Vector4f(color.r/255.0,color.g/255.0,color.b/255.0,color.a/255.0));
+        // The shaders don't use the tint, so keyframe animation goes into the color
+        Vector4f colorVec(color.r/255.0,color.g/255.0,color.b/255.0,color.a/255.0);
+        if (frameInfo->animState)
+            colorVec = colorVec.cwiseProduct(frameInfo->animState->color) * frameInfo->animState->alpha;
+        frameInfo->program->setUniform("u_color", colorVec);
         
         // Note: This calculation is out of date with respect to the shader
         // Redo the calculation for debugging
@@ -179,6 +191,7 @@ static const char *vertexShaderTri =
 "uniform float u_fade;\n"
 "uniform float u_w2;\n"
 "uniform float u_real_w2;\n"
+"uniform float u_real_offset;\n"
 "uniform float u_texScale;\n"
 "uniform vec4 u_color;\n"
 "\n"
@@ -189,6 +202,7 @@ static const char *vertexShaderTri =
 "attribute vec3 a_p1;\n"
 "attribute vec3 a_n0;\n"
 "attribute float a_c0;\n"
+"attribute vec3 a_offset;\n"
 "\n"
 "varying vec2 v_texCoord;\n"
 //"varying vec4 v_color;\n"
@@ -199,7 +213,7 @@ static const char *vertexShaderTri =
 //  Position along the line
 "   float t0 = a_c0 * u_real_w2;\n"
 "   t0 = clamp(t0,0.0,1.0);\n"
-"   vec3 realPos = (a_p1 - a_position) * t0 + a_n0 * u_real_w2 + a_position;\n"
+"   vec3 realPos = (a_p1 - a_position) * t0 + a_n0 * u_real_w2 + a_offset * u_real_offset + a_position;\n"
 "   float texPos = ((a_texinfo.z - a_texinfo.y) * t0 + a_texinfo.y + a_texinfo.w * u_real_w2) * u_texScale;\n"
 "   v_texCoord = vec2(a_texinfo.x, texPos);\n"
 "   vec4 screenPos = u_mvpMatrix * vec4(realPos,1.0);\n"
@@ -215,6 +229,7 @@ static const char *vertexGlobeShaderTri =
 "uniform float u_fade;\n"
 "uniform float u_w2;\n"
 "uniform float u_real_w2;\n"
+"uniform float u_real_offset;\n"
 "uniform float u_texScale;\n"
 "uniform vec4 u_color;\n"
 "\n"
@@ -225,6 +240,7 @@ static const char *vertexGlobeShaderTri =
 "attribute vec3 a_p1;\n"
 "attribute vec3 a_n0;\n"
 "attribute float a_c0;\n"
+"attribute vec3 a_offset;\n"
 "\n"
 "varying vec2 v_texCoord;\n"
 //"varying vec4 v_color;\n"
@@ -236,7 +252,7 @@ static const char *vertexGlobeShaderTri =
 //  Position along the line
 "   float t0 = a_c0 * u_real_w2;\n"
 "   t0 = clamp(t0,0.0,1.0);\n"
-"   vec3 realPos = (a_p1 - a_position) * t0 + a_n0 * u_real_w2 + a_position;\n"
+"   vec3 realPos = (a_p1 - a_position) * t0 + a_n0 * u_real_w2 + a_offset * u_real_offset + a_position;\n"
 "   vec4 pt = u_mvMatrix * vec4(a_position,1.0);\n"
 "   pt /= pt.w;\n"
 "   vec4 testNorm = u_mvNormalMatrix * vec4(a_normal,0.0);\n"
@@ -343,6 +359,38 @@ WhirlyKit::OpenGLES2Program *BuildWideVectorGlobeProgram()
     return shader;
 }
 
+WideVectorInstance::WideVectorInstance(const std::string &name,SimpleIdentity masterID)
+    : BasicDrawableInstance(name,masterID,ReuseStyle), width(2.0), offset(0.0)
+{
+}
+
+void WideVectorInstance::draw(WhirlyKit::RendererFrameInfo *frameInfo,Scene *scene)
+{
+    WideVectorDrawable *wideDraw = dynamic_cast<WideVectorDrawable *>(basicDraw.get());
+    if (!wideDraw)
+    {
+        BasicDrawableInstance::draw(frameInfo,scene);
+        return;
+    }
     
+    // The master draws with our width and offset, then goes back to its own
+    float oldLineWidth = wideDraw->getLineWidth();
+    float oldOffset = wideDraw->getOffset();
+    double oldRealWidth;
+    bool realWidth = wideDraw->getRealWorldWidth(oldRealWidth);
+    if (realWidth)
+        wideDraw->setRealWorldWidth(width);
+    else
+        wideDraw->setLineWidth(width);
+    wideDraw->setOffset(offset);
     
+    BasicDrawableInstance::draw(frameInfo,scene);
+    
+    if (realWidth)
+        wideDraw->setRealWorldWidth(oldRealWidth);
+    else
+        wideDraw->setLineWidth(oldLineWidth);
+    wideDraw->setOffset(oldOffset);
+}
+
 }
@@ -22,21 +22,40 @@
 #import "FlatMath.h"
 #import "SharedAttributes.h"
 #import "WhirlyKitLog.h"
+#import "ElevationManager.h"
+#import "DefaultShaderPrograms.h"
+#import "SceneRendererES.h"
 
 using namespace WhirlyKit;
 using namespace Eigen;
 
 namespace WhirlyKit
 {
+WideVectorStroke::WideVectorStroke()
+    : width(2.0), offset(0.0), color(255,255,255,255), drawPriority(0)
+{
+}
+
+WideVectorStroke::WideVectorStroke(float width,const RGBAColor &color,int drawPriority)
+    : width(width), offset(0.0), color(color), drawPriority(drawPriority)
+{
+}
+
+WideVectorDecoration::WideVectorDecoration()
+    : placement(WideVecDecorationRepeat), texID(EmptyIdentity), size(16.0,16.0), color(255,255,255,255),
+    spacing(0.0), startGap(-1.0), drawPriority(-1)
+{
+}
+
 WideVectorInfo::WideVectorInfo()
     : BaseInfo(), color(255,255,255,255),width(2.0),repeatSize(32),edgeSize(1.0),coordType(WideVecCoordScreen),joinType(WideVecMiterJoin),
-    capType(WideVecButtCap),texID(EmptyIdentity),miterLimit(2.0)
+    capType(WideVecButtCap),texID(EmptyIdentity),miterLimit(2.0),clampToGround(false),offset(0.0)
 {
 }
 
 WideVectorInfo::WideVectorInfo(const Dictionary &dict) :
 BaseInfo(dict),color(255,255,255,255),width(2.0),repeatSize(32),edgeSize(1.0),coordType(WideVecCoordScreen),joinType(WideVecMiterJoin),
-capType(WideVecButtCap),texID(EmptyIdentity),miterLimit(2.0)
+capType(WideVecButtCap),texID(EmptyIdentity),miterLimit(2.0),clampToGround(false),offset(0.0)
 {
     color = dict.getColor(MaplyColor,RGBAColor(255,255,255,255));
     width = dict.getDouble(MaplyVecWidth,2.0);
@@ -54,8 +73,13 @@ capType(WideVecButtCap),texID(EmptyIdentity),miterLimit(2.0)
     repeatSize = dict.getDouble(MaplyWideVecTexRepeatLen,32);
     edgeSize = dict.getDouble(MaplyWideVecEdgeFalloff,1.0);
     miterLimit = dict.getDouble(MaplyWideVecMiterLimit,2.0);
+    clampToGround = dict.getBool(MaplyVecClampToGround,false);
+    offset = dict.getDouble(MaplyWideVecOffset,0.0);
 }
 
+// Longest we'll let the offset get at a sharp turn, as a multiple of the offset
+static const double MaxOffsetMiter = 4.0;
+
 // Turn this on for smaller texture lengths
 //#define TEXTURE_RESET 1
 
@@ -74,7 +98,7 @@ public:
     class InterPoint
     {
     public:
-        InterPoint() : texX(0.0),texYmin(0.0),texYmax(0.0),texOffset(0.0) { }
+        InterPoint() : texX(0.0),texYmin(0.0),texYmax(0.0),texOffset(0.0),off(0,0,0) { }
         // Construct with a single line
         InterPoint(const Point3d &p0,const Point3d &p1,const Point3d &n0,double inTexX,double inTexYmin,double inTexYmax,double inTexOffset)
         {
@@ -87,6 +111,7 @@ public:
             texYmin = inTexYmin;
             texYmax = inTexYmax;
             texOffset = inTexOffset;
+            off = Point3d(0,0,0);
         }
         
         // Return a version of the point flipped around its main axis
@@ -114,6 +139,8 @@ public:
         Point3d org,dest;
         double texX;
         double texYmin,texYmax,texOffset;
+        // Where the center line moves at org for a unit offset
+        Point3d off;
     };
     
     // Intersect the wide lines, but return an equation to calculate the point
@@ -171,6 +198,7 @@ public:
             drawable->add_n0(Vector3dToVector3f(vert.n));
             drawable->add_c0(vert.c);
             drawable->add_texInfo(vert.texX,vert.texYmin,vert.texYmax,vert.texOffset);
+            drawable->add_offset(Vector3dToVector3f(vert.off));
         }
 
         drawable->addTriangle(BasicDrawable::Triangle(startPt+0,startPt+1,startPt+3));
@@ -191,6 +219,7 @@ public:
             drawable->add_n0(Vector3dToVector3f(vert.n));
             drawable->add_c0(vert.c);
             drawable->add_texInfo(vert.texX,vert.texYmin,vert.texYmax,vert.texOffset);
+            drawable->add_offset(Vector3dToVector3f(vert.off));
         }
         
         drawable->addTriangle(BasicDrawable::Triangle(startPt+0,startPt+1,startPt+2));
@@ -230,6 +259,19 @@ public:
         
         Point3d paLocal = *pa-dispCenter;
         Point3d pbLocal = *pb-dispCenter;
+        
+        // Offset lines are parallel to the segments, so they cross on the miter at pb
+        Point3d offB = norm0;
+        if (pc)
+        {
+            double denom = 1.0 + norm0.dot(norm1);
+            if (denom > 1e-8)
+            {
+                offB = (norm0 + norm1) / denom;
+                if (offB.norm() > MaxOffsetMiter)
+                    offB = offB.normalized() * MaxOffsetMiter;
+            }
+        }
 
         // Lengths we use to calculate texture coordinates
         double texBase = texOffset;
@@ -247,6 +289,8 @@ public:
         {
             e0 = InterPoint(paLocal,pbLocal,revNorm0,1.0,texBase,texNext,0.0);
             e1 = InterPoint(paLocal,pbLocal,norm0,0.0,texBase,texNext,0.0);
+            e0.off = norm0;
+            e1.off = norm0;
             edgePointsValid = true;
         }
 
@@ -273,6 +317,7 @@ public:
                 {
                     iPtsValid = true;
                     angleBetween = acos(dot);
+                    rPt0.off = rPt1.off = lPt0.off = lPt1.off = offB;
                 }
         }
         
@@ -293,6 +338,7 @@ public:
         InterPoint endPt1;
         if (pc)
             endPt1 = InterPoint(pbLocal,pcLocal,norm1,0.0,texNext,texNext2,0.0);
+        endPt0.off = endPt1.off = offB;
 
         // Set up the segment points
         if (iPtsValid)
@@ -495,6 +541,14 @@ public:
     {
         coordAdapter = scene->getCoordAdapter();
         coordSys = coordAdapter->getCoordSystem();
+        
+        // The drawables we build are the first stroke and the rest are instances of them
+        if (vecInfo->strokes.empty())
+        {
+            baseStroke = WideVectorStroke(vecInfo->width,vecInfo->color,vecInfo->drawPriority);
+            baseStroke.offset = vecInfo->offset;
+        } else
+            baseStroke = vecInfo->strokes[0];
     }
     
     // Center to use for drawables we create
@@ -505,6 +559,12 @@ public:
         dispCenter = newDispCenter;
     }
     
+    // Elevation to drape the lines over
+    void setElevation(ElevationSamplerRef sampler)
+    {
+        elevSampler = sampler;
+    }
+    
     // Build or return a suitable drawable (depending on the mode)
     BasicDrawable *getDrawable(int ptCount,int triCount,int ptCountAllocate,int triCountAllocate)
     {
@@ -525,14 +585,16 @@ public:
             drawable->setProgram(vecInfo->programID);
             wideDrawable->setTexRepeat(vecInfo->repeatSize);
             wideDrawable->setEdgeSize(vecInfo->edgeSize);
-            wideDrawable->setLineWidth(vecInfo->width);
+            wideDrawable->setLineWidth(baseStroke.width);
             if (vecInfo->coordType == WideVecCoordReal)
-                wideDrawable->setRealWorldWidth(vecInfo->width);
+                wideDrawable->setRealWorldWidth(baseStroke.width);
+            wideDrawable->setOffset(baseStroke.offset);
             
 //            drawMbr.reset();
             drawable->setType(GL_TRIANGLES);
             vecInfo->setupBasicDrawable(drawable);
-            drawable->setColor(vecInfo->color);
+            drawable->setColor(baseStroke.color);
+            drawable->setDrawPriority(baseStroke.drawPriority);
             if (vecInfo->texID != EmptyIdentity)
                 drawable->setTexId(0, vecInfo->texID);
             if (centerValid)
@@ -546,9 +608,16 @@ public:
         return drawable;
     }
     
-    // Add the points for a linear
-    void addLinear(const VectorRing &pts,const Point3d &up,bool closed)
+    // Add the points for a linear.  Optionally hand back the display points for decorations.
+    void addLinear(const VectorRing &inPts,const Point3d &up,bool closed,Point3dVector *outDispPts=NULL)
     {
+        // Break the edges up where they cross the terrain grid.
+        // Closed loops already repeat their first point.
+        VectorRing clampPts;
+        if (elevSampler)
+            elevSampler->subdivideEdges(inPts,clampPts,false);
+        const VectorRing &pts = elevSampler ? clampPts : inPts;
+        
         // We'll add one on the beginning and two on the end
         //  if we're doing a closed loop.  This gets us
         //  valid junctions that match up.
@@ -591,10 +660,12 @@ public:
                 continue;
 
             Point3d localPa = coordSys->geographicToLocal3d(GeoCoord(geoA.x(),geoA.y()));
-            Point3d dispPa = coordAdapter->localToDisplay(localPa);
             Point3d thisUp = up;
             if (!coordAdapter->isFlat())
                 thisUp = coordAdapter->normalForLocal(localPa);
+            if (elevSampler)
+                localPa = elevSampler->localPointFor(Point2d(geoA.x(),geoA.y()));
+            Point3d dispPa = coordAdapter->localToDisplay(localPa);
             
             // Get a drawable ready
             int triCount = 2+3;
@@ -603,6 +674,8 @@ public:
             totalTriCount -= triCount;
             totalPtCount -= ptCount;
             drawMbr.addPoint(geoA);
+            if (outDispPts && ii >= 0)
+                outDispPts->push_back(dispPa);
             
             bool doSegment = !closed || (ii > 0);
             bool doJunction = !closed || (ii >= 0);
@@ -648,16 +721,11 @@ public:
         vecBuilder.flush(drawable,true,true);
     }
 
-    // Flush out the drawables
-    WideVectorSceneRep *flush(ChangeSet &changes)
+    // Flush out the drawables into the given representation
+    void flush(ChangeSet &changes,WideVectorSceneRep *sceneRep)
     {
         flush();
         
-        if (drawables.empty())
-            return NULL;
-        
-        WideVectorSceneRep *sceneRep = new WideVectorSceneRep();
-        sceneRep->fade = vecInfo->fade;
         for (unsigned int ii=0;ii<drawables.size();ii++)
         {
             Drawable *drawable = drawables[ii];
@@ -665,9 +733,25 @@ public:
             changes.push_back(new AddDrawableReq(drawable));
         }
         
-        drawables.clear();
+        // The other strokes reuse the geometry, so they have to follow it in
+        for (unsigned int si=1;si<vecInfo->strokes.size();si++)
+        {
+            const WideVectorStroke &stroke = vecInfo->strokes[si];
+            for (unsigned int ii=0;ii<drawables.size();ii++)
+            {
+                WideVectorInstance *drawInst = new WideVectorInstance("WideVectorManager",drawables[ii]->getId());
+                drawInst->setEnable(vecInfo->enable);
+                drawInst->setVisibleRange(vecInfo->minVis, vecInfo->maxVis);
+                drawInst->setColor(stroke.color);
+                drawInst->setWidth(stroke.width);
+                drawInst->setOffset(stroke.offset);
+                drawInst->setDrawPriority(stroke.drawPriority);
+                sceneRep->instIDs.insert(drawInst->getId());
+                changes.push_back(new AddDrawableReq(drawInst));
+            }
+        }
         
-        return sceneRep;
+        drawables.clear();
     }
     
 protected:
@@ -689,8 +773,10 @@ protected:
     CoordSystemDisplayAdapter *coordAdapter;
     CoordSystem *coordSys;
     const WideVectorInfo *vecInfo;
+    WideVectorStroke baseStroke;
     BasicDrawable *drawable;
     std::vector<BasicDrawable *> drawables;
+    ElevationSamplerRef elevSampler;
 };
     
 WideVectorSceneRep::WideVectorSceneRep()
@@ -710,6 +796,7 @@ void WideVectorSceneRep::enableContents(bool enable,ChangeSet &changes)
 {
     SimpleIDSet allIDs = drawIDs;
     allIDs.insert(instIDs.begin(),instIDs.end());
+    allIDs.insert(decorIDs.begin(),decorIDs.end());
     for (SimpleIDSet::iterator it = allIDs.begin();
          it != allIDs.end(); ++it)
         changes.push_back(new OnOffChangeRequest(*it,enable));
@@ -719,6 +806,7 @@ void WideVectorSceneRep::clearContents(ChangeSet &changes,TimeInterval when)
 {
     SimpleIDSet allIDs = drawIDs;
     allIDs.insert(instIDs.begin(),instIDs.end());
+    allIDs.insert(decorIDs.begin(),decorIDs.end());
     for (SimpleIDSet::iterator it = allIDs.begin();
          it != allIDs.end(); ++it)
         changes.push_back(new RemDrawableReq(*it,when));
@@ -739,6 +827,38 @@ WideVectorManager::~WideVectorManager()
 }
     
 SimpleIdentity WideVectorManager::addVectors(ShapeSet *shapes,const WideVectorInfo &vecInfo,ChangeSet &changes)
+{
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(vecInfo.memLabel);
+    WideVectorSceneRep *sceneRep = new WideVectorSceneRep();
+    sceneRep->fade = vecInfo.fade;
+    
+    buildVectors(sceneRep,shapes,vecInfo,changes);
+    if (sceneRep->drawIDs.empty())
+    {
+        delete sceneRep;
+        return EmptyIdentity;
+    }
+    
+    // Hang on to what we need to drape these again when better elevation shows up
+    if (vecInfo.clampToGround)
+    {
+        sceneRep->shapes = *shapes;
+        sceneRep->clampInfo = std::shared_ptr<WideVectorInfo>(new WideVectorInfo(vecInfo));
+        sceneRep->clampInfo->fade = 0.0;
+    }
+    
+    SimpleIdentity vecID = sceneRep->getId();
+    pthread_mutex_lock(&vecLock);
+    sceneReps.insert(sceneRep);
+    pthread_mutex_unlock(&vecLock);
+    tagChanges(changes,startChange,memTag);
+    trackSceneRep(sceneRep->getId(),sizeof(*sceneRep),memTag);
+    
+    return vecID;
+}
+    
+void WideVectorManager::buildVectors(WideVectorSceneRep *sceneRep,ShapeSet *shapes,const WideVectorInfo &vecInfo,ChangeSet &changes)
 {
     WideVectorDrawableBuilder builder(scene,&vecInfo);
     
@@ -751,7 +871,7 @@ SimpleIdentity WideVectorManager::addVectors(ShapeSet *shapes,const WideVectorIn
     }
     // No data?
     if (!geoMbr.valid())
-        return EmptyIdentity;
+        return;
     CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
     GeoCoord centerGeo = geoMbr.mid();
     Point3d localCenter = coordAdapter->getCoordSystem()->geographicToLocal3d(centerGeo);
@@ -762,44 +882,161 @@ SimpleIdentity WideVectorManager::addVectors(ShapeSet *shapes,const WideVectorIn
     {
         centerUp = coordAdapter->normalForLocal(localCenter);
     }
+    
+    // Sample whatever elevation is loaded for the area
+    if (vecInfo.clampToGround)
+    {
+        sceneRep->geoMbr = geoMbr;
+        ElevationManager *elevManager = (ElevationManager *)scene->getManager(kWKElevationManager);
+        if (elevManager)
+        {
+            ElevationSamplerRef elevSampler = elevManager->makeSampler(geoMbr);
+            if (!elevSampler->empty())
+                builder.setElevation(elevSampler);
+        }
+    }
+
+    // Decorations are screen space objects placed on the same points
+    ScreenSpaceBuilder ssBuild(coordAdapter,renderer ? renderer->getScale() : 1.0);
+    bool doDecorations = !vecInfo.decorations.empty();
+    Point3dVector dispPts;
 
     for (ShapeSet::iterator it = shapes->begin(); it != shapes->end(); ++it)
     {
         VectorLinearRef lin = std::dynamic_pointer_cast<VectorLinear>(*it);
         if (lin)
         {
-            builder.addLinear(lin->pts,centerUp,false);
+            dispPts.clear();
+            builder.addLinear(lin->pts,centerUp,false,doDecorations ? &dispPts : NULL);
+            if (doDecorations)
+                buildDecorations(ssBuild,dispPts,vecInfo);
         } else {
             VectorArealRef ar = std::dynamic_pointer_cast<VectorAreal>(*it);
             if (ar)
             {
                 for (const auto &loop : ar->loops)
                 {
+                    dispPts.clear();
                     if (loop.size() > 2 && loop.begin() != loop.end())
                     {
                         // Just tack on another point at the end.  Kind of dumb, but easy.
                         VectorRing newLoop = loop;
                         newLoop.push_back(loop[0]);
-                        builder.addLinear(newLoop, centerUp, true);
+                        builder.addLinear(newLoop, centerUp, true, doDecorations ? &dispPts : NULL);
                     } else
-                        builder.addLinear(loop, centerUp, true);
+                        builder.addLinear(loop, centerUp, true, doDecorations ? &dispPts : NULL);
+                    if (doDecorations)
+                        buildDecorations(ssBuild,dispPts,vecInfo);
                 }
             }
         }
     }
 //    builder.addLinearDebug();
     
-    WideVectorSceneRep *sceneRep = builder.flush(changes);
-    SimpleIdentity vecID = EmptyIdentity;
-    if (sceneRep)
+    builder.flush(changes,sceneRep);
+    if (doDecorations)
+        ssBuild.flushChanges(changes,sceneRep->decorIDs);
+    
+    // Keyframe tracks can animate the vectors and their decorations as a whole
+    SimpleIDSet allIDs = sceneRep->drawIDs;
+    allIDs.insert(sceneRep->instIDs.begin(),sceneRep->instIDs.end());
+    allIDs.insert(sceneRep->decorIDs.begin(),sceneRep->decorIDs.end());
+    if (!allIDs.empty())
+        changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),allIDs));
+}
+
+void WideVectorManager::buildDecorations(ScreenSpaceBuilder &ssBuild,const Point3dVector &dispPts,const WideVectorInfo &vecInfo)
+{
+    if (dispPts.size() < 2)
+        return;
+    CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
+    SimpleIdentity progID = scene->getProgramIDBySceneName(kToolkitDefaultScreenSpaceProgram);
+
+    // Distance along the line to the start of each point
+    std::vector<double> dists(dispPts.size(),0.0);
+    for (unsigned int ii=1;ii<dispPts.size();ii++)
+        dists[ii] = dists[ii-1] + (dispPts[ii]-dispPts[ii-1]).norm();
+    double totalLen = dists.back();
+    if (totalLen <= 0.0)
+        return;
+
+    for (const WideVectorDecoration &decor : vecInfo.decorations)
     {
-        vecID = sceneRep->getId();
-        pthread_mutex_lock(&vecLock);
-        sceneReps.insert(sceneRep);
-        pthread_mutex_unlock(&vecLock);
+        // Positions along the line for this one
+        std::vector<double> places;
+        switch (decor.placement)
+        {
+            case WideVecDecorationRepeat:
+                if (decor.spacing > 0.0)
+                    for (double dist = (decor.startGap < 0.0 ? decor.spacing/2.0 : decor.startGap);dist <= totalLen;dist += decor.spacing)
+                        places.push_back(dist);
+                break;
+            case WideVecDecorationStart:
+                places.push_back(0.0);
+                break;
+            case WideVecDecorationEnd:
+                places.push_back(totalLen);
+                break;
+        }
+
+        ScreenSpaceObject::ConvexGeometry geom;
+        if (decor.texID != EmptyIdentity)
+            geom.texIDs.push_back(decor.texID);
+        geom.progID = progID;
+        geom.color = decor.color;
+        geom.drawPriority = decor.drawPriority < 0 ? vecInfo.drawPriority : decor.drawPriority;
+        double width2 = decor.size.x()/2.0, height2 = decor.size.y()/2.0;
+        geom.coords.push_back(Point2d(-width2,-height2));  geom.texCoords.push_back(TexCoord(0.0,1.0));
+        geom.coords.push_back(Point2d(width2,-height2));  geom.texCoords.push_back(TexCoord(1.0,1.0));
+        geom.coords.push_back(Point2d(width2,height2));  geom.texCoords.push_back(TexCoord(1.0,0.0));
+        geom.coords.push_back(Point2d(-width2,height2));  geom.texCoords.push_back(TexCoord(0.0,0.0));
+
+        unsigned int seg = 0;
+        for (double dist : places)
+        {
+            // Find the segment with a non-zero length we're on
+            while (seg < dispPts.size()-2 && (dists[seg+1] < dist || dists[seg+1] == dists[seg]))
+                seg++;
+            const Point3d &pa = dispPts[seg], &pb = dispPts[seg+1];
+            double segLen = dists[seg+1] - dists[seg];
+            if (segLen <= 0.0)
+                continue;
+            Point3d dir = (pb - pa) / segLen;
+            Point3d loc = pa + dir * std::min(std::max(dist - dists[seg],0.0),segLen);
+            
+            // Turn the symbol from north to the line direction, counter-clockwise as the screen space shader wants
+            Point3d upVec,northVec,eastVec;
+            if (coordAdapter->isFlat())
+            {
+                upVec = Point3d(0,0,1);
+                northVec = Point3d(0,1,0);
+                eastVec = Point3d(1,0,0);
+            } else {
+                upVec = loc.normalized();
+                northVec = Point3d(-loc.x(),-loc.y(),1.0-loc.z());
+                eastVec = northVec.cross(upVec);
+                northVec = upVec.cross(eastVec);
+            }
+            double rot = atan2(-dir.dot(eastVec),dir.dot(northVec));
+            
+            ScreenSpaceObject ssObj;
+            // Follow the line if it's been moved sideways
+            if (vecInfo.offset != 0.0)
+            {
+                if (vecInfo.coordType == WideVecCoordReal)
+                    loc += dir.cross(upVec).normalized() * vecInfo.offset;
+                else
+                    ssObj.setOffset(Point2d(vecInfo.offset,0.0));
+            }
+            ssObj.setWorldLoc(loc);
+            ssObj.setRotation(rot);
+            ssObj.setEnable(vecInfo.enable);
+            ssObj.setVisibility(vecInfo.minVis, vecInfo.maxVis);
+            ssObj.setDrawPriority(geom.drawPriority);
+            ssObj.addGeometry(geom);
+            ssBuild.addScreenObject(ssObj);
+        }
     }
-    
-    return vecID;
 }
 
 void WideVectorManager::enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet &changes)
@@ -813,8 +1050,11 @@ void WideVectorManager::enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet
         if (it != sceneReps.end())
         {
             WideVectorSceneRep *vecRep = *it;
+            if (vecRep->clampInfo)
+                vecRep->clampInfo->enable = enable;
             SimpleIDSet allIDs = vecRep->drawIDs;
             allIDs.insert(vecRep->instIDs.begin(),vecRep->instIDs.end());
+            allIDs.insert(vecRep->decorIDs.begin(),vecRep->decorIDs.end());
             for (SimpleIDSet::iterator idIt = allIDs.begin(); idIt != allIDs.end(); ++idIt)
                 changes.push_back(new OnOffChangeRequest(*idIt,enable));
         }
@@ -825,6 +1065,8 @@ void WideVectorManager::enableVectors(SimpleIDSet &vecIDs,bool enable,ChangeSet
     
 SimpleIdentity WideVectorManager::instanceVectors(SimpleIdentity vecID,const WideVectorInfo &vecInfo,ChangeSet &changes)
 {
+    unsigned int startChange = changes.size();
+    int memTag = getMemTag(vecInfo.memLabel);
     SimpleIdentity newId = EmptyIdentity;
     
     pthread_mutex_lock(&vecLock);
@@ -832,7 +1074,9 @@ SimpleIdentity WideVectorManager::instanceVectors(SimpleIdentity vecID,const Wid
     // Look for the representation
     WideVectorSceneRep dummyRep(vecID);
     WideVectorSceneRepSet::iterator it = sceneReps.find(&dummyRep);
-    if (it != sceneReps.end())
+    if (it != sceneReps.end() && (*it)->clampInfo)
+        WHIRLYKIT_LOGW("WideVectorManager: Can't instance vectors clamped to the ground");
+    else if (it != sceneReps.end())
     {
         WideVectorSceneRep *sceneRep = *it;
         WideVectorSceneRep *newSceneRep = new WideVectorSceneRep();
@@ -862,8 +1106,13 @@ SimpleIdentity WideVectorManager::instanceVectors(SimpleIdentity vecID,const Wid
             changes.push_back(new AddDrawableReq(drawInst));
         }
         
+        if (!newSceneRep->instIDs.empty())
+            changes.push_back(new SetAnimFeatureReq(newSceneRep->getId(),newSceneRep->instIDs));
+        
         sceneReps.insert(newSceneRep);
         newId = newSceneRep->getId();
+        tagChanges(changes,startChange,memTag);
+        trackSceneRep(newId,sizeof(*newSceneRep),memTag);
     }
     
     pthread_mutex_unlock(&vecLock);
@@ -889,6 +1138,7 @@ void WideVectorManager::removeVectors(SimpleIDSet &vecIDs,ChangeSet &changes)
             {
                 SimpleIDSet allIDs = sceneRep->drawIDs;
                 allIDs.insert(sceneRep->instIDs.begin(),sceneRep->instIDs.end());
+                allIDs.insert(sceneRep->decorIDs.begin(),sceneRep->decorIDs.end());
                 for (SimpleIDSet::iterator it = allIDs.begin();
                      it != allIDs.end(); ++it)
                     changes.push_back(new FadeChangeRequest(*it, curTime, curTime+sceneRep->fade));
@@ -897,6 +1147,8 @@ void WideVectorManager::removeVectors(SimpleIDSet &vecIDs,ChangeSet &changes)
             }
             
             (*it)->clearContents(changes,removeTime);
+            changes.push_back(new SetAnimFeatureReq(sceneRep->getId(),SimpleIDSet()));
+            untrackSceneRep(sceneRep->getId());
             sceneReps.erase(it);
             delete sceneRep;
         }
@@ -905,4 +1157,37 @@ void WideVectorManager::removeVectors(SimpleIDSet &vecIDs,ChangeSet &changes)
     pthread_mutex_unlock(&vecLock);
 }
 
+void WideVectorManager::elevationChanged(const std::vector<GeoMbr> &mbrs,ChangeSet &changes)
+{
+    pthread_mutex_lock(&vecLock);
+    
+    for (WideVectorSceneRepSet::iterator it = sceneReps.begin(); it != sceneReps.end(); ++it)
+    {
+        WideVectorSceneRep *sceneRep = *it;
+        if (!sceneRep->clampInfo)
+            continue;
+        
+        bool overlaps = false;
+        for (const auto &mbr : mbrs)
+            if (mbr.overlaps(sceneRep->geoMbr))
+            {
+                overlaps = true;
+                break;
+            }
+        if (!overlaps)
+            continue;
+        
+        // Swap in new drawables.  The vector ID stays the same.
+        sceneRep->clearContents(changes,0.0);
+        sceneRep->drawIDs.clear();
+        sceneRep->instIDs.clear();
+        sceneRep->decorIDs.clear();
+        unsigned int startChange = changes.size();
+        buildVectors(sceneRep,&sceneRep->shapes,*sceneRep->clampInfo,changes);
+        tagChanges(changes,startChange,getMemTag(sceneRep->clampInfo->memLabel));
+    }
+    
+    pthread_mutex_unlock(&vecLock);
+}
+
 }
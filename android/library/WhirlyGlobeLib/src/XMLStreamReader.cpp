@@ -0,0 +1,381 @@
+/*
+ *  XMLStreamReader.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/18/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <string.h>
+#import <stdlib.h>
+#import <ctype.h>
+#import "XMLStreamReader.h"
+
+namespace WhirlyKit
+{
+
+// Size of the pieces we read from files
+static const size_t XMLReadChunk = 64*1024;
+
+XMLStreamReader::XMLStreamReader(XMLStreamHandler *handler)
+    : handler(handler), stripNamespaces(true), stopped(false), pos(0), sawRoot(false)
+{
+}
+
+std::string XMLStreamReader::localName(const std::string &name) const
+{
+    if (!stripNamespaces)
+        return name;
+    size_t colon = name.find(':');
+    return colon == std::string::npos ? name : name.substr(colon+1);
+}
+
+void XMLStreamReader::AppendDecoded(const char *str,size_t len,std::string &out)
+{
+    for (size_t ii=0;ii<len;ii++)
+    {
+        if (str[ii] != '&')
+        {
+            out += str[ii];
+            continue;
+        }
+        const char *semi = (const char *)memchr(str+ii,';',len-ii);
+        if (!semi)
+        {
+            out += str[ii];
+            continue;
+        }
+        std::string ent(str+ii+1,semi-(str+ii+1));
+        if (ent == "lt")
+            out += '<';
+        else if (ent == "gt")
+            out += '>';
+        else if (ent == "amp")
+            out += '&';
+        else if (ent == "quot")
+            out += '"';
+        else if (ent == "apos")
+            out += '\'';
+        else if (ent.size() > 1 && ent[0] == '#')
+        {
+            unsigned long code = (ent[1] == 'x' || ent[1] == 'X') ? strtoul(ent.c_str()+2,NULL,16) : strtoul(ent.c_str()+1,NULL,10);
+            // UTF-8
+            if (code < 0x80)
+                out += (char)code;
+            else if (code < 0x800)
+            {
+                out += (char)(0xC0 | (code >> 6));
+                out += (char)(0x80 | (code & 0x3F));
+            } else if (code < 0x10000)
+            {
+                out += (char)(0xE0 | (code >> 12));
+                out += (char)(0x80 | ((code >> 6) & 0x3F));
+                out += (char)(0x80 | (code & 0x3F));
+            } else {
+                out += (char)(0xF0 | (code >> 18));
+                out += (char)(0x80 | ((code >> 12) & 0x3F));
+                out += (char)(0x80 | ((code >> 6) & 0x3F));
+                out += (char)(0x80 | (code & 0x3F));
+            }
+        } else
+            out.append(str+ii,semi-(str+ii)+1);
+        ii = semi - str;
+    }
+}
+
+bool XMLStreamReader::feed(const char *data,size_t len)
+{
+    if (!error.empty())
+        return false;
+    if (stopped)
+        return true;
+
+    buf.append(data,len);
+    bool ret = process(false);
+
+    // Toss what we've used once it builds up
+    if (pos > XMLReadChunk)
+    {
+        buf.erase(0,pos);
+        pos = 0;
+    }
+
+    return ret;
+}
+
+bool XMLStreamReader::finish()
+{
+    if (!error.empty())
+        return false;
+    if (stopped)
+        return true;
+    if (!process(true))
+        return false;
+
+    if (!openElements.empty())
+    {
+        error = "Missing end tag for <" + openElements.back() + ">";
+        return false;
+    }
+    if (!sawRoot)
+    {
+        error = "No root element";
+        return false;
+    }
+
+    return true;
+}
+
+bool XMLStreamReader::parseFile(FILE *fp)
+{
+    std::vector<char> chunk(XMLReadChunk);
+    size_t numRead;
+    while (!stopped && (numRead = fread(&chunk[0],1,chunk.size(),fp)) > 0)
+        if (!feed(&chunk[0],numRead))
+            return false;
+
+    return finish();
+}
+
+bool XMLStreamReader::parse(const std::string &xml)
+{
+    return feed(xml.c_str(),xml.size()) && finish();
+}
+
+bool XMLStreamReader::processTag(size_t end)
+{
+    const char *tag = buf.c_str() + pos + 1;
+    size_t tagLen = end - pos - 1;
+
+    // End tag
+    if (tag[0] == '/')
+    {
+        size_t nameEnd = 1;
+        while (nameEnd < tagLen && !isspace((unsigned char)tag[nameEnd]))
+            nameEnd++;
+        std::string name(tag+1,nameEnd-1);
+        if (openElements.empty() || openElements.back() != name)
+        {
+            error = "Mismatched end tag </" + name + ">";
+            return false;
+        }
+        openElements.pop_back();
+        handler->endElement(localName(name));
+        return true;
+    }
+
+    bool selfClosing = tagLen > 0 && tag[tagLen-1] == '/';
+    if (selfClosing)
+        tagLen--;
+
+    size_t ii = 0;
+    while (ii < tagLen && !isspace((unsigned char)tag[ii]))
+        ii++;
+    std::string name(tag,ii);
+    if (name.empty())
+    {
+        error = "Missing element name";
+        return false;
+    }
+    if (openElements.empty() && sawRoot)
+    {
+        error = "More than one root element";
+        return false;
+    }
+
+    XMLAttributes attrs;
+    while (ii < tagLen)
+    {
+        while (ii < tagLen && isspace((unsigned char)tag[ii]))
+            ii++;
+        if (ii >= tagLen)
+            break;
+        size_t nameStart = ii;
+        while (ii < tagLen && tag[ii] != '=' && !isspace((unsigned char)tag[ii]))
+            ii++;
+        std::string attrName(tag+nameStart,ii-nameStart);
+        while (ii < tagLen && isspace((unsigned char)tag[ii]))
+            ii++;
+        if (ii >= tagLen || tag[ii] != '=')
+        {
+            error = "Bad attribute in <" + name + ">";
+            return false;
+        }
+        ii++;
+        while (ii < tagLen && isspace((unsigned char)tag[ii]))
+            ii++;
+        if (ii >= tagLen || (tag[ii] != '"' && tag[ii] != '\''))
+        {
+            error = "Unquoted attribute in <" + name + ">";
+            return false;
+        }
+        char quote = tag[ii++];
+        const char *valEnd = (const char *)memchr(tag+ii,quote,tagLen-ii);
+        if (!valEnd)
+        {
+            error = "Unterminated attribute in <" + name + ">";
+            return false;
+        }
+        std::string val;
+        AppendDecoded(tag+ii,valEnd-(tag+ii),val);
+        attrs[localName(attrName)] = val;
+        ii = valEnd - tag + 1;
+    }
+
+    sawRoot = true;
+    std::string local = localName(name);
+    handler->startElement(local,attrs);
+    if (selfClosing)
+        handler->endElement(local);
+    else
+        openElements.push_back(name);
+
+    return true;
+}
+
+bool XMLStreamReader::process(bool final)
+{
+    while (pos < buf.size() && !stopped)
+    {
+        if (buf[pos] != '<')
+        {
+            size_t lt = buf.find('<',pos);
+            size_t end = lt;
+            if (lt == std::string::npos)
+            {
+                end = buf.size();
+                // Don't split an entity across pieces
+                if (!final)
+                {
+                    size_t amp = buf.rfind('&');
+                    if (amp != std::string::npos && amp >= pos && buf.find(';',amp) == std::string::npos)
+                        end = amp;
+                }
+            }
+            if (end > pos)
+            {
+                if (openElements.empty())
+                {
+                    // Only whitespace is allowed outside the root
+                    for (size_t ii=pos;ii<end;ii++)
+                        if (!isspace((unsigned char)buf[ii]))
+                        {
+                            error = "Text outside of the root element";
+                            return false;
+                        }
+                } else {
+                    std::string text;
+                    AppendDecoded(buf.c_str()+pos,end-pos,text);
+                    handler->characters(text);
+                }
+                pos = end;
+            }
+            if (lt == std::string::npos)
+                break;
+            continue;
+        }
+
+        // Need enough to tell what kind of markup this is
+        if (!final && buf.size() - pos < 9)
+            break;
+
+        const char *start = buf.c_str() + pos;
+        size_t end = std::string::npos;
+        if (!strncmp(start,"<!--",4))
+        {
+            end = buf.find("-->",pos+4);
+            if (end != std::string::npos)
+            {
+                pos = end + 3;
+                continue;
+            }
+        } else if (!strncmp(start,"<![CDATA[",9))
+        {
+            end = buf.find("]]>",pos+9);
+            if (end != std::string::npos)
+            {
+                handler->characters(buf.substr(pos+9,end-pos-9));
+                pos = end + 3;
+                continue;
+            }
+        } else if (!strncmp(start,"<?",2))
+        {
+            end = buf.find("?>",pos+2);
+            if (end != std::string::npos)
+            {
+                pos = end + 2;
+                continue;
+            }
+        } else if (!strncmp(start,"<!",2))
+        {
+            // Doctype, possibly with an internal subset in brackets
+            int depth = 0;
+            for (size_t ii=pos+2;ii<buf.size();ii++)
+            {
+                if (buf[ii] == '[')
+                    depth++;
+                else if (buf[ii] == ']')
+                    depth--;
+                else if (buf[ii] == '>' && depth <= 0)
+                {
+                    end = ii;
+                    break;
+                }
+            }
+            if (end != std::string::npos)
+            {
+                pos = end + 1;
+                continue;
+            }
+        } else {
+            // A tag.  Watch for > inside attribute values.
+            char quote = 0;
+            for (size_t ii=pos+1;ii<buf.size();ii++)
+            {
+                char c = buf[ii];
+                if (quote)
+                {
+                    if (c == quote)
+                        quote = 0;
+                } else if (c == '"' || c == '\'')
+                    quote = c;
+                else if (c == '>')
+                {
+                    end = ii;
+                    break;
+                }
+            }
+            if (end != std::string::npos)
+            {
+                if (!processTag(end))
+                    return false;
+                pos = end + 1;
+                continue;
+            }
+        }
+
+        // Didn't find the end of it
+        if (final)
+        {
+            error = "Unexpected end of document";
+            return false;
+        }
+        break;
+    }
+
+    return true;
+}
+
+}
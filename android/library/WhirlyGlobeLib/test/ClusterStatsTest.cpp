@@ -0,0 +1,99 @@
+/*
+ *  ClusterStatsTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import "WhirlyGlobe.h"
+#import "ClusterStats.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+static Dictionary MakeAttrs(const std::string &kind,double val)
+{
+    Dictionary attrs;
+    attrs.setString("kind",kind);
+    attrs.setDouble("val",val);
+    return attrs;
+}
+
+// Aggregates come out right whether members are added one by one or merged
+static void TestAggregates()
+{
+    std::vector<ClusterStatDef> defs;
+    defs.push_back(ClusterStatDef(ClusterStatCountByCategory,"kind"));
+    defs.push_back(ClusterStatDef(ClusterStatSum,"val"));
+    defs.push_back(ClusterStatDef(ClusterStatMean,"val"));
+    defs.back().name = "meanVal";
+    defs.push_back(ClusterStatDef(ClusterStatFirstByPriority,"kind"));
+    defs.back().name = "top";
+
+    Dictionary a = MakeAttrs("cafe",1.0), b = MakeAttrs("bar",2.0), c = MakeAttrs("cafe",6.0);
+    ClusterStats all(&defs);
+    all.addMember(&a,1.0);
+    all.addMember(&b,3.0);
+    all.addMember(&c,2.0);
+    all.addMember(NULL,5.0);
+
+    CHECK_EQ(all.getCount(),4);
+    CHECK_EQ(all.findStat("meanVal"),2);
+    CHECK_EQ(all.getCategoryCounts(0).at("cafe"),2);
+    CHECK(all.getDominantCategory(0) == "cafe");
+    CHECK_NEAR(all.getValue(1),9.0,1e-9);
+    CHECK_NEAR(all.getValue(2),3.0,1e-9);
+    CHECK(all.getFirstValue(3) == "bar");
+
+    ClusterStats left(&defs),right(&defs);
+    left.addMember(&a,1.0);
+    left.addMember(&b,3.0);
+    right.addMember(&c,2.0);
+    right.addMember(NULL,5.0);
+    left.merge(right);
+    CHECK(left.getKey() == all.getKey());
+}
+
+// Separators in category names and values can't make different clusters share a key
+static void TestKeyEscaping()
+{
+    std::vector<ClusterStatDef> defs;
+    defs.push_back(ClusterStatDef(ClusterStatCountByCategory,"kind"));
+    defs.push_back(ClusterStatDef(ClusterStatFirstByPriority,"label"));
+
+    Dictionary plain;
+    plain.setString("kind","a");
+    plain.setString("label","b|c");
+    Dictionary tricky;
+    tricky.setString("kind","a:1,|b");
+    tricky.setString("label","c");
+
+    ClusterStats plainStats(&defs),trickyStats(&defs);
+    plainStats.addMember(&plain,1.0);
+    trickyStats.addMember(&tricky,1.0);
+
+    CHECK(plainStats.getKey() == "1|a:1,|b\\|c");
+    CHECK(trickyStats.getKey() == "1|a\\:1\\,\\|b:1,|c");
+    CHECK(plainStats.getKey() != trickyStats.getKey());
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestAggregates);
+    RUN_TEST(TestKeyEscaping);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,119 @@
+/*
+ *  DrawableAnimatorTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import "WhirlyGlobe.h"
+#import "DrawableAnimator.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+// Fade from 1 to 0 over a second
+static AnimTrack MakeFadeTrack(SimpleIdentity drawID,SimpleIdentity featureID)
+{
+    AnimTrack track;
+    track.property = AnimAlpha;
+    track.drawID = drawID;
+    track.featureID = featureID;
+    track.keys.push_back(AnimKeyframe(0.0,Eigen::Vector4f(1.0,1.0,1.0,1.0)));
+    track.keys.push_back(AnimKeyframe(1.0,Eigen::Vector4f(0.0,0.0,0.0,0.0)));
+
+    return track;
+}
+
+static void TestRemoveFeatureDrawable()
+{
+    DrawableAnimator animator;
+    SimpleIDSet drawIDs;
+    drawIDs.insert(1);  drawIDs.insert(2);
+    animator.setFeatureDrawables(100,drawIDs);
+    animator.addTrack(MakeFadeTrack(EmptyIdentity,100));
+    animator.evaluate(0.5);
+    CHECK(animator.stateForDrawable(1) != NULL);
+    CHECK(animator.stateForDrawable(2) != NULL);
+
+    // The feature keeps animating what's left of it
+    animator.removeDrawable(1);
+    CHECK(animator.stateForDrawable(1) == NULL);
+    CHECK(!animator.empty());
+    animator.evaluate(0.5);
+    const DrawableAnimState *state = animator.stateForDrawable(2);
+    CHECK(state != NULL);
+    if (state)
+        CHECK_NEAR(state->alpha,0.5,1e-5);
+
+    // Once the feature goes, so do its tracks
+    animator.removeFeature(100);
+    CHECK(animator.empty());
+    CHECK(animator.stateForDrawable(2) == NULL);
+}
+
+static void TestRemoveTargetedDrawable()
+{
+    DrawableAnimator animator;
+    animator.addTrack(MakeFadeTrack(3,EmptyIdentity));
+    animator.addTrack(MakeFadeTrack(4,EmptyIdentity));
+    animator.removeDrawable(3);
+    CHECK(animator.stateForDrawable(3) == NULL);
+    CHECK(animator.stateForDrawable(4) != NULL);
+    animator.removeDrawable(4);
+    CHECK(animator.empty());
+
+    // Drawables nobody animates are ignored
+    animator.removeDrawable(5);
+    CHECK(animator.empty());
+}
+
+static void TestCachedSlot()
+{
+    DrawableAnimator animator;
+    BasicDrawable draw("DrawableAnimatorTest");
+    BasicDrawable other("DrawableAnimatorTest");
+    AnimTrack track = MakeFadeTrack(draw.getId(),EmptyIdentity);
+    animator.addTrack(track);
+    animator.evaluate(0.25);
+
+    const DrawableAnimState *state = animator.stateForDrawable(&draw);
+    CHECK(state != NULL);
+    if (state)
+        CHECK_NEAR(state->alpha,0.75,1e-5);
+    CHECK(animator.stateForDrawable(&other) == NULL);
+    // Second lookup comes off the drawable and agrees
+    CHECK(animator.stateForDrawable(&draw) == state);
+
+    // Changing the tracks has to invalidate what the drawables cached
+    animator.removeTrack(track.getId());
+    CHECK(animator.stateForDrawable(&draw) == NULL);
+    animator.addTrack(MakeFadeTrack(other.getId(),EmptyIdentity));
+    animator.evaluate(0.5);
+    state = animator.stateForDrawable(&other);
+    CHECK(state != NULL);
+    if (state)
+        CHECK_NEAR(state->alpha,0.5,1e-5);
+    CHECK(animator.stateForDrawable(&draw) == NULL);
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestRemoveFeatureDrawable);
+    RUN_TEST(TestRemoveTargetedDrawable);
+    RUN_TEST(TestCachedSlot);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,219 @@
+/*
+ *  MotionManagerTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import "WhirlyGlobe.h"
+#import "MotionManager.h"
+#import "FlatMath.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+// Meters along the equator to radians
+static double MetersToRad(double meters)
+{
+    return meters / EarthRadius;
+}
+
+// Something heading east along the equator at the given speed, reported every second
+static void FeedEastbound(MotionManager &manager,SimpleIdentity objID,double speed,int numReports)
+{
+    for (int ii=0;ii<numReports;ii++)
+    {
+        MotionObservation obs(GeoCoord(MetersToRad(speed*ii),0.0),ii);
+        obs.accuracy = 1.0;
+        manager.addObservation(objID,obs);
+    }
+}
+
+static void TestConstantVelocity()
+{
+    MotionManager manager;
+    FeedEastbound(manager,1,10.0,20);
+
+    // Last report was at t=19, so this is extrapolating
+    MotionSample sample;
+    CHECK(manager.sample(1,24.0,sample));
+    CHECK(sample.extrapolated);
+    CHECK_NEAR(sample.loc.lon(),MetersToRad(240.0),MetersToRad(2.0));
+    CHECK_NEAR(sample.loc.lat(),0.0,MetersToRad(1.0));
+    CHECK_NEAR(sample.speed,10.0,0.5);
+    // East is a quarter turn clockwise from north, which is counter-clockwise on screen
+    CHECK_NEAR(sample.heading,M_PI/2.0,0.01);
+    CHECK_NEAR(sample.screenRotation(),3.0*M_PI/2.0,0.01);
+
+    // Between reports we follow the filter, not the raw points
+    CHECK(manager.sample(1,10.5,sample));
+    CHECK(!sample.extrapolated);
+}
+
+static void TestOrdering()
+{
+    MotionManager manager;
+    FeedEastbound(manager,1,10.0,5);
+
+    // Older than what we've seen, so it's dropped
+    MotionObservation late(GeoCoord(MetersToRad(-500.0),0.0),2.0);
+    CHECK(!manager.addObservation(1,late));
+
+    MotionSample sample;
+    CHECK(manager.sample(1,4.0,sample));
+    CHECK_NEAR(sample.loc.lon(),MetersToRad(40.0),MetersToRad(2.0));
+
+    // Same time as the last one is fine
+    MotionObservation same(GeoCoord(MetersToRad(40.0),0.0),4.0);
+    CHECK(manager.addObservation(1,same));
+}
+
+static void TestExtrapolationLimit()
+{
+    MotionManager manager;
+    MotionParams params;
+    params.maxExtrapolate = 5.0;
+    manager.setParams(params);
+    FeedEastbound(manager,1,10.0,10);
+
+    // Objects stop where the limit runs out
+    MotionSample atLimit,wayPast;
+    CHECK(manager.sample(1,9.0+5.0,atLimit));
+    CHECK(manager.sample(1,9.0+500.0,wayPast));
+    CHECK_NEAR(wayPast.loc.lon(),atLimit.loc.lon(),1e-12);
+    CHECK_EQ(wayPast.speed,0.0);
+    // But keep facing the way they were going
+    CHECK_NEAR(wayPast.heading,M_PI/2.0,0.01);
+}
+
+static void TestBlendAndSnap()
+{
+    MotionParams params;
+    params.blendTime = 2.0;
+    params.snapDistance = 100.0;
+
+    // A report a little off the path eases over rather than jumping
+    {
+        MotionManager manager;
+        manager.setParams(params);
+        FeedEastbound(manager,1,10.0,10);
+        MotionSample before;
+        manager.sample(1,10.0,before);
+
+        MotionObservation obs(GeoCoord(MetersToRad(100.0),MetersToRad(20.0)),10.0);
+        obs.accuracy = 1.0;
+        manager.addObservation(1,obs);
+        MotionSample atReport,afterBlend;
+        manager.sample(1,10.0,atReport);
+        manager.sample(1,10.0+params.blendTime,afterBlend);
+
+        // Still showing where it was
+        CHECK_NEAR(atReport.loc.lon(),before.loc.lon(),MetersToRad(0.01));
+        CHECK_NEAR(atReport.loc.lat(),before.loc.lat(),MetersToRad(0.01));
+        // And moved over to the new track by the end of the blend
+        CHECK(afterBlend.loc.lat() > MetersToRad(10.0));
+    }
+
+    // One too far off jumps straight to the new estimate
+    {
+        MotionFilter filter;
+        for (int ii=0;ii<10;ii++)
+        {
+            MotionObservation obs(GeoCoord(MetersToRad(10.0*ii),0.0),ii);
+            obs.accuracy = 1.0;
+            filter.addObservation(obs,params);
+        }
+
+        MotionObservation obs(GeoCoord(MetersToRad(100.0),MetersToRad(5000.0)),10.0);
+        obs.accuracy = 1.0;
+        filter.addObservation(obs,params);
+        MotionSample atReport;
+        filter.sample(10.0,params,atReport);
+        GeoCoord estLoc;
+        Point2d estVel;
+        filter.estimate(10.0,params,estLoc,estVel);
+        CHECK(estLoc.lat() > MetersToRad(params.snapDistance));
+        CHECK_EQ(atReport.loc.lon(),estLoc.lon());
+        CHECK_EQ(atReport.loc.lat(),estLoc.lat());
+    }
+}
+
+static void TestRepeatable()
+{
+    // Same reports, same answers, regardless of when or how often we ask
+    MotionManager manager1,manager2;
+    FeedEastbound(manager1,1,7.0,12);
+    FeedEastbound(manager2,1,7.0,12);
+
+    MotionSample sample1,sample2;
+    for (double when = 0.0;when < 20.0;when += 0.25)
+        manager1.sample(1,when,sample1);
+    manager1.sample(1,15.5,sample1);
+    manager2.sample(1,15.5,sample2);
+    CHECK_EQ(sample1.loc.lon(),sample2.loc.lon());
+    CHECK_EQ(sample1.loc.lat(),sample2.loc.lat());
+    CHECK_EQ(sample1.heading,sample2.heading);
+}
+
+static void TestSampleAllAndSegments()
+{
+    MotionManager manager;
+    FeedEastbound(manager,30,10.0,20);
+    FeedEastbound(manager,10,20.0,20);
+    FeedEastbound(manager,20,5.0,20);
+    CHECK_EQ(manager.numObjects(),3);
+
+    // Objects come back in ID order
+    std::vector<SimpleIdentity> objIDs;
+    std::vector<MotionSample> samples;
+    manager.sampleAll(19.0,objIDs,samples);
+    CHECK_EQ(objIDs.size(),3);
+    CHECK_EQ(samples.size(),3);
+    if (objIDs.size() == 3)
+    {
+        CHECK(objIDs[0] == 10 && objIDs[1] == 20 && objIDs[2] == 30);
+        CHECK_NEAR(samples[0].loc.lon(),MetersToRad(380.0),MetersToRad(2.0));
+        CHECK_NEAR(samples[1].loc.lon(),MetersToRad(95.0),MetersToRad(2.0));
+    }
+
+    // Segments run from one sample to the other, facing the heading
+    MotionSegment segment;
+    CHECK(manager.calcSegment(10,19.0,2.0,segment));
+    CHECK_NEAR(segment.startLoc.lon(),MetersToRad(380.0),MetersToRad(2.0));
+    CHECK_NEAR(segment.endLoc.lon(),MetersToRad(420.0),MetersToRad(2.0));
+    CHECK_EQ(segment.endTime,21.0);
+    CHECK_NEAR(segment.rotation,3.0*M_PI/2.0,0.01);
+
+    SimpleIDSet toRemove;
+    toRemove.insert(20);
+    manager.removeObjects(toRemove);
+    CHECK_EQ(manager.numObjects(),2);
+    MotionSample sample;
+    CHECK(!manager.sample(20,19.0,sample));
+    CHECK(!manager.calcSegment(20,19.0,2.0,segment));
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestConstantVelocity);
+    RUN_TEST(TestOrdering);
+    RUN_TEST(TestExtrapolationLimit);
+    RUN_TEST(TestBlendAndSnap);
+    RUN_TEST(TestRepeatable);
+    RUN_TEST(TestSampleAllAndSegments);
+
+    return TEST_RESULT();
+}
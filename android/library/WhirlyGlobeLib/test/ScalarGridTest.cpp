@@ -0,0 +1,249 @@
+/*
+ *  ScalarGridTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <string.h>
+#import "WhirlyGlobe.h"
+#import "ScalarGrid.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+template<typename T> static ScalarGridRef MakeGrid(int width,int height,ScalarGridDataType dataType,const std::vector<T> &vals)
+{
+    RawDataRef data(new MutableRawData((void *)&vals[0],(unsigned int)(vals.size()*sizeof(T))));
+    return ScalarGridRef(new ScalarGrid(width,height,dataType,data));
+}
+
+static bool ColorIs(const RGBAColor &color,int r,int g,int b,int a)
+{
+    return color.r == r && color.g == g && color.b == b && color.a == a;
+}
+
+static void FreeChanges(ChangeSet &changes)
+{
+    for (ChangeRequest *change : changes)
+        delete change;
+    changes.clear();
+}
+
+static void TestValues()
+{
+    // Scale, offset and no data
+    std::vector<int16_t> vals = {-100, 0, 100, -9999};
+    ScalarGridRef grid = MakeGrid(2,2,ScalarGridInt16,vals);
+    grid->setScaleOffset(0.5,10.0);
+    grid->setNoData(-9999);
+    CHECK(grid->isValid());
+
+    double val;
+    CHECK(grid->valueAt(0,0,val));
+    CHECK_EQ(val,-40.0);
+    CHECK(grid->valueAt(1,1,val) == false);
+    CHECK(grid->valueAt(2,0,val) == false);
+
+    double minVal,maxVal;
+    CHECK(grid->getRange(minVal,maxVal));
+    CHECK_EQ(minVal,-40.0);
+    CHECK_EQ(maxVal,60.0);
+
+    // Floats with NaN count as missing too
+    std::vector<float> fvals = {1.5f, NAN};
+    ScalarGridRef fgrid = MakeGrid(2,1,ScalarGridFloat32,fvals);
+    CHECK(fgrid->valueAt(0,0,val) && val == 1.5);
+    CHECK(!fgrid->valueAt(1,0,val));
+
+    // Not enough data for the size
+    std::vector<uint16_t> short16 = {1,2,3};
+    CHECK(!MakeGrid(2,2,ScalarGridUInt16,short16)->isValid());
+}
+
+static void TestSampling()
+{
+    std::vector<uint8_t> vals = {0, 100,
+                                 200, 255};
+    ScalarGridRef grid = MakeGrid(2,2,ScalarGridUInt8,vals);
+
+    double val;
+    // Cell centers give the cell values
+    CHECK(grid->sample(0.5,0.5,val));
+    CHECK_NEAR(val,0.0,1e-9);
+    CHECK(grid->sample(1.5,1.5,val));
+    CHECK_NEAR(val,255.0,1e-9);
+    // Halfway between all four
+    CHECK(grid->sample(1.0,1.0,val));
+    CHECK_NEAR(val,(0+100+200+255)/4.0,1e-9);
+    // Halfway along the top row
+    CHECK(grid->sample(1.0,0.5,val));
+    CHECK_NEAR(val,50.0,1e-9);
+    // Outside
+    CHECK(!grid->sample(-0.1,0.5,val));
+    CHECK(!grid->sample(0.5,2.1,val));
+
+    // Next to missing data we take the nearest cell rather than blending
+    grid->setNoData(255);
+    CHECK(grid->sample(1.2,0.8,val));
+    CHECK_NEAR(val,100.0,1e-9);
+    CHECK(!grid->sample(1.8,1.8,val));
+}
+
+static void TestEncoding()
+{
+    ScalarGridEncoding encoding(-50.0,50.0);
+    unsigned char pixel[4];
+    double val;
+
+    // Round trips to within a step of the 16 bits
+    for (double in = -50.0;in <= 50.0;in += 0.37)
+    {
+        encoding.encode(in,true,pixel);
+        CHECK(encoding.decode(pixel,val));
+        CHECK_NEAR(val,in,100.0/65535.0);
+    }
+
+    // Clamped to the range
+    encoding.encode(1000.0,true,pixel);
+    CHECK(encoding.decode(pixel,val));
+    CHECK_EQ(val,50.0);
+
+    // No data is transparent
+    encoding.encode(0.0,false,pixel);
+    CHECK_EQ(pixel[3],0);
+    CHECK(!encoding.decode(pixel,val));
+}
+
+static void TestColorMap()
+{
+    ColorMap colorMap;
+    colorMap.addStop(100.0,RGBAColor(0,0,255,255));
+    colorMap.addStop(0.0,RGBAColor(255,0,0,255));
+    colorMap.addStop(50.0,RGBAColor(0,255,0,255));
+    CHECK_EQ(colorMap.getMinValue(),0.0);
+    CHECK_EQ(colorMap.getMaxValue(),100.0);
+
+    // Ends and stops
+    CHECK(ColorIs(colorMap.colorFor(-10.0),255,0,0,255));
+    CHECK(ColorIs(colorMap.colorFor(50.0),0,255,0,255));
+    CHECK(ColorIs(colorMap.colorFor(500.0),0,0,255,255));
+    // Blended between
+    CHECK(ColorIs(colorMap.colorFor(25.0),128,128,0,255));
+
+    // Held when it's discrete
+    colorMap.setDiscrete(true);
+    CHECK(ColorIs(colorMap.colorFor(49.0),255,0,0,255));
+    CHECK(ColorIs(colorMap.colorFor(75.0),0,255,0,255));
+}
+
+static void TestRamp()
+{
+    ColorMap colorMap;
+    colorMap.addStop(-20.0,RGBAColor(0,0,0,0));
+    colorMap.addStop(40.0,RGBAColor(255,128,0,128));
+    colorMap.addStop(60.0,RGBAColor(255,255,255,255));
+
+    RawDataRef ramp = colorMap.makeRamp();
+    CHECK_EQ(ramp->getLen(),ColorMap::RampSize*4);
+
+    // Look up the ramp the way the shader does (nearest texel) and compare
+    const unsigned char *texels = ramp->getRawData();
+    double minVal = colorMap.getMinValue(), range = colorMap.getMaxValue() - minVal;
+    for (double val = -30.0;val <= 70.0;val += 0.13)
+    {
+        double t = std::min(std::max((val - minVal) / range,0.0),1.0);
+        float texCoord = (t * 1023.0 + 0.5) / 1024.0;
+        int texel = std::min((int)(texCoord * ColorMap::RampSize),ColorMap::RampSize-1);
+        const unsigned char *pix = &texels[texel*4];
+        RGBAColor color = colorMap.rampColorFor(val);
+        CHECK(ColorIs(color,pix[0],pix[1],pix[2],pix[3]));
+    }
+
+    // Premultiplied
+    RGBAColor mid = colorMap.rampColorFor(40.0);
+    CHECK(mid.r <= mid.a && mid.g <= mid.a);
+}
+
+static void TestColorize()
+{
+    std::vector<float> vals = {0.0f, 25.0f, 50.0f, -1.0f};
+    ScalarGridRef grid = MakeGrid(4,1,ScalarGridFloat32,vals);
+    grid->setNoData(-1.0);
+
+    ColorMap colorMap;
+    colorMap.addStop(0.0,RGBAColor(255,0,0,255));
+    colorMap.addStop(50.0,RGBAColor(0,0,255,255));
+
+    ChangeSet changes;
+    ScalarGridColorizer colorizer(ScalarGridEncoding(0.0,50.0));
+    colorizer.setColorMap(colorMap,changes);
+    FreeChanges(changes);
+
+    RawDataRef out = colorizer.colorize(*grid);
+    CHECK_EQ(out->getLen(),16);
+    const unsigned char *pix = out->getRawData();
+    CHECK(pix[0] == 255 && pix[2] == 0 && pix[3] == 255);
+    CHECK(pix[8] == 0 && pix[10] == 255 && pix[11] == 255);
+    // No data stays clear
+    CHECK_EQ(pix[15],0);
+
+    // Filtered values are dropped, the rest unchanged
+    colorizer.setValueFilter(10.0,40.0,changes);
+    FreeChanges(changes);
+    out = colorizer.colorize(*grid);
+    pix = out->getRawData();
+    CHECK_EQ(pix[3],0);
+    CHECK_EQ(pix[7],255);
+    CHECK_EQ(pix[11],0);
+}
+
+static void TestSampler()
+{
+    // Coarse tile of all 1s and a finer one of 2s over its lower left quarter
+    std::vector<uint8_t> ones(4*4,1), twos(4*4,2);
+    twos[0] = 3;
+    ScalarGridSampler sampler;
+    sampler.addTile(Quadtree::Identifier(0,0,0),Point2d(0,0),Point2d(4,4),MakeGrid(4,4,ScalarGridUInt8,ones));
+    sampler.addTile(Quadtree::Identifier(0,0,1),Point2d(0,0),Point2d(2,2),MakeGrid(4,4,ScalarGridUInt8,twos));
+
+    double val;
+    CHECK(sampler.valueAt(Point2d(3,3),val));
+    CHECK_EQ(val,1.0);
+    CHECK(sampler.valueAt(Point2d(1,1),val));
+    CHECK_EQ(val,2.0);
+    // First row is the top of the tile
+    CHECK(sampler.valueAt(Point2d(0.1,1.9),val));
+    CHECK_EQ(val,3.0);
+    CHECK(!sampler.valueAt(Point2d(5,5),val));
+
+    sampler.removeTile(Quadtree::Identifier(0,0,1));
+    CHECK(sampler.valueAt(Point2d(1,1),val));
+    CHECK_EQ(val,1.0);
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestValues);
+    RUN_TEST(TestSampling);
+    RUN_TEST(TestEncoding);
+    RUN_TEST(TestColorMap);
+    RUN_TEST(TestRamp);
+    RUN_TEST(TestColorize);
+    RUN_TEST(TestSampler);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+/*
+ *  SelectableIndexTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import "WhirlyGlobe.h"
+#import "SelectableIndex.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+// Box queries find what's in range, plus the ones that are always candidates
+static void TestBoxQuery()
+{
+    SelectableIndex index(1.0,4);
+    index.addEntry(1,Point3d(0.5,0.5,0),Point3d(0.6,0.6,0));
+    index.addEntry(2,Point3d(10.5,10.5,0),Point3d(10.6,10.6,0));
+    index.addEntry(3,Point3d(-20.5,3.5,0),Point3d(-20.4,3.6,0));
+    index.addAlways(4);
+
+    SimpleIDSet found;
+    index.findCandidates(Point3d(0,0,0),Point3d(2,2,0),found);
+    CHECK_EQ((int)found.size(),2);
+    CHECK(found.count(1) && found.count(4));
+
+    found.clear();
+    index.findCandidates(Point3d(-25,0,0),Point3d(-15,5,0),found);
+    CHECK_EQ((int)found.size(),2);
+    CHECK(found.count(3) && found.count(4));
+
+    index.removeEntry(3);
+    found.clear();
+    index.findCandidates(Point3d(-25,0,0),Point3d(-15,5,0),found);
+    CHECK_EQ((int)found.size(),1);
+}
+
+// Only the coarse cells within the box get tested, however many there are outside it
+static void TestQueryClamped()
+{
+    SelectableIndex index(1.0,4);
+    SimpleIdentity selectID = 1;
+    for (int iy=0;iy<64;iy++)
+        for (int ix=0;ix<64;ix++,selectID++)
+            index.addEntry(selectID,Point3d(ix+0.25,iy+0.25,0),Point3d(ix+0.5,iy+0.5,0));
+
+    // Two by two coarse cells, each holding four by four fine ones
+    int numTests = 0;
+    SimpleIDSet found;
+    index.findCandidates(Point3d(0,0,0),Point3d(7.9,7.9,0),
+                         [&](const Point3d &ll,const Point3d &ur)
+                         {
+                             numTests++;
+                             CHECK(ll.x() < 8.0 && ll.y() < 8.0);
+                             return true;
+                         },
+                         found);
+    CHECK_EQ((int)found.size(),64);
+    CHECK_EQ(numTests,4+64);
+
+    // A test that turns down a coarse cell skips everything in it
+    found.clear();
+    index.findCandidates(Point3d(0,0,0),Point3d(7.9,7.9,0),
+                         [&](const Point3d &ll,const Point3d &ur)
+                         {
+                             return ll.x() >= 4.0;
+                         },
+                         found);
+    CHECK_EQ((int)found.size(),32);
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestBoxQuery);
+    RUN_TEST(TestQueryClamped);
+
+    return TEST_RESULT();
+}
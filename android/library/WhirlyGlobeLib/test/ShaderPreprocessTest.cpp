@@ -0,0 +1,215 @@
+/*
+ *  ShaderPreprocessTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <algorithm>
+#import <map>
+#import <sstream>
+#import "WhirlyGlobe.h"
+#import "ShaderPermutation.h"
+#import "DefaultShaderPrograms.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+// Preprocess and return the lines that survived, joined with commas
+static std::string Survivors(const std::string &src,const std::set<std::string> &defines)
+{
+    std::string outSrc,errStr;
+    if (!ShaderPreprocess(src,defines,outSrc,errStr))
+        return "error: " + errStr;
+
+    std::string ret;
+    std::istringstream in(outSrc);
+    std::string line;
+    while (std::getline(in,line))
+        if (!line.empty())
+            ret += (ret.empty() ? "" : ",") + line;
+
+    return ret;
+}
+
+static int CountLines(const std::string &str)
+{
+    return (int)std::count(str.begin(),str.end(),'\n') + 1;
+}
+
+// The taken side of an #ifdef/#else survives and line numbers stay put
+static void TestIfdefElse()
+{
+    std::string src = "a\n#ifdef X\nb\n#else\nc\n#endif\nd";
+    std::string outSrc,errStr;
+
+    CHECK(ShaderPreprocess(src,{"X"},outSrc,errStr));
+    CHECK(outSrc == "a\n\nb\n\n\n\nd");
+    CHECK(ShaderPreprocess(src,{},outSrc,errStr));
+    CHECK(outSrc == "a\n\n\n\nc\n\nd");
+    CHECK_EQ(CountLines(outSrc),CountLines(src));
+
+    CHECK(Survivors("#ifndef X\nyes\n#endif",{}) == "yes");
+    CHECK(Survivors("#ifndef X\nyes\n#endif",{"X"}) == "");
+}
+
+// An #else inside a dead block doesn't bring anything back
+static void TestNesting()
+{
+    std::string src =
+        "#ifdef A\n"
+        "#ifdef B\n"
+        "ab\n"
+        "#else\n"
+        "a\n"
+        "#endif\n"
+        "#else\n"
+        "#ifdef B\n"
+        "b\n"
+        "#else\n"
+        "none\n"
+        "#endif\n"
+        "#endif\n";
+
+    CHECK(Survivors(src,{"A","B"}) == "ab");
+    CHECK(Survivors(src,{"A"}) == "a");
+    CHECK(Survivors(src,{"B"}) == "b");
+    CHECK(Survivors(src,{}) == "none");
+}
+
+// #if and #elif expressions, and #define in live code only
+static void TestIfElif()
+{
+    std::string src =
+        "#if defined(A) && !defined(B)\n"
+        "onlyA\n"
+        "#elif defined(A) || defined(B)\n"
+        "some\n"
+        "#else\n"
+        "neither\n"
+        "#endif";
+
+    CHECK(Survivors(src,{"A"}) == "onlyA");
+    CHECK(Survivors(src,{"A","B"}) == "some");
+    CHECK(Survivors(src,{"B"}) == "some");
+    CHECK(Survivors(src,{}) == "neither");
+
+    CHECK(Survivors("#define N 2\n#if N\nbig\n#endif\n#if 0\nzero\n#endif",{}) == "#define N 2,big");
+    CHECK(Survivors("#ifdef X\n#define Y\n#endif\n#ifdef Y\ny\n#endif",{}) == "");
+    CHECK(Survivors("#undef X\n#ifdef X\nx\n#endif",{"X"}) == "#undef X");
+}
+
+// Directives we don't handle go through untouched when live
+static void TestUnknownDirectives()
+{
+    std::string src =
+        "#version 100\n"
+        "#extension GL_OES_standard_derivatives : enable\n"
+        "#ifdef X\n"
+        "#pragma debug(on)\n"
+        "#endif\n"
+        "main";
+
+    CHECK(Survivors(src,{"X"}) == "#version 100,#extension GL_OES_standard_derivatives : enable,#pragma debug(on),main");
+    CHECK(Survivors(src,{}) == "#version 100,#extension GL_OES_standard_derivatives : enable,main");
+}
+
+// Unbalanced conditionals are errors
+static void TestMalformed()
+{
+    std::string outSrc,errStr;
+    CHECK(!ShaderPreprocess("a\n#endif",{},outSrc,errStr));
+    CHECK(errStr.find("Line 2") != std::string::npos);
+    CHECK(!ShaderPreprocess("#else",{},outSrc,errStr));
+    CHECK(!ShaderPreprocess("#ifdef X\na",{},outSrc,errStr));
+    CHECK(!ShaderPreprocess("#ifdef X\n#else\n#else\n#endif",{},outSrc,errStr));
+    CHECK(!ShaderPreprocess("#ifdef\n#endif",{},outSrc,errStr));
+    CHECK(!ShaderPreprocess("#if (1\n#endif",{},outSrc,errStr));
+}
+
+// Each distinct permutation of the triangle module gets its own name, and they all build
+static void TestPermutationNames()
+{
+    ShaderModule module = DefaultTriangleShaderModule();
+
+    std::map<std::string,int> nameToFeatures;
+    int allFeatures = ShaderTriLighting | ShaderTriModelInstance | ShaderTriScreenTex | ShaderTriMultiTex | ShaderTriColorRamp | ShaderTriNightDay;
+    for (int features=0;features<=allFeatures;features++)
+    {
+        int norm = module.normalizeFeatures(features);
+        CHECK_EQ(module.normalizeFeatures(norm),norm);
+        CHECK(module.permutationName(features) == module.permutationName(norm));
+
+        std::string name = module.permutationName(norm);
+        auto it = nameToFeatures.find(name);
+        if (it != nameToFeatures.end())
+            CHECK_EQ(it->second,norm);
+        else
+            nameToFeatures[name] = norm;
+
+        std::string vertSrc,fragSrc,errStr;
+        CHECK(module.buildSources(norm,vertSrc,fragSrc,errStr));
+    }
+
+    // No two feature sets share a name
+    std::set<int> distinctFeatures;
+    for (auto &it : nameToFeatures)
+        distinctFeatures.insert(it.second);
+    CHECK_EQ((int)distinctFeatures.size(),(int)nameToFeatures.size());
+
+    // The toolkit program names are permutation names
+    CHECK(module.permutationName(0) == kToolkitDefaultTriangleNoLightingProgram);
+    CHECK(module.permutationName(ShaderTriLighting) == kToolkitDefaultTriangleProgram);
+    CHECK(module.permutationName(ShaderTriModelInstance | ShaderTriLighting) == kToolkitDefaultTriangleModel);
+    CHECK(module.permutationName(ShaderTriScreenTex | ShaderTriLighting) == kToolkitDefaultTriangleScreenTex);
+    CHECK(module.permutationName(ShaderTriMultiTex | ShaderTriLighting) == kToolkitDefaultTriangleMultiTex);
+    CHECK(module.permutationName(ShaderTriMultiTex | ShaderTriLighting | ShaderTriColorRamp) == kToolkitDefaultTriangleMultiTexRamp);
+    CHECK(module.permutationName(ShaderTriNightDay | ShaderTriMultiTex | ShaderTriLighting) == kToolkitDefaultTriangleNightDay);
+}
+
+// Drawables without a program pick theirs from the features they ask for
+static void TestDrawablePermutation()
+{
+    ShaderModule module = DefaultTriangleShaderModule();
+
+    // One texture is the plain default, which comes from the scene's default triangle shader
+    BasicDrawable singleTex("ShaderPreprocessTest");
+    singleTex.setTexId(0,1);
+    CHECK(singleTex.getProgram() == EmptyIdentity);
+    CHECK_EQ(singleTex.getShaderFeatures(),(int)ShaderTriLighting);
+
+    // Two textures get the multitexture permutation rather than the default
+    BasicDrawable multiTex("ShaderPreprocessTest");
+    std::vector<SimpleIdentity> texIDs;
+    texIDs.push_back(1);  texIDs.push_back(2);
+    multiTex.setTexIDs(texIDs);
+    CHECK(multiTex.getProgram() == EmptyIdentity);
+    CHECK_EQ(multiTex.getShaderFeatures(),(int)(ShaderTriLighting | ShaderTriMultiTex));
+    CHECK(module.permutationName(multiTex.getShaderFeatures()) == kToolkitDefaultTriangleMultiTex);
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestIfdefElse);
+    RUN_TEST(TestNesting);
+    RUN_TEST(TestIfElif);
+    RUN_TEST(TestUnknownDirectives);
+    RUN_TEST(TestMalformed);
+    RUN_TEST(TestPermutationNames);
+    RUN_TEST(TestDrawablePermutation);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,206 @@
+/*
+ *  SoftRasterizerTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdint.h>
+#import "WhirlyGlobe.h"
+#import "SoftRasterizer.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+// Hash of the golden frame drawn by DrawGoldenScene().
+// If the rasterizer's output changes on purpose, look at the .ppm the test writes and update this.
+static const uint64_t GoldenHash = 0xa90b628511f4f7b0ULL;
+// Same scene with the checkerboard sampled bilinear
+static const uint64_t BilinearGoldenHash = 0xb615302f585460a8ULL;
+
+static const int FrameWidth = 96, FrameHeight = 64;
+
+static SoftVertex MakeVert(float x,float y,float z,const Eigen::Vector4f &color,float u=0.0,float v=0.0)
+{
+    SoftVertex vert;
+    vert.pos = Eigen::Vector4f(x,y,z,1.0);
+    vert.color = color;
+    vert.uv = Point2f(u,v);
+    return vert;
+}
+
+// 2x2 checkerboard
+static const unsigned char CheckerPixels[] = {
+    255,255,255,255,   0,0,0,255,
+    0,0,0,255,         255,255,255,255
+};
+
+// A little bit of everything: culling, depth, texturing, lines and points
+static void DrawGoldenScene(SoftFrameBuffer &frameBuffer,int numThreads,bool linear=false)
+{
+    frameBuffer.clear(RGBAColor(0,0,64,255));
+
+    SoftRasterizer raster(&frameBuffer,numThreads,16);
+
+    SoftDrawState plainState;
+    plainState.depthTest = true;
+    plainState.depthWrite = true;
+    int plain = raster.addState(plainState);
+
+    SoftTexture tex;
+    tex.pixels = CheckerPixels;
+    tex.width = 2;  tex.height = 2;
+    tex.linear = linear;
+    SoftDrawState texState = plainState;
+    texState.tex = &tex;
+    int textured = raster.addState(texState);
+
+    SoftDrawState overState;
+    overState.cullBack = false;
+    int over = raster.addState(overState);
+
+    Eigen::Vector4f red(1,0,0,1), green(0,1,0,1), white(1,1,1,1), yellow(1,1,0,1);
+
+    // Red triangle in front, counter clockwise
+    raster.addTriangle(MakeVert(-0.9,-0.8,0.2,red),MakeVert(0.3,-0.8,0.2,red),MakeVert(-0.3,0.8,0.2,red),plain);
+    // Textured quad behind it, partly covered
+    raster.addTriangle(MakeVert(-0.5,-0.5,0.5,white,0,0),MakeVert(0.7,-0.5,0.5,white,1,0),MakeVert(0.7,0.5,0.5,white,1,1),textured);
+    raster.addTriangle(MakeVert(-0.5,-0.5,0.5,white,0,0),MakeVert(0.7,0.5,0.5,white,1,1),MakeVert(-0.5,0.5,0.5,white,0,1),textured);
+    // Clockwise triangle in the corner, which should be culled
+    raster.addTriangle(MakeVert(0.8,0.9,0.0,green),MakeVert(0.95,0.6,0.0,green),MakeVert(0.6,0.6,0.0,green),plain);
+    // Line and point drawn over everything
+    raster.addLine(MakeVert(-0.95,0.9,0.0,yellow),MakeVert(0.95,-0.9,0.0,yellow),2.0,over);
+    raster.addPoint(MakeVert(0.85,-0.75,0.0,green),4.0,over);
+
+    raster.flush();
+}
+
+// FNV-1a over the color buffer
+static uint64_t HashFrame(SoftFrameBuffer &frameBuffer)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int iy=0;iy<frameBuffer.getHeight();iy++)
+        for (int ix=0;ix<frameBuffer.getWidth();ix++)
+        {
+            const unsigned char *pix = frameBuffer.colorAt(ix,iy);
+            for (int ii=0;ii<4;ii++)
+            {
+                hash ^= pix[ii];
+                hash *= 1099511628211ULL;
+            }
+        }
+    return hash;
+}
+
+static void WritePPM(SoftFrameBuffer &frameBuffer,const char *fileName)
+{
+    FILE *fp = fopen(fileName,"wb");
+    if (!fp)
+        return;
+    fprintf(fp,"P6\n%d %d\n255\n",frameBuffer.getWidth(),frameBuffer.getHeight());
+    for (int iy=0;iy<frameBuffer.getHeight();iy++)
+        for (int ix=0;ix<frameBuffer.getWidth();ix++)
+            fwrite(frameBuffer.colorAt(ix,iy),1,3,fp);
+    fclose(fp);
+}
+
+// Pixel for a point in normalized device coordinates.  Row 0 is the top.
+static unsigned char *PixelAt(SoftFrameBuffer &frameBuffer,float x,float y)
+{
+    int ix = (int)((x+1.0)/2.0 * frameBuffer.getWidth());
+    int iy = (int)((1.0-y)/2.0 * frameBuffer.getHeight());
+    return frameBuffer.colorAt(ix,iy);
+}
+
+static bool PixelIs(const unsigned char *pix,int r,int g,int b)
+{
+    return pix[0] == r && pix[1] == g && pix[2] == b;
+}
+
+static void CheckGolden(SoftFrameBuffer &frameBuffer,uint64_t goldenHash,const char *fileName)
+{
+    uint64_t hash = HashFrame(frameBuffer);
+    if (hash != goldenHash)
+    {
+        fprintf(stderr,"Golden hash mismatch: got 0x%016llxULL, wrote %s\n",(unsigned long long)hash,fileName);
+        WritePPM(frameBuffer,fileName);
+    }
+    CHECK(hash == goldenHash);
+}
+
+static void TestGoldenImage()
+{
+    SoftFrameBuffer frameBuffer(FrameWidth,FrameHeight);
+    DrawGoldenScene(frameBuffer,1);
+
+    CheckGolden(frameBuffer,GoldenHash,"SoftRasterizerTest.ppm");
+}
+
+static void TestBilinearGoldenImage()
+{
+    SoftFrameBuffer frameBuffer(FrameWidth,FrameHeight);
+    DrawGoldenScene(frameBuffer,1,true);
+
+    CheckGolden(frameBuffer,BilinearGoldenHash,"SoftRasterizerTestBilinear.ppm");
+
+    // Middle of the quad falls between all four texels, so it blends to gray
+    const unsigned char *midPix = PixelAt(frameBuffer,0.1,0.0);
+    CHECK(midPix[0] == midPix[1] && midPix[1] == midPix[2]);
+    CHECK(midPix[0] > 64 && midPix[0] < 192);
+
+    // Bilinear output must not depend on the thread count either
+    SoftFrameBuffer manyThreads(FrameWidth,FrameHeight);
+    DrawGoldenScene(manyThreads,4,true);
+    CHECK_EQ(HashFrame(frameBuffer),HashFrame(manyThreads));
+}
+
+static void TestThreadsMatch()
+{
+    // Tiles are independent, so the thread count mustn't change a thing
+    SoftFrameBuffer oneThread(FrameWidth,FrameHeight), manyThreads(FrameWidth,FrameHeight);
+    DrawGoldenScene(oneThread,1);
+    DrawGoldenScene(manyThreads,4);
+
+    CHECK_EQ(HashFrame(oneThread),HashFrame(manyThreads));
+}
+
+static void TestCoverage()
+{
+    SoftFrameBuffer frameBuffer(FrameWidth,FrameHeight);
+    DrawGoldenScene(frameBuffer,2);
+
+    // Red triangle is in front of the quad
+    CHECK(PixelIs(PixelAt(frameBuffer,-0.3,-0.3),255,0,0));
+    // Quad shows through to the right of it, in one of the checker colors
+    const unsigned char *quadPix = PixelAt(frameBuffer,0.55,0.35);
+    CHECK(PixelIs(quadPix,255,255,255) || PixelIs(quadPix,0,0,0));
+    // Clockwise triangle got culled
+    CHECK(PixelIs(PixelAt(frameBuffer,0.8,0.7),0,0,64));
+    // Point was drawn
+    CHECK(PixelIs(PixelAt(frameBuffer,0.85,-0.75),0,255,0));
+    // Untouched corner
+    CHECK(PixelIs(frameBuffer.colorAt(0,FrameHeight-1),0,0,64));
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestGoldenImage);
+    RUN_TEST(TestBilinearGoldenImage);
+    RUN_TEST(TestThreadsMatch);
+    RUN_TEST(TestCoverage);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,41 @@
+/*
+ *  TestCheck.h
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <stdio.h>
+#import <math.h>
+
+// Minimal checks for the host tests.  Failures are counted and reported,
+// and the test returns TEST_RESULT() from main so ctest sees them.
+
+static int TestFailures = 0;
+
+#define CHECK(cond) \
+    do { if (!(cond)) { TestFailures++; fprintf(stderr,"%s:%d: CHECK(%s) failed\n",__FILE__,__LINE__,#cond); } } while (0)
+
+#define CHECK_EQ(a,b) \
+    do { if (!((a) == (b))) { TestFailures++; fprintf(stderr,"%s:%d: CHECK_EQ(%s,%s) failed\n",__FILE__,__LINE__,#a,#b); } } while (0)
+
+#define CHECK_NEAR(a,b,eps) \
+    do { double _a = (a), _b = (b); if (!(fabs(_a-_b) <= (eps))) { TestFailures++; fprintf(stderr,"%s:%d: CHECK_NEAR(%s,%s) failed: %f vs %f\n",__FILE__,__LINE__,#a,#b,_a,_b); } } while (0)
+
+#define RUN_TEST(func) \
+    do { int _before = TestFailures; func(); fprintf(stderr,"%s %s\n",TestFailures == _before ? "PASS" : "FAIL",#func); } while (0)
+
+#define TEST_RESULT() (TestFailures == 0 ? 0 : 1)
@@ -0,0 +1,137 @@
+/*
+ *  ThematicClassifierTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import "WhirlyGlobe.h"
+#import "ThematicClassifier.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+static void CheckBreaks(const ThematicClassifier &classifier,const std::vector<double> &expected)
+{
+    const std::vector<double> &breaks = classifier.getBreaks();
+    CHECK_EQ(breaks.size(),expected.size());
+    for (unsigned int ii=0;ii<std::min(breaks.size(),expected.size());ii++)
+        CHECK_NEAR(breaks[ii],expected[ii],1e-9);
+}
+
+static void CheckCounts(const ThematicClassifier &classifier,const std::vector<int> &expected)
+{
+    const std::vector<int> &counts = classifier.getClassCounts();
+    CHECK_EQ(counts.size(),expected.size());
+    for (unsigned int ii=0;ii<std::min(counts.size(),expected.size());ii++)
+        CHECK_EQ(counts[ii],expected[ii]);
+}
+
+// Jenks finds the optimal grouping, checked against a brute force search
+static void TestJenks()
+{
+    ThematicClassifier classifier;
+    classifier.setMethod(ClassifyJenks);
+    classifier.setNumClasses(4);
+    classifier.setValues({30,0,1,2,4,5,7,9,10,14,15,16,20,28,29});
+    CHECK(classifier.computeBreaks());
+
+    CheckBreaks(classifier,{0,5,10,20,30});
+    CheckCounts(classifier,{5,3,4,3});
+    CHECK_NEAR(classifier.getGoodnessOfFit(),0.969676,1e-6);
+    CHECK_EQ(classifier.classFor(5.0),0);
+    CHECK_EQ(classifier.classFor(5.5),1);
+    CHECK_EQ(classifier.getOutlierCount(),0);
+}
+
+// Quantile breaks are the top value of each class
+static void TestQuantile()
+{
+    ThematicClassifier classifier;
+    classifier.setMethod(ClassifyQuantile);
+    classifier.setNumClasses(4);
+    classifier.setValues({10,9,8,7,6,5,4,3,2,1});
+    CHECK(classifier.computeBreaks());
+
+    CheckBreaks(classifier,{1,3,5,8,10});
+    CheckCounts(classifier,{3,2,3,2});
+
+    classifier.setNumClasses(5);
+    CHECK(classifier.computeBreaks());
+    CheckBreaks(classifier,{1,2,4,6,8,10});
+    CheckCounts(classifier,{2,2,2,2,2});
+}
+
+// Equal interval splits the range evenly, nulls aside
+static void TestEqualInterval()
+{
+    ThematicClassifier classifier;
+    classifier.setMethod(ClassifyEqualInterval);
+    classifier.setNumClasses(5);
+    classifier.setValues({0,3,10,std::numeric_limits<double>::quiet_NaN()});
+    CHECK(classifier.computeBreaks());
+
+    CheckBreaks(classifier,{0,2,4,6,8,10});
+    CheckCounts(classifier,{1,1,0,0,1});
+    CHECK_EQ(classifier.getNullCount(),1);
+    CHECK_EQ(classifier.classFor(std::numeric_limits<double>::quiet_NaN()),ThematicClassifier::NullClass);
+}
+
+// Fewer distinct values than classes
+static void TestFewValues()
+{
+    std::vector<double> vals = {7,5,9,5,7,5};
+
+    // Jenks can't make more classes than there are values, so it makes fewer
+    ThematicClassifier jenks;
+    jenks.setMethod(ClassifyJenks);
+    jenks.setNumClasses(5);
+    jenks.setValues(vals);
+    CHECK(jenks.computeBreaks());
+    CHECK_EQ(jenks.getNumClasses(),3);
+    CheckBreaks(jenks,{5,5,7,9});
+    CheckCounts(jenks,{3,2,1});
+    CHECK_NEAR(jenks.getGoodnessOfFit(),1.0,1e-9);
+
+    // Quantile keeps the classes, but repeated breaks leave some empty
+    ThematicClassifier quantile;
+    quantile.setMethod(ClassifyQuantile);
+    quantile.setNumClasses(5);
+    quantile.setValues(vals);
+    CHECK(quantile.computeBreaks());
+    CheckBreaks(quantile,{5,5,5,7,7,9});
+    CheckCounts(quantile,{3,0,2,0,1});
+
+    // A single value puts everything in the first class
+    ThematicClassifier equal;
+    equal.setMethod(ClassifyEqualInterval);
+    equal.setNumClasses(5);
+    equal.setValues({4,4,4});
+    CHECK(equal.computeBreaks());
+    CheckBreaks(equal,{4,4,4,4,4,4});
+    CheckCounts(equal,{3,0,0,0,0});
+    CHECK_EQ(equal.getOutlierCount(),0);
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestJenks);
+    RUN_TEST(TestQuantile);
+    RUN_TEST(TestEqualInterval);
+    RUN_TEST(TestFewValues);
+
+    return TEST_RESULT();
+}
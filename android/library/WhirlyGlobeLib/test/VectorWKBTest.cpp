@@ -0,0 +1,367 @@
+/*
+ *  VectorWKBTest.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#import <string.h>
+#import <string>
+#import "WhirlyGlobe.h"
+#import "VectorWKB.h"
+#import "VectorWKT.h"
+#import "TestCheck.h"
+
+using namespace WhirlyKit;
+
+static std::string FromHex(const char *hex)
+{
+    std::string out;
+    for (const char *ptr = hex;ptr[0] && ptr[1];ptr += 2)
+    {
+        unsigned int byte;
+        sscanf(ptr,"%2x",&byte);
+        out += (char)byte;
+    }
+    return out;
+}
+
+static std::string ToHex(const std::string &data)
+{
+    std::string out;
+    char buf[3];
+    for (unsigned char byte : data)
+    {
+        snprintf(buf,sizeof(buf),"%02x",byte);
+        out += buf;
+    }
+    return out;
+}
+
+static const unsigned char *Bytes(const std::string &str)
+{
+    return (const unsigned char *)str.data();
+}
+
+// Geometries match, coordinate for coordinate
+static bool SameGeometry(const WKBGeometry &a,const WKBGeometry &b,double eps = 1e-9)
+{
+    if (a.type != b.type || a.hasZ != b.hasZ || a.rings.size() != b.rings.size() || a.parts.size() != b.parts.size())
+        return false;
+    for (unsigned int ii=0;ii<a.rings.size();ii++)
+    {
+        if (a.rings[ii].size() != b.rings[ii].size())
+            return false;
+        for (unsigned int jj=0;jj<a.rings[ii].size();jj++)
+            if ((a.rings[ii][jj] - b.rings[ii][jj]).norm() > eps)
+                return false;
+    }
+    for (unsigned int ii=0;ii<a.parts.size();ii++)
+        if (!SameGeometry(a.parts[ii],b.parts[ii],eps))
+            return false;
+
+    return true;
+}
+
+static WKBGeometry MakeLine(bool hasZ)
+{
+    WKBGeometry geom;
+    geom.type = WKBLineString;
+    geom.hasZ = hasZ;
+    Point3dVector pts;
+    pts.push_back(Point3d(1.5,2.25,hasZ ? 10.0 : 0.0));
+    pts.push_back(Point3d(-3.0,4.0,hasZ ? -5.5 : 0.0));
+    pts.push_back(Point3d(5.0,-6.125,hasZ ? 0.25 : 0.0));
+    geom.rings.push_back(pts);
+    return geom;
+}
+
+// Write out as WKB and read back
+static bool WKBRoundTrip(const WKBGeometry &geom,int srid,bool ewkb,int &outSRID,std::string &data)
+{
+    WKBWriter writer;
+    writer.setSRID(srid);
+    writer.setEWKB(ewkb);
+    data.clear();
+    writer.write(geom,data);
+
+    WKBParser parser;
+    WKBGeometry back;
+    size_t used = parser.parse(Bytes(data),data.size(),back);
+    outSRID = parser.getSRID();
+
+    return used == data.size() && SameGeometry(geom,back);
+}
+
+static void TestWKBRoundTrips()
+{
+    int srid;
+    std::string data;
+
+    // ISO, 2D and Z
+    CHECK(WKBRoundTrip(MakeLine(false),0,false,srid,data));
+    CHECK_EQ(srid,0);
+    CHECK(WKBRoundTrip(MakeLine(true),0,false,srid,data));
+    // ISO Z types are in the 1000s
+    CHECK_EQ((unsigned char)data[1],(1000+WKBLineString) & 0xff);
+
+    // EWKB flags Z in the high bit
+    CHECK(WKBRoundTrip(MakeLine(true),0,true,srid,data));
+    CHECK((unsigned char)data[4] & 0x80);
+
+    // SRID comes along
+    CHECK(WKBRoundTrip(MakeLine(true),4326,false,srid,data));
+    CHECK_EQ(srid,4326);
+    CHECK((unsigned char)data[4] & 0x20);
+
+    // Collections with Z, and the SRID only on the top one
+    WKBGeometry coll;
+    coll.type = WKBGeometryCollection;
+    coll.hasZ = true;
+    coll.parts.push_back(MakeLine(true));
+    WKBGeometry pt;
+    pt.type = WKBPoint;
+    pt.hasZ = true;
+    pt.rings.push_back(Point3dVector(1,Point3d(7,8,9)));
+    coll.parts.push_back(pt);
+    CHECK(WKBRoundTrip(coll,3857,true,srid,data));
+    CHECK_EQ(srid,3857);
+}
+
+static void TestWKBMeasures()
+{
+    WKBParser parser;
+    WKBGeometry geom;
+
+    // EWKB POINT M (1 2 3).  M is skipped.
+    std::string pointM = FromHex("0101000040000000000000f03f00000000000000400000000000000840");
+    CHECK_EQ(parser.parse(Bytes(pointM),pointM.size(),geom),pointM.size());
+    CHECK(geom.type == WKBPoint && !geom.hasZ);
+    CHECK(geom.rings.size() == 1 && geom.rings[0][0] == Point3d(1,2,0));
+
+    // EWKB POINT ZM (1 2 3 4) with SRID 4326.  Z stays, M goes.
+    std::string pointZM = FromHex("01010000e0e6100000000000000000f03f000000000000004000000000000008400000000000001040");
+    CHECK_EQ(parser.parse(Bytes(pointZM),pointZM.size(),geom),pointZM.size());
+    CHECK(geom.hasZ);
+    CHECK(geom.rings.size() == 1 && geom.rings[0][0] == Point3d(1,2,3));
+    CHECK_EQ(parser.getSRID(),4326);
+
+    // ISO LINESTRING ZM, big endian, two points
+    std::string lineZM = FromHex("0000000bba00000002"
+                                 "3ff0000000000000400000000000000040080000000000004010000000000000"
+                                 "40140000000000004018000000000000401c0000000000004020000000000000");
+    CHECK_EQ(parser.parse(Bytes(lineZM),lineZM.size(),geom),lineZM.size());
+    CHECK(geom.type == WKBLineString && geom.hasZ);
+    CHECK(geom.rings.size() == 1 && geom.rings[0].size() == 2);
+    if (geom.rings.size() == 1 && geom.rings[0].size() == 2)
+        CHECK(geom.rings[0][1] == Point3d(5,6,7));
+
+    // ISO POINT M written back out loses M but keeps the point
+    std::string isoPointM = FromHex("01d1070000000000000000f03f00000000000000400000000000000840");
+    CHECK_EQ(parser.parse(Bytes(isoPointM),isoPointM.size(),geom),isoPointM.size());
+    std::string out;
+    WKBWriter writer;
+    writer.write(geom,out);
+    CHECK_EQ(ToHex(out),std::string("0101000000000000000000f03f0000000000000040"));
+
+    // Truncated data is reported as such
+    CHECK_EQ(parser.parse(Bytes(pointZM),pointZM.size()-3,geom),0);
+    CHECK(parser.needsMore());
+}
+
+// TWKB encodings from the spec's rules, checked both ways
+static void CheckTWKB(const char *hex,const char *wkt)
+{
+    std::string data = FromHex(hex);
+    TWKBParser parser;
+    WKBGeometry geom;
+    size_t used = parser.parse(Bytes(data),data.size(),geom);
+    if (used != data.size())
+        fprintf(stderr,"TWKB %s: used %d of %d bytes\n",hex,(int)used,(int)data.size());
+    CHECK_EQ(used,data.size());
+
+    WKTWriter wktWriter;
+    std::string outWKT;
+    wktWriter.write(geom,outWKT);
+    if (outWKT != wkt)
+        fprintf(stderr,"TWKB %s: got %s, expected %s\n",hex,outWKT.c_str(),wkt);
+    CHECK(outWKT == wkt);
+}
+
+static void TestTWKBVectors()
+{
+    // POINT(1 2): type 1, no metadata, zigzag varints
+    CheckTWKB("01000204","POINT (1 2)");
+    // The linestring example from the PostGIS docs
+    CheckTWKB("02000202020808","LINESTRING (1 1,5 5)");
+    // One decimal place of precision goes in the high nibble (zigzag 1 = 2)
+    CheckTWKB("21001e32","POINT (1.5 2.5)");
+    // Negative precision scales up: -1 is zigzag 1
+    CheckTWKB("11000204","POINT (10 20)");
+    // Empty flag
+    CheckTWKB("0110","POINT EMPTY");
+    // Bounding box (x min, delta, y min, delta) before the coordinates
+    CheckTWKB("0201020802080202020808","LINESTRING (1 1,5 5)");
+    // Size, then the rest
+    CheckTWKB("0202050202020808","LINESTRING (1 1,5 5)");
+    // Extended dimensions with Z at no extra precision
+    CheckTWKB("010801020406","POINT Z (1 2 3)");
+    // Polygon: one ring of four points
+    CheckTWKB("030001040000020000020101","POLYGON ((0 0,1 0,1 1,0 0))");
+    // Multi point with an ID list
+    CheckTWKB("040402020402020202","MULTIPOINT ((1 1),(2 2))");
+
+    // IDs make it into the geometry
+    std::string data = FromHex("040402020402020202");
+    TWKBParser parser;
+    WKBGeometry geom;
+    parser.parse(Bytes(data),data.size(),geom);
+    CHECK(geom.ids.size() == 2 && geom.ids[0] == 1 && geom.ids[1] == 2);
+
+    // And writing gives the same bytes back
+    TWKBWriter writer;
+    writer.setPrecision(0);
+    std::string out;
+    WKTParser wktParser;
+    WKBGeometry line;
+    wktParser.parse("LINESTRING(1 1,5 5)",19,line);
+    writer.write(line,out);
+    CHECK_EQ(ToHex(out),std::string("02000202020808"));
+
+    out.clear();
+    writer.setPrecision(1);
+    WKBGeometry point;
+    wktParser.parse("POINT(1.5 2.5)",14,point);
+    writer.write(point,out);
+    CHECK_EQ(ToHex(out),std::string("21001e32"));
+
+    // Truncated
+    data = FromHex("020002020208");
+    CHECK_EQ(parser.parse(Bytes(data),data.size(),geom),0);
+    CHECK(parser.needsMore());
+}
+
+// Parse some WKT and write it back out
+static std::string WKTRoundTrip(const std::string &wkt,int *srid = NULL)
+{
+    WKTParser parser;
+    WKBGeometry geom;
+    if (parser.parse(wkt.c_str(),wkt.size(),geom) == 0)
+        return "error: " + parser.getError();
+
+    WKTWriter writer;
+    writer.setSRID(parser.getSRID());
+    if (srid)
+        *srid = parser.getSRID();
+    std::string out;
+    writer.write(geom,out);
+    return out;
+}
+
+static void CheckWKT(const std::string &in,const std::string &expected)
+{
+    std::string out = WKTRoundTrip(in);
+    if (out != expected)
+        fprintf(stderr,"WKT %s: got %s, expected %s\n",in.c_str(),out.c_str(),expected.c_str());
+    CHECK(out == expected);
+}
+
+static void TestWKTRoundTrips()
+{
+    CheckWKT("POINT(1 2)","POINT (1 2)");
+    CheckWKT("  point ( -1.5   2.25 ) ","POINT (-1.5 2.25)");
+    CheckWKT("LINESTRING(0 0,1 1,2 0.5)","LINESTRING (0 0,1 1,2 0.5)");
+    CheckWKT("POLYGON((0 0,4 0,4 4,0 4,0 0),(1 1,2 1,2 2,1 1))","POLYGON ((0 0,4 0,4 4,0 4,0 0),(1 1,2 1,2 2,1 1))");
+    CheckWKT("MULTIPOINT(1 2,3 4)","MULTIPOINT ((1 2),(3 4))");
+    CheckWKT("MULTIPOINT((1 2),(3 4))","MULTIPOINT ((1 2),(3 4))");
+    CheckWKT("MULTILINESTRING((0 0,1 1),(2 2,3 3))","MULTILINESTRING ((0 0,1 1),(2 2,3 3))");
+    CheckWKT("MULTIPOLYGON(((0 0,1 0,1 1,0 0)),((5 5,6 5,6 6,5 5)))","MULTIPOLYGON (((0 0,1 0,1 1,0 0)),((5 5,6 5,6 6,5 5)))");
+    CheckWKT("GEOMETRYCOLLECTION(POINT(1 2),LINESTRING(0 0,1 1))","GEOMETRYCOLLECTION (POINT (1 2),LINESTRING (0 0,1 1))");
+    CheckWKT("POINT EMPTY","POINT EMPTY");
+    CheckWKT("GEOMETRYCOLLECTION EMPTY","GEOMETRYCOLLECTION EMPTY");
+
+    // Z is kept, M is dropped
+    CheckWKT("POINT Z (1 2 3)","POINT Z (1 2 3)");
+    CheckWKT("POINT(1 2 3)","POINT Z (1 2 3)");
+    CheckWKT("POINT M (1 2 3)","POINT (1 2)");
+    CheckWKT("POINT ZM (1 2 3 4)","POINT Z (1 2 3)");
+    CheckWKT("POINT(1 2 3 4)","POINT Z (1 2 3)");
+    CheckWKT("LINESTRING Z (1 2 3,4 5 6)","LINESTRING Z (1 2 3,4 5 6)");
+
+    // EWKT
+    int srid = 0;
+    CHECK_EQ(WKTRoundTrip("SRID=4326;POINT(1 2)",&srid),std::string("SRID=4326;POINT (1 2)"));
+    CHECK_EQ(srid,4326);
+
+    // Output parses back to the same thing
+    std::string once = WKTRoundTrip("MULTIPOLYGON Z (((0 0 1,1 0 2,1 1 3,0 0 1)))");
+    CHECK_EQ(WKTRoundTrip(once),once);
+
+    // Several at once
+    WKTParser parser;
+    ShapeSet shapes;
+    CHECK(parser.parseAll("POINT(1 2); LINESTRING(0 0,1 1)\nPOINT(3 4)",shapes));
+    CHECK_EQ(shapes.size(),3);
+}
+
+static void CheckBadWKT(const std::string &wkt)
+{
+    WKTParser parser;
+    WKBGeometry geom;
+    size_t used = parser.parse(wkt.c_str(),wkt.size(),geom);
+    if (used != 0)
+        fprintf(stderr,"WKT %s: parsed when it shouldn't have\n",wkt.c_str());
+    CHECK_EQ(used,0);
+    CHECK(!parser.getError().empty());
+}
+
+static void TestMalformedWKT()
+{
+    CheckBadWKT("");
+    CheckBadWKT("POINT");
+    CheckBadWKT("POINT(1)");
+    CheckBadWKT("POINT(1 2");
+    CheckBadWKT("POINT(1 x)");
+    CheckBadWKT("POINT Z (1 2)");
+    CheckBadWKT("BLOB(1 2)");
+    CheckBadWKT("LINESTRING(1 2,)");
+    CheckBadWKT("POLYGON(0 0,1 1,1 0,0 0)");
+    CheckBadWKT("MULTIPOINT((1 2),(3))");
+    CheckBadWKT("GEOMETRYCOLLECTION(POINT(1 2),)");
+    CheckBadWKT("SRID=abc;POINT(1 2)");
+
+    // Nesting too deep doesn't blow the stack
+    std::string deep;
+    for (int ii=0;ii<1000;ii++)
+        deep += "GEOMETRYCOLLECTION(";
+    CheckBadWKT(deep);
+
+    // Stops at a bad one in a list
+    WKTParser parser;
+    ShapeSet shapes;
+    CHECK(!parser.parseAll("POINT(1 2);POINT(3",shapes));
+}
+
+int main(int argc,char *argv[])
+{
+    RUN_TEST(TestWKBRoundTrips);
+    RUN_TEST(TestWKBMeasures);
+    RUN_TEST(TestTWKBVectors);
+    RUN_TEST(TestWKTRoundTrips);
+    RUN_TEST(TestMalformedWKT);
+
+    return TEST_RESULT();
+}
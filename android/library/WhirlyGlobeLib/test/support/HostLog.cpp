@@ -0,0 +1,39 @@
+/*
+ *  HostLog.cpp
+ *  WhirlyGlobeLib tests
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "android/log.h"
+
+int __android_log_print(int prio,const char *tag,const char *fmt,...)
+{
+    // Verbose and debug output just gets in the way of the test results
+    if (prio < ANDROID_LOG_WARN)
+        return 0;
+
+    va_list args;
+    va_start(args,fmt);
+    fprintf(stderr,"%s: ",tag);
+    int ret = vfprintf(stderr,fmt,args);
+    fprintf(stderr,"\n");
+    va_end(args);
+
+    return ret;
+}
@@ -316,3 +316,23 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_InternalMarker_setVertexAttribut
         __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in InternalMarker::setVertexAttributes()");
     }
 }
+
+JNIEXPORT void JNICALL Java_com_mousebird_maply_InternalMarker_setAttributes
+(JNIEnv *env, jobject obj, jobject attrsObj)
+{
+    try {
+        MarkerClassInfo *classInfo = MarkerClassInfo::getClassInfo();
+        Marker *marker = classInfo->getObject(env,obj);
+        if (!marker)
+            return;
+
+        // The layout engine holds on to these, so take a copy
+        Dictionary *attrs = attrsObj ? AttrDictClassInfo::getClassInfo()->getObject(env,attrsObj) : NULL;
+        if (attrs)
+            marker->attrs = DictionaryRef(new Dictionary(*attrs));
+        else
+            marker->attrs.reset();
+    } catch (...) {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in InternalMarker::setAttributes()");
+    }
+}
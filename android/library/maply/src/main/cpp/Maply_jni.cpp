@@ -164,6 +164,30 @@ void ConvertLongArrayToSet(JNIEnv *env,jlongArray &idArrayObj,std::set<WhirlyKit
     env->ReleaseLongArrayElements(idArrayObj,ids, 0);
 }
 
+// Matches the layout in TileMatrixSet.java
+static const int TileMatrixLevelSize = 8;
+
+WhirlyKit::TileMatrixSetRef ConvertTileMatrixSet(JNIEnv *env,jdoubleArray &levelArray)
+{
+    int numLevels = env->GetArrayLength(levelArray)/TileMatrixLevelSize;
+    if (numLevels == 0)
+        return WhirlyKit::TileMatrixSetRef();
+
+    WhirlyKit::TileMatrixSetRef tileMatrixSet(new WhirlyKit::TileMatrixSet());
+    double *vals = env->GetDoubleArrayElements(levelArray, NULL);
+    for (int ii=0;ii<numLevels;ii++)
+    {
+        const double *level = &vals[ii*TileMatrixLevelSize];
+        WhirlyKit::TileMatrix matrix(WhirlyKit::Point2d(level[0],level[1]),WhirlyKit::Point2d(level[2],level[3]),(int)level[4],(int)level[5]);
+        matrix.tileWidth = (int)level[6];
+        matrix.tileHeight = (int)level[7];
+        tileMatrixSet->addLevel(matrix);
+    }
+    env->ReleaseDoubleArrayElements(levelArray,vals,0);
+
+    return tileMatrixSet;
+}
+
 JavaString::JavaString(JNIEnv *env,jstring &str)
 : str(str), env(env)
 {
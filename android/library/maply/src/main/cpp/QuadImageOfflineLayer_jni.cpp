@@ -241,7 +241,8 @@ public:
             //            {
             //                import = ScreenImportance(viewState, frameSize, thisTileSize, coordSys, scene->getCoordAdapter(), mbr, _minElev, _maxElev, ident, attrs);
             //            } else {
-            import = ScreenImportance(viewState, frameSize, viewState->eyeVec, thisTileSize, coordSys, scene->getCoordAdapter(), mbr, ident, attrs);
+            // The tile matrix set knows the tile's extents and how big its level's tiles are
+            import = control->getQuadtree()->getTileMatrixSet()->screenImportance(viewState, frameSize, thisTileSize, coordSys, scene->getCoordAdapter(), ident, attrs);
             //            }
             import *= importanceScale;
         }
@@ -38,6 +38,7 @@ public:
 	Scene *scene;
 	SceneRendererES *renderer;
 	CoordSystem *coordSys;
+	TileMatrixSetRef tileMatrixSet;
 	int minZoom,maxZoom;
 	int simultaneousFetches;
 	bool useTargetZoomLevel;
@@ -353,6 +354,12 @@ public:
     	return maxZoom;
     }
 
+    /// Tile matrix set from the tile source, if it doesn't use the usual quad tree
+    virtual TileMatrixSetRef getTileMatrixSet()
+    {
+        return tileMatrixSet;
+    }
+
     /// Return an importance value for the given tile
     virtual double importanceForTile(const Quadtree::Identifier &ident,const Mbr &mbr,ViewState *viewState,const Point2f &frameSize,Dictionary *attrs)
     {
@@ -399,7 +406,8 @@ public:
 //            {
 //                import = ScreenImportance(viewState, frameSize, thisTileSize, coordSys, scene->getCoordAdapter(), mbr, _minElev, _maxElev, ident, attrs);
 //            } else {
-        	    import = ScreenImportance(viewState, frameSize, viewState->eyeVec, thisTileSize, coordSys, scene->getCoordAdapter(), mbr, ident, attrs);
+            // The tile matrix set knows the tile's extents and how big its level's tiles are
+        	    import = control->getQuadtree()->getTileMatrixSet()->screenImportance(viewState, frameSize, thisTileSize, coordSys, scene->getCoordAdapter(), ident, attrs);
 //            }
             import *= importanceScale;
         }
@@ -565,6 +573,21 @@ public:
     	}
     }
 
+    /// The tile loaded along with a grid of elevation samples (top row first) covering it
+    void tileLoaded(int level,int col,int row,int frame,RawDataRef imgData,int width,int height,const float *elevData,int elevSizeX,int elevSizeY,ChangeSet &changes)
+    {
+        Quadtree::Identifier ident(col,row,level);
+        Point2d ll,ur;
+        control->getQuadtree()->generateMbrForNode(ident,ll,ur);
+        ElevationGridTileRef elevTile(new ElevationGridTile(ident,ll,ur,elevSizeX,elevSizeY,elevData));
+
+        std::vector<LoadedImage *> images;
+        ImageWrapper tileWrapper(imgData,width,height);
+        if (imgData)
+            images.push_back(&tileWrapper);
+        tileLoader->loadedImages(this, images, elevTile, level, col, row, frame, changes);
+    }
+
     /// The tile loaded correctly (or didn't if it's null)
     void tileLoaded(int level,int col,int row,int frame,std::vector<RawDataRef> &imgData,int width,int height,ChangeSet &changes)
     {
@@ -699,6 +722,29 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setEnable
 	}
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setTileMatrixSetNative
+  (JNIEnv *env, jobject obj, jdoubleArray levelArray)
+{
+	try
+	{
+		QILAdapterClassInfo *classInfo = QILAdapterClassInfo::getClassInfo();
+		QuadImageLayerAdapter *adapter = classInfo->getObject(env,obj);
+		if (!adapter)
+			return;
+		// The quad tree is built from this when the layer starts, so it can't change after
+		if (adapter->control)
+		{
+			__android_log_print(ANDROID_LOG_VERBOSE, "Maply", "QuadImageTileLayer::setTileMatrixSet() called after the layer started.  Ignoring.");
+			return;
+		}
+		adapter->tileMatrixSet = ConvertTileMatrixSet(env,levelArray);
+	}
+	catch (...)
+	{
+		__android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadImageTileLayer::setTileMatrixSetNative()");
+	}
+}
+
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_setDrawPriority
   (JNIEnv *env, jobject obj, jint drawPriority)
 {
@@ -1477,6 +1523,50 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDid
     }
 }
 
+JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDidLoadElev
+(JNIEnv *env, jobject obj, jint x, jint y, jint level, jint frame, jobject bitmapObj, jfloatArray elevArray, jint elevSizeX, jint elevSizeY, jobject changesObj)
+{
+    try
+    {
+        QuadImageLayerAdapter *adapter = QILAdapterClassInfo::getClassInfo()->getObject(env,obj);
+        ChangeSet *changes = ChangeSetClassInfo::getClassInfo()->getObject(env,changesObj);
+        if (!adapter || !changes || !elevArray)
+            return;
+
+        if (elevSizeX < 2 || elevSizeY < 2 || env->GetArrayLength(elevArray) < elevSizeX*elevSizeY)
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Elevation samples don't match their size in QuadImageTileLayer::nativeTileDidLoadElev()");
+            return;
+        }
+
+        AndroidBitmapInfo info;
+        if (AndroidBitmap_getInfo(env, bitmapObj, &info) < 0)
+            return;
+        if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888)
+        {
+            __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Only dealing with 8888 bitmaps in QuadImageTileLayer");
+            return;
+        }
+        void* bitmapPixels;
+        if (AndroidBitmap_lockPixels(env, bitmapObj, &bitmapPixels) < 0)
+            return;
+
+        if (info.height > 0 && info.width > 0)
+        {
+            RawDataRef rawDataRef(new MutableRawData(bitmapPixels,info.height*info.width*4));
+            jfloat *elevData = env->GetFloatArrayElements(elevArray, NULL);
+            adapter->tileLoaded(level,x,y,frame,rawDataRef,info.width,info.height,elevData,elevSizeX,elevSizeY,*changes);
+            env->ReleaseFloatArrayElements(elevArray, elevData, JNI_ABORT);
+        }
+
+        AndroidBitmap_unlockPixels(env, bitmapObj);
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in QuadImageTileLayer::nativeTileDidLoadElev()");
+    }
+}
+
 JNIEXPORT void JNICALL Java_com_mousebird_maply_QuadImageTileLayer_nativeTileDidNotLoad
   (JNIEnv *env, jobject obj, jint x, jint y, jint level, jint frame, jobject changesObj)
 {
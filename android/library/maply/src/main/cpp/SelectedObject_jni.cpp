@@ -20,6 +20,7 @@
 
 #import <jni.h>
 #import "Maply_jni.h"
+#import "Maply_utils_jni.h"
 #import "com_mousebird_maply_SelectedObject.h"
 #import "WhirlyGlobe.h"
 
@@ -159,3 +160,24 @@ JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_SelectedObject_isPartOfClust
     
     return false;
 }
+
+JNIEXPORT jobject JNICALL Java_com_mousebird_maply_SelectedObject_getAttributes
+(JNIEnv *env, jobject obj)
+{
+    try
+    {
+        SelectedObjectClassInfo *classInfo = SelectedObjectClassInfo::getClassInfo();
+        SelectionManager::SelectedObject *selectedObj = classInfo->getObject(env,obj);
+        if (!selectedObj || !selectedObj->attrs)
+            return NULL;
+        
+        // The dictionary stays with the selected object
+        return MakeAttrDictionary(env,selectedObj->attrs.get());
+    }
+    catch (...)
+    {
+        __android_log_print(ANDROID_LOG_VERBOSE, "Maply", "Crash in SelectedObject::getAttributes()");
+    }
+    
+    return NULL;
+}
@@ -0,0 +1,53 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_mousebird_maply_GeoPackage */
+
+#ifndef _Included_com_mousebird_maply_GeoPackage
+#define _Included_com_mousebird_maply_GeoPackage
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_mousebird_maply_GeoPackage
+ * Method:    nativeInit
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoPackage_nativeInit
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     com_mousebird_maply_GeoPackage
+ * Method:    initialise
+ * Signature: (Ljava/lang/String;I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_GeoPackage_initialise
+  (JNIEnv *, jobject, jstring, jint);
+
+/*
+ * Class:     com_mousebird_maply_GeoPackage
+ * Method:    dispose
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoPackage_dispose
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_mousebird_maply_GeoPackage
+ * Method:    getFeatureTables
+ * Signature: ()[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_mousebird_maply_GeoPackage_getFeatureTables
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_mousebird_maply_GeoPackage
+ * Method:    readFeaturesNative
+ * Signature: (Ljava/lang/String;ZDDDD)Lcom/mousebird/maply/VectorObject;
+ */
+JNIEXPORT jobject JNICALL Java_com_mousebird_maply_GeoPackage_readFeaturesNative
+  (JNIEnv *, jobject, jstring, jboolean, jdouble, jdouble, jdouble, jdouble);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,77 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_mousebird_maply_GeoTIFFTileSource */
+
+#ifndef _Included_com_mousebird_maply_GeoTIFFTileSource
+#define _Included_com_mousebird_maply_GeoTIFFTileSource
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    nativeInit
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_nativeInit
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    initialise
+ * Signature: (Ljava/lang/String;Lcom/mousebird/maply/CoordSystem;DDDDI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_initialise
+  (JNIEnv *, jobject, jstring, jobject, jdouble, jdouble, jdouble, jdouble, jint);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    dispose
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_dispose
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    getMaxLevel
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_getMaxLevel
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    setBilinear
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_setBilinear
+  (JNIEnv *, jobject, jboolean);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    setSampleGrid
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_setSampleGrid
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    tileOverlaps
+ * Signature: (III)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_tileOverlaps
+  (JNIEnv *, jobject, jint, jint, jint);
+
+/*
+ * Class:     com_mousebird_maply_GeoTIFFTileSource
+ * Method:    fetchTileNative
+ * Signature: (III)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_mousebird_maply_GeoTIFFTileSource_fetchTileNative
+  (JNIEnv *, jobject, jint, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_mousebird_maply_IntersectionManager */
+
+#ifndef _Included_com_mousebird_maply_IntersectionManager
+#define _Included_com_mousebird_maply_IntersectionManager
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_mousebird_maply_IntersectionManager
+ * Method:    findIntersection
+ * Signature: (Lcom/mousebird/maply/Scene;Lcom/mousebird/maply/View;Lcom/mousebird/maply/MaplyRenderer;Lcom/mousebird/maply/Point2d;Lcom/mousebird/maply/Point2d;)[D
+ */
+JNIEXPORT jdoubleArray JNICALL Java_com_mousebird_maply_IntersectionManager_findIntersection
+  (JNIEnv *, jobject, jobject, jobject, jobject, jobject, jobject);
+
+/*
+ * Class:     com_mousebird_maply_IntersectionManager
+ * Method:    nativeInit
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_IntersectionManager_nativeInit
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     com_mousebird_maply_IntersectionManager
+ * Method:    initialise
+ * Signature: (Lcom/mousebird/maply/Scene;)V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_IntersectionManager_initialise
+  (JNIEnv *, jobject, jobject);
+
+/*
+ * Class:     com_mousebird_maply_IntersectionManager
+ * Method:    dispose
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_mousebird_maply_IntersectionManager_dispose
+  (JNIEnv *, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
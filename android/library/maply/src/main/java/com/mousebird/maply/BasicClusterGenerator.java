@@ -131,6 +131,12 @@ public class BasicClusterGenerator extends ClusterGenerator {
 
     MaplyBaseController.TextureSettings texSettings = new MaplyBaseController.TextureSettings();
 
+    // The images only depend on the count
+    @Override
+    public boolean cacheClusterGroups() {
+        return true;
+    }
+
     @Override
     public ClusterGroup makeClusterGroup(ClusterInfo clusterInfo) {
         if (!correct)
@@ -23,7 +23,9 @@ package com.mousebird.maply;
 import android.util.Log;
 
 import java.util.ArrayList;
+import java.util.HashMap;
 import java.util.HashSet;
+import java.util.Iterator;
 
 /**
  * Fill in this protocol to provide images when individual markers/labels are clustered.
@@ -34,6 +36,7 @@ public class ClusterGenerator
 {
     public MaplyBaseController baseController = null;
     private HashSet<Long> currentTextures,oldTextures;
+    private HashMap<String,ClusterGroup> groupCache = new HashMap<String,ClusterGroup>();
 
     /**
      * Called at the start of clustering.
@@ -43,6 +46,12 @@ public class ClusterGenerator
     public void startClusterGroup()
     {
         if (oldTextures != null) {
+            // Cached images still in use stick around
+            oldTextures.removeAll(currentTextures);
+            Iterator<ClusterGroup> it = groupCache.values().iterator();
+            while (it.hasNext())
+                if (oldTextures.contains(it.next().tex.texID))
+                    it.remove();
             baseController.removeTexturesByID(new ArrayList<Long>(oldTextures), MaplyBaseController.ThreadMode.ThreadCurrent);
             oldTextures = null;
         }
@@ -63,11 +72,55 @@ public class ClusterGenerator
         return null;
     }
 
+    /**
+     * Set this if the cluster images only depend on what's in the ClusterInfo.
+     * <p>
+     * Clusters with the same count and aggregates will then share an image across layout passes.
+     * Off by default.
+     */
+    public boolean cacheClusterGroups()
+    {
+        return false;
+    }
+
+    /**
+     * Aggregates to compute over the attributes of the markers in each cluster.
+     * <p>
+     * The results are passed to makeClusterGroup() in the ClusterInfo and go into its cache key.
+     * Markers supply the attributes in ScreenMarker.attrs.  None by default.
+     */
+    public ClusterStatDef[] clusterStats()
+    {
+        return null;
+    }
+
     // The C++ code calls this to get a Bitmap then we call makeClusterGroup
-    public long makeClusterGroupJNI(int num)
+    // The aggregates come in as rows.  Rows with a category are category counts, rows
+    // with a string are first by priority values and the rest are numeric.
+    public long makeClusterGroupJNI(int num,String statsKey,String[] statNames,String[] statCategories,double[] statValues,String[] statStrings)
     {
-        ClusterInfo clusterInfo = new ClusterInfo(num);
-        ClusterGroup newGroup = makeClusterGroup(clusterInfo);
+        boolean useCache = statsKey != null && cacheClusterGroups();
+        ClusterGroup newGroup = useCache ? groupCache.get(statsKey) : null;
+        if (newGroup == null) {
+            ClusterInfo clusterInfo = new ClusterInfo(num,statsKey);
+            for (int ii=0;ii<statNames.length;ii++) {
+                String name = statNames[ii];
+                if (statCategories[ii] != null) {
+                    HashMap<String,Integer> counts = clusterInfo.categoryCounts.get(name);
+                    if (counts == null) {
+                        counts = new HashMap<String,Integer>();
+                        clusterInfo.categoryCounts.put(name,counts);
+                    }
+                    counts.put(statCategories[ii],(int)statValues[ii]);
+                } else if (statStrings[ii] != null)
+                    clusterInfo.firstValues.put(name,statStrings[ii]);
+                else
+                    clusterInfo.values.put(name,statValues[ii]);
+            }
+            newGroup = makeClusterGroup(clusterInfo);
+            if (useCache)
+                groupCache.put(statsKey,newGroup);
+        }
 
         currentTextures.add(newGroup.tex.texID);
 
@@ -19,6 +19,9 @@
  */
 package com.mousebird.maply;
 
+import java.util.HashMap;
+import java.util.Map;
+
 /**
  * Information about the group of objects to cluster.
  * <p>
@@ -31,7 +34,54 @@ public class ClusterInfo {
      */
     public int numObjects = 0;
 
+    /**
+     * Key built from the count and the cluster aggregates.  Clusters with the same key look the same.
+     */
+    public String statsKey = null;
+
+    /**
+     * Sum, min, max and mean aggregates from the generator's clusterStats(), by name.
+     * Missing if no member had the attribute.
+     */
+    public HashMap<String,Double> values = new HashMap<String,Double>();
+
+    /**
+     * First by priority aggregates, by name.
+     */
+    public HashMap<String,String> firstValues = new HashMap<String,String>();
+
+    /**
+     * Count by category aggregates, by name.  Each maps a category to its number of members.
+     */
+    public HashMap<String,HashMap<String,Integer>> categoryCounts = new HashMap<String,HashMap<String,Integer>>();
+
     public ClusterInfo(int numObjects){
         this.numObjects = numObjects;
     }
+
+    public ClusterInfo(int numObjects,String statsKey){
+        this.numObjects = numObjects;
+        this.statsKey = statsKey;
+    }
+
+    /**
+     * Category with the most members for a count by category aggregate.
+     * Ties go to the first alphabetically.  Null if there are none.
+     */
+    public String getDominantCategory(String name)
+    {
+        HashMap<String,Integer> counts = categoryCounts.get(name);
+        if (counts == null)
+            return null;
+
+        String best = null;
+        int bestCount = 0;
+        for (Map.Entry<String,Integer> entry : counts.entrySet())
+            if (entry.getValue() > bestCount || (entry.getValue() == bestCount && best != null && entry.getKey().compareTo(best) < 0)) {
+                best = entry.getKey();
+                bestCount = entry.getValue();
+            }
+
+        return best;
+    }
 }
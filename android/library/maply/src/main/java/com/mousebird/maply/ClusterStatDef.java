@@ -0,0 +1,93 @@
+/*
+ *  ClusterStatDef.java
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+package com.mousebird.maply;
+
+/**
+ * An aggregate to compute over the attributes of clustered markers.
+ * <p>
+ * Return these from ClusterGenerator.clusterStats().  The results show up
+ * in the ClusterInfo passed to makeClusterGroup().
+ */
+public class ClusterStatDef
+{
+    /**
+     * Count the members by the value of a string attribute.
+     */
+    public static final int CountByCategory = 0;
+    /**
+     * Sum of a numeric attribute.
+     */
+    public static final int Sum = 1;
+    /**
+     * Smallest value of a numeric attribute.
+     */
+    public static final int Min = 2;
+    /**
+     * Largest value of a numeric attribute.
+     */
+    public static final int Max = 3;
+    /**
+     * Mean of a numeric attribute.
+     */
+    public static final int Mean = 4;
+    /**
+     * Attribute value from the member with the highest priority.
+     */
+    public static final int FirstByPriority = 5;
+
+    /**
+     * How to aggregate.
+     */
+    public int type = CountByCategory;
+
+    /**
+     * Member attribute to look at.
+     */
+    public String attrName = null;
+
+    /**
+     * Name to report the result under.  The attribute name if null.
+     */
+    public String name = null;
+
+    /**
+     * For FirstByPriority, the numeric attribute to rank members by.  Layout importance if null.
+     */
+    public String priorityAttr = null;
+
+    /**
+     * Round numeric results to a multiple of this for the cluster image cache.  Zero for exact.
+     */
+    public double keyBucket = 0.0;
+
+    public ClusterStatDef(int type,String attrName)
+    {
+        this.type = type;
+        this.attrName = attrName;
+    }
+
+    /**
+     * Name the result shows up under in the ClusterInfo.
+     */
+    public String getName()
+    {
+        return name != null ? name : attrName;
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ *  GeoPackage.java
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+package com.mousebird.maply;
+
+/**
+ * A GeoPackage file, read through Android's own SQLite.
+ * <p>
+ * We keep a small pool of read only connections to the file, so reads on
+ * different threads don't wait on one another.  Each read only holds a
+ * connection for the length of a query.
+ */
+public class GeoPackage
+{
+    /**
+     * Open the GeoPackage with the default number of connections.
+     *
+     * @param fileName Full path to the .gpkg file.
+     * @throws IllegalArgumentException if the file can't be opened or isn't a GeoPackage.
+     */
+    public GeoPackage(String fileName)
+    {
+        this(fileName,4);
+    }
+
+    /**
+     * Open the GeoPackage.
+     *
+     * @param fileName Full path to the .gpkg file.
+     * @param maxConnections Most connections we'll have open to the file at once.
+     * @throws IllegalArgumentException if the file can't be opened or isn't a GeoPackage.
+     */
+    public GeoPackage(String fileName,int maxConnections)
+    {
+        if (!initialise(fileName,maxConnections))
+            throw new IllegalArgumentException("Couldn't open GeoPackage " + fileName);
+    }
+
+    public void finalize()
+    {
+        dispose();
+    }
+
+    /**
+     * Names of the tables with features in them.
+     */
+    public native String[] getFeatureTables();
+
+    /**
+     * Read all the features in a table.  Geometry comes back in geographic
+     * radians and the other columns become attributes.
+     *
+     * @param tableName Table to read.
+     * @return The features or null if the table couldn't be read.
+     */
+    public VectorObject readFeatures(String tableName)
+    {
+        return readFeaturesNative(tableName,false,0.0,0.0,0.0,0.0);
+    }
+
+    /**
+     * Read the features in a table that overlap the given bounds.
+     *
+     * @param tableName Table to read.
+     * @param geoBounds Bounds in geographic radians.
+     * @return The features or null if the table couldn't be read.
+     */
+    public VectorObject readFeatures(String tableName,Mbr geoBounds)
+    {
+        return readFeaturesNative(tableName,true,geoBounds.ll.getX(),geoBounds.ll.getY(),geoBounds.ur.getX(),geoBounds.ur.getY());
+    }
+
+    native VectorObject readFeaturesNative(String tableName,boolean hasBounds,double llX,double llY,double urX,double urY);
+
+    static
+    {
+        nativeInit();
+    }
+    private static native void nativeInit();
+    native boolean initialise(String fileName,int maxConnections);
+    native void dispose();
+    private long nativeHandle;
+}
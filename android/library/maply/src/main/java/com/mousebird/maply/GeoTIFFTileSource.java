@@ -0,0 +1,149 @@
+/*
+ *  GeoTIFFTileSource.java
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+package com.mousebird.maply;
+
+import android.graphics.Bitmap;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+
+/**
+ * Serves image tiles out of a local GeoTIFF file.
+ * <p>
+ * Tiles are the usual quad tree over the coordinate system you hand in,
+ * which is probably the same one the QuadImageTileLayer uses.  If the
+ * file is in a different system we reproject on the fly.  The maximum
+ * zoom level is where tiles match the file's full resolution pixels.
+ * <p>
+ * Tiles are read one at a time on a thread of our own.
+ */
+public class GeoTIFFTileSource implements QuadImageTileLayer.TileSource
+{
+    CoordSystem coordSys = null;
+    int pixelsPerSide = 256;
+    int maxZoom = 0;
+    ExecutorService executor = Executors.newSingleThreadExecutor();
+
+    /**
+     * Open the GeoTIFF and set up tiling in the given coordinate system.
+     *
+     * @param fileName Full path to the GeoTIFF.
+     * @param inCoordSys Coordinate system to produce tiles in.  Its bounds must be set.
+     * @param tileSize Size of the tiles in pixels.
+     * @throws IllegalArgumentException if the file can't be read.
+     */
+    public GeoTIFFTileSource(String fileName,CoordSystem inCoordSys,int tileSize)
+    {
+        coordSys = inCoordSys;
+        pixelsPerSide = tileSize;
+        if (!initialise(fileName,coordSys,coordSys.ll.getX(),coordSys.ll.getY(),coordSys.ur.getX(),coordSys.ur.getY(),tileSize))
+            throw new IllegalArgumentException("Couldn't read GeoTIFF " + fileName);
+        maxZoom = getMaxLevel();
+    }
+
+    public void finalize()
+    {
+        executor.shutdownNow();
+        dispose();
+    }
+
+    /**
+     * The minimum zoom level you'll be called about to create a tile for.
+     */
+    public int minZoom()
+    {
+        return 0;
+    }
+
+    /**
+     * The maximum zoom level you'll be called about to create a tile for.
+     */
+    public int maxZoom()
+    {
+        return maxZoom;
+    }
+
+    /**
+     * The number of pixels square for each tile.
+     */
+    public int pixelsPerSide()
+    {
+        return pixelsPerSide;
+    }
+
+    /**
+     * Tiles that don't touch the file aren't worth loading.
+     */
+    public boolean validTile(MaplyTileID tileID,Mbr tileBounds)
+    {
+        return tileOverlaps(tileID.x,tileID.y,tileID.level);
+    }
+
+    /**
+     * Called by the quad image tile layer.  Don't call this yourself.
+     */
+    public void startFetchForTile(final QuadImageTileLayerInterface layer,final MaplyTileID tileID,final int frame)
+    {
+        executor.execute(new Runnable() {
+            @Override
+            public void run() {
+                byte[] rgba = fetchTileNative(tileID.x,tileID.y,tileID.level);
+                if (rgba == null) {
+                    layer.loadedTile(tileID,frame,null);
+                    return;
+                }
+
+                Bitmap bm = Bitmap.createBitmap(pixelsPerSide,pixelsPerSide,Bitmap.Config.ARGB_8888);
+                bm.copyPixelsFromBuffer(ByteBuffer.wrap(rgba));
+                layer.loadedTile(tileID,frame,new MaplyImageTile(bm));
+            }
+        });
+    }
+
+    @Override
+    public void clear(QuadImageTileLayerInterface layer)
+    {
+        // Note: Tiles already queued will still load
+    }
+
+    /**
+     * Interpolate between pixels rather than taking the nearest one.  On by default.
+     */
+    public native void setBilinear(boolean bilinear);
+
+    /**
+     * Number of cells along each side of the reprojection grid.  More is more accurate.
+     */
+    public native void setSampleGrid(int sampleGrid);
+
+    native int getMaxLevel();
+    native boolean tileOverlaps(int x,int y,int level);
+    native byte[] fetchTileNative(int x,int y,int level);
+
+    static
+    {
+        nativeInit();
+    }
+    private static native void nativeInit();
+    native boolean initialise(String fileName,CoordSystem coordSys,double llX,double llY,double urX,double urY,int tileSize);
+    native void dispose();
+    private long nativeHandle;
+}
@@ -57,6 +57,8 @@ class InternalMarker
 			setOffset(marker.offset.getX(),marker.offset.getY());
 		if (marker.selectable)
 			setSelectID(marker.ident);
+		if (marker.attrs != null)
+			setAttributes(marker.attrs);
 	}
 
 	/**
@@ -93,6 +95,7 @@ class InternalMarker
 	public native void setOffset(double offX,double offY);
 	public native void setLayoutImportance(double layoutImp);
 	public native void setVertexAttributes(Object vertAttrs[]);
+	public native void setAttributes(AttrDictionary attrs);
 	public native void setClusterGroup(int clusterGroup);
 	public native void setPeriod(double period);
 	
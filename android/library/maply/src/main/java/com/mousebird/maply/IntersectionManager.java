@@ -0,0 +1,53 @@
+/*
+ *  IntersectionManager.java
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+package com.mousebird.maply;
+
+/**
+ * The intersection manager finds where a tap hits the terrain or 3D models.
+ * Terrain comes from the elevation tile sources hand in with their images.
+ */
+class IntersectionManager
+{
+	private IntersectionManager()
+	{
+	}
+
+	IntersectionManager(Scene scene)
+	{
+		initialise(scene);
+	}
+
+	public void finalize()
+	{
+		dispose();
+	}
+
+	// Closest hit for a point in frame buffer coordinates.  Returns lon, lat (radians), elevation (meters) and distance, or null.
+	public native double[] findIntersection(Scene scene,View view,MaplyRenderer renderer,Point2d frameLoc,Point2d frameSize);
+
+	static
+	{
+		nativeInit();
+	}
+	private static native void nativeInit();
+	native void initialise(Scene scene);
+	native void dispose();
+	private long nativeHandle;
+}
@@ -158,6 +158,10 @@ class LayoutLayer extends Layer implements LayerThread.ViewWatcherInterface
 		synchronized (this) {
 			Point2d clusterSize = generator.clusterLayoutSize();
 			this.layoutManager.addClusterGenerator(generator, generator.clusterNumber(),generator.selectable(),clusterSize.getX(),clusterSize.getY());
+			ClusterStatDef[] stats = generator.clusterStats();
+			if (stats != null)
+				for (ClusterStatDef stat : stats)
+					this.layoutManager.addClusterStat(generator.clusterNumber(),stat.type,stat.attrName,stat.name,stat.priorityAttr,stat.keyBucket);
 		}
 	}
 }
@@ -67,6 +67,9 @@ class LayoutManager
 	// Adds a cluster generator to be used during layout
 	public native void addClusterGenerator(ClusterGenerator generator, int clusterGroupID,boolean selectable,double sizeX,double sizeY);
 
+	// Adds an aggregate for a cluster generator to compute.  Call after the generator is added.
+	public native void addClusterStat(int clusterGroupID,int type,String attrName,String name,String priorityAttr,double keyBucket);
+
 	// Get rid of cluster generators
 	public native void clearClusterGenerators();
 	
@@ -176,6 +176,7 @@ public class MaplyBaseController
     StickerManager stickerManager;
 	LabelManager labelManager;
 	SelectionManager selectionManager;
+	IntersectionManager intersectionManager;
 	LayoutManager layoutManager;
 	ParticleSystemManager particleSystemManager;
 	LayoutLayer layoutLayer = null;
@@ -330,6 +331,7 @@ public class MaplyBaseController
 		labelManager = new LabelManager(scene);
 		layoutManager = new LayoutManager(scene);
 		selectionManager = new SelectionManager(scene);
+		intersectionManager = new IntersectionManager(scene);
 		particleSystemManager = new ParticleSystemManager(scene);
 		shapeManager = new ShapeManager(scene);
 		billboardManager = new BillboardManager(scene);
@@ -597,6 +599,8 @@ public class MaplyBaseController
 				stickerManager.dispose();
 			if (selectionManager != null)
 				selectionManager.dispose();
+			if (intersectionManager != null)
+				intersectionManager.dispose();
 			if (labelManager != null)
 				labelManager.dispose();
 			if (layoutManager != null)
@@ -648,6 +652,7 @@ public class MaplyBaseController
 			stickerManager = null;
 			labelManager = null;
 			selectionManager = null;
+			intersectionManager = null;
 			layoutManager = null;
 			particleSystemManager = null;
 			layoutLayer = null;
@@ -1850,6 +1855,29 @@ public class MaplyBaseController
 		return null;
 	}
 
+	/**
+	 * Find where a point on the screen hits the terrain or a 3D model.
+	 * Terrain is whatever elevation the tile sources have handed in with their tiles.
+	 *
+	 * @param screenPt Point on the screen.
+	 * @return Lon, lat (radians) and elevation (meters) of the closest hit, or null if there isn't one.
+	 */
+	public Point3d geoPointFromScreenIntersect(Point2d screenPt)
+	{
+		if (!running || intersectionManager == null || renderWrapper == null || renderWrapper.maplyRender == null)
+			return null;
+
+		Point2d viewSize = getViewSize();
+		Point2d frameSize = renderWrapper.maplyRender.frameSize;
+		Point2d frameLoc = new Point2d(frameSize.getX()/viewSize.getX()*screenPt.getX(),frameSize.getY()/viewSize.getY()*screenPt.getY());
+
+		double[] hit = intersectionManager.findIntersection(scene,view,renderWrapper.maplyRender,frameLoc,frameSize);
+		if (hit == null)
+			return null;
+
+		return new Point3d(hit[0],hit[1],hit[2]);
+	}
+
 	/**
 	 * Return the frame size we're rendering to.
 	 */
@@ -1871,17 +1899,7 @@ public class MaplyBaseController
 		Point2d frameLoc = new Point2d(scale.getX()*screenLoc.getX(),scale.getY()*screenLoc.getY());
 
 		// Ask the selection manager
-		SelectedObject selManObjs[] = selectionManager.pickObjects(view, frameLoc);
-		if (selManObjs != null)
-		{
-			// Remap the objects
-			synchronized(selectionMap) {
-				for (SelectedObject selObj : selManObjs) {
-					long selectID = selObj.getSelectID();
-					selObj.selObj = selectionMap.get(selectID);
-				}
-			}
-		}
+		SelectedObject selManObjs[] = remapSelectedObjects(selectionManager.pickObjects(view, frameLoc));
 
 		Point2d geoPt = geoPointFromScreen(screenLoc);
 		if (geoPt == null)
@@ -1917,6 +1935,67 @@ public class MaplyBaseController
 		}
 	}
 
+	// Look up the objects we handed to the selection manager
+	private SelectedObject[] remapSelectedObjects(SelectedObject selManObjs[])
+	{
+		if (selManObjs != null)
+		{
+			synchronized(selectionMap) {
+				for (SelectedObject selObj : selManObjs) {
+					long selectID = selObj.getSelectID();
+					selObj.selObj = selectionMap.get(selectID);
+				}
+			}
+		}
+
+		return selManObjs;
+	}
+
+	/**
+	 * Returns the selectable objects that overlap a polygon on the screen, such as a lasso.
+	 * They're sorted by distance from the eye.  Selectable vectors aren't included.
+	 * @param region Polygon in screen coordinates.
+	 * @return The selected objects or null if there weren't any.
+	 */
+	public SelectedObject[] getObjectsInScreenRegion(Point2d[] region)
+	{
+		if (renderWrapper == null || renderWrapper.maplyRender == null || region == null)
+			return null;
+
+		Point2d viewSize = getViewSize();
+		Point2d frameSize = renderWrapper.maplyRender.frameSize;
+		Point2d scale = new Point2d(frameSize.getX()/viewSize.getX(),frameSize.getY()/viewSize.getY());
+		double[] frameRegion = new double[2*region.length];
+		for (int ii=0;ii<region.length;ii++)
+		{
+			frameRegion[2*ii] = scale.getX()*region[ii].getX();
+			frameRegion[2*ii+1] = scale.getY()*region[ii].getY();
+		}
+
+		return remapSelectedObjects(selectionManager.objectsInScreenRegion(view, frameRegion));
+	}
+
+	/**
+	 * Returns the selectable objects within a geographic polygon, whether they're on screen or not.
+	 * They're sorted by distance from the eye.  Selectable vectors aren't included.
+	 * @param region Polygon in geographic coordinates (radians).
+	 * @return The selected objects or null if there weren't any.
+	 */
+	public SelectedObject[] getObjectsInGeoRegion(Point2d[] region)
+	{
+		if (region == null)
+			return null;
+
+		double[] geoRegion = new double[2*region.length];
+		for (int ii=0;ii<region.length;ii++)
+		{
+			geoRegion[2*ii] = region[ii].getX();
+			geoRegion[2*ii+1] = region[ii].getY();
+		}
+
+		return remapSelectedObjects(selectionManager.objectsInGeoRegion(view, geoRegion));
+	}
+
 	/**
 	 * Returns an object (if any) at a given screen location
 	 * @param screenLoc the screen location to be considered
@@ -34,6 +34,8 @@ public class MaplyImageTile
 {
 	public Bitmap[] bitmaps = null;
 	public Bitmap bitmap = null;
+	public float[] elevation = null;
+	public int elevSizeX = 0, elevSizeY = 0;
 	
 	/**
 	 * Construct with a bitmap.
@@ -48,4 +50,20 @@ public class MaplyImageTile
 	{
 		bitmaps = inBitmaps;
 	}
+
+	/**
+	 * Attach elevation to a single bitmap tile.  The layer hands it to the elevation
+	 * manager so vectors can be clamped to the ground and taps can hit the terrain.
+	 * The samples run corner to corner over the tile, top row first.
+	 *
+	 * @param samples Heights in meters, sizeX * sizeY of them.
+	 * @param sizeX Number of samples across.
+	 * @param sizeY Number of samples down.
+	 */
+	public void setElevation(float[] samples,int sizeX,int sizeY)
+	{
+		elevation = samples;
+		elevSizeX = sizeX;
+		elevSizeY = sizeY;
+	}
 }
@@ -95,10 +95,24 @@ public class QuadImageTileLayer extends Layer implements LayerThread.ViewWatcher
 		 */
 		public void clear(QuadImageTileLayerInterface layer);
 	}
+
+	/**
+	 * Tile sources that don't use the usual power of two quad tree over the
+	 * coordinate system can implement this too.  The layer builds its quad tree
+	 * from the tile matrix set they hand back.
+	 */
+	public interface TileMatrixSetSource
+	{
+		/**
+		 * Return the tile matrix set for the source, or null for the usual quad tree.
+		 */
+		public TileMatrixSet getTileMatrixSet();
+	}
 	
 	public MaplyBaseController maplyControl = null;
 	public CoordSystem coordSys = null;
 	TileSource tileSource = null;
+	TileMatrixSet tileMatrixSet = null;
 	boolean flipY = true;
 	
 	/**
@@ -157,6 +171,10 @@ public class QuadImageTileLayer extends Layer implements LayerThread.ViewWatcher
 		layerThread.addWatcher(this);
 		Point2d ll = new Point2d(coordSys.ll.getX(),coordSys.ll.getY());
 		Point2d ur = new Point2d(coordSys.ur.getX(),coordSys.ur.getY());
+		// Has to be in place before the quad tree is built
+		TileMatrixSet tms = getTileMatrixSet();
+		if (tms != null)
+			setTileMatrixSetNative(tms.getLevelData());
 		nativeStartLayer(layerThread.scene,layerThread.renderer,ll,ur,tileSource.minZoom(),tileSource.maxZoom(),tileSource.pixelsPerSide());
 
 		if (currentImageSetBeforeStart)
@@ -376,6 +394,8 @@ public class QuadImageTileLayer extends Layer implements LayerThread.ViewWatcher
 		if (imageTile != null) {
 			if (imageTile.bitmaps != null)
 				nativeTileDidLoad(tileID.x, y, tileID.level, -1, imageTile.bitmaps, changes);
+			else if (imageTile.elevation != null)
+				nativeTileDidLoadElev(tileID.x, y, tileID.level, frame, imageTile.bitmap, imageTile.elevation, imageTile.elevSizeX, imageTile.elevSizeY, changes);
 			else
 				nativeTileDidLoad(tileID.x, y, tileID.level, frame, imageTile.bitmap, changes);
 		} else
@@ -405,6 +425,19 @@ public class QuadImageTileLayer extends Layer implements LayerThread.ViewWatcher
 	}
 	
 	native void setEnable(boolean enable,ChangeSet changes);
+
+	/**
+	 * The tile matrix set the layer tiles by, if the tile source provides one.
+	 * Null means the usual quad tree over the coordinate system.
+	 */
+	public TileMatrixSet getTileMatrixSet()
+	{
+		if (tileMatrixSet == null && tileSource instanceof TileMatrixSetSource)
+			tileMatrixSet = ((TileMatrixSetSource)tileSource).getTileMatrixSet();
+		return tileMatrixSet;
+	}
+
+	native void setTileMatrixSetNative(double[] levels);
 	
 	/**
 	 * Set the draw priority for the whole quad image layer.
@@ -840,5 +873,6 @@ public class QuadImageTileLayer extends Layer implements LayerThread.ViewWatcher
 	native boolean nativeRefresh(ChangeSet changes);
 	native void nativeTileDidLoad(int x,int y,int level,int frame,Bitmap bitmap,ChangeSet changes);
 	native void nativeTileDidLoad(int x,int y,int level,int frame,Bitmap[] bitmaps,ChangeSet changes);
+	native void nativeTileDidLoadElev(int x,int y,int level,int frame,Bitmap bitmap,float[] elev,int elevSizeX,int elevSizeY,ChangeSet changes);
 	native void nativeTileDidNotLoad(int x,int y,int level,int frame,ChangeSet changes);
 }
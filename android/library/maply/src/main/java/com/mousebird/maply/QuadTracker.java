@@ -40,6 +40,20 @@ public class QuadTracker
         initialise(globeController.globeView,globeController.renderWrapper.maplyRender,globeController.coordAdapter,coordSystem,ll,ur,minLevel);
     }
 
+    /**
+     * Set up the quad tracker to follow the tiles of a quad image layer.
+     * It picks up the layer's coordinate system, minimum level and tile matrix set.
+     */
+    public QuadTracker(GlobeController globeController,QuadImageTileLayer layer)
+    {
+        this(globeController,layer.coordSys,
+                new Point2d(layer.coordSys.ll.getX(),layer.coordSys.ll.getY()),new Point2d(layer.coordSys.ur.getX(),layer.coordSys.ur.getY()),
+                layer.tileSource.minZoom());
+        TileMatrixSet tms = layer.getTileMatrixSet();
+        if (tms != null)
+            setTileMatrixSet(tms);
+    }
+
     public void finalize(){
         dispose();
     }
@@ -76,6 +90,17 @@ public class QuadTracker
 
     native void removeTile(int x, int y, int level);
 
+    /**
+     * Set the tile matrix set if the tiles aren't the usual quad tree over the extents.
+     * Pass null to go back to the usual quad tree.
+     */
+    public void setTileMatrixSet(TileMatrixSet tileMatrixSet)
+    {
+        setTileMatrixSetNative(tileMatrixSet != null ? tileMatrixSet.getLevelData() : new double[0]);
+    }
+
+    native void setTileMatrixSetNative(double[] levels);
+
     /**
      * Return the minimum level.  The maximum isn't set.
      */
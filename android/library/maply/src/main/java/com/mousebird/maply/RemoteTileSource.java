@@ -44,7 +44,7 @@ import java.net.URL;
  * This object works on conjunction with a QuadImageTileLayer.
  *
  */
-public class RemoteTileSource implements QuadImageTileLayer.TileSource
+public class RemoteTileSource implements QuadImageTileLayer.TileSource, QuadImageTileLayer.TileMatrixSetSource
 {
 	MaplyBaseController controller = null;
 	RemoteTileInfo tileInfo = null;
@@ -60,6 +60,13 @@ public class RemoteTileSource implements QuadImageTileLayer.TileSource
 	 */
 	public boolean debugOutput = false;
 
+	/**
+	 * Set this if the remote service doesn't use the usual power of two quad tree,
+	 * such as WMTS.  Rows are flipped per level using its matrix heights.
+	 * Set it before the layer starts.
+	 */
+	public TileMatrixSet tileMatrixSet = null;
+
 	/**
 	 * The tile source delegate will be called back when a tile loads
 	 * or fails to load.
@@ -298,6 +305,15 @@ public class RemoteTileSource implements QuadImageTileLayer.TileSource
         }
 	}
 	
+	/**
+	 * The tile matrix set, if there is one.  Called by the quad image tile layer.
+	 */
+	@Override
+	public TileMatrixSet getTileMatrixSet()
+	{
+		return tileMatrixSet;
+	}
+
 	/**
 	 * This is called by the quad image tile layer.  Don't call this yourself.
 	 */
@@ -308,7 +324,7 @@ public class RemoteTileSource implements QuadImageTileLayer.TileSource
 			Log.d("Maply","Starting fetch for tile " + tileID.level + ": (" + tileID.x + "," + tileID.y + ")");
 
 		// Form the tile URL
-		int maxY = 1<<tileID.level;
+		int maxY = tileMatrixSet != null ? tileMatrixSet.getMatrixHeight(tileID.level) : 1<<tileID.level;
 		int remoteY = maxY - tileID.y - 1;
 		final URL tileURL = tileInfo.buildURL(tileID.x,remoteY,tileID.level);
 		
@@ -93,6 +93,12 @@ public class ScreenMarker
 	 */
 	public Object userObject = null;
 
+	/**
+	 * Attributes the layout engine looks at when this marker is clustered.
+	 * The cluster generator's statistics are computed over these.
+	 */
+	public AttrDictionary attrs = null;
+
 	/**
 	 * If set, these are vertex attributes to be applied to be consolidated and passed
 	 * to a custom shader.  Each set of attributes will be copied for each individual vertex
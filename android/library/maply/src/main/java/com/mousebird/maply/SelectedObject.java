@@ -38,6 +38,13 @@ public class SelectedObject
      */
     native public boolean isPartOfCluster();
 
+    /**
+     * Attributes of the selected object, if it was added with some.
+     * Markers pass theirs along.  Clusters don't have any.
+     * The dictionary is only good for as long as this object is.
+     */
+    native public AttrDictionary getAttributes();
+
     public void finalize()
     {
         dispose();
@@ -24,6 +24,12 @@ class SelectionManager
 
 	// Look for a list of objects the selection manager is handling
 	public native SelectedObject[] pickObjects(View view,Point2d screenLoc);
+
+	// Objects overlapping a polygon on the screen.  Region is x,y pairs in frame buffer coordinates.
+	public native SelectedObject[] objectsInScreenRegion(View view,double[] region);
+
+	// Objects within a geographic polygon.  Region is lon,lat pairs in radians.
+	public native SelectedObject[] objectsInGeoRegion(View view,double[] region);
 	
 	static
 	{
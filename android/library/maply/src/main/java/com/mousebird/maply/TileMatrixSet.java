@@ -0,0 +1,120 @@
+/*
+ *  TileMatrixSet.java
+ *  WhirlyGlobeLib
+ *
+ *  Created by mousebird consulting on 10/19/26.
+ *  Copyright 2011-2026 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+package com.mousebird.maply;
+
+import java.util.ArrayList;
+
+/**
+ * A tile matrix set describes how a tiling scheme breaks up space at each level.
+ * <p>
+ * Use this when your tiles aren't the usual power of two quad tree over the
+ * coordinate system's extents, such as WMTS or a national grid.  Each level
+ * has its own origin, tile size and number of tiles.  Tile (0,0) is in the
+ * lower left, as with the rest of the toolkit.
+ * <p>
+ * Hand this back from a TileMatrixSetSource and the QuadImageTileLayer will
+ * build its quad tree from it.
+ */
+public class TileMatrixSet
+{
+    // Size of a pixel in meters, per the WMTS spec
+    static final double WMTSPixelSize = 0.00028;
+    // Doubles per level in the data we pass to the native side
+    static final int LevelSize = 8;
+
+    ArrayList<double[]> levels = new ArrayList<double[]>();
+
+    public TileMatrixSet()
+    {
+    }
+
+    /**
+     * Add the next level down.
+     *
+     * @param ll Lower left corner of tile (0,0) in the coordinate system.
+     * @param tileSpan Size of a single tile in coordinate system units.
+     * @param matrixWidth Number of tiles across.
+     * @param matrixHeight Number of tiles up.
+     * @param tileWidth Width of a tile in pixels, or 0 to use the tile source's.
+     * @param tileHeight Height of a tile in pixels, or 0 to use the tile source's.
+     */
+    public void addLevel(Point2d ll,Point2d tileSpan,int matrixWidth,int matrixHeight,int tileWidth,int tileHeight)
+    {
+        levels.add(new double[]{ll.getX(),ll.getY(),tileSpan.getX(),tileSpan.getY(),matrixWidth,matrixHeight,tileWidth,tileHeight});
+    }
+
+    /**
+     * Add the next level down from a WMTS TileMatrix description.
+     *
+     * @param topLeft Top left corner of the matrix, where WMTS tiles start.
+     * @param scaleDenominator Scale denominator for the level.
+     * @param metersPerUnit Meters per unit of the coordinate system.
+     * @param tileWidth Width of a tile in pixels.
+     * @param tileHeight Height of a tile in pixels.
+     * @param matrixWidth Number of tiles across.
+     * @param matrixHeight Number of tiles down.
+     */
+    public void addWMTSLevel(Point2d topLeft,double scaleDenominator,double metersPerUnit,int tileWidth,int tileHeight,int matrixWidth,int matrixHeight)
+    {
+        double pixelSpan = scaleDenominator * WMTSPixelSize / metersPerUnit;
+        Point2d tileSpan = new Point2d(tileWidth * pixelSpan,tileHeight * pixelSpan);
+        Point2d ll = new Point2d(topLeft.getX(),topLeft.getY() - matrixHeight * tileSpan.getY());
+
+        addLevel(ll,tileSpan,matrixWidth,matrixHeight,tileWidth,tileHeight);
+    }
+
+    /**
+     * Number of levels in the set.
+     */
+    public int getNumLevels()
+    {
+        return levels.size();
+    }
+
+    /**
+     * Number of tiles up at the given level.  Use this to flip rows for sources that count from the top.
+     */
+    public int getMatrixHeight(int level)
+    {
+        if (level < 0 || level >= levels.size())
+            return 0;
+        return (int)levels.get(level)[5];
+    }
+
+    /**
+     * Number of tiles across at the given level.
+     */
+    public int getMatrixWidth(int level)
+    {
+        if (level < 0 || level >= levels.size())
+            return 0;
+        return (int)levels.get(level)[4];
+    }
+
+    // All the levels, one after another, for the native side
+    double[] getLevelData()
+    {
+        double[] data = new double[levels.size() * LevelSize];
+        for (int ii=0;ii<levels.size();ii++)
+            System.arraycopy(levels.get(ii),0,data,ii*LevelSize,LevelSize);
+
+        return data;
+    }
+}